@@ -47,11 +47,13 @@ public:
 
     constexpr FORCEINLINE ArrayView& operator=(ArrayView&& other) noexcept = default;
 
-    constexpr FORCEINLINE const T* Data() const { return m_Data; }
+    constexpr FORCEINLINE T* Data() const { return m_Data; }
 
-    constexpr FORCEINLINE const T* Length() const { return m_Size; }
+    constexpr FORCEINLINE bool IsEmpty() const { return m_Size == 0; }
 
-    constexpr FORCEINLINE const T* Size() const { return m_Size; }
+    constexpr FORCEINLINE usize Length() const { return m_Size; }
+
+    constexpr FORCEINLINE usize Size() const { return m_Size; }
 
     constexpr FORCEINLINE T operator[](usize idx) { return m_Data[idx]; }
 
@@ -63,7 +65,7 @@ public:
 
     constexpr FORCEINLINE T Back() const { return m_Data[m_Size - 1]; }
 
-    constexpr FORCEINLINE void RemovePrefix(usize skip) { m_Data += skip; }
+    constexpr FORCEINLINE void RemovePrefix(usize skip) { m_Data += skip; m_Size -= skip; }
 
     constexpr FORCEINLINE void RemoveSuffix(usize skip) { m_Size -= skip; }
 
@@ -110,8 +112,8 @@ public:
     }
 
 private:
-    T* m_Data;
-    usize m_Size;
+    T* m_Data = NULL;
+    usize m_Size = 0;
 };
 
 template<typename T>
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <limits>
+
+#include <Core/Misc/Defines/Common.hpp>
+
+TRE_NS_START
+
+namespace Utils
+{
+    // ptr is one past the last character parsed, first when nothing could be parsed
+    struct FromCharsResult
+    {
+        const char* ptr;
+        bool ok;
+    };
+
+    namespace Internal
+    {
+        CONSTEXPR FORCEINLINE bool IsDigit(char ch) { return uint8(ch - '0') < 10; }
+
+        // Decimal number split in a mantissa of at most 19 significant digits and a power of ten
+        struct DecimalNumber
+        {
+            uint64 mantissa;
+            int32 exponent;
+            bool negative;
+            bool truncated; // More than 19 significant digits
+        };
+
+        constexpr const char* ParseDecimal(const char* first, const char* last, DecimalNumber& number)
+        {
+            const char* ptr = first;
+            number = {};
+
+            if (ptr != last && (*ptr == '-' || *ptr == '+')) {
+                number.negative = *ptr == '-';
+                ptr++;
+            }
+
+            const char* digits = ptr;
+            uint32 significant = 0;
+
+            for (; ptr != last && IsDigit(*ptr); ptr++) {
+                if (significant < 19) {
+                    number.mantissa = number.mantissa * 10 + uint64(*ptr - '0');
+                    significant += number.mantissa != 0;
+                } else {
+                    number.exponent++;
+                    number.truncated |= *ptr != '0';
+                }
+            }
+
+            usize digitCount = usize(ptr - digits);
+
+            if (ptr != last && *ptr == '.') {
+                ptr++;
+                const char* fraction = ptr;
+
+                for (; ptr != last && IsDigit(*ptr); ptr++) {
+                    if (significant < 19) {
+                        number.mantissa = number.mantissa * 10 + uint64(*ptr - '0');
+                        significant += number.mantissa != 0;
+                        number.exponent--;
+                    } else {
+                        number.truncated |= *ptr != '0';
+                    }
+                }
+
+                digitCount += usize(ptr - fraction);
+            }
+
+            if (digitCount == 0)
+                return first;
+
+            if (ptr != last && (*ptr == 'e' || *ptr == 'E')) {
+                const char* exponent = ptr + 1;
+                bool negative = false;
+
+                if (exponent != last && (*exponent == '-' || *exponent == '+')) {
+                    negative = *exponent == '-';
+                    exponent++;
+                }
+
+                // Without digits the 'e' isn't part of the number
+                if (exponent != last && IsDigit(*exponent)) {
+                    int32 value = 0;
+
+                    for (; exponent != last && IsDigit(*exponent); exponent++) {
+                        value = value < 100000 ? value * 10 + (*exponent - '0') : value;
+                    }
+
+                    number.exponent += negative ? -value : value;
+                    ptr = exponent;
+                }
+            }
+
+            return ptr;
+        }
+
+        template<typename F>
+        CONSTEXPR F POWERS_OF_TEN[] = {
+            F(1e0), F(1e1), F(1e2), F(1e3), F(1e4), F(1e5), F(1e6), F(1e7), F(1e8), F(1e9), F(1e10), F(1e11),
+            F(1e12), F(1e13), F(1e14), F(1e15), F(1e16), F(1e17), F(1e18), F(1e19), F(1e20), F(1e21), F(1e22)
+        };
+
+        /*
+         * Clinger's fast path: when the mantissa and the power of ten are both exact in F, one multiplication or
+         * division is correctly rounded. Everything else goes to std::from_chars.
+         */
+        template<typename F>
+        FromCharsResult ParseFloat(const char* first, const char* last, F& value)
+        {
+            CONSTEXPR uint64 MAX_MANTISSA = 1ull << std::numeric_limits<F>::digits;
+            CONSTEXPR int32 MAX_EXPONENT = sizeof(F) == 4 ? 10 : 22;
+
+            DecimalNumber number;
+            const char* end = ParseDecimal(first, last, number);
+
+            if (end != first && !number.truncated && number.mantissa <= MAX_MANTISSA &&
+                number.exponent >= -MAX_EXPONENT && number.exponent <= MAX_EXPONENT) {
+                F result = F(number.mantissa);
+                result = number.exponent < 0 ? result / POWERS_OF_TEN<F>[-number.exponent] :
+                    result * POWERS_OF_TEN<F>[number.exponent];
+                value = number.negative ? -result : result;
+                return { end, true };
+            }
+
+            // Unlike ours std::from_chars doesn't take a leading '+'
+            const char* start = (first != last && *first == '+') ? first + 1 : first;
+            const std::from_chars_result result = std::from_chars(start, last, value);
+
+            if (result.ec == std::errc::invalid_argument)
+                return { first, false };
+
+            return { result.ptr, result.ec == std::errc() };
+        }
+    }
+
+    /*
+     * Integer parsing in the spirit of std::from_chars, base 10, with an optional sign. Fails on overflow, the value is
+     * only written on success.
+     */
+    template<std::integral T>
+    constexpr FromCharsResult FromChars(const char* first, const char* last, T& value)
+    {
+        const char* ptr = first;
+        bool negative = false;
+
+        if (ptr != last && (*ptr == '-' || *ptr == '+')) {
+            negative = *ptr == '-';
+            ptr++;
+
+            if (negative && !std::numeric_limits<T>::is_signed)
+                return { first, false };
+        }
+
+        const char* digits = ptr;
+        using U = std::make_unsigned_t<T>;
+        const U limit = negative ? U(U(std::numeric_limits<T>::max()) + 1) : U(std::numeric_limits<T>::max());
+        U result = 0;
+        bool overflow = false;
+
+        for (; ptr != last && Internal::IsDigit(*ptr); ptr++) {
+            const U digit = U(*ptr - '0');
+            overflow |= result > (limit - digit) / 10;
+            result = U(result * 10 + digit);
+        }
+
+        if (ptr == digits)
+            return { first, false };
+
+        if (overflow)
+            return { ptr, false };
+
+        value = negative ? T(U(0) - result) : T(result);
+        return { ptr, true };
+    }
+
+    // Decimal or scientific notation, inf and nan
+    inline FromCharsResult FromChars(const char* first, const char* last, float& value)
+    {
+        return Internal::ParseFloat(first, last, value);
+    }
+
+    inline FromCharsResult FromChars(const char* first, const char* last, double& value)
+    {
+        return Internal::ParseFloat(first, last, value);
+    }
+}
+
+TRE_NS_END
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include <Core/Misc/Defines/Common.hpp>
+#include <Core/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+/*
+ * Index of a slot in a HandleTable and the generation the slot had when it was acquired. Live generations are odd,
+ * so the default handle {0, 0} never resolves.
+ */
+template<typename T>
+struct TableHandle
+{
+    uint32 index = 0;
+    uint32 generation = 0;
+
+    CONSTEXPR FORCEINLINE bool IsNull() const { return generation == 0; }
+
+    CONSTEXPR FORCEINLINE uint64 ToUInt64() const { return uint64(generation) << 32 | index; }
+
+    CONSTEXPR FORCEINLINE static TableHandle FromUInt64(uint64 value) { return { uint32(value), uint32(value >> 32) }; }
+
+    CONSTEXPR bool operator==(const TableHandle& other) const = default;
+};
+
+/*
+ * Generational handle table. Objects live in pages of PAGE_SLOTS slots that are allocated on demand and never move,
+ * so pointers returned by Get stay valid until the handle is released. Acquire and Release are lock-free: free slots
+ * form a tagged Treiber stack and the table grows by bumping a slot counter and publishing pages with a CAS.
+ *
+ * Each slot carries a generation, odd while the slot is alive and even while it's free. Releasing bumps it, which
+ * makes every handle to the old object stale (Get returns NULL, Release returns false) even once the slot is reused.
+ * Releasing an object other threads are still reading is the owner's business, the table only makes sure it's
+ * destroyed once.
+ */
+template<typename T, uint32 PAGE_SLOTS = 1024, uint32 MAX_PAGES = 4096>
+class HandleTable
+{
+public:
+    using Handle = TableHandle<T>;
+
+    static_assert((PAGE_SLOTS & (PAGE_SLOTS - 1)) == 0, "PAGE_SLOTS must be a power of 2");
+
+    CONSTEXPR static uint32 MAX_SLOTS = PAGE_SLOTS * MAX_PAGES;
+
+public:
+    HandleTable() = default;
+
+    ~HandleTable();
+
+    HandleTable(const HandleTable&) = delete;
+
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    // Constructs the object in a free slot, returns a null handle when all MAX_SLOTS slots are used
+    template<typename... Args>
+    Handle Acquire(Args&&... args);
+
+    // Destroys the object and recycles its slot, false when the handle is stale or was already released
+    bool Release(Handle handle);
+
+    // NULL when the handle is stale
+    FORCEINLINE T* Get(Handle handle) const;
+
+    FORCEINLINE bool IsValid(Handle handle) const { return this->Get(handle) != NULL; }
+
+    FORCEINLINE uint32 GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+
+    // Slots handed out so far, live or free
+    FORCEINLINE uint32 GetCapacity() const { return MIN(m_SlotCount.load(std::memory_order_relaxed), MAX_SLOTS); }
+
+    // Not thread safe, calls func(Handle, T&) on every live object
+    template<typename Func>
+    void ForEach(Func&& func);
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32> generation{ 0 };
+        std::atomic<uint32> nextFree{ 0 };
+        alignas(T) uint8 storage[sizeof(T)];
+
+        FORCEINLINE T* GetObject() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    CONSTEXPR static uint32 EMPTY = UINT32_MAX;
+
+    FORCEINLINE Slot* GetSlot(uint32 index) const;
+
+    uint32 PopFree();
+
+    void PushFree(uint32 index);
+
+    uint32 Grow();
+
+private:
+    std::atomic<Slot*>  m_Pages[MAX_PAGES] = {};
+    std::atomic<uint64> m_FreeHead{ EMPTY };  // Tag in the high bits against ABA, slot index in the low bits
+    std::atomic<uint32> m_SlotCount{ 0 };
+    std::atomic<uint32> m_Count{ 0 };
+};
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+HandleTable<T, PAGE_SLOTS, MAX_PAGES>::~HandleTable()
+{
+    this->ForEach([](Handle, T& object) { object.~T(); });
+
+    for (std::atomic<Slot*>& page : m_Pages) {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+template<typename... Args>
+typename HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Handle HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Acquire(Args&&... args)
+{
+    uint32 index = this->PopFree();
+
+    if (index == EMPTY) {
+        index = this->Grow();
+
+        if (index == EMPTY)
+            return Handle{};
+    }
+
+    Slot* slot = this->GetSlot(index);
+    new (slot->storage) T(std::forward<Args>(args)...);
+
+    // Publishes the object, readers acquire the generation before touching it
+    const uint32 generation = slot->generation.load(std::memory_order_relaxed) + 1;
+    slot->generation.store(generation, std::memory_order_release);
+    m_Count.fetch_add(1, std::memory_order_relaxed);
+    return Handle{ index, generation };
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+bool HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Release(Handle handle)
+{
+    if (!(handle.generation & 1) || handle.index >= this->GetCapacity())
+        return false;
+
+    Slot* slot = this->GetSlot(handle.index);
+
+    if (!slot)
+        return false;
+
+    // Only one of the threads releasing the same handle wins
+    uint32 expected = handle.generation;
+
+    if (!slot->generation.compare_exchange_strong(expected, handle.generation + 1, std::memory_order_acq_rel,
+        std::memory_order_relaxed))
+        return false;
+
+    slot->GetObject()->~T();
+    m_Count.fetch_sub(1, std::memory_order_relaxed);
+    this->PushFree(handle.index);
+    return true;
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+FORCEINLINE T* HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Get(Handle handle) const
+{
+    if (!(handle.generation & 1) || handle.index >= this->GetCapacity())
+        return NULL;
+
+    Slot* slot = this->GetSlot(handle.index);
+
+    if (!slot || slot->generation.load(std::memory_order_acquire) != handle.generation)
+        return NULL;
+
+    return slot->GetObject();
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+template<typename Func>
+void HandleTable<T, PAGE_SLOTS, MAX_PAGES>::ForEach(Func&& func)
+{
+    const uint32 capacity = this->GetCapacity();
+
+    for (uint32 index = 0; index < capacity; index++) {
+        Slot* slot = this->GetSlot(index);
+
+        if (!slot)
+            continue;
+
+        const uint32 generation = slot->generation.load(std::memory_order_acquire);
+
+        if (generation & 1) {
+            func(Handle{ index, generation }, *slot->GetObject());
+        }
+    }
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+FORCEINLINE typename HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Slot* HandleTable<T, PAGE_SLOTS, MAX_PAGES>::GetSlot(uint32 index) const
+{
+    Slot* page = m_Pages[index / PAGE_SLOTS].load(std::memory_order_acquire);
+    return page ? &page[index % PAGE_SLOTS] : NULL;
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+uint32 HandleTable<T, PAGE_SLOTS, MAX_PAGES>::PopFree()
+{
+    uint64 head = m_FreeHead.load(std::memory_order_acquire);
+
+    while (uint32(head) != EMPTY) {
+        // The slot may be popped and pushed again meanwhile, the tag makes the CAS fail then
+        const uint32 index = uint32(head);
+        const uint32 next = this->GetSlot(index)->nextFree.load(std::memory_order_relaxed);
+        const uint64 newHead = ((head >> 32) + 1) << 32 | next;
+
+        if (m_FreeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+            return index;
+    }
+
+    return EMPTY;
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+void HandleTable<T, PAGE_SLOTS, MAX_PAGES>::PushFree(uint32 index)
+{
+    Slot* slot = this->GetSlot(index);
+    uint64 head = m_FreeHead.load(std::memory_order_relaxed);
+    uint64 newHead;
+
+    do {
+        slot->nextFree.store(uint32(head), std::memory_order_relaxed);
+        newHead = ((head >> 32) + 1) << 32 | index;
+    } while (!m_FreeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+}
+
+template<typename T, uint32 PAGE_SLOTS, uint32 MAX_PAGES>
+uint32 HandleTable<T, PAGE_SLOTS, MAX_PAGES>::Grow()
+{
+    const uint32 index = m_SlotCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (index >= MAX_SLOTS) {
+        m_SlotCount.store(MAX_SLOTS, std::memory_order_relaxed);
+        return EMPTY;
+    }
+
+    // Every thread landing on a missing page tries to publish one, the losers drop theirs
+    std::atomic<Slot*>& page = m_Pages[index / PAGE_SLOTS];
+
+    if (!page.load(std::memory_order_acquire)) {
+        Slot* expected = NULL;
+        Slot* slots = new Slot[PAGE_SLOTS];
+
+        if (!page.compare_exchange_strong(expected, slots, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            delete[] slots;
+        }
+    }
+
+    return index;
+}
+
+TRE_NS_END
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <Core/Misc/Defines/Common.hpp>
+
+TRE_NS_START
+
+namespace Utils
+{
+    /*
+     * Incremental 64-bit FNV hasher, one step per 32-bit value. The renderer keys its pipelines, render passes and
+     * descriptor layouts with it, the string interner hashes its strings with it at compile time as well.
+     */
+    class Hasher
+    {
+    public:
+        CONSTEXPR explicit Hasher(uint64 h) : h(h) {}
+
+        CONSTEXPR explicit Hasher() : h(0xcbf29ce484222325ull) {}
+
+        template<typename T>
+        FORCEINLINE void Data(const T* data_, size_t size)
+        {
+            size /= sizeof(*data_);
+            for (size_t i = 0; i < size; i++)
+                h = (h * 0x100000001b3ull) ^ data_[i];
+        }
+
+        template<typename T>
+        FORCEINLINE void Data(const T& data)
+        {
+            CONSTEXPR size_t size = sizeof(T) / sizeof(uint8);
+            const uint8* byteData = (const uint8*)&data;
+
+            for (size_t i = 0; i < size; i++)
+                u32(uint8_t(byteData[i]));
+        }
+
+        template<typename BY, typename T>
+        FORCEINLINE void Data(const T& data)
+        {
+            CONSTEXPR size_t size = sizeof(T) / sizeof(BY);
+            const BY* byteData = (const BY*)&data;
+
+            for (size_t i = 0; i < size; i++)
+                u32(BY(byteData[i]));
+        }
+
+        CONSTEXPR FORCEINLINE void u32(uint32_t value)
+        {
+            h = (h * 0x100000001b3ull) ^ value;
+        }
+
+        CONSTEXPR FORCEINLINE void s32(int32_t value)
+        {
+            u32(uint32_t(value));
+        }
+
+        FORCEINLINE void f32(float value)
+        {
+            union
+            {
+                float f32;
+                uint32_t u32;
+            } u;
+            u.f32 = value;
+            u32(u.u32);
+        }
+
+        CONSTEXPR FORCEINLINE void u64(uint64_t value)
+        {
+            u32(value & 0xffffffffu);
+            u32(value >> 32);
+        }
+
+        template<typename T>
+        FORCEINLINE void Pointer(T* ptr)
+        {
+            u64(reinterpret_cast<uintptr_t>(ptr));
+        }
+
+        CONSTEXPR FORCEINLINE void String(const char* str)
+        {
+            char c;
+            u32(0xff);
+            while ((c = *str++) != '\0')
+                u32(uint8_t(c));
+        }
+
+        // Same hash as String() for a string that isn't null terminated
+        CONSTEXPR FORCEINLINE void String(const char* str, size_t size)
+        {
+            u32(0xff);
+            for (size_t i = 0; i < size; i++)
+                u32(uint8_t(str[i]));
+        }
+
+        CONSTEXPR FORCEINLINE uint64 Get() const
+        {
+            return h;
+        }
+    private:
+        uint64 h;
+    };
+}
+
+TRE_NS_END
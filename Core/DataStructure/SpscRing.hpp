@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include <Core/Misc/Defines/Common.hpp>
+
+TRE_NS_START
+
+/*
+ * Bounded single producer single consumer queue. One thread pushes, another one pops, neither ever blocks or locks:
+ * each side owns its index and only reads the other one's, refreshing its cached copy when the ring looks full (or
+ * empty). Items are copied in and out, so they have to be trivially copyable.
+ */
+template<typename T, usize CAPACITY>
+class SpscRing
+{
+public:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2");
+    static_assert(std::is_trivially_copyable_v<T>, "Items are copied with plain assignments");
+
+public:
+    // The slots are value initialized, a pop never hands out indeterminate bytes
+    SpscRing() : head(0), cachedTail(0), tail(0), cachedHead(0), items() {}
+
+    SpscRing(const SpscRing&) = delete;
+
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side, false when full
+    bool TryPush(const T& item)
+    {
+        const usize position = head.load(std::memory_order_relaxed);
+
+        if (position - cachedTail == CAPACITY) {
+            cachedTail = tail.load(std::memory_order_acquire);
+
+            if (position - cachedTail == CAPACITY) {
+                return false;
+            }
+        }
+
+        items[position & (CAPACITY - 1)] = item;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, false when empty
+    bool TryPop(T& item)
+    {
+        const usize position = tail.load(std::memory_order_relaxed);
+
+        if (position == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+
+            if (position == cachedHead) {
+                return false;
+            }
+        }
+
+        item = items[position & (CAPACITY - 1)];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, the oldest item without popping it, NULL when empty
+    const T* Peek()
+    {
+        const usize position = tail.load(std::memory_order_relaxed);
+
+        if (position == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+
+            if (position == cachedHead) {
+                return NULL;
+            }
+        }
+
+        return &items[position & (CAPACITY - 1)];
+    }
+
+    // Exact from either side when the other one is idle, a snapshot otherwise
+    FORCEINLINE usize Size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    FORCEINLINE bool IsEmpty() const { return this->Size() == 0; }
+
+    CONSTEXPR static usize Capacity() { return CAPACITY; }
+private:
+    // Producer and consumer indices on their own cache lines, with their cached view of the other side
+    alignas(64) std::atomic<usize> head;
+    usize cachedTail;
+    alignas(64) std::atomic<usize> tail;
+    usize cachedHead;
+    alignas(64) T items[CAPACITY];
+};
+
+TRE_NS_END
@@ -28,6 +28,8 @@ public:
     using size_type         = size_t;
     using difference_type	= ptrdiff_t;
 
+    CONSTEXPR static usize NPOS = Utils::NPOS;
+
 public:
     constexpr FORCEINLINE BasicString();
 
@@ -74,6 +76,13 @@ public:
 
     constexpr bool EndsWith(const BasicString<T>& str) const noexcept;
 
+    // Searches return NPOS when there is no match
+    constexpr FORCEINLINE usize Find(const T* str, usize sz = 0, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize Find(const BasicString<T>& str, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize Find(T ch, usize pos = 0) const noexcept;
+
     constexpr bool Reserve(usize size);
 
     constexpr FORCEINLINE BasicString<T> SubString(usize index, usize count) const;
@@ -406,6 +415,38 @@ constexpr FORCEINLINE bool BasicString<T>::EndsWith(const BasicString<T>& str) c
     return this->StartsWith(str.Data(), str.Size());
 }
 
+template<typename T>
+constexpr FORCEINLINE usize BasicString<T>::Find(const T* str, usize sz, usize pos) const noexcept
+{
+    if (str != nullptr && sz == 0)
+        sz = Utils::Strlen(str);
+
+    if (pos > m_Size)
+        return NPOS;
+
+    const usize index = Utils::Find(m_Data + pos, m_Size - pos, str, sz);
+    return index == NPOS ? NPOS : index + pos;
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicString<T>::Find(const BasicString<T>& str, usize pos) const noexcept
+{
+    if (str.Empty())
+        return pos <= m_Size ? pos : NPOS;
+
+    return this->Find(str.Data(), str.Size(), pos);
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicString<T>::Find(T ch, usize pos) const noexcept
+{
+    if (pos >= m_Size)
+        return NPOS;
+
+    const usize index = Utils::FindChar(m_Data + pos, m_Size - pos, ch);
+    return index == NPOS ? NPOS : index + pos;
+}
+
 template<typename T>
 constexpr FORCEINLINE BasicString<T> BasicString<T>::SubString(usize index, usize count) const
 {
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string.h>
+
+#include <Core/Misc/Defines/Common.hpp>
+#include <Core/Misc/Defines/Debug.hpp>
+#include <Core/DataStructure/Hasher.hpp>
+#include <Core/DataStructure/StringView.hpp>
+
+TRE_NS_START
+
+/*
+ * Stable 32-bit name of an interned string. Two ids are equal exactly when their strings are, the default id is null.
+ */
+struct StringId
+{
+    uint32 id = 0;
+
+    CONSTEXPR FORCEINLINE bool IsNull() const { return id == 0; }
+
+    CONSTEXPR bool operator==(const StringId& other) const = default;
+};
+
+/*
+ * Thread safe string interner. Strings are spread over SHARD_COUNT shards by hash, each shard owns an open addressing
+ * table of ids, its entries and an arena holding the characters. Lookups of strings that are already interned never
+ * lock: they probe the shard's current table and compare against immutable entries. Inserting takes the shard's
+ * mutex, so threads interning different strings rarely wait on each other.
+ *
+ * Interned strings are null terminated and live, like the tables readers may still be probing after a grow, until
+ * the interner is destroyed.
+ */
+class StringInterner
+{
+public:
+    CONSTEXPR static uint32 SHARD_BITS = 4;
+    CONSTEXPR static uint32 SHARD_COUNT = 1 << SHARD_BITS;
+    CONSTEXPR static uint32 PAGE_ENTRIES = 4096;
+    CONSTEXPR static uint32 MAX_PAGES = 256;
+    CONSTEXPR static uint32 MAX_STRINGS_PER_SHARD = PAGE_ENTRIES * MAX_PAGES;
+    CONSTEXPR static usize ARENA_CHUNK_SIZE = 64 * 1024;
+
+    // Utils::Hasher::String(), also usable at compile time
+    CONSTEXPR static uint64 Hash(const char* str, usize size)
+    {
+        Utils::Hasher hasher;
+        hasher.String(str, size);
+        return hasher.Get();
+    }
+
+public:
+    StringInterner() = default;
+
+    ~StringInterner();
+
+    StringInterner(const StringInterner&) = delete;
+
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    StringId Intern(StringView str);
+
+    FORCEINLINE StringId Intern(const char* str) { return this->Intern(StringView(str, Utils::Strlen(str))); }
+
+    // Null when the string was never interned, never locks
+    StringId Find(StringView str) const;
+
+    // The id must come from this interner
+    FORCEINLINE StringView GetString(StringId id) const;
+
+    FORCEINLINE const char* GetCString(StringId id) const { return this->GetEntry(id).data; }
+
+    // Hash of the string's content, the same on every run unlike the id
+    FORCEINLINE uint64 GetHash(StringId id) const { return this->GetEntry(id).hash; }
+
+    uint32 GetCount() const;
+
+private:
+    struct Entry
+    {
+        const char* data;
+        uint32 size;
+        uint64 hash;
+    };
+
+    // Slots hold the local index of an entry plus one, zero for an empty slot
+    struct Table
+    {
+        std::atomic<uint32>* slots;
+        uint32 mask;
+        Table* previous; // Retired tables, freed with the interner
+    };
+
+    struct alignas(64) Shard
+    {
+        std::atomic<Table*> table{ NULL };
+        std::atomic<Entry*> pages[MAX_PAGES] = {};
+        mutable std::mutex mutex;
+        uint32 count = 0;
+        char* arena = NULL;
+        usize arenaLeft = 0;
+        void* chunks = NULL; // Each chunk starts with a pointer to the previous one
+    };
+
+    CONSTEXPR static uint32 INITIAL_CAPACITY = 256;
+
+    CONSTEXPR static FORCEINLINE uint32 GetShardIndex(uint64 hash) { return uint32(hash) & (SHARD_COUNT - 1); }
+
+    CONSTEXPR static FORCEINLINE StringId MakeId(uint32 shard, uint32 local) { return StringId{ (local + 1) << SHARD_BITS | shard }; }
+
+    FORCEINLINE const Entry& GetEntry(StringId id) const;
+
+    StringId Lookup(const Shard& shard, uint32 shardIndex, StringView str, uint64 hash) const;
+
+    void Grow(Shard& shard);
+
+    const char* Store(Shard& shard, StringView str);
+
+private:
+    Shard m_Shards[SHARD_COUNT];
+};
+
+inline StringInterner::~StringInterner()
+{
+    for (Shard& shard : m_Shards) {
+        Table* table = shard.table.load(std::memory_order_relaxed);
+
+        while (table) {
+            Table* previous = table->previous;
+            delete[] table->slots;
+            delete table;
+            table = previous;
+        }
+
+        for (std::atomic<Entry*>& page : shard.pages) {
+            delete[] page.load(std::memory_order_relaxed);
+        }
+
+        void* chunk = shard.chunks;
+
+        while (chunk) {
+            void* previous = *(void**)chunk;
+            ::operator delete(chunk);
+            chunk = previous;
+        }
+    }
+}
+
+inline StringId StringInterner::Intern(StringView str)
+{
+    const uint64 hash = Hash(str.Data(), str.Size());
+    const uint32 shardIndex = GetShardIndex(hash);
+    Shard& shard = m_Shards[shardIndex];
+    StringId id = this->Lookup(shard, shardIndex, str, hash);
+
+    if (!id.IsNull())
+        return id;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Another thread may have inserted it while we were waiting
+    id = this->Lookup(shard, shardIndex, str, hash);
+
+    if (!id.IsNull())
+        return id;
+
+    TRE_ASSERTF(shard.count < MAX_STRINGS_PER_SHARD, "String interner shard %u is full", shardIndex);
+
+    Table* table = shard.table.load(std::memory_order_relaxed);
+
+    if (!table || (shard.count + 1) * 4 > (table->mask + 1) * 3) {
+        this->Grow(shard);
+        table = shard.table.load(std::memory_order_relaxed);
+    }
+
+    const uint32 local = shard.count++;
+    std::atomic<Entry*>& page = shard.pages[local / PAGE_ENTRIES];
+
+    if (!page.load(std::memory_order_relaxed)) {
+        page.store(new Entry[PAGE_ENTRIES], std::memory_order_release);
+    }
+
+    Entry& entry = page.load(std::memory_order_relaxed)[local % PAGE_ENTRIES];
+    entry.data = this->Store(shard, str);
+    entry.size = (uint32)str.Size();
+    entry.hash = hash;
+
+    // Publishes the entry, readers acquire the slot before reading it
+    uint32 slot = uint32(hash >> SHARD_BITS) & table->mask;
+
+    while (table->slots[slot].load(std::memory_order_relaxed)) {
+        slot = (slot + 1) & table->mask;
+    }
+
+    table->slots[slot].store(local + 1, std::memory_order_release);
+    return MakeId(shardIndex, local);
+}
+
+inline StringId StringInterner::Find(StringView str) const
+{
+    const uint64 hash = Hash(str.Data(), str.Size());
+    const uint32 shardIndex = GetShardIndex(hash);
+    return this->Lookup(m_Shards[shardIndex], shardIndex, str, hash);
+}
+
+FORCEINLINE StringView StringInterner::GetString(StringId id) const
+{
+    const Entry& entry = this->GetEntry(id);
+    return StringView(entry.data, entry.size);
+}
+
+inline uint32 StringInterner::GetCount() const
+{
+    uint32 count = 0;
+
+    for (const Shard& shard : m_Shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.count;
+    }
+
+    return count;
+}
+
+FORCEINLINE const StringInterner::Entry& StringInterner::GetEntry(StringId id) const
+{
+    TRE_ASSERTF(!id.IsNull(), "Null string id");
+
+    const uint32 local = (id.id >> SHARD_BITS) - 1;
+    const Entry* page = m_Shards[id.id & (SHARD_COUNT - 1)].pages[local / PAGE_ENTRIES].load(std::memory_order_acquire);
+    return page[local % PAGE_ENTRIES];
+}
+
+inline StringId StringInterner::Lookup(const Shard& shard, uint32 shardIndex, StringView str, uint64 hash) const
+{
+    // A table that was just retired misses the newest strings, the caller then checks again under the lock
+    const Table* table = shard.table.load(std::memory_order_acquire);
+
+    if (!table)
+        return StringId{};
+
+    for (uint32 slot = uint32(hash >> SHARD_BITS) & table->mask;; slot = (slot + 1) & table->mask) {
+        const uint32 value = table->slots[slot].load(std::memory_order_acquire);
+
+        if (!value)
+            return StringId{};
+
+        const uint32 local = value - 1;
+        const Entry& entry = shard.pages[local / PAGE_ENTRIES].load(std::memory_order_acquire)[local % PAGE_ENTRIES];
+
+        if (entry.hash == hash && entry.size == str.Size() && (!entry.size || memcmp(entry.data, str.Data(), entry.size) == 0))
+            return MakeId(shardIndex, local);
+    }
+}
+
+inline void StringInterner::Grow(Shard& shard)
+{
+    Table* old = shard.table.load(std::memory_order_relaxed);
+    const uint32 capacity = old ? (old->mask + 1) * 2 : INITIAL_CAPACITY;
+
+    Table* table = new Table{ new std::atomic<uint32>[capacity], capacity - 1, old };
+
+    for (uint32 i = 0; i < capacity; i++) {
+        table->slots[i].store(0, std::memory_order_relaxed);
+    }
+
+    for (uint32 local = 0; local < shard.count; local++) {
+        const Entry& entry = shard.pages[local / PAGE_ENTRIES].load(std::memory_order_relaxed)[local % PAGE_ENTRIES];
+        uint32 slot = uint32(entry.hash >> SHARD_BITS) & table->mask;
+
+        while (table->slots[slot].load(std::memory_order_relaxed)) {
+            slot = (slot + 1) & table->mask;
+        }
+
+        table->slots[slot].store(local + 1, std::memory_order_relaxed);
+    }
+
+    shard.table.store(table, std::memory_order_release);
+}
+
+inline const char* StringInterner::Store(Shard& shard, StringView str)
+{
+    const usize size = str.Size() + 1;
+
+    // Large strings get a chunk of their own so the current one isn't wasted
+    if (size > ARENA_CHUNK_SIZE / 4) {
+        void** chunk = (void**)::operator new(sizeof(void*) + size);
+        *chunk = shard.chunks;
+        shard.chunks = chunk;
+
+        char* data = (char*)(chunk + 1);
+        memcpy(data, str.Data(), str.Size());
+        data[str.Size()] = '\0';
+        return data;
+    }
+
+    if (size > shard.arenaLeft) {
+        void** chunk = (void**)::operator new(ARENA_CHUNK_SIZE);
+        *chunk = shard.chunks;
+        shard.chunks = chunk;
+        shard.arena = (char*)(chunk + 1);
+        shard.arenaLeft = ARENA_CHUNK_SIZE - sizeof(void*);
+    }
+
+    char* data = shard.arena;
+
+    if (str.Size()) {
+        memcpy(data, str.Data(), str.Size());
+    }
+
+    data[str.Size()] = '\0';
+    shard.arena += size;
+    shard.arenaLeft -= size;
+    return data;
+}
+
+// Process wide interner for resource, material and shader names
+inline StringInterner& GetStringInterner()
+{
+    static StringInterner interner;
+    return interner;
+}
+
+inline StringId InternString(StringView str)
+{
+    return GetStringInterner().Intern(str);
+}
+
+inline StringId InternString(const char* str)
+{
+    return GetStringInterner().Intern(str);
+}
+
+TRE_NS_END
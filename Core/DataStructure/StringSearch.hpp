@@ -0,0 +1,373 @@
+#pragma once
+
+#include <bit>
+#include <string.h>
+#include <type_traits>
+
+#include <Core/Misc/Defines/Common.hpp>
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_AVX2
+    #include <immintrin.h>
+#elif SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+    #define TRE_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+    #define TRE_NO_SANITIZE_ADDRESS
+#endif
+
+TRE_NS_START
+
+/*
+ * Text scanning primitives. Byte strings are scanned 16 (SSE2) or 32 (AVX2, when compiled with it) characters at a time,
+ * other character types and constant evaluation use the scalar loops. Every search returns an index into the
+ * string or NPOS.
+ */
+namespace Utils
+{
+    CONSTEXPR usize NPOS = ~usize(0);
+
+    // The whitespace SkipWhitespace skips
+    CONSTEXPR char WHITESPACES[] = " \t\r\n\v\f";
+
+    namespace Internal
+    {
+        template<typename T>
+        constexpr usize StrlenScalar(const T* str)
+        {
+            usize size = 0;
+
+            while (str[size]) {
+                size++;
+            }
+
+            return size;
+        }
+
+        template<typename T>
+        constexpr usize FindCharScalar(const T* data, usize size, T ch, usize start = 0)
+        {
+            for (usize i = start; i < size; i++) {
+                if (data[i] == ch)
+                    return i;
+            }
+
+            return NPOS;
+        }
+
+        template<typename T>
+        constexpr bool IsAnyOf(T ch, const T* set, usize setSize)
+        {
+            for (usize i = 0; i < setSize; i++) {
+                if (set[i] == ch)
+                    return true;
+            }
+
+            return false;
+        }
+
+        template<bool MATCH, typename T>
+        constexpr usize FindAnyOfScalar(const T* data, usize size, const T* set, usize setSize, usize start = 0)
+        {
+            for (usize i = start; i < size; i++) {
+                if (IsAnyOf(data[i], set, setSize) == MATCH)
+                    return i;
+            }
+
+            return NPOS;
+        }
+
+        template<typename T>
+        constexpr usize FindScalar(const T* data, usize size, const T* needle, usize needleSize, usize start = 0)
+        {
+            if (needleSize > size)
+                return NPOS;
+
+            for (usize i = start; i <= size - needleSize; i++) {
+                usize j = 0;
+
+                while (j < needleSize && data[i + j] == needle[j]) {
+                    j++;
+                }
+
+                if (j == needleSize)
+                    return i;
+            }
+
+            return NPOS;
+        }
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+    #if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_AVX2
+        typedef __m256i Block;
+        CONSTEXPR usize BLOCK_SIZE = 32;
+
+        FORCEINLINE Block Load(const char* data) { return _mm256_loadu_si256((const __m256i*)data); }
+
+        FORCEINLINE Block LoadAligned(const char* data) { return _mm256_load_si256((const __m256i*)data); }
+
+        FORCEINLINE Block Splat(char ch) { return _mm256_set1_epi8(ch); }
+
+        FORCEINLINE Block Equal(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+
+        FORCEINLINE Block Or(Block a, Block b) { return _mm256_or_si256(a, b); }
+
+        FORCEINLINE uint32 Mask(Block a) { return (uint32)_mm256_movemask_epi8(a); }
+
+        CONSTEXPR uint32 FULL_MASK = 0xFFFFFFFF;
+    #else
+        typedef __m128i Block;
+        CONSTEXPR usize BLOCK_SIZE = 16;
+
+        FORCEINLINE Block Load(const char* data) { return _mm_loadu_si128((const __m128i*)data); }
+
+        FORCEINLINE Block LoadAligned(const char* data) { return _mm_load_si128((const __m128i*)data); }
+
+        FORCEINLINE Block Splat(char ch) { return _mm_set1_epi8(ch); }
+
+        FORCEINLINE Block Equal(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+
+        FORCEINLINE Block Or(Block a, Block b) { return _mm_or_si128(a, b); }
+
+        FORCEINLINE uint32 Mask(Block a) { return (uint32)_mm_movemask_epi8(a); }
+
+        CONSTEXPR uint32 FULL_MASK = 0xFFFF;
+    #endif
+
+        // One bit per byte equal in both blocks
+        FORCEINLINE uint32 Match(Block a, Block b) { return Mask(Equal(a, b)); }
+
+        // Four blocks checked at once, only one movemask and branch per 64 or 128 bytes
+        CONSTEXPR usize UNROLL_SIZE = 4 * BLOCK_SIZE;
+
+        // Index of the first matching byte in four consecutive blocks known to hold one
+        FORCEINLINE usize FirstMatch(const char* data, Block splat)
+        {
+            for (usize i = 0; i < UNROLL_SIZE; i += BLOCK_SIZE) {
+                const uint32 mask = Match(Load(data + i), splat);
+
+                if (mask)
+                    return i + std::countr_zero(mask);
+            }
+
+            return UNROLL_SIZE;
+        }
+
+        FORCEINLINE bool AnyMatch(const char* data, Block splat)
+        {
+            const Block a = Or(Equal(Load(data), splat), Equal(Load(data + BLOCK_SIZE), splat));
+            const Block b = Or(Equal(Load(data + 2 * BLOCK_SIZE), splat), Equal(Load(data + 3 * BLOCK_SIZE), splat));
+            return Mask(Or(a, b)) != 0;
+        }
+
+        // Aligned blocks never cross a page, reading past the terminator is safe even if the sanitizer disagrees
+        TRE_NO_SANITIZE_ADDRESS inline usize StrlenSimd(const char* str)
+        {
+            const usize misalignment = (usize)str & (BLOCK_SIZE - 1);
+            const char* block = str - misalignment;
+            const Block zero = Splat(0);
+            uint32 mask = Match(LoadAligned(block), zero) >> misalignment;
+
+            if (mask)
+                return std::countr_zero(mask);
+
+            // Single blocks up to an unroll boundary, then the four blocks read together stay in the same page
+            for (block += BLOCK_SIZE; (usize)block & (UNROLL_SIZE - 1); block += BLOCK_SIZE) {
+                mask = Match(LoadAligned(block), zero);
+
+                if (mask)
+                    return usize(block - str) + std::countr_zero(mask);
+            }
+
+            while (!AnyMatch(block, zero)) {
+                block += UNROLL_SIZE;
+            }
+
+            return usize(block - str) + FirstMatch(block, zero);
+        }
+
+        inline usize FindCharSimd(const char* data, usize size, char ch)
+        {
+            const Block splat = Splat(ch);
+            usize i = 0;
+
+            // Only whole blocks are loaded, written as the bytes left so the bounds are visible to the optimizer
+            for (; size - i >= UNROLL_SIZE; i += UNROLL_SIZE) {
+                if (AnyMatch(data + i, splat))
+                    return i + FirstMatch(data + i, splat);
+            }
+
+            for (; size - i >= BLOCK_SIZE; i += BLOCK_SIZE) {
+                const uint32 mask = Match(Load(data + i), splat);
+
+                if (mask)
+                    return i + std::countr_zero(mask);
+            }
+
+            return FindCharScalar(data, size, ch, i);
+        }
+
+        // Matches against up to 16 characters, one compare per character of the set
+        template<bool MATCH>
+        inline usize FindAnyOfSimd(const char* data, usize size, const char* set, usize setSize)
+        {
+            Block splats[16];
+
+            for (usize s = 0; s < setSize; s++) {
+                splats[s] = Splat(set[s]);
+            }
+
+            auto scan = [&](const char* block) {
+                const Block bytes = Load(block);
+                uint32 mask = 0;
+
+                for (usize s = 0; s < setSize; s++) {
+                    mask |= Match(bytes, splats[s]);
+                }
+
+                return MATCH ? mask : ~mask & FULL_MASK;
+            };
+
+            usize i = 0;
+
+            for (; size - i >= BLOCK_SIZE; i += BLOCK_SIZE) {
+                const uint32 mask = scan(data + i);
+
+                if (mask)
+                    return i + std::countr_zero(mask);
+            }
+
+            return FindAnyOfScalar<MATCH>(data, size, set, setSize, i);
+        }
+
+        // Compares the needle's first and last characters a block at a time, only full compares the candidates
+        inline usize FindSimd(const char* data, usize size, const char* needle, usize needleSize)
+        {
+            const Block first = Splat(needle[0]);
+            const Block last = Splat(needle[needleSize - 1]);
+            usize i = 0;
+
+            for (; size - i >= needleSize - 1 + BLOCK_SIZE; i += BLOCK_SIZE) {
+                uint32 mask = Match(Load(data + i), first) & Match(Load(data + i + needleSize - 1), last);
+
+                while (mask) {
+                    const usize candidate = i + std::countr_zero(mask);
+
+                    if (memcmp(data + candidate + 1, needle + 1, needleSize - 2) == 0)
+                        return candidate;
+
+                    mask &= mask - 1;
+                }
+            }
+
+            return FindScalar(data, size, needle, needleSize, i);
+        }
+#endif
+    }
+
+    template<typename T>
+    constexpr usize Strlen(const T* str)
+    {
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+        if constexpr (sizeof(T) == 1) {
+#if defined(__GNUC__) || defined(__clang__)
+            // Literals fold to a constant once inlined, the optimizer then knows their bounds
+            if (__builtin_constant_p(__builtin_strlen((const char*)str)))
+                return __builtin_strlen((const char*)str);
+#endif
+
+            if (!std::is_constant_evaluated())
+                return Internal::StrlenSimd((const char*)str);
+        }
+#endif
+
+        return Internal::StrlenScalar(str);
+    }
+
+    template<typename T>
+    constexpr usize FindChar(const T* data, usize size, T ch)
+    {
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+        if constexpr (sizeof(T) == 1) {
+            if (!std::is_constant_evaluated())
+                return Internal::FindCharSimd((const char*)data, size, (char)ch);
+        }
+#endif
+
+        return Internal::FindCharScalar(data, size, ch);
+    }
+
+    // First character that is in the set
+    template<typename T>
+    constexpr usize FindAnyOf(const T* data, usize size, const T* set, usize setSize)
+    {
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+        if constexpr (sizeof(T) == 1) {
+            if (!std::is_constant_evaluated() && setSize && setSize <= 16)
+                return Internal::FindAnyOfSimd<true>((const char*)data, size, (const char*)set, setSize);
+        }
+#endif
+
+        return Internal::FindAnyOfScalar<true>(data, size, set, setSize);
+    }
+
+    // First character that is not in the set
+    template<typename T>
+    constexpr usize FindNotAnyOf(const T* data, usize size, const T* set, usize setSize)
+    {
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+        if constexpr (sizeof(T) == 1) {
+            if (!std::is_constant_evaluated() && setSize && setSize <= 16)
+                return Internal::FindAnyOfSimd<false>((const char*)data, size, (const char*)set, setSize);
+        }
+#endif
+
+        return Internal::FindAnyOfScalar<false>(data, size, set, setSize);
+    }
+
+    // First occurrence of the needle, an empty needle is found at 0
+    template<typename T>
+    constexpr usize Find(const T* data, usize size, const T* needle, usize needleSize)
+    {
+        if (needleSize == 0)
+            return 0;
+
+        if (needleSize == 1)
+            return Utils::FindChar(data, size, needle[0]);
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+        if constexpr (sizeof(T) == 1) {
+            if (!std::is_constant_evaluated() && needleSize <= size)
+                return Internal::FindSimd((const char*)data, size, (const char*)needle, needleSize);
+        }
+#endif
+
+        return Internal::FindScalar(data, size, needle, needleSize);
+    }
+
+    // Index of the first non whitespace character, size when there is none
+    template<typename T>
+    constexpr usize SkipWhitespace(const T* data, usize size)
+    {
+        T set[sizeof(WHITESPACES) - 1] = {};
+
+        for (usize i = 0; i < sizeof(WHITESPACES) - 1; i++) {
+            set[i] = T(WHITESPACES[i]);
+        }
+
+        const usize index = Utils::FindNotAnyOf(data, size, set, sizeof(WHITESPACES) - 1);
+        return index == NPOS ? size : index;
+    }
+
+    // Index of the '\n' ending the first line, size for the last line
+    template<typename T>
+    constexpr usize FindLineEnd(const T* data, usize size)
+    {
+        const usize index = Utils::FindChar(data, size, T('\n'));
+        return index == NPOS ? size : index;
+    }
+}
+
+TRE_NS_END
@@ -7,8 +7,6 @@
 
 TRE_NS_START
 
-std::string_view a;
-
 template<typename T>
 class BasicStringView
 {
@@ -27,10 +25,12 @@ public:
     using size_type         = size_t;
     using difference_type	= ptrdiff_t;
 
+    CONSTEXPR static usize NPOS = Utils::NPOS;
+
 public:
     constexpr FORCEINLINE BasicStringView() noexcept = default;
 
-    constexpr FORCEINLINE BasicStringView(T* data, usize size) noexcept;
+    constexpr FORCEINLINE BasicStringView(const T* data, usize size) noexcept;
 
     constexpr FORCEINLINE BasicStringView(const BasicString<T>& str) noexcept;
 
@@ -49,9 +49,11 @@ public:
 
     constexpr FORCEINLINE const T* Data() const { return m_Data; }
 
-    constexpr FORCEINLINE const T* Length() const { return m_Size; }
+    constexpr FORCEINLINE usize Length() const { return m_Size; }
+
+    constexpr FORCEINLINE usize Size() const { return m_Size; }
 
-    constexpr FORCEINLINE const T* Size() const { return m_Size; }
+    constexpr FORCEINLINE bool Empty() const { return m_Size == 0; }
 
     constexpr FORCEINLINE T operator[](usize idx) { return m_Data[idx]; }
 
@@ -59,11 +61,16 @@ public:
 
     constexpr FORCEINLINE T At(usize idx) const { return m_Data[idx]; }
 
+    constexpr FORCEINLINE bool operator==(const BasicStringView& other) const noexcept
+    {
+        return m_Size == other.m_Size && Utils::MemCmp(m_Data, other.m_Data, m_Size);
+    }
+
     constexpr FORCEINLINE T Front() const { return *m_Data; }
 
     constexpr FORCEINLINE T Back() const { return m_Data[m_Size - 1]; }
 
-    constexpr FORCEINLINE void RemovePrefix(usize skip) { m_Data += skip; }
+    constexpr FORCEINLINE void RemovePrefix(usize skip) { m_Data += skip; m_Size -= skip; }
 
     constexpr FORCEINLINE void RemoveSuffix(usize skip) { m_Size -= skip; }
 
@@ -77,9 +84,22 @@ public:
 
     constexpr FORCEINLINE bool EndsWith(const BasicStringView& str) const noexcept;
 
-    constexpr FORCEINLINE usize Find(const T* str, usize sz = 0) const noexcept;
+    // Searches return NPOS when there is no match
+    constexpr FORCEINLINE usize Find(const T* str, usize sz = 0, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize Find(const BasicStringView& str, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize Find(T ch, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize FindFirstOf(const BasicStringView& set, usize pos = 0) const noexcept;
+
+    constexpr FORCEINLINE usize FindFirstNotOf(const BasicStringView& set, usize pos = 0) const noexcept;
+
+    // Without the leading whitespaces
+    constexpr FORCEINLINE BasicStringView TrimStart() const noexcept;
 
-    constexpr FORCEINLINE usize Find(const BasicStringView& str) const noexcept;
+    // Returns the first line without its line ending and removes it from the view
+    constexpr BasicStringView PopLine() noexcept;
 
     constexpr iterator begin() const noexcept
     {
@@ -121,12 +141,15 @@ public:
         return const_reverse_iterator(this->begin());
     }
 private:
-    T* m_Data;
-    usize m_Size;
+    constexpr FORCEINLINE usize Offset(usize index, usize pos) const { return index == NPOS ? NPOS : index + pos; }
+
+private:
+    const T* m_Data = nullptr;
+    usize m_Size = 0;
 };
 
 template<typename T>
-constexpr FORCEINLINE BasicStringView<T>::BasicStringView(T* data, usize size) noexcept
+constexpr FORCEINLINE BasicStringView<T>::BasicStringView(const T* data, usize size) noexcept
     : m_Data(data), m_Size(size)
 {
 
@@ -192,16 +215,72 @@ constexpr FORCEINLINE bool BasicStringView<T>::EndsWith(const BasicStringView& s
 }
 
 template<typename T>
-constexpr FORCEINLINE usize BasicStringView<T>::Find(const T* str, usize sz) const noexcept
+constexpr FORCEINLINE usize BasicStringView<T>::Find(const T* str, usize sz, usize pos) const noexcept
+{
+    if (str != nullptr && sz == 0)
+        sz = Utils::Strlen(str);
+
+    if (pos > m_Size)
+        return NPOS;
+
+    return this->Offset(Utils::Find(m_Data + pos, m_Size - pos, str, sz), pos);
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicStringView<T>::Find(const BasicStringView& str, usize pos) const noexcept
+{
+    if (str.m_Size == 0)
+        return pos <= m_Size ? pos : NPOS;
+
+    return this->Find(str.m_Data, str.m_Size, pos);
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicStringView<T>::Find(T ch, usize pos) const noexcept
+{
+    if (pos >= m_Size)
+        return NPOS;
+
+    return this->Offset(Utils::FindChar(m_Data + pos, m_Size - pos, ch), pos);
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicStringView<T>::FindFirstOf(const BasicStringView& set, usize pos) const noexcept
+{
+    if (pos >= m_Size)
+        return NPOS;
+
+    return this->Offset(Utils::FindAnyOf(m_Data + pos, m_Size - pos, set.m_Data, set.m_Size), pos);
+}
+
+template<typename T>
+constexpr FORCEINLINE usize BasicStringView<T>::FindFirstNotOf(const BasicStringView& set, usize pos) const noexcept
 {
-    // TODO : Implement this
-    return std::numeric_limits<usize>::max();
+    if (pos >= m_Size)
+        return NPOS;
+
+    return this->Offset(Utils::FindNotAnyOf(m_Data + pos, m_Size - pos, set.m_Data, set.m_Size), pos);
 }
 
 template<typename T>
-constexpr FORCEINLINE usize BasicStringView<T>::Find(const BasicStringView& str) const noexcept
+constexpr FORCEINLINE BasicStringView<T> BasicStringView<T>::TrimStart() const noexcept
 {
-    return this->Find(str.m_Data, str.m_Size);
+    const usize start = Utils::SkipWhitespace(m_Data, m_Size);
+    return BasicStringView(m_Data + start, m_Size - start);
+}
+
+template<typename T>
+constexpr BasicStringView<T> BasicStringView<T>::PopLine() noexcept
+{
+    const usize end = Utils::FindLineEnd(m_Data, m_Size);
+    BasicStringView line(m_Data, end);
+
+    if (line.m_Size && line.Back() == T('\r')) {
+        line.m_Size--;
+    }
+
+    this->RemovePrefix(end < m_Size ? end + 1 : end);
+    return line;
 }
 
 using StringView = BasicStringView<char>;
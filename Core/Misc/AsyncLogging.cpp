@@ -0,0 +1,556 @@
+#include "AsyncLogging.hpp"
+#include <algorithm>
+#include <time.h>
+
+TRE_NS_START
+
+void ConsoleLogSink::Write(Log::LogType type, const char* line, usize length)
+{
+	const char* color = NULL;
+
+	if (colors) {
+		color = type == Log::WARN || type == Log::DEBUG_INFO ? "\033[93m" : type == Log::ERR || type == Log::FATAL || type == Log::ASSERT ? "\033[91m" : NULL;
+	}
+
+	if (color) {
+		fputs(color, stdout);
+		fwrite(line, 1, length - 1, stdout);
+		fputs("\033[0m\n", stdout);
+	} else {
+		fwrite(line, 1, length, stdout);
+	}
+}
+
+void ConsoleLogSink::Flush()
+{
+	fflush(stdout);
+}
+
+FileLogSink::FileLogSink(const char* path, bool append) : file(fopen(path, append ? "ab" : "wb"))
+{
+}
+
+FileLogSink::~FileLogSink()
+{
+	if (file) {
+		fclose(file);
+	}
+}
+
+void FileLogSink::Write(Log::LogType, const char* line, usize length)
+{
+	if (file) {
+		fwrite(line, 1, length, file);
+	}
+}
+
+void FileLogSink::Flush()
+{
+	if (file) {
+		fflush(file);
+	}
+}
+
+RotatingFileLogSink::RotatingFileLogSink(const char* path, usize maxSize, uint32 maxFiles) :
+	path(path), maxSize(maxSize), maxFiles(maxFiles), size(0)
+{
+	file = fopen(path, "ab");
+
+	if (file) {
+		fseek(file, 0, SEEK_END);
+		size = usize(ftell(file));
+	}
+}
+
+RotatingFileLogSink::~RotatingFileLogSink()
+{
+	if (file) {
+		fclose(file);
+	}
+}
+
+void RotatingFileLogSink::Write(Log::LogType, const char* line, usize length)
+{
+	if (size && size + length > maxSize) {
+		this->Rotate();
+	}
+
+	if (file) {
+		size += fwrite(line, 1, length, file);
+	}
+}
+
+void RotatingFileLogSink::Flush()
+{
+	if (file) {
+		fflush(file);
+	}
+}
+
+void RotatingFileLogSink::Rotate()
+{
+	if (file) {
+		fclose(file);
+	}
+
+	for (uint32 i = maxFiles; i > 0; i--) {
+		const std::string from = i > 1 ? path + "." + std::to_string(i - 1) : path;
+		const std::string to = path + "." + std::to_string(i);
+		remove(to.c_str());
+		rename(from.c_str(), to.c_str());
+	}
+
+	remove(path.c_str());
+	file = fopen(path.c_str(), "wb");
+	size = 0;
+}
+
+struct AsyncLog::ThreadRing
+{
+	std::shared_ptr<Ring> ring;
+	uint32 generation = 0;
+
+	~ThreadRing()
+	{
+		if (ring) {
+			ring->closed.store(true, std::memory_order_release);
+		}
+	}
+};
+
+void AsyncLog::Start(const AsyncLogSettings& settings)
+{
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	if (state.running.load()) {
+		return;
+	}
+
+	uint32 ringSize = 256;
+
+	while (ringSize < settings.ringSize) {
+		ringSize <<= 1;
+	}
+
+	state.settings = settings;
+	state.settings.ringSize = ringSize;
+	state.generation++;
+	state.running.store(true);
+	state.thread = std::thread(&AsyncLog::Run, state.dropped.load());
+	Log::SetAsyncHooks(&AsyncLog::WriteFormatted, &AsyncLog::Flush);
+}
+
+void AsyncLog::Stop()
+{
+	State& state = GetState();
+	std::unique_lock<std::mutex> lock(state.mutex);
+
+	if (!state.running.load()) {
+		return;
+	}
+
+	Log::SetAsyncHooks(NULL, NULL);
+	state.running.store(false);
+	lock.unlock();
+	state.wakeUp.notify_all();
+	state.thread.join();
+}
+
+void AsyncLog::AddSink(std::unique_ptr<LogSink> sink)
+{
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.sinkMutex);
+	state.sinks.emplace_back(std::move(sink));
+}
+
+void AsyncLog::ClearSinks()
+{
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.sinkMutex);
+	state.sinks.clear();
+}
+
+void AsyncLog::Flush()
+{
+	State& state = GetState();
+	std::unique_lock<std::mutex> lock(state.mutex);
+
+	if (!state.running.load()) {
+		return;
+	}
+
+	const uint64 target = ++state.flushRequests;
+	state.wakeUp.notify_all();
+	state.flushed.wait(lock, [&]() { return state.flushedRequests >= target || !state.running.load(); });
+}
+
+uint8* AsyncLog::Ring::Reserve(uint32 size, bool block)
+{
+	size = (size + 7) & ~7u;
+	const uint64 offset = head & (capacity - 1);
+	const uint64 skip = offset + size > capacity ? capacity - offset : 0;
+
+	if (size + skip > capacity / 2) {
+		return NULL;
+	}
+
+	while (head + skip + size - cachedTail > capacity) {
+		cachedTail = tail.load(std::memory_order_acquire);
+
+		if (head + skip + size - cachedTail <= capacity) {
+			break;
+		}
+
+		if (!block || !GetState().running.load(std::memory_order_relaxed)) {
+			return NULL;
+		}
+
+		std::this_thread::yield();
+	}
+
+	if (skip) {
+		// The consumer jumps over the end of the ring when it reads a 0 size
+		*(uint32*)((uint8*)buffer.get() + offset) = 0;
+		head += skip;
+		sharedHead.store(head, std::memory_order_release);
+	}
+
+	return (uint8*)buffer.get() + (head & (capacity - 1));
+}
+
+const AsyncLog::RecordHeader* AsyncLog::Ring::Peek()
+{
+	const uint64 end = sharedHead.load(std::memory_order_acquire);
+	uint64 position = tail.load(std::memory_order_relaxed);
+
+	while (position != end) {
+		const RecordHeader* header = (const RecordHeader*)((const uint8*)buffer.get() + (position & (capacity - 1)));
+
+		if (header->size) {
+			return header;
+		}
+
+		position += capacity - (position & (capacity - 1));
+		tail.store(position, std::memory_order_release);
+	}
+
+	return NULL;
+}
+
+AsyncLog::State& AsyncLog::GetState()
+{
+	static State state;
+	return state;
+}
+
+AsyncLog::Ring* AsyncLog::GetThreadRing()
+{
+	static thread_local ThreadRing threadRing;
+	State& state = GetState();
+
+	// Rings are registered again after a restart, with its ring size
+	if (!threadRing.ring || threadRing.generation != state.generation) {
+		std::lock_guard<std::mutex> lock(state.mutex);
+
+		if (!state.running.load()) {
+			return NULL;
+		}
+
+		if (threadRing.ring) {
+			threadRing.ring->closed.store(true, std::memory_order_release);
+		}
+
+		threadRing.ring = std::make_shared<Ring>(state.settings.ringSize);
+		threadRing.generation = state.generation;
+		state.rings.push_back(threadRing.ring);
+	}
+
+	return threadRing.ring.get();
+}
+
+void AsyncLog::Run(uint64 reportedDrops)
+{
+	State& state = GetState();
+	std::vector<std::shared_ptr<Ring>> rings;
+	std::string line;
+
+	for (;;) {
+		uint64 flushTarget;
+		bool running;
+
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			rings = state.rings;
+			flushTarget = state.flushRequests;
+			running = state.running.load();
+		}
+
+		// Oldest record of all the rings first
+		uint32 written = 0;
+
+		for (;;) {
+			Ring* oldest = NULL;
+			const RecordHeader* record = NULL;
+
+			for (const std::shared_ptr<Ring>& ring : rings) {
+				const RecordHeader* header = ring->Peek();
+
+				if (header && (!record || header->time < record->time)) {
+					oldest = ring.get();
+					record = header;
+				}
+			}
+
+			if (!record) {
+				break;
+			}
+
+			FormatRecord(record, line);
+			WriteLine(Log::LogType(record->type), Channel(record->channel), line);
+			oldest->Pop(record);
+			written++;
+		}
+
+		const uint64 dropped = state.dropped.load(std::memory_order_relaxed);
+
+		if (dropped != reportedDrops) {
+			char message[64];
+			snprintf(message, sizeof(message), "%llu log messages dropped", (unsigned long long)(dropped - reportedDrops));
+			reportedDrops = dropped;
+			line.clear();
+			AppendPrefix(Log::WARN, ENGINE, uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()), line);
+			line += message;
+			line += '\n';
+			WriteLine(Log::WARN, ENGINE, line);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(state.mutex);
+
+			// Rings of exited threads are read one last time above before they go
+			state.rings.erase(std::remove_if(state.rings.begin(), state.rings.end(), [](const std::shared_ptr<Ring>& ring) {
+				return ring->closed.load(std::memory_order_acquire) && ring->IsEmpty();
+			}), state.rings.end());
+
+			if (flushTarget > state.flushedRequests || !running) {
+				lock.unlock();
+				FlushSinks();
+				lock.lock();
+				state.flushedRequests = flushTarget > state.flushedRequests ? flushTarget : state.flushedRequests;
+				state.flushed.notify_all();
+			}
+
+			if (!running) {
+				state.rings.clear();
+				return;
+			}
+
+			if (!written && state.flushRequests == flushTarget && state.running.load()) {
+				state.wakeUp.wait_for(lock, std::chrono::microseconds(state.settings.pollIntervalUs));
+			}
+		}
+	}
+}
+
+void AsyncLog::WriteLine(Log::LogType type, Channel channel, const std::string& line)
+{
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.sinkMutex);
+
+	if (state.sinks.empty()) {
+		// The renderer's lines were always colored, the engine's never
+		ConsoleLogSink(channel == RENDERER).Write(type, line.data(), line.size());
+		return;
+	}
+
+	for (const std::unique_ptr<LogSink>& sink : state.sinks) {
+		sink->Write(type, line.data(), line.size());
+	}
+}
+
+void AsyncLog::FlushSinks()
+{
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.sinkMutex);
+
+	if (state.sinks.empty()) {
+		fflush(stdout);
+	}
+
+	for (const std::unique_ptr<LogSink>& sink : state.sinks) {
+		sink->Flush();
+	}
+}
+
+void AsyncLog::WriteFormatted(Log::LogType type, const char* message)
+{
+	AsyncLog::Write(type, "%s", message);
+}
+
+void AsyncLog::AppendPrefix(Log::LogType type, Channel channel, uint64 time, std::string& out)
+{
+	char prefix[96];
+
+	if (channel == RENDERER) {
+		snprintf(prefix, sizeof(prefix), "[TRE][RENDERER] (%s): ", Log::GetStringFromLogType(type));
+	} else {
+		const time_t seconds = time_t(time / 1000000000ull);
+		struct tm tm = *localtime(&seconds);
+		char date[26];
+		strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm);
+		snprintf(prefix, sizeof(prefix), "[%s] [TrikytaEngine][%s]: ", date, Log::GetStringFromLogType(type));
+	}
+
+	out += prefix;
+}
+
+void AsyncLog::FormatRecord(const RecordHeader* header, std::string& line)
+{
+	line.clear();
+	AppendPrefix(Log::LogType(header->type), Channel(header->channel), header->time, line);
+	FormatMessage(header, line);
+	line += '\n';
+}
+
+/*
+ * Every conversion is printed on its own with snprintf, its length modifier replaced by the width the argument was
+ * stored with.
+ */
+void AsyncLog::FormatMessage(const RecordHeader* header, std::string& out)
+{
+	const uint8* data = (const uint8*)header + sizeof(RecordHeader);
+	uint32 remaining = header->argCount;
+	const char* format = header->format;
+	char spec[32];
+	char buffer[256];
+
+	auto next = [&](uint8& type, uint64& value, const char*& string) {
+		if (!remaining) {
+			return false;
+		}
+
+		remaining--;
+		type = data[0];
+		memcpy(&value, data + 8, 8);
+		string = type == STRING ? (const char*)data + ARGUMENT_SIZE : NULL;
+		data += type == STRING ? ARGUMENT_SIZE + ((value + 1 + 7) & ~uint64(7)) : ARGUMENT_SIZE;
+		return true;
+	};
+
+	auto asInt = [](uint8 type, uint64 value) {
+		if (type == FLOAT) {
+			double d;
+			memcpy(&d, &value, 8);
+			return (long long)d;
+		}
+
+		return (long long)value;
+	};
+
+	while (*format) {
+		const char* percent = strchr(format, '%');
+
+		if (!percent) {
+			out += format;
+			break;
+		}
+
+		out.append(format, percent - format);
+		const char* c = percent + 1;
+
+		if (*c == '%') {
+			out += '%';
+			format = c + 1;
+			continue;
+		}
+
+		// Flags, width and precision are kept, '*' replaced by its argument
+		usize length = 0;
+		spec[length++] = '%';
+
+		while (*c && strchr("-+ #0", *c) && length < 8) {
+			spec[length++] = *c++;
+		}
+
+		for (uint32 part = 0; part < 2; part++) {
+			if (part == 1) {
+				if (*c != '.') {
+					break;
+				}
+
+				spec[length++] = *c++;
+			}
+
+			if (*c == '*') {
+				uint8 type; uint64 value; const char* string;
+				const long long star = next(type, value, string) ? asInt(type, value) : 0;
+				length += snprintf(spec + length, 12, "%lld", star);
+				c++;
+			} else {
+				while (*c >= '0' && *c <= '9' && length < 24) {
+					spec[length++] = *c++;
+				}
+			}
+		}
+
+		while (*c && strchr("hlLqjzt", *c)) {
+			c++;
+		}
+
+		const char conversion = *c;
+		format = conversion ? c + 1 : c;
+
+		uint8 type;
+		uint64 value;
+		const char* string;
+
+		if (!conversion || !next(type, value, string)) {
+			out += "(missing)";
+			continue;
+		}
+
+		int written = 0;
+		const usize start = out.size();
+
+		if (strchr("diouxXc", conversion)) {
+			if (conversion != 'c') {
+				spec[length++] = 'l';
+				spec[length++] = 'l';
+			}
+
+			spec[length++] = conversion;
+			spec[length] = 0;
+			written = conversion == 'c' ? snprintf(buffer, sizeof(buffer), spec, int(asInt(type, value))) : snprintf(buffer, sizeof(buffer), spec, asInt(type, value));
+		} else if (strchr("feEgGaA", conversion)) {
+			double d = double((long long)value);
+
+			if (type == FLOAT) {
+				memcpy(&d, &value, 8);
+			} else if (type == UNSIGNED) {
+				d = double(value);
+			}
+
+			spec[length++] = conversion;
+			spec[length] = 0;
+			written = snprintf(buffer, sizeof(buffer), spec, d);
+		} else if (conversion == 's' && type == STRING) {
+			spec[length++] = 's';
+			spec[length] = 0;
+			written = snprintf(NULL, 0, spec, string);
+			out.resize(start + written + 1);
+			snprintf(&out[start], written + 1, spec, string);
+			out.resize(start + written);
+			continue;
+		} else if (conversion == 'p') {
+			written = snprintf(buffer, sizeof(buffer), "%p", (void*)uintptr_t(value));
+		} else {
+			out += "(invalid)";
+			continue;
+		}
+
+		out.append(buffer, written < int(sizeof(buffer)) ? usize(written) : sizeof(buffer) - 1);
+	}
+}
+
+TRE_NS_END
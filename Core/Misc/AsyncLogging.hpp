@@ -0,0 +1,409 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <Core/Misc/Defines/Common.hpp>
+#include <Core/Misc/Logging.hpp>
+
+// Calls below this severity compile to nothing: 0 debug, 1 info, 2 warnings, 3 errors, 4 fatal and asserts
+#if !defined(TRE_LOG_MIN_SEVERITY)
+	#if defined(_DEBUG) && !defined(NDEBUG)
+		#define TRE_LOG_MIN_SEVERITY 0
+	#else
+		#define TRE_LOG_MIN_SEVERITY 1
+	#endif
+#endif
+
+// Logs through AsyncLog when the severity of type passes TRE_LOG_MIN_SEVERITY, the arguments aren't evaluated otherwise
+#define TRE_ALOG(type, ...) \
+	TRE_ALOG_CHANNEL(TRE::AsyncLog::ENGINE, type, __VA_ARGS__)
+
+// Same with the line prefix of channel
+#define TRE_ALOG_CHANNEL(channel, type, ...) \
+	do { if constexpr (TRE::AsyncLog::IsEnabled(type)) { TRE::AsyncLog::Write(channel, type, __VA_ARGS__); } } while (0)
+
+TRE_NS_START
+
+class LogSink
+{
+public:
+	virtual ~LogSink() = default;
+
+	// line is a whole formatted line, new line included
+	virtual void Write(Log::LogType type, const char* line, usize length) = 0;
+
+	virtual void Flush() {}
+};
+
+// Warnings and debug messages in yellow, errors in red
+class ConsoleLogSink : public LogSink
+{
+public:
+	ConsoleLogSink(bool colors = true) : colors(colors) {}
+
+	void Write(Log::LogType type, const char* line, usize length) override;
+
+	void Flush() override;
+private:
+	bool colors;
+};
+
+class FileLogSink : public LogSink
+{
+public:
+	FileLogSink(const char* path, bool append = true);
+
+	~FileLogSink() override;
+
+	void Write(Log::LogType type, const char* line, usize length) override;
+
+	void Flush() override;
+
+	FORCEINLINE bool IsOpen() const { return file != NULL; }
+private:
+	FILE* file;
+};
+
+// Starts a new file past maxSize bytes: path becomes path.1, path.1 becomes path.2... up to path.maxFiles
+class RotatingFileLogSink : public LogSink
+{
+public:
+	RotatingFileLogSink(const char* path, usize maxSize, uint32 maxFiles);
+
+	~RotatingFileLogSink() override;
+
+	void Write(Log::LogType type, const char* line, usize length) override;
+
+	void Flush() override;
+private:
+	void Rotate();
+private:
+	std::string path;
+	usize maxSize;
+	uint32 maxFiles;
+	usize size;
+	FILE* file;
+};
+
+struct AsyncLogSettings
+{
+	enum FullRingPolicy
+	{
+		BLOCK,  // Waits for the logging thread to make room
+		DROP,   // Drops the record, dropped records are counted and reported
+	};
+
+	uint32 ringSize = 64 * 1024;     // Per thread, rounded up to a power of two
+	FullRingPolicy policy = BLOCK;
+	uint32 pollIntervalUs = 1000;    // Sleep of the logging thread when all the rings are empty
+};
+
+/*
+ * Logging off the calling thread. Producers only write a compact record into a ring of their own: the format string
+ * pointer, a timestamp and the arguments in binary, strings copied. A background thread takes the records of all the
+ * rings in time order, formats them like Log::Write and hands the lines to the sinks, so lines are never interleaved
+ * and the callers never wait on the console or the disk.
+ *
+ * The rings are single producer single consumer and lock free, a thread takes a lock once only, when it first logs.
+ * Format strings must outlive the logger, string literals in practice. Until Start and after Stop, or with a full ring
+ * in BLOCK mode, the calling thread formats and writes to stdout itself.
+ */
+class AsyncLog
+{
+public:
+	CONSTEXPR static usize MAX_STRING_ARGUMENT = 1024;  // Longer string arguments are truncated
+
+	// Picks the line prefix
+	enum Channel : uint8
+	{
+		ENGINE,     // [date] [TrikytaEngine][TYPE]: like Log::Write
+		RENDERER,   // [TRE][RENDERER] (TYPE): like the renderer's printf logs, colored on stdout without sinks
+	};
+public:
+	static CONSTEXPR int32 GetSeverity(Log::LogType type)
+	{
+		return type == Log::DEBUG_INFO ? 0 : type == Log::WARN ? 2 : type == Log::ERR ? 3 : type == Log::FATAL || type == Log::ASSERT ? 4 : 1;
+	}
+
+	static CONSTEXPR bool IsEnabled(Log::LogType type) { return GetSeverity(type) >= TRE_LOG_MIN_SEVERITY; }
+
+	static void Start(const AsyncLogSettings& settings = AsyncLogSettings());
+
+	// Writes everything logged so far and joins the logging thread
+	static void Stop();
+
+	FORCEINLINE static bool IsRunning() { return GetState().running.load(std::memory_order_relaxed); }
+
+	// Sinks get the lines from the logging thread, or from the caller when it isn't running. stdout without any
+	static void AddSink(std::unique_ptr<LogSink> sink);
+
+	static void ClearSinks();
+
+	// Blocks until everything this thread logged before is written and the sinks flushed
+	static void Flush();
+
+	FORCEINLINE static uint64 GetDroppedCount() { return GetState().dropped.load(std::memory_order_relaxed); }
+
+	template<typename... Args>
+	FORCEINLINE static void Write(Log::LogType type, const char* format, const Args&... args)
+	{
+		AsyncLog::Write(ENGINE, type, format, args...);
+	}
+
+	template<typename... Args>
+	static void Write(Channel channel, Log::LogType type, const char* format, const Args&... args)
+	{
+		State& state = GetState();
+		[[maybe_unused]] usize lengths[sizeof...(Args) + 1] = { StringLength(args)... };
+		usize size = sizeof(RecordHeader);
+		usize i = 0;
+		((size += ArgumentSize(args, lengths[i++])), ...);
+
+		Ring* ring = state.running.load(std::memory_order_acquire) ? GetThreadRing() : NULL;
+		uint8* record = ring ? ring->Reserve(uint32(size), state.settings.policy == AsyncLogSettings::BLOCK) : NULL;
+		uint8 local[1024];
+		std::vector<uint8> heap;
+
+		if (!record) {
+			if (ring && state.settings.policy == AsyncLogSettings::DROP) {
+				state.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			// Not running or record larger than the ring: the caller formats it
+			if (size > sizeof(local)) {
+				heap.resize(size);
+			}
+
+			record = size > sizeof(local) ? heap.data() : local;
+		}
+
+		RecordHeader* header = (RecordHeader*)record;
+		header->size = uint32(size);
+		header->type = uint8(type);
+		header->argCount = uint8(sizeof...(Args));
+		header->channel = channel;
+		header->format = format;
+		header->time = uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+		[[maybe_unused]] uint8* data = record + sizeof(RecordHeader);
+		i = 0;
+		((data = EncodeArgument(data, args, lengths[i++])), ...);
+
+		if (record == local || record == heap.data()) {
+			std::string line;
+			FormatRecord(header, line);
+			WriteLine(type, channel, line);
+
+			if (type == Log::FATAL || type == Log::ASSERT) {
+				FlushSinks();
+			}
+
+			return;
+		}
+
+		ring->Commit(uint32(size));
+
+		// These precede a crash more often than not
+		if (type == Log::FATAL || type == Log::ASSERT) {
+			Flush();
+		}
+	}
+
+	// Formats a record like the logging thread does, for tests and tools
+	template<typename... Args>
+	static std::string Format(const char* format, const Args&... args)
+	{
+		[[maybe_unused]] usize lengths[sizeof...(Args) + 1] = { StringLength(args)... };
+		usize size = sizeof(RecordHeader);
+		usize i = 0;
+		((size += ArgumentSize(args, lengths[i++])), ...);
+
+		std::vector<uint8> record(size);
+		RecordHeader* header = (RecordHeader*)record.data();
+		header->size = uint32(size);
+		header->argCount = uint8(sizeof...(Args));
+		header->format = format;
+		[[maybe_unused]] uint8* data = record.data() + sizeof(RecordHeader);
+		i = 0;
+		((data = EncodeArgument(data, args, lengths[i++])), ...);
+
+		std::string message;
+		FormatMessage(header, message);
+		return message;
+	}
+private:
+	enum ArgumentType : uint8
+	{
+		SIGNED,
+		UNSIGNED,
+		FLOAT,
+		STRING,
+		POINTER,
+	};
+
+	// Followed by the arguments, a type byte and 8 bytes of value each, strings by their characters padded to 8 bytes
+	struct RecordHeader
+	{
+		uint32 size;     // Aligned to 8 bytes in the ring, 0 marks the unused end of the ring
+		uint8 type;
+		uint8 argCount;
+		uint8 channel;
+		uint8 padding;
+		const char* format;
+		uint64 time;     // Nanoseconds since the epoch
+	};
+
+	CONSTEXPR static usize ARGUMENT_SIZE = 16;
+
+	class Ring
+	{
+	public:
+		Ring(uint32 capacity) : buffer(new uint64[capacity / 8]), capacity(capacity), head(0), cachedTail(0), sharedHead(0), tail(0), closed(false) {}
+
+		// Contiguous space for size bytes, NULL when full and not blocking or when it would never fit
+		uint8* Reserve(uint32 size, bool block);
+
+		FORCEINLINE void Commit(uint32 size)
+		{
+			head += (size + 7) & ~7u;
+			sharedHead.store(head, std::memory_order_release);
+		}
+
+		// Oldest record, NULL when empty
+		const RecordHeader* Peek();
+
+		FORCEINLINE void Pop(const RecordHeader* header)
+		{
+			tail.store(tail.load(std::memory_order_relaxed) + ((header->size + 7) & ~7u), std::memory_order_release);
+		}
+
+		FORCEINLINE bool IsEmpty() const { return sharedHead.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed); }
+	private:
+		std::unique_ptr<uint64[]> buffer;
+		uint64 capacity;
+		uint64 head;        // Producer side, with its last view of the tail
+		uint64 cachedTail;
+		alignas(64) std::atomic<uint64> sharedHead;
+		alignas(64) std::atomic<uint64> tail;
+	public:
+		alignas(64) std::atomic<bool> closed; // Its thread exited, removed once empty
+	};
+
+	struct State
+	{
+		std::mutex mutex;
+		std::mutex sinkMutex;
+		std::condition_variable wakeUp;
+		std::condition_variable flushed;
+		std::vector<std::shared_ptr<Ring>> rings;
+		std::vector<std::unique_ptr<LogSink>> sinks;
+		std::thread thread;
+		AsyncLogSettings settings;
+		std::atomic<bool> running{ false };
+		std::atomic<uint64> dropped{ 0 };
+		uint64 flushRequests = 0;
+		uint64 flushedRequests = 0;
+		uint32 generation = 0;
+	};
+
+	// Owned by the thread, closes its ring when it exits
+	struct ThreadRing;
+
+	static State& GetState();
+
+	static Ring* GetThreadRing();
+
+	static void Run(uint64 reportedDrops);
+
+	static void WriteLine(Log::LogType type, Channel channel, const std::string& line);
+
+	static void FlushSinks();
+
+	// Log::Write when running, it formats its va_list itself and passes the message on
+	static void WriteFormatted(Log::LogType type, const char* message);
+
+	// Encoding, integers widened to 64 bits, enums as integers, char arrays and pointers as strings
+	template<typename T>
+	static FORCEINLINE usize StringLength(const T& arg)
+	{
+		typedef std::decay_t<T> D;
+
+		if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+			const char* string = arg;
+
+			if (!string) {
+				return 6; // (null)
+			}
+
+			const usize length = strlen(string);
+			return length < MAX_STRING_ARGUMENT ? length : MAX_STRING_ARGUMENT;
+		} else {
+			return 0;
+		}
+	}
+
+	template<typename T>
+	static FORCEINLINE usize ArgumentSize(const T&, usize length)
+	{
+		typedef std::decay_t<T> D;
+
+		if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+			return ARGUMENT_SIZE + ((length + 1 + 7) & ~usize(7));
+		} else {
+			return ARGUMENT_SIZE;
+		}
+	}
+
+	template<typename T>
+	static FORCEINLINE uint8* EncodeArgument(uint8* data, const T& arg, usize length)
+	{
+		typedef std::decay_t<T> D;
+		uint64 value = 0;
+
+		if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+			data[0] = STRING;
+			value = length;
+			memcpy(data + 8, &value, 8);
+			const char* string = arg;
+			memcpy(data + ARGUMENT_SIZE, string ? string : "(null)", length);
+			data[ARGUMENT_SIZE + length] = 0;
+			return data + ArgumentSize(arg, length);
+		} else if constexpr (std::is_floating_point_v<D>) {
+			const double d = double(arg);
+			data[0] = FLOAT;
+			memcpy(&value, &d, 8);
+		} else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+			data[0] = POINTER;
+			value = uint64(uintptr_t(arg));
+		} else if constexpr (std::is_enum_v<D>) {
+			data[0] = std::is_signed_v<std::underlying_type_t<D>> ? SIGNED : UNSIGNED;
+			value = uint64(int64(arg));
+		} else {
+			static_assert(std::is_integral_v<D>, "Log arguments are numbers, enums, pointers and C strings");
+			data[0] = std::is_signed_v<D> ? SIGNED : UNSIGNED;
+			value = std::is_signed_v<D> ? uint64(int64(arg)) : uint64(arg);
+		}
+
+		memcpy(data + 8, &value, 8);
+		return data + ARGUMENT_SIZE;
+	}
+
+	static void AppendPrefix(Log::LogType type, Channel channel, uint64 time, std::string& out);
+
+	static void FormatRecord(const RecordHeader* header, std::string& line);
+
+	// printf formatting from the decoded arguments
+	static void FormatMessage(const RecordHeader* header, std::string& out);
+};
+
+TRE_NS_END
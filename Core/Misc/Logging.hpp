@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
@@ -36,14 +37,45 @@ public:
 		va_end(arg);
 	}
 
+	typedef void (*AsyncWriteCallback)(LogType logtype, const char* message);
+	typedef void (*AsyncFlushCallback)();
+
+	// Set by AsyncLog while it runs: messages are still formatted by the caller but written by the logging thread
+	static void SetAsyncHooks(AsyncWriteCallback write, AsyncFlushCallback flush)
+	{
+		asyncFlush.store(flush, std::memory_order_release);
+		asyncWrite.store(write, std::memory_order_release);
+	}
+
+	FORCEINLINE static const char* GetStringFromLogType(LogType v) {
+		return logtype2str[v];
+	}
+
 private:
 	CONSTEXPR static const char* logtype2str[] = { "INFO", "WARNING", "ERROR", "FATAL", "ASSERT", "DEBUG", "DISPLAY", "OTHER" };
 	/* GREEN, YELLOW, RED, DARK RED, PURPLE, GREY, CYAN, DEFAULT*/
 	CONSTEXPR static const uint8 logtype2color[] = { 10, 14, 12, 4, 13, 8, 11, 15}; 
 	CONSTEXPR static const usize MAX_MESSAGE_BUFFER = 1024;
 
+	static inline std::atomic<AsyncWriteCallback> asyncWrite{ NULL };
+	static inline std::atomic<AsyncFlushCallback> asyncFlush{ NULL };
+
 	static void WriteHelper(LogType logtype, const char* msg, va_list ap)
 	{
+		const AsyncWriteCallback write = asyncWrite.load(std::memory_order_acquire);
+
+		if (write && logtype != FATAL && logtype != ASSERT) {
+			char message[MAX_MESSAGE_BUFFER];
+			vsnprintf(message, MAX_MESSAGE_BUFFER, msg, ap);
+			write(logtype, message);
+			return;
+		}
+
+		// Whatever is queued goes out first, the process may not live much longer
+		if (const AsyncFlushCallback flush = asyncFlush.load(std::memory_order_acquire)) {
+			flush();
+		}
+
 		char text_message_buffer[MAX_MESSAGE_BUFFER];
 		char log_message[MAX_MESSAGE_BUFFER];
 		char date_str[26];
@@ -56,10 +88,6 @@ private:
 		printf("%s\n", text_message_buffer);
 	}
 
-	FORCEINLINE static const char* GetStringFromLogType(LogType v) {
-		return logtype2str[v];
-	}
-
 	FORCEINLINE static uint8 GetColorFromLogType(LogType v) {
 		return logtype2color[v];
 	}
@@ -137,7 +137,7 @@ template<typename T, usize S>
 template<typename ...Args>
 FORCEINLINE void Array<T, S>::ConstructAt(usize i, Args&& ...args)
 {
-	ASSERTF((i >= CAPACITY || i >= m_Length), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(i < CAPACITY && i < m_Length, "Usage of PutAt with bad parameter index out of bound.");
 	m_Data[i] = T(std::forward<Args>(args)...);
 }
 
@@ -145,7 +145,7 @@ template<typename T, usize S>
 template<typename ...Args>
 FORCEINLINE void Array<T, S>::EmplaceBack(Args&& ...args)
 {
-	ASSERTF((m_Length > CAPACITY), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(m_Length <= CAPACITY, "Usage of PutAt with bad parameter index out of bound.");
 	if (m_Length > CAPACITY) return;
 	m_Data[m_Length++] = T(std::forward<Args>(args)...);
 }
@@ -178,14 +178,14 @@ FORCEINLINE void Array<T, S>::Fill(const T& obj)
 template<typename T, usize S>
 FORCEINLINE void Array<T, S>::PutAt(usize i, const T& obj)
 {
-	ASSERTF((i >= CAPACITY), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(i < CAPACITY, "Usage of PutAt with bad parameter index out of bound.");
 	m_Data[i] = obj;
 }
 
 template<typename T, usize S>
 FORCEINLINE void Array<T, S>::PushBack(const T& obj)
 {
-	ASSERTF((m_Length > CAPACITY), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(m_Length <= CAPACITY, "Usage of PutAt with bad parameter index out of bound.");
 	if (m_Length > CAPACITY) return;
 	m_Data[m_Length++] = obj;
 }
@@ -229,7 +229,7 @@ typename Array<T, S>::Iterator Array<T, S>::end() noexcept
 template<typename T, usize S>
 FORCEINLINE T& Array<T, S>::At(usize i)
 {
-	ASSERTF((i >= CAPACITY || i >= m_Length), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(i < CAPACITY && i < m_Length, "Usage of PutAt with bad parameter index out of bound.");
 	return m_Data[i];
 }
 
@@ -242,7 +242,7 @@ FORCEINLINE T& Array<T, S>::operator[](usize i)
 template<typename T, usize S>
 FORCEINLINE const T& Array<T, S>::At(usize i) const
 {
-	ASSERTF((i >= CAPACITY || i >= m_Length), "Usage of PutAt with bad parameter index out of bound.");
+	ASSERTF(i < CAPACITY && i < m_Length, "Usage of PutAt with bad parameter index out of bound.");
 	return m_Data[i];
 }
 
@@ -42,7 +42,7 @@ template<typename T, typename Alloc_t>
 FORCEINLINE T& BinarySearchTree<T, Alloc_t>::FindMin() const
 {
 	BTLeaf* res = this->FindMinHelper(BTree::m_Root);
-	ASSERTF((res == NULL), "Attempt to search an empty tree!");
+	ASSERTF(res != NULL, "Attempt to search an empty tree!");
 	return res->element;
 }
 
@@ -50,7 +50,7 @@ template<typename T, typename Alloc_t>
 FORCEINLINE T& BinarySearchTree<T, Alloc_t>::FindMax() const
 {
 	BTLeaf* res = this->FindMaxHelper(BTree::m_Root);
-	ASSERTF((res == NULL), "Attempt to search an empty tree!");
+	ASSERTF(res != NULL, "Attempt to search an empty tree!");
 	return res->element;
 }
 
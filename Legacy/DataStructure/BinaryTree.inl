@@ -51,7 +51,7 @@ FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::Get
 template<typename T, typename Alloc_t>
 FORCEINLINE void BinaryTree<T, Alloc_t>::RemoveRight(BTLeaf* cur)
 {
-	ASSERTF((cur == NULL), "Attempt to remove a null node!");
+	ASSERTF(cur != NULL, "Attempt to remove a null node!");
 	this->RemoveNode(cur->right);
 	cur->right = NULL;
 }
@@ -59,7 +59,7 @@ FORCEINLINE void BinaryTree<T, Alloc_t>::RemoveRight(BTLeaf* cur)
 template<typename T, typename Alloc_t>
 FORCEINLINE void BinaryTree<T, Alloc_t>::RemoveLeft(BTLeaf* cur)
 {
-	ASSERTF((cur == NULL), "Attempt to remove a null node!");
+	ASSERTF(cur != NULL, "Attempt to remove a null node!");
 	this->RemoveNode(cur->left);
 	cur->left = NULL;
 }
@@ -77,7 +77,7 @@ FORCEINLINE void BinaryTree<T, Alloc_t>::RemoveNode(BTLeaf* cur)
 template<typename T, typename Alloc_t>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::RightRotate(BTLeaf* parent, BTLeaf* cur)
 {
-	ASSERTF((parent == NULL || cur == NULL), "Attempt to perform rotation with NULL parent or NULL leaf!");
+	ASSERTF(parent != NULL && cur != NULL, "Attempt to perform rotation with NULL parent or NULL leaf!");
 	auto left = cur->left;
 	cur->left = left->right;
 	left->right = cur;
@@ -95,7 +95,7 @@ FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::Rig
 template<typename T, typename Alloc_t>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::LeftRotate(BTLeaf* parent, BTLeaf* cur)
 {
-	ASSERTF((parent == NULL || cur == NULL), "Attempt to perform rotation with NULL parent or NULL leaf!");
+	ASSERTF(parent != NULL && cur != NULL, "Attempt to perform rotation with NULL parent or NULL leaf!");
 	auto right = cur->right;
 	cur->right = right->left;
 	right->left = cur;
@@ -178,7 +178,7 @@ template<typename... Args>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf*  BinaryTree<T, Alloc_t>::InsertRight(BTLeaf* cur, Args&&... args)
 {
 	if (cur == NULL) cur = m_Root;
-	ASSERTF((m_Root == NULL), "Attempt to insert in a tree with a NULL root!");
+	ASSERTF(m_Root != NULL, "Attempt to insert in a tree with a NULL root!");
 	/*if (cur == NULL) {
 		this->SetRoot(std::forward<Args>(args)...);
 		return;
@@ -193,7 +193,7 @@ template<typename... Args>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf*  BinaryTree<T, Alloc_t>::InsertLeft(BTLeaf* cur, Args&&... args)
 {
 	if (cur == NULL) cur = m_Root;
-	ASSERTF((m_Root == NULL), "Attempt to insert in a tree with a NULL root!");
+	ASSERTF(m_Root != NULL, "Attempt to insert in a tree with a NULL root!");
 	/*if (cur == NULL) {
 		this->SetRoot(std::forward<Args>(args)...);
 		return;
@@ -220,7 +220,7 @@ template<typename T, typename Alloc_t>
 template<typename... Args>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::InsertTopRight(Args&& ...args)
 {
-	ASSERTF((m_Root == NULL), "Attempt to insert in a tree with a NULL root!");
+	ASSERTF(m_Root != NULL, "Attempt to insert in a tree with a NULL root!");
 	BTLeaf* cur = m_Root;
 	while (cur->right != NULL) {
 		cur = cur->right;
@@ -234,7 +234,7 @@ template<typename T, typename Alloc_t>
 template<typename... Args>
 FORCEINLINE typename BinaryTree<T, Alloc_t>::BTLeaf* BinaryTree<T, Alloc_t>::InsertTopLeft(Args&& ...args)
 {
-	ASSERTF((m_Root == NULL), "Attempt to insert in a tree with a NULL root!");
+	ASSERTF(m_Root != NULL, "Attempt to insert in a tree with a NULL root!");
 	BTLeaf* cur = m_Root;
 	while (cur->left != NULL) {
 		cur = cur->left;
@@ -85,11 +85,11 @@ Bitset::BitsBlock Bitset::operator[](usize index)
 	int32 rest_of_bits = ((uint32)index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
 
 	if (is_small) {
-		ASSERTF((index >= this->GetSmallLength()), "Bitset index out of range");
+		ASSERTF(index < this->GetSmallLength(), "Bitset index out of range");
 		return BitsBlock(m_Data[nb_byte_to_look_at], rest_of_bits);
 	}
 
-	ASSERTF((index >= this->GetNormalLength()), "Bitset index out of range");
+	ASSERTF(index < this->GetNormalLength(), "Bitset index out of range");
 	return BitsBlock(*((uint8*)m_Bits + nb_byte_to_look_at), rest_of_bits);
 }
 
@@ -98,14 +98,14 @@ bool Bitset::Get(usize index) const
 	bool is_small = this->IsSmall();
 
 	if (is_small) {
-		ASSERTF((index >= this->GetSmallLength()), "Bitset index out of range");
+		ASSERTF(index < this->GetSmallLength(), "Bitset index out of range");
 
 		uint32 nb_byte_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(uint8) * BITS_PER_BYTE));
 		int32 rest_of_bits = ((uint32)index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
 		return m_Data[nb_byte_to_look_at] & (uint16(1) << (rest_of_bits));
 	}
 
-	ASSERTF((index >= this->GetNormalLength()), "Bitset index out of range");
+	ASSERTF(index < this->GetNormalLength(), "Bitset index out of range");
 
 	uint32 nb_of_usize_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(usize) * BITS_PER_BYTE));
 	int32 rest_of_bits = int32(index - nb_of_usize_to_look_at * sizeof(usize) * BITS_PER_BYTE);
@@ -118,7 +118,7 @@ void Bitset::Set(usize index, bool value) // TODO!
 	bool is_small = this->IsSmall();
 
 	if (is_small) {
-		ASSERTF((index >= this->GetSmallLength()), "Bitset index out of range");
+		ASSERTF(index < this->GetSmallLength(), "Bitset index out of range");
 
 		uint32 nb_byte_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(uint8) * BITS_PER_BYTE));
 		int32 rest_of_bits = ((uint32)index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
@@ -126,7 +126,7 @@ void Bitset::Set(usize index, bool value) // TODO!
 		return;
 	}
 
-	ASSERTF((index >= this->GetNormalLength()), "Bitset index out of range");
+	ASSERTF(index < this->GetNormalLength(), "Bitset index out of range");
 
 	uint32 nb_of_usize_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(usize) * BITS_PER_BYTE));
 	int32 rest_of_bits = int32(index - nb_of_usize_to_look_at * sizeof(usize) * BITS_PER_BYTE);
@@ -138,7 +138,7 @@ void Bitset::Toggle(usize index)
 	bool is_small = this->IsSmall();
 
 	if (is_small) {
-		ASSERTF((index >= this->GetSmallLength()), "Bitset index out of range");
+		ASSERTF(index < this->GetSmallLength(), "Bitset index out of range");
 
 		uint32 nb_byte_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(uint8) * BITS_PER_BYTE));
 		int32 rest_of_bits = ((uint32)index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
@@ -146,7 +146,7 @@ void Bitset::Toggle(usize index)
 		return;
 	}
 
-	ASSERTF((index >= this->GetNormalLength()), "Bitset index out of range");
+	ASSERTF(index < this->GetNormalLength(), "Bitset index out of range");
 
 	uint32 nb_of_usize_to_look_at = (uint32)Math::Floor((double)index / (double)(sizeof(usize) * BITS_PER_BYTE));
 	int32 rest_of_bits = int32(index - nb_of_usize_to_look_at * sizeof(usize) * BITS_PER_BYTE);
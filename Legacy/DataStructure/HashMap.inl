@@ -342,7 +342,7 @@ template<typename K, typename V, usize S>
 FORCEINLINE V& HashMap<K, V, PROBING, S>::operator[](const K& key) const
 {
 	V* ptr = this->GetKeyPtr(key);
-	ASSERTF(ptr == NULL, "Attempt to access element at an invalid key.");
+	ASSERTF(ptr != NULL, "Attempt to access element at an invalid key.");
 	return *ptr;
 }
 
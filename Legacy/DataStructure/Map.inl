@@ -74,7 +74,7 @@ template<typename K, typename V, typename Alloc_t>
 FORCEINLINE const V& Map<K, V, Alloc_t>::operator[](const K& key) const
 {
 	V* value = this->Get(key);
-	ASSERTF(value == NULL, "Key not found!");
+	ASSERTF(value != NULL, "Key not found!");
 	return *value;
 }
 
@@ -119,7 +119,7 @@ T& PackedArray<T>::Get(ID id) const
 	Index* indices = this->GetIndexArray();
 	Index& in = indices[id];
 
-	ASSERTF(in.index == INVALID_INDEX, "Invalid ID supplied to the PackedArray:Get().\n");
+	ASSERTF(in.index != INVALID_INDEX, "Invalid ID supplied to the PackedArray:Get().\n");
 	return m_Objects[in.index].second;
 }
 
@@ -20,7 +20,7 @@ void StaticBitset<N>::Fill(bool bit)
 template<uint32 N>
 typename StaticBitset<N>::BitsBlock StaticBitset<N>::operator[](uint32 index)
 {
-	ASSERTF(index >= N, "StaticBitset<N> index out of range");
+	ASSERTF(index < N, "StaticBitset<N> index out of range");
 	uint32 nb_byte_to_look_at = Math::DivFloor(index, sizeof(uint8) * BITS_PER_BYTE);
 	int32 rest_of_bits = (index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
 	return BitsBlock(m_Bits[nb_byte_to_look_at], rest_of_bits);
@@ -29,7 +29,7 @@ typename StaticBitset<N>::BitsBlock StaticBitset<N>::operator[](uint32 index)
 template<uint32 N>
 bool StaticBitset<N>::Get(uint32 index) const
 {
-	ASSERTF(index >= N, "Get() index out of range");
+	ASSERTF(index < N, "Get() index out of range");
 	uint32 nb_byte_to_look_at = Math::DivFloor(index, sizeof(uint8) * BITS_PER_BYTE);
 	int32 rest_of_bits = (index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
 	return m_Bits[nb_byte_to_look_at] & (uint16(1) << (rest_of_bits));
@@ -38,7 +38,7 @@ bool StaticBitset<N>::Get(uint32 index) const
 template<uint32 N>
 void StaticBitset<N>::Set(uint32 index, bool value) // TODO!
 {
-	ASSERTF((index >= N), "StaticBitset<N> index out of range");
+	ASSERTF(index < N, "StaticBitset<N> index out of range");
 
 	uint32 nb_byte_to_look_at = Math::DivFloor(index, sizeof(uint8) * BITS_PER_BYTE);
 	int32 rest_of_bits = (index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
@@ -49,7 +49,7 @@ void StaticBitset<N>::Set(uint32 index, bool value) // TODO!
 template<uint32 N>
 void StaticBitset<N>::Toggle(uint32 index)
 {
-	ASSERTF((index >= N), "StaticBitset<N> index out of range");
+	ASSERTF(index < N, "StaticBitset<N> index out of range");
 
 	uint32 nb_byte_to_look_at = Math::DivFloor(index, sizeof(uint8) * BITS_PER_BYTE);
 	int32 rest_of_bits = (index - nb_byte_to_look_at * sizeof(uint8) * BITS_PER_BYTE);
@@ -271,7 +271,7 @@ template<typename T>
 template<typename NUMERIC_TYPE>
 T& BasicString2<T>::operator[] (const NUMERIC_TYPE i)
 {
-    ASSERTF((usize)i > (usize)m_Length, "Bad usage of [] with BasicString2 class, given index out of bounds.");
+    ASSERTF((usize)i <= (usize)m_Length, "Bad usage of [] with BasicString2 class, given index out of bounds.");
 	return this->EditableBuffer()[i];
 }
 
@@ -279,7 +279,7 @@ template<typename T>
 template<typename NUMERIC_TYPE>
 const T& BasicString2<T>::operator[] (const NUMERIC_TYPE i) const
 {
-    ASSERTF((usize)i > (usize)m_Length, "Bad usage of [] with BasicString2 class, given index out of bounds.");
+    ASSERTF((usize)i <= (usize)m_Length, "Bad usage of [] with BasicString2 class, given index out of bounds.");
 	return this->Buffer()[i];
 }
 
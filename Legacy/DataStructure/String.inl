@@ -95,7 +95,7 @@ void BasicString2<T>::Resize(usize s)
 	if (s == len) return;
 	bool isSmall = this->IsSmall();
 	if (s < len) {
-		ASSERTF(len - s < 0, "String::Resize function is used with bad parameter.");
+		ASSERTF(len >= s, "String::Resize function is used with bad parameter.");
 		if (isSmall) {
 			usize nlen = (len - s); // new len remmber that len does represent whats rest in the buffer (when SSO is enabled)
 			SetSmallLength(nlen);
@@ -198,7 +198,7 @@ void BasicString2<T>::Append(const char* str)
 template<typename T>
 INLINE T BasicString2<T>::At(usize i) const
 {
-	ASSERTF((i > Length()), "Bad usage of String::At (index out of bound).");
+	ASSERTF(i <= Length(), "Bad usage of String::At (index out of bound).");
 	return this->Buffer()[i];
 }
 
@@ -53,7 +53,7 @@ public:
 
 	FORCEINLINE T& operator[](uint32 i) { return m_Buffer[i]; }
 
-	FORCEINLINE const T& operator[](uint32 i) const { ASSERTF((i >= m_Length), "The given index point outside the buffer"); return m_Buffer[i]; }
+	FORCEINLINE const T& operator[](uint32 i) const { ASSERTF(i < m_Length, "The given index point outside the buffer"); return m_Buffer[i]; }
 
 	FORCEINLINE StringBuffer<T>& operator+=(const StringBuffer<T>& str) { return this->Append(str); };
 
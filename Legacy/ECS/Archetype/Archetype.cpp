@@ -132,6 +132,15 @@ void Archetype::PushFreeChunk(ArchetypeChunk* chunk)
 	m_FreeChunks = chunk;
 }
 
+void Archetype::ReleaseAllChunks()
+{
+	// Components must have been moved out or destroyed by the caller
+	while (m_OccupiedChunks) {
+		m_OccupiedChunks->m_EntitiesCount = 0;
+		this->PushFreeChunk(m_OccupiedChunks);
+	}
+}
+
 bool Archetype::HasComponentType(ComponentTypeID id) const
 {
 	return m_Signature.Get(id);
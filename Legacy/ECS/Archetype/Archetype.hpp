@@ -37,6 +37,8 @@ public:
 
 	ArchetypeChunk* GetLastOccupiedChunk();
 
+	void ReleaseAllChunks();
+
 	EntityManager& GetEntityManager() const;
 
 	FORCEINLINE uint32 GetID() { return m_Id; }
@@ -70,7 +70,6 @@ ArchetypeChunk* ArchetypeChunk::SwapEntityWithLastOne(uint32 entity_internal_id)
 		Entity* last_entity = last_chunk->GetEntity(last_chunk->m_EntitiesCount - 1);
 
 		if (last_entity) {
-			((EntityID*)m_ComponentBuffer)[last_entity->m_InternalId] = 0;
 			((EntityID*)m_ComponentBuffer)[entity_internal_id] = last_entity->m_Id;
 			last_entity->m_InternalId = entity_internal_id;
 			last_entity->m_Chunk = this;
@@ -113,7 +112,7 @@ void ArchetypeChunk::DestroyComponentInternal(ArchetypeChunk* last_chunk, Compon
 	BaseComponent* destComponent = (BaseComponent*) &components_buffer[internal_id * size];
 	freefn(destComponent); // call dtor
 
-	if (m_EntitiesCount > 1)
+	if (last_chunk == this && internal_id == last_chunk->m_EntitiesCount) // Removed entity was the last one
 		return;
 
 	usize srcIndex = size * last_chunk->m_EntitiesCount;
@@ -126,7 +125,7 @@ void ArchetypeChunk::RemoveComponentInternal(ArchetypeChunk* last_chunk, Compone
 	uint32 size = BaseComponent::GetTypeSize(type_id);
 	BaseComponent* destComponent = (BaseComponent*) &components_buffer[internal_id * size];
 
-	if (m_EntitiesCount > 1)
+	if (last_chunk == this && internal_id == last_chunk->m_EntitiesCount) // Removed entity was the last one
 		return;
 
 	usize srcIndex = size * last_chunk->m_EntitiesCount;
@@ -160,6 +159,63 @@ void ArchetypeChunk::AddEntityComponents(Entity& entity, BaseComponent** compone
 	}
 }
 
+uint32 ArchetypeChunk::MoveEntitiesFrom(ArchetypeChunk& src, uint32 src_index, uint32 count)
+{
+	ASSERTF(count <= this->GetFreeSlotsCount(), "Not enough free slots in the chunk to move the entities.");
+	ASSERTF(src_index + count <= src.m_EntitiesCount, "Invalid range supplied to MoveEntitiesFrom.");
+	const uint32 first = m_EntitiesCount;
+	EntityID* dst_ids = (EntityID*)m_ComponentBuffer + first;
+	::std::memcpy(dst_ids, (EntityID*)src.m_ComponentBuffer + src_index, sizeof(EntityID) * count);
+
+	// Relocate every column shared by both archetypes in one go, components are relocated bitwise
+	// exactly like the single entity path does when it swaps with the last entity.
+	const Archetype& src_arche = *src.m_Archetype;
+
+	for (auto& c : m_Archetype->GetTypesBufferMarker()) {
+		if (!src_arche.HasComponentType(c.first))
+			continue;
+
+		uint32 size = BaseComponent::GetTypeSize(c.first);
+		uint8* dst_buffer = this->GetComponentsBuffer() + c.second + first * size;
+		uint8* src_buffer = src.GetComponentBuffer(c.first) + src_index * size;
+		::std::memcpy(dst_buffer, src_buffer, (usize)size * count);
+	}
+
+	EntityManager& manager = m_Archetype->GetEntityManager();
+
+	for (uint32 i = 0; i < count; i++) {
+		manager.GetEntityByID(dst_ids[i]).AttachToArchetypeChunk(this, first + i);
+	}
+
+	m_EntitiesCount += count;
+	return first;
+}
+
+void ArchetypeChunk::ConstructComponents(ComponentTypeID component_id, BaseComponent* component, uint32 first, uint32 count)
+{
+	if (!count)
+		return;
+
+	ComponentCreateFunction createfn = BaseComponent::GetTypeCreateFunction(component_id);
+	uint32 size = BaseComponent::GetTypeSize(component_id);
+	uint8* buffer = this->GetComponentBuffer(component_id) + first * size;
+
+	for (uint32 i = 0; i < count; i++) {
+		createfn(&buffer[i * size], component);
+	}
+}
+
+void ArchetypeChunk::DestroyComponents(ComponentTypeID component_id, uint32 first, uint32 count)
+{
+	ComponentDeleteFunction freefn = BaseComponent::GetTypeDeleteFunction(component_id);
+	uint32 size = BaseComponent::GetTypeSize(component_id);
+	uint8* buffer = this->GetComponentBuffer(component_id) + first * size;
+
+	for (uint32 i = 0; i < count; i++) {
+		freefn((BaseComponent*) &buffer[i * size]);
+	}
+}
+
 uint32 ArchetypeChunk::ReserveEntity(const Entity& entity)
 {
 	((EntityID*)m_ComponentBuffer)[m_EntitiesCount] = entity.m_Id;
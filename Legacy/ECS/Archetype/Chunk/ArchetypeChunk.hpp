@@ -45,6 +45,12 @@ public:
 
 	uint32 DestroyEntityComponents(Entity& entity);
 
+	uint32 MoveEntitiesFrom(ArchetypeChunk& src, uint32 src_index, uint32 count);
+
+	void ConstructComponents(ComponentTypeID component_id, BaseComponent* component, uint32 first, uint32 count);
+
+	void DestroyComponents(ComponentTypeID component_id, uint32 first, uint32 count);
+
 	uint8* GetComponentBuffer(ComponentTypeID id) const;
 
 	uint8* GetComponentsBuffer() const;
@@ -55,6 +61,8 @@ public:
 
 	FORCEINLINE uint32 GetEntitiesCount() const { return m_EntitiesCount; }
 
+	FORCEINLINE uint32 GetFreeSlotsCount() const { return CAPACITY - m_EntitiesCount; }
+
 	EntityID& GetEntityID(uint32 internal_id) const;
 
 	template<typename Component>
@@ -90,6 +98,8 @@ private:
 	ArchetypeChunk* SwapEntityWithLastOne(uint32 entity_internal_id);
 
 	uint32 ReserveEntity(const Entity& entity);
+
+	friend class Archetype;
 };
 
 template<typename Component>
@@ -129,14 +139,14 @@ FORCEINLINE ArchetypeChunkIterator<EntityID> ArchetypeChunk::EntityIterator() co
 template<typename Component>
 FORCEINLINE Component& ArchetypeChunk::GetComponentByInternalID(uint32 id)
 {
-	ASSERTF(id >= m_EntitiesCount, "Invalid internal ID supplied to the chunk.");
+	ASSERTF(id < m_EntitiesCount, "Invalid internal ID supplied to the chunk.");
 	return *(Component*)(this->GetComponentBuffer(Component::ID) + BaseComponent::GetTypeSize(Component::ID) * id);
 }
 
 template<typename Component>
 FORCEINLINE Component& ArchetypeChunk::GetComponentByInternalID(uint32 id) const
 {
-	ASSERTF(id >= m_EntitiesCount, "Invalid internal ID supplied to the chunk.");
+	ASSERTF(id < m_EntitiesCount, "Invalid internal ID supplied to the chunk.");
 	return *(Component*)(this->GetComponentBuffer(Component::ID) + BaseComponent::GetTypeSize(Component::ID) * id);
 }
 
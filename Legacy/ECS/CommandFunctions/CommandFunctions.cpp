@@ -1,16 +1,71 @@
 #include "CommandFunctions.hpp"
-//#include <Legacy/ECS/Commands/Commands.hpp>
-//#include <Legacy/ECS/World/World.hpp>
+#include <Legacy/ECS/Commands/Commands.hpp>
+#include <Legacy/ECS/World/World.hpp>
 
 TRE_NS_START
 
 void CommandFunctions::RemoveComponent(const void* data)
 {
-	/*const ECSCommands::RemoveComponentCmd* real_data = reinterpret_cast<const ECSCommands::RemoveComponentCmd*>(data);
-		
+	const ECSCommands::RemoveComponentCmd* real_data = reinterpret_cast<const ECSCommands::RemoveComponentCmd*>(data);
 	EntityManager& manager = real_data->word->GetEntityManager();
-	Entity& ent = manager.GetEntityByID(real_data->entity_id);
-	manager.RemoveComponentInternal(ent, real_data->component_type_id);*/
+	Entity* ent = manager.LookupEntity(real_data->entity_id);
+
+	if (ent)
+		manager.RemoveComponentInternal(*ent, real_data->component_type_id);
+}
+
+void CommandFunctions::AddComponent(const void* data)
+{
+	const ECSCommands::AddComponentCmd* real_data = reinterpret_cast<const ECSCommands::AddComponentCmd*>(data);
+	EntityManager& manager = real_data->world->GetEntityManager();
+	Entity* ent = manager.LookupEntity(real_data->entity_id);
+	BaseComponent* component = real_data->GetComponent();
+
+	if (ent)
+		manager.AddComponentInternal(*ent, real_data->component_type_id, component);
+
+	DestroyAddComponent(data);
+}
+
+void CommandFunctions::DeleteEntity(const void* data)
+{
+	const ECSCommands::DeleteEntityCmd* real_data = reinterpret_cast<const ECSCommands::DeleteEntityCmd*>(data);
+	real_data->world->GetEntityManager().DeleteEntity(real_data->entity_id);
+}
+
+void CommandFunctions::CreateEntities(const void* data)
+{
+	const ECSCommands::CreateEntitiesCmd* real_data = reinterpret_cast<const ECSCommands::CreateEntitiesCmd*>(data);
+	CONSTEXPR uint32 MAX_COMPONENTS = 64;
+	ASSERTF(real_data->num_components <= MAX_COMPONENTS, "Too many components supplied to the CreateEntities command.");
+
+	const ComponentTypeID* ids = real_data->GetComponentIDs();
+	const uint32* offsets = real_data->GetComponentOffsets();
+	BaseComponent* components[MAX_COMPONENTS];
+
+	for (uint32 i = 0; i < real_data->num_components; i++) {
+		components[i] = (BaseComponent*)((uint8*)data + offsets[i]);
+	}
+
+	real_data->world->GetEntityManager().CreateEntities(real_data->count, components, ids, real_data->num_components);
+	DestroyCreateEntities(data);
+}
+
+void CommandFunctions::DestroyAddComponent(const void* data)
+{
+	const ECSCommands::AddComponentCmd* real_data = reinterpret_cast<const ECSCommands::AddComponentCmd*>(data);
+	BaseComponent::GetTypeDeleteFunction(real_data->component_type_id)(real_data->GetComponent());
+}
+
+void CommandFunctions::DestroyCreateEntities(const void* data)
+{
+	const ECSCommands::CreateEntitiesCmd* real_data = reinterpret_cast<const ECSCommands::CreateEntitiesCmd*>(data);
+	const ComponentTypeID* ids = real_data->GetComponentIDs();
+	const uint32* offsets = real_data->GetComponentOffsets();
+
+	for (uint32 i = 0; i < real_data->num_components; i++) {
+		BaseComponent::GetTypeDeleteFunction(ids[i])((BaseComponent*)((uint8*)data + offsets[i]));
+	}
 }
 
-TRE_NS_END
\ No newline at end of file
+TRE_NS_END
@@ -7,6 +7,17 @@ TRE_NS_START
 struct CommandFunctions
 {
 	static void RemoveComponent(const void* data);
+
+	static void AddComponent(const void* data);
+
+	static void DeleteEntity(const void* data);
+
+	static void CreateEntities(const void* data);
+
+	// Destroy the components a command carries, for commands dropped without being dispatched
+	static void DestroyAddComponent(const void* data);
+
+	static void DestroyCreateEntities(const void* data);
 };
 
-TRE_NS_END
\ No newline at end of file
+TRE_NS_END
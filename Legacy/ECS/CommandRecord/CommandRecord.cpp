@@ -2,31 +2,131 @@
 
 TRE_NS_START
 
-CommandRecord::CommandRecord() : 
-	m_Allocator(CMD_TOTAL, true),
-	m_Commands((void**)m_Allocator.Allocate(CMD_COUNT * CMD_PTR)),
-	m_Count(0)
+CommandRecord::CommandRecord(uint32 page_size) :
+	m_Head(NULL), m_Current(NULL), m_PageSize(page_size), m_Count(0), m_PagesCount(0)
 {
 }
 
+CommandRecord::~CommandRecord()
+{
+	this->Clear();
+
+	while (m_Head) {
+		Page* next = m_Head->next;
+		Free((uint8*)m_Head);
+		m_Head = next;
+	}
+}
+
+CommandRecord::Page* CommandRecord::AllocatePage(uint32 min_size)
+{
+	uint32 capacity = min_size > m_PageSize ? AlignSize(min_size) : m_PageSize;
+	Page* page = (Page*)Allocate<uint8>(HEADER_SIZE + capacity);
+	page->next = NULL;
+	page->offset = 0;
+	page->capacity = capacity;
+	m_PagesCount++;
+	return page;
+}
+
+void* CommandRecord::AllocateCommand(ECSCommands::CommandFunction dispatch, ECSCommands::CommandFunction destroy, uint32 size)
+{
+	const uint32 total_size = OFFSET_COMMAND + AlignSize(size);
+
+	if (!m_Current) {
+		if (!m_Head)
+			m_Head = this->AllocatePage(total_size);
+
+		m_Current = m_Head;
+	}
+
+	// Walk through the pages kept from previous frames before growing the chain
+	while (m_Current->offset + total_size > m_Current->capacity) {
+		if (!m_Current->next)
+			m_Current->next = this->AllocatePage(total_size);
+
+		m_Current = m_Current->next;
+		m_Current->offset = 0;
+	}
+
+	uint8* cmd = m_Current->GetData() + m_Current->offset;
+	CommandHeader* header = (CommandHeader*)cmd;
+	header->dispatch = dispatch;
+	header->destroy = destroy;
+	header->size = total_size;
+	m_Current->offset += total_size;
+	m_Count++;
+	return cmd + OFFSET_COMMAND;
+}
+
 void CommandRecord::Flush()
 {
 	if (m_Count) {
-		for (uint32 i = 0; i < m_Count; i++) {
-			void* cmd = m_Commands[i];
-			const ECSCommands::CommandFunction callback = *reinterpret_cast<ECSCommands::CommandFunction*>((uint8*)cmd);
-			const void* cmd_data = (void*)((uint8*)(cmd) + OFFSET_COMMAND);
-			callback(cmd_data);
+		for (Page* page = m_Head; page; page = page->next) {
+			uint8* data = page->GetData();
+			uint32 offset = 0;
+
+			while (offset < page->offset) {
+				const CommandHeader* header = (const CommandHeader*)(data + offset);
+				header->dispatch(data + offset + OFFSET_COMMAND);
+				offset += header->size;
+			}
+
+			if (page == m_Current)
+				break;
 		}
 
-		this->Clear();
+		this->Reset();
 	}
 }
 
 void CommandRecord::Clear()
 {
+	if (m_Count) {
+		for (Page* page = m_Head; page; page = page->next) {
+			uint8* data = page->GetData();
+			uint32 offset = 0;
+
+			while (offset < page->offset) {
+				const CommandHeader* header = (const CommandHeader*)(data + offset);
+
+				if (header->destroy)
+					header->destroy(data + offset + OFFSET_COMMAND);
+
+				offset += header->size;
+			}
+
+			if (page == m_Current)
+				break;
+		}
+	}
+
+	this->Reset();
+}
+
+void CommandRecord::Reset()
+{
+	for (Page* page = m_Head; page; page = page->next) {
+		page->offset = 0;
+	}
+
 	m_Count = 0;
-	m_Allocator.SetOffset(CMD_COUNT * CMD_PTR);
+	m_Current = m_Head;
+}
+
+void CommandRecord::RemoveComponent(World* world, EntityID entity_id, ComponentTypeID component_id)
+{
+	ECSCommands::RemoveComponentCmd* cmd = this->SubmitCommand<ECSCommands::RemoveComponentCmd>();
+	cmd->word = world;
+	cmd->entity_id = entity_id;
+	cmd->component_type_id = component_id;
+}
+
+void CommandRecord::DeleteEntity(World* world, EntityID entity_id)
+{
+	ECSCommands::DeleteEntityCmd* cmd = this->SubmitCommand<ECSCommands::DeleteEntityCmd>();
+	cmd->world = world;
+	cmd->entity_id = entity_id;
 }
 
-TRE_NS_END
\ No newline at end of file
+TRE_NS_END
@@ -1,54 +1,131 @@
 #pragma once
 
 #include <Legacy/Misc/Defines/Common.hpp>
-#include <Legacy/Memory/Allocators/LinearAllocator.hpp>
+#include <Legacy/Memory/Utils/Utils.hpp>
 #include <Legacy/ECS/Commands/Commands.hpp>
+#include <new>
 
 TRE_NS_START
 
+/*
+* Deferred structural changes. Commands are packed linearly in pages that are chained
+* on demand, pages are kept around after a flush so steady state recording doesn't allocate.
+* Clear drops the commands not flushed yet, destroying the components they carry.
+*/
 class CommandRecord
 {
 public:
-	CommandRecord();
+	CommandRecord(uint32 page_size = DEFAULT_PAGE_SIZE);
 
-	template<typename CMD>
-	CMD* SubmitCommand();
+	~CommandRecord();
+
+	CommandRecord(const CommandRecord& other) = delete;
+	CommandRecord& operator=(const CommandRecord& other) = delete;
 
 	template<typename CMD>
-	void* CreateCommand();
+	CMD* SubmitCommand(uint32 extra_size = 0);
+
+	template<typename Component>
+	void AddComponent(World* world, EntityID entity_id, const Component& component);
+
+	void RemoveComponent(World* world, EntityID entity_id, ComponentTypeID component_id);
+
+	void DeleteEntity(World* world, EntityID entity_id);
+
+	template<typename... Components>
+	void CreateEntities(World* world, uint32 count, const Components&... components);
 
 	void Flush();
 
 	void Clear();
+
+	FORCEINLINE uint32 GetCommandsCount() const { return m_Count; }
+
+	FORCEINLINE uint32 GetPagesCount() const { return m_PagesCount; }
+
+	CONSTEXPR static uint32 DEFAULT_PAGE_SIZE = 64 * 1024;
+	CONSTEXPR static uint32 CMD_ALIGNMENT = 16;
 private:
-	LinearAllocator m_Allocator;
-	void** m_Commands;
+	struct Page
+	{
+		Page* next;
+		uint32 offset;
+		uint32 capacity;
+
+		FORCEINLINE uint8* GetData() { return (uint8*)this + HEADER_SIZE; }
+	};
+
+	struct CommandHeader
+	{
+		ECSCommands::CommandFunction dispatch;
+		ECSCommands::CommandFunction destroy; // NULL when there is nothing to destroy
+		uint32 size;
+	};
+
+	Page* m_Head;
+	Page* m_Current;
+	uint32 m_PageSize;
 	uint32 m_Count;
+	uint32 m_PagesCount;
 
-	CONSTEXPR static uint32 CMD_SIZE = 1024;
-	CONSTEXPR static uint32 CMD_PTR = sizeof(void**);
-	CONSTEXPR static uint32 CMD_COUNT = 1024;
-	CONSTEXPR static uint32 CMD_TOTAL = CMD_COUNT * (CMD_SIZE + CMD_PTR);
-	CONSTEXPR static uint32 OFFSET_COMMAND = sizeof(ECSCommands::CommandFunction*);
+	CONSTEXPR static uint32 HEADER_SIZE = (sizeof(Page) + CMD_ALIGNMENT - 1) & ~(CMD_ALIGNMENT - 1);
+	CONSTEXPR static uint32 OFFSET_COMMAND = (sizeof(CommandHeader) + CMD_ALIGNMENT - 1) & ~(CMD_ALIGNMENT - 1);
+
+	FORCEINLINE CONSTEXPR static uint32 AlignSize(uint32 size) { return (size + CMD_ALIGNMENT - 1) & ~(CMD_ALIGNMENT - 1); }
+
+	void* AllocateCommand(ECSCommands::CommandFunction dispatch, ECSCommands::CommandFunction destroy, uint32 size);
+
+	// Rewinds the pages, the commands must have been dispatched or destroyed
+	void Reset();
+
+	Page* AllocatePage(uint32 min_size);
 };
 
 template<typename CMD>
-CMD* CommandRecord::SubmitCommand()
+CMD* CommandRecord::SubmitCommand(uint32 extra_size)
 {
-	ASSERTF(m_Count >= CMD_COUNT, "ECS Command Record buffer is full.");
-
-	void* cmd = CommandRecord::CreateCommand<CMD>();
-	m_Commands[m_Count++] = cmd;
-	return (CMD*)(void*)(reinterpret_cast<uint8*>(cmd) + OFFSET_COMMAND);
+	void* cmd = this->AllocateCommand(CMD::DISPATCH_FUNCTION, CMD::DESTROY_FUNCTION, AlignSize(sizeof(CMD)) + extra_size);
+	return new (cmd) CMD();
 }
 
-template<typename CMD>
-void* CommandRecord::CreateCommand()
+template<typename Component>
+void CommandRecord::AddComponent(World* world, EntityID entity_id, const Component& component)
 {
-	void* cmd = m_Allocator.Allocate(sizeof(CMD) + sizeof(ECSCommands::CommandFunction));
-	*reinterpret_cast<ECSCommands::CommandFunction*>(reinterpret_cast<char*>(cmd)) = CMD::DISPATCH_FUNCTION;
-	return cmd;
+	ECSCommands::AddComponentCmd* cmd = this->SubmitCommand<ECSCommands::AddComponentCmd>(AlignSize(sizeof(Component)));
+	cmd->world = world;
+	cmd->entity_id = entity_id;
+	cmd->component_type_id = Component::ID;
+	new (cmd->GetComponent()) Component(component);
 }
 
+template<typename... Components>
+void CommandRecord::CreateEntities(World* world, uint32 count, const Components&... components)
+{
+	CONSTEXPR uint32 numComponents = sizeof...(components);
+	CONSTEXPR uint32 sizes[] = { 0, AlignSize(sizeof(Components))... };
+	uint32 payload_size = AlignSize(numComponents * sizeof(ComponentTypeID) * 2);
+
+	for (uint32 size : sizes)
+		payload_size += size;
+
+	ECSCommands::CreateEntitiesCmd* cmd = this->SubmitCommand<ECSCommands::CreateEntitiesCmd>(payload_size);
+	cmd->world = world;
+	cmd->count = count;
+	cmd->num_components = numComponents;
+
+	ComponentTypeID* ids = cmd->GetComponentIDs();
+	uint32* offsets = cmd->GetComponentOffsets();
+	uint32 offset = AlignSize(sizeof(ECSCommands::CreateEntitiesCmd)) + AlignSize(numComponents * sizeof(ComponentTypeID) * 2);
+	uint32 index = 0;
+
+	([&](const auto& component) {
+		using Component = ::std::decay_t<decltype(component)>;
+		ids[index] = Component::ID;
+		offsets[index] = offset;
+		new ((uint8*)cmd + offset) Component(component);
+		offset += AlignSize(sizeof(Component));
+		index++;
+	}(components), ...);
+}
 
 TRE_NS_END
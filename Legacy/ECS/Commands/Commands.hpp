@@ -10,6 +10,8 @@ struct ECSCommands
 {
 	typedef void(*CommandFunction)(const void*);
 
+	CONSTEXPR static uint32 PAYLOAD_ALIGNMENT = 16;
+
 	struct RemoveComponentCmd
 	{
 		World* word;
@@ -17,7 +19,51 @@ struct ECSCommands
 		ComponentTypeID component_type_id;
 
 		CONSTEXPR static CommandFunction DISPATCH_FUNCTION = &CommandFunctions::RemoveComponent;
+		CONSTEXPR static CommandFunction DESTROY_FUNCTION = NULL;
+	};
+
+	// The component is stored right after the command
+	struct AddComponentCmd
+	{
+		World* world;
+		EntityID entity_id;
+		ComponentTypeID component_type_id;
+
+		FORCEINLINE BaseComponent* GetComponent() const
+		{ 
+			return (BaseComponent*)((uint8*)this + ((sizeof(AddComponentCmd) + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1)));
+		}
+
+		CONSTEXPR static CommandFunction DISPATCH_FUNCTION = &CommandFunctions::AddComponent;
+		CONSTEXPR static CommandFunction DESTROY_FUNCTION = &CommandFunctions::DestroyAddComponent;
+	};
+
+	struct DeleteEntityCmd
+	{
+		World* world;
+		EntityID entity_id;
+
+		CONSTEXPR static CommandFunction DISPATCH_FUNCTION = &CommandFunctions::DeleteEntity;
+		CONSTEXPR static CommandFunction DESTROY_FUNCTION = NULL;
+	};
+
+	// Followed by the components IDs, their offsets from the command start, then the components themselves
+	struct CreateEntitiesCmd
+	{
+		World* world;
+		uint32 count;
+		uint32 num_components;
+
+		FORCEINLINE ComponentTypeID* GetComponentIDs() const
+		{ 
+			return (ComponentTypeID*)((uint8*)this + ((sizeof(CreateEntitiesCmd) + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1)));
+		}
+
+		FORCEINLINE uint32* GetComponentOffsets() const { return (uint32*)(this->GetComponentIDs() + num_components); }
+
+		CONSTEXPR static CommandFunction DISPATCH_FUNCTION = &CommandFunctions::CreateEntities;
+		CONSTEXPR static CommandFunction DESTROY_FUNCTION = &CommandFunctions::DestroyCreateEntities;
 	};
 };
 
-TRE_NS_END
\ No newline at end of file
+TRE_NS_END
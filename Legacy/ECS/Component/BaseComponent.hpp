@@ -25,6 +25,7 @@ private:
 	friend class ArchetypeChunk;
 	friend class EntityManager;
 	friend class BaseSystem;
+	friend struct CommandFunctions;
 
 	typedef Tuple<ComponentCreateFunction, ComponentDeleteFunction, uint32> ComponentMetaData;
 
@@ -13,7 +13,7 @@ World& ECS::CreateWorld()
 
 World& ECS::GetWorld(uint32 id)
 {
-	ASSERTF(id >= s_WorldCount, "Invalid usage of ECS::GetWorld() index is out of bound.");
+	ASSERTF(id < s_WorldCount, "Invalid usage of ECS::GetWorld() index is out of bound.");
 	return s_Worlds[id];
 }
 
@@ -86,7 +86,7 @@ Entity& EntityContainer::Get(ID id) const
 	Index* indices = this->GetIndexArray();
 	Index& in = indices[id];
 
-	ASSERTF(in.index == INVALID_INDEX, "Invalid ID supplied to the PackedArray:Get().\n");
+	ASSERTF(in.index != INVALID_INDEX, "Invalid ID supplied to the PackedArray:Get().\n");
 	return m_Entities[in.index];
 }
 
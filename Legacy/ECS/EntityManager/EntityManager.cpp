@@ -58,6 +58,165 @@ Entity& EntityManager::CreateEntity(BaseComponent** components, const ComponentT
 	return entity;
 }
 
+void EntityManager::CreateEntities(usize count, BaseComponent** components, const ComponentTypeID* componentIDs, usize numComponents, EntityID* outIds)
+{
+	if (!numComponents) {
+		for (usize i = 0; i < count; i++) {
+			Entity& entity = this->CreateEntity();
+
+			if (outIds)
+				outIds[i] = entity.GetEntityID();
+		}
+
+		return;
+	}
+
+	Bitset sig(BaseComponent::GetComponentsCount());
+
+	for (uint32 i = 0; i < numComponents; i++) {
+		sig.Set(componentIDs[i], true);
+	}
+
+	Archetype& archetype = GetOrCreateArchetype(sig);
+	usize created = 0;
+
+	while (created < count) {
+		// Fill the allocation chunk as much as possible then construct each column in a single pass
+		ArchetypeChunk* chunk = archetype.GetAllocationChunk();
+		uint32 first = chunk->GetEntitiesCount();
+		uint32 batch = (uint32)MIN((usize)chunk->GetFreeSlotsCount(), count - created);
+
+		for (uint32 i = 0; i < batch; i++) {
+			Entity& entity = this->CreateEntity();
+			chunk->AddEntity(entity);
+
+			if (outIds)
+				outIds[created + i] = entity.GetEntityID();
+		}
+
+		for (uint32 c = 0; c < numComponents; c++) {
+			chunk->ConstructComponents(componentIDs[c], components[c], first, batch);
+		}
+
+		created += batch;
+	}
+}
+
+usize EntityManager::MoveArchetypeEntities(Archetype& src, Archetype& dst, uint32 added_id, BaseComponent* component)
+{
+	const Bitset& dst_sig = dst.GetSignature();
+	usize moved_total = 0;
+	ArchetypeChunk* src_chunk = src.GetLastOccupiedChunk();
+
+	while (src_chunk) {
+		const uint32 src_count = src_chunk->GetEntitiesCount();
+
+		// Components the destination doesn't have are destroyed in place before the columns are relocated
+		for (auto& c : src.GetTypesBufferMarker()) {
+			if (!dst_sig.Get(c.first))
+				src_chunk->DestroyComponents(c.first, 0, src_count);
+		}
+
+		uint32 moved = 0;
+
+		while (moved < src_count) {
+			ArchetypeChunk* dst_chunk = dst.GetAllocationChunk();
+			uint32 batch = MIN(dst_chunk->GetFreeSlotsCount(), src_count - moved);
+			uint32 first = dst_chunk->MoveEntitiesFrom(*src_chunk, moved, batch);
+
+			if (component)
+				dst_chunk->ConstructComponents(added_id, component, first, batch);
+
+			moved += batch;
+		}
+
+		moved_total += src_count;
+		src_chunk = src_chunk->GetNextChunk();
+	}
+
+	src.ReleaseAllChunks();
+	return moved_total;
+}
+
+usize EntityManager::AddComponentToQuerryInternal(const ArchetypeQuerry& querry, uint32 component_id, BaseComponent* component)
+{
+	// Gather the archetypes first as creating the destination ones would register new archetypes
+	Vector<Archetype*> archetypes = this->GettAllArchetypeThatMatch(querry);
+	usize count = 0;
+
+	for (Archetype* src : archetypes) {
+		if (src->IsEmpty() || src->HasComponentType(component_id))
+			continue;
+
+		Bitset sig = src->GetSignature();
+		sig.Set(component_id, true);
+		Archetype& dst = EntityManager::GetOrCreateArchetype(sig);
+		count += this->MoveArchetypeEntities(*src, dst, component_id, component);
+	}
+
+	return count;
+}
+
+usize EntityManager::RemoveComponentFromQuerryInternal(const ArchetypeQuerry& querry, uint32 component_id)
+{
+	Vector<Archetype*> archetypes = this->GettAllArchetypeThatMatch(querry);
+	usize count = 0;
+
+	for (Archetype* src : archetypes) {
+		if (src->IsEmpty() || !src->HasComponentType(component_id))
+			continue;
+
+		if (src->GetComponentsTypesCount() == 1) {
+			// Entities are left without any component, no archetype is needed for them
+			for (ArchetypeChunk& chunk : *src) {
+				chunk.DestroyComponents(component_id, 0, chunk.GetEntitiesCount());
+
+				for (uint32 i = 0; i < chunk.GetEntitiesCount(); i++) {
+					GetEntityByID(chunk.GetEntityID(i)).AttachToArchetypeChunk(NULL, 0);
+				}
+
+				count += chunk.GetEntitiesCount();
+			}
+
+			src->ReleaseAllChunks();
+			continue;
+		}
+
+		Bitset sig = src->GetSignature();
+		sig.Set(component_id, false);
+		Archetype& dst = EntityManager::GetOrCreateArchetype(sig);
+		count += this->MoveArchetypeEntities(*src, dst, component_id, NULL);
+	}
+
+	return count;
+}
+
+usize EntityManager::DeleteEntities(const ArchetypeQuerry& querry)
+{
+	Vector<Archetype*> archetypes = this->GettAllArchetypeThatMatch(querry);
+	usize count = 0;
+
+	for (Archetype* arche : archetypes) {
+		for (ArchetypeChunk& chunk : *arche) {
+			const uint32 entities_count = chunk.GetEntitiesCount();
+
+			for (auto& c : arche->GetTypesBufferMarker()) {
+				chunk.DestroyComponents(c.first, 0, entities_count);
+			}
+
+			for (uint32 i = 0; i < entities_count; i++) {
+				m_Entities.Remove(chunk.GetEntityID(i));
+			}
+
+			count += entities_count;
+		}
+
+		arche->ReleaseAllChunks();
+	}
+
+	return count;
+}
+
 void EntityManager::DeleteEntity(EntityID id)
 {
 	Entity* entity = m_Entities.Lookup(id);
@@ -160,7 +319,7 @@ bool EntityManager::HasComponent(EntityID id, ComponentID comp_id)
 BaseComponent* EntityManager::GetComponentInternal(const Entity& entity, uint32 component_id)
 {
 	ArchetypeChunk* chunk = entity.GetChunk();
-	ASSERTF(!(chunk && chunk->GetArchetype().GetSignature().Get(component_id)), "Invalid usage of GetComponentInternal entity doesn't have any components or doesn't have the specified component.");
+	ASSERTF(chunk && chunk->GetArchetype().GetSignature().Get(component_id), "Invalid usage of GetComponentInternal entity doesn't have any components or doesn't have the specified component.");
 	
 	if (!(chunk && chunk->GetArchetype().GetSignature().Get(component_id))) {
 		return NULL;
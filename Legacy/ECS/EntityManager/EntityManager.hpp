@@ -29,12 +29,20 @@ public:
 
 	Entity& CreateEntity(BaseComponent** components, const ComponentTypeID* componentIDs, usize numComponents);
 
+	// Bulk creation, every entity receives a copy of the supplied components :
+	template<typename... Components>
+	FORCEINLINE void CreateEntitiesWithComponents(usize count, EntityID* outIds, const Components&... components);
+
+	void CreateEntities(usize count, BaseComponent** components, const ComponentTypeID* componentIDs, usize numComponents, EntityID* outIds = NULL);
+
 	FORCEINLINE Entity& GetEntityByID(uint32 id);
 
 	FORCEINLINE Entity* LookupEntity(EntityID id);
 
 	void DeleteEntity(EntityID id);
 
+	usize DeleteEntities(const ArchetypeQuerry& querry);
+
 	bool HasComponent(EntityID id, ComponentID comp_id);
 
 	template<typename Component>
@@ -50,6 +58,17 @@ public:
 	template<typename Component>
 	FORCEINLINE Component* GetComponent(const Entity& entity);
 
+	// Bulk components, whole archetypes are moved at once :
+	template<typename Component>
+	FORCEINLINE usize AddComponentToQuerry(const ArchetypeQuerry& querry, const Component& component);
+
+	template<typename Component>
+	FORCEINLINE usize RemoveComponentFromQuerry(const ArchetypeQuerry& querry);
+
+	usize AddComponentToQuerryInternal(const ArchetypeQuerry& querry, uint32 component_id, BaseComponent* component);
+
+	usize RemoveComponentFromQuerryInternal(const ArchetypeQuerry& querry, uint32 component_id);
+
 	template<typename Component>
 	Vector<Component*> GetAllComponents(ComponentTypeID id) const;
 
@@ -78,6 +97,8 @@ public:
 	void UpdateSystemsQuerrys(Archetype& arch);
 
 private:
+	usize MoveArchetypeEntities(Archetype& src, Archetype& dst, uint32 added_id, BaseComponent* component);
+
 	EntityContainer m_Entities;
 	ArchetypeContainer m_Archetypes;
 	HashMap<Bitset, uint32> m_SigToArchetypes;
@@ -99,10 +120,19 @@ FORCEINLINE Entity& EntityManager::CreateEntityWithComponents(const Components&.
 	return this->CreateEntity(components_arr, component_ids, numComponents);
 }
 
+template<typename... Components>
+FORCEINLINE void EntityManager::CreateEntitiesWithComponents(usize count, EntityID* outIds, const Components&... components)
+{
+	CONSTEXPR usize numComponents = sizeof...(components);
+	BaseComponent* components_arr[numComponents] = { (BaseComponent*)(&components)... };
+	ComponentTypeID component_ids[numComponents] = { Components::ID... };
+	this->CreateEntities(count, components_arr, component_ids, numComponents, outIds);
+}
+
 FORCEINLINE Entity& EntityManager::GetEntityByID(uint32 id)
 {
 	Entity* ent = m_Entities.Lookup(id);
-	ASSERTF(ent == NULL, "Invalid usage of 'GetEntityByID', invalid ID is supplied.");
+	ASSERTF(ent != NULL, "Invalid usage of 'GetEntityByID', invalid ID is supplied.");
 	return *ent;
 }
 
@@ -130,6 +160,18 @@ FORCEINLINE Component* EntityManager::GetComponent(const Entity& entity)
 }
 
 
+template<typename Component>
+FORCEINLINE usize EntityManager::AddComponentToQuerry(const ArchetypeQuerry& querry, const Component& component)
+{
+	return AddComponentToQuerryInternal(querry, Component::ID, (BaseComponent*)&component);
+}
+
+template<typename Component>
+FORCEINLINE usize EntityManager::RemoveComponentFromQuerry(const ArchetypeQuerry& querry)
+{
+	return RemoveComponentFromQuerryInternal(querry, Component::ID);
+}
+
 template<typename Component>
 Vector<Component*> EntityManager::GetAllComponents(ComponentTypeID id) const
 {
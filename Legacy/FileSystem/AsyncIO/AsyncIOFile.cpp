@@ -0,0 +1,120 @@
+#include "AsyncIOFile.hpp"
+
+#if defined(OS_WINDOWS)
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+TRE_NS_START
+
+AsyncIOFile::AsyncIOFile() : m_Handle(INVALID_HANDLE), m_DirectHandle(INVALID_HANDLE), m_Size(0)
+{
+}
+
+AsyncIOFile::AsyncIOFile(const char* path, uint32 flags) : m_Handle(INVALID_HANDLE), m_DirectHandle(INVALID_HANDLE), m_Size(0)
+{
+	this->Open(path, flags);
+}
+
+AsyncIOFile::~AsyncIOFile()
+{
+	this->Close();
+}
+
+#if defined(OS_WINDOWS)
+
+bool AsyncIOFile::Open(const char* path, uint32 flags)
+{
+	this->Close();
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(handle, &size);
+	m_Handle = (NativeFileHandle)handle;
+	m_Size = (uint64)size.QuadPart;
+
+	if (flags & DIRECT) {
+		HANDLE direct = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+
+		if (direct != INVALID_HANDLE_VALUE)
+			m_DirectHandle = (NativeFileHandle)direct;
+	}
+
+	return true;
+}
+
+void AsyncIOFile::Close()
+{
+	if (m_DirectHandle != INVALID_HANDLE)
+		CloseHandle((HANDLE)m_DirectHandle);
+
+	if (m_Handle != INVALID_HANDLE)
+		CloseHandle((HANDLE)m_Handle);
+
+	m_Handle = m_DirectHandle = INVALID_HANDLE;
+	m_Size = 0;
+}
+
+#else
+
+bool AsyncIOFile::Open(const char* path, uint32 flags)
+{
+	this->Close();
+	int32 fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat infos;
+
+	if (fstat(fd, &infos) != 0) {
+		close(fd);
+		return false;
+	}
+
+	m_Handle = fd;
+	m_Size = (uint64)infos.st_size;
+
+#if defined(O_DIRECT)
+	// Not every file system supports O_DIRECT (tmpfs for instance), the buffered handle is used then
+	if (flags & DIRECT) {
+		int32 direct_fd = open(path, O_RDONLY | O_DIRECT);
+
+		if (direct_fd >= 0)
+			m_DirectHandle = direct_fd;
+	}
+#endif
+
+	return true;
+}
+
+void AsyncIOFile::Close()
+{
+	if (m_DirectHandle != INVALID_HANDLE)
+		close(m_DirectHandle);
+
+	if (m_Handle != INVALID_HANDLE)
+		close(m_Handle);
+
+	m_Handle = m_DirectHandle = INVALID_HANDLE;
+	m_Size = 0;
+}
+
+#endif
+
+NativeFileHandle AsyncIOFile::GetHandle(const void* buffer, uint64 offset, uint32 size) const
+{
+	if (m_DirectHandle != INVALID_HANDLE && IsDirectAligned(buffer, offset, size))
+		return m_DirectHandle;
+
+	return m_Handle;
+}
+
+TRE_NS_END
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+
+TRE_NS_START
+
+#if defined(OS_WINDOWS)
+typedef intptr NativeFileHandle; // HANDLE
+#else
+typedef int32 NativeFileHandle; // File descriptor
+#endif
+
+/*
+* Read only file used by the async IO manager. When opened with DIRECT a second unbuffered
+* handle is kept and picked for every request whose buffer, offset and size are aligned.
+*/
+class AsyncIOFile
+{
+public:
+	enum Flags
+	{
+		NONE = 0x0,
+		DIRECT = 0x1,
+	};
+
+	CONSTEXPR static uint32 DIRECT_ALIGNMENT = 4096;
+public:
+	AsyncIOFile();
+
+	AsyncIOFile(const char* path, uint32 flags = NONE);
+
+	~AsyncIOFile();
+
+	AsyncIOFile(const AsyncIOFile& other) = delete;
+	AsyncIOFile& operator=(const AsyncIOFile& other) = delete;
+
+	bool Open(const char* path, uint32 flags = NONE);
+
+	void Close();
+
+	NativeFileHandle GetHandle(const void* buffer, uint64 offset, uint32 size) const;
+
+	FORCEINLINE bool IsOpen() const { return m_Handle != INVALID_HANDLE; }
+
+	FORCEINLINE bool HasDirectHandle() const { return m_DirectHandle != INVALID_HANDLE; }
+
+	FORCEINLINE uint64 Size() const { return m_Size; }
+
+	FORCEINLINE static bool IsDirectAligned(const void* buffer, uint64 offset, uint32 size)
+	{
+		return (((uintptr)buffer | offset | size) & (DIRECT_ALIGNMENT - 1)) == 0;
+	}
+
+	CONSTEXPR static NativeFileHandle INVALID_HANDLE = -1;
+private:
+	NativeFileHandle m_Handle;
+	NativeFileHandle m_DirectHandle;
+	uint64 m_Size;
+};
+
+TRE_NS_END
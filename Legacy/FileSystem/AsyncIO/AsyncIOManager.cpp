@@ -0,0 +1,106 @@
+#include "AsyncIOManager.hpp"
+#include <Legacy/FileSystem/AsyncIO/Backends/IOUringBackend.hpp>
+#include <Legacy/FileSystem/AsyncIO/Backends/ThreadPoolBackend.hpp>
+
+TRE_NS_START
+
+AsyncIOManager::AsyncIOManager() : m_Backend(NULL), m_BackendType(BACKEND_AUTO)
+{
+}
+
+AsyncIOManager::~AsyncIOManager()
+{
+	this->Shutdown();
+}
+
+bool AsyncIOManager::Init(BackendType type, uint32 queue_depth, uint32 worker_count)
+{
+	this->Shutdown();
+
+#if defined(OS_LINUX)
+	if (type == BACKEND_AUTO || type == BACKEND_IO_URING) {
+		AsyncIOBackend* backend = new IOUringBackend();
+
+		if (backend->Init(queue_depth, worker_count)) {
+			m_Backend = backend;
+			m_BackendType = BACKEND_IO_URING;
+			return true;
+		}
+
+		delete backend;
+
+		if (type == BACKEND_IO_URING)
+			return false;
+	}
+#else
+	if (type == BACKEND_IO_URING)
+		return false;
+#endif
+
+	AsyncIOBackend* backend = new ThreadPoolBackend();
+
+	if (!backend->Init(queue_depth, worker_count)) {
+		delete backend;
+		return false;
+	}
+
+	m_Backend = backend;
+	m_BackendType = BACKEND_THREAD_POOL;
+	return true;
+}
+
+void AsyncIOManager::Shutdown()
+{
+	if (m_Backend) {
+		m_Backend->Shutdown();
+		delete m_Backend;
+		m_Backend = NULL;
+	}
+}
+
+void AsyncIOManager::Submit(AsyncIOBatch& batch)
+{
+	ASSERTF(m_Backend, "AsyncIOManager::Submit called before Init.");
+	CONSTEXPR uint32 MAX_SUBMIT = 64;
+	AsyncIORequest* requests[MAX_SUBMIT];
+
+	batch.m_PendingCount.fetch_add(batch.m_Count, std::memory_order_relaxed);
+
+	for (uint32 i = 0; i < batch.m_Count; i += MAX_SUBMIT) {
+		uint32 count = MIN(MAX_SUBMIT, batch.m_Count - i);
+
+		for (uint32 j = 0; j < count; j++) {
+			requests[j] = &batch.m_Requests[i + j];
+		}
+
+		m_Backend->Submit(requests, count);
+	}
+}
+
+void AsyncIOManager::Submit(AsyncIORequest& request)
+{
+	ASSERTF(m_Backend, "AsyncIOManager::Submit called before Init.");
+
+	if (request.batch)
+		request.batch->m_PendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	AsyncIORequest* requests[] = { &request };
+	m_Backend->Submit(requests, 1);
+}
+
+void AsyncIOManager::CompleteRequest(AsyncIORequest& request, int64 result)
+{
+	AsyncIOBatch* batch = request.batch;
+	request.result = result;
+
+	if (request.callback)
+		request.callback(request);
+
+	// Past this point the owner is free to release the request
+	request.status.store(result < 0 ? AsyncIORequest::FAILED : AsyncIORequest::COMPLETED, std::memory_order_release);
+
+	if (batch)
+		batch->m_PendingCount.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+TRE_NS_END
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/FileSystem/AsyncIO/AsyncIOFile.hpp>
+#include <Legacy/FileSystem/AsyncIO/AsyncIORequest.hpp>
+
+TRE_NS_START
+
+class AsyncIOBackend
+{
+public:
+	virtual ~AsyncIOBackend() = default;
+
+	virtual bool Init(uint32 queue_depth, uint32 worker_count) = 0;
+
+	virtual void Shutdown() = 0;
+
+	virtual void Submit(AsyncIORequest** requests, uint32 count) = 0;
+
+	virtual const char* GetName() const = 0;
+};
+
+/*
+* Batched asynchronous reads into caller provided buffers. On Linux the requests are handed to 
+* io_uring, if it's not available (old kernel, seccomp...) a thread pool doing pread is used.
+* Callbacks are invoked from the completion thread, they should be short.
+*/
+class AsyncIOManager
+{
+public:
+	enum BackendType
+	{
+		BACKEND_AUTO = 0,
+		BACKEND_IO_URING = 1,
+		BACKEND_THREAD_POOL = 2,
+	};
+
+	CONSTEXPR static uint32 DEFAULT_QUEUE_DEPTH = 256;
+	CONSTEXPR static uint32 DEFAULT_WORKER_COUNT = 4;
+public:
+	AsyncIOManager();
+
+	~AsyncIOManager();
+
+	bool Init(BackendType type = BACKEND_AUTO, uint32 queue_depth = DEFAULT_QUEUE_DEPTH, uint32 worker_count = DEFAULT_WORKER_COUNT);
+
+	void Shutdown();
+
+	void Submit(AsyncIOBatch& batch);
+
+	void Submit(AsyncIORequest& request);
+
+	FORCEINLINE bool IsInitialised() const { return m_Backend != NULL; }
+
+	FORCEINLINE BackendType GetBackendType() const { return m_BackendType; }
+
+	FORCEINLINE const char* GetBackendName() const { return m_Backend ? m_Backend->GetName() : "None"; }
+
+	// Called by the backends once a read is done, result is the bytes count or a negated error code
+	static void CompleteRequest(AsyncIORequest& request, int64 result);
+private:
+	AsyncIOBackend* m_Backend;
+	BackendType m_BackendType;
+};
+
+TRE_NS_END
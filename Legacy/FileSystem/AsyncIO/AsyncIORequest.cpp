@@ -0,0 +1,54 @@
+#include "AsyncIORequest.hpp"
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Legacy/TaskSystem/TaskExecutor/TaskExecutor.hpp>
+#include <thread>
+
+TRE_NS_START
+
+AsyncIOBatch::AsyncIOBatch(uint32 capacity) :
+	m_Requests(new AsyncIORequest[capacity]), m_Capacity(capacity), m_Count(0), m_PendingCount(0)
+{
+}
+
+AsyncIOBatch::~AsyncIOBatch()
+{
+	this->Wait(); // Requests in flight still point to our storage
+	delete[] m_Requests;
+}
+
+AsyncIORequest& AsyncIOBatch::AddRead(const AsyncIOFile& file, void* buffer, uint64 offset, uint32 size, const AsyncIORequest::CallBackFunction& callback)
+{
+	ASSERTF(m_Count < m_Capacity, "AsyncIOBatch is full.");
+	AsyncIORequest& request = m_Requests[m_Count++];
+	request.file = &file;
+	request.buffer = buffer;
+	request.offset = offset;
+	request.size = size;
+	request.result = 0;
+	request.callback = callback;
+	request.batch = this;
+	request.status.store(AsyncIORequest::PENDING, std::memory_order_relaxed);
+	return request;
+}
+
+void AsyncIOBatch::Wait(TaskExecutor* executor) const
+{
+	// When called from a worker thread keep executing other tasks while the reads are in flight
+	while (!this->IsCompleted()) {
+		Task* task = executor ? executor->GetTask() : NULL;
+
+		if (task) {
+			executor->Execute(task);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void AsyncIOBatch::Reset()
+{
+	this->Wait();
+	m_Count = 0;
+}
+
+TRE_NS_END
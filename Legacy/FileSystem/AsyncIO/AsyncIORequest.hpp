@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/FileSystem/AsyncIO/AsyncIOFile.hpp>
+#include <functional>
+#include <atomic>
+
+TRE_NS_START
+
+class AsyncIOBatch;
+class TaskExecutor;
+
+struct AsyncIORequest
+{
+	enum Status
+	{
+		PENDING = 0,
+		COMPLETED = 1,
+		FAILED = 2,
+	};
+
+	typedef std::function<void(const AsyncIORequest&)> CallBackFunction;
+
+	AsyncIORequest() : 
+		file(NULL), buffer(NULL), offset(0), size(0), result(0), batch(NULL), status(PENDING)
+	{}
+
+	FORCEINLINE bool IsCompleted() const { return status.load(std::memory_order_acquire) != PENDING; }
+
+	FORCEINLINE bool HasFailed() const { return status.load(std::memory_order_acquire) == FAILED; }
+
+	const AsyncIOFile* file;
+	void* buffer;
+	uint64 offset;
+	uint32 size;
+
+	int64 result; // Bytes read, or the negated error code on failure
+	CallBackFunction callback;
+	AsyncIOBatch* batch;
+	std::atomic<uint32> status;
+};
+
+/*
+* A group of reads submitted together. Requests are stored in place so they never move
+* once submitted, the capacity is thus fixed at construction.
+*/
+class AsyncIOBatch
+{
+public:
+	AsyncIOBatch(uint32 capacity);
+
+	~AsyncIOBatch();
+
+	AsyncIOBatch(const AsyncIOBatch& other) = delete;
+	AsyncIOBatch& operator=(const AsyncIOBatch& other) = delete;
+
+	AsyncIORequest& AddRead(const AsyncIOFile& file, void* buffer, uint64 offset, uint32 size, 
+		const AsyncIORequest::CallBackFunction& callback = AsyncIORequest::CallBackFunction());
+
+	void Wait(TaskExecutor* executor = NULL) const;
+
+	void Reset();
+
+	FORCEINLINE bool IsCompleted() const { return m_PendingCount.load(std::memory_order_acquire) == 0; }
+
+	FORCEINLINE uint32 GetRequestsCount() const { return m_Count; }
+
+	FORCEINLINE uint32 GetCapacity() const { return m_Capacity; }
+
+	FORCEINLINE AsyncIORequest& operator[](uint32 index) { return m_Requests[index]; }
+
+	FORCEINLINE const AsyncIORequest& operator[](uint32 index) const { return m_Requests[index]; }
+private:
+	AsyncIORequest* m_Requests;
+	uint32 m_Capacity;
+	uint32 m_Count;
+	std::atomic<uint32> m_PendingCount;
+
+	friend class AsyncIOManager;
+};
+
+TRE_NS_END
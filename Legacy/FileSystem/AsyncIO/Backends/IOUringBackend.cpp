@@ -0,0 +1,322 @@
+#include "IOUringBackend.hpp"
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+#if defined(OS_LINUX)
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+TRE_NS_START
+
+static int32 IOUringSetup(uint32 entries, io_uring_params* params)
+{
+	return (int32)syscall(__NR_io_uring_setup, entries, params);
+}
+
+IOUringBackend::IOUringBackend() :
+	m_SQ{}, m_CQ{}, m_SQRing(MAP_FAILED), m_CQRing(MAP_FAILED), m_SQRingSize(0), m_CQRingSize(0), m_SQEsSize(0),
+	m_RingFd(-1), m_Entries(0), m_Slots(NULL), m_FreeSlots(NULL), m_FreeSlotsCount(0), m_InFlightCount(0), m_IsRunning(false)
+{
+}
+
+IOUringBackend::~IOUringBackend()
+{
+	this->Shutdown();
+}
+
+bool IOUringBackend::Init(uint32 queue_depth, [[maybe_unused]] uint32 worker_count)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	m_RingFd = IOUringSetup(queue_depth, &params);
+
+	if (m_RingFd < 0) // ENOSYS on old kernels, EPERM when blocked by seccomp
+		return false;
+
+	m_Entries = params.sq_entries;
+	m_SQRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+	m_CQRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		m_SQRingSize = m_CQRingSize = MAX(m_SQRingSize, m_CQRingSize);
+	}
+
+	m_SQRing = mmap(NULL, m_SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQ_RING);
+
+	if (m_SQRing == MAP_FAILED) {
+		this->Shutdown();
+		return false;
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		m_CQRing = m_SQRing;
+	} else {
+		m_CQRing = mmap(NULL, m_CQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_CQ_RING);
+
+		if (m_CQRing == MAP_FAILED) {
+			this->Shutdown();
+			return false;
+		}
+	}
+
+	m_SQEsSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = mmap(NULL, m_SQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQES);
+
+	if (sqes == MAP_FAILED) {
+		this->Shutdown();
+		return false;
+	}
+
+	uint8* sq_ptr = (uint8*)m_SQRing;
+	m_SQ.head = (std::atomic<uint32>*)(sq_ptr + params.sq_off.head);
+	m_SQ.tail = (std::atomic<uint32>*)(sq_ptr + params.sq_off.tail);
+	m_SQ.ring_mask = (uint32*)(sq_ptr + params.sq_off.ring_mask);
+	m_SQ.array = (uint32*)(sq_ptr + params.sq_off.array);
+	m_SQ.sqes = (io_uring_sqe*)sqes;
+
+	uint8* cq_ptr = (uint8*)m_CQRing;
+	m_CQ.head = (std::atomic<uint32>*)(cq_ptr + params.cq_off.head);
+	m_CQ.tail = (std::atomic<uint32>*)(cq_ptr + params.cq_off.tail);
+	m_CQ.ring_mask = (uint32*)(cq_ptr + params.cq_off.ring_mask);
+	m_CQ.cqes = (io_uring_cqe*)(cq_ptr + params.cq_off.cqes);
+
+	// One slot per SQ entry keeps the CQ from overflowing, one entry is kept for the wake up NOP
+	m_Slots = new InFlight[m_Entries];
+	m_FreeSlots = new InFlight*[m_Entries];
+
+	for (uint32 i = 0; i < m_Entries - 1; i++) {
+		m_FreeSlots[m_FreeSlotsCount++] = &m_Slots[i];
+	}
+
+	m_IsRunning.store(true, std::memory_order_release);
+	m_CompletionThread = std::thread(&IOUringBackend::ProcessCompletions, this);
+	return true;
+}
+
+void IOUringBackend::Shutdown()
+{
+	// The completion thread reaps the reads still in flight before exiting, the kernel would write into the
+	// buffers (and the CQ) after they are released otherwise
+	if (m_IsRunning.exchange(false)) {
+		{
+			std::lock_guard<std::mutex> lock(m_SubmitMutex);
+			int32 error;
+			this->PushWakeup();
+			this->SubmitPushed(1, error);
+		}
+
+		m_CompletionThread.join();
+	}
+
+	if (m_SQ.sqes) {
+		munmap(m_SQ.sqes, m_SQEsSize);
+		m_SQ.sqes = NULL;
+	}
+
+	if (m_CQRing != MAP_FAILED && m_CQRing != m_SQRing)
+		munmap(m_CQRing, m_CQRingSize);
+
+	if (m_SQRing != MAP_FAILED)
+		munmap(m_SQRing, m_SQRingSize);
+
+	m_SQRing = m_CQRing = MAP_FAILED;
+
+	if (m_RingFd >= 0) {
+		close(m_RingFd);
+		m_RingFd = -1;
+	}
+
+	delete[] m_Slots;
+	delete[] m_FreeSlots;
+	m_Slots = NULL;
+	m_FreeSlots = NULL;
+	m_FreeSlotsCount = 0;
+	m_InFlightCount.store(0, std::memory_order_relaxed);
+}
+
+int32 IOUringBackend::Enter(uint32 to_submit, uint32 min_complete, uint32 flags)
+{
+	int32 ret;
+
+	do {
+		ret = (int32)syscall(__NR_io_uring_enter, m_RingFd, to_submit, min_complete, flags, NULL, 0);
+	} while (ret < 0 && errno == EINTR);
+
+	return ret;
+}
+
+uint32 IOUringBackend::SubmitPushed(uint32 count, int32& error)
+{
+	// Must be called with the submit mutex held, the count entries are the last ones pushed to the SQ.
+	// Returns how many of them were not submitted, these are removed from the SQ and error is set
+	uint32 remaining = count;
+	error = 0;
+
+	while (remaining) {
+		int32 ret = this->Enter(remaining, 0, 0);
+
+		if (ret > 0) {
+			// The kernel stops at an entry it can't take, the rest stay in the SQ for the next call
+			remaining -= MIN((uint32)ret, remaining);
+			continue;
+		}
+
+		if (ret == 0 || errno == EAGAIN || errno == EBUSY) {
+			// Out of kernel resources or CQ overflowing, the completion thread frees some
+			std::this_thread::yield();
+			continue;
+		}
+
+		error = errno;
+		m_SQ.tail->store(m_SQ.tail->load(std::memory_order_relaxed) - remaining, std::memory_order_release);
+		break;
+	}
+
+	return remaining;
+}
+
+IOUringBackend::InFlight* IOUringBackend::AcquireSlot()
+{
+	return m_FreeSlots[--m_FreeSlotsCount];
+}
+
+void IOUringBackend::ReleaseSlot(InFlight* slot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SubmitMutex);
+		m_FreeSlots[m_FreeSlotsCount++] = slot;
+	}
+
+	m_SlotsCondition.notify_one();
+}
+
+void IOUringBackend::PushRead(InFlight* slot)
+{
+	// Must be called with the submit mutex held
+	const AsyncIORequest& request = *slot->request;
+	void* buffer = (uint8*)request.buffer + slot->done;
+	uint64 offset = request.offset + slot->done;
+	uint32 size = request.size - slot->done;
+
+	uint32 tail = m_SQ.tail->load(std::memory_order_relaxed);
+	uint32 index = tail & *m_SQ.ring_mask;
+	io_uring_sqe* sqe = &m_SQ.sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = request.file->GetHandle(buffer, offset, size);
+	sqe->addr = (uint64)(uintptr)buffer;
+	sqe->len = size;
+	sqe->off = offset;
+	sqe->user_data = (uint64)(uintptr)slot;
+	m_SQ.array[index] = index;
+	m_SQ.tail->store(tail + 1, std::memory_order_release);
+}
+
+void IOUringBackend::PushWakeup()
+{
+	uint32 tail = m_SQ.tail->load(std::memory_order_relaxed);
+	uint32 index = tail & *m_SQ.ring_mask;
+	io_uring_sqe* sqe = &m_SQ.sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = 0;
+	m_SQ.array[index] = index;
+	m_SQ.tail->store(tail + 1, std::memory_order_release);
+}
+
+void IOUringBackend::Submit(AsyncIORequest** requests, uint32 count)
+{
+	uint32 submitted = 0;
+
+	while (submitted < count) {
+		std::unique_lock<std::mutex> lock(m_SubmitMutex);
+		m_SlotsCondition.wait(lock, [this]() { return m_FreeSlotsCount != 0; });
+
+		uint32 batch = 0;
+
+		while (submitted < count && m_FreeSlotsCount) {
+			InFlight* slot = this->AcquireSlot();
+			slot->request = requests[submitted++];
+			slot->done = 0;
+			this->PushRead(slot);
+			batch++;
+		}
+
+		m_InFlightCount.fetch_add(batch, std::memory_order_relaxed);
+		int32 error;
+		uint32 failed = this->SubmitPushed(batch, error);
+
+		if (!failed)
+			continue;
+
+		// The slots of the refused reads are the last ones taken, they are still stored past the free count
+		m_FreeSlotsCount += failed;
+		lock.unlock();
+		m_SlotsCondition.notify_all();
+
+		for (uint32 i = submitted - failed; i < submitted; i++) {
+			AsyncIOManager::CompleteRequest(*requests[i], -(int64)error);
+			m_InFlightCount.fetch_sub(1, std::memory_order_release);
+		}
+	}
+}
+
+void IOUringBackend::ProcessCompletions()
+{
+	while (true) {
+		uint32 head = m_CQ.head->load(std::memory_order_relaxed);
+		uint32 tail = m_CQ.tail->load(std::memory_order_acquire);
+
+		if (head == tail) {
+			if (!m_IsRunning.load(std::memory_order_acquire) && !m_InFlightCount.load(std::memory_order_acquire))
+				return;
+
+			this->Enter(0, 1, IORING_ENTER_GETEVENTS);
+			continue;
+		}
+
+		for (; head != tail; head++) {
+			const io_uring_cqe& cqe = m_CQ.cqes[head & *m_CQ.ring_mask];
+			InFlight* slot = (InFlight*)(uintptr)cqe.user_data;
+			int32 res = cqe.res;
+
+			if (!slot) // Wake up NOP
+				continue;
+
+			AsyncIORequest& request = *slot->request;
+
+			if (res > 0 && slot->done + (uint32)res < request.size) {
+				// Short read, go on with the rest of the buffer
+				slot->done += (uint32)res;
+				int32 error;
+				uint32 failed;
+
+				{
+					std::lock_guard<std::mutex> lock(m_SubmitMutex);
+					this->PushRead(slot);
+					failed = this->SubmitPushed(1, error);
+				}
+
+				if (!failed)
+					continue;
+
+				res = -error;
+			}
+
+			int64 result = res < 0 ? (int64)res : (int64)(slot->done + res);
+			this->ReleaseSlot(slot);
+			AsyncIOManager::CompleteRequest(request, result);
+			m_InFlightCount.fetch_sub(1, std::memory_order_release);
+		}
+
+		m_CQ.head->store(head, std::memory_order_release);
+	}
+}
+
+TRE_NS_END
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/FileSystem/AsyncIO/AsyncIOManager.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(OS_LINUX)
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+TRE_NS_START
+
+/*
+* io_uring backend talking to the kernel directly through the raw syscalls, no liburing needed.
+* Any thread can submit, a single completion thread reaps the CQ and runs the callbacks.
+* Short reads are resubmitted for the remaining bytes until EOF.
+* Reads the kernel refuses to take are taken back off the SQ and fail with the error of io_uring_enter.
+* Shutdown waits for the reads in flight to complete, their callbacks still run.
+*/
+class IOUringBackend : public AsyncIOBackend
+{
+public:
+	IOUringBackend();
+
+	~IOUringBackend();
+
+	bool Init(uint32 queue_depth, uint32 worker_count) override;
+
+	void Shutdown() override;
+
+	void Submit(AsyncIORequest** requests, uint32 count) override;
+
+	const char* GetName() const override { return "io_uring"; }
+private:
+	struct SubmissionQueue
+	{
+		std::atomic<uint32>* head;
+		std::atomic<uint32>* tail;
+		uint32* ring_mask;
+		uint32* array;
+		::io_uring_sqe* sqes;
+	};
+
+	struct CompletionQueue
+	{
+		std::atomic<uint32>* head;
+		std::atomic<uint32>* tail;
+		uint32* ring_mask;
+		::io_uring_cqe* cqes;
+	};
+
+	// Keeps track of the progress of a request across short reads
+	struct InFlight
+	{
+		AsyncIORequest* request;
+		uint32 done;
+	};
+
+	void ProcessCompletions();
+
+	void PushRead(InFlight* slot);
+
+	void PushWakeup();
+
+	InFlight* AcquireSlot();
+
+	void ReleaseSlot(InFlight* slot);
+
+	uint32 SubmitPushed(uint32 count, int32& error);
+
+	int32 Enter(uint32 to_submit, uint32 min_complete, uint32 flags);
+
+	SubmissionQueue m_SQ;
+	CompletionQueue m_CQ;
+	void* m_SQRing;
+	void* m_CQRing;
+	usize m_SQRingSize;
+	usize m_CQRingSize;
+	usize m_SQEsSize;
+	int32 m_RingFd;
+	uint32 m_Entries;
+
+	InFlight* m_Slots;
+	InFlight** m_FreeSlots;
+	uint32 m_FreeSlotsCount;
+	std::atomic<uint32> m_InFlightCount; // Submitted reads not completed yet, short reads count once
+
+	std::thread m_CompletionThread;
+	std::mutex m_SubmitMutex;
+	std::condition_variable m_SlotsCondition;
+	std::atomic<bool> m_IsRunning;
+};
+
+TRE_NS_END
+
+#endif
@@ -0,0 +1,138 @@
+#include "ThreadPoolBackend.hpp"
+
+#if defined(OS_WINDOWS)
+	#include <windows.h>
+#else
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
+TRE_NS_START
+
+ThreadPoolBackend::ThreadPoolBackend() : m_RequestsHead(0), m_IsRunning(false)
+{
+}
+
+ThreadPoolBackend::~ThreadPoolBackend()
+{
+	this->Shutdown();
+}
+
+bool ThreadPoolBackend::Init([[maybe_unused]] uint32 queue_depth, uint32 worker_count)
+{
+	m_IsRunning = true;
+	worker_count = worker_count ? worker_count : 1;
+	m_Workers.Reserve(worker_count);
+
+	for (uint32 i = 0; i < worker_count; i++) {
+		m_Workers.EmplaceBack(&ThreadPoolBackend::ProcessRequests, this);
+	}
+
+	return true;
+}
+
+void ThreadPoolBackend::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (!m_IsRunning)
+			return;
+
+		m_IsRunning = false;
+	}
+
+	m_Condition.notify_all();
+
+	for (std::thread& worker : m_Workers) {
+		worker.join();
+	}
+
+	m_Workers.Clear();
+}
+
+void ThreadPoolBackend::Submit(AsyncIORequest** requests, uint32 count)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (uint32 i = 0; i < count; i++) {
+			m_Requests.EmplaceBack(requests[i]);
+		}
+	}
+
+	if (count > 1) {
+		m_Condition.notify_all();
+	} else {
+		m_Condition.notify_one();
+	}
+}
+
+void ThreadPoolBackend::ProcessRequests()
+{
+	while (true) {
+		AsyncIORequest* request;
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return !m_IsRunning || m_RequestsHead < m_Requests.Size(); });
+
+			// Drain what's left before leaving so no request stays pending forever
+			if (m_RequestsHead == m_Requests.Size())
+				return;
+
+			request = m_Requests[m_RequestsHead++];
+
+			if (m_RequestsHead == m_Requests.Size()) {
+				m_Requests.Clear();
+				m_RequestsHead = 0;
+			}
+		}
+
+		AsyncIOManager::CompleteRequest(*request, ReadBlocking(*request));
+	}
+}
+
+int64 ThreadPoolBackend::ReadBlocking(const AsyncIORequest& request)
+{
+	NativeFileHandle handle = request.file->GetHandle(request.buffer, request.offset, request.size);
+	uint8* buffer = (uint8*)request.buffer;
+	uint64 offset = request.offset;
+	uint32 remaining = request.size;
+	int64 total = 0;
+
+	while (remaining) {
+#if defined(OS_WINDOWS)
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD read = 0;
+
+		if (!ReadFile((HANDLE)handle, buffer, remaining, &read, &overlapped)) {
+			DWORD error = GetLastError();
+			return error == ERROR_HANDLE_EOF ? total : -(int64)error;
+		}
+#else
+		ssize read = pread(handle, buffer, remaining, (off_t)offset);
+
+		if (read < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return -(int64)errno;
+		}
+#endif
+
+		if (read == 0) // End of file
+			break;
+
+		buffer += read;
+		offset += read;
+		remaining -= (uint32)read;
+		total += read;
+	}
+
+	return total;
+}
+
+TRE_NS_END
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/DataStructure/Vector.hpp>
+#include <Legacy/FileSystem/AsyncIO/AsyncIOManager.hpp>
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+
+TRE_NS_START
+
+// Portable fallback, every worker runs blocking positional reads (pread/ReadFile)
+class ThreadPoolBackend : public AsyncIOBackend
+{
+public:
+	ThreadPoolBackend();
+
+	~ThreadPoolBackend();
+
+	bool Init(uint32 queue_depth, uint32 worker_count) override;
+
+	void Shutdown() override;
+
+	void Submit(AsyncIORequest** requests, uint32 count) override;
+
+	const char* GetName() const override { return "ThreadPool"; }
+
+	static int64 ReadBlocking(const AsyncIORequest& request);
+private:
+	void ProcessRequests();
+
+	Vector<AsyncIORequest*> m_Requests; // FIFO, consumed from m_RequestsHead
+	usize m_RequestsHead;
+	Vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_IsRunning;
+};
+
+TRE_NS_END
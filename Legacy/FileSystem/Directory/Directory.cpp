@@ -1,4 +1,5 @@
 #include "Directory.hpp"
+#include "DirectoryIterator.hpp"
 #include "Legacy/Misc/Defines/Debug.hpp"
 
 /*********************************************/
@@ -63,47 +64,25 @@ int64 Directory::GetSize() const
 
 void Directory::GetContent(Vector<String>& sub_dirs) const
 {
-    DIR* dir = opendir(m_DirPath.Buffer());
-
-    if (dir == NULL)
-        return;
+    DirectoryIterator itr(m_DirPath.Buffer());
 
-    struct dirent* dir_info = readdir(dir);
-
-    while (dir_info != NULL){
-        if (dir_info->d_name[0] != '.') {
-            String sub_path(dir_info->d_name);
-            sub_path += (dir_info->d_type == DT_DIR ? "/" : "");
-            sub_dirs.EmplaceBack(sub_path);
-        }
-
-        dir_info = readdir(dir);
+    while (itr.Next()) {
+        String sub_path(itr.GetName());
+        sub_path += (itr.IsDirectory() ? "/" : "");
+        sub_dirs.EmplaceBack(sub_path);
     }
-
-    closedir(dir);
 }
 
 void Directory::GetContentEx(Vector<Directory>& sub_dirs) const
 {
-    DIR* dir = opendir(m_DirPath.Buffer());
-
-    if (dir == NULL)
-        return;
-
-    struct dirent* dir_info = readdir(dir);
+    DirectoryIterator itr(m_DirPath.Buffer());
 
-    while (dir_info != NULL){
-        if (dir_info->d_name[0] != '.') {
-            String sub_path(m_DirPath);
-            sub_path += dir_info->d_name;
-            sub_path += String(dir_info->d_type == DT_DIR ? "/" : "");
-            sub_dirs.EmplaceBack(sub_path);
-        } 
-
-        dir_info = readdir(dir);
+    while (itr.Next()) {
+        String sub_path(m_DirPath);
+        sub_path += itr.GetName();
+        sub_path += String(itr.IsDirectory() ? "/" : "");
+        sub_dirs.EmplaceBack(sub_path);
     }
-
-    closedir(dir);
 }
 
 Directory Directory::GetParent() const
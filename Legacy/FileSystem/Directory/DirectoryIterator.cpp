@@ -0,0 +1,128 @@
+#include "DirectoryIterator.hpp"
+#include <string.h>
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+    #include <sys/stat.h>
+    #include <fcntl.h>
+#endif
+
+TRE_NS_START
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+
+DirectoryIterator::DirectoryIterator(const char* path, bool skip_hidden) : 
+    m_SkipHidden(skip_hidden), m_Dir(opendir(path)), m_Entry(NULL), m_Type(DT_UNKNOWN)
+{
+}
+
+DirectoryIterator::~DirectoryIterator()
+{
+    if (m_Dir != NULL)
+        closedir(m_Dir);
+}
+
+bool DirectoryIterator::Next()
+{
+    if (m_Dir == NULL)
+        return false;
+
+    while ((m_Entry = readdir(m_Dir)) != NULL) {
+        if (m_SkipHidden && m_Entry->d_name[0] == '.')
+            continue;
+
+        m_Type = m_Entry->d_type;
+
+        // Some file systems don't fill d_type, fall back to a stat relative to the directory
+        if (m_Type == DT_UNKNOWN) {
+            struct stat st;
+
+            if (fstatat(dirfd(m_Dir), m_Entry->d_name, &st, 0) == 0) {
+                m_Type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool DirectoryIterator::IsValid() const
+{
+    return m_Dir != NULL;
+}
+
+const char* DirectoryIterator::GetName() const
+{
+    return m_Entry ? m_Entry->d_name : NULL;
+}
+
+bool DirectoryIterator::IsDirectory() const
+{
+    return m_Entry && m_Type == DT_DIR;
+}
+
+bool DirectoryIterator::IsFile() const
+{
+    return m_Entry && m_Type == DT_REG;
+}
+
+#elif defined(OS_WINDOWS)
+
+DirectoryIterator::DirectoryIterator(const char* path, bool skip_hidden) : 
+    m_SkipHidden(skip_hidden), m_HasPending(false), m_HasEntry(false)
+{
+	char pattern[MAX_PATH];
+	usize len = strlen(path);
+	bool has_separator = len && (path[len - 1] == '\\' || path[len - 1] == '/');
+	snprintf(pattern, sizeof(pattern), has_separator ? "%s*" : "%s\\*", path);
+
+	m_Handle = FindFirstFileA(pattern, &m_Entry);
+	m_HasPending = m_Handle != INVALID_HANDLE_VALUE;
+}
+
+DirectoryIterator::~DirectoryIterator()
+{
+	if (m_Handle != INVALID_HANDLE_VALUE)
+		FindClose(m_Handle);
+}
+
+bool DirectoryIterator::Next()
+{
+	if (m_Handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	// FindFirstFile already produced the first entry
+	m_HasEntry = m_HasPending || FindNextFileA(m_Handle, &m_Entry);
+	m_HasPending = false;
+
+	while (m_HasEntry && m_SkipHidden && m_Entry.cFileName[0] == '.') {
+		m_HasEntry = FindNextFileA(m_Handle, &m_Entry);
+	}
+
+	return m_HasEntry;
+}
+
+bool DirectoryIterator::IsValid() const
+{
+	return m_Handle != INVALID_HANDLE_VALUE;
+}
+
+const char* DirectoryIterator::GetName() const
+{
+	return m_HasEntry ? m_Entry.cFileName : NULL;
+}
+
+bool DirectoryIterator::IsDirectory() const
+{
+	return m_HasEntry && (m_Entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+bool DirectoryIterator::IsFile() const
+{
+	return m_HasEntry && !(m_Entry.dwFileAttributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE));
+}
+
+#endif
+
+TRE_NS_END
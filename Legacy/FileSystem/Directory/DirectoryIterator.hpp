@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Legacy/Misc/Defines/Common.hpp"
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+    #include <sys/types.h>
+    #include <dirent.h>
+#elif defined(OS_WINDOWS)
+	#include <windows.h>
+#endif
+
+TRE_NS_START
+
+/*
+ * Streams the entries of a directory one at a time without materializing them.
+ * The name returned by GetName() is only valid until the next call to Next().
+ * Usage:
+ *     DirectoryIterator itr("Assets/");
+ *     while (itr.Next()) { ... itr.GetName() ... }
+ */
+class DirectoryIterator
+{
+public:
+    DirectoryIterator(const char* path, bool skip_hidden = true);
+
+    ~DirectoryIterator();
+
+    DirectoryIterator(const DirectoryIterator& other) = delete;
+
+    DirectoryIterator& operator=(const DirectoryIterator& other) = delete;
+
+    bool Next();
+
+    bool IsValid() const;
+
+    const char* GetName() const;
+
+    bool IsDirectory() const;
+
+    bool IsFile() const;
+
+private:
+    bool m_SkipHidden;
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+    DIR* m_Dir;
+    struct dirent* m_Entry;
+    uint8 m_Type;
+#elif defined(OS_WINDOWS)
+	HANDLE m_Handle;
+	WIN32_FIND_DATAA m_Entry;
+	bool m_HasPending;
+	bool m_HasEntry;
+#endif
+};
+
+TRE_NS_END
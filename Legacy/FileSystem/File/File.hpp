@@ -196,19 +196,15 @@ FORCEINLINE bool File::SetCursor(usize cur, CursorOrigin cur_position) const
 
 FORCEINLINE String File::ReadAll() const
 {
+	// Sized once and read in a single call, the content keeps its null terminator in the length like before
 	usize sz = this->Size();
-	String data(sz);
-	char byte;
-	uint64 index = 0;
-
-	while ((byte = fgetc(m_File)) != EOF) {
-		// data[index] = byte;
-		data.PushBack(byte);
-		index++;
-	}
+	String data(sz + 2);
+	char* buffer = data.EditableBuffer();
+	usize read = fread(buffer, 1, sz, m_File);
 
-	// data[index] = 0;
-	data.PushBack(0);
+	buffer[read] = 0;
+	buffer[read + 1] = 0;
+	data.SetLength(read + 1);
 	return data;
 }
 
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Core/DataStructure/ArrayView.hpp>
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#elif defined(OS_WINDOWS)
+    #include <windows.h>
+#endif
+
+TRE_NS_START
+
+/*
+ * Read-only memory mapping of a whole file. The content is exposed as a span
+ * that stays valid for the lifetime of the object, so loaders can parse straight
+ * out of the page cache instead of copying the file into a heap buffer first.
+ * This is header only so that modules that don't link Legacy (Renderer) can use it.
+ */
+class MappedFile
+{
+public:
+    enum AccessHint
+    {
+        HINT_NORMAL = 0,        // No particular access pattern
+        HINT_SEQUENTIAL = 1,    // Read front to back once (aggressive read-ahead)
+        HINT_RANDOM = 2,        // Random access (no read-ahead)
+        HINT_WILLNEED = 3,      // Whole range will be needed soon (prefetch now)
+    };
+
+public:
+    MappedFile();
+
+    MappedFile(const char* path, AccessHint hint = HINT_SEQUENTIAL);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+
+    MappedFile& operator=(MappedFile&& other);
+
+    MappedFile(const MappedFile& other) = delete;
+
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    FORCEINLINE bool Open(const char* path, AccessHint hint = HINT_SEQUENTIAL);
+
+    FORCEINLINE void Close();
+
+    FORCEINLINE void Advise(AccessHint hint, usize offset = 0, usize size = usize(-1)) const;
+
+    FORCEINLINE bool IsOpen() const { return m_IsOpen; }
+
+    FORCEINLINE const uint8* Data() const { return m_Data; }
+
+    FORCEINLINE usize Size() const { return m_Size; }
+
+    FORCEINLINE ArrayView<const uint8> GetView() const { return ArrayView<const uint8>(m_Data, m_Size); }
+
+    // Reinterprets the mapping as an array of T, the trailing bytes that don't form a full T are dropped.
+    template<typename T>
+    FORCEINLINE ArrayView<const T> GetViewAs() const { return ArrayView<const T>((const T*)m_Data, m_Size / sizeof(T)); }
+
+private:
+    FORCEINLINE void Reset();
+
+    const uint8* m_Data;
+    usize m_Size;
+    bool m_IsOpen;
+
+#if defined(OS_WINDOWS)
+    HANDLE m_FileHandle;
+    HANDLE m_MappingHandle;
+#endif
+};
+
+/**************************************************/
+/*               Public Functions                 */
+/**************************************************/
+
+FORCEINLINE MappedFile::MappedFile()
+{
+    this->Reset();
+}
+
+FORCEINLINE MappedFile::MappedFile(const char* path, AccessHint hint)
+{
+    this->Reset();
+    this->Open(path, hint);
+}
+
+FORCEINLINE MappedFile::~MappedFile()
+{
+    this->Close();
+}
+
+FORCEINLINE MappedFile::MappedFile(MappedFile&& other)
+{
+    m_Data = other.m_Data;
+    m_Size = other.m_Size;
+    m_IsOpen = other.m_IsOpen;
+#if defined(OS_WINDOWS)
+    m_FileHandle = other.m_FileHandle;
+    m_MappingHandle = other.m_MappingHandle;
+#endif
+    other.Reset();
+}
+
+FORCEINLINE MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if (this != &other) {
+        this->Close();
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+        m_IsOpen = other.m_IsOpen;
+#if defined(OS_WINDOWS)
+        m_FileHandle = other.m_FileHandle;
+        m_MappingHandle = other.m_MappingHandle;
+#endif
+        other.Reset();
+    }
+
+    return *this;
+}
+
+#if defined(OS_LINUX) || defined(OS_UNIX)
+
+FORCEINLINE bool MappedFile::Open(const char* path, AccessHint hint)
+{
+    this->Close();
+
+    int32 fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    m_Size = (usize)st.st_size;
+
+    // mmap refuses empty ranges, an empty file is still a valid (empty) mapping
+    if (m_Size) {
+        void* data = mmap(NULL, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED) {
+            close(fd);
+            m_Size = 0;
+            return false;
+        }
+
+        m_Data = (const uint8*)data;
+    }
+
+    // The mapping holds its own reference to the file
+    close(fd);
+    m_IsOpen = true;
+    this->Advise(hint);
+    return true;
+}
+
+FORCEINLINE void MappedFile::Close()
+{
+    if (m_Data) {
+        munmap((void*)m_Data, m_Size);
+    }
+
+    this->Reset();
+}
+
+FORCEINLINE void MappedFile::Advise(AccessHint hint, usize offset, usize size) const
+{
+    if (!m_Data || offset >= m_Size)
+        return;
+
+    constexpr static int32 ADVICES[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED };
+
+    // madvise wants a page aligned start address
+    const usize pageSize = (usize)sysconf(_SC_PAGESIZE);
+    const usize alignedOffset = offset & ~(pageSize - 1);
+    const usize length = MIN(size, m_Size - offset) + (offset - alignedOffset);
+    madvise((void*)(m_Data + alignedOffset), length, ADVICES[hint]);
+}
+
+#elif defined(OS_WINDOWS)
+
+FORCEINLINE bool MappedFile::Open(const char* path, AccessHint hint)
+{
+    this->Close();
+
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+
+    if (hint == HINT_SEQUENTIAL) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    } else if (hint == HINT_RANDOM) {
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+
+    m_FileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+
+    if (m_FileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(m_FileHandle, &size)) {
+        this->Close();
+        return false;
+    }
+
+    m_Size = (usize)size.QuadPart;
+
+    // CreateFileMapping refuses empty files, an empty file is still a valid (empty) mapping
+    if (m_Size) {
+        m_MappingHandle = CreateFileMappingA(m_FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (m_MappingHandle == NULL) {
+            this->Close();
+            return false;
+        }
+
+        m_Data = (const uint8*)MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+        if (m_Data == NULL) {
+            this->Close();
+            return false;
+        }
+    }
+
+    m_IsOpen = true;
+    this->Advise(hint);
+    return true;
+}
+
+FORCEINLINE void MappedFile::Close()
+{
+    if (m_Data) {
+        UnmapViewOfFile(m_Data);
+    }
+
+    if (m_MappingHandle) {
+        CloseHandle(m_MappingHandle);
+    }
+
+    if (m_FileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_FileHandle);
+    }
+
+    this->Reset();
+}
+
+FORCEINLINE void MappedFile::Advise(AccessHint hint, usize offset, usize size) const
+{
+    if (!m_Data || offset >= m_Size || hint != HINT_WILLNEED)
+        return;
+
+    // Sequential and random hints are given at open time through the file flags
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = (PVOID)(m_Data + offset);
+    range.NumberOfBytes = MIN(size, m_Size - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#endif
+
+/**************************************************/
+/*               Private Functions                */
+/**************************************************/
+
+FORCEINLINE void MappedFile::Reset()
+{
+    m_Data = NULL;
+    m_Size = 0;
+    m_IsOpen = false;
+#if defined(OS_WINDOWS)
+    m_FileHandle = INVALID_HANDLE_VALUE;
+    m_MappingHandle = NULL;
+#endif
+}
+
+TRE_NS_END
@@ -8,7 +8,7 @@ void* LinearAllocator::Allocate(uint32 size, [[maybe_unused]] uint32 alignement)
 
 	[[maybe_unused]] char* curr_adr = (char*)m_Start + m_Offset;
 	const uint32 padding = 0; // CalculatePadding(curr_adr, alignement);
-	ASSERTF((m_Offset + size + padding > m_TotalSize), "Failed to allocate the requested amount of bytes, allocator is out of memory.");
+	ASSERTF(m_Offset + size + padding <= m_TotalSize, "Failed to allocate the requested amount of bytes, allocator is out of memory.");
 	if (m_Offset + size + padding > m_TotalSize) { // Doesnt have enough size
 		return NULL;
 	}
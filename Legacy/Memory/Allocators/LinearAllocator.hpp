@@ -138,7 +138,7 @@ FORCEINLINE U* LinearAllocator::Allocate(Args&&... args)
 
 	U* curr_adr = (U*)(m_Start + m_Offset);
     const uint32 padding = 0; //CalculatePadding<U>(curr_adr);
-	ASSERTF((m_Offset + padding + sizeof(U)), "Failed to allocate the requested amount of bytes, allocator is out of memory.");
+	ASSERTF(m_Offset + padding + sizeof(U) <= m_TotalSize, "Failed to allocate the requested amount of bytes, allocator is out of memory.");
 
 	if (m_Offset + padding + sizeof(U) > m_TotalSize) { // Doesnt have enough size
 		return NULL;
@@ -153,8 +153,8 @@ FORCEINLINE U* LinearAllocator::Allocate(Args&&... args)
 template<typename T>
 FORCEINLINE void LinearAllocator::Deallocate(T* obj)
 {
-	ASSERTF((m_Offset <= 0), "Attempt to Destroy an object with an empty linear allocator.");
-	ASSERTF((obj == NULL), "Can't destroy a null pointer...");
+	ASSERTF(m_Offset > 0, "Attempt to Destroy an object with an empty linear allocator.");
+	ASSERTF(obj != NULL, "Can't destroy a null pointer...");
 #if !defined(_DEBUG) || defined(NDEBUG)
 	if (m_Offset <= 0 || obj == NULL) return;
 #endif
@@ -42,14 +42,14 @@ public:
 	explicit PoolArena(uint32 chunk_num) : m_Next(NULL)
 	{
 		uint32 chunk_size = sizeof(T);
-		ASSERTF((chunk_size < sizeof(PoolItem)), "Given size (%u bytes) is smaller than the Pool Chunk(Item) size(%" SZu ").", chunk_size, sizeof(PoolItem));
+		ASSERTF(chunk_size >= sizeof(PoolItem), "Given size (%u bytes) is smaller than the Pool Chunk(Item) size(%" SZu ").", chunk_size, sizeof(PoolItem));
 		m_Items = (PoolItem*) operator new (chunk_size * chunk_num);
 		this->Reset(chunk_size, chunk_num);
 	}
 
 	PoolArena(uint32 chunk_size, uint32 chunk_num) : m_Next(NULL)
 	{
-		ASSERTF((chunk_size < sizeof(PoolItem)), "Given size (%u bytes) is smaller than the Pool Chunk(Item) size(%" SZu ").", chunk_size, sizeof(PoolItem));
+		ASSERTF(chunk_size >= sizeof(PoolItem), "Given size (%u bytes) is smaller than the Pool Chunk(Item) size(%" SZu ").", chunk_size, sizeof(PoolItem));
 		m_Items = (PoolItem*) operator new (chunk_size * chunk_num);
 		this->Reset(chunk_size, chunk_num);
 	}
@@ -154,7 +154,7 @@ public:
 
 	void Deallocate(void* ptr)
 	{
-		ASSERTF((ptr == NULL), "Can't destroy a null pointer...");
+		ASSERTF(ptr != NULL, "Can't destroy a null pointer...");
 		#if !defined(_DEBUG) || defined(NDEBUG)
 				if (ptr == NULL) return;
 		#endif
@@ -168,7 +168,7 @@ public:
 	template<typename T>
 	void Deallocate(T* ptr)
 	{
-		ASSERTF((ptr == NULL), "Can't destroy a null pointer...");
+		ASSERTF(ptr != NULL, "Can't destroy a null pointer...");
 		#if !defined(_DEBUG) || defined(NDEBUG)
 				if (ptr == NULL) return;
 		#endif
@@ -43,17 +43,17 @@ FORCEINLINE PoolAllocator& PoolAllocator::Reset()
 
 FORCEINLINE void* PoolAllocator::Allocate(uint32 size, [[maybe_unused]] uint32 alignement)
 {
-	ASSERTF((size > m_ChunkSize), "Failed to allocate the requested amount of bytes, requested size is bigger than block size.");
+	ASSERTF(size <= m_ChunkSize, "Failed to allocate the requested amount of bytes, requested size is bigger than block size.");
 	if (size > m_ChunkSize) return NULL;
 	this->InternalInit();
 	Node* freePosition = m_FreeList.Pop();
-	ASSERTF((freePosition == NULL), "Pool is full (empty free positions) //TODO: Allocate another arena in the future.");
+	ASSERTF(freePosition != NULL, "Pool is full (empty free positions) //TODO: Allocate another arena in the future.");
 	return (void*)freePosition;
 }
 
 FORCEINLINE void PoolAllocator::Deallocate(void* ptr)
 {
-	ASSERTF((ptr == NULL), "Can't destroy a null pointer...");
+	ASSERTF(ptr != NULL, "Can't destroy a null pointer...");
 #if !defined(_DEBUG) || defined(NDEBUG)
 	if (ptr == NULL) return;
 #endif
@@ -44,9 +44,9 @@ private:
 template<typename U, typename... Args>
 FORCEINLINE U* PoolAllocator::Allocate(Args&&... args)
 {
-	ASSERTF((m_ChunkSize < sizeof(U)), "Pool chunk size is smaller than sizeof(U)."); // Doesnt have enough size per chunk
+	ASSERTF(m_ChunkSize >= sizeof(U), "Pool chunk size is smaller than sizeof(U)."); // Doesnt have enough size per chunk
 	U* freePosition = (U*)m_FreeList.Pop();
-	ASSERTF((freePosition == NULL), "Pool is full (empty free positions) //TODO: Allocate another arena in the future.");
+	ASSERTF(freePosition != NULL, "Pool is full (empty free positions) //TODO: Allocate another arena in the future.");
 	new (freePosition) U(std::forward<Args>(args)...);
 	return freePosition;
 }
@@ -54,7 +54,7 @@ FORCEINLINE U* PoolAllocator::Allocate(Args&&... args)
 template<typename T>
 FORCEINLINE void PoolAllocator::Deallocate(T* obj)
 {
-	ASSERTF((obj == NULL), "Can't destroy a null pointer...");
+	ASSERTF(obj != NULL, "Can't destroy a null pointer...");
 #if !defined(_DEBUG) || defined(NDEBUG)
 	if (obj == NULL) return;
 #endif
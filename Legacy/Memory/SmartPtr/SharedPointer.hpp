@@ -30,7 +30,7 @@ private:
 template<typename T, bool IsThreadSafe>
 SharedPointer<T, IsThreadSafe>::SharedPointer(T* ptr) : m_Ptr(ptr), m_RefCounter(new RefCounter<IsThreadSafe>(1))
 {
-	ASSERTF((m_Ptr == NULL), "Attempt to use shared pointer with a null pointer!");
+	ASSERTF(m_Ptr != NULL, "Attempt to use shared pointer with a null pointer!");
 }
 
 template<typename T, bool IsThreadSafe>
@@ -2,176 +2,463 @@
 
 #include <Legacy/Misc/Defines/Common.hpp>
 #include <Legacy/Misc/Defines/Debug.hpp>
-#include <Legacy/DataStructure/String/String.hpp>
 #include <Legacy/Misc/Singleton/Singleton.hpp>
 #include <Legacy/Utils/Logging.hpp>
-#include <Legacy/Misc/Defines/Debug.hpp>
 
-#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <fstream>
-#include <iomanip>
-#include <string>
-#include <thread>
 #include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
 
-#if defined(DEBUG)
-#define PROFILE
-#else
+#if defined(CPU_X86) || defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#define TRE_PROFILE_RDTSC
+#endif
+
+// Zones are compiled in unless TRE_NO_PROFILE is defined, recording is then toggled at runtime
+// through Profiler::SetEnabled and costs a single relaxed load while disabled.
+//
+// An enabled zone is two timestamps and a ring store. Measured on a virtualized single core Xeon (Release,
+// Tests/Benchmarks/Profiler), where rdtsc costs ~17 ns: a disabled zone ~0.6 ns, an enabled one ~36 ns whether
+// the event is stored or dropped, 100-150 ns once writing the event to the trace is counted as well (the writer
+// shares the core). The two timestamps are most of a zone.
+#if !defined(TRE_NO_PROFILE)
 #define PROFILE
 #endif
 
 TRE_NS_START
 
-struct ProfileResult
+struct ProfileEvent
 {
-	String Name;
-
-	std::chrono::duration<double, std::micro> Start;
-	std::chrono::microseconds ElapsedTime;
-	std::thread::id ThreadID;
+	const char* Name;
+	uint64 Start;
+	uint64 End;
 };
 
-struct ProfileSession
+/*
+ * Per-thread ring of completed zones. The owning thread is the only producer and the
+ * profiler writer thread the only consumer. The producer keeps the last tail it saw and
+ * only reads the writer's cache line again when the ring looks full, so pushing is a store
+ * and a release store. When the writer falls behind events are dropped (and counted) rather
+ * than blocking the hot path.
+ */
+struct ProfileThreadBuffer
 {
-	String Name;
+	CONSTEXPR static uint32 DEFAULT_CAPACITY = 1 << 12; // 96 KB of events a thread
+
+	// Owning thread
+	alignas(64) std::atomic<uint32> Head;
+	uint32 CachedTail;
+	uint32 Mask;
+	std::atomic<uint32> Dropped;
+	ProfileEvent* Events;
+
+	// Writer
+	alignas(64) std::atomic<uint32> Tail;
+	uint32 ThreadID;
+	ProfileThreadBuffer* Next;
+
+	ProfileThreadBuffer(uint32 tid, uint32 capacity) :
+		Head(0), CachedTail(0), Mask(capacity - 1), Dropped(0), Events(new ProfileEvent[capacity]), Tail(0), ThreadID(tid), Next(NULL)
+	{
+	}
+
+	~ProfileThreadBuffer() { delete[] Events; }
+
+	FORCEINLINE uint32 GetCapacity() const { return Mask + 1; }
+
+	FORCEINLINE void Push(const char* name, uint64 start, uint64 end)
+	{
+		const uint32 head = Head.load(std::memory_order_relaxed);
+
+		if (head - CachedTail > Mask) {
+			CachedTail = Tail.load(std::memory_order_acquire);
+
+			if (head - CachedTail > Mask) {
+				Dropped.store(Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		Events[head & Mask] = ProfileEvent{ name, start, end };
+		Head.store(head + 1, std::memory_order_release);
+	}
 };
 
 class Profiler : public Singleton<Profiler>
 {
-private:
-	std::mutex m_Mutex;
-	ProfileSession* m_CurrentSession;
-	std::ofstream m_OutputStream;
 public:
-	Profiler()
-		: m_CurrentSession(nullptr)
+	CONSTEXPR static uint32 WRITER_PERIOD_MS = 1;
+	CONSTEXPR static usize WRITE_BUFFER_SIZE = 1 << 16;
+
+public:
+	Profiler() :
+		m_Buffers(NULL), m_File(NULL), m_Name(NULL), m_Recording(false), m_Enabled(true), m_Running(false),
+		m_BaseTicks(0), m_NanosPerTick(0.0), m_FirstEvent(true), m_ThreadCount(0), m_RingCapacity(ProfileThreadBuffer::DEFAULT_CAPACITY),
+		m_DroppedBase(0), m_WriteSize(0)
 	{
 	}
 
-	void BeginSession(const String& name, const String& filepath = "results.json")
+	~Profiler()
+	{
+		this->EndSession();
+
+		ProfileThreadBuffer* buffer = m_Buffers.load(std::memory_order_acquire);
+
+		while (buffer) {
+			ProfileThreadBuffer* next = buffer->Next;
+			delete buffer;
+			buffer = next;
+		}
+	}
+
+	// Opens the trace file and starts the background writer, names passed to zones must outlive the session.
+	void BeginSession(const char* name, const char* filepath = "results.json")
 	{
-		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::lock_guard<std::mutex> lock(m_SessionMutex);
+
+		if (m_File) {
+			Log::Write(Log::WARN, "Profiler::BeginSession('%s') when session '%s' already open.", name, m_Name);
+			this->InternalEndSession();
+		}
+
+		m_File = fopen(filepath, "w");
 
-		if (m_CurrentSession) {
-			// If there is already a current session, then close it before beginning new one.
-			// Subsequent profiling output meant for the original session will end up in the
-			// newly opened session instead.  That's better than having badly formatted
-			// profiling output.
-			Log::Write(Log::WARN, "Instrumentor::BeginSession('%s') when session '%s' already open.", name.Buffer(), m_CurrentSession->Name.Buffer());
-			InternalEndSession();
+		if (!m_File) {
+			Log::Write(Log::ERR, "Profiler could not open results file '%s'.", filepath);
+			return;
 		}
 
-		m_OutputStream.open(filepath.Buffer());
+		m_Name = name;
+		m_FirstEvent = true;
+		m_DroppedBase = this->GetTotalDroppedCount();
+		this->Calibrate();
+		fprintf(m_File, "{\"otherData\":{\"session\":\"%s\"},\"traceEvents\":[", name);
 
-		if (m_OutputStream.is_open()) {
-			m_CurrentSession = new ProfileSession({ name });
-			WriteHeader();
-		} else {
-			Log::Write(Log::ERR, "Instrumentor could not open results file '%s'.", filepath.Buffer());
+		// Skip whatever was recorded outside of a session
+		for (ProfileThreadBuffer* buffer = m_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next) {
+			buffer->Tail.store(buffer->Head.load(std::memory_order_acquire), std::memory_order_release);
 		}
+
+		m_Running.store(true, std::memory_order_release);
+		m_Writer = std::thread(&Profiler::WriterLoop, this);
+		m_Recording.store(m_Enabled.load(std::memory_order_relaxed), std::memory_order_release);
 	}
 
 	void EndSession()
 	{
-		std::lock_guard<std::mutex> lock(m_Mutex);
-		InternalEndSession();
+		std::lock_guard<std::mutex> lock(m_SessionMutex);
+		this->InternalEndSession();
 	}
 
-	void WriteProfile(const ProfileResult& result)
+	// Runtime toggle, zones opened while disabled are not recorded.
+	void SetEnabled(bool enabled)
 	{
-		std::stringstream json;
+		std::lock_guard<std::mutex> lock(m_SessionMutex);
+		m_Enabled.store(enabled, std::memory_order_relaxed);
+		m_Recording.store(enabled && m_File != NULL, std::memory_order_release);
+	}
+
+	FORCEINLINE bool IsEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+	// Events each thread can have waiting for the writer (a power of 2), applies to the threads that record their first zone afterwards.
+	// A thread ending zones in bursts longer than the writer keeps up with needs more or has to Flush between them.
+	void SetThreadBufferCapacity(uint32 capacity)
+	{
+		ASSERTF(capacity && (capacity & (capacity - 1)) == 0, "Profiler ring capacity must be a power of 2, got %u", capacity);
+		m_RingCapacity.store(capacity, std::memory_order_relaxed);
+	}
+
+	// Capacity of the calling thread's ring
+	FORCEINLINE uint32 GetThreadBufferCapacity() { return this->GetThreadBuffer()->GetCapacity(); }
+
+	FORCEINLINE bool IsRecording() const { return m_Recording.load(std::memory_order_relaxed); }
+
+	FORCEINLINE void Record(const char* name, uint64 start, uint64 end)
+	{
+		this->GetThreadBuffer()->Push(name, start, end);
+	}
 
-		std::string name = result.Name.Buffer();
-		std::replace(name.begin(), name.end(), '"', '\'');
+	// Number of events lost since the session began because a thread ring was full when the zone ended.
+	FORCEINLINE uint64 GetDroppedCount() const { return this->GetTotalDroppedCount() - m_DroppedBase; }
 
-		json << std::setprecision(3) << std::fixed;
-		json << ",{";
-		json << "\"cat\":\"function\",";
-		json << "\"dur\":" << (result.ElapsedTime.count()) << ',';
-		json << "\"name\":\"" << name << "\",";
-		json << "\"ph\":\"X\",";
-		json << "\"pid\":0,";
-		json << "\"tid\":" << result.ThreadID << ",";
-		json << "\"ts\":" << result.Start.count();
-		json << "}";
+	// Writes what was recorded so far on the calling thread instead of waiting for the writer. A thread ending zones
+	// faster than they can be written (a tight loop) can call it between bursts instead of losing events.
+	void Flush()
+	{
+		std::lock_guard<std::mutex> lock(m_DrainMutex);
 
-		std::lock_guard<std::mutex> lock(m_Mutex);
-		if (m_CurrentSession) {
-			m_OutputStream << json.str();
-			m_OutputStream.flush();
+		if (m_Running.load(std::memory_order_acquire)) {
+			this->Drain();
 		}
 	}
 
+	static FORCEINLINE uint64 Now()
+	{
+#if defined(TRE_PROFILE_RDTSC)
+		return __rdtsc();
+#else
+		return (uint64)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
 private:
+	FORCEINLINE ProfileThreadBuffer* GetThreadBuffer()
+	{
+		thread_local ProfileThreadBuffer* tlsBuffer = NULL;
+
+		if (!tlsBuffer) {
+			tlsBuffer = this->RegisterThread();
+		}
+
+		return tlsBuffer;
+	}
+
+	ProfileThreadBuffer* RegisterThread()
+	{
+		ProfileThreadBuffer* buffer = new ProfileThreadBuffer(m_ThreadCount.fetch_add(1, std::memory_order_relaxed),
+			m_RingCapacity.load(std::memory_order_relaxed));
+		ProfileThreadBuffer* head = m_Buffers.load(std::memory_order_relaxed);
+
+		do {
+			buffer->Next = head;
+		} while (!m_Buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+		return buffer;
+	}
 
-	void WriteHeader()
+	// Maps ticks to nanoseconds, rdtsc is invariant on every CPU we target but its rate is unknown.
+	void Calibrate()
 	{
-		m_OutputStream << "{\"otherData\": {},\"traceEvents\":[{}";
-		m_OutputStream.flush();
+#if defined(TRE_PROFILE_RDTSC)
+		const auto clockStart = std::chrono::steady_clock::now();
+		const uint64 tickStart = Now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		const auto clockEnd = std::chrono::steady_clock::now();
+		const uint64 tickEnd = Now();
+
+		const double nanos = std::chrono::duration<double, std::nano>(clockEnd - clockStart).count();
+		m_NanosPerTick = nanos / double(tickEnd - tickStart);
+#else
+		m_NanosPerTick = double(std::chrono::steady_clock::period::num) * 1e9 / double(std::chrono::steady_clock::period::den);
+#endif
+		m_BaseTicks = Now();
 	}
 
-	void WriteFooter()
+	uint64 GetTotalDroppedCount() const
 	{
-		m_OutputStream << "]}";
-		m_OutputStream.flush();
+		uint64 dropped = 0;
+
+		for (ProfileThreadBuffer* buffer = m_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next) {
+			dropped += buffer->Dropped.load(std::memory_order_relaxed);
+		}
+
+		return dropped;
 	}
 
-	// Note: you must already own lock on m_Mutex before
-	// calling InternalEndSession()
-	void InternalEndSession()
+	void WriterLoop()
 	{
-		if (m_CurrentSession) {
-			WriteFooter();
-			m_OutputStream.close();
-			delete m_CurrentSession;
-			m_CurrentSession = nullptr;
+		while (m_Running.load(std::memory_order_acquire)) {
+			uint32 written;
+
+			{
+				std::lock_guard<std::mutex> lock(m_DrainMutex);
+				written = this->Drain();
+			}
+
+			// Only sleeps once the rings are empty, a busy thread is drained back to back
+			if (!written) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_PERIOD_MS));
+			}
 		}
 	}
 
-};
+	// Returns how many events were written, the rings have a single consumer: callers hold m_DrainMutex
+	uint32 Drain()
+	{
+		uint32 written = 0;
 
-struct ProfileTimer
-{
-public:
-	ProfileTimer(const char* name)
-		: m_Name(name), m_Stopped(false)
+		for (ProfileThreadBuffer* buffer = m_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->Next) {
+			const uint32 head = buffer->Head.load(std::memory_order_acquire);
+			uint32 tail = buffer->Tail.load(std::memory_order_relaxed);
+			written += head - tail;
+
+			for (; tail != head; tail++) {
+				this->WriteEvent(buffer->Events[tail & buffer->Mask], buffer->ThreadID);
+			}
+
+			buffer->Tail.store(tail, std::memory_order_release);
+		}
+
+		if (written) {
+			this->FlushWrites();
+			fflush(m_File);
+		}
+
+		return written;
+	}
+
+	// Events are formatted by hand into a buffer, printf is most of what the writer spends otherwise
+	void WriteEvent(const ProfileEvent& event, uint32 tid)
+	{
+		CONSTEXPR static char SEPARATOR[] = ",\n{\"name\":\"";
+		CONSTEXPR static char FIELDS[] = "\",\"cat\":\"function\",\"ph\":\"X\",\"pid\":0,\"tid\":";
+		CONSTEXPR static usize MAX_TAIL_SIZE = sizeof(FIELDS) + 80; // Fields and three numbers
+
+		// Events recorded right before a session started may predate the calibration point
+		const uint64 ts = event.Start >= m_BaseTicks ? uint64(double(event.Start - m_BaseTicks) * m_NanosPerTick + 0.5) : 0;
+		const uint64 dur = uint64(double(event.End - event.Start) * m_NanosPerTick + 0.5);
+
+		const usize skip = m_FirstEvent ? 1 : 0; // No comma before the first one
+		this->Append(SEPARATOR + skip, sizeof(SEPARATOR) - 1 - skip);
+		m_FirstEvent = false;
+
+		for (const char* c = event.Name; *c; c++) {
+			if (m_WriteSize + 2 > WRITE_BUFFER_SIZE)
+				this->FlushWrites();
+
+			if (*c == '"' || *c == '\\')
+				m_WriteBuffer[m_WriteSize++] = '\\';
+			m_WriteBuffer[m_WriteSize++] = *c;
+		}
+
+		if (m_WriteSize + MAX_TAIL_SIZE > WRITE_BUFFER_SIZE)
+			this->FlushWrites();
+
+		this->Append(FIELDS, sizeof(FIELDS) - 1);
+		this->AppendUInt(tid);
+		this->Append(",\"ts\":", 6);
+		this->AppendMicros(ts);
+		this->Append(",\"dur\":", 7);
+		this->AppendMicros(dur);
+		m_WriteBuffer[m_WriteSize++] = '}';
+	}
+
+	FORCEINLINE void Append(const char* data, usize size)
 	{
-		m_StartTimepoint = std::chrono::steady_clock::now();
+		if (m_WriteSize + size > WRITE_BUFFER_SIZE)
+			this->FlushWrites();
+
+		memcpy(m_WriteBuffer + m_WriteSize, data, size);
+		m_WriteSize += size;
 	}
 
-	~ProfileTimer()
+	FORCEINLINE void AppendUInt(uint64 value)
 	{
-		if (!m_Stopped)
-			Stop();
+		char digits[20];
+		usize count = 0;
+
+		do {
+			digits[count++] = char('0' + value % 10);
+			value /= 10;
+		} while (value);
+
+		while (count) {
+			m_WriteBuffer[m_WriteSize++] = digits[--count];
+		}
 	}
 
-	void Stop()
+	// Chrome traces are in microseconds, written with 3 decimals
+	FORCEINLINE void AppendMicros(uint64 nanos)
 	{
-		auto endTimepoint = std::chrono::steady_clock::now();
-		auto highResStart = std::chrono::duration<double, std::micro>{ m_StartTimepoint.time_since_epoch() };
-		auto elapsedTime = std::chrono::time_point_cast<std::chrono::microseconds>(endTimepoint).time_since_epoch() - std::chrono::time_point_cast<std::chrono::microseconds>(m_StartTimepoint).time_since_epoch();
+		const uint32 fraction = uint32(nanos % 1000);
+		this->AppendUInt(nanos / 1000);
+		m_WriteBuffer[m_WriteSize++] = '.';
+		m_WriteBuffer[m_WriteSize++] = char('0' + fraction / 100);
+		m_WriteBuffer[m_WriteSize++] = char('0' + fraction / 10 % 10);
+		m_WriteBuffer[m_WriteSize++] = char('0' + fraction % 10);
+	}
+
+	void FlushWrites()
+	{
+		fwrite(m_WriteBuffer, 1, m_WriteSize, m_File);
+		m_WriteSize = 0;
+	}
+
+	// Note: you must already own lock on m_SessionMutex before calling InternalEndSession()
+	void InternalEndSession()
+	{
+		if (!m_File)
+			return;
+
+		m_Recording.store(false, std::memory_order_release);
+		m_Running.store(false, std::memory_order_release);
+
+		if (m_Writer.joinable())
+			m_Writer.join();
 
-		Profiler::Instance().WriteProfile({ m_Name, highResStart, elapsedTime, std::this_thread::get_id() });
+		std::lock_guard<std::mutex> lock(m_DrainMutex);
+		this->Drain();
+		fputs("\n]}\n", m_File);
+		fclose(m_File);
+		m_File = NULL;
+		m_Name = NULL;
+	}
+
+private:
+	std::atomic<ProfileThreadBuffer*> m_Buffers;
+	std::mutex m_SessionMutex;
+	std::mutex m_DrainMutex;
+	std::thread m_Writer;
+	FILE* m_File;
+	const char* m_Name;
+	std::atomic<bool> m_Recording;
+	std::atomic<bool> m_Enabled;
+	std::atomic<bool> m_Running;
+	uint64 m_BaseTicks;
+	double m_NanosPerTick;
+	bool m_FirstEvent;
+	std::atomic<uint32> m_ThreadCount;
+	std::atomic<uint32> m_RingCapacity;
+	uint64 m_DroppedBase;
+	usize m_WriteSize;
+	char m_WriteBuffer[WRITE_BUFFER_SIZE]; // Under m_DrainMutex
+};
 
-		m_Stopped = true;
+// RAII zone, the name must be a string with static storage (literal or TRE_FUNC_SIG).
+struct ProfileZone
+{
+public:
+	FORCEINLINE ProfileZone(const char* name) : m_Name(name), m_Start(0)
+	{
+		if (Profiler::Instance().IsRecording()) {
+			m_Start = Profiler::Now();
+		}
 	}
+
+	FORCEINLINE ~ProfileZone()
+	{
+		if (m_Start) {
+			Profiler::Instance().Record(m_Name, m_Start, Profiler::Now());
+		}
+	}
+
 private:
 	const char* m_Name;
-	std::chrono::time_point<std::chrono::steady_clock> m_StartTimepoint;
-	bool m_Stopped;
+	uint64 m_Start;
 };
 
+#define TRE_PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define TRE_PROFILE_CONCAT(a, b) TRE_PROFILE_CONCAT_INTERNAL(a, b)
+
 #if defined(PROFILE)
-#define TRE_PROFILE_BEGIN_SESSION(name, filepath) Profiler::Instance().BeginSession(name, filepath)
-#define TRE_PROFILE_END_SESSION() Profiler::Instance().EndSession()
-#define TRE_PROFILE_SCOPE(name) ProfileTimer timer##__LINE__(name);
+#define TRE_PROFILE_BEGIN_SESSION(name, filepath) ::TRE::Profiler::Instance().BeginSession(name, filepath)
+#define TRE_PROFILE_END_SESSION() ::TRE::Profiler::Instance().EndSession()
+#define TRE_PROFILE_ENABLE(enabled) ::TRE::Profiler::Instance().SetEnabled(enabled)
+#define TRE_PROFILE_SCOPE(name) ::TRE::ProfileZone TRE_PROFILE_CONCAT(profileZone, __LINE__)(name)
 #define TRE_PROFILE_FUNCTION() TRE_PROFILE_SCOPE(TRE_FUNC_SIG)
 #else
 #define TRE_PROFILE_BEGIN_SESSION(name, filepath)
 #define TRE_PROFILE_END_SESSION()
+#define TRE_PROFILE_ENABLE(enabled)
 #define TRE_PROFILE_SCOPE(name)
 #define TRE_PROFILE_FUNCTION()
 #endif
 
-TRE_NS_END
\ No newline at end of file
+TRE_NS_END
@@ -13,4 +13,6 @@
 #include <Renderer/Backend/Misc/Color/Color.hpp>
 #include <Renderer/Backend/Core/Alignement/Alignement.hpp>
 #include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
-#include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
\ No newline at end of file
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
+#include <Renderer/Backend/Texture/TextureCooker/TextureCooker.hpp>
+#include <Renderer/Backend/Texture/TextureDecodeService/TextureDecodeService.hpp>
\ No newline at end of file
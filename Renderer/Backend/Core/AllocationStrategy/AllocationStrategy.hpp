@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Math/Maths.hpp>
+
+TRE_NS_START
+
+enum class AllocationStrategy : uint8
+{
+    SLAB,      // Fixed size slots packed in pages, for the many small buffers
+    BUDDY,     // Power of 2 ranges in the shared blocks
+    DEDICATED, // A memory object of its own
+};
+
+struct AllocationRequest
+{
+    uint64 size;
+    uint64 alignment;
+    uint32 group;             // Allocations of different groups never share a slab page (linear buffers and optimal images)
+    bool   requiresDedicated;
+    bool   prefersDedicated;
+};
+
+struct AllocationStrategyConfig
+{
+    uint64 slabMaxSize           = 16u << 10;
+    uint64 slabPageSize          = 256u << 10;
+    uint64 dedicatedThreshold    = 32u << 20; // Dedicated from this size regardless of the waste
+    uint64 dedicatedWasteMinSize = 4u << 20;  // From this size, dedicated when the buddy rounding wastes more than maxBuddyWaste
+    float  maxBuddyWaste         = 0.25f;
+};
+
+// Slots are spaced by a quarter of the power of 2 above the size (at least 16 bytes) and keep the alignment, so a slot
+// never wastes more than 25% where the buddy blocks can waste up to 50%
+FORCEINLINE uint64 GetSlabSlotSize(uint64 size, uint64 alignment)
+{
+    const uint64 step = MAX(Math::NextPow2(size) / 4, (uint64)16);
+    const uint64 granularity = MAX(step, alignment);
+    return (size + granularity - 1) & ~(granularity - 1);
+}
+
+FORCEINLINE AllocationStrategy ChooseAllocationStrategy(const AllocationRequest& request, const AllocationStrategyConfig& config)
+{
+    if (request.requiresDedicated || request.prefersDedicated || request.size >= config.dedicatedThreshold)
+        return AllocationStrategy::DEDICATED;
+
+    if (request.size >= config.dedicatedWasteMinSize) {
+        const uint64 waste = Math::NextPow2(request.size) - request.size;
+
+        if (float(waste) > float(request.size) * config.maxBuddyWaste)
+            return AllocationStrategy::DEDICATED;
+    }
+
+    if (request.alignment <= config.slabPageSize && GetSlabSlotSize(request.size, request.alignment) <= config.slabMaxSize)
+        return AllocationStrategy::SLAB;
+
+    return AllocationStrategy::BUDDY;
+}
+
+TRE_NS_END
@@ -1,6 +1,9 @@
 #pragma once
 
-#include <Renderer/Backend/Common.hpp>
+#include <stdio.h>
+#include <string.h>
+
+#include <Legacy/Misc/Defines/Common.hpp>
 #include <Legacy/Math/Maths.hpp>
 
 TRE_NS_START
@@ -107,7 +110,7 @@ struct BitmapTree
         return GetNode(GetParentIdx(nodeIdx));
     }
 
-    uint8 GetNode(uint32 nodeIdx)
+    uint8 GetNode(uint32 nodeIdx) const
     {
         return tree[nodeIdx];
     }
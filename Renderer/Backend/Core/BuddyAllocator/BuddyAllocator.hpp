@@ -1,4 +1,6 @@
-#include <Renderer/Backend/Common.hpp>
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
 #include <Renderer/Backend/Core/BitmapTree/BitmapTree.hpp>
 
 TRE_NS_START
@@ -13,12 +15,14 @@ struct BuddyAllocator
 
     BuddyAllocator() = default;
 
-    BuddyAllocator(const BuddyAllocator& other) noexcept : minSize(other.minSize), maxSize(other.maxSize), tree(other.tree)
+    BuddyAllocator(const BuddyAllocator& other) noexcept : minSize(other.minSize), maxSize(other.maxSize), tree(other.tree),
+        usedSize(other.usedSize), allocationCount(other.allocationCount)
     {
 
     }
 
-    BuddyAllocator(BuddyAllocator&& other) noexcept : minSize(other.minSize), maxSize(other.maxSize), tree(std::move(other.tree))
+    BuddyAllocator(BuddyAllocator&& other) noexcept : minSize(other.minSize), maxSize(other.maxSize), tree(std::move(other.tree)),
+        usedSize(other.usedSize), allocationCount(other.allocationCount)
     {
 
     }
@@ -27,6 +31,8 @@ struct BuddyAllocator
     {
         this->minSize = minSize;
         this->maxSize = maxSize;
+        this->usedSize = 0;
+        this->allocationCount = 0;
         uint32 numBlocks = maxSize / minSize;
         tree.Init(2 * numBlocks - 1);
         uint32 currentLvl = tree.GetLevels();
@@ -76,6 +82,8 @@ struct BuddyAllocator
         // Mark current Node as used and then descend while updating parents
         tree.SetNode(currentNode, 0);
         this->UpdateParentsAlloc(currentNode);
+        usedSize += this->GetBlockSize(size);
+        allocationCount++;
         // tree.Print();
         return { offset, size };
     }
@@ -103,7 +111,31 @@ struct BuddyAllocator
         }
 
         tree.SetNode(currentNode, level);
-        this->UpdateParentsFree(currentNode);
+        this->UpdateParentsFree(currentNode, level);
+        usedSize -= this->GetBlockSize(alloc.size);
+        allocationCount--;
+    }
+
+    // Size actually taken by an allocation: the next power of 2, at least minSize
+    FORCEINLINE uint64 GetBlockSize(uint64 size) const
+    {
+        const uint64 realSize = Math::NextPow2(size);
+        return realSize > minSize ? realSize : minSize;
+    }
+
+    FORCEINLINE bool IsEmpty() const { return allocationCount == 0; }
+
+    FORCEINLINE uint64 GetUsedSize() const { return usedSize; }
+
+    FORCEINLINE uint64 GetFreeSize() const { return maxSize - usedSize; }
+
+    FORCEINLINE uint32 GetAllocationCount() const { return allocationCount; }
+
+    // The root holds the level of the largest free node
+    FORCEINLINE uint64 GetLargestFreeBlock() const
+    {
+        const uint8 level = tree.GetNode(0);
+        return level ? uint64(minSize) << (level - 1) : 0;
     }
 
     void UpdateParentsAlloc(uint32 currentNode)
@@ -121,18 +153,19 @@ struct BuddyAllocator
         }
     }
 
-    void UpdateParentsFree(uint32 currentNode)
+    void UpdateParentsFree(uint32 currentNode, uint8 level)
     {
-        // Moving upward updating parents:
+        // Moving upward updating parents, they merge back only when both children are entirely free:
         uint32 dummyNode = tree.GetParentIdx(currentNode);
 
         while (dummyNode != UINT32_MAX) {
             uint8 leftValue = tree.GetLeftNode(dummyNode);
             uint8 rightValue = tree.GetRightNode(dummyNode);
-            uint8 dummyLevel = (rightValue == leftValue) ? rightValue + 1 : MAX(leftValue, rightValue);
+            uint8 dummyLevel = (rightValue == level && leftValue == level) ? level + 1 : MAX(leftValue, rightValue);
 
             tree.SetNode(dummyNode, dummyLevel);
             dummyNode = tree.GetParentIdx(dummyNode);
+            level++;
         }
     }
 
@@ -144,6 +177,8 @@ struct BuddyAllocator
     uint32     minSize;
     uint32     maxSize;
     BitmapTree tree;
+    uint64     usedSize;
+    uint32     allocationCount;
 };
 
 
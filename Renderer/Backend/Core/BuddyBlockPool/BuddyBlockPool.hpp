@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Core/BuddyAllocator/BuddyAllocator.hpp>
+
+TRE_NS_START
+
+struct BuddyPoolConfig
+{
+    uint32 minSize            = 64;
+    uint64 firstBlockSize     = 16u << 20;
+    uint64 maxBlockSize       = 1024u << 20;
+    uint32 growthFactor       = 4;  // Each new block is this many times the largest one, up to maxBlockSize
+    uint32 releaseDelayFrames = 60; // Frames a block has to stay empty before it's released
+    uint32 spareBlocks        = 1;  // Empty blocks kept regardless, so allocations going back and forth don't churn blocks
+};
+
+struct BuddyPoolStats
+{
+    uint64 blockBytes;       // Reserved from the backend
+    uint64 usedBytes;        // Allocated, rounded up to the buddy sizes
+    uint64 largestFreeBlock;
+    uint32 blockCount;
+    uint32 emptyBlockCount;
+    uint32 allocationCount;
+    float  fragmentation;    // 1 - largest free range / free bytes, 0 when the free space is a single range
+};
+
+struct BuddyPoolAllocation
+{
+    uint32 block;
+    uint64 offset;
+    uint64 size;
+};
+
+struct BuddyPoolMove
+{
+    uint32              allocation; // Index in the live allocations given to PlanDefragmentation
+    BuddyPoolAllocation dst;
+};
+
+/*
+ * Growing set of buddy allocated blocks. Block derives from BuddyAllocator and Backend provides:
+ *     bool CreateBlock(Block& block, uint64 size); // Must Init the buddy allocator, false if out of memory
+ *     void DestroyBlock(Block& block, uint32 index);
+ * Block indices are stable: a released block leaves a hole that the next growth fills, allocations can keep referring
+ * to their block by index.
+ */
+template<typename Block, typename Backend>
+class BuddyBlockPool
+{
+public:
+    void Init(Backend* backend, const BuddyPoolConfig& config)
+    {
+        this->backend = backend;
+        this->config = config;
+        this->growthLimited = false;
+    }
+
+    void Destroy()
+    {
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (states[i].alive) {
+                backend->DestroyBlock(blocks[i], i);
+            }
+        }
+
+        blocks.clear();
+        states.clear();
+    }
+
+    bool Allocate(uint64 size, BuddyPoolAllocation& out)
+    {
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (states[i].alive && this->TryAllocate(i, size, out))
+                return true;
+        }
+
+        const uint64 nextPow2 = Math::NextPow2(size);
+        const uint64 required = MAX(nextPow2, (uint64)config.minSize);
+        uint64 blockSize = MAX(this->GetNextBlockSize(), required);
+        ASSERTF(blockSize <= UINT32_MAX, "Buddy blocks are limited to 4GB, requested %" PRIu64, blockSize);
+
+        // Out of memory: retry smaller blocks down to what the allocation needs
+        while (true) {
+            const uint32 index = this->AddBlock(blockSize);
+
+            if (index != UINT32_MAX)
+                return this->TryAllocate(index, size, out);
+
+            if (blockSize <= required)
+                return false;
+
+            blockSize = MAX(blockSize / 2, required);
+        }
+    }
+
+    void Free(const BuddyPoolAllocation& alloc)
+    {
+        ASSERTF(alloc.block < blocks.size() && states[alloc.block].alive, "Freeing from a block that doesn't exist");
+        blocks[alloc.block].Free({ alloc.offset, alloc.size });
+
+        if (blocks[alloc.block].IsEmpty()) {
+            states[alloc.block].emptyFrames = 0;
+        }
+    }
+
+    // Called once per frame: releases the largest blocks that stayed empty long enough, keeping the spare ones unless
+    // releaseAll is set (over budget). Returns the number of bytes given back.
+    uint64 ReleaseEmptyBlocks(bool releaseAll = false)
+    {
+        scratch.clear();
+
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (states[i].alive && blocks[i].IsEmpty()) {
+                states[i].emptyFrames++;
+                scratch.push_back(i);
+            }
+        }
+
+        std::sort(scratch.begin(), scratch.end(), [this](uint32 a, uint32 b) {
+            return states[a].size != states[b].size ? states[a].size > states[b].size : a < b;
+        });
+
+        const uint32 keep = releaseAll ? 0 : config.spareBlocks;
+        uint64 released = 0;
+
+        for (uint32 i = 0; i + keep < scratch.size(); i++) {
+            const uint32 index = scratch[i];
+
+            if (releaseAll || states[index].emptyFrames > config.releaseDelayFrames) {
+                backend->DestroyBlock(blocks[index], index);
+                blocks[index].tree = BitmapTree(); // Large blocks have large trees
+                states[index].alive = false;
+                released += states[index].size;
+            }
+        }
+
+        return released;
+    }
+
+    BuddyPoolStats GetStats() const
+    {
+        BuddyPoolStats stats{};
+
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (!states[i].alive)
+                continue;
+
+            stats.blockBytes += states[i].size;
+            stats.usedBytes += blocks[i].GetUsedSize();
+            stats.largestFreeBlock = MAX(stats.largestFreeBlock, blocks[i].GetLargestFreeBlock());
+            stats.blockCount++;
+            stats.emptyBlockCount += blocks[i].IsEmpty();
+            stats.allocationCount += blocks[i].GetAllocationCount();
+        }
+
+        const uint64 freeBytes = stats.blockBytes - stats.usedBytes;
+        stats.fragmentation = freeBytes ? 1.f - float(stats.largestFreeBlock) / float(freeBytes) : 0.f;
+        return stats;
+    }
+
+    /*
+     * Plans moves emptying the least used block into the fullest ones, at most maxMoves and maxBytes (a single larger
+     * allocation still moves alone). The destination ranges are allocated here, the caller copies the data, points its
+     * resources to the destinations and frees the sources once the GPU is done with them. Usage is measured from the
+     * live allocations so planning again while sources are pending resumes with the same block.
+     */
+    uint32 PlanDefragmentation(const BuddyPoolAllocation* live, uint32 count, uint64 maxBytes, uint32 maxMoves,
+        std::vector<BuddyPoolMove>& moves)
+    {
+        moves.clear();
+        liveBytes.assign(blocks.size(), 0);
+
+        for (uint32 i = 0; i < count; i++) {
+            liveBytes[live[i].block] += blocks[live[i].block].GetBlockSize(live[i].size);
+        }
+
+        uint64 totalFree = 0;
+        scratch.clear();
+
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (states[i].alive && liveBytes[i]) {
+                scratch.push_back(i);
+                totalFree += blocks[i].GetFreeSize();
+            }
+        }
+
+        // Least used first, ties going to the latest block
+        std::sort(scratch.begin(), scratch.end(), [this](uint32 a, uint32 b) {
+            const double usageA = double(liveBytes[a]) / double(states[a].size);
+            const double usageB = double(liveBytes[b]) / double(states[b].size);
+            return usageA != usageB ? usageA < usageB : a > b;
+        });
+
+        // The source has to fit in the free space of the others, otherwise moving it doesn't free anything
+        uint32 source = UINT32_MAX;
+
+        for (uint32 index : scratch) {
+            if (liveBytes[index] <= totalFree - blocks[index].GetFreeSize()) {
+                source = index;
+                break;
+            }
+        }
+
+        if (source == UINT32_MAX)
+            return 0;
+
+        scratch.erase(std::find(scratch.begin(), scratch.end(), source));
+
+        // Fullest destinations first
+        std::sort(scratch.begin(), scratch.end(), [this](uint32 a, uint32 b) {
+            const uint64 freeA = blocks[a].GetFreeSize();
+            const uint64 freeB = blocks[b].GetFreeSize();
+            return freeA != freeB ? freeA < freeB : a < b;
+        });
+
+        // Largest allocations first, they are the hardest to place
+        sources.clear();
+
+        for (uint32 i = 0; i < count; i++) {
+            if (live[i].block == source) {
+                sources.push_back(i);
+            }
+        }
+
+        std::sort(sources.begin(), sources.end(), [live](uint32 a, uint32 b) {
+            return live[a].size != live[b].size ? live[a].size > live[b].size : live[a].offset < live[b].offset;
+        });
+
+        uint64 bytes = 0;
+
+        for (uint32 allocation : sources) {
+            const uint64 size = live[allocation].size;
+
+            if (moves.size() >= maxMoves || (!moves.empty() && bytes + size > maxBytes))
+                break;
+
+            BuddyPoolMove move;
+            move.allocation = allocation;
+            uint32 d = 0;
+
+            while (d < scratch.size() && !this->TryAllocate(scratch[d], size, move.dst)) {
+                d++;
+            }
+
+            if (d == scratch.size())
+                break;
+
+            moves.push_back(move);
+            bytes += size;
+        }
+
+        return (uint32)moves.size();
+    }
+
+    // When set, new blocks are sized to the allocation instead of growing (over budget)
+    FORCEINLINE void SetGrowthLimited(bool limited) { growthLimited = limited; }
+
+    FORCEINLINE Block& GetBlock(uint32 index) { return blocks[index]; }
+
+    FORCEINLINE const Block& GetBlock(uint32 index) const { return blocks[index]; }
+
+    FORCEINLINE bool IsBlockAlive(uint32 index) const { return index < states.size() && states[index].alive; }
+
+    FORCEINLINE uint64 GetBlockSize(uint32 index) const { return states[index].size; }
+
+    FORCEINLINE uint32 GetBlockSlotCount() const { return (uint32)blocks.size(); }
+
+private:
+    struct BlockState
+    {
+        uint64 size;
+        uint32 emptyFrames;
+        bool   alive;
+    };
+
+    bool TryAllocate(uint32 index, uint64 size, BuddyPoolAllocation& out)
+    {
+        Block& block = blocks[index];
+
+        if (block.GetLargestFreeBlock() < size)
+            return false;
+
+        const BuddyAllocator::Allocation allocation = block.Allocate(size);
+
+        if (allocation.offset == UINT64_MAX)
+            return false;
+
+        out = { index, allocation.offset, allocation.size };
+        return true;
+    }
+
+    uint64 GetNextBlockSize() const
+    {
+        uint64 largest = 0;
+
+        for (uint32 i = 0; i < blocks.size(); i++) {
+            if (states[i].alive) {
+                largest = MAX(largest, states[i].size);
+            }
+        }
+
+        if (!largest || growthLimited)
+            return growthLimited ? 0 : config.firstBlockSize;
+
+        return MIN(largest * config.growthFactor, MAX(config.maxBlockSize, largest));
+    }
+
+    // Fills the first hole, returns UINT32_MAX if the backend couldn't create the block
+    uint32 AddBlock(uint64 size)
+    {
+        uint32 index = 0;
+
+        while (index < blocks.size() && states[index].alive) {
+            index++;
+        }
+
+        if (index == blocks.size()) {
+            blocks.emplace_back();
+            states.push_back({ 0, 0, false });
+        }
+
+        if (!backend->CreateBlock(blocks[index], size))
+            return UINT32_MAX;
+
+        states[index] = { size, 0, true };
+        return index;
+    }
+
+private:
+    std::vector<Block>      blocks;
+    std::vector<BlockState> states;
+    std::vector<uint32>     scratch;
+    std::vector<uint32>     sources;
+    std::vector<uint64>     liveBytes;
+    Backend*                backend;
+    BuddyPoolConfig         config;
+    bool                    growthLimited;
+};
+
+TRE_NS_END
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <float.h>
+#include <math.h>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+	#include <emmintrin.h>
+#endif
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// Four floats in one SSE register when available, comparisons return one bit per lane
+	struct BvhFloat4
+	{
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2
+		__m128 v;
+
+		static FORCEINLINE BvhFloat4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+
+		static FORCEINLINE BvhFloat4 Broadcast(float f) { return { _mm_set1_ps(f) }; }
+
+		FORCEINLINE void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+		friend FORCEINLINE BvhFloat4 operator+(BvhFloat4 a, BvhFloat4 b) { return { _mm_add_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE BvhFloat4 operator-(BvhFloat4 a, BvhFloat4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE BvhFloat4 operator*(BvhFloat4 a, BvhFloat4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE BvhFloat4 operator/(BvhFloat4 a, BvhFloat4 b) { return { _mm_div_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE BvhFloat4 Min(BvhFloat4 a, BvhFloat4 b) { return { _mm_min_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE BvhFloat4 Max(BvhFloat4 a, BvhFloat4 b) { return { _mm_max_ps(a.v, b.v) }; }
+
+		friend FORCEINLINE uint32 Less(BvhFloat4 a, BvhFloat4 b) { return uint32(_mm_movemask_ps(_mm_cmplt_ps(a.v, b.v))); }
+
+		friend FORCEINLINE uint32 LessEqual(BvhFloat4 a, BvhFloat4 b) { return uint32(_mm_movemask_ps(_mm_cmple_ps(a.v, b.v))); }
+#else
+		float v[4];
+
+		static FORCEINLINE BvhFloat4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+
+		static FORCEINLINE BvhFloat4 Broadcast(float f) { return { { f, f, f, f } }; }
+
+		FORCEINLINE void Store(float* p) const { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+
+	#define TRE_BVH_FLOAT4_OP(name, expr) \
+		friend FORCEINLINE BvhFloat4 name(BvhFloat4 a, BvhFloat4 b) \
+		{ BvhFloat4 r; for (uint32 i = 0; i < 4; i++) { const float x = a.v[i], y = b.v[i]; r.v[i] = (expr); } return r; }
+
+		TRE_BVH_FLOAT4_OP(operator+, x + y)
+		TRE_BVH_FLOAT4_OP(operator-, x - y)
+		TRE_BVH_FLOAT4_OP(operator*, x * y)
+		TRE_BVH_FLOAT4_OP(operator/, x / y)
+		TRE_BVH_FLOAT4_OP(Min, x < y ? x : y)
+		TRE_BVH_FLOAT4_OP(Max, x > y ? x : y)
+	#undef TRE_BVH_FLOAT4_OP
+
+		friend FORCEINLINE uint32 Less(BvhFloat4 a, BvhFloat4 b)
+		{
+			uint32 mask = 0;
+			for (uint32 i = 0; i < 4; i++) { mask |= uint32(a.v[i] < b.v[i]) << i; }
+			return mask;
+		}
+
+		friend FORCEINLINE uint32 LessEqual(BvhFloat4 a, BvhFloat4 b)
+		{
+			uint32 mask = 0;
+			for (uint32 i = 0; i < 4; i++) { mask |= uint32(a.v[i] <= b.v[i]) << i; }
+			return mask;
+		}
+#endif
+	};
+
+	struct BvhAabb
+	{
+		float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		FORCEINLINE void Extend(const float* point)
+		{
+			for (uint32 i = 0; i < 3; i++) {
+				min[i] = point[i] < min[i] ? point[i] : min[i];
+				max[i] = point[i] > max[i] ? point[i] : max[i];
+			}
+		}
+
+		FORCEINLINE void Extend(const BvhAabb& other)
+		{
+			for (uint32 i = 0; i < 3; i++) {
+				min[i] = other.min[i] < min[i] ? other.min[i] : min[i];
+				max[i] = other.max[i] > max[i] ? other.max[i] : max[i];
+			}
+		}
+
+		FORCEINLINE bool IsEmpty() const { return min[0] > max[0]; }
+
+		// Half the surface area, all the SAH needs
+		FORCEINLINE float HalfArea() const
+		{
+			if (this->IsEmpty()) {
+				return 0.f;
+			}
+
+			const float x = max[0] - min[0];
+			const float y = max[1] - min[1];
+			const float z = max[2] - min[2];
+			return x * y + y * z + z * x;
+		}
+	};
+
+	struct BvhRay
+	{
+		CONSTEXPR static float MIN_DIRECTION = 1e-20f;
+
+		float origin[3];
+		float direction[3]; // Not normalized necessarily, distances are in units of direction
+		float invDirection[3];
+		float tMin;
+		float tMax;         // Shortened to the closest hit found so far
+		uint32 mask;        // Instances sharing no bit with it are skipped
+
+		BvhRay() = default;
+
+		BvhRay(const float o[3], const float d[3], float tMin = 0.f, float tMax = FLT_MAX, uint32 mask = 0xFF)
+			: tMin(tMin), tMax(tMax), mask(mask)
+		{
+			origin[0] = o[0]; origin[1] = o[1]; origin[2] = o[2];
+			this->SetDirection(d);
+		}
+
+		// Zero components get a tiny direction instead so the slab tests never divide by zero
+		FORCEINLINE void SetDirection(const float d[3])
+		{
+			for (uint32 i = 0; i < 3; i++) {
+				direction[i] = d[i];
+				const float safe = fabsf(d[i]) < MIN_DIRECTION ? (d[i] < 0.f ? -MIN_DIRECTION : MIN_DIRECTION) : d[i];
+				invDirection[i] = 1.f / safe;
+			}
+		}
+	};
+
+	// Four rays laid out SoA, traversed together down the BVH. Fast when they are coherent (camera, shadow rays
+	// towards one light), single rays are better otherwise
+	struct BvhRayPacket4
+	{
+		float origin[3][4];
+		float direction[3][4];
+		float invDirection[3][4];
+		float tMin[4];
+		float tMax[4];
+		uint32 mask = 0xFF;
+		uint32 active = 0;  // Lanes holding a ray
+
+		FORCEINLINE void SetRay(uint32 lane, const BvhRay& ray)
+		{
+			for (uint32 i = 0; i < 3; i++) {
+				origin[i][lane] = ray.origin[i];
+				direction[i][lane] = ray.direction[i];
+				invDirection[i][lane] = ray.invDirection[i];
+			}
+
+			tMin[lane] = ray.tMin;
+			tMax[lane] = ray.tMax;
+			active |= 1u << lane;
+		}
+
+		FORCEINLINE BvhRay GetRay(uint32 lane) const
+		{
+			BvhRay ray;
+
+			for (uint32 i = 0; i < 3; i++) {
+				ray.origin[i] = origin[i][lane];
+				ray.direction[i] = direction[i][lane];
+				ray.invDirection[i] = invDirection[i][lane];
+			}
+
+			ray.tMin = tMin[lane];
+			ray.tMax = tMax[lane];
+			ray.mask = mask;
+			return ray;
+		}
+	};
+
+	struct BvhHit
+	{
+		CONSTEXPR static uint32 INVALID = ~0u;
+
+		float t = FLT_MAX;
+		float u = 0.f;                 // Barycentrics of vertices 1 and 2
+		float v = 0.f;
+		uint32 primitive = INVALID;    // Triangle index in its mesh
+		uint32 instance = INVALID;     // Index of the instance in the scene, INVALID for a lone mesh
+
+		FORCEINLINE bool IsValid() const { return primitive != INVALID; }
+	};
+
+	/*
+	 * 4-wide node, two cache lines. The children's boxes are stored SoA so a ray is tested against the four of them
+	 * with one SIMD slab test. A child is either another node, a leaf of up to MAX_LEAF_SIZE consecutive primitives,
+	 * or EMPTY with a box at infinity that no ray hits.
+	 */
+	struct alignas(64) BvhNode4
+	{
+		CONSTEXPR static uint32 LEAF_BIT = 0x80000000u;
+		CONSTEXPR static uint32 EMPTY = ~0u;
+		CONSTEXPR static uint32 MAX_LEAF_SIZE = 16;
+		CONSTEXPR static uint32 MAX_LEAF_FIRST = (1u << 27) - 1;
+
+		float bounds[6][4];  // Min x, y, z then max x, y, z of the 4 children
+		uint32 children[4];
+		uint32 padding[4];
+
+		static FORCEINLINE uint32 MakeLeaf(uint32 first, uint32 count)
+		{
+			ASSERTF(first <= MAX_LEAF_FIRST && count != 0 && count <= MAX_LEAF_SIZE, "Leaf out of range (first %u, count %u)", first, count);
+			return LEAF_BIT | (first << 4) | (count - 1);
+		}
+
+		static FORCEINLINE bool IsLeaf(uint32 child) { return child & LEAF_BIT; }
+
+		static FORCEINLINE uint32 GetLeafFirst(uint32 child) { return (child & ~LEAF_BIT) >> 4; }
+
+		static FORCEINLINE uint32 GetLeafCount(uint32 child) { return (child & 0xF) + 1; }
+
+		FORCEINLINE void SetChild(uint32 slot, const BvhAabb& box, uint32 child)
+		{
+			for (uint32 i = 0; i < 3; i++) {
+				bounds[i][slot] = box.min[i];
+				bounds[i + 3][slot] = box.max[i];
+			}
+
+			children[slot] = child;
+		}
+
+		FORCEINLINE void SetEmpty(uint32 slot)
+		{
+			for (uint32 i = 0; i < 6; i++) {
+				bounds[i][slot] = INFINITY;
+			}
+
+			children[slot] = EMPTY;
+		}
+	};
+
+	static_assert(sizeof(BvhNode4) == 128, "BvhNode4 should span two cache lines");
+
+	CONSTEXPR static uint32 BVH_STACK_SIZE = 256;
+
+	// Children of node the ray enters within [tMin, tMax], one bit each, with their entry distances
+	FORCEINLINE uint32 BvhIntersectNode(const BvhNode4& node, const BvhRay& ray, float tEntry[4])
+	{
+		const BvhFloat4 ox = BvhFloat4::Broadcast(ray.origin[0]);
+		const BvhFloat4 oy = BvhFloat4::Broadcast(ray.origin[1]);
+		const BvhFloat4 oz = BvhFloat4::Broadcast(ray.origin[2]);
+		const BvhFloat4 ix = BvhFloat4::Broadcast(ray.invDirection[0]);
+		const BvhFloat4 iy = BvhFloat4::Broadcast(ray.invDirection[1]);
+		const BvhFloat4 iz = BvhFloat4::Broadcast(ray.invDirection[2]);
+
+		const BvhFloat4 x0 = (BvhFloat4::Load(node.bounds[0]) - ox) * ix;
+		const BvhFloat4 y0 = (BvhFloat4::Load(node.bounds[1]) - oy) * iy;
+		const BvhFloat4 z0 = (BvhFloat4::Load(node.bounds[2]) - oz) * iz;
+		const BvhFloat4 x1 = (BvhFloat4::Load(node.bounds[3]) - ox) * ix;
+		const BvhFloat4 y1 = (BvhFloat4::Load(node.bounds[4]) - oy) * iy;
+		const BvhFloat4 z1 = (BvhFloat4::Load(node.bounds[5]) - oz) * iz;
+
+		const BvhFloat4 tNear = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), BvhFloat4::Broadcast(ray.tMin)));
+		const BvhFloat4 tFar = Min(Min(Max(x0, x1), Max(y0, y1)), Min(Max(z0, z1), BvhFloat4::Broadcast(ray.tMax)));
+		tNear.Store(tEntry);
+		return LessEqual(tNear, tFar);
+	}
+
+	// Lanes of the packet entering the box of a node's child, and the nearest of their entry distances
+	FORCEINLINE uint32 BvhIntersectChild(const BvhNode4& node, uint32 slot, const BvhRayPacket4& packet, float& tEntry)
+	{
+		BvhFloat4 tNear = BvhFloat4::Load(packet.tMin);
+		BvhFloat4 tFar = BvhFloat4::Load(packet.tMax);
+
+		for (uint32 i = 0; i < 3; i++) {
+			const BvhFloat4 origin = BvhFloat4::Load(packet.origin[i]);
+			const BvhFloat4 inv = BvhFloat4::Load(packet.invDirection[i]);
+			const BvhFloat4 t0 = (BvhFloat4::Broadcast(node.bounds[i][slot]) - origin) * inv;
+			const BvhFloat4 t1 = (BvhFloat4::Broadcast(node.bounds[i + 3][slot]) - origin) * inv;
+			tNear = Max(tNear, Min(t0, t1));
+			tFar = Min(tFar, Max(t0, t1));
+		}
+
+		const uint32 lanes = LessEqual(tNear, tFar) & packet.active;
+		float entries[4];
+		tNear.Store(entries);
+		tEntry = FLT_MAX;
+
+		for (uint32 lane = 0; lane < 4; lane++) {
+			if ((lanes & (1u << lane)) && entries[lane] < tEntry) {
+				tEntry = entries[lane];
+			}
+		}
+
+		return lanes;
+	}
+
+	/*
+	 * Walks the BVH front to back. leaf(first, count, ray) tests the primitives of a leaf, shortening ray.tMax on the
+	 * hits it finds, and returns whether it found any. With ANY_HIT the walk stops at the first one.
+	 */
+	template<bool ANY_HIT, typename LeafFunc>
+	bool BvhTraverse(const BvhNode4* nodes, BvhRay& ray, LeafFunc&& leaf)
+	{
+		struct Entry
+		{
+			uint32 node;
+			float t;
+		};
+
+		Entry stack[BVH_STACK_SIZE];
+		uint32 stackSize = 0;
+		uint32 node = 0;
+		bool hit = false;
+
+		for (;;) {
+			float tEntry[4];
+			const BvhNode4& current = nodes[node];
+			const uint32 mask = BvhIntersectNode(current, ray, tEntry);
+
+			// Leaves right away, inner children sorted farthest first
+			Entry inner[4];
+			uint32 innerCount = 0;
+
+			for (uint32 slot = 0; slot < 4; slot++) {
+				if (!(mask & (1u << slot))) {
+					continue;
+				}
+
+				const uint32 child = current.children[slot];
+
+				if (BvhNode4::IsLeaf(child)) {
+					if (leaf(BvhNode4::GetLeafFirst(child), BvhNode4::GetLeafCount(child), ray)) {
+						hit = true;
+
+						if CONSTEXPR (ANY_HIT) {
+							return true;
+						}
+					}
+				} else {
+					uint32 i = innerCount++;
+
+					for (; i > 0 && inner[i - 1].t < tEntry[slot]; i--) {
+						inner[i] = inner[i - 1];
+					}
+
+					inner[i] = { child, tEntry[slot] };
+				}
+			}
+
+			// Leaves may have moved tMax closer than the children
+			while (innerCount && inner[innerCount - 1].t > ray.tMax) {
+				innerCount--;
+			}
+
+			if (innerCount) {
+				node = inner[--innerCount].node;
+
+				for (uint32 i = 0; i < innerCount; i++) {
+					if (inner[i].t <= ray.tMax) {
+						ASSERT(stackSize < BVH_STACK_SIZE);
+						stack[stackSize++] = inner[i];
+					}
+				}
+
+				continue;
+			}
+
+			while (stackSize && stack[stackSize - 1].t > ray.tMax) {
+				stackSize--;
+			}
+
+			if (!stackSize) {
+				return hit;
+			}
+
+			node = stack[--stackSize].node;
+		}
+	}
+
+	/*
+	 * Same for a packet, a node is visited when any active lane enters it. leaf(first, count, packet, lanes) tests the
+	 * lanes that entered the leaf and returns those it found hits for. Returns the lanes that hit anything.
+	 */
+	template<typename LeafFunc>
+	uint32 BvhTraversePacket(const BvhNode4* nodes, BvhRayPacket4& packet, LeafFunc&& leaf)
+	{
+		uint32 stack[BVH_STACK_SIZE];
+		uint32 stackSize = 0;
+		uint32 node = 0;
+		uint32 hits = 0;
+
+		for (;;) {
+			const BvhNode4& current = nodes[node];
+			uint32 inner[4];
+			float innerT[4];
+			uint32 innerCount = 0;
+
+			for (uint32 slot = 0; slot < 4; slot++) {
+				const uint32 child = current.children[slot];
+
+				if (child == BvhNode4::EMPTY) {
+					continue;
+				}
+
+				float tEntry;
+				const uint32 lanes = BvhIntersectChild(current, slot, packet, tEntry);
+
+				if (!lanes) {
+					continue;
+				}
+
+				if (BvhNode4::IsLeaf(child)) {
+					hits |= leaf(BvhNode4::GetLeafFirst(child), BvhNode4::GetLeafCount(child), packet, lanes);
+				} else {
+					uint32 i = innerCount++;
+
+					for (; i > 0 && innerT[i - 1] < tEntry; i--) {
+						inner[i] = inner[i - 1];
+						innerT[i] = innerT[i - 1];
+					}
+
+					inner[i] = child;
+					innerT[i] = tEntry;
+				}
+			}
+
+			if (innerCount) {
+				node = inner[--innerCount];
+
+				for (uint32 i = 0; i < innerCount; i++) {
+					ASSERT(stackSize < BVH_STACK_SIZE);
+					stack[stackSize++] = inner[i];
+				}
+
+				continue;
+			}
+
+			if (!stackSize) {
+				return hits;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+}
+
+TRE_NS_END
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <Renderer/Backend/Core/Bvh/Bvh.hpp>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	struct BvhBuildSettings
+	{
+		uint32 maxLeafSize = 4;      // At most BvhNode4::MAX_LEAF_SIZE
+		uint32 binCount = 16;        // Candidate split planes per axis, at most BvhBuilder::MAX_BINS
+		float traversalCost = 1.f;   // Cost of visiting a node relative to intersecting a primitive
+		uint32 threadCount = 1;
+	};
+
+	/*
+	 * Binned SAH builder: a binary BVH is built top down, each node split at the cheapest of binCount planes per axis
+	 * by surface area heuristic, then collapsed into 4-wide nodes by pulling up the largest grandchildren. Both halves
+	 * of large nodes near the root are built in parallel on the worker pool, threadCount threads at most.
+	 */
+	class BvhBuilder
+	{
+	public:
+		CONSTEXPR static uint32 MAX_BINS = 32;
+		CONSTEXPR static uint32 PARALLEL_MIN_PRIMITIVES = 4096;
+	public:
+		// Builds over the boxes of count primitives, primitiveOrder gets their indices in leaf order, the range the
+		// leaves point into
+		static void Build(const BvhAabb* primitiveBounds, uint32 count, const BvhBuildSettings& settings,
+			std::vector<BvhNode4>& nodes, std::vector<uint32>& primitiveOrder)
+		{
+			nodes.clear();
+			primitiveOrder.clear();
+
+			if (!count) {
+				return;
+			}
+
+			ASSERTF(count - 1 <= BvhNode4::MAX_LEAF_FIRST, "Too many primitives in one BVH (%u)", count);
+
+			Context ctx;
+			ctx.settings = settings;
+			ctx.settings.maxLeafSize = std::min(std::max(settings.maxLeafSize, 1u), BvhNode4::MAX_LEAF_SIZE);
+			ctx.settings.binCount = std::min(std::max(settings.binCount, 2u), MAX_BINS);
+			ctx.spawnDepth = 0;
+
+			while ((2u << ctx.spawnDepth) <= settings.threadCount) {
+				ctx.spawnDepth++;
+			}
+
+			ctx.refs.resize(count);
+
+			for (uint32 i = 0; i < count; i++) {
+				PrimitiveRef& ref = ctx.refs[i];
+				ref.bounds = primitiveBounds[i];
+				ref.index = i;
+
+				for (uint32 axis = 0; axis < 3; axis++) {
+					ref.centroid[axis] = (ref.bounds.min[axis] + ref.bounds.max[axis]) * 0.5f;
+				}
+			}
+
+			// A binary tree over count leaves has 2 * count - 1 nodes at most
+			ctx.binary.resize(2 * usize(count));
+			ctx.nodeCount = 1;
+			BuildNode(ctx, 0, 0, count, 0);
+
+			nodes.reserve(ctx.nodeCount / 2 + 1);
+			const BinaryNode& root = ctx.binary[0];
+
+			if (root.count) {
+				nodes.emplace_back();
+				nodes[0].SetChild(0, root.bounds, BvhNode4::MakeLeaf(root.first, root.count));
+
+				for (uint32 slot = 1; slot < 4; slot++) {
+					nodes[0].SetEmpty(slot);
+				}
+			} else {
+				Collapse(ctx, 0, nodes);
+			}
+
+			primitiveOrder.resize(count);
+
+			for (uint32 i = 0; i < count; i++) {
+				primitiveOrder[i] = ctx.refs[i].index;
+			}
+		}
+	private:
+		struct PrimitiveRef
+		{
+			BvhAabb bounds;
+			float centroid[3];
+			uint32 index;
+		};
+
+		struct BinaryNode
+		{
+			BvhAabb bounds;
+			uint32 left;   // Right child follows it
+			uint32 first;
+			uint32 count;  // 0 for inner nodes
+		};
+
+		struct Context
+		{
+			BvhBuildSettings settings;
+			std::vector<PrimitiveRef> refs;
+			std::vector<BinaryNode> binary;
+			std::atomic<uint32> nodeCount;
+			uint32 spawnDepth;
+		};
+
+		static void BuildNode(Context& ctx, uint32 index, uint32 begin, uint32 end, uint32 depth)
+		{
+			BinaryNode& node = ctx.binary[index];
+			const BvhBuildSettings& settings = ctx.settings;
+			const uint32 count = end - begin;
+			BvhAabb centroidBounds;
+			node.bounds = BvhAabb();
+
+			for (uint32 i = begin; i < end; i++) {
+				node.bounds.Extend(ctx.refs[i].bounds);
+				centroidBounds.Extend(ctx.refs[i].centroid);
+			}
+
+			node.first = begin;
+			node.count = count;
+
+			if (count == 1) {
+				return;
+			}
+
+			// Cheapest plane between the bins of centroids, in units of primitive intersections
+			struct Bin
+			{
+				BvhAabb bounds;
+				uint32 count = 0;
+			};
+
+			const uint32 binCount = settings.binCount;
+			const float area = node.bounds.HalfArea();
+			float bestCost = FLT_MAX;
+			uint32 bestAxis = 3;
+			uint32 bestSplit = 0;
+
+			for (uint32 axis = 0; axis < 3; axis++) {
+				const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+
+				if (!(extent > 0.f)) {
+					continue;
+				}
+
+				Bin bins[MAX_BINS];
+				const float scale = float(binCount) / extent;
+
+				for (uint32 i = begin; i < end; i++) {
+					const PrimitiveRef& ref = ctx.refs[i];
+					const uint32 bin = BinOf(ref.centroid[axis], centroidBounds.min[axis], scale, binCount);
+					bins[bin].bounds.Extend(ref.bounds);
+					bins[bin].count++;
+				}
+
+				// Right side of every plane swept from the end, then the left side from the start
+				float rightCost[MAX_BINS];
+				BvhAabb right;
+				uint32 rightCount = 0;
+
+				for (uint32 split = binCount - 1; split > 0; split--) {
+					right.Extend(bins[split].bounds);
+					rightCount += bins[split].count;
+					rightCost[split] = right.HalfArea() * float(rightCount);
+				}
+
+				BvhAabb left;
+				uint32 leftCount = 0;
+
+				for (uint32 split = 1; split < binCount; split++) {
+					left.Extend(bins[split - 1].bounds);
+					leftCount += bins[split - 1].count;
+
+					if (!leftCount || leftCount == count) {
+						continue;
+					}
+
+					const float cost = left.HalfArea() * float(leftCount) + rightCost[split];
+
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+
+			uint32 mid = begin + count / 2;
+
+			if (bestAxis < 3) {
+				bestCost = settings.traversalCost + (area > 0.f ? bestCost / area : float(count));
+
+				if (count <= settings.maxLeafSize && bestCost >= float(count)) {
+					return;
+				}
+
+				const float min = centroidBounds.min[bestAxis];
+				const float scale = float(binCount) / (centroidBounds.max[bestAxis] - min);
+				mid = uint32(std::partition(ctx.refs.begin() + begin, ctx.refs.begin() + end, [&](const PrimitiveRef& ref) {
+					return BinOf(ref.centroid[bestAxis], min, scale, binCount) < bestSplit;
+				}) - ctx.refs.begin());
+			} else if (count <= settings.maxLeafSize) {
+				// All the centroids at one point, nothing to split them by
+				return;
+			}
+
+			const uint32 left = ctx.nodeCount.fetch_add(2, std::memory_order_relaxed);
+			node.left = left;
+			node.count = 0;
+
+			if (depth < ctx.spawnDepth && count >= PARALLEL_MIN_PRIMITIVES) {
+				const uint32 bounds[3] = { begin, mid, end };
+				WorkerPool::Instance().ParallelFor(2, [&ctx, &bounds, left, depth](uint32 i) {
+					BuildNode(ctx, left + i, bounds[i], bounds[i + 1], depth + 1);
+				});
+			} else {
+				BuildNode(ctx, left, begin, mid, depth + 1);
+				BuildNode(ctx, left + 1, mid, end, depth + 1);
+			}
+		}
+
+		static FORCEINLINE uint32 BinOf(float centroid, float min, float scale, uint32 binCount)
+		{
+			const uint32 bin = uint32((centroid - min) * scale);
+			return bin < binCount ? bin : binCount - 1;
+		}
+
+		// Turns the binary subtree into 4-wide nodes, returns the index of its root
+		static uint32 Collapse(const Context& ctx, uint32 index, std::vector<BvhNode4>& nodes)
+		{
+			const uint32 result = uint32(nodes.size());
+			nodes.emplace_back();
+
+			uint32 children[4] = { ctx.binary[index].left, ctx.binary[index].left + 1 };
+			uint32 childCount = 2;
+
+			// Replace the largest inner child by its own two children until there are four
+			while (childCount < 4) {
+				float largest = -1.f;
+				uint32 expand = 4;
+
+				for (uint32 i = 0; i < childCount; i++) {
+					const BinaryNode& child = ctx.binary[children[i]];
+
+					if (!child.count && child.bounds.HalfArea() > largest) {
+						largest = child.bounds.HalfArea();
+						expand = i;
+					}
+				}
+
+				if (expand == 4) {
+					break;
+				}
+
+				const uint32 left = ctx.binary[children[expand]].left;
+				children[expand] = left;
+				children[childCount++] = left + 1;
+			}
+
+			for (uint32 slot = 0; slot < 4; slot++) {
+				if (slot >= childCount) {
+					nodes[result].SetEmpty(slot);
+					continue;
+				}
+
+				const BinaryNode& child = ctx.binary[children[slot]];
+
+				if (child.count) {
+					nodes[result].SetChild(slot, child.bounds, BvhNode4::MakeLeaf(child.first, child.count));
+				} else {
+					// Collapsing may grow nodes, index it again afterwards
+					const uint32 node = Collapse(ctx, children[slot], nodes);
+					nodes[result].SetChild(slot, child.bounds, node);
+				}
+			}
+
+			return result;
+		}
+	};
+}
+
+TRE_NS_END
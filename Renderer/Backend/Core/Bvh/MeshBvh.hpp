@@ -0,0 +1,231 @@
+#pragma once
+
+#include <vector>
+
+#include <Renderer/Backend/Core/Bvh/BvhBuilder.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// Triangle in the form Moller-Trumbore wants it, primitive is its index in the source mesh
+	struct BvhTriangle
+	{
+		float v0[3];
+		float e1[3];  // v1 - v0
+		float e2[3];  // v2 - v0
+		uint32 primitive;
+	};
+
+	// Distance along the ray and barycentrics of the hit, fails for hits outside (tMin, tMax)
+	FORCEINLINE bool BvhIntersectTriangle(const BvhTriangle& tri, const BvhRay& ray, float& t, float& u, float& v)
+	{
+		const float* d = ray.direction;
+		const float p[3] = { d[1] * tri.e2[2] - d[2] * tri.e2[1], d[2] * tri.e2[0] - d[0] * tri.e2[2], d[0] * tri.e2[1] - d[1] * tri.e2[0] };
+		const float det = tri.e1[0] * p[0] + tri.e1[1] * p[1] + tri.e1[2] * p[2];
+		const float inv = 1.f / det;
+		const float s[3] = { ray.origin[0] - tri.v0[0], ray.origin[1] - tri.v0[1], ray.origin[2] - tri.v0[2] };
+		u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+
+		// Parallel rays give infinite or NaN barycentrics, written so these fail too
+		if (!(u >= 0.f && u <= 1.f)) {
+			return false;
+		}
+
+		const float q[3] = { s[1] * tri.e1[2] - s[2] * tri.e1[1], s[2] * tri.e1[0] - s[0] * tri.e1[2], s[0] * tri.e1[1] - s[1] * tri.e1[0] };
+		v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv;
+
+		if (!(v >= 0.f && u + v <= 1.f)) {
+			return false;
+		}
+
+		t = (tri.e2[0] * q[0] + tri.e2[1] * q[1] + tri.e2[2] * q[2]) * inv;
+		return t > ray.tMin && t < ray.tMax;
+	}
+
+	// Same against the lanes of a packet, returns the lanes that hit
+	FORCEINLINE uint32 BvhIntersectTriangle(const BvhTriangle& tri, const BvhRayPacket4& packet, uint32 lanes,
+		BvhFloat4& t, BvhFloat4& u, BvhFloat4& v)
+	{
+		const BvhFloat4 zero = BvhFloat4::Broadcast(0.f);
+		const BvhFloat4 one = BvhFloat4::Broadcast(1.f);
+		const BvhFloat4 dx = BvhFloat4::Load(packet.direction[0]);
+		const BvhFloat4 dy = BvhFloat4::Load(packet.direction[1]);
+		const BvhFloat4 dz = BvhFloat4::Load(packet.direction[2]);
+		const BvhFloat4 e1x = BvhFloat4::Broadcast(tri.e1[0]), e1y = BvhFloat4::Broadcast(tri.e1[1]), e1z = BvhFloat4::Broadcast(tri.e1[2]);
+		const BvhFloat4 e2x = BvhFloat4::Broadcast(tri.e2[0]), e2y = BvhFloat4::Broadcast(tri.e2[1]), e2z = BvhFloat4::Broadcast(tri.e2[2]);
+
+		const BvhFloat4 px = dy * e2z - dz * e2y;
+		const BvhFloat4 py = dz * e2x - dx * e2z;
+		const BvhFloat4 pz = dx * e2y - dy * e2x;
+		const BvhFloat4 inv = one / (e1x * px + e1y * py + e1z * pz);
+
+		const BvhFloat4 sx = BvhFloat4::Load(packet.origin[0]) - BvhFloat4::Broadcast(tri.v0[0]);
+		const BvhFloat4 sy = BvhFloat4::Load(packet.origin[1]) - BvhFloat4::Broadcast(tri.v0[1]);
+		const BvhFloat4 sz = BvhFloat4::Load(packet.origin[2]) - BvhFloat4::Broadcast(tri.v0[2]);
+		u = (sx * px + sy * py + sz * pz) * inv;
+
+		const BvhFloat4 qx = sy * e1z - sz * e1y;
+		const BvhFloat4 qy = sz * e1x - sx * e1z;
+		const BvhFloat4 qz = sx * e1y - sy * e1x;
+		v = (dx * qx + dy * qy + dz * qz) * inv;
+		t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+		// Comparisons with NaN are false, parallel lanes drop out like in the single ray test
+		return lanes & LessEqual(zero, u) & LessEqual(zero, v) & LessEqual(u + v, one)
+			& Less(BvhFloat4::Load(packet.tMin), t) & Less(t, BvhFloat4::Load(packet.tMax));
+	}
+
+	/*
+	 * BVH over the triangles of a mesh, for picking and CPU ray queries. The triangles are copied in leaf order so a
+	 * leaf is one contiguous run, hits report the index of the triangle in the source mesh.
+	 */
+	class MeshBvh
+	{
+	public:
+		// positions are 3 floats every vertexStride bytes, indices 3 per triangle or NULL for a plain triangle list
+		void Build(const void* positions, uint32 vertexCount, usize vertexStride, const uint32* indices,
+			uint32 triangleCount, const BvhBuildSettings& settings = BvhBuildSettings())
+		{
+			const uint8* base = (const uint8*)positions;
+			std::vector<BvhAabb> boxes(triangleCount);
+			std::vector<uint32> order;
+			bounds = BvhAabb();
+			(void)vertexCount; // Only checked by the assert
+
+			auto vertex = [&](uint32 triangle, uint32 corner) {
+				const uint32 index = indices ? indices[triangle * 3 + corner] : triangle * 3 + corner;
+				ASSERTF(index < vertexCount, "Vertex %u out of range (%u vertices)", index, vertexCount);
+				return (const float*)(base + index * vertexStride);
+			};
+
+			for (uint32 i = 0; i < triangleCount; i++) {
+				for (uint32 corner = 0; corner < 3; corner++) {
+					boxes[i].Extend(vertex(i, corner));
+				}
+
+				bounds.Extend(boxes[i]);
+			}
+
+			BvhBuilder::Build(boxes.data(), triangleCount, settings, nodes, order);
+			triangles.resize(triangleCount);
+
+			for (uint32 i = 0; i < triangleCount; i++) {
+				BvhTriangle& tri = triangles[i];
+				const float* v0 = vertex(order[i], 0);
+				const float* v1 = vertex(order[i], 1);
+				const float* v2 = vertex(order[i], 2);
+
+				for (uint32 axis = 0; axis < 3; axis++) {
+					tri.v0[axis] = v0[axis];
+					tri.e1[axis] = v1[axis] - v0[axis];
+					tri.e2[axis] = v2[axis] - v0[axis];
+				}
+
+				tri.primitive = order[i];
+			}
+		}
+
+		// Closest hit, ray.tMax ends up at its distance
+		bool Intersect(BvhRay& ray, BvhHit& hit) const
+		{
+			if (nodes.empty()) {
+				return false;
+			}
+
+			return BvhTraverse<false>(nodes.data(), ray, [&](uint32 first, uint32 count, BvhRay& r) {
+				bool found = false;
+
+				for (uint32 i = first; i < first + count; i++) {
+					float t, u, v;
+
+					if (BvhIntersectTriangle(triangles[i], r, t, u, v)) {
+						r.tMax = t;
+						hit.t = t;
+						hit.u = u;
+						hit.v = v;
+						hit.primitive = triangles[i].primitive;
+						found = true;
+					}
+				}
+
+				return found;
+			});
+		}
+
+		// Whether anything is hit within (tMin, tMax), stops at the first hit
+		bool Occluded(const BvhRay& ray) const
+		{
+			if (nodes.empty()) {
+				return false;
+			}
+
+			BvhRay r = ray;
+			return BvhTraverse<true>(nodes.data(), r, [&](uint32 first, uint32 count, BvhRay& r) {
+				for (uint32 i = first; i < first + count; i++) {
+					float t, u, v;
+
+					if (BvhIntersectTriangle(triangles[i], r, t, u, v)) {
+						return true;
+					}
+				}
+
+				return false;
+			});
+		}
+
+		// Closest hits of the active lanes, returns the lanes that hit, their hits and tMax are updated
+		uint32 Intersect(BvhRayPacket4& packet, BvhHit hits[4]) const
+		{
+			if (nodes.empty() || !packet.active) {
+				return 0;
+			}
+
+			return BvhTraversePacket(nodes.data(), packet, [&](uint32 first, uint32 count, BvhRayPacket4& p, uint32 lanes) {
+				uint32 found = 0;
+
+				for (uint32 i = first; i < first + count; i++) {
+					BvhFloat4 t, u, v;
+					const uint32 hitLanes = BvhIntersectTriangle(triangles[i], p, lanes, t, u, v);
+
+					if (!hitLanes) {
+						continue;
+					}
+
+					float ts[4], us[4], vs[4];
+					t.Store(ts);
+					u.Store(us);
+					v.Store(vs);
+
+					for (uint32 lane = 0; lane < 4; lane++) {
+						if (hitLanes & (1u << lane)) {
+							p.tMax[lane] = ts[lane];
+							hits[lane].t = ts[lane];
+							hits[lane].u = us[lane];
+							hits[lane].v = vs[lane];
+							hits[lane].primitive = triangles[i].primitive;
+						}
+					}
+
+					found |= hitLanes;
+				}
+
+				return found;
+			});
+		}
+
+		FORCEINLINE const BvhAabb& GetBounds() const { return bounds; }
+
+		FORCEINLINE uint32 GetTriangleCount() const { return uint32(triangles.size()); }
+
+		FORCEINLINE uint32 GetNodeCount() const { return uint32(nodes.size()); }
+
+		FORCEINLINE bool IsEmpty() const { return nodes.empty(); }
+	private:
+		std::vector<BvhNode4> nodes;
+		std::vector<BvhTriangle> triangles;
+		BvhAabb bounds;
+	};
+}
+
+TRE_NS_END
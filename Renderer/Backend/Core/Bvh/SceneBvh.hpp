@@ -0,0 +1,235 @@
+#pragma once
+
+#include <vector>
+
+#include <Renderer/Backend/Core/Bvh/MeshBvh.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// A mesh placed in the scene, the CPU side of a TLAS instance
+	struct BvhInstance
+	{
+		const MeshBvh* mesh = NULL;
+		float transform[3][4];  // Object to world, row major 3x4 like VkTransformMatrixKHR
+		uint32 mask = 0xFF;     // Skipped by rays sharing no bit with it
+	};
+
+	/*
+	 * Two levels like BLAS/TLAS: a BVH over the world boxes of the instances whose leaves send the rays on into the
+	 * meshes' own BVHs, in object space. The ray directions are transformed but not normalized so hit distances are
+	 * the same in both spaces. The meshes are referenced, they have to outlive the scene.
+	 */
+	class SceneBvh
+	{
+	public:
+		void Build(const BvhInstance* instances, uint32 instanceCount, const BvhBuildSettings& settings = BvhBuildSettings())
+		{
+			std::vector<BvhAabb> boxes;
+			std::vector<Instance> placed;
+			std::vector<uint32> order;
+			boxes.reserve(instanceCount);
+			placed.reserve(instanceCount);
+			bounds = BvhAabb();
+
+			for (uint32 i = 0; i < instanceCount; i++) {
+				const BvhInstance& source = instances[i];
+				Instance instance;
+
+				// Empty meshes and singular transforms can't be hit
+				if (!source.mesh || source.mesh->IsEmpty() || !Invert(source.transform, instance.toObject)) {
+					continue;
+				}
+
+				instance.mesh = source.mesh;
+				instance.mask = source.mask;
+				instance.index = i;
+				placed.push_back(instance);
+				boxes.push_back(TransformBox(source.transform, source.mesh->GetBounds()));
+				bounds.Extend(boxes.back());
+			}
+
+			BvhBuildSettings topSettings = settings;
+			topSettings.maxLeafSize = 1;
+			BvhBuilder::Build(boxes.data(), uint32(boxes.size()), topSettings, nodes, order);
+			this->instances.resize(placed.size());
+
+			for (usize i = 0; i < placed.size(); i++) {
+				this->instances[i] = placed[order[i]];
+			}
+		}
+
+		// Closest hit, hit.instance is the index of the instance given to Build
+		bool Intersect(BvhRay& ray, BvhHit& hit) const
+		{
+			if (nodes.empty()) {
+				return false;
+			}
+
+			return BvhTraverse<false>(nodes.data(), ray, [&](uint32 first, uint32 count, BvhRay& r) {
+				bool found = false;
+
+				for (uint32 i = first; i < first + count; i++) {
+					const Instance& instance = instances[i];
+
+					if (!(instance.mask & r.mask)) {
+						continue;
+					}
+
+					BvhRay local = ToObject(instance, r);
+
+					if (instance.mesh->Intersect(local, hit)) {
+						r.tMax = local.tMax;
+						hit.instance = instance.index;
+						found = true;
+					}
+				}
+
+				return found;
+			});
+		}
+
+		bool Occluded(const BvhRay& ray) const
+		{
+			if (nodes.empty()) {
+				return false;
+			}
+
+			BvhRay r = ray;
+			return BvhTraverse<true>(nodes.data(), r, [&](uint32 first, uint32 count, BvhRay& r) {
+				for (uint32 i = first; i < first + count; i++) {
+					const Instance& instance = instances[i];
+
+					if ((instance.mask & r.mask) && instance.mesh->Occluded(ToObject(instance, r))) {
+						return true;
+					}
+				}
+
+				return false;
+			});
+		}
+
+		uint32 Intersect(BvhRayPacket4& packet, BvhHit hits[4]) const
+		{
+			if (nodes.empty() || !packet.active) {
+				return 0;
+			}
+
+			return BvhTraversePacket(nodes.data(), packet, [&](uint32 first, uint32 count, BvhRayPacket4& p, uint32 lanes) {
+				uint32 found = 0;
+
+				for (uint32 i = first; i < first + count; i++) {
+					const Instance& instance = instances[i];
+
+					if (!(instance.mask & p.mask)) {
+						continue;
+					}
+
+					BvhRayPacket4 local;
+					local.mask = p.mask;
+
+					for (uint32 lane = 0; lane < 4; lane++) {
+						if (lanes & (1u << lane)) {
+							local.SetRay(lane, ToObject(instance, p.GetRay(lane)));
+						}
+					}
+
+					const uint32 hitLanes = instance.mesh->Intersect(local, hits);
+
+					for (uint32 lane = 0; lane < 4; lane++) {
+						if (hitLanes & (1u << lane)) {
+							p.tMax[lane] = local.tMax[lane];
+							hits[lane].instance = instance.index;
+						}
+					}
+
+					found |= hitLanes;
+				}
+
+				return found;
+			});
+		}
+
+		FORCEINLINE const BvhAabb& GetBounds() const { return bounds; }
+
+		FORCEINLINE uint32 GetInstanceCount() const { return uint32(instances.size()); }
+	private:
+		struct Instance
+		{
+			const MeshBvh* mesh;
+			float toObject[3][4];
+			uint32 mask;
+			uint32 index;
+		};
+
+		static FORCEINLINE BvhRay ToObject(const Instance& instance, const BvhRay& ray)
+		{
+			const float (&m)[3][4] = instance.toObject;
+			float origin[3];
+			float direction[3];
+
+			for (uint32 row = 0; row < 3; row++) {
+				origin[row] = m[row][0] * ray.origin[0] + m[row][1] * ray.origin[1] + m[row][2] * ray.origin[2] + m[row][3];
+				direction[row] = m[row][0] * ray.direction[0] + m[row][1] * ray.direction[1] + m[row][2] * ray.direction[2];
+			}
+
+			return BvhRay(origin, direction, ray.tMin, ray.tMax, ray.mask);
+		}
+
+		// Inverse of an affine 3x4 transform, false when it is singular
+		static bool Invert(const float (&m)[3][4], float (&inv)[3][4])
+		{
+			const float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+			const float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+			const float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+			const float det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+
+			if (det == 0.f || !isfinite(det)) {
+				return false;
+			}
+
+			const float s = 1.f / det;
+			inv[0][0] = c00 * s;
+			inv[1][0] = c01 * s;
+			inv[2][0] = c02 * s;
+			inv[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * s;
+			inv[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * s;
+			inv[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * s;
+			inv[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * s;
+			inv[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * s;
+			inv[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * s;
+
+			for (uint32 row = 0; row < 3; row++) {
+				inv[row][3] = -(inv[row][0] * m[0][3] + inv[row][1] * m[1][3] + inv[row][2] * m[2][3]);
+			}
+
+			return true;
+		}
+
+		// World box of a transformed box, one axis at a time (Arvo)
+		static BvhAabb TransformBox(const float (&m)[3][4], const BvhAabb& box)
+		{
+			BvhAabb result;
+
+			for (uint32 row = 0; row < 3; row++) {
+				result.min[row] = result.max[row] = m[row][3];
+
+				for (uint32 col = 0; col < 3; col++) {
+					const float a = m[row][col] * box.min[col];
+					const float b = m[row][col] * box.max[col];
+					result.min[row] += a < b ? a : b;
+					result.max[row] += a < b ? b : a;
+				}
+			}
+
+			return result;
+		}
+	private:
+		std::vector<BvhNode4> nodes;
+		std::vector<Instance> instances;
+		BvhAabb bounds;
+	};
+}
+
+TRE_NS_END
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+/*
+ * Objects waiting on the GPU, tagged with the timeline value (frame number, semaphore value...) they were last used at.
+ * Values never go down, so entries are kept in batches of the same value and Collect only looks at the oldest ones.
+ * The batches' storage is recycled. Not thread safe, owned by the thread that destroys the objects.
+ */
+template<typename Entry>
+class DeletionQueue
+{
+public:
+    void Push(const Entry& entry, uint64 retireValue)
+    {
+        if (batches.empty() || batches.back().retireValue != retireValue) {
+            ASSERTF(batches.empty() || batches.back().retireValue <= retireValue,
+                "Retire values must not go down (%" PRIu64 " after %" PRIu64 ")", retireValue, batches.back().retireValue);
+
+            batches.emplace_back();
+            batches.back().retireValue = retireValue;
+
+            if (!spare.empty()) {
+                batches.back().entries.swap(spare.back());
+                spare.pop_back();
+            }
+        }
+
+        batches.back().entries.push_back(entry);
+        pendingCount++;
+    }
+
+    // Appends every entry retired at or before completedValue to out
+    uint32 Collect(uint64 completedValue, std::vector<Entry>& out)
+    {
+        uint32 count = 0;
+
+        while (!batches.empty() && batches.front().retireValue <= completedValue) {
+            std::vector<Entry>& entries = batches.front().entries;
+            out.insert(out.end(), entries.begin(), entries.end());
+            count += (uint32)entries.size();
+
+            entries.clear();
+            spare.emplace_back().swap(entries);
+            batches.pop_front();
+        }
+
+        pendingCount -= count;
+        return count;
+    }
+
+    FORCEINLINE uint32 GetPendingCount() const { return pendingCount; }
+
+    FORCEINLINE bool IsEmpty() const { return pendingCount == 0; }
+
+private:
+    struct Batch
+    {
+        uint64 retireValue;
+        std::vector<Entry> entries;
+    };
+
+    std::deque<Batch> batches;
+    std::vector<std::vector<Entry>> spare;
+    uint32 pendingCount = 0;
+};
+
+struct DeletionWorkerStats
+{
+    uint64 destroyedObjects;
+    uint32 batches;
+    float  lastLatencyMs; // From Submit to the end of the destroy callback
+    float  maxLatencyMs;
+};
+
+/*
+ * Hands batches of entries to a background thread that runs the destroy callback on them, in submission order. Without
+ * Init (or after Shutdown) batches are destroyed on the submitting thread.
+ */
+template<typename Entry>
+class DeletionWorker
+{
+public:
+    typedef void(*FPN_Destroy)(const Entry* entries, uint32 count, void* userData);
+
+    ~DeletionWorker()
+    {
+        this->Shutdown();
+    }
+
+    void Init(FPN_Destroy destroy, void* userData)
+    {
+        this->destroy = destroy;
+        this->userData = userData;
+        stats = {};
+        isRunning = true;
+        thread = std::thread(&DeletionWorker::Run, this);
+    }
+
+    // Destroys what is still queued and joins the thread
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!isRunning)
+                return;
+
+            isRunning = false;
+        }
+
+        condition.notify_one();
+        thread.join();
+    }
+
+    void Submit(const Entry* entries, uint32 count)
+    {
+        if (!count)
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (!isRunning) {
+            lock.unlock();
+
+            if (destroy) {
+                destroy(entries, count, userData);
+            }
+
+            return;
+        }
+
+        queue.emplace_back();
+        Batch& batch = queue.back();
+        batch.submitTime = std::chrono::steady_clock::now();
+
+        if (!spare.empty()) {
+            batch.entries.swap(spare.back());
+            spare.pop_back();
+        }
+
+        batch.entries.assign(entries, entries + count);
+        lock.unlock();
+        condition.notify_one();
+    }
+
+    // Blocks until every submitted batch is destroyed
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return queue.empty() && !isBusy; });
+    }
+
+    FORCEINLINE DeletionWorkerStats GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    struct Batch
+    {
+        std::vector<Entry> entries;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            condition.wait(lock, [this]() { return !queue.empty() || !isRunning; });
+
+            if (queue.empty()) {
+                break;
+            }
+
+            Batch batch = std::move(queue.front());
+            queue.pop_front();
+            isBusy = true;
+            lock.unlock();
+
+            destroy(batch.entries.data(), (uint32)batch.entries.size(), userData);
+            const float latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - batch.submitTime).count();
+
+            lock.lock();
+            stats.destroyedObjects += batch.entries.size();
+            stats.batches++;
+            stats.lastLatencyMs = latency;
+            stats.maxLatencyMs = MAX(stats.maxLatencyMs, latency);
+            batch.entries.clear();
+            spare.emplace_back().swap(batch.entries);
+            isBusy = false;
+
+            if (queue.empty()) {
+                idle.notify_all();
+            }
+        }
+
+        idle.notify_all();
+    }
+
+private:
+    std::deque<Batch> queue;
+    std::vector<std::vector<Entry>> spare;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable idle;
+    FPN_Destroy destroy = NULL;
+    void* userData = NULL;
+    DeletionWorkerStats stats = {};
+    bool isRunning = false;
+    bool isBusy = false;
+};
+
+TRE_NS_END
@@ -1,14 +1,17 @@
 #pragma once
 
+#include <Core/Misc/AsyncLogging.hpp>
+
+// Through the asynchronous logger with the renderer's "[TRE][RENDERER] (TYPE): " prefix, debug messages are compiled
+// out of release builds with TRE_LOG_MIN_SEVERITY
 #define TRE_LOGI(...) \
-	{ printf("[TRE][RENDERER] (INFO): "); printf(__VA_ARGS__); printf("\n"); }\
+	TRE_ALOG_CHANNEL(TRE::AsyncLog::RENDERER, TRE::Log::INFO, __VA_ARGS__)
 
 #define TRE_LOGD(...) \
-	{ printf("\033[93m[TRE][RENDERER] (DEBUG): "); printf(__VA_ARGS__); printf("\033[0m\n"); }\
+	TRE_ALOG_CHANNEL(TRE::AsyncLog::RENDERER, TRE::Log::DEBUG_INFO, __VA_ARGS__)
 
 #define TRE_LOGE(...) \
-	{ printf("\033[91m[TRE][RENDERER] (ERROR): "); printf(__VA_ARGS__); printf("\033[0m\n"); }\
+	TRE_ALOG_CHANNEL(TRE::AsyncLog::RENDERER, TRE::Log::ERR, __VA_ARGS__)
 
 #define TRE_LOGW(...) \
-	{ printf("\033[93m[TRE][RENDERER] (WARNING): "); printf(__VA_ARGS__); printf("\033[0m\n"); }\
-
+	TRE_ALOG_CHANNEL(TRE::AsyncLog::RENDERER, TRE::Log::WARN, __VA_ARGS__)
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+#include <string.h>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	namespace Utils
+	{
+		/*
+		 * Stable LSD radix sort of elements carrying a 64-bit key, 8 bits per pass. A single read of the keys builds the
+		 * histograms of every digit, and digits where all keys agree are skipped (sort keys usually leave most of their
+		 * bits constant within a frame). When threadCount > 1 the elements are split in that many contiguous chunks, each
+		 * scattered through its own prefix offsets on the worker pool, so the result is identical to the single threaded one.
+		 * The sorted elements end up in `data`, `scratch` must hold `count` elements.
+		 */
+		template<typename T, typename KeyFunc>
+		void RadixSort(T* data, T* scratch, usize count, KeyFunc&& getKey, uint32 threadCount = 1);
+
+		namespace Internal
+		{
+			CONSTEXPR static uint32 RADIX_BITS	  = 8;
+			CONSTEXPR static uint32 RADIX_BUCKETS = 1u << RADIX_BITS;
+			CONSTEXPR static uint32 RADIX_PASSES  = 64 / RADIX_BITS;
+
+			// Below this every chunk would only scatter a few cache lines, handing it to a worker costs more than it saves
+			CONSTEXPR static usize RADIX_MIN_ELEMENTS_PER_THREAD = 16 * 1024;
+
+			typedef usize RadixHistogram[RADIX_PASSES][RADIX_BUCKETS];
+
+			template<typename T, typename KeyFunc>
+			FORCEINLINE void RadixHistograms(const T* data, usize begin, usize end, KeyFunc& getKey, RadixHistogram& histogram)
+			{
+				memset(histogram, 0, sizeof(RadixHistogram));
+
+				for (usize i = begin; i < end; i++) {
+					const uint64 key = getKey(data[i]);
+
+					for (uint32 pass = 0; pass < RADIX_PASSES; pass++) {
+						histogram[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+					}
+				}
+			}
+
+			template<typename T, typename KeyFunc>
+			FORCEINLINE void RadixScatter(const T* src, T* dst, usize begin, usize end, uint32 shift, KeyFunc& getKey, usize* offsets)
+			{
+				for (usize i = begin; i < end; i++) {
+					const uint32 digit = (getKey(src[i]) >> shift) & (RADIX_BUCKETS - 1);
+					dst[offsets[digit]++] = src[i];
+				}
+			}
+
+			// A pass is useless when every key falls in the same bucket
+			FORCEINLINE bool RadixPassIsTrivial(const usize* histogram, usize count)
+			{
+				for (uint32 b = 0; b < RADIX_BUCKETS; b++) {
+					if (histogram[b])
+						return histogram[b] == count;
+				}
+
+				return true;
+			}
+		}
+
+		template<typename T, typename KeyFunc>
+		void RadixSort(T* data, T* scratch, usize count, KeyFunc&& getKey, uint32 threadCount)
+		{
+			using namespace Internal;
+
+			if (count < 2)
+				return;
+
+			threadCount = (uint32)MAX(MIN((usize)threadCount, count / RADIX_MIN_ELEMENTS_PER_THREAD), (usize)1);
+			const usize chunkSize = (count + threadCount - 1) / threadCount;
+
+			// Per chunk histograms, the chunk boundaries never move between passes
+			std::vector<RadixHistogram> histograms(threadCount);
+			std::vector<usize> offsets((usize)threadCount * RADIX_BUCKETS);
+			uint32 passes[RADIX_PASSES];
+			uint32 passCount = 0;
+
+			auto chunkBegin = [&](uint32 t) { return MIN(chunkSize * t, count); };
+			auto chunkEnd = [&](uint32 t) { return MIN(chunkSize * (t + 1), count); };
+
+			// Chunk t's offsets for a digit start after every bucket below it and after the chunks before t in that bucket
+			auto computeOffsets = [&](uint32 pass, const std::vector<RadixHistogram>& counts) {
+				usize sum = 0;
+
+				for (uint32 b = 0; b < RADIX_BUCKETS; b++) {
+					for (uint32 t = 0; t < threadCount; t++) {
+						offsets[t * RADIX_BUCKETS + b] = sum;
+						sum += counts[t][pass][b];
+					}
+				}
+			};
+
+			if (threadCount == 1) {
+				RadixHistograms(data, 0, count, getKey, histograms[0]);
+
+				for (uint32 pass = 0; pass < RADIX_PASSES; pass++) {
+					if (!RadixPassIsTrivial(histograms[0][pass], count))
+						passes[passCount++] = pass;
+				}
+
+				T* src = data;
+				T* dst = scratch;
+
+				for (uint32 p = 0; p < passCount; p++) {
+					computeOffsets(passes[p], histograms);
+					RadixScatter(src, dst, 0, count, passes[p] * RADIX_BITS, getKey, offsets.data());
+					std::swap(src, dst);
+				}
+
+				if (src != data) {
+					memcpy((void*)data, src, sizeof(T) * count);
+				}
+
+				return;
+			}
+
+			// Histograms after the first pass depend on how the previous pass moved elements, every chunk is then recounted
+			// in the source buffer only for the digit of the upcoming pass. Each phase runs its chunks on the worker pool.
+			std::vector<RadixHistogram> passHistograms(threadCount);
+			T* buffers[2] = { data, scratch };
+			WorkerPool& pool = WorkerPool::Instance();
+
+			pool.ParallelFor(threadCount, [&](uint32 t) {
+				RadixHistograms(data, chunkBegin(t), chunkEnd(t), getKey, histograms[t]);
+			});
+
+			for (uint32 pass = 0; pass < RADIX_PASSES; pass++) {
+				usize bucketCounts[RADIX_BUCKETS] = {};
+
+				for (uint32 t = 0; t < threadCount; t++) {
+					for (uint32 b = 0; b < RADIX_BUCKETS; b++) {
+						bucketCounts[b] += histograms[t][pass][b];
+					}
+				}
+
+				if (!RadixPassIsTrivial(bucketCounts, count))
+					passes[passCount++] = pass;
+			}
+
+			for (uint32 p = 0; p < passCount; p++) {
+				const uint32 pass = passes[p];
+				const uint32 shift = pass * RADIX_BITS;
+				const T* src = buffers[p & 1];
+				T* dst = buffers[(p + 1) & 1];
+
+				if (p > 0) {
+					pool.ParallelFor(threadCount, [&](uint32 t) {
+						usize* counts = passHistograms[t][pass];
+						memset(counts, 0, sizeof(usize) * RADIX_BUCKETS);
+
+						for (usize i = chunkBegin(t); i < chunkEnd(t); i++) {
+							counts[(getKey(src[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+						}
+					});
+				}
+
+				computeOffsets(pass, p > 0 ? passHistograms : histograms);
+
+				pool.ParallelFor(threadCount, [&](uint32 t) {
+					RadixScatter(src, dst, chunkBegin(t), chunkEnd(t), shift, getKey, offsets.data() + t * RADIX_BUCKETS);
+				});
+			}
+
+			if (passCount & 1) {
+				memcpy((void*)data, scratch, sizeof(T) * count);
+			}
+		}
+	}
+}
+
+TRE_NS_END
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <deque>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+/*
+ * Ring allocator over a buffer of fixed size whose space is given back by timeline value (semaphore value, frame
+ * number...). Allocations made since the last Commit are tagged with the value Commit is given, Release frees every
+ * region whose value completed. Values must not go down. Not thread safe.
+ */
+class TimelineRing
+{
+public:
+    CONSTEXPR static uint64 INVALID_OFFSET = UINT64_MAX;
+
+    explicit TimelineRing(uint64 capacity = 0) : capacity(capacity) {}
+
+    void Init(uint64 capacity)
+    {
+        ASSERTF(used == 0, "Can't resize a ring that is in use");
+        this->capacity = capacity;
+        head = 0;
+        tail = 0;
+    }
+
+    // INVALID_OFFSET when there is no room, Release (or wait on GetOldestValue first) and try again
+    uint64 Allocate(uint64 size, uint64 alignment = 1)
+    {
+        if (size > capacity)
+            return INVALID_OFFSET;
+
+        if (used == 0) {
+            head = 0;
+            tail = 0;
+        }
+
+        const uint64 offset = (head + alignment - 1) / alignment * alignment;
+        uint64 start;
+
+        if (head > tail || used == 0) {
+            // Free space is the end of the buffer, then its start up to the oldest live region
+            if (offset + size <= capacity) {
+                start = offset;
+            } else if (size <= tail) {
+                start = 0;
+            } else {
+                return INVALID_OFFSET;
+            }
+        } else if (head < tail && offset + size <= tail) {
+            start = offset;
+        } else {
+            return INVALID_OFFSET;
+        }
+
+        // Padding and the end of the buffer skipped when wrapping count as part of the allocation
+        const uint64 consumed = (start >= head ? start - head : capacity - head + start) + size;
+        used += consumed;
+        pendingSize += consumed;
+        head = start + size;
+        return start;
+    }
+
+    void Commit(uint64 value)
+    {
+        if (!pendingSize)
+            return;
+
+        ASSERTF(regions.empty() || regions.back().value <= value, "Timeline values must not go down (%" PRIu64 " after %" PRIu64 ")",
+            value, regions.back().value);
+
+        regions.push_back({ head, pendingSize, value });
+        pendingSize = 0;
+    }
+
+    void Release(uint64 completedValue)
+    {
+        while (!regions.empty() && regions.front().value <= completedValue) {
+            tail = regions.front().end;
+            used -= regions.front().size;
+            regions.pop_front();
+        }
+    }
+
+    // The value to wait on to free the oldest region, 0 when nothing committed is in use
+    FORCEINLINE uint64 GetOldestValue() const { return regions.empty() ? 0 : regions.front().value; }
+
+    FORCEINLINE uint64 GetUsedSize() const { return used; }
+
+    FORCEINLINE uint64 GetCapacity() const { return capacity; }
+
+private:
+    struct Region
+    {
+        uint64 end;
+        uint64 size;
+        uint64 value;
+    };
+
+    std::deque<Region> regions;
+    uint64 capacity;
+    uint64 head = 0;
+    uint64 tail = 0;
+    uint64 used = 0;
+    uint64 pendingSize = 0;
+};
+
+TRE_NS_END
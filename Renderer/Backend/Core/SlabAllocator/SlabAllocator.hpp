@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Core/AllocationStrategy/AllocationStrategy.hpp>
+#include <Renderer/Backend/Core/BuddyBlockPool/BuddyBlockPool.hpp>
+
+TRE_NS_START
+
+struct SlabStats
+{
+    uint64 pageBytes;
+    uint64 usedBytes;  // Slots handed out, rounded up to the slot sizes
+    uint32 pageCount;
+    uint32 allocationCount;
+};
+
+/*
+ * Small allocations in fixed size slots. Pages are taken from a BuddyBlockPool (or anything with the same Allocate and
+ * Free) and hold slots of a single size and group. Page offsets are multiples of the page size, which lets Free find
+ * the page of a slot from its offset. An empty page goes back to the pool unless it's the last page of its class.
+ */
+template<typename Pool>
+class SlabAllocator
+{
+public:
+    void Init(Pool* pool, uint64 pageSize)
+    {
+        ASSERTF(pageSize == Math::NextPow2(pageSize), "Slab pages must be a power of 2, got %" PRIu64, pageSize);
+        this->pool = pool;
+        this->pageSize = pageSize;
+        stats = {};
+    }
+
+    void Destroy()
+    {
+        for (const Page& page : pages) {
+            if (page.slotCount) {
+                pool->Free(page.memory);
+            }
+        }
+
+        pages.clear();
+        freePages.clear();
+        classes.clear();
+        lookup.clear();
+        stats = {};
+    }
+
+    // out.size is the slot size, which is what Free expects back
+    bool Allocate(uint64 size, uint64 alignment, uint32 group, BuddyPoolAllocation& out)
+    {
+        const uint64 slotSize = GetSlabSlotSize(size, alignment);
+        ASSERTF(slotSize <= pageSize, "Slab slots of %" PRIu64 " bytes don't fit in a %" PRIu64 " bytes page", slotSize, pageSize);
+
+        const uint64 classKey = this->GetClassKey(slotSize, group);
+        std::vector<uint32>& partial = classes[classKey];
+
+        if (partial.empty()) {
+            const uint32 index = this->AddPage(slotSize, classKey);
+
+            if (index == UINT32_MAX)
+                return false;
+
+            partial.push_back(index);
+        }
+
+        Page& page = pages[partial.back()];
+        uint32 word = 0;
+
+        while (!page.freeMask[word]) {
+            word++;
+        }
+
+        const uint32 bit = (uint32)__builtin_ctzll(page.freeMask[word]);
+        page.freeMask[word] &= ~(1ull << bit);
+        page.freeCount--;
+
+        if (!page.freeCount) {
+            partial.pop_back();
+        }
+
+        const uint32 slot = word * 64 + bit;
+        out = { page.memory.block, page.memory.offset + slot * slotSize, slotSize };
+        stats.usedBytes += slotSize;
+        stats.allocationCount++;
+        return true;
+    }
+
+    void Free(const BuddyPoolAllocation& alloc)
+    {
+        const uint64 pageOffset = alloc.offset & ~(pageSize - 1);
+        const auto it = lookup.find(this->GetPageKey(alloc.block, pageOffset));
+        ASSERTF(it != lookup.end(), "Freeing a slot from a page that doesn't exist");
+
+        const uint32 index = it->second;
+        Page& page = pages[index];
+        const uint32 slot = uint32((alloc.offset - pageOffset) / page.slotSize);
+        page.freeMask[slot / 64] |= 1ull << (slot % 64);
+        page.freeCount++;
+        stats.usedBytes -= page.slotSize;
+        stats.allocationCount--;
+
+        std::vector<uint32>& partial = classes[page.classKey];
+
+        if (page.freeCount == 1) {
+            partial.push_back(index);
+        }
+
+        if (page.freeCount == page.slotCount && partial.size() > 1) {
+            partial.erase(std::find(partial.begin(), partial.end(), index));
+            this->ReleasePage(index);
+        }
+    }
+
+    FORCEINLINE const SlabStats& GetStats() const { return stats; }
+
+    FORCEINLINE uint64 GetPageSize() const { return pageSize; }
+
+private:
+    struct Page
+    {
+        BuddyPoolAllocation memory;
+        uint64 slotSize;
+        uint64 classKey;
+        uint32 slotCount; // 0 once released
+        uint32 freeCount;
+        std::vector<uint64> freeMask;
+    };
+
+    FORCEINLINE static uint64 GetClassKey(uint64 slotSize, uint32 group) { return slotSize << 8 | group; }
+
+    FORCEINLINE static uint64 GetPageKey(uint32 block, uint64 offset) { return uint64(block) << 40 | offset; }
+
+    uint32 AddPage(uint64 slotSize, uint64 classKey)
+    {
+        BuddyPoolAllocation memory;
+
+        if (!pool->Allocate(pageSize, memory))
+            return UINT32_MAX;
+
+        uint32 index;
+
+        if (!freePages.empty()) {
+            index = freePages.back();
+            freePages.pop_back();
+        } else {
+            index = (uint32)pages.size();
+            pages.emplace_back();
+        }
+
+        Page& page = pages[index];
+        page.memory = memory;
+        page.slotSize = slotSize;
+        page.classKey = classKey;
+        page.slotCount = uint32(pageSize / slotSize);
+        page.freeCount = page.slotCount;
+        page.freeMask.assign((page.slotCount + 63) / 64, ~0ull);
+
+        if (page.slotCount % 64) {
+            page.freeMask.back() = (1ull << (page.slotCount % 64)) - 1;
+        }
+
+        lookup[this->GetPageKey(memory.block, memory.offset)] = index;
+        stats.pageBytes += pageSize;
+        stats.pageCount++;
+        return index;
+    }
+
+    void ReleasePage(uint32 index)
+    {
+        Page& page = pages[index];
+        lookup.erase(this->GetPageKey(page.memory.block, page.memory.offset));
+        pool->Free(page.memory);
+        page.slotCount = 0;
+        freePages.push_back(index);
+        stats.pageBytes -= pageSize;
+        stats.pageCount--;
+    }
+
+private:
+    std::vector<Page>                                    pages;
+    std::vector<uint32>                                  freePages;
+    std::unordered_map<uint64, std::vector<uint32>>      classes; // Pages with free slots per slot size and group
+    std::unordered_map<uint64, uint32>                   lookup;  // Page index from its block and offset
+    Pool*                                                pool;
+    uint64                                               pageSize;
+    SlabStats                                            stats;
+};
+
+TRE_NS_END
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Legacy/Misc/Singleton/Singleton.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * The renderer's worker threads, started once and shared by everything that runs CPU work off the render thread:
+	 * draw sorting, BVH builds, the path tracer, pipeline compiles and texture decoding. The services keep their own
+	 * queues and only hand the pool as many jobs as they are allowed to run at once, so together they never run more
+	 * threads than the pool has.
+	 *
+	 * One hardware thread is left to the render thread and one to the threads that mostly block: the deletion worker,
+	 * the async log writer and the IO backend's threads.
+	 */
+	class WorkerPool : public Singleton<WorkerPool>
+	{
+	public:
+		typedef std::function<void()> Job;
+
+	public:
+		WorkerPool()
+		{
+			const uint32 workerCount = GetDefaultWorkerCount();
+			workers.reserve(workerCount);
+
+			for (uint32 i = 0; i < workerCount; i++) {
+				workers.emplace_back(&WorkerPool::ProcessJobs, this);
+			}
+		}
+
+		// Runs what is still queued then joins the workers
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				isRunning = false;
+			}
+
+			condition.notify_all();
+
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+		}
+
+		static uint32 GetDefaultWorkerCount()
+		{
+			const uint32 hardwareThreads = std::thread::hardware_concurrency();
+			return hardwareThreads > 2 ? hardwareThreads - 2 : 1;
+		}
+
+		// Runs job on a worker, in submission order with the other jobs
+		void Submit(Job&& job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				jobs.emplace_back(std::move(job));
+			}
+
+			condition.notify_one();
+		}
+
+		/*
+		 * Calls func(i) for every i in [0, count) and returns once they all ran, on maxThreads threads at most (0 for
+		 * the whole pool) counting the caller. The caller takes indices too and only waits for the ones already running
+		 * elsewhere, so a busy pool (or a call from a worker) runs them on the caller rather than blocking on it.
+		 */
+		template<typename F>
+		void ParallelFor(uint32 count, F&& func, uint32 maxThreads = 0)
+		{
+			const uint32 threadCount = std::min(maxThreads ? maxThreads : count, count);
+			const uint32 helperCount = threadCount ? std::min(threadCount - 1, (uint32)workers.size()) : 0;
+
+			if (!helperCount) {
+				for (uint32 i = 0; i < count; i++) {
+					func(i);
+				}
+
+				return;
+			}
+
+			// Helpers starting after every index was taken only look at the batch, it outlives the call
+			std::shared_ptr<ParallelBatch> batch = std::make_shared<ParallelBatch>(count);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				// Ahead of the services' jobs, the caller is waiting on them
+				for (uint32 i = 0; i < helperCount; i++) {
+					jobs.emplace_front([batch, &func]() { batch->Run(func); });
+				}
+			}
+
+			if (helperCount == 1) {
+				condition.notify_one();
+			} else {
+				condition.notify_all();
+			}
+
+			batch->Run(func);
+			batch->Wait();
+		}
+
+		FORCEINLINE uint32 GetWorkerCount() const { return (uint32)workers.size(); }
+
+	private:
+		struct ParallelBatch
+		{
+			explicit ParallelBatch(uint32 count) : count(count) {}
+
+			template<typename F>
+			void Run(F& func)
+			{
+				uint32 ran = 0;
+
+				for (uint32 i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+					func(i);
+					ran++;
+				}
+
+				if (ran && finished.fetch_add(ran, std::memory_order_acq_rel) + ran == count) {
+					std::lock_guard<std::mutex> lock(mutex);
+					done.notify_all();
+				}
+			}
+
+			void Wait()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				done.wait(lock, [this]() { return finished.load(std::memory_order_acquire) == count; });
+			}
+
+			std::atomic<uint32> next{ 0 };
+			std::atomic<uint32> finished{ 0 };
+			const uint32 count;
+			std::mutex mutex;
+			std::condition_variable done;
+		};
+
+		void ProcessJobs()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (true) {
+				condition.wait(lock, [this]() { return !isRunning || !jobs.empty(); });
+
+				if (jobs.empty())
+					return;
+
+				Job job = std::move(jobs.front());
+				jobs.pop_front();
+
+				lock.unlock();
+				job();
+				lock.lock();
+			}
+		}
+
+	private:
+		std::deque<Job> jobs;
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool isRunning = true;
+	};
+}
+
+TRE_NS_END
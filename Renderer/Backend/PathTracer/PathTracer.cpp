@@ -0,0 +1,456 @@
+#include "PathTracer.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+TRE_NS_START
+
+namespace
+{
+    CONSTEXPR float PI = 3.14159265358979f;
+
+    FORCEINLINE float Dot(const float* a, const float* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+    FORCEINLINE void Cross(const float* a, const float* b, float* out)
+    {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    FORCEINLINE void Normalize(float* v)
+    {
+        const float inv = 1.f / sqrtf(Dot(v, v));
+        v[0] *= inv;
+        v[1] *= inv;
+        v[2] *= inv;
+    }
+
+    // Orthonormal basis around n (Duff et al.)
+    FORCEINLINE void Basis(const float* n, float* t, float* b)
+    {
+        const float sign = n[2] >= 0.f ? 1.f : -1.f;
+        const float a = -1.f / (sign + n[2]);
+        const float c = n[0] * n[1] * a;
+        t[0] = 1.f + sign * n[0] * n[0] * a; t[1] = sign * c; t[2] = -sign * n[0];
+        b[0] = c; b[1] = sign + n[1] * n[1] * a; b[2] = -n[1];
+    }
+}
+
+// PCG32, one sequence per pixel
+struct Renderer::PathTracer::Random
+{
+    uint64 state;
+
+    Random(uint32 seed, uint32 pixel)
+    {
+        // Splitmix the pixel and seed so neighbouring pixels start far apart
+        uint64 z = ((uint64(seed) << 32) | pixel) + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = z ^ (z >> 31);
+    }
+
+    FORCEINLINE uint32 Next()
+    {
+        const uint64 old = state;
+        state = old * 6364136223846793005ull + 1442695040888963407ull;
+        const uint32 xorshifted = uint32(((old >> 18) ^ old) >> 27);
+        const uint32 rot = uint32(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // [0, 1)
+    FORCEINLINE float NextFloat() { return float(this->Next() >> 8) * (1.f / 16777216.f); }
+};
+
+void Renderer::PathTracer::SetScene(const RtScene& scene, const BvhBuildSettings& buildSettings)
+{
+    meshes.clear();
+    meshes.resize(scene.meshes.size());
+    instances.clear();
+    materials = scene.materials;
+    lights = scene.lights;
+    camera = scene.camera;
+    memcpy(background, scene.background, sizeof(background));
+
+    if (materials.empty()) {
+        materials.emplace_back();
+    }
+
+    // SceneBvh points into meshes, it isn't resized past this point
+    for (usize i = 0; i < meshes.size(); i++) {
+        const RtMesh& desc = scene.meshes[i];
+        meshes[i].desc = desc;
+        meshes[i].bvh.Build((const uint8*)desc.vertices + desc.positionOffset, desc.vertexCount, desc.vertexStride,
+            desc.indices, desc.triangleCount, buildSettings);
+    }
+
+    std::vector<BvhInstance> bvhInstances(scene.instances.size());
+    instances.resize(scene.instances.size());
+
+    for (usize i = 0; i < scene.instances.size(); i++) {
+        const RtInstance& source = scene.instances[i];
+        ASSERTF(source.mesh < meshes.size(), "Instance %u uses mesh %u out of %u", uint32(i), source.mesh, uint32(meshes.size()));
+
+        BvhInstance& bvhInstance = bvhInstances[i];
+        bvhInstance.mesh = &meshes[source.mesh].bvh;
+        bvhInstance.mask = source.mask;
+        memcpy(bvhInstance.transform, source.transform, sizeof(bvhInstance.transform));
+
+        Instance& instance = instances[i];
+        instance.mesh = source.mesh;
+        instance.material = source.material < materials.size() ? source.material : 0;
+
+        const float (&m)[4][4] = source.transform;
+
+        for (uint32 row = 0; row < 3; row++) {
+            const uint32 r1 = (row + 1) % 3, r2 = (row + 2) % 3;
+
+            for (uint32 col = 0; col < 3; col++) {
+                const uint32 c1 = (col + 1) % 3, c2 = (col + 2) % 3;
+                instance.normalMatrix[row][col] = m[r1][c1] * m[r2][c2] - m[r1][c2] * m[r2][c1];
+            }
+        }
+    }
+
+    sceneBvh.Build(bvhInstances.data(), uint32(bvhInstances.size()), buildSettings);
+}
+
+void Renderer::PathTracer::Render(const PathTracerSettings& settings, std::vector<float>& image) const
+{
+    ASSERTF(settings.width && settings.height && settings.tileSize, "Empty image or tiles (%ux%u, tile %u)",
+        settings.width, settings.height, settings.tileSize);
+
+    const usize size = usize(settings.width) * settings.height * 3;
+
+    if (image.size() != size) {
+        image.assign(size, 0.f);
+    }
+
+    const uint32 tileCount = this->GetTileCount(settings);
+    const uint32 first = settings.firstTile < tileCount ? settings.firstTile : tileCount;
+    const uint32 end = settings.tileCount && settings.tileCount < tileCount - first ? first + settings.tileCount : tileCount;
+
+    // Tiles are taken in order by whichever thread is free, costly tiles don't hold the others back
+    WorkerPool::Instance().ParallelFor(end - first, [&](uint32 i) {
+        this->RenderTile(settings, first + i, image.data());
+    }, settings.threadCount ? settings.threadCount : 1);
+}
+
+void Renderer::PathTracer::RenderTile(const PathTracerSettings& settings, uint32 tile, float* image) const
+{
+    const uint32 tilesX = this->GetTilesX(settings);
+    const uint32 x0 = (tile % tilesX) * settings.tileSize;
+    const uint32 y0 = (tile / tilesX) * settings.tileSize;
+    const uint32 x1 = x0 + settings.tileSize < settings.width ? x0 + settings.tileSize : settings.width;
+    const uint32 y1 = y0 + settings.tileSize < settings.height ? y0 + settings.tileSize : settings.height;
+
+    for (uint32 y = y0; y < y1; y++) {
+        for (uint32 x = x0; x < x1; x++) {
+            const uint32 pixel = y * settings.width + x;
+            float* out = image + usize(pixel) * 3;
+
+            if (settings.mode == PathTracerMode::BARYCENTRICS) {
+                BvhRay ray = this->CameraRay(settings, float(x) + 0.5f, float(y) + 0.5f);
+                BvhHit hit;
+
+                if (sceneBvh.Intersect(ray, hit)) {
+                    out[0] = 1.f - hit.u - hit.v;
+                    out[1] = hit.u;
+                    out[2] = hit.v;
+                } else {
+                    memcpy(out, background, sizeof(background));
+                }
+
+                continue;
+            }
+
+            Random random(settings.seed, pixel);
+            float sum[3] = { 0.f, 0.f, 0.f };
+
+            for (uint32 s = 0; s < settings.samplesPerPixel; s++) {
+                const float jitterX = random.NextFloat();
+                const float jitterY = random.NextFloat();
+                float radiance[3];
+                this->Trace(settings, this->CameraRay(settings, float(x) + jitterX, float(y) + jitterY), random, radiance);
+
+                for (uint32 c = 0; c < 3; c++) {
+                    sum[c] += radiance[c];
+                }
+            }
+
+            const float scale = settings.samplesPerPixel ? 1.f / float(settings.samplesPerPixel) : 0.f;
+
+            for (uint32 c = 0; c < 3; c++) {
+                out[c] = sum[c] * scale;
+            }
+        }
+    }
+}
+
+// Same as raytrace.rgen
+Renderer::BvhRay Renderer::PathTracer::CameraRay(const PathTracerSettings& settings, float x, float y) const
+{
+    const float dx = x / float(settings.width) * 2.f - 1.f;
+    const float dy = y / float(settings.height) * 2.f - 1.f;
+    const float* view = camera.viewInverse;
+    const float* proj = camera.projInverse;
+    float target[3];
+
+    for (uint32 r = 0; r < 3; r++) {
+        target[r] = proj[r] * dx + proj[4 + r] * dy + proj[8 + r] + proj[12 + r];
+    }
+
+    Normalize(target);
+    const float origin[3] = { view[12], view[13], view[14] };
+    float direction[3];
+
+    for (uint32 r = 0; r < 3; r++) {
+        direction[r] = view[r] * target[0] + view[4 + r] * target[1] + view[8 + r] * target[2];
+    }
+
+    return BvhRay(origin, direction, settings.tMin, settings.tMax);
+}
+
+void Renderer::PathTracer::Trace(const PathTracerSettings& settings, BvhRay ray, Random& random, float (&radiance)[3]) const
+{
+    float throughput[3] = { 1.f, 1.f, 1.f };
+    radiance[0] = radiance[1] = radiance[2] = 0.f;
+
+    for (uint32 bounce = 0; bounce < settings.maxBounces; bounce++) {
+        BvhHit hit;
+
+        if (!sceneBvh.Intersect(ray, hit)) {
+            for (uint32 c = 0; c < 3; c++) {
+                radiance[c] += throughput[c] * background[c];
+            }
+
+            return;
+        }
+
+        const RtMaterial& material = materials[instances[hit.instance].material];
+        float n[3], ng[3];
+        this->GetNormals(ray, hit, n, ng);
+        const float p[3] = { ray.origin[0] + ray.direction[0] * hit.t, ray.origin[1] + ray.direction[1] * hit.t, ray.origin[2] + ray.direction[2] * hit.t };
+
+        // Emitters aren't sampled, paths only find them by hitting them
+        for (uint32 c = 0; c < 3; c++) {
+            radiance[c] += throughput[c] * material.emission[c];
+        }
+
+        // Lights through the diffuse part, the mirror part can't see delta lights
+        const float diffuse = 1.f - material.metallic;
+
+        if (diffuse > 0.f) {
+            for (const RtLight& light : lights) {
+                float toLight[3];
+                float irradiance[3];
+                float distance;
+
+                if (light.type == RtLight::POINT) {
+                    toLight[0] = light.position[0] - p[0];
+                    toLight[1] = light.position[1] - p[1];
+                    toLight[2] = light.position[2] - p[2];
+                    const float distance2 = Dot(toLight, toLight);
+                    distance = sqrtf(distance2);
+
+                    for (uint32 c = 0; c < 3; c++) {
+                        irradiance[c] = light.color[c] / distance2;
+                    }
+                } else {
+                    toLight[0] = -light.position[0];
+                    toLight[1] = -light.position[1];
+                    toLight[2] = -light.position[2];
+                    distance = settings.tMax;
+                    memcpy(irradiance, light.color, sizeof(irradiance));
+                }
+
+                Normalize(toLight);
+                const float cosine = Dot(n, toLight);
+
+                if (cosine <= 0.f || Dot(ng, toLight) <= 0.f) {
+                    continue;
+                }
+
+                const BvhRay shadow(p, toLight, settings.tMin, distance - settings.tMin);
+
+                if (sceneBvh.Occluded(shadow)) {
+                    continue;
+                }
+
+                for (uint32 c = 0; c < 3; c++) {
+                    radiance[c] += throughput[c] * diffuse * material.albedo[c] / PI * irradiance[c] * cosine;
+                }
+            }
+        }
+
+        if (bounce + 1 == settings.maxBounces) {
+            return;
+        }
+
+        // Picks a lobe by its weight, which then cancels out: either way the throughput only takes the albedo
+        float direction[3];
+
+        if (random.NextFloat() < material.metallic) {
+            const float d = 2.f * Dot(ray.direction, n);
+            float fuzz[3];
+
+            // Rough mirrors scatter around the reflection, by a random point of a sphere
+            do {
+                for (uint32 c = 0; c < 3; c++) {
+                    fuzz[c] = random.NextFloat() * 2.f - 1.f;
+                }
+            } while (Dot(fuzz, fuzz) > 1.f);
+
+            for (uint32 c = 0; c < 3; c++) {
+                direction[c] = ray.direction[c] - d * n[c] + material.roughness * fuzz[c];
+            }
+
+            if (Dot(direction, ng) <= 0.f) {
+                return;
+            }
+        } else {
+            // Cosine weighted, the pdf cancels the Lambert cosine and 1 / PI
+            const float r = sqrtf(random.NextFloat());
+            const float phi = 2.f * PI * random.NextFloat();
+            const float lx = r * cosf(phi), ly = r * sinf(phi), lz = sqrtf(1.f - r * r);
+            float t[3], b[3];
+            Basis(n, t, b);
+
+            for (uint32 c = 0; c < 3; c++) {
+                direction[c] = t[c] * lx + b[c] * ly + n[c] * lz;
+            }
+
+            if (Dot(direction, ng) <= 0.f) {
+                return;
+            }
+        }
+
+        for (uint32 c = 0; c < 3; c++) {
+            throughput[c] *= material.albedo[c];
+        }
+
+        // Russian roulette once paths carry little
+        if (bounce >= 3) {
+            float survival = throughput[0] > throughput[1] ? throughput[0] : throughput[1];
+            survival = survival > throughput[2] ? survival : throughput[2];
+
+            if (survival < 1.f) {
+                if (random.NextFloat() >= survival) {
+                    return;
+                }
+
+                for (uint32 c = 0; c < 3; c++) {
+                    throughput[c] /= survival;
+                }
+            }
+        }
+
+        Normalize(direction);
+        ray = BvhRay(p, direction, settings.tMin, settings.tMax);
+    }
+}
+
+void Renderer::PathTracer::GetNormals(const BvhRay& ray, const BvhHit& hit, float (&shading)[3], float (&geometric)[3]) const
+{
+    const Instance& instance = instances[hit.instance];
+    const RtMesh& mesh = meshes[instance.mesh].desc;
+    const uint8* vertices = (const uint8*)mesh.vertices;
+    uint32 index[3];
+
+    for (uint32 k = 0; k < 3; k++) {
+        index[k] = mesh.indices ? mesh.indices[hit.primitive * 3 + k] : hit.primitive * 3 + k;
+    }
+
+    auto attribute = [&](uint32 k, usize offset) {
+        return (const float*)(vertices + index[k] * mesh.vertexStride + offset);
+    };
+
+    const float* p0 = attribute(0, mesh.positionOffset);
+    const float* p1 = attribute(1, mesh.positionOffset);
+    const float* p2 = attribute(2, mesh.positionOffset);
+    const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    float objectGeometric[3];
+    float objectShading[3];
+    Cross(e1, e2, objectGeometric);
+
+    if (mesh.normalOffset != RtMesh::NO_ATTRIBUTE) {
+        const float* n0 = attribute(0, mesh.normalOffset);
+        const float* n1 = attribute(1, mesh.normalOffset);
+        const float* n2 = attribute(2, mesh.normalOffset);
+        const float w = 1.f - hit.u - hit.v;
+
+        for (uint32 c = 0; c < 3; c++) {
+            objectShading[c] = n0[c] * w + n1[c] * hit.u + n2[c] * hit.v;
+        }
+    } else {
+        memcpy(objectShading, objectGeometric, sizeof(objectShading));
+    }
+
+    for (uint32 row = 0; row < 3; row++) {
+        geometric[row] = Dot(instance.normalMatrix[row], objectGeometric);
+        shading[row] = Dot(instance.normalMatrix[row], objectShading);
+    }
+
+    Normalize(geometric);
+    Normalize(shading);
+
+    // Both facing the ray, the shading normal on the side of the geometric one
+    if (Dot(geometric, ray.direction) > 0.f) {
+        for (uint32 c = 0; c < 3; c++) {
+            geometric[c] = -geometric[c];
+        }
+    }
+
+    if (Dot(shading, geometric) < 0.f) {
+        for (uint32 c = 0; c < 3; c++) {
+            shading[c] = -shading[c];
+        }
+    }
+}
+
+bool Renderer::PathTracer::SavePfm(const char* path, const float* image, uint32 width, uint32 height)
+{
+    FILE* file = fopen(path, "wb");
+
+    if (!file)
+        return false;
+
+    // Rows bottom to top, negative scale for little endian
+    bool written = fprintf(file, "PF\n%u %u\n-1.0\n", width, height) > 0;
+
+    for (uint32 y = height; y-- > 0 && written;) {
+        written = fwrite(image + usize(y) * width * 3, sizeof(float), usize(width) * 3, file) == usize(width) * 3;
+    }
+
+    fclose(file);
+    return written;
+}
+
+bool Renderer::PathTracer::LoadPfm(const char* path, std::vector<float>& image, uint32& width, uint32& height)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (!file)
+        return false;
+
+    char magic[3] = {};
+    float scale = 0.f;
+    bool read = fscanf(file, "%2s %u %u %f", magic, &width, &height, &scale) == 4 && !strcmp(magic, "PF") && scale < 0.f;
+    read = read && fgetc(file) == '\n';
+
+    if (read) {
+        image.resize(usize(width) * height * 3);
+
+        for (uint32 y = height; y-- > 0 && read;) {
+            read = fread(image.data() + usize(y) * width * 3, sizeof(float), usize(width) * 3, file) == usize(width) * 3;
+        }
+    }
+
+    fclose(file);
+    return read;
+}
+
+TRE_NS_END
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include <Renderer/Backend/Core/Bvh/SceneBvh.hpp>
+#include <Renderer/Backend/PathTracer/RtScene.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	enum class PathTracerMode : uint32
+	{
+		PATH_TRACE,
+		BARYCENTRICS, // What the raytrace.rchit/rmiss shaders output, to check the GPU path against
+	};
+
+	struct PathTracerSettings
+	{
+		uint32 width = 0;
+		uint32 height = 0;
+		PathTracerMode mode = PathTracerMode::PATH_TRACE;
+		uint32 samplesPerPixel = 16;
+		uint32 maxBounces = 4;      // 1 for direct lighting only
+		uint32 seed = 0;
+		uint32 tileSize = 16;
+		uint32 threadCount = 1;     // Worker pool threads at most, the calling one included
+		float tMin = 0.001f;        // The raygen shader's
+		float tMax = 10000.f;
+
+		// Range of tiles to render, row major, for render nodes each taking a part of the frame. 0 tiles for all
+		uint32 firstTile = 0;
+		uint32 tileCount = 0;
+	};
+
+	/*
+	 * Reference CPU path tracer for regression images and offline renders. Every pixel draws its random numbers from
+	 * its own sequence, seeded by its position, so images are the same bit for bit whatever the thread count or the
+	 * tiles rendered: frames can be split across threads and machines and merged back.
+	 *
+	 * Diffuse and (rough) mirror materials, point and directional lights sampled at every bounce with shadow rays,
+	 * emissive surfaces found by the paths themselves.
+	 */
+	class PathTracer
+	{
+	public:
+		// Builds the BVHs, the scene isn't referenced afterwards but its vertex and index data is
+		void SetScene(const RtScene& scene, const BvhBuildSettings& buildSettings = BvhBuildSettings());
+
+		// Linear RGB, 3 floats per pixel row major from the top. Only the tiles rendered are written
+		void Render(const PathTracerSettings& settings, std::vector<float>& image) const;
+
+		FORCEINLINE uint32 GetTileCount(const PathTracerSettings& settings) const
+		{
+			return this->GetTilesX(settings) * ((settings.height + settings.tileSize - 1) / settings.tileSize);
+		}
+
+		// Portable float map, lossless for reference images
+		static bool SavePfm(const char* path, const float* image, uint32 width, uint32 height);
+
+		static bool LoadPfm(const char* path, std::vector<float>& image, uint32& width, uint32& height);
+	private:
+		struct Instance
+		{
+			uint32 mesh;
+			uint32 material;
+			float normalMatrix[3][3]; // Cofactors of the transform, normals only need the direction
+		};
+
+		struct Mesh
+		{
+			RtMesh desc;
+			MeshBvh bvh;
+		};
+
+		struct Random;
+
+		FORCEINLINE uint32 GetTilesX(const PathTracerSettings& settings) const
+		{
+			return (settings.width + settings.tileSize - 1) / settings.tileSize;
+		}
+
+		void RenderTile(const PathTracerSettings& settings, uint32 tile, float* image) const;
+
+		BvhRay CameraRay(const PathTracerSettings& settings, float x, float y) const;
+
+		void Trace(const PathTracerSettings& settings, BvhRay ray, Random& random, float (&radiance)[3]) const;
+
+		// World space normal of a hit facing the ray, shading normal in shading and geometric one in geometric
+		void GetNormals(const BvhRay& ray, const BvhHit& hit, float (&shading)[3], float (&geometric)[3]) const;
+	private:
+		std::vector<Mesh> meshes;
+		std::vector<Instance> instances;
+		std::vector<RtMaterial> materials;
+		std::vector<RtLight> lights;
+		RtCamera camera;
+		float background[3];
+		SceneBvh sceneBvh;
+	};
+}
+
+TRE_NS_END
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <math.h>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * Scene as the ray tracing path sees it, without any Vulkan object: the vertex and index data the BLASes are built
+	 * from, instances with the transforms BlasInstance takes and the camera the raygen shader reads. Materials and
+	 * lights are what the hit shaders shade with. The CPU path tracer renders straight from it.
+	 */
+	struct RtMesh
+	{
+		CONSTEXPR static usize NO_ATTRIBUTE = ~usize(0);
+
+		const void* vertices = NULL;
+		uint32 vertexCount = 0;
+		usize vertexStride = 0;               // Bytes, like BlasCreateInfo::AddGeometry
+		usize positionOffset = 0;             // 3 floats
+		usize normalOffset = NO_ATTRIBUTE;    // 3 floats, flat shading without
+		const uint32* indices = NULL;         // 3 per triangle, NULL for a triangle list
+		uint32 triangleCount = 0;
+	};
+
+	struct RtMaterial
+	{
+		float albedo[3] = { 0.8f, 0.8f, 0.8f };
+		float emission[3] = { 0.f, 0.f, 0.f };
+		float metallic = 0.f;   // Blend between diffuse and a mirror tinted by albedo
+		float roughness = 0.f;  // Blur of the mirror
+	};
+
+	struct RtInstance
+	{
+		uint32 mesh = 0;
+		uint32 material = 0;
+		uint32 mask = 0xFF;
+		float transform[4][4] = { { 1.f, 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f }, { 0.f, 0.f, 0.f, 1.f } }; // Row major, the last row is ignored
+	};
+
+	struct RtLight
+	{
+		enum Type : uint32
+		{
+			POINT,
+			DIRECTIONAL,
+		};
+
+		Type type = POINT;
+		float position[3] = { 0.f, 0.f, 0.f };  // Direction the light travels for directional lights
+		float color[3] = { 1.f, 1.f, 1.f };     // Intensity for point lights, irradiance for directional ones
+	};
+
+	// The CameraUBO of the raygen shader: column major inverses of the view and projection matrices
+	struct RtCamera
+	{
+		float viewInverse[16];
+		float projInverse[16];
+
+		// Camera at eye looking at target, fovY in radians, with the Y flip of the Vulkan projection
+		static RtCamera LookAt(const float eye[3], const float target[3], const float up[3], float fovY, float aspect)
+		{
+			auto normalize = [](float (&v)[3]) {
+				const float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+				v[0] /= length;
+				v[1] /= length;
+				v[2] /= length;
+			};
+
+			float forward[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+			normalize(forward);
+			float right[3] = { forward[1] * up[2] - forward[2] * up[1], forward[2] * up[0] - forward[0] * up[2], forward[0] * up[1] - forward[1] * up[0] };
+			normalize(right);
+			const float trueUp[3] = { right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2], right[0] * forward[1] - right[1] * forward[0] };
+			const float tanY = tanf(fovY * 0.5f);
+
+			RtCamera camera = {
+				{ right[0], right[1], right[2], 0.f, trueUp[0], trueUp[1], trueUp[2], 0.f,
+				  -forward[0], -forward[1], -forward[2], 0.f, eye[0], eye[1], eye[2], 1.f },
+				{ tanY * aspect, 0.f, 0.f, 0.f, 0.f, -tanY, 0.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f },
+			};
+
+			return camera;
+		}
+	};
+
+	struct RtScene
+	{
+		std::vector<RtMesh> meshes;
+		std::vector<RtMaterial> materials;
+		std::vector<RtInstance> instances;
+		std::vector<RtLight> lights;
+		RtCamera camera;
+		float background[3] = { 0.f, 0.1f, 0.3f }; // Radiance of rays that miss, the miss shader's color
+	};
+}
+
+TRE_NS_END
@@ -26,6 +26,7 @@ Renderer::Buffer::Buffer(RenderDevice& dev, VkBuffer buffer, const BufferInfo& i
 Renderer::Buffer::~Buffer()
 {
     if (apiBuffer != VK_NULL_HANDLE) {
+        device.GetDefragmenter().Unregister(*this);
         device.DestroyBuffer(apiBuffer);
         device.FreeMemory(bufferMemory);
         apiBuffer = VK_NULL_HANDLE;
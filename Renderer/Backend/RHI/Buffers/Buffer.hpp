@@ -69,6 +69,7 @@ namespace Renderer
 
         friend class RenderDevice;
 		friend class StagingManager;
+		friend class MemoryDefragmenter;
 	};
 
 	using BufferHandle = Handle<Buffer>;
@@ -6,6 +6,7 @@
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
 #include <Renderer/Backend/RHI/Descriptors/DescriptorSetAlloc.hpp>
 #include <Renderer/Backend/RHI/Images/Image.hpp>
+#include <Legacy/Profiler/Profiler.hpp>
 #include <Renderer/Backend/RHI/Images/Sampler.hpp>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
 #include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
@@ -98,7 +99,7 @@ void Renderer::CommandBuffer::End()
 
 void Renderer::CommandBuffer::Dispatch(uint32 groupX, uint32 groupY, uint32 groupZ)
 {
-    this->BindPipeline();
+    this->FlushDescriptorSets();
     vkCmdDispatch(commandBuffer, groupX, groupY, groupZ);
 }
 
@@ -244,13 +245,51 @@ void Renderer::CommandBuffer::Draw(uint32 vertexCount, uint32 instanceCount, uin
     vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
+void Renderer::CommandBuffer::DrawIndirect(const Buffer& buffer, DeviceSize offset, uint32 drawCount, uint32 stride)
+{
+    this->FlushDescriptorSets();
+    vkCmdDrawIndirect(commandBuffer, buffer.GetApiObject(), offset, drawCount, stride);
+}
+
+void Renderer::CommandBuffer::DrawIndexedIndirect(const Buffer& buffer, DeviceSize offset, uint32 drawCount, uint32 stride)
+{
+    this->FlushDescriptorSets();
+    vkCmdDrawIndexedIndirect(commandBuffer, buffer.GetApiObject(), offset, drawCount, stride);
+}
+
+void Renderer::CommandBuffer::DrawIndexedIndirectCount(const Buffer& buffer, DeviceSize offset, const Buffer& countBuffer,
+    DeviceSize countOffset, uint32 maxDrawCount, uint32 stride)
+{
+    this->FlushDescriptorSets();
+    vkCmdDrawIndexedIndirectCount(commandBuffer, buffer.GetApiObject(), offset, countBuffer.GetApiObject(), countOffset,
+        maxDrawCount, stride);
+}
+
 void Renderer::CommandBuffer::BindDescriptorSet(const Pipeline& pipeline, const std::initializer_list<VkDescriptorSet>& descriptors,
     const std::initializer_list<uint32>& dyncOffsets)
 {
+    this->BindDescriptorSets(pipeline, 0, descriptors.begin(), (uint32)descriptors.size(), dyncOffsets.begin(), (uint32)dyncOffsets.size());
+}
+
+void Renderer::CommandBuffer::BindDescriptorSets(const Pipeline& pipeline, uint32 firstSet, const VkDescriptorSet* descriptors, 
+    uint32 count, const uint32* dyncOffsets, uint32 dyncOffsetsCount)
+{
+    ASSERTF(firstSet + count <= MAX_DESCRIPTOR_SET, "Binding sets %u to %u, there are %u", firstSet, firstSet + count - 1, MAX_DESCRIPTOR_SET);
+
     vkCmdBindDescriptorSets(commandBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        (VkPipelineBindPoint)pipeline.GetPipelineType(),
         pipeline.GetPipelineLayout().GetApiObject(),
-        0, (uint32)descriptors.size(), descriptors.begin(), (uint32)dyncOffsets.size(), dyncOffsets.begin());
+        firstSet, count, descriptors, dyncOffsetsCount, dyncOffsets);
+
+    // The sets bound here replace whatever the Set* calls left pending for them, the next flush must not rebind those
+    // over them. Their resources aren't known, a later Set* call on them starts from the cached bindings again.
+    const uint8 boundSets = uint8(((1u << count) - 1) << firstSet);
+    dirty.sets &= ~boundSets;
+    dirty.dynamicSets &= ~boundSets;
+
+    for (uint32 i = 0; i < count; i++) {
+        allocatedSets[firstSet + i] = descriptors[i];
+    }
 }
 
 void Renderer::CommandBuffer::SetGraphicsState(GraphicsState& state)
@@ -389,6 +428,10 @@ void Renderer::CommandBuffer::SetInputAttachments(uint32 set, uint32 startBindin
 
 void Renderer::CommandBuffer::PushConstants(ShaderStagesFlags stages, const void* data, VkDeviceSize size, VkDeviceSize offset)
 {
+    if (pipeline == NULL) {
+        this->BindPipeline();
+    }
+
     const auto& pipelineLayout = pipeline->GetPipelineLayout();
     const auto& pushConstant = pipelineLayout.GetPushConstantRangeFromStage(stages);
 
@@ -565,6 +608,11 @@ void Renderer::CommandBuffer::CopyBuffer(const Buffer& srcBuffer, const Buffer&
     vkCmdCopyBuffer(commandBuffer, srcBuffer.GetApiObject(), dstBuffer.GetApiObject(), copies.size, copies.data);
 }
 
+void Renderer::CommandBuffer::FillBuffer(const Buffer& buffer, uint32 value, DeviceSize offset, DeviceSize size)
+{
+    vkCmdFillBuffer(commandBuffer, buffer.GetApiObject(), offset, size, value);
+}
+
 void Renderer::CommandBuffer::CopyBufferToImage(const Buffer& srcBuffer, const Image& dstImage, VkDeviceSize bufferOffset,
     const VkOffset3D& imageOffset, const VkExtent3D& imageExtent, uint32_t bufferRowLength, uint32_t bufferImageHeight, 
     const VkImageSubresourceLayers& imageSubresource)
@@ -884,7 +932,7 @@ void Renderer::CommandBuffer::UpdateDescriptorSet([[maybe_unused]] uint32 set, V
         }
     }
 
-    printf("Updating descriptor sets: writting count:%u\n", writeCount);
+    TRE_LOGD("Updating descriptor sets: writting count:%u", writeCount);
     vkUpdateDescriptorSets(device.GetDevice(), writeCount, writes, 0, NULL);
 }
 
@@ -933,6 +981,7 @@ void Renderer::CommandBuffer::FlushDescriptorSet(uint32 set)
 
 void Renderer::CommandBuffer::FlushDescriptorSets()
 {
+    TRE_PROFILE_SCOPE("CommandBuffer::FlushDescriptorSets");
     if (pipeline == NULL) {
         this->BindPipeline();
     }
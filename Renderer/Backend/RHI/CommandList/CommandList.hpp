@@ -98,9 +98,22 @@ namespace Renderer
 
 		void Draw(uint32 vertexCount, uint32 instanceCount = 1, uint32 firstVertex = 0, uint32 firstInstance = 0);
 
+		// Indirect draws, the arguments are read from the buffer when the GPU executes them
+		void DrawIndirect(const Buffer& buffer, DeviceSize offset, uint32 drawCount, uint32 stride = sizeof(VkDrawIndirectCommand));
+
+		void DrawIndexedIndirect(const Buffer& buffer, DeviceSize offset, uint32 drawCount, uint32 stride = sizeof(VkDrawIndexedIndirectCommand));
+
+		// Draws as many commands as the uint32 at countOffset in countBuffer says, at most maxDrawCount
+		void DrawIndexedIndirectCount(const Buffer& buffer, DeviceSize offset, const Buffer& countBuffer, DeviceSize countOffset,
+			uint32 maxDrawCount, uint32 stride = sizeof(VkDrawIndexedIndirectCommand));
+
 		void BindDescriptorSet(const Pipeline& pipeline, const std::initializer_list<VkDescriptorSet>& descriptors, 
 			const std::initializer_list<uint32>& dyncOffsets);
 
+		// Binds prebuilt sets, they stop being dirty: the next draw doesn't rebind the Set* resources over them
+		void BindDescriptorSets(const Pipeline& pipeline, uint32 firstSet, const VkDescriptorSet* descriptors, uint32 count,
+			const uint32* dyncOffsets = NULL, uint32 dyncOffsetsCount = 0);
+
 		void BindShaderProgram(ShaderProgram& program);
 
 		// Graphics State functions:
@@ -135,6 +148,8 @@ namespace Renderer
 
 		void CopyBuffer(const Buffer& srcBuffer, const Buffer& dstBuffer);
 
+		void FillBuffer(const Buffer& buffer, uint32 value, DeviceSize offset = 0, DeviceSize size = VK_WHOLE_SIZE);
+
 		void CopyBuffer(const Buffer& srcBuffer, const Buffer& dstBuffer, const VectorView<VkBufferCopy>& copies);
 
 
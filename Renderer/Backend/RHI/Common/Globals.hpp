@@ -34,17 +34,22 @@ namespace Renderer
 		}\
 
 	const std::initializer_list<const char*> VK_REQ_EXT = {
-		VK_KHR_SURFACE_EXTENSION_NAME,
 		VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
 
+#if defined(DEBUG) && defined(VALIDATION_LAYERS)
+		VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+		VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
+#endif
+	};
+
+	// Only required when rendering to a window, headless contexts skip them
+	const std::initializer_list<const char*> VK_REQ_SURFACE_EXT = {
+		VK_KHR_SURFACE_EXTENSION_NAME,
+
 #if defined(OS_WINDOWS)
 		VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
 #elif defined(OS_LINUX)
 		VK_KHR_XLIB_SURFACE_EXTENSION_NAME,
-#endif
-#if defined(DEBUG) && defined(VALIDATION_LAYERS)
-		VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
-		VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
 #endif
 	};
 
@@ -61,6 +66,9 @@ namespace Renderer
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 	};
 
+	const std::initializer_list<const char*> VK_REQ_HEADLESS_DEVICE_EXT = {
+	};
+
 	const std::initializer_list<const char*> DEV_EXTENSIONS[] = {
 		// Ray-Tracing
 		{
@@ -84,8 +92,8 @@ namespace Renderer
 	CONSTEXPR static uint32 MAX_THREADS				= 1;
 
 	// Frame related constants:
-    CONSTEXPR static uint32	MAX_FRAMES				= 2;
-    CONSTEXPR static uint32	NUM_FRAMES				= 2;
+    CONSTEXPR static uint32	MAX_FRAMES				= 3; // Frames in flight are picked at runtime up to this (FramePacingSettings)
+    CONSTEXPR static uint32	NUM_FRAMES				= 2; // Default frames in flight
     CONSTEXPR static uint32	MAX_IMAGES_COUNT		= 8;
 
 	// Descriptor related constants:
@@ -347,8 +355,14 @@ namespace Renderer
 			VkPhysicalDeviceFeatures2						 deviceFeatures2;
 			VkPhysicalDeviceAccelerationStructureFeaturesKHR accelFeatures;
 			VkPhysicalDeviceRayTracingPipelineFeaturesKHR	 rtPipelineFeatures;
-			VkPhysicalDeviceBufferDeviceAddressFeatures		 buffAdrFeatures;
-			VkPhysicalDeviceTimelineSemaphoreFeatures	     timelineSemaphoreFeatures;
+			VkPhysicalDeviceVulkan12Features				 vulkan12Features; // Timeline semaphores, buffer addresses, indirect count...
+#if defined(VK_KHR_present_wait)
+			VkPhysicalDevicePresentIdFeaturesKHR			 presentIdFeatures;
+			VkPhysicalDevicePresentWaitFeaturesKHR			 presentWaitFeatures;
+#endif
+#if defined(VK_EXT_graphics_pipeline_library)
+			VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures;
+#endif
 
 			VkDevice							device;
 			QueueFamilyIndices					queueFamilyIndices;
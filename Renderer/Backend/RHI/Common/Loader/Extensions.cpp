@@ -1482,6 +1482,31 @@ int load_VK_NV_device_generated_commands(VkInstance instance, PFN_vkGetInstanceP
 }
 #endif
 
+/* /////////////////////////////////// */
+#if VK_KHR_present_wait
+static PFN_vkWaitForPresentKHR pfn_vkWaitForPresentKHR = 0;
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitForPresentKHR(
+    VkDevice device,
+    VkSwapchainKHR swapchain,
+    uint64_t presentId,
+    uint64_t timeout)
+{
+    assert(pfn_vkWaitForPresentKHR);
+    return pfn_vkWaitForPresentKHR(device, swapchain, presentId, timeout);
+}
+
+int has_VK_KHR_present_wait = 0;
+int load_VK_KHR_present_wait(VkInstance instance, PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr)
+{
+    pfn_vkWaitForPresentKHR = (PFN_vkWaitForPresentKHR)getDeviceProcAddr(device, "vkWaitForPresentKHR");
+    int success = 1;
+    success = success && (pfn_vkWaitForPresentKHR != 0);
+    has_VK_KHR_present_wait = success;
+    return success;
+}
+#endif
+
 
 /* super load/reset */
 void load_VK_EXTENSION_SUBSET(VkInstance instance, PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr)
@@ -1561,6 +1586,9 @@ void load_VK_EXTENSION_SUBSET(VkInstance instance, PFN_vkGetInstanceProcAddr get
 #if VK_NV_device_generated_commands
     load_VK_NV_device_generated_commands(instance, getInstanceProcAddr, device, getDeviceProcAddr);
 #endif
+#if VK_KHR_present_wait
+    load_VK_KHR_present_wait(instance, getInstanceProcAddr, device, getDeviceProcAddr);
+#endif
 }
 void reset_VK_EXTENSION_SUBSET()
 {
@@ -1760,5 +1788,10 @@ void reset_VK_EXTENSION_SUBSET()
     PFN_vkDestroyIndirectCommandsLayoutNV pfn_vkDestroyIndirectCommandsLayoutNV = 0;
 #endif
 
+#if VK_KHR_present_wait
+    has_VK_KHR_present_wait = 0;
+    PFN_vkWaitForPresentKHR pfn_vkWaitForPresentKHR = 0;
+#endif
+
 }
 
@@ -210,4 +210,10 @@ int load_VK_NV_device_generated_commands(VkInstance instance, PFN_vkGetInstanceP
 extern int has_VK_NV_device_generated_commands;
 #endif
 
+#if VK_KHR_present_wait
+#define LOADER_VK_KHR_present_wait 1
+int load_VK_KHR_present_wait(VkInstance instance, PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr);
+extern int has_VK_KHR_present_wait;
+#endif
+
 
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <Renderer/Backend/Common.hpp>
-#include <fstream>
 
 TRE_NS_START
 
@@ -61,22 +60,6 @@ namespace Renderer
         }
     }
     
-    FORCEINLINE std::vector<char> ReadShaderFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file!");
-        }
-
-        size_t fileSize = (size_t)file.tellg();
-        std::vector<char> buffer(fileSize);
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
-
-        return buffer;
-    }
-
     FORCEINLINE uint32 GetSetBit(uint32 bitmask)
     {
         uint32 i = 0;
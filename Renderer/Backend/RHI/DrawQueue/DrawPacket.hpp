@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Renderer/Backend/Common.hpp>
+#include <Renderer/Backend/RHI/DrawQueue/DrawQueue.hpp>
+#include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	class Pipeline;
+	class Buffer;
+
+	typedef BasicDrawPacket<Pipeline, VkDescriptorSet, Buffer> DrawPacket;
+	typedef DrawQueue<DrawPacket> RenderQueue;
+
+	// Forwards the replayed draws to a CommandBuffer
+	struct CommandBufferRecorder
+	{
+		CommandBuffer& cmd;
+
+		FORCEINLINE void BindPipeline(const Pipeline& pipeline) { cmd.BindPipeline(pipeline); }
+
+		FORCEINLINE void BindDescriptorSets(const Pipeline& pipeline, uint32 firstSet, const VkDescriptorSet* sets, uint32 count,
+			const uint32* dynamicOffsets, uint32 dynamicOffsetsCount)
+		{
+			cmd.BindDescriptorSets(pipeline, firstSet, sets, count, dynamicOffsets, dynamicOffsetsCount);
+		}
+
+		FORCEINLINE void BindVertexBuffer(const Buffer& buffer, uint64 offset) { cmd.BindVertexBuffer(buffer, offset); }
+
+		FORCEINLINE void BindIndexBuffer(const Buffer& buffer, uint64 offset, uint8 indexType)
+		{
+			cmd.BindIndexBuffer(buffer, offset, (VkIndexType)indexType);
+		}
+
+		FORCEINLINE void Draw(uint32 vertexCount, uint32 instanceCount, uint32 firstVertex, uint32 firstInstance)
+		{
+			cmd.Draw(vertexCount, instanceCount, firstVertex, firstInstance);
+		}
+
+		FORCEINLINE void DrawIndexed(uint32 indexCount, uint32 instanceCount, uint32 firstIndex, int32 vertexOffset, uint32 firstInstance)
+		{
+			cmd.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+		}
+	};
+
+	FORCEINLINE DrawReplayStats ReplayDraws(CommandBuffer& cmd, const RenderQueue& queue)
+	{
+		CommandBufferRecorder recorder{ cmd };
+		return ReplayDraws(queue, recorder);
+	}
+}
+
+TRE_NS_END
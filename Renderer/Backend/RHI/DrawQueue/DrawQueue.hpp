@@ -0,0 +1,249 @@
+#pragma once
+
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Core/RadixSort/RadixSort.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * 64-bit draw sort key, from the most to the least significant bits:
+	 * | pass (6) | pipeline (18) | material (16) | depth (24) |
+	 * Sorting the keys groups the draws of a pass by pipeline then by material, depth only orders draws sharing both.
+	 * The pipeline hash is folded down to 18 bits, a collision only costs an extra bind as replay compares the real objects.
+	 */
+	struct DrawKey
+	{
+		CONSTEXPR static uint32 DEPTH_BITS	  = 24;
+		CONSTEXPR static uint32 MATERIAL_BITS = 16;
+		CONSTEXPR static uint32 PIPELINE_BITS = 18;
+		CONSTEXPR static uint32 PASS_BITS	  = 6;
+
+		CONSTEXPR static uint32 DEPTH_SHIFT	   = 0;
+		CONSTEXPR static uint32 MATERIAL_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+		CONSTEXPR static uint32 PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+		CONSTEXPR static uint32 PASS_SHIFT	   = PIPELINE_SHIFT + PIPELINE_BITS;
+
+		CONSTEXPR static uint32 MAX_PASSES = 1u << PASS_BITS;
+
+		static FORCEINLINE uint64 Encode(uint32 pass, uint64 pipelineHash, uint32 material, uint32 depth)
+		{
+			return (uint64(pass) & Mask(PASS_BITS)) << PASS_SHIFT |
+				FoldPipelineHash(pipelineHash) << PIPELINE_SHIFT |
+				(uint64(material) & Mask(MATERIAL_BITS)) << MATERIAL_SHIFT |
+				(uint64(depth) & Mask(DEPTH_BITS)) << DEPTH_SHIFT;
+		}
+
+		// Maps a view space depth in [nearPlane, farPlane] to the key's depth bits, translucent draws want back to front
+		static FORCEINLINE uint32 QuantizeDepth(float depth, float nearPlane, float farPlane, bool backToFront = false)
+		{
+			float t = (depth - nearPlane) / (farPlane - nearPlane);
+			t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+			const uint32 quantized = uint32(t * float(Mask(DEPTH_BITS)));
+			return backToFront ? uint32(Mask(DEPTH_BITS)) - quantized : quantized;
+		}
+
+		static FORCEINLINE uint32 GetPass(uint64 key) { return uint32(key >> PASS_SHIFT); }
+
+		static FORCEINLINE uint32 GetPipeline(uint64 key) { return uint32((key >> PIPELINE_SHIFT) & Mask(PIPELINE_BITS)); }
+
+		static FORCEINLINE uint32 GetMaterial(uint64 key) { return uint32((key >> MATERIAL_SHIFT) & Mask(MATERIAL_BITS)); }
+
+		static FORCEINLINE uint32 GetDepth(uint64 key) { return uint32((key >> DEPTH_SHIFT) & Mask(DEPTH_BITS)); }
+
+		static CONSTEXPR FORCEINLINE uint64 Mask(uint32 bits) { return (1ull << bits) - 1; }
+
+		static FORCEINLINE uint64 FoldPipelineHash(uint64 hash)
+		{
+			hash ^= hash >> 36;
+			hash ^= hash >> 18;
+			return hash & Mask(PIPELINE_BITS);
+		}
+	};
+
+	/*
+	 * Everything needed to emit one draw without touching any other state. The handle types are template parameters so
+	 * that the sort and replay logic doesn't depend on Vulkan (the RHI instantiation is DrawPacket in DrawPacket.hpp).
+	 * A descriptor set whose bit is set in dynamicSets consumes exactly one entry of dynamicOffsets.
+	 */
+	template<typename PipelineT, typename DescriptorSetT, typename BufferT>
+	struct BasicDrawPacket
+	{
+		CONSTEXPR static uint32 MAX_SETS = 4;
+
+		const PipelineT* pipeline;
+		const BufferT* vertexBuffer;
+		const BufferT* indexBuffer; // Non indexed draw when NULL
+		uint64 vertexBufferOffset;
+		uint64 indexBufferOffset;
+
+		DescriptorSetT descriptorSets[MAX_SETS];
+		uint32 dynamicOffsets[MAX_SETS];
+		uint8 descriptorSetCount;
+		uint8 dynamicSets;
+		uint8 indexType; // Backend value (VkIndexType)
+
+		uint32 count; // Index count, or vertex count for non indexed draws
+		uint32 instanceCount;
+		uint32 first;
+		int32 vertexOffset;
+		uint32 firstInstance;
+	};
+
+	/*
+	 * Stateless submission queue: packets are written once to a linear array and only 16 byte (key, index) items
+	 * are sorted, the packets themselves never move. Reset() keeps the storage around so steady state frames
+	 * don't allocate.
+	 */
+	template<typename Packet>
+	class DrawQueue
+	{
+	public:
+		struct Item
+		{
+			uint64 key;
+			uint32 packet;
+		};
+
+	public:
+		DrawQueue(usize capacity = 0) { this->Reserve(capacity); }
+
+		FORCEINLINE void Reserve(usize capacity)
+		{
+			items.reserve(capacity);
+			scratch.reserve(capacity);
+			packets.reserve(capacity);
+		}
+
+		FORCEINLINE void Reset()
+		{
+			items.clear();
+			packets.clear();
+		}
+
+		FORCEINLINE Packet& Push(uint64 key)
+		{
+			items.push_back(Item{ key, (uint32)packets.size() });
+			return packets.emplace_back();
+		}
+
+		FORCEINLINE void Push(uint64 key, const Packet& packet) { this->Push(key) = packet; }
+
+		FORCEINLINE void Sort(uint32 threadCount = 1)
+		{
+			scratch.resize(items.size());
+			Utils::RadixSort(items.data(), scratch.data(), items.size(), [](const Item& item) { return item.key; }, threadCount);
+		}
+
+		FORCEINLINE usize Size() const { return items.size(); }
+
+		FORCEINLINE bool IsEmpty() const { return items.empty(); }
+
+		FORCEINLINE const Item* GetItems() const { return items.data(); }
+
+		FORCEINLINE const Packet& GetPacket(const Item& item) const { return packets[item.packet]; }
+
+	private:
+		std::vector<Item> items;
+		std::vector<Item> scratch;
+		std::vector<Packet> packets;
+	};
+
+	struct DrawReplayStats
+	{
+		uint32 draws;
+		uint32 pipelineBinds;
+		uint32 descriptorSetBinds;
+		uint32 vertexBufferBinds;
+		uint32 indexBufferBinds;
+	};
+
+	/*
+	 * Emits the queue in its current order to a recorder exposing BindPipeline, BindDescriptorSets, BindVertexBuffer,
+	 * BindIndexBuffer, Draw and DrawIndexed (see CommandBufferRecorder). Binds matching the state left by the previous
+	 * draw are skipped, and changed descriptor sets are bound as contiguous ranges. Changing pipeline invalidates the
+	 * bound sets since the layout may differ.
+	 */
+	template<typename Packet, typename Recorder>
+	DrawReplayStats ReplayDraws(const DrawQueue<Packet>& queue, Recorder& recorder)
+	{
+		CONSTEXPR uint32 MAX_SETS = Packet::MAX_SETS;
+
+		DrawReplayStats stats{};
+		const Packet* bound = NULL;
+		uint32 boundSetCount = 0;
+
+		for (usize i = 0; i < queue.Size(); i++) {
+			const Packet& packet = queue.GetPacket(queue.GetItems()[i]);
+
+			if (!bound || packet.pipeline != bound->pipeline) {
+				recorder.BindPipeline(*packet.pipeline);
+				stats.pipelineBinds++;
+				boundSetCount = 0;
+			}
+
+			// First set that differs from what is bound, everything after it is rebound as one range
+			uint32 firstDirty = MAX_SETS;
+			uint32 dynamicBefore = 0;
+
+			for (uint32 s = 0; s < packet.descriptorSetCount; s++) {
+				const bool isDynamic = packet.dynamicSets & (1u << s);
+				const bool same = s < boundSetCount && packet.descriptorSets[s] == bound->descriptorSets[s] &&
+					isDynamic == bool(bound->dynamicSets & (1u << s)) &&
+					(!isDynamic || packet.dynamicOffsets[dynamicBefore] == bound->dynamicOffsets[dynamicBefore]);
+
+				if (!same) {
+					firstDirty = s;
+					break;
+				}
+
+				dynamicBefore += isDynamic;
+			}
+
+			if (firstDirty < packet.descriptorSetCount) {
+				uint32 dynamicCount = 0;
+
+				for (uint32 s = firstDirty; s < packet.descriptorSetCount; s++) {
+					dynamicCount += bool(packet.dynamicSets & (1u << s));
+				}
+
+				recorder.BindDescriptorSets(*packet.pipeline, firstDirty, packet.descriptorSets + firstDirty,
+					packet.descriptorSetCount - firstDirty, packet.dynamicOffsets + dynamicBefore, dynamicCount);
+				stats.descriptorSetBinds++;
+			}
+
+			boundSetCount = packet.descriptorSetCount;
+
+			if (packet.vertexBuffer && (!bound || packet.vertexBuffer != bound->vertexBuffer ||
+				packet.vertexBufferOffset != bound->vertexBufferOffset))
+			{
+				recorder.BindVertexBuffer(*packet.vertexBuffer, packet.vertexBufferOffset);
+				stats.vertexBufferBinds++;
+			}
+
+			if (packet.indexBuffer) {
+				if (!bound || packet.indexBuffer != bound->indexBuffer || packet.indexBufferOffset != bound->indexBufferOffset ||
+					packet.indexType != bound->indexType)
+				{
+					recorder.BindIndexBuffer(*packet.indexBuffer, packet.indexBufferOffset, packet.indexType);
+					stats.indexBufferBinds++;
+				}
+
+				recorder.DrawIndexed(packet.count, packet.instanceCount, packet.first, packet.vertexOffset, packet.firstInstance);
+			} else {
+				recorder.Draw(packet.count, packet.instanceCount, packet.first, packet.firstInstance);
+			}
+
+			stats.draws++;
+			bound = &packet;
+		}
+
+		return stats;
+	}
+}
+
+TRE_NS_END
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// How frames are handed to the screen, a mode the surface doesn't support falls back to FIFO
+	enum class PresentMode : uint8
+	{
+		FIFO,			// Vsync, always supported
+		FIFO_RELAXED,	// Vsync, but a late frame is shown right away (and tears) instead of waiting a whole interval
+		MAILBOX,		// Vsync, a newer frame replaces the one queued
+		IMMEDIATE,		// No vsync, shown as soon as it's ready, tears
+	};
+
+	struct FramePacingSettings
+	{
+		PresentMode	presentMode			= PresentMode::MAILBOX;
+		uint32		framesInFlight		= 2;		// Clamped to [1, MAX_FRAMES]
+		uint32		targetFrameTimeUs	= 0;		// Frame rate cap, 0 for none
+		uint32		jitMarginUs			= 1000;		// Least slack kept between a just in time frame's expected end and its present
+		bool		presentWait			= false;	// Time presents and wait for the previous one before a frame starts (VK_KHR_present_wait)
+		bool		justInTime			= false;	// Start frames (and sample input) as late as they can and still make their present, needs present waits
+	};
+
+	struct FrameLatencyStats
+	{
+		uint64	frameId;			// Last frame measured
+		uint32	lastUs;				// Its latency, from the start of the frame to its present
+		uint32	averageUs;			// Over the last count frames
+		uint32	minUs;
+		uint32	maxUs;
+		uint32	count;
+		uint32	presentIntervalUs;	// Measured time between presents, 0 until known
+		uint32	marginUs;			// Slack just in time pacing currently keeps
+		bool	presentTimed;		// Measured up to the present, otherwise up to when the GPU was seen done with the frame
+	};
+
+	/*
+	 * Paces frames and measures how long after its start (when its input is sampled) each frame was presented. The frame
+	 * loop reports when a frame starts, when the CPU is done with it and when it is done: presented when presents can be
+	 * waited on, otherwise when the GPU was seen done with it, an upper bound that says nothing of when it was shown.
+	 *
+	 * GetWakeTime tells when the next frame should start. A frame rate cap starts frames one target interval apart. Just
+	 * in time pacing needs present times and a presentation rate (vsync or the cap): the frame starts so that its expected
+	 * CPU time plus a margin ends right before the first present slot it can still make. A frame presented late doubles the
+	 * margin (it has to cover the GPU time as well), frames on time slowly give it back.
+	 * Times are in microseconds. Not thread safe.
+	 */
+	class FramePacer
+	{
+	public:
+		CONSTEXPR static uint32 MAX_PENDING_FRAMES	= 16;
+		CONSTEXPR static uint32 LATENCY_HISTORY		= 64;
+
+		FramePacer() : records{}, history{}, historyCount(0), lastStart(0), lastBegunId(0), lastPresent(0), lastPresentId(0),
+			nextTargetPresent(0), cpuEstimate(0), presentInterval(0), margin(0), lastFrameId(0), presentTimed(false), vsync(true)
+		{
+			this->SetSettings(FramePacingSettings());
+		}
+
+		void SetSettings(const FramePacingSettings& settings)
+		{
+			this->settings = settings;
+			margin = settings.jitMarginUs;
+		}
+
+		// Whether presents follow the display rate (FIFO modes), what the swapchain ended up with rather than what was asked
+		FORCEINLINE void SetVsync(bool vsync) { this->vsync = vsync; }
+
+		void BeginFrame(uint64 frameId, uint64 now)
+		{
+			FrameRecord& record = records[frameId % MAX_PENDING_FRAMES];
+			record.id = frameId;
+			record.start = now;
+			record.targetPresent = nextTargetPresent;
+			record.begun = true;
+			record.done = false;
+
+			nextTargetPresent = 0;
+			lastStart = now;
+			lastBegunId = frameId;
+		}
+
+		// The CPU handed the frame to the GPU and the presentation engine
+		void EndFrame(uint64 frameId, uint64 now)
+		{
+			const FrameRecord* record = this->Find(frameId);
+
+			if (!record)
+				return;
+
+			const uint64 cpuTime = now - record->start;
+			cpuEstimate = cpuEstimate ? (cpuEstimate * 7 + cpuTime) / 8 : cpuTime;
+		}
+
+		// The frame is on screen (presented) or the GPU was seen done with it, reported once, later calls are ignored
+		void OnFrameDone(uint64 frameId, uint64 now, bool presented)
+		{
+			FrameRecord* record = this->Find(frameId);
+
+			if (!record || record->done)
+				return;
+
+			record->done = true;
+			history[historyCount++ % LATENCY_HISTORY] = (uint32)std::min<uint64>(now - record->start, UINT32_MAX);
+			lastFrameId = frameId;
+			presentTimed = presented;
+
+			if (!presented) {
+				lastPresent = 0;
+				return;
+			}
+
+			// Consecutive presents are an interval apart, or a multiple of it when one missed its slot
+			if (lastPresent && lastPresentId + 1 == frameId) {
+				const uint64 delta = now - lastPresent;
+
+				if (!presentInterval) {
+					presentInterval = delta;
+				} else if (delta < presentInterval + presentInterval / 2) {
+					presentInterval = (presentInterval * 7 + delta) / 8;
+				}
+			}
+
+			lastPresent = now;
+			lastPresentId = frameId;
+
+			// Only frames started just in time say whether the margin covers what the CPU estimate misses
+			if (record->targetPresent) {
+				const uint64 interval = this->GetInterval();
+
+				if (now > record->targetPresent + interval / 2) {
+					margin = std::min<uint64>(margin * 2, std::max<uint64>(interval, settings.jitMarginUs));
+				} else {
+					margin = std::max<uint64>(margin - margin / 128, settings.jitMarginUs);
+				}
+			}
+		}
+
+		// When the next frame should start, now or earlier means right away
+		uint64 GetWakeTime(uint64 now)
+		{
+			uint64 wake = 0;
+			nextTargetPresent = 0;
+
+			if (settings.targetFrameTimeUs && lastStart) {
+				wake = lastStart + settings.targetFrameTimeUs;
+			}
+
+			const uint64 interval = this->GetInterval();
+
+			if (settings.justInTime && interval && lastPresent) {
+				// Frames started since the last present take the slots after it
+				const uint64 budget = cpuEstimate + margin;
+				uint64 slot = lastPresent + interval * (1 + lastBegunId - lastPresentId);
+
+				// Starting now already misses it, the next slot it can make is when it would be shown anyway
+				if (slot < now + budget) {
+					slot += ((now + budget - slot) / interval + 1) * interval;
+				}
+
+				nextTargetPresent = slot;
+				wake = std::max(wake, slot - budget);
+			}
+
+			return wake;
+		}
+
+		// The time between present slots, 0 when presents don't follow any rate
+		uint64 GetInterval() const
+		{
+			const uint64 displayInterval = vsync ? presentInterval : 0;
+			return std::max<uint64>(settings.targetFrameTimeUs, displayInterval);
+		}
+
+		FrameLatencyStats GetLatencyStats() const
+		{
+			FrameLatencyStats stats{};
+			stats.frameId = lastFrameId;
+			stats.count = (uint32)std::min<uint64>(historyCount, LATENCY_HISTORY);
+			stats.presentIntervalUs = (uint32)presentInterval;
+			stats.marginUs = (uint32)margin;
+			stats.presentTimed = presentTimed;
+
+			if (!stats.count)
+				return stats;
+
+			uint64 sum = 0;
+			stats.lastUs = history[(historyCount - 1) % LATENCY_HISTORY];
+			stats.minUs = UINT32_MAX;
+
+			for (uint32 i = 0; i < stats.count; i++) {
+				sum += history[i];
+				stats.minUs = std::min(stats.minUs, history[i]);
+				stats.maxUs = std::max(stats.maxUs, history[i]);
+			}
+
+			stats.averageUs = (uint32)(sum / stats.count);
+			return stats;
+		}
+
+		FORCEINLINE const FramePacingSettings& GetSettings() const { return settings; }
+
+		FORCEINLINE uint64 GetCpuEstimate() const { return cpuEstimate; }
+
+		FORCEINLINE uint64 GetMargin() const { return margin; }
+
+		static uint64 Now()
+		{
+			return (uint64)std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// OS sleeps overshoot, the last stretch is spent yielding
+		static void SleepUntil(uint64 time)
+		{
+			CONSTEXPR uint64 SPIN_TIME = 1000;
+			uint64 now = Now();
+
+			if (time > now + SPIN_TIME) {
+				std::this_thread::sleep_for(std::chrono::microseconds(time - now - SPIN_TIME));
+			}
+
+			while (Now() < time) {
+				std::this_thread::yield();
+			}
+		}
+	private:
+		struct FrameRecord
+		{
+			uint64	id;
+			uint64	start;
+			uint64	targetPresent;	// Slot it was started for, 0 if it wasn't started just in time
+			bool	begun;
+			bool	done;
+		};
+
+		FrameRecord* Find(uint64 frameId)
+		{
+			FrameRecord& record = records[frameId % MAX_PENDING_FRAMES];
+			return record.begun && record.id == frameId ? &record : NULL;
+		}
+	private:
+		FramePacingSettings	settings;
+		FrameRecord			records[MAX_PENDING_FRAMES];
+		uint32				history[LATENCY_HISTORY];
+		uint64				historyCount;
+
+		uint64				lastStart;
+		uint64				lastBegunId;
+		uint64				lastPresent;
+		uint64				lastPresentId;
+		uint64				nextTargetPresent;
+
+		uint64				cpuEstimate;
+		uint64				presentInterval;
+		uint64				margin;
+
+		uint64				lastFrameId;
+		bool				presentTimed;
+		bool				vsync;
+	};
+}
+
+TRE_NS_END
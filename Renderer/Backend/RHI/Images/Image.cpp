@@ -45,6 +45,7 @@ Renderer::Image::Image(RenderDevice& dev, VkImage image, VkImageView defaultView
 Renderer::Image::~Image()
 {
 	if (apiImage != VK_NULL_HANDLE && !IsSwapchainImage()) {
+        device.GetDefragmenter().Unregister(*this);
         device.DestroyImage(apiImage);
         device.FreeMemory(imageMemory);
         apiImage = VK_NULL_HANDLE;
@@ -43,6 +43,7 @@ namespace Renderer
 		VkImageView			apiImageView;
 
         friend class RenderDevice;
+		friend class MemoryDefragmenter;
 	};
 
 	using ImageViewHandle = Handle<ImageView>;
@@ -89,6 +90,7 @@ namespace Renderer
 
         friend class RenderDevice;
 		friend class StagingManager;
+		friend class MemoryDefragmenter;
 	};
 
 	using ImageHandle = Handle<Image>;
@@ -26,7 +26,8 @@ namespace Renderer
 		IMAGE_MISC_MUTABLE_SRGB_BIT = 1 << 2,
 		IMAGE_MISC_VERIFY_FORMAT_FEATURE_SAMPLED_LINEAR_FILTER_BIT = 1 << 7,
 		IMAGE_MISC_LINEAR_IMAGE_IGNORE_DEVICE_LOCAL_BIT = 1 << 8,
-		IMAGE_MISC_FORCE_NO_DEDICATED_BIT = 1 << 9
+		IMAGE_MISC_FORCE_NO_DEDICATED_BIT = 1 << 9,
+		IMAGE_MISC_MOVABLE_BIT = 1 << 10 // Can be moved by the defragmenter, no view other than the default one
 	};
 
 	enum ImageViewMiscFlagBits
@@ -372,6 +373,20 @@ namespace Renderer
 			return info;
 		}
 
+		// Sampled image whose mip chain is uploaded as is (e.g. block compressed by the texture cooker)
+		static ImageCreateInfo PrebuiltTexture2D(uint32 width, uint32 height, uint32 levels, VkFormat format,
+			VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+		{
+			ImageCreateInfo info;
+			info.width = width;
+			info.height = height;
+			info.levels = levels;
+			info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			info.format = format;
+			info.layout = layout;
+			return info;
+		}
+
 		static ImageCreateInfo RenderTarget(uint32 width, uint32 height, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB)
 		{
 			ImageCreateInfo info;
@@ -414,6 +429,13 @@ namespace Renderer
 		}
 	};
 
+	// Texels of one mip level, tightly packed (whole blocks for compressed formats)
+	struct ImageInitialData
+	{
+		const void* data;
+		DeviceSize size;
+	};
+
 	FORCEINLINE VkImageViewType GetImageViewType(const ImageCreateInfo& createInfo, const ImageViewCreateInfo* view)
 	{
 		uint32 layers;
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <math.h>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * GPU driven culling. The structures below are the std430 layouts read and written by Shaders/Cull/cull.comp, and
+	 * the functions are the CPU version of that shader (one CullInstance call per invocation). Both must stay in sync.
+	 * Vulkan free so the kernel can be validated without a GPU.
+	 */
+	struct GpuInstance
+	{
+		float model[16]; // Column major
+		uint32 mesh;
+		uint32 padding[3];
+	};
+
+	// One level of detail, used while the instance is at most maxDistance away (scaled by the camera's lodScale)
+	struct GpuMeshLod
+	{
+		uint32 indexCount;
+		uint32 firstIndex;
+		int32 vertexOffset;
+		float maxDistance;
+	};
+
+	// Mesh with its object space bounding sphere (center, radius) and LODs, from the most to the least detailed
+	struct GpuMesh
+	{
+		float sphere[4];
+		uint32 firstLod;
+		uint32 lodCount;
+		uint32 batch; // Pipeline the mesh is drawn with
+		uint32 padding;
+	};
+
+	// Region of the command buffer owned by a batch, filled in any order and drawn by one indirect count draw
+	struct GpuBatch
+	{
+		uint32 firstCommand;
+		uint32 maxCommands;
+	};
+
+	// Same layout as VkDrawIndexedIndirectCommand
+	struct GpuDrawCommand
+	{
+		uint32 indexCount;
+		uint32 instanceCount;
+		uint32 firstIndex;
+		int32 vertexOffset;
+		uint32 firstInstance; // Index of the instance, vertex shaders fetch it with gl_InstanceIndex
+	};
+
+	// Push constants of the culling shader, 128 bytes
+	struct GpuCullParams
+	{
+		float planes[6][4]; // Normalized, pointing inside the frustum
+		float camera[3];
+		float lodScale;
+		uint32 instanceCount;
+		uint32 padding[3];
+	};
+
+	static_assert(sizeof(GpuInstance) == 80, "GpuInstance doesn't match the shader");
+	static_assert(sizeof(GpuMesh) == 32, "GpuMesh doesn't match the shader");
+	static_assert(sizeof(GpuDrawCommand) == 20, "GpuDrawCommand doesn't match VkDrawIndexedIndirectCommand");
+	static_assert(sizeof(GpuCullParams) == 128, "GpuCullParams doesn't fit the guaranteed push constant size");
+
+	CONSTEXPR uint32 CULL_GROUP_SIZE = 64;
+
+	// Left, right, bottom, top, near, far planes of a column major view projection with a [0, 1] depth range
+	FORCEINLINE void ExtractFrustumPlanes(const float viewProj[16], float planes[6][4])
+	{
+		for (uint32 i = 0; i < 4; i++) {
+			const float x = viewProj[i * 4 + 0];
+			const float y = viewProj[i * 4 + 1];
+			const float z = viewProj[i * 4 + 2];
+			const float w = viewProj[i * 4 + 3];
+
+			planes[0][i] = w + x;
+			planes[1][i] = w - x;
+			planes[2][i] = w + y;
+			planes[3][i] = w - y;
+			planes[4][i] = z;
+			planes[5][i] = w - z;
+		}
+
+		for (uint32 p = 0; p < 6; p++) {
+			const float length = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+
+			for (uint32 i = 0; i < 4; i++) {
+				planes[p][i] /= length;
+			}
+		}
+	}
+
+	// Gives every batch a region as large as the number of instances using it, returns the total command count
+	FORCEINLINE uint32 LayoutBatches(const GpuInstance* instances, uint32 instanceCount, const GpuMesh* meshes,
+		GpuBatch* batches, uint32 batchCount)
+	{
+		for (uint32 b = 0; b < batchCount; b++) {
+			batches[b].maxCommands = 0;
+		}
+
+		for (uint32 i = 0; i < instanceCount; i++) {
+			ASSERTF(meshes[instances[i].mesh].batch < batchCount, "Instance %u uses an unknown batch", i);
+			batches[meshes[instances[i].mesh].batch].maxCommands++;
+		}
+
+		uint32 total = 0;
+
+		for (uint32 b = 0; b < batchCount; b++) {
+			batches[b].firstCommand = total;
+			total += batches[b].maxCommands;
+		}
+
+		return total;
+	}
+
+	/*
+	 * Frustum tests the instance's world space bounding sphere, picks the LOD from its distance to the camera and appends
+	 * a draw to the batch's region. counts holds one counter per batch, atomically incremented on the GPU.
+	 * Returns false when the instance is culled or too far for its last LOD.
+	 */
+	FORCEINLINE bool CullInstance(const GpuCullParams& params, uint32 index, const GpuInstance* instances, const GpuMesh* meshes,
+		const GpuMeshLod* lods, const GpuBatch* batches, GpuDrawCommand* commands, uint32* counts)
+	{
+		const GpuInstance& instance = instances[index];
+		const GpuMesh& mesh = meshes[instance.mesh];
+		const float* m = instance.model;
+
+		float center[3];
+
+		for (uint32 i = 0; i < 3; i++) {
+			center[i] = m[i] * mesh.sphere[0] + m[4 + i] * mesh.sphere[1] + m[8 + i] * mesh.sphere[2] + m[12 + i];
+		}
+
+		// The radius grows with the largest axis scale
+		const float scaleX = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+		const float scaleY = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+		const float scaleZ = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+		const float radius = mesh.sphere[3] * sqrtf(MAX(scaleX, MAX(scaleY, scaleZ)));
+
+		for (uint32 p = 0; p < 6; p++) {
+			const float* plane = params.planes[p];
+
+			if (plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius)
+				return false;
+		}
+
+		const float dx = center[0] - params.camera[0];
+		const float dy = center[1] - params.camera[1];
+		const float dz = center[2] - params.camera[2];
+		const float distance = sqrtf(dx * dx + dy * dy + dz * dz) * params.lodScale;
+
+		uint32 lod = 0;
+
+		while (lod < mesh.lodCount && distance > lods[mesh.firstLod + lod].maxDistance) {
+			lod++;
+		}
+
+		if (lod == mesh.lodCount)
+			return false;
+
+		const GpuBatch& batch = batches[mesh.batch];
+		const uint32 slot = counts[mesh.batch]++;
+
+		if (slot >= batch.maxCommands)
+			return false;
+
+		const GpuMeshLod& level = lods[mesh.firstLod + lod];
+		GpuDrawCommand& command = commands[batch.firstCommand + slot];
+		command.indexCount = level.indexCount;
+		command.instanceCount = 1;
+		command.firstIndex = level.firstIndex;
+		command.vertexOffset = level.vertexOffset;
+		command.firstInstance = index;
+		return true;
+	}
+
+	// Whole dispatch on the CPU, counts must be zeroed first. Returns the number of draws written.
+	FORCEINLINE uint32 CullInstances(const GpuCullParams& params, const GpuInstance* instances, const GpuMesh* meshes,
+		const GpuMeshLod* lods, const GpuBatch* batches, GpuDrawCommand* commands, uint32* counts)
+	{
+		uint32 visible = 0;
+
+		for (uint32 i = 0; i < params.instanceCount; i++) {
+			visible += CullInstance(params, i, instances, meshes, lods, batches, commands, counts);
+		}
+
+		return visible;
+	}
+}
+
+TRE_NS_END
@@ -0,0 +1,127 @@
+#include "IndirectScene.hpp"
+#include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
+#include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
+
+TRE_NS_START
+
+Renderer::IndirectScene::IndirectScene(RenderDevice& device) : device(device), useIndirectCount(false)
+{
+}
+
+uint32 Renderer::IndirectScene::AddBatch()
+{
+    batches.push_back(GpuBatch{ 0, 0 });
+    return (uint32)batches.size() - 1;
+}
+
+uint32 Renderer::IndirectScene::AddMesh(uint32 batch, const float sphere[4], const GpuMeshLod* lods, uint32 lodCount)
+{
+    ASSERT(batch < batches.size());
+    ASSERT(lodCount != 0);
+
+    GpuMesh mesh = {};
+    mesh.sphere[0] = sphere[0];
+    mesh.sphere[1] = sphere[1];
+    mesh.sphere[2] = sphere[2];
+    mesh.sphere[3] = sphere[3];
+    mesh.firstLod = (uint32)this->lods.size();
+    mesh.lodCount = lodCount;
+    mesh.batch = batch;
+
+    this->lods.insert(this->lods.end(), lods, lods + lodCount);
+    meshes.push_back(mesh);
+    return (uint32)meshes.size() - 1;
+}
+
+uint32 Renderer::IndirectScene::AddInstance(uint32 mesh, const float model[16])
+{
+    ASSERT(mesh < meshes.size());
+
+    GpuInstance instance = {};
+    memcpy(instance.model, model, sizeof(instance.model));
+    instance.mesh = mesh;
+    instances.push_back(instance);
+    return (uint32)instances.size() - 1;
+}
+
+void Renderer::IndirectScene::Upload()
+{
+    ASSERT(!instances.empty());
+
+    const uint32 commandCount = LayoutBatches(instances.data(), (uint32)instances.size(), meshes.data(), batches.data(),
+        (uint32)batches.size());
+    const uint32 readUsage = BufferUsage::STORAGE_BUFFER | BufferUsage::TRANSFER_DST;
+
+    instanceBuffer = device.CreateBuffer({ instances.size() * sizeof(GpuInstance), readUsage }, instances.data());
+    meshBuffer = device.CreateBuffer({ meshes.size() * sizeof(GpuMesh), readUsage }, meshes.data());
+    lodBuffer = device.CreateBuffer({ lods.size() * sizeof(GpuMeshLod), readUsage }, lods.data());
+    batchBuffer = device.CreateBuffer({ batches.size() * sizeof(GpuBatch), readUsage }, batches.data());
+
+    const uint32 indirectUsage = BufferUsage::STORAGE_BUFFER | BufferUsage::INDIRECT_BUFFER | BufferUsage::TRANSFER_DST;
+    commandBuffer = device.CreateBuffer({ commandCount * sizeof(GpuDrawCommand), indirectUsage });
+    countBuffer = device.CreateBuffer({ batches.size() * sizeof(uint32), indirectUsage });
+
+    // Without indirect count every slot of a batch is drawn, the unused ones are cleared to zero instances each frame
+    useIndirectCount = device.GetVulkan12Features().drawIndirectCount;
+}
+
+void Renderer::IndirectScene::Cull(CommandBuffer& cmd, ShaderProgram& cullProgram, const float viewProj[16], const float camera[3],
+    float lodScale)
+{
+    TRE_PROFILE_SCOPE("IndirectScene::Cull");
+
+    GpuCullParams params = {};
+    ExtractFrustumPlanes(viewProj, params.planes);
+    params.camera[0] = camera[0];
+    params.camera[1] = camera[1];
+    params.camera[2] = camera[2];
+    params.lodScale = lodScale;
+    params.instanceCount = (uint32)instances.size();
+
+    // The previous frame's draws may still be reading the commands
+    cmd.Barrier(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    cmd.FillBuffer(*countBuffer, 0);
+
+    if (!useIndirectCount) {
+        cmd.FillBuffer(*commandBuffer, 0);
+    }
+
+    cmd.Barrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    cmd.BindShaderProgram(cullProgram);
+    cmd.SetStorageBuffer(0, 0, *instanceBuffer);
+    cmd.SetStorageBuffer(0, 1, *meshBuffer);
+    cmd.SetStorageBuffer(0, 2, *lodBuffer);
+    cmd.SetStorageBuffer(0, 3, *batchBuffer);
+    cmd.SetStorageBuffer(0, 4, *commandBuffer);
+    cmd.SetStorageBuffer(0, 5, *countBuffer);
+    cmd.PushConstants(ShaderStagesFlagsBits::COMPUTE_SHADER, &params, sizeof(params));
+    cmd.Dispatch((params.instanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    cmd.Barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+void Renderer::IndirectScene::Draw(CommandBuffer& cmd, uint32 batch)
+{
+    ASSERT(batch < batches.size());
+
+    const GpuBatch& region = batches[batch];
+
+    if (!region.maxCommands)
+        return;
+
+    const DeviceSize offset = region.firstCommand * sizeof(GpuDrawCommand);
+
+    if (useIndirectCount) {
+        cmd.DrawIndexedIndirectCount(*commandBuffer, offset, *countBuffer, batch * sizeof(uint32), region.maxCommands,
+            sizeof(GpuDrawCommand));
+    } else {
+        cmd.DrawIndexedIndirect(*commandBuffer, offset, region.maxCommands, sizeof(GpuDrawCommand));
+    }
+}
+
+TRE_NS_END
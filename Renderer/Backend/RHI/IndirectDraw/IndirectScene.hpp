@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <Renderer/Backend/Common.hpp>
+#include <Renderer/Backend/RHI/Common/Globals.hpp>
+#include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
+#include <Renderer/Backend/RHI/IndirectDraw/IndirectCulling.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	class RenderDevice;
+	class CommandBuffer;
+	class ShaderProgram;
+
+	/*
+	 * Scene drawn without per object CPU work. Instances, meshes and LODs are uploaded once to device local storage
+	 * buffers, then every frame a compute pass (Shaders/Cull/cull.comp) frustum culls the instances, picks their LOD and
+	 * writes compacted draw commands and one count per batch. Each batch (pipeline) is then one DrawIndexedIndirectCount.
+	 * All the meshes of a batch must share the vertex and index buffers bound before Draw, their vertex shaders read the
+	 * instance with gl_InstanceIndex from GetInstanceBuffer().
+	 */
+	class RENDERER_API IndirectScene
+	{
+	public:
+		IndirectScene(RenderDevice& device);
+
+		uint32 AddBatch();
+
+		// sphere is the object space bounding sphere (center, radius), lods go from the most to the least detailed
+		uint32 AddMesh(uint32 batch, const float sphere[4], const GpuMeshLod* lods, uint32 lodCount);
+
+		uint32 AddInstance(uint32 mesh, const float model[16]);
+
+		// Creates the buffers from what was added so far
+		void Upload();
+
+		// Records the counts reset, the culling dispatch and its barrier to the indirect draws, outside of a render pass
+		void Cull(CommandBuffer& cmd, ShaderProgram& cullProgram, const float viewProj[16], const float camera[3], float lodScale = 1.f);
+
+		// Draws the batch's visible instances with the bound pipeline and geometry
+		void Draw(CommandBuffer& cmd, uint32 batch);
+
+		FORCEINLINE const Buffer& GetInstanceBuffer() const { return *instanceBuffer; }
+
+		FORCEINLINE uint32 GetInstanceCount() const { return (uint32)instances.size(); }
+
+		FORCEINLINE uint32 GetBatchCount() const { return (uint32)batches.size(); }
+
+	private:
+		RenderDevice& device;
+
+		std::vector<GpuInstance> instances;
+		std::vector<GpuMesh> meshes;
+		std::vector<GpuMeshLod> lods;
+		std::vector<GpuBatch> batches;
+
+		BufferHandle instanceBuffer;
+		BufferHandle meshBuffer;
+		BufferHandle lodBuffer;
+		BufferHandle batchBuffer;
+		BufferHandle commandBuffer;
+		BufferHandle countBuffer;
+		bool useIndirectCount;
+	};
+}
+
+TRE_NS_END
@@ -5,7 +5,7 @@ TRE_NS_START
 
 // TypedMemoryAllocator
 
-void Renderer::TypedMemoryAllocator::Init(const RenderDevice& device, uint32 memoryTypeIndex)
+void Renderer::TypedMemoryAllocator::Init(const RenderDevice& device, uint32 memoryTypeIndex, uint64 slabPageSize)
 {
     if (device.GetMemoryProperties().memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
         map = true;
@@ -15,71 +15,166 @@ void Renderer::TypedMemoryAllocator::Init(const RenderDevice& device, uint32 mem
 
     this->device = device.GetDevice();
     this->memoryTypeIndex = memoryTypeIndex;
-    auto& alloc = allocators.emplace_back();
-    alloc.Create(this->device, memoryTypeIndex, MIN_SIZE, NUM_BLOCKS * MIN_SIZE, map);
+
+    BuddyPoolConfig config;
+    config.minSize = MIN_SIZE;
+    config.firstBlockSize = NUM_BLOCKS * MIN_SIZE;
+    config.maxBlockSize = MAX_BLOCK_SIZE;
+    config.growthFactor = RESIZE_FACTOR;
+    config.releaseDelayFrames = RELEASE_DELAY_FRAMES;
+    config.spareBlocks = 1;
+    pool.Init(this, config);
+    slabs.Init(&pool, slabPageSize);
+    dedicatedBytes = 0;
+    dedicatedCount = 0;
 }
 
 void Renderer::TypedMemoryAllocator::Destroy()
 {
-    for (auto& alloc : allocators) {
-        if (map)
-            vkUnmapMemory(device, alloc.gpuMemory);
-        alloc.Destroy(device);
+    slabs.Destroy();
+    pool.Destroy();
+}
+
+bool Renderer::TypedMemoryAllocator::CreateBlock(DeviceBuddyAllocator& block, uint64 size)
+{
+    VkMemoryAllocateInfo info;
+    info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    info.pNext = NULL;
+    info.allocationSize = size;
+    info.memoryTypeIndex = memoryTypeIndex;
+
+    if (vkAllocateMemory(device, &info, NULL, &block.gpuMemory) != VK_SUCCESS)
+        return false;
+
+    if (map) {
+        vkMapMemory(device, block.gpuMemory, 0, size, 0, &block.mappedData);
+    }else{
+        block.mappedData = NULL;
     }
+
+    block.Init(MIN_SIZE, (uint32)size);
+    // printf("[%d] Creating new block of %llu bytes\n", memoryTypeIndex, size);
+    return true;
+}
+
+void Renderer::TypedMemoryAllocator::DestroyBlock(DeviceBuddyAllocator& block, uint32 index)
+{
+    if (map)
+        vkUnmapMemory(device, block.gpuMemory);
+
+    vkFreeMemory(device, block.gpuMemory, NULL);
+    block.gpuMemory = VK_NULL_HANDLE;
+    block.mappedData = NULL;
 }
 
 Renderer::MemoryAllocation Renderer::TypedMemoryAllocator::Allocate(uint64 size, uint64 alignement)
 {
-	// I think the final padding is going to be always 0 hence this if this wasn't always the case we will revert back this
-	// uint64 worstCasePadding = (~MIN_SIZE + 1)& (alignement - 1);
-	uint64 worstCasePadding = 0;
-    uint32 i = 0;
-    BuddyAllocator::Allocation allocation = { UINT64_MAX, UINT64_MAX };
-
-    while (allocation.offset == UINT64_MAX) {
-        if (i >= allocators.size()) {
-            uint32 lastMaxSize = allocators.back().maxSize;
-            auto& alloc = allocators.emplace_back();
-            alloc.Create(device, memoryTypeIndex, MIN_SIZE, lastMaxSize * RESIZE_FACTOR, map);
-			printf("[%d] Creating new allocator\n", memoryTypeIndex);
-        }
+    // The buddy offsets are multiples of the allocation's power of 2 size, which covers the alignments the driver asks for
+    BuddyPoolAllocation allocation;
+
+    if (!pool.Allocate(size, allocation)) {
+        ASSERTF(false, "[%d] Out of device memory allocating %" PRIu64 " bytes", memoryTypeIndex, size);
+        return MemoryAllocation{};
+    }
+
+    return this->ToMemoryAllocation(allocation, alignement);
+}
+
+Renderer::MemoryAllocation Renderer::TypedMemoryAllocator::AllocateSlab(uint64 size, uint64 alignement, uint32 group)
+{
+    BuddyPoolAllocation allocation;
 
-        // printf("[mem type ind: %d] Requesting %d from %d\n", memoryTypeIndex, size + worstCasePadding, i);
-        allocation = allocators[i].Allocate(size + worstCasePadding);
-        i++;
+    if (!slabs.Allocate(size, alignement, group, allocation)) {
+        ASSERTF(false, "[%d] Out of device memory allocating a slab page for %" PRIu64 " bytes", memoryTypeIndex, size);
+        return MemoryAllocation{};
     }
 
-	/*auto padding22 = (~allocation.offset + 1) & (alignement - 1);
-	auto offset22 = allocation.offset + (~allocation.offset + 1) & (alignement - 1);
-	printf("[%d] Allocating size: %llu | alignement: %llu | offset: %llu | worst case padding: %llu | Final padding: %llu | Final offset: %llu\n",
-		memoryTypeIndex, size, alignement, allocation.offset,
-		worstCasePadding, padding22, offset22);*/
+    MemoryAllocation alloc = this->ToMemoryAllocation(allocation, alignement);
+    alloc.allocKey |= MemoryAllocation::SLAB_BIT;
+    return alloc;
+}
+
+Renderer::MemoryAllocation Renderer::TypedMemoryAllocator::AllocateDedicated(uint64 size, uint64 alignement, VkMemoryAllocateFlags flags)
+{
+    VkMemoryAllocateFlagsInfo flagsInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
+    flagsInfo.flags = flags;
+
+    VkMemoryAllocateInfo info;
+    info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    info.pNext = &flagsInfo;
+    info.allocationSize = size;
+    info.memoryTypeIndex = memoryTypeIndex;
+
+    MemoryAllocation alloc;
+    alloc.size       = size;
+    alloc.offset     = 0;
+    alloc.padding    = 0;
+    alloc.alignment  = alignement;
+    alloc.mappedData = NULL;
+    alloc.allocKey   = MemoryAllocation::DEDICATED_BIT | memoryTypeIndex;
+    CALL_VK(vkAllocateMemory(device, &info, NULL, &alloc.memory));
+
+    if (map) {
+        vkMapMemory(device, alloc.memory, 0, size, 0, &alloc.mappedData);
+    }
+
+    dedicatedBytes += size;
+    dedicatedCount++;
+    return alloc;
+}
+
+void Renderer::TypedMemoryAllocator::Free(const MemoryAllocation& allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    if (MemoryAllocation::IsDedicated(allocation)) {
+        if (allocation.mappedData)
+            vkUnmapMemory(device, allocation.memory);
+
+        vkFreeMemory(device, allocation.memory, NULL);
+        dedicatedBytes -= allocation.size;
+        dedicatedCount--;
+    } else if (MemoryAllocation::IsSlab(allocation)) {
+        slabs.Free(ToPoolAllocation(allocation));
+    } else {
+        pool.Free(ToPoolAllocation(allocation));
+    }
+}
+
+Renderer::MemoryTypeStats Renderer::TypedMemoryAllocator::GetStats() const
+{
+    return { pool.GetStats(), slabs.GetStats(), dedicatedBytes, dedicatedCount };
+}
+
+Renderer::MemoryAllocation Renderer::TypedMemoryAllocator::ToMemoryAllocation(const BuddyPoolAllocation& allocation, uint64 alignement) const
+{
+    const DeviceBuddyAllocator& block = pool.GetBlock(allocation.block);
 
     MemoryAllocation alloc;
-    alloc.memory     = allocators[i - 1].gpuMemory;
+    alloc.memory     = block.gpuMemory;
     alloc.offset     = (VkDeviceSize)allocation.offset;
     alloc.padding    = (~alloc.offset + 1) & (alignement - 1);
     alloc.offset     += alloc.padding;
     alloc.size       = (VkDeviceSize)allocation.size;
     alloc.alignment  = alignement;
-    alloc.mappedData = allocators[i - 1].mappedData;
-    alloc.allocKey   = (i - 1) << MemoryAllocation::INDEX_SHIFT | memoryTypeIndex;
+    alloc.mappedData = block.mappedData;
+    alloc.allocKey   = allocation.block << MemoryAllocation::INDEX_SHIFT | memoryTypeIndex;
 
 	ASSERTF(alloc.padding != 0, "Padding is just assumed to be always 0 that was unfortuently not the case so revert back");
     return alloc;
 }
 
-void Renderer::TypedMemoryAllocator::Free(const MemoryAllocation& allocation)
+BuddyPoolAllocation Renderer::TypedMemoryAllocator::ToPoolAllocation(const MemoryAllocation& allocation)
 {
-    BuddyAllocator::Allocation alloc = { allocation.offset - allocation.padding, allocation.size };
-    allocators[MemoryAllocation::GetIndex(allocation)].Free(alloc);
+    return { MemoryAllocation::GetIndex(allocation), allocation.offset - allocation.padding, allocation.size };
 }
 
 
 
 // MemoryAllocator2
 
-Renderer::MemoryAllocator2::MemoryAllocator2(Renderer::RenderDevice& device) : renderDevice(device)
+Renderer::MemoryAllocator2::MemoryAllocator2(Renderer::RenderDevice& device) : renderDevice(device), heapBudgets{}
 {
 
 }
@@ -87,8 +182,10 @@ Renderer::MemoryAllocator2::MemoryAllocator2(Renderer::RenderDevice& device) : r
 void Renderer::MemoryAllocator2::Init()
 {
     for (uint32 i = 0; i < renderDevice.GetMemoryProperties().memoryTypeCount; i++) {
-        allocators[i].Init(renderDevice, i);
+        allocators[i].Init(renderDevice, i, strategyConfig.slabPageSize);
     }
+
+    this->UpdateBudget();
 }
 
 void Renderer::MemoryAllocator2::Destroy()
@@ -103,11 +200,100 @@ Renderer::MemoryAllocation Renderer::MemoryAllocator2::Allocate(uint32 indexType
     return allocators[indexType].Allocate(size, alignement);
 }
 
+Renderer::MemoryAllocation Renderer::MemoryAllocator2::Allocate(uint32 indexType, const AllocationRequest& request, VkMemoryAllocateFlags flags)
+{
+    switch (ChooseAllocationStrategy(request, strategyConfig)) {
+    case AllocationStrategy::SLAB:
+        return allocators[indexType].AllocateSlab(request.size, request.alignment, request.group);
+    case AllocationStrategy::BUDDY:
+        return allocators[indexType].Allocate(request.size, request.alignment);
+    default:
+        return allocators[indexType].AllocateDedicated(request.size, request.alignment, flags);
+    }
+}
+
 void Renderer::MemoryAllocator2::Free(const MemoryAllocation& alloc)
 {
     allocators[MemoryAllocation::GetTypeIndex(alloc)].Free(alloc);
 }
 
+VkDeviceSize Renderer::MemoryAllocator2::Free(const MemoryAllocation* allocations, uint32 count)
+{
+    VkDeviceSize reclaimed = 0;
+
+    for (uint32 i = 0; i < count; i++) {
+        allocators[MemoryAllocation::GetTypeIndex(allocations[i])].Free(allocations[i]);
+        reclaimed += allocations[i].size;
+    }
+
+    return reclaimed;
+}
+
+void Renderer::MemoryAllocator2::BeginFrame()
+{
+    this->UpdateBudget();
+    const VkPhysicalDeviceMemoryProperties& properties = renderDevice.GetMemoryProperties();
+
+    for (uint32 i = 0; i < properties.memoryTypeCount; i++) {
+        const MemoryHeapBudget& heap = heapBudgets[properties.memoryTypes[i].heapIndex];
+        const bool overBudget = heap.usage > heap.budget;
+
+        allocators[i].SetGrowthLimited(overBudget);
+        allocators[i].ReleaseEmptyBlocks(overBudget);
+    }
+}
+
+void Renderer::MemoryAllocator2::UpdateBudget()
+{
+    const VkPhysicalDeviceMemoryProperties& properties = renderDevice.GetMemoryProperties();
+
+    if (renderDevice.IsExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+        VkPhysicalDeviceMemoryProperties2 properties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+        properties2.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(renderDevice.GetGPU(), &properties2);
+
+        for (uint32 i = 0; i < properties.memoryHeapCount; i++) {
+            heapBudgets[i] = { budget.heapBudget[i], budget.heapUsage[i] };
+        }
+
+        return;
+    }
+
+    for (uint32 i = 0; i < properties.memoryHeapCount; i++) {
+        heapBudgets[i] = { properties.memoryHeaps[i].size / 10 * 8, 0 };
+    }
+
+    for (uint32 i = 0; i < properties.memoryTypeCount; i++) {
+        const MemoryTypeStats stats = allocators[i].GetStats();
+        heapBudgets[properties.memoryTypes[i].heapIndex].usage += stats.blocks.blockBytes + stats.dedicatedBytes;
+    }
+}
+
+void Renderer::MemoryAllocator2::PrintStats() const
+{
+    const VkPhysicalDeviceMemoryProperties& properties = renderDevice.GetMemoryProperties();
+
+    for (uint32 i = 0; i < properties.memoryHeapCount; i++) {
+        TRE_LOGI("Heap %d: %" PRIu64 " / %" PRIu64 " MB used", i, heapBudgets[i].usage >> 20, heapBudgets[i].budget >> 20);
+    }
+
+    for (uint32 i = 0; i < properties.memoryTypeCount; i++) {
+        const MemoryTypeStats stats = allocators[i].GetStats();
+
+        if (!stats.blocks.blockCount && !stats.dedicatedCount)
+            continue;
+
+        TRE_LOGI("Memory type %d (heap %d): %d blocks (%d empty), %" PRIu64 " / %" PRIu64 " KB used by %d allocations, %.1f%% fragmented",
+            i, properties.memoryTypes[i].heapIndex, stats.blocks.blockCount, stats.blocks.emptyBlockCount,
+            stats.blocks.usedBytes >> 10, stats.blocks.blockBytes >> 10, stats.blocks.allocationCount,
+            stats.blocks.fragmentation * 100.f);
+        TRE_LOGI("    slabs: %d pages, %" PRIu64 " / %" PRIu64 " KB used by %d allocations | dedicated: %d allocations, %" PRIu64 " KB",
+            stats.slabs.pageCount, stats.slabs.usedBytes >> 10, stats.slabs.pageBytes >> 10, stats.slabs.allocationCount,
+            stats.dedicatedCount, stats.dedicatedBytes >> 10);
+    }
+}
+
 
 
 
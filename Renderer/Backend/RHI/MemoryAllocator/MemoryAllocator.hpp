@@ -4,6 +4,9 @@
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/Core/BitmapTree/BitmapTree.hpp>
 #include <Renderer/Backend/Core/BuddyAllocator/BuddyAllocator.hpp>
+#include <Renderer/Backend/Core/BuddyBlockPool/BuddyBlockPool.hpp>
+#include <Renderer/Backend/Core/SlabAllocator/SlabAllocator.hpp>
+#include <Renderer/Backend/Core/AllocationStrategy/AllocationStrategy.hpp>
 
 TRE_NS_START
 
@@ -13,7 +16,10 @@ namespace Renderer
 
     struct MemoryAllocation
     {
-        CONSTEXPR static uint32 INDEX_SHIFT = 16;
+        CONSTEXPR static uint32 INDEX_SHIFT   = 16;
+        CONSTEXPR static uint32 TYPE_MASK     = 0xFF;
+        CONSTEXPR static uint32 SLAB_BIT      = 1 << 14;
+        CONSTEXPR static uint32 DEDICATED_BIT = 1 << 15;
 
         VkDeviceMemory memory;
         VkDeviceSize   size;
@@ -28,7 +34,17 @@ namespace Renderer
 
         FORCEINLINE static uint32 GetTypeIndex(const MemoryAllocation& alloc)
         {
-            return alloc.allocKey & ((1 << INDEX_SHIFT) - 1);
+            return alloc.allocKey & TYPE_MASK;
+        }
+
+        FORCEINLINE static bool IsDedicated(const MemoryAllocation& alloc)
+        {
+            return alloc.allocKey & DEDICATED_BIT;
+        }
+
+        FORCEINLINE static bool IsSlab(const MemoryAllocation& alloc)
+        {
+            return (alloc.allocKey & (SLAB_BIT | DEDICATED_BIT)) == SLAB_BIT;
         }
 
         FORCEINLINE static uint32 GetIndex(const MemoryAllocation& alloc)
@@ -38,14 +54,28 @@ namespace Renderer
     };
 
 
+    struct MemoryHeapBudget
+    {
+        VkDeviceSize budget; // What the process can use on the heap before the driver starts paging
+        VkDeviceSize usage;  // What the process uses on the heap, dedicated allocations and other allocators included
+    };
+
+    struct MemoryTypeStats
+    {
+        BuddyPoolStats blocks;
+        SlabStats      slabs;
+        VkDeviceSize   dedicatedBytes;
+        uint32         dedicatedCount;
+    };
+
     class TypedMemoryAllocator
     {
-    private:
+    public:
         struct DeviceBuddyAllocator : public BuddyAllocator
         {
             DeviceBuddyAllocator() = default;
 
-            DeviceBuddyAllocator(DeviceBuddyAllocator&& other) :
+            DeviceBuddyAllocator(DeviceBuddyAllocator&& other) noexcept :
                 BuddyAllocator(std::move(*(BuddyAllocator*)(&other))),
                 gpuMemory(other.gpuMemory), mappedData(other.mappedData)
             {
@@ -59,49 +89,62 @@ namespace Renderer
 
             }
 
-            void Create(VkDevice dev, uint32 memTypeIndex, uint32 minSize, uint32 maxSize, bool map)
-            {
-                VkMemoryAllocateInfo info;
-                info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-                info.pNext = NULL;
-                info.allocationSize = maxSize;
-                info.memoryTypeIndex = memTypeIndex;
-                vkAllocateMemory(dev, &info, NULL, &gpuMemory);
-
-                if (map) {
-                    vkMapMemory(dev, gpuMemory, 0, maxSize, 0, &mappedData);
-                }else{
-                    mappedData = NULL;
-                }
-
-                this->Init(minSize, maxSize);
-            }
-
-            void Destroy(VkDevice dev)
-            {
-                vkFreeMemory(dev, gpuMemory, NULL);
-            }
-
             VkDeviceMemory gpuMemory;
             void* mappedData;
         };
+
+        typedef BuddyBlockPool<DeviceBuddyAllocator, TypedMemoryAllocator> BlockPool;
+        typedef SlabAllocator<BlockPool> SlabPool;
     public:
         // These must be a power of 2
         CONSTEXPR static uint32 MIN_SIZE        = 64;
         CONSTEXPR static uint32 NUM_BLOCKS      = 65536; // The intial pool have 16 MB
-        CONSTEXPR static uint32 RESIZE_FACTOR   = 4;  // The pool will grow by a factor of 4 giving: 64, 128, 256, 512 MB respectively
+        CONSTEXPR static uint32 RESIZE_FACTOR   = 4;  // The pool will grow by a factor of 4 giving: 64, 256 then 1024 MB blocks
+        CONSTEXPR static uint32 MAX_BLOCK_SIZE  = 1024u << 20;
+
+        CONSTEXPR static uint32 RELEASE_DELAY_FRAMES = 120; // Frames a block stays empty before it is freed
 
-        void Init(const RenderDevice& device, uint32 memoryTypeIndex);
+        void Init(const RenderDevice& device, uint32 memoryTypeIndex, uint64 slabPageSize);
 
         void Destroy();
 
+        // Both return a null allocation (VK_NULL_HANDLE memory) when out of device memory
         MemoryAllocation Allocate(uint64 size, uint64 alignement);
 
+        MemoryAllocation AllocateSlab(uint64 size, uint64 alignement, uint32 group);
+
+        MemoryAllocation AllocateDedicated(uint64 size, uint64 alignement, VkMemoryAllocateFlags flags);
+
+        // Frees any kind of allocation made by this allocator, null ones are ignored
         void Free(const MemoryAllocation& allocation);
 
+        // Frees the blocks that stayed empty long enough (all of them when over budget), returns the bytes given back
+        FORCEINLINE VkDeviceSize ReleaseEmptyBlocks(bool releaseAll) { return pool.ReleaseEmptyBlocks(releaseAll); }
+
+        // Over budget new blocks are sized to the allocations instead of growing
+        FORCEINLINE void SetGrowthLimited(bool limited) { pool.SetGrowthLimited(limited); }
+
+        MemoryTypeStats GetStats() const;
+
+        FORCEINLINE BlockPool& GetBlockPool() { return pool; }
+
+        FORCEINLINE uint32 GetMemoryTypeIndex() const { return memoryTypeIndex; }
+
+        MemoryAllocation ToMemoryAllocation(const BuddyPoolAllocation& allocation, uint64 alignement) const;
+
+        static BuddyPoolAllocation ToPoolAllocation(const MemoryAllocation& allocation);
+
+        // BuddyBlockPool backend:
+        bool CreateBlock(DeviceBuddyAllocator& block, uint64 size);
+
+        void DestroyBlock(DeviceBuddyAllocator& block, uint32 index);
+
     private:
-        std::vector<DeviceBuddyAllocator> allocators;
+        BlockPool pool;
+        SlabPool slabs;
         VkDevice device;
+        VkDeviceSize dedicatedBytes;
+        uint32 dedicatedCount;
         uint32 memoryTypeIndex;
         bool map;
     };
@@ -117,10 +160,37 @@ namespace Renderer
 
         MemoryAllocation Allocate(uint32 indexType, uint64 size, uint64 alignement = 1);
 
+        // Picks slab, buddy or dedicated memory for the request, see ChooseAllocationStrategy
+        MemoryAllocation Allocate(uint32 indexType, const AllocationRequest& request, VkMemoryAllocateFlags flags = 0);
+
         void Free(const MemoryAllocation& alloc);
+
+        // Bulk free of the allocations the GPU is done with, returns the bytes reclaimed
+        VkDeviceSize Free(const MemoryAllocation* allocations, uint32 count);
+
+        // Once per frame: refreshes the heap budgets, frees the blocks left empty and stops growing the heaps over budget
+        void BeginFrame();
+
+        // Uses VK_EXT_memory_budget when enabled, otherwise 80% of each heap against what this allocator reserved
+        void UpdateBudget();
+
+        FORCEINLINE const MemoryHeapBudget& GetHeapBudget(uint32 heapIndex) const { return heapBudgets[heapIndex]; }
+
+        FORCEINLINE MemoryTypeStats GetStats(uint32 typeIndex) const { return allocators[typeIndex].GetStats(); }
+
+        FORCEINLINE const AllocationStrategyConfig& GetStrategyConfig() const { return strategyConfig; }
+
+        // Must be set before Init, the slab page size is fixed from there
+        FORCEINLINE void SetStrategyConfig(const AllocationStrategyConfig& config) { strategyConfig = config; }
+
+        FORCEINLINE TypedMemoryAllocator& GetTypedAllocator(uint32 typeIndex) { return allocators[typeIndex]; }
+
+        void PrintStats() const;
     private:
         RenderDevice& renderDevice;
         TypedMemoryAllocator allocators[VK_MAX_MEMORY_TYPES];
+        MemoryHeapBudget heapBudgets[VK_MAX_MEMORY_HEAPS];
+        AllocationStrategyConfig strategyConfig;
     };
 
 
@@ -135,7 +205,6 @@ namespace Renderer
 
 
 
-
 	class RENDERER_API MemoryAllocator
 	{
 	public:
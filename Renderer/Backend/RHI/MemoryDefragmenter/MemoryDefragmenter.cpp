@@ -0,0 +1,221 @@
+#include "MemoryDefragmenter.hpp"
+#include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
+#include <Renderer/Backend/RHI/Images/Image.hpp>
+#include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
+#include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
+
+TRE_NS_START
+
+Renderer::MemoryDefragmenter::MemoryDefragmenter(RenderDevice& device) : device(device), stats{}
+{
+}
+
+void Renderer::MemoryDefragmenter::Register(Buffer& buffer)
+{
+    const BufferInfo& info = buffer.GetBufferInfo();
+    const MemoryAllocation& memory = buffer.GetBufferMemory();
+
+    // Only buddy ranges are compacted, device addresses would change under the shaders using them
+    if (MemoryAllocation::IsDedicated(memory) || MemoryAllocation::IsSlab(memory) ||
+        info.domain != MemoryDomain::GPU_ONLY || buffer.GetRingSize() != 1 || !(info.usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) ||
+        (info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT))
+        return;
+
+    buffers.insert(&buffer);
+}
+
+void Renderer::MemoryDefragmenter::Register(Image& image)
+{
+    const ImageCreateInfo& info = image.GetInfo();
+
+    if (!(info.misc & IMAGE_MISC_MOVABLE_BIT) || MemoryAllocation::IsDedicated(image.imageMemory) ||
+        MemoryAllocation::IsSlab(image.imageMemory) || info.domain != ImageDomain::PHYSICAL ||
+        info.layout == VK_IMAGE_LAYOUT_UNDEFINED || image.IsSwapchainImage())
+        return;
+
+    images.insert(&image);
+}
+
+void Renderer::MemoryDefragmenter::Unregister(Buffer& buffer)
+{
+    buffers.erase(&buffer);
+}
+
+void Renderer::MemoryDefragmenter::Unregister(Image& image)
+{
+    images.erase(&image);
+}
+
+uint32 Renderer::MemoryDefragmenter::Step(const Config& config)
+{
+    TRE_PROFILE_SCOPE("MemoryDefragmenter::Step");
+
+    if (buffers.empty() && images.empty())
+        return 0;
+
+    MemoryAllocator2& allocator = device.GetContextAllocator();
+    CommandBufferHandle cmd;
+    uint32 moved = 0;
+
+    for (uint32 type = 0; type < device.GetMemoryProperties().memoryTypeCount; type++) {
+        live.clear();
+        owners.clear();
+
+        for (Buffer* buffer : buffers) {
+            if (MemoryAllocation::GetTypeIndex(buffer->bufferMemory) == type) {
+                live.push_back(TypedMemoryAllocator::ToPoolAllocation(buffer->bufferMemory));
+                owners.push_back({ buffer, NULL });
+            }
+        }
+
+        for (Image* image : images) {
+            if (MemoryAllocation::GetTypeIndex(image->imageMemory) == type) {
+                live.push_back(TypedMemoryAllocator::ToPoolAllocation(image->imageMemory));
+                owners.push_back({ NULL, image });
+            }
+        }
+
+        if (live.empty())
+            continue;
+
+        TypedMemoryAllocator& typed = allocator.GetTypedAllocator(type);
+
+        if (!typed.GetBlockPool().PlanDefragmentation(live.data(), (uint32)live.size(), config.maxBytesPerStep,
+            config.maxMovesPerStep, moves))
+            continue;
+
+        // After the staging flush, the copies see the uploads of the previous frame
+        if (!cmd) {
+            cmd = device.RequestCommandBuffer(CommandBuffer::Type::GENERIC);
+        }
+
+        for (const BuddyPoolMove& move : moves) {
+            const Owner& owner = owners[move.allocation];
+
+            if (owner.buffer) {
+                const MemoryAllocation dst = typed.ToMemoryAllocation(move.dst, owner.buffer->bufferMemory.alignment);
+                this->MoveBuffer(*cmd, *owner.buffer, dst);
+                stats.movedBuffers++;
+            } else {
+                const MemoryAllocation dst = typed.ToMemoryAllocation(move.dst, owner.image->imageMemory.alignment);
+                this->MoveImage(*cmd, *owner.image, dst);
+                stats.movedImages++;
+            }
+
+            stats.movedBytes += move.dst.size;
+            moved++;
+        }
+    }
+
+    if (cmd) {
+        device.Submit(CommandBuffer::Type::GENERIC, cmd);
+    }
+
+    return moved;
+}
+
+void Renderer::MemoryDefragmenter::MoveBuffer(CommandBuffer& cmd, Buffer& buffer, const MemoryAllocation& memory)
+{
+    const BufferInfo& info = buffer.GetBufferInfo();
+    VkBuffer apiBuffer = device.CreateBufferHelper(info);
+    vkBindBufferMemory(device.GetDevice(), apiBuffer, memory.memory, memory.offset);
+
+    cmd.Barrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    VkBufferCopy region;
+    region.srcOffset = 0;
+    region.dstOffset = 0;
+    region.size      = info.size;
+    vkCmdCopyBuffer(cmd.GetApiObject(), buffer.apiBuffer, apiBuffer, 1, &region);
+
+    cmd.Barrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+
+    // The frames in flight still use the old buffer, both go through the deferred destruction
+    device.DestroyBuffer(buffer.apiBuffer);
+    device.FreeMemory(buffer.bufferMemory);
+    buffer.apiBuffer = apiBuffer;
+    buffer.bufferMemory = memory;
+}
+
+void Renderer::MemoryDefragmenter::MoveImage(CommandBuffer& cmd, Image& image, const MemoryAllocation& memory)
+{
+    const ImageCreateInfo& info = image.GetInfo();
+    VkImageCopy regions[16];
+    ASSERTF(info.levels <= ARRAY_SIZE(regions), "Can't move an image with %d levels", info.levels);
+
+    MemoryDomain domain;
+    VkImageLayout initialLayout;
+    VkImage apiImage = device.CreateImageHelper(info, domain, initialLayout);
+    vkBindImageMemory(device.GetDevice(), apiImage, memory.memory, memory.offset);
+
+    const VkImageSubresourceRange range = { FormatToAspectMask(info.format), 0, info.levels, 0, info.layers };
+    VkImageMemoryBarrier barriers[2];
+
+    for (uint32 i = 0; i < 2; i++) {
+        barriers[i] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].subresourceRange = range;
+    }
+
+    barriers[0].image         = image.apiImage;
+    barriers[0].oldLayout     = info.layout;
+    barriers[0].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[1].image         = apiImage;
+    barriers[1].oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    cmd.Barrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, NULL, 0, NULL, 2, barriers);
+
+    for (uint32 level = 0; level < info.levels; level++) {
+        VkImageCopy& region = regions[level];
+        region.srcSubresource = { range.aspectMask, level, 0, info.layers };
+        region.dstSubresource = region.srcSubresource;
+        region.srcOffset      = { 0, 0, 0 };
+        region.dstOffset      = { 0, 0, 0 };
+        region.extent         = { image.GetWidth(level), image.GetHeight(level), MAX(info.depth >> level, 1u) };
+    }
+
+    vkCmdCopyImage(cmd.GetApiObject(), image.apiImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        apiImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, info.levels, regions);
+
+    barriers[1].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout     = info.layout;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    cmd.Barrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, NULL, 0, NULL, 1, &barriers[1]);
+
+    // Same view as before on the new image
+    if (image.defaultView) {
+        ImageView& view = *image.defaultView;
+        const ImageViewCreateInfo& viewInfo = view.GetInfo();
+
+        VkImageViewCreateInfo vkViewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        vkViewInfo.image      = apiImage;
+        vkViewInfo.viewType   = viewInfo.viewType;
+        vkViewInfo.format     = viewInfo.format;
+        vkViewInfo.components = viewInfo.swizzle;
+        vkViewInfo.subresourceRange = {
+            FormatToAspectMask(viewInfo.format),
+            viewInfo.baseLevel, viewInfo.levels,
+            viewInfo.baseLayer, viewInfo.layers
+        };
+
+        VkImageView apiView;
+        vkCreateImageView(device.GetDevice(), &vkViewInfo, NULL, &apiView);
+        device.DestroyImageView(view.apiImageView);
+        view.apiImageView = apiView;
+    }
+
+    device.DestroyImage(image.apiImage);
+    device.FreeMemory(image.imageMemory);
+    image.apiImage = apiImage;
+    image.imageMemory = memory;
+}
+
+TRE_NS_END
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include <Renderer/Backend/Common.hpp>
+#include <Renderer/Backend/RHI/Common/Globals.hpp>
+#include <Renderer/Backend/RHI/MemoryAllocator/MemoryAllocator.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	class RenderDevice;
+	class Buffer;
+	class Image;
+	class CommandBuffer;
+
+	/*
+	 * Incremental defragmentation of the suballocated device memory. Each step plans a few moves per memory type on the
+	 * CPU (BuddyBlockPool::PlanDefragmentation), recreates the moved resources at their new place, records the copies and
+	 * points the Buffer/Image objects to the new Vulkan handles. The old handles and memory go through the device's
+	 * deferred destruction so frames still in flight keep reading them. Descriptors are written from the objects on every
+	 * bind so they pick the new handles up.
+	 *
+	 * Only device local buffers that can be copied (transfer src usage, no ring) and images created with
+	 * IMAGE_MISC_MOVABLE_BIT are moved. For images only the default view is recreated.
+	 */
+	class RENDERER_API MemoryDefragmenter
+	{
+	public:
+		struct Config
+		{
+			VkDeviceSize maxBytesPerStep = 16u << 20;
+			uint32 maxMovesPerStep = 32;
+		};
+
+		struct Stats
+		{
+			uint64 movedBytes;
+			uint32 movedBuffers;
+			uint32 movedImages;
+		};
+	public:
+		MemoryDefragmenter(RenderDevice& device);
+
+		// Resources that can't be moved are ignored
+		void Register(Buffer& buffer);
+
+		void Register(Image& image);
+
+		void Unregister(Buffer& buffer);
+
+		void Unregister(Image& image);
+
+		// Plans and records this step's moves on the generic queue, returns the number of resources moved
+		uint32 Step(const Config& config);
+
+		FORCEINLINE const Stats& GetStats() const { return stats; }
+
+	private:
+		struct Owner
+		{
+			Buffer* buffer;
+			Image* image;
+		};
+
+		void MoveBuffer(CommandBuffer& cmd, Buffer& buffer, const MemoryAllocation& memory);
+
+		void MoveImage(CommandBuffer& cmd, Image& image, const MemoryAllocation& memory);
+
+	private:
+		RenderDevice& device;
+		std::unordered_set<Buffer*> buffers;
+		std::unordered_set<Image*> images;
+
+		std::vector<BuddyPoolAllocation> live;
+		std::vector<Owner> owners;
+		std::vector<BuddyPoolMove> moves;
+		Stats stats;
+	};
+}
+
+TRE_NS_END
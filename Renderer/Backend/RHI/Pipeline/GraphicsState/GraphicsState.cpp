@@ -111,6 +111,7 @@ void Renderer::GraphicsState::Reset()
     viewportState.scissorCount = 0;
 
     subpassIndex = 0;
+    memset(partHashes, 0, sizeof(partHashes));
 }
 
 void Renderer::GraphicsState::AddViewport(const VkViewport& viewport)
@@ -135,7 +136,12 @@ Renderer::Hash Renderer::GraphicsState::CalculateHash()
 
     h.u32(inputAssemblyState.topology);
     h.u32(inputAssemblyState.primitiveRestartEnable);
+    partHashes[VERTEX_INPUT] = h.Get();
 
+    h = Hasher();
+    h.u32(subpassIndex);
+    h.u32(viewportState.viewportCount);
+    h.u32(viewportState.scissorCount);
     h.u32(rasterizationState.depthClampEnable);
     h.u32(rasterizationState.rasterizerDiscardEnable);
     h.u32(rasterizationState.polygonMode);
@@ -146,14 +152,19 @@ Renderer::Hash Renderer::GraphicsState::CalculateHash()
     h.f32(rasterizationState.depthBiasClamp);
     h.f32(rasterizationState.depthBiasSlopeFactor);
     h.f32(rasterizationState.lineWidth);
-
-    h.u32(multisampleState.rasterizationSamples);
-    h.u32(multisampleState.sampleShadingEnable);
-    h.f32(multisampleState.minSampleShading);
-    h.u64((uint64)multisampleState.pSampleMask);
-    h.u32(multisampleState.alphaToCoverageEnable);
-    h.u32(multisampleState.alphaToOneEnable);
-    
+    partHashes[PRE_RASTERIZATION] = h.Get();
+
+    // Both fragment parts need the multisample state
+    Hasher multisample;
+    multisample.u32(subpassIndex);
+    multisample.u32(multisampleState.rasterizationSamples);
+    multisample.u32(multisampleState.sampleShadingEnable);
+    multisample.f32(multisampleState.minSampleShading);
+    multisample.u64((uint64)multisampleState.pSampleMask);
+    multisample.u32(multisampleState.alphaToCoverageEnable);
+    multisample.u32(multisampleState.alphaToOneEnable);
+
+    h = multisample;
     h.u32(depthStencilState.depthTestEnable);
     h.u32(depthStencilState.depthWriteEnable);
     h.u32(depthStencilState.depthCompareOp);
@@ -163,7 +174,9 @@ Renderer::Hash Renderer::GraphicsState::CalculateHash()
     h.Data(reinterpret_cast<const uint32*>(&depthStencilState.back), sizeof(VkStencilOpState) / 4);
     h.f32(depthStencilState.minDepthBounds);
     h.f32(depthStencilState.maxDepthBounds);
+    partHashes[FRAGMENT_SHADER] = h.Get();
 
+    h = multisample;
     h.u32(colorBlendState.logicOpEnable);
     h.u32(colorBlendState.logicOp);
     h.u32(colorBlendState.attachmentCount);
@@ -183,6 +196,13 @@ Renderer::Hash Renderer::GraphicsState::CalculateHash()
     for (uint32 i = 0; i < 4; i++)
         h.f32(colorBlendState.blendConstants[i]);
 
+    partHashes[FRAGMENT_OUTPUT] = h.Get();
+
+    h = Hasher();
+
+    for (uint32 i = 0; i < LIBRARY_PART_MAX; i++)
+        h.u64(partHashes[i]);
+
     hash = h.Get();
     return h.Get();
 }
@@ -19,6 +19,17 @@ namespace Renderer
 
 	class GraphicsState : public Hashable
 	{
+	public:
+		// The state subsets a pipeline library can be built with (VK_EXT_graphics_pipeline_library)
+		enum LibraryPart
+		{
+			VERTEX_INPUT = 0,	// Input assembly
+			PRE_RASTERIZATION,	// Rasterization, viewport counts
+			FRAGMENT_SHADER,	// Depth stencil, multisample
+			FRAGMENT_OUTPUT,	// Color blend, multisample
+
+			LIBRARY_PART_MAX
+		};
 	public:
 		GraphicsState();
 
@@ -40,6 +51,9 @@ namespace Renderer
 
 		FORCEINLINE const VkPipelineViewportStateCreateInfo& GetViewportState() const { return viewportState; }
 
+		// Only the state that goes in that part, the whole state hash combines them. Updated by SaveChanges as well.
+		FORCEINLINE Hash GetLibraryPartHash(LibraryPart part) const { return partHashes[part]; }
+
 	private:
 		Hash CalculateHash();
 	private:
@@ -55,6 +69,7 @@ namespace Renderer
 		VkRect2D							scissors[8];
 
 		uint32								subpassIndex;
+		Hash								partHashes[LIBRARY_PART_MAX];
 
 		friend class Pipeline;
 		friend class CommandBuffer;
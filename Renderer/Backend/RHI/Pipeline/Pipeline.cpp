@@ -56,8 +56,6 @@ void Renderer::Pipeline::Create(RenderDevice& device, uint32 maxDepth, uint32 ma
     vkCreateRayTracingPipelinesKHR(device.GetDevice(), deferredOperation, VK_NULL_HANDLE, 1, &rayTraceInfo, NULL, &pipeline);
 
     sbt.Init(device, *shaderProgram, *this);
-
-    shaderProgram->DestroyShaderModules();
 }
 
 // Compute:
@@ -75,19 +73,29 @@ void Renderer::Pipeline::Create(RenderDevice& device)
     info.basePipelineIndex = -1;
 
     vkCreateComputePipelines(device.GetDevice(), VK_NULL_HANDLE, 1, &info, NULL, &pipeline);
-
-    shaderProgram->DestroyShaderModules();
 }
 
 // Graphics
-void Renderer::Pipeline::Create(const RenderContext& renderContext, const VertexInput& vertexInput, const GraphicsState& state)
+struct Renderer::Pipeline::GraphicsCreateInfo
 {
-    renderDevice = renderContext.GetRenderDevice();
-
-    VkViewport viewport;
-    VkRect2D scissor;
-
-    VkPipelineViewportStateCreateInfo viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+    VkViewport                          viewport;
+    VkRect2D                            scissor;
+    VkPipelineViewportStateCreateInfo   viewportState;
+    VkPipelineDynamicStateCreateInfo    dynamicState;
+    VkGraphicsPipelineCreateInfo        pipelineInfo;
+};
+
+static const VkDynamicState GRAPHICS_DYNAMIC_STATES[] = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+    VK_DYNAMIC_STATE_LINE_WIDTH,
+};
+
+void Renderer::Pipeline::FillGraphicsCreateInfo(const RenderContext& renderContext, const VertexInput& vertexInput,
+    const RenderPass& renderPass, const GraphicsState& state, GraphicsCreateInfo& info)
+{
+    VkPipelineViewportStateCreateInfo& viewportState = info.viewportState;
+    viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
     viewportState.viewportCount = state.GetViewportState().viewportCount;
     viewportState.pViewports = state.GetViewportState().pViewports;
     viewportState.scissorCount = state.GetViewportState().scissorCount;
@@ -97,36 +105,26 @@ void Renderer::Pipeline::Create(const RenderContext& renderContext, const Vertex
         const Swapchain::SwapchainData& swapchainData = renderContext.GetSwapchain().GetSwapchainData();
         // state.AddViewport({ 0.f, 0.f, (float)swapchainData.swapChainExtent.width, (float)swapchainData.swapChainExtent.height, 0.f, 1.f });
 
-        viewport = { 0.f, 0.f, (float)swapchainData.swapChainExtent.width, (float)swapchainData.swapChainExtent.height, 0.f, 1.f };
+        info.viewport = { 0.f, 0.f, (float)swapchainData.swapChainExtent.width, (float)swapchainData.swapChainExtent.height, 0.f, 1.f };
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
+        viewportState.pViewports = &info.viewport;
     }
 
     if (state.viewportState.scissorCount == 0) {
         const Swapchain::SwapchainData& swapchainData = renderContext.GetSwapchain().GetSwapchainData();
         // state.AddScissor({ {0, 0}, swapchainData.swapChainExtent });
 
-        scissor = { {0, 0}, swapchainData.swapChainExtent };
+        info.scissor = { {0, 0}, swapchainData.swapChainExtent };
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
-    }
-    
-    VkDynamicState dynamicStatesArray[] = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR,
-        VK_DYNAMIC_STATE_LINE_WIDTH,
-    };
-
-    for (uint32 i = 0; i < ARRAY_SIZE(dynamicStatesArray); i++) {
-        dynamicState |= 1 << dynamicStatesArray[i];
+        viewportState.pScissors = &info.scissor;
     }
 
-    VkPipelineDynamicStateCreateInfo dynamicState;
+    VkPipelineDynamicStateCreateInfo& dynamicState = info.dynamicState;
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicState.pNext = NULL;
     dynamicState.flags = 0;
-    dynamicState.dynamicStateCount = ARRAY_SIZE(dynamicStatesArray);
-    dynamicState.pDynamicStates = dynamicStatesArray;
+    dynamicState.dynamicStateCount = ARRAY_SIZE(GRAPHICS_DYNAMIC_STATES);
+    dynamicState.pDynamicStates = GRAPHICS_DYNAMIC_STATES;
     
     // Add shader specilization here:
     /*{
@@ -143,12 +141,12 @@ void Renderer::Pipeline::Create(const RenderContext& renderContext, const Vertex
         // shaderStages->pSpecializationInfo
     }*/
     
-    VkGraphicsPipelineCreateInfo pipelineInfo;
+    VkGraphicsPipelineCreateInfo& pipelineInfo = info.pipelineInfo;
     pipelineInfo.sType                  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.pNext                  = NULL;
     pipelineInfo.flags                  = 0;
-    pipelineInfo.stageCount             = (uint32)shaderProgram->GetShadersCount();
-    pipelineInfo.pStages                = shaderProgram->GetShaderStages(); //shaderStagesDesc.data();
+    pipelineInfo.stageCount             = 0;
+    pipelineInfo.pStages                = NULL;
     pipelineInfo.pVertexInputState      = &vertexInput.GetVertexInputDesc();
     pipelineInfo.pViewportState         = &viewportState;
     pipelineInfo.pInputAssemblyState    = &state.inputAssemblyState;
@@ -158,18 +156,36 @@ void Renderer::Pipeline::Create(const RenderContext& renderContext, const Vertex
     pipelineInfo.pDepthStencilState     = &state.depthStencilState;
     pipelineInfo.pColorBlendState       = &state.colorBlendState;
     pipelineInfo.pDynamicState          = &dynamicState;
-    pipelineInfo.layout                 = shaderProgram->GetPipelineLayout().GetApiObject();
-    pipelineInfo.renderPass             = renderPass->GetApiObject();
+    pipelineInfo.layout                 = VK_NULL_HANDLE;
+    pipelineInfo.renderPass             = renderPass.GetApiObject();
     pipelineInfo.subpass                = state.subpassIndex; //desc.subpass;
     pipelineInfo.basePipelineHandle     = VK_NULL_HANDLE; //desc.basePipelineHandle;
     pipelineInfo.basePipelineIndex      = -1;//desc.basePipelineIndex;
+}
+
+void Renderer::Pipeline::SetDynamicStates(const VkDynamicState* states, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++) {
+        dynamicState |= 1 << states[i];
+    }
+}
 
-    if (vkCreateGraphicsPipelines(renderContext.GetRenderDevice()->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS) {
+void Renderer::Pipeline::Create(const RenderContext& renderContext, const VertexInput& vertexInput, const GraphicsState& state)
+{
+    renderDevice = renderContext.GetRenderDevice();
+    this->SetDynamicStates(GRAPHICS_DYNAMIC_STATES, ARRAY_SIZE(GRAPHICS_DYNAMIC_STATES));
+
+    GraphicsCreateInfo info;
+    FillGraphicsCreateInfo(renderContext, vertexInput, *renderPass, state, info);
+    info.pipelineInfo.stageCount = (uint32)shaderProgram->GetShadersCount();
+    info.pipelineInfo.pStages = shaderProgram->GetShaderStages(); //shaderStagesDesc.data();
+    info.pipelineInfo.layout = shaderProgram->GetPipelineLayout().GetApiObject();
+
+    if (vkCreateGraphicsPipelines(renderContext.GetRenderDevice()->GetDevice(), VK_NULL_HANDLE, 1, &info.pipelineInfo, NULL, &pipeline) != VK_SUCCESS) {
         ASSERTF(true, "Failed to create graphics pipeline!");
     }
 
-    shaderProgram->DestroyShaderModules();
-    printf("Creating new pipline\n");
+    TRE_LOGD("Creating new pipline");
 }
 
 void Renderer::Pipeline::Create(const RenderContext& renderContext, const GraphicsState& state)
@@ -177,6 +193,109 @@ void Renderer::Pipeline::Create(const RenderContext& renderContext, const Graphi
     this->Create(renderContext, shaderProgram->GetVertexInput(), state);
 }
 
+VkPipeline Renderer::Pipeline::CreateLibrary(const RenderContext& renderContext, const ShaderProgram& program, const RenderPass& renderPass,
+    const GraphicsState& state, GraphicsState::LibraryPart part)
+{
+#if defined(VK_EXT_graphics_pipeline_library)
+    CONSTEXPR VkGraphicsPipelineLibraryFlagsEXT PART_FLAGS[] = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+    };
+
+    GraphicsCreateInfo info;
+    FillGraphicsCreateInfo(renderContext, program.GetVertexInput(), renderPass, state, info);
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo;
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryInfo.pNext = NULL;
+    libraryInfo.flags = PART_FLAGS[part];
+
+    // The state of the other parts is ignored, their shaders aren't
+    VkPipelineShaderStageCreateInfo stages[ShaderProgram::END_RASTER];
+    uint32 stageCount = 0;
+
+    if (part == GraphicsState::PRE_RASTERIZATION || part == GraphicsState::FRAGMENT_SHADER) {
+        ASSERT(program.GetShadersCount() <= ARRAY_SIZE(stages));
+
+        for (uint32 i = 0; i < program.GetShadersCount(); i++) {
+            const VkPipelineShaderStageCreateInfo& stage = program.GetShaderStages()[i];
+
+            if ((stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT) == (part == GraphicsState::FRAGMENT_SHADER)) {
+                stages[stageCount++] = stage;
+            }
+        }
+
+        info.pipelineInfo.layout = program.GetPipelineLayout().GetApiObject();
+    }
+
+    if (part == GraphicsState::VERTEX_INPUT) {
+        info.pipelineInfo.renderPass = VK_NULL_HANDLE;
+    }
+
+    info.pipelineInfo.pNext = &libraryInfo;
+    info.pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    info.pipelineInfo.stageCount = stageCount;
+    info.pipelineInfo.pStages = stageCount ? stages : NULL;
+
+    VkPipeline library = VK_NULL_HANDLE;
+
+    if (vkCreateGraphicsPipelines(renderContext.GetRenderDevice()->GetDevice(), VK_NULL_HANDLE, 1, &info.pipelineInfo, NULL, &library) != VK_SUCCESS) {
+        ASSERTF(false, "Failed to create graphics pipeline library!");
+    }
+
+    return library;
+#else
+    return VK_NULL_HANDLE;
+#endif
+}
+
+VkPipeline Renderer::Pipeline::LinkLibraries(VkDevice device, VkPipelineLayout layout, const VkPipeline* libraries, uint32 count, bool optimize)
+{
+#if defined(VK_EXT_graphics_pipeline_library)
+    VkPipelineLibraryCreateInfoKHR libraryInfo;
+    libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryInfo.pNext = NULL;
+    libraryInfo.libraryCount = count;
+    libraryInfo.pLibraries = libraries;
+
+    // All the state comes from the parts, the render pass as well
+    VkGraphicsPipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineInfo.pNext = &libraryInfo;
+    pipelineInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    // Called from worker threads as well, the caller keeps what it has on failure
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS) {
+        TRE_LOGE("Failed to link graphics pipeline libraries (optimized: %d)", optimize);
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+#else
+    return VK_NULL_HANDLE;
+#endif
+}
+
+void Renderer::Pipeline::Create(RenderDevice& device, const VkPipeline* libraries, uint32 count)
+{
+    renderDevice = &device;
+    this->SetDynamicStates(GRAPHICS_DYNAMIC_STATES, ARRAY_SIZE(GRAPHICS_DYNAMIC_STATES));
+
+    pipeline = LinkLibraries(device.GetDevice(), shaderProgram->GetPipelineLayout().GetApiObject(), libraries, count, false);
+
+    if (pipeline == VK_NULL_HANDLE) {
+        ASSERTF(false, "Failed to link graphics pipeline!");
+    }
+
+    TRE_LOGD("Linking new pipline");
+}
+
 Renderer::Pipeline::~Pipeline()
 {
     if (renderDevice) {
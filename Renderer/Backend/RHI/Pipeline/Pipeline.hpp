@@ -64,11 +64,42 @@ namespace Renderer
 			const RenderContext& renderContext,
 			const GraphicsState& state);
 
+		// Graphics pipeline library (VK_EXT_graphics_pipeline_library):
+		// A part of the pipeline compiled on its own, kept with what link time optimizations need
+		static VkPipeline CreateLibrary(
+			const RenderContext& renderContext,
+			const ShaderProgram& program,
+			const RenderPass& renderPass,
+			const GraphicsState& state,
+			GraphicsState::LibraryPart part);
+
+		// Links the parts into a whole pipeline, optimizing takes about as long as a monolithic compile
+		static VkPipeline LinkLibraries(VkDevice device, VkPipelineLayout layout, const VkPipeline* libraries, uint32 count, bool optimize);
+
+		// Fast links the parts, the pipeline can be bound right away
+		void Create(RenderDevice& device, const VkPipeline* libraries, uint32 count);
+
+		// Swaps in a pipeline built from the same parts (the optimized one), returns the old one to be retired
+		FORCEINLINE VkPipeline Replace(VkPipeline newPipeline)
+		{
+			VkPipeline old = pipeline;
+			pipeline = newPipeline;
+			return old;
+		}
+
 		void SetRenderPass(const RenderPass* renderPass) { this->renderPass = renderPass; }
 
 		const RenderPass* GetRenderPass() const { return renderPass; }
 
 		bool IsStateDynamic(VkDynamicState state) const { return dynamicState & (1 << state); }
+	private:
+		struct GraphicsCreateInfo;
+
+		// The state whole pipelines and their parts are created with, everything but the flags, stages and layout
+		static void FillGraphicsCreateInfo(const RenderContext& renderContext, const VertexInput& vertexInput,
+			const RenderPass& renderPass, const GraphicsState& state, GraphicsCreateInfo& info);
+
+		void SetDynamicStates(const VkDynamicState* states, uint32 count);
 	protected:
         RenderDevice*  renderDevice;
         ShaderProgram*       shaderProgram;
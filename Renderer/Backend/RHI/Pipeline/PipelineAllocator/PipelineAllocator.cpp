@@ -7,6 +7,11 @@ Renderer::PipelineAllocator::PipelineAllocator(RenderDevice& device) : device(de
 {
 }
 
+void Renderer::PipelineAllocator::Init(uint32 workerCount)
+{
+	compileQueue.Init(workerCount);
+}
+
 Renderer::Pipeline& Renderer::PipelineAllocator::RequestPipline(ShaderProgram& program, const RenderPass& rp, const GraphicsState& state)
 {
 	// Graphics pipeline:
@@ -21,12 +26,56 @@ Renderer::Pipeline& Renderer::PipelineAllocator::RequestPipline(ShaderProgram& p
 	if (ret.second) {
 		pipline.SetRenderPass(&rp);
 		// pipline.SetShaderProgram(&program);
-        pipline.Create(*device.GetRenderContext(), state);
+
+		if (device.IsGraphicsPipelineLibrarySupported()) {
+			VkPipeline libraries[GraphicsState::LIBRARY_PART_MAX];
+
+			for (uint32 i = 0; i < GraphicsState::LIBRARY_PART_MAX; i++) {
+				libraries[i] = this->RequestLibrary(program, rp, state, (GraphicsState::LibraryPart)i);
+			}
+
+			pipline.Create(device, libraries, GraphicsState::LIBRARY_PART_MAX);
+
+			// The job copies the handles, the parts and the layout outlive it as Clear and Destroy drain the queue first
+			VkDevice dev = device.GetDevice();
+			VkPipelineLayout layout = program.GetPipelineLayout().GetApiObject();
+
+			compileQueue.Submit(h.Get(), [dev, layout, libraries]() {
+				return Pipeline::LinkLibraries(dev, layout, libraries, GraphicsState::LIBRARY_PART_MAX, true);
+			});
+		} else {
+			pipline.Create(*device.GetRenderContext(), state);
+		}
 	}
 
 	return pipline;
 }
 
+VkPipeline Renderer::PipelineAllocator::RequestLibrary(ShaderProgram& program, const RenderPass& rp, const GraphicsState& state,
+	GraphicsState::LibraryPart part)
+{
+	Hasher h;
+	h.u32(part);
+	h.u64(state.GetLibraryPartHash(part));
+
+	// The vertex input comes from the program, the output interface from the render pass, the shader parts need both
+	if (part != GraphicsState::FRAGMENT_OUTPUT) {
+		h.u64(program.GetHash());
+	}
+
+	if (part != GraphicsState::VERTEX_INPUT) {
+		h.u64(rp.GetHash());
+	}
+
+	auto ret = libraryCache.emplace(h.Get(), VK_NULL_HANDLE);
+
+	if (ret.second) {
+		ret.first->second = Pipeline::CreateLibrary(*device.GetRenderContext(), program, rp, state, part);
+	}
+
+	return ret.first->second;
+}
+
 Renderer::Pipeline& Renderer::PipelineAllocator::RequestPipline(ShaderProgram& program)
 {
 	// Compute pipeline:
@@ -45,15 +94,52 @@ Renderer::Pipeline& Renderer::PipelineAllocator::RequestPipline(ShaderProgram& p
 
 void Renderer::PipelineAllocator::BeginFrame()
 {
+	compileQueue.Collect([this](uint64 key, VkPipeline optimized) {
+		if (optimized == VK_NULL_HANDLE)
+			return;
+
+		auto it = pipelineCache.find(key);
+
+		if (it == pipelineCache.end()) {
+			vkDestroyPipeline(device.GetDevice(), optimized, NULL);
+			return;
+		}
+
+		// The frames in flight may still use the fast linked one
+		device.DestroyPipeline(it->second.Replace(optimized));
+	});
+}
+
+void Renderer::PipelineAllocator::DestroyLibraries()
+{
+	compileQueue.Drain();
+
+	// Never bound, nothing waits on them
+	compileQueue.Collect([this](uint64, VkPipeline optimized) {
+		if (optimized != VK_NULL_HANDLE) {
+			vkDestroyPipeline(device.GetDevice(), optimized, NULL);
+		}
+	});
+
+	for (const auto& library : libraryCache) {
+		if (library.second != VK_NULL_HANDLE) {
+			vkDestroyPipeline(device.GetDevice(), library.second, NULL);
+		}
+	}
+
+	libraryCache.clear();
 }
 
 void Renderer::PipelineAllocator::Clear()
 {
+	this->DestroyLibraries();
 	pipelineCache.clear();
 }
 
 void Renderer::PipelineAllocator::Destroy()
 {
+	compileQueue.Shutdown();
+	this->DestroyLibraries();
     pipelineCache.clear();
 }
 
@@ -3,6 +3,7 @@
 #include <Renderer/Backend/Common.hpp>
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/RHI/Pipeline/Pipeline.hpp>
+#include <Renderer/Backend/RHI/Pipeline/PipelineAllocator/PipelineCompileQueue.hpp>
 #include <Renderer/Backend/Core/Hashmap/TemporaryHashmap.hpp>
 
 TRE_NS_START
@@ -13,23 +14,46 @@ namespace Renderer
 	class ShaderProgram;
 	class RenderPass;
 
+	/*
+	 * Graphics pipelines are created the first time they are bound. With VK_EXT_graphics_pipeline_library that doesn't
+	 * compile them whole: their vertex input, pre-rasterization, fragment shader and fragment output parts are compiled
+	 * once per program, render pass and state they depend on, then quickly linked. The optimized pipeline is linked from
+	 * the same parts on worker threads and swapped in at the start of a frame once ready.
+	 */
 	class RENDERER_API PipelineAllocator
 	{
 	public:
         PipelineAllocator(RenderDevice& device);
 
+		// Links optimized pipelines on workerCount pool workers at most (0 for all), only needed with graphics pipeline libraries
+		void Init(uint32 workerCount = 0);
+
 		Pipeline& RequestPipline(ShaderProgram& program, const RenderPass& rp, const GraphicsState& state);
 
 		Pipeline& RequestPipline(ShaderProgram& program);
 
+		// Swaps in the optimized pipelines done since the last frame
 		void BeginFrame();
 
 		void Clear();
 
 		void Destroy();
+
+		// Optimized pipelines queued or being linked
+		FORCEINLINE uint32 GetPendingOptimizations() { return compileQueue.GetPendingCount(); }
+
+		// Blocks until the optimized pipelines queued are linked (behind a loading screen), they are swapped in next frame
+		FORCEINLINE void WaitForOptimizations() { compileQueue.WaitIdle(); }
+	private:
+		VkPipeline RequestLibrary(ShaderProgram& program, const RenderPass& rp, const GraphicsState& state, GraphicsState::LibraryPart part);
+
+		// Waits for the background links and releases their pipelines, then the parts
+		void DestroyLibraries();
 	private:
         RenderDevice& device;
 		std::unordered_map<Hash, Pipeline> pipelineCache;
+		std::unordered_map<Hash, VkPipeline> libraryCache;
+		PipelineCompileQueue<VkPipeline> compileQueue;
 	};
 }
 
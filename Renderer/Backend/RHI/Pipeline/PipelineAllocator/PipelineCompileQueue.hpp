@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * Runs slow compiles (optimized pipelines) on the worker pool while the render thread keeps using what it already
+	 * has, workerCount of them at once at most. Jobs are keyed, a key already queued, running or waiting to be collected isn't submitted twice. The render
+	 * thread picks the results up with Collect, in the order they finished, whenever it can swap them in safely.
+	 */
+	template<typename Result>
+	class PipelineCompileQueue
+	{
+	public:
+		typedef std::function<Result()> Job;
+
+		PipelineCompileQueue() = default;
+
+		PipelineCompileQueue(const PipelineCompileQueue&) = delete;
+
+		PipelineCompileQueue& operator=(const PipelineCompileQueue&) = delete;
+
+		~PipelineCompileQueue() { this->Shutdown(); }
+
+		// At most as many compiles at once as the pool has workers, 0 for all of them
+		void Init(uint32 workerCount = 0)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ASSERT(!isRunning);
+
+			const uint32 poolWorkers = WorkerPool::Instance().GetWorkerCount();
+			this->workerCount = workerCount ? std::min(workerCount, poolWorkers) : poolWorkers;
+			isRunning = true;
+		}
+
+		// Drops what is still queued and waits for the jobs running, results already done stay there to be collected
+		void Shutdown()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			if (!isRunning)
+				return;
+
+			isRunning = false;
+			this->DropQueued();
+			completed.wait(lock, [this]() { return scheduledCount == 0; });
+			workerCount = 0;
+		}
+
+		// False when the key is already in, or before Init: the caller keeps what it has
+		bool Submit(uint64 key, Job&& job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (!isRunning || !keys.insert(key).second)
+					return false;
+
+				jobs.emplace_back(key, std::move(job));
+
+				if (scheduledCount == workerCount)
+					return true;
+
+				scheduledCount++;
+			}
+
+			WorkerPool::Instance().Submit([this]() { this->ProcessJob(); });
+			return true;
+		}
+
+		// Drops what is still queued and waits for the jobs running, their results are then all there to be collected
+		void Drain()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			this->DropQueued();
+			completed.wait(lock, [this]() { return runningCount == 0; });
+		}
+
+		// Waits for every job submitted to be done, a loading screen can finish the optimizations before play starts
+		void WaitIdle()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completed.wait(lock, [this]() { return runningCount == 0 && (jobs.empty() || !isRunning); });
+		}
+
+		// Render thread, calls onReady(key, result) for every job done since the last call, returns how many there were
+		template<typename F>
+		uint32 Collect(F&& onReady)
+		{
+			std::vector<std::pair<uint64, Result>> ready;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (results.empty())
+					return 0;
+
+				ready.swap(results);
+
+				for (const auto& result : ready) {
+					keys.erase(result.first);
+				}
+			}
+
+			for (auto& result : ready) {
+				onReady(result.first, result.second);
+			}
+
+			return (uint32)ready.size();
+		}
+
+		// Queued and running jobs
+		uint32 GetPendingCount()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return (uint32)jobs.size() + runningCount;
+		}
+
+		// Pool workers the queue may take at once
+		FORCEINLINE uint32 GetWorkerCount() const { return workerCount; }
+	private:
+		// Called with the mutex held
+		void DropQueued()
+		{
+			for (const auto& job : jobs) {
+				keys.erase(job.first);
+			}
+
+			jobs.clear();
+		}
+
+		// One job per pool job, then back in the pool's queue if there are more so the other services get their turn
+		void ProcessJob()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			if (!jobs.empty()) {
+				std::pair<uint64, Job> job = std::move(jobs.front());
+				jobs.pop_front();
+				runningCount++;
+
+				lock.unlock();
+				Result result = job.second();
+				lock.lock();
+
+				results.emplace_back(job.first, std::move(result));
+				runningCount--;
+				completed.notify_all();
+
+				if (!jobs.empty()) {
+					lock.unlock();
+					WorkerPool::Instance().Submit([this]() { this->ProcessJob(); });
+					return;
+				}
+			}
+
+			scheduledCount--;
+			completed.notify_all();
+		}
+	private:
+		std::deque<std::pair<uint64, Job>> jobs;
+		std::vector<std::pair<uint64, Result>> results;
+		std::unordered_set<uint64> keys;
+		std::mutex mutex;
+		std::condition_variable completed;
+		uint32 workerCount = 0;
+		uint32 scheduledCount = 0; // Pool jobs queued or running
+		uint32 runningCount = 0;
+		bool isRunning = false;
+	};
+}
+
+TRE_NS_END
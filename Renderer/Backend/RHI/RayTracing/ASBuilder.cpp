@@ -1,375 +1,650 @@
 #include "ASBuilder.hpp"
+#include <algorithm>
+#include <unordered_set>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
-#include <Renderer/Backend/RHI/Images/Image.hpp>
 #include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
+#include <Renderer/Backend/RHI/RenderContext/RenderContext.hpp>
 #include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
 #include <Renderer/Backend/RHI/RayTracing/TLAS/TLAS.hpp>
 
 TRE_NS_START
 
+// Upper bound of minAccelerationStructureScratchOffsetAlignment on current implementations
+CONSTEXPR static VkDeviceSize SCRATCH_ALIGNMENT = 256;
+
+// dst is mapped memory, the instance is filled locally and written once and in order
+static void WriteInstance(VkAccelerationStructureInstanceKHR* dst, const Renderer::BlasInstance& inst)
+{
+	VkAccelerationStructureInstanceKHR acclInst;
+	acclInst.instanceCustomIndex = inst.instanceCustomId;
+	acclInst.mask = inst.mask;
+	acclInst.instanceShaderBindingTableRecordOffset = inst.hitGroupId;
+	acclInst.flags = inst.flags;
+	acclInst.accelerationStructureReference = inst.blas->GetAcclAddress();
+	Renderer::PackTransform3x4(acclInst.transform.matrix[0], inst.transform);
+	memcpy(dst, &acclInst, sizeof(VkAccelerationStructureInstanceKHR));
+}
+
 Renderer::AsBuilder::AsBuilder(RenderDevice& device) :
-	renderDevice(device), maxScratchSize(MAX_UPLOAD_BUFFER_SIZE), currentStaging(0)
+	renderDevice(device), submittedValue(0), swapped(false), scratchSize(0),
+	stagingBuffer(VK_NULL_HANDLE), stagingMemory(VK_NULL_HANDLE), stagingData(NULL)
 {
 }
 
-// RT functionality:
 void Renderer::AsBuilder::Init()
 {
-	BufferCreateInfo info;
-	info.domain = MemoryDomain::GPU_ONLY;
-	info.size = maxScratchSize;
-	info.usage = BufferUsage::SHADER_DEVICE_ADDRESS | BufferUsage::STORAGE_BUFFER;
+	timeline = renderDevice.RequestTimelineSemaphore();
+	submittedValue = timeline->GetTempValue();
 
 	BufferCreateInfo stagingInfo;
 	stagingInfo.domain = MemoryDomain::CPU_COHERENT;
-	stagingInfo.size = MAX_UPLOAD_BUFFER_SIZE;
+	stagingInfo.size = STAGING_BUFFER_SIZE;
 	stagingInfo.usage = BufferUsage::TRANSFER_SRC;
 
-	for (int i = 0; i < NUM_FRAMES; i++) {
-        rtStaging[i].scratchBuffer = renderDevice.CreateBufferHelper(info);
-        rtStaging[i].address = (VkDeviceAddress)VK_NULL_HANDLE;
-		rtStaging[i].submitted = false;
-        rtStaging[i].stagingBuffer = renderDevice.CreateBufferHelper(stagingInfo);
-
-		VkCommandPoolCreateInfo commandPoolCreateInfo = {};
-		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		//TODO: we are doing RT here so what should we do maybe transfer ?
-		commandPoolCreateInfo.queueFamilyIndex = renderDevice.GetQueueFamilyIndices().queueFamilies[COMPUTE];
-		vkCreateCommandPool(renderDevice.GetDevice(), &commandPoolCreateInfo, NULL, &rtStaging[i].cmdPool);
-	}
-
-	VkDeviceSize stagingAlignedSize = 0;
-	stagingMemory = renderDevice.CreateBufferMemory(stagingInfo, rtStaging[0].stagingBuffer, &stagingAlignedSize, NUM_FRAMES);
-	vkMapMemory(renderDevice.GetDevice(), stagingMemory, 0, stagingAlignedSize * NUM_FRAMES, 0, reinterpret_cast<void**>(&stagingMappedData));
+	// Persistently mapped, bound by CreateBufferMemory
+	stagingBuffer = renderDevice.CreateBufferHelper(stagingInfo);
+	stagingMemory = renderDevice.CreateBufferMemory(stagingInfo, stagingBuffer);
+	vkMapMemory(renderDevice.GetDevice(), stagingMemory, 0, STAGING_BUFFER_SIZE, 0, reinterpret_cast<void**>(&stagingData));
+	stagingRing.Init(STAGING_BUFFER_SIZE);
+}
 
-	VkDeviceSize alignedSize = 0;
-	scartchMemory = renderDevice.CreateBufferMemory(info, rtStaging[0].scratchBuffer, &alignedSize, NUM_FRAMES);
-	VkBufferDeviceAddressInfo bufferAdrInfo{ VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+void Renderer::AsBuilder::Shutdown()
+{
+	if (!timeline)
+		return;
 
-	VkFenceCreateInfo fenceCreateInfo = {};
-	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	// The device is idle, nothing here is in use anymore
+	VkDevice device = renderDevice.GetDevice();
 
-	for (int i = 0; i < NUM_FRAMES; i++) {
-		vkBindBufferMemory(renderDevice.GetDevice(), rtStaging[i].scratchBuffer, scartchMemory, i * alignedSize);
+	for (PendingSwap& swap : pendingSwaps) {
+		vkDestroyAccelerationStructureKHR(device, swap.compacted, NULL);
+	}
 
-		bufferAdrInfo.buffer = rtStaging[i].scratchBuffer;
-		rtStaging[i].address = vkGetBufferDeviceAddressKHR(renderDevice.GetDevice(), &bufferAdrInfo);
-		vkCreateFence(renderDevice.GetDevice(), &fenceCreateInfo, NULL, &rtStaging[i].fence);
+	for (PendingCompaction& compaction : pendingCompactions) {
+		vkDestroyQueryPool(device, compaction.queryPool, NULL);
+	}
 
-		// Staging buffer for RT:
-		vkBindBufferMemory(renderDevice.GetDevice(), rtStaging[i].stagingBuffer, stagingMemory, i * stagingAlignedSize);
-		rtStaging[i].data = (uint8*)stagingMappedData + (i * alignedSize);
-		rtStaging[i].offset = 0;
+	for (CommandContext& context : commandContexts) {
+		vkDestroyCommandPool(device, context.pool, NULL);
 	}
+
+	pendingSwaps.clear();
+	pendingCompactions.clear();
+	commandContexts.clear();
+	scratchBuffers.clear();
+	blasBuilds[0].clear();
+	blasBuilds[1].clear();
+	tlasBuilds.clear();
+
+	vkUnmapMemory(device, stagingMemory);
+	vkDestroyBuffer(device, stagingBuffer, NULL);
+	vkFreeMemory(device, stagingMemory, NULL);
+	stagingBuffer = VK_NULL_HANDLE;
+	stagingMemory = VK_NULL_HANDLE;
+	stagingData = NULL;
+
+	timeline.Reset();
 }
 
-void Renderer::AsBuilder::BuildBlasBatchs()
+void Renderer::AsBuilder::StageBlasBuilding(const BlasHandle& blas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+	const VkAccelerationStructureBuildRangeInfoKHR* ranges, uint32 rangesCount, uint32 flags, VkDeviceSize scratchSize)
+{
+	const bool compact = (flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR) != 0;
+
+	blasBuilds[compact].emplace_back();
+	BlasBuild& build = blasBuilds[compact].back();
+	build.blas = blas;
+	build.buildInfo = buildInfo;
+	build.buildInfo.flags = flags;
+	// The caller's geometries may not outlive this call, the BLAS keeps its own copy
+	build.buildInfo.pGeometries = blas->GetInfo().acclGeo.begin();
+	build.ranges.assign(ranges, ranges + rangesCount);
+	build.scratchSize = scratchSize;
+}
+
+void Renderer::AsBuilder::StageTlasBuilding(const TlasHandle& tlas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+	VkBuildAccelerationStructureFlagsKHR flags, VkDeviceSize scratchSize)
 {
-	// Start by building compact ones as they have dependcies later
-	this->BuildBlasBatch(1);
-	this->BuildBlasBatch(0);
+	tlasBuilds.emplace_back();
+	TlasBuild& build = tlasBuilds.back();
+	build.tlas = tlas;
+	build.buildInfo = buildInfo;
+	build.buildInfo.flags = flags;
+	build.scratchSize = scratchSize;
+	build.region = 0;
 }
 
-void Renderer::AsBuilder::SyncAcclBuilding()
+void Renderer::AsBuilder::StageTlasUpdate(const TlasHandle& tlas)
 {
-	RtStaging* stage = &rtStaging[currentStaging];
-	bool fenceSet = stage->submitted;
+	ASSERTF(tlas->IsDynamic(), "Only dynamic TLASes can be updated, rebuild the others with CreateTlas");
 
-	if (!fenceSet)
+	if (!tlas->instanceTracker.HasChanges())
 		return;
 
-	// wait till we get everything done to re-claim resources
-	vkWaitForFences(renderDevice.GetDevice(), 1, &stage->fence, VK_TRUE, UINT64_MAX);
-	vkResetFences(renderDevice.GetDevice(), 1, &stage->fence);
-	stage->submitted = false;
+	VkAccelerationStructureBuildGeometryInfoKHR buildInfo{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+	buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+	this->StageTlasBuilding(tlas, buildInfo, tlas->buildFlags, tlas->scratchSize);
+}
+
+void Renderer::AsBuilder::BuildBlasBatchs()
+{
+	std::vector<BlasBuild>& compactBuilds = blasBuilds[1];
+
+	if (blasBuilds[0].empty() && compactBuilds.empty())
+		return;
 
-	vkResetCommandPool(renderDevice.GetDevice(), stage->cmdPool, 0);
+	CommandContext& context = this->BeginCommands();
+	VkDeviceSize maxScratchSize = 0;
 
-	for (uint32 i = 0; i < stage->batch[1].batchInfo.size(); i++) {
-		vkDestroyAccelerationStructureKHR(renderDevice.GetDevice(), stage->cleanupAS[i], NULL);
+	for (const std::vector<BlasBuild>& builds : blasBuilds) {
+		for (const BlasBuild& build : builds) {
+			maxScratchSize = std::max(maxScratchSize, build.scratchSize);
+		}
 	}
 
-	for (uint32 i = 0; i < NUM_FRAMES; i++) {
-		stage->batch[i].batchInfo.clear();
-		stage->offset = 0;
+	ScratchBuffer& scratch = this->AcquireScratch(maxScratchSize);
+	PendingCompaction compaction;
+	compaction.queryPool = VK_NULL_HANDLE;
+
+	if (!compactBuilds.empty()) {
+		VkQueryPoolCreateInfo queryPoolInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		queryPoolInfo.queryCount = (uint32)compactBuilds.size();
+		queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+		vkCreateQueryPool(renderDevice.GetDevice(), &queryPoolInfo, NULL, &compaction.queryPool);
+		vkCmdResetQueryPool(context.cmd, compaction.queryPool, 0, queryPoolInfo.queryCount);
 	}
 
-	// TRE_LOGI("Building and compression DONE.\n");
-}
+	// Compact ones first, their sizes are read back later
+	for (int32 compact = 1; compact >= 0; compact--) {
+		std::vector<BlasBuild>& builds = blasBuilds[compact];
 
-void Renderer::AsBuilder::StageTlasBuilding(Tlas* tlas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
-	VkBuildAccelerationStructureFlagsKHR flags)
-{
-	RtStaging* stage = &rtStaging[currentStaging];
+		for (uint32 i = 0; i < (uint32)builds.size(); i++) {
+			BlasBuild& build = builds[i];
+			build.buildInfo.scratchData.deviceAddress = scratch.address;
+			pBuildOffset.resize(build.ranges.size());
 
-	// wait till we get everything done to re-claim resources
-	this->SyncAcclBuilding();
+			for (size_t j = 0; j < build.ranges.size(); j++) {
+				pBuildOffset[j] = &build.ranges[j];
+			}
 
-	stage->tlasBuilds.emplace_back();
-	RtStaging::TlasBuild& build = stage->tlasBuilds.back();
-	build.tlasObject = tlas;
-	build.buildInfo = buildInfo;
-	stage->tlasBuilds.emplace_back(build);
+			vkCmdBuildAccelerationStructuresKHR(context.cmd, 1, &build.buildInfo, pBuildOffset.data());
+
+			// Also makes the build visible to the size query below
+			this->ScratchBarrier(context.cmd);
+
+			if (compact) {
+				vkCmdWriteAccelerationStructuresPropertiesKHR(context.cmd, 1, &build.buildInfo.dstAccelerationStructure,
+					VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, compaction.queryPool, i);
+				compaction.blases.emplace_back(build.blas);
+			}
+		}
+
+		builds.clear();
+	}
+
+	const uint64 value = this->Submit(context, true);
+	scratch.value = value;
+
+	if (compaction.queryPool != VK_NULL_HANDLE) {
+		compaction.value = value;
+		compaction.frame = renderDevice.GetRetireValue();
+		pendingCompactions.emplace_back(std::move(compaction));
+	}
 }
 
 void Renderer::AsBuilder::BuildTlasBatch()
 {
-	RtStaging* stage = &rtStaging[currentStaging];
-	bool fenceSet = stage->submitted;
-	size_t nbTlas = stage->tlasBuilds.size();
-	auto cmdBuff = renderDevice.CreateCmdBuffer(stage->cmdPool);
+	if (tlasBuilds.empty())
+		return;
 
-	if (fenceSet) {
-		vkWaitForFences(renderDevice.GetDevice(), 1, &stage->fence, VK_TRUE, UINT64_MAX);
-		vkResetFences(renderDevice.GetDevice(), 1, &stage->fence);
-		stage->submitted = false;
+	CommandContext& context = this->BeginCommands();
+	VkDeviceSize maxScratchSize = 0;
 
-		vkResetCommandPool(renderDevice.GetDevice(), stage->cmdPool, 0);
+	for (const TlasBuild& build : tlasBuilds) {
+		maxScratchSize = std::max(maxScratchSize, build.scratchSize);
 	}
 
-	std::vector<VkAccelerationStructureInstanceKHR> geometryInstances(512);
-
-	for (size_t i = 0; i < nbTlas; i++) {
-		auto& info = stage->tlasBuilds[i];
-		auto& buildInfo = info.buildInfo;
-		Tlas* tlas = info.tlasObject;
-		bool update = false;
-
-		geometryInstances.clear();
-		geometryInstances.reserve(tlas->GetInfo().blasInstances.size());
-
-		for (const BlasInstance& inst : tlas->GetInfo().blasInstances) {
-			geometryInstances.emplace_back();
-			VkAccelerationStructureInstanceKHR& acclInst = geometryInstances.back();
-			acclInst.instanceCustomIndex = inst.instanceCustomId;
-			acclInst.mask = inst.mask;
-			acclInst.instanceShaderBindingTableRecordOffset = inst.hitGroupId;
-			acclInst.flags = inst.flags;
-			acclInst.accelerationStructureReference = inst.blas->GetAcclAddress();
-			// TODO: maybe should transpose the matrix ?
-			memcpy(&acclInst.transform, &inst.transform, sizeof(VkTransformMatrixKHR));
+	ScratchBuffer& scratch = this->AcquireScratch(maxScratchSize);
+
+	// Earlier submissions on this queue may still read the instance buffers or write the BLASes we reference
+	VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+		VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(context.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+	for (TlasBuild& build : tlasBuilds) {
+		Tlas* tlas = build.tlas;
+		const std::vector<BlasInstance>& instances = tlas->GetInfo().blasInstances;
+		const VkDeviceSize size = instances.size() * sizeof(VkAccelerationStructureInstanceKHR);
+
+		// Refits read the current copy and write the new one
+		const VkAccelerationStructureKHR current = tlas->GetApiObject();
+		this->SwapTlasCopy(*tlas);
+		build.buildInfo.dstAccelerationStructure = tlas->GetApiObject();
+		build.buildInfo.srcAccelerationStructure = VK_NULL_HANDLE;
+
+		if (tlas->IsDynamic()) {
+			// Written in place, once the build that last read this copy is done (NUM_FRAMES builds ago)
+			build.region = tlas->instanceTracker.GetNextRegion();
+
+			if (tlas->regionValues[build.region] > timeline->GetCurrentCounterValue()) {
+				timeline->Wait(tlas->regionValues[build.region]);
+			}
+
+			const MemoryAllocation& memory = tlas->GetInstanceBuffer()->GetBufferMemory();
+			VkAccelerationStructureInstanceKHR* acclInstances = reinterpret_cast<VkAccelerationStructureInstanceKHR*>(
+				(uint8*)memory.mappedData + memory.offset + build.region * tlas->GetInstanceBuffer()->GetUnitSize());
+
+			const auto update = tlas->instanceTracker.BeginBuild([&](uint32 i, bool full) {
+				if (full) {
+					WriteInstance(acclInstances + i, instances[i]);
+				} else {
+					PackTransform3x4(acclInstances[i].transform.matrix[0], instances[i].transform);
+				}
+			});
+
+			build.buildInfo.mode = update.rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR :
+				VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+
+			if (!update.rebuild) {
+				build.buildInfo.srcAccelerationStructure = current;
+			}
+
+			continue;
+		}
+
+		if (!size)
+			continue;
+
+		const uint64 offset = this->AllocateStaging(size);
+		VkAccelerationStructureInstanceKHR* acclInstances = reinterpret_cast<VkAccelerationStructureInstanceKHR*>(stagingData + offset);
+
+		for (size_t i = 0; i < instances.size(); i++) {
+			WriteInstance(acclInstances + i, instances[i]);
 		}
 
-		// TODO: what if we exceed space ?
-		uint32 instSize = (uint32)geometryInstances.size() * sizeof(VkAccelerationStructureInstanceKHR);
-		uint8* stageBufferData = (uint8*)stage->data + stage->offset;
-		memcpy(stageBufferData, geometryInstances.data(), geometryInstances.size() * sizeof(VkAccelerationStructureInstanceKHR));
-		VkBufferCopy bufferCopy{ stage->offset, 0, instSize };
-		vkCmdCopyBuffer(cmdBuff, stage->stagingBuffer, tlas->GetInstanceBuffer()->GetApiObject(), 1, &bufferCopy);
-		stage->offset += instSize;
+		VkBufferCopy bufferCopy{ offset, 0, size };
+		vkCmdCopyBuffer(context.cmd, stagingBuffer, tlas->GetInstanceBuffer()->GetApiObject(), 1, &bufferCopy);
+	}
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+	vkCmdPipelineBarrier(context.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		0, 1, &barrier, 0, NULL, 0, NULL);
 
-		// Create VkAccelerationStructureGeometryInstancesDataKHR
-		// This wraps a device pointer to the above uploaded instances.
+	for (TlasBuild& build : tlasBuilds) {
 		VkAccelerationStructureGeometryInstancesDataKHR instancesVk{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR };
 		instancesVk.arrayOfPointers = VK_FALSE;
-		instancesVk.data.deviceAddress = renderDevice.GetBufferAddress(tlas->GetInstanceBuffer());
+		instancesVk.data.deviceAddress = renderDevice.GetBufferAddress(build.tlas->GetInstanceBuffer()) +
+			build.region * build.tlas->GetInstanceBuffer()->GetUnitSize();
 
-		// Put the above into a VkAccelerationStructureGeometryKHR. We need to put the
-		// instances struct in a union and label it as instance data.
 		VkAccelerationStructureGeometryKHR topASGeometry{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
 		topASGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
 		topASGeometry.geometry.instances = instancesVk;
 
+		VkAccelerationStructureBuildGeometryInfoKHR& buildInfo = build.buildInfo;
 		buildInfo.geometryCount = 1;
 		buildInfo.pGeometries = &topASGeometry;
+		buildInfo.scratchData.deviceAddress = scratch.address;
 
-		// Make sure the copy of the instance buffer are copied before triggering the
-		// acceleration structure build
-		VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
-		vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
-			0, 1, &barrier, 0, NULL, 0, NULL);
-
-		// Update build information
-		buildInfo.srcAccelerationStructure = update ? tlas->GetApiObject() : VK_NULL_HANDLE;
-		buildInfo.dstAccelerationStructure = tlas->GetApiObject();
-		buildInfo.scratchData.deviceAddress = stage->address;
-
-		// Build Offsets info: n instances
-		uint32 instanceCount = static_cast<uint32_t>(tlas->GetInfo().blasInstances.size());
-		VkAccelerationStructureBuildRangeInfoKHR        buildOffsetInfo{ instanceCount, 0, 0, 0 };
+		const uint32 instanceCount = (uint32)build.tlas->GetInfo().blasInstances.size();
+		VkAccelerationStructureBuildRangeInfoKHR buildOffsetInfo{ instanceCount, 0, 0, 0 };
 		const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = &buildOffsetInfo;
 
-		// Build the TLAS
-		vkCmdBuildAccelerationStructuresKHR(cmdBuff, 1, &buildInfo, &pBuildOffsetInfo);
+		vkCmdBuildAccelerationStructuresKHR(context.cmd, 1, &buildInfo, &pBuildOffsetInfo);
+		this->ScratchBarrier(context.cmd);
 	}
 
-    vkEndCommandBuffer(cmdBuff);
+	scratch.value = this->Submit(context, true);
 
-    auto queue = renderDevice.GetQueue(COMPUTE);
-    CALL_VK(renderDevice.SubmitCmdBuffer(queue, &cmdBuff, 1, 0, VK_NULL_HANDLE, VK_NULL_HANDLE, stage->fence));
+	for (TlasBuild& build : tlasBuilds) {
+		if (build.tlas->IsDynamic()) {
+			build.tlas->regionValues[build.region] = scratch.value;
+		}
+	}
 
-	stage->submitted = true;
+	tlasBuilds.clear();
 }
 
-void Renderer::AsBuilder::StageBlasBuilding(Blas* blas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
-	const VkAccelerationStructureBuildRangeInfoKHR* ranges, uint32 rangesCount, uint32 flags)
+void Renderer::AsBuilder::CompressBatch()
 {
-	RtStaging* stage = &rtStaging[currentStaging];
-
-	// wait till we get everything done to re-claim resources
-	this->SyncAcclBuilding();
-
-	// Is compaction requested?
-	bool doCompaction = (flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
-		== VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
-	buildInfo.scratchData.deviceAddress = stage->address;
-
-	std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildOffset(ranges, ranges + rangesCount);
-	RtStaging::Batch::BatchInfo info;
-	info.buildInfo = buildInfo;
-	info.buildInfo.flags = flags;
-	info.cmd = renderDevice.CreateCmdBuffer(stage->cmdPool);
-	info.ranges = std::move(buildOffset);
-	info.blasObject = blas;
-	stage->batch[doCompaction].batchInfo.emplace_back(std::move(info));
+	this->ScheduleCompactions(timeline->GetCurrentCounterValue(), false);
 }
 
-void Renderer::AsBuilder::BuildBlasBatch(bool compact)
+void Renderer::AsBuilder::Update()
 {
-	RtStaging* stage = &rtStaging[currentStaging];
-	RtStaging::Batch& batch = stage->batch[compact];
-	auto& pBuildOffset = stage->pBuildOffset;
-	size_t nbBlas = batch.batchInfo.size();
-	
-	// Sanity check:
-	if (batch.batchInfo.size() == 0) {
-		return;
+	const uint64 completedValue = timeline->GetCurrentCounterValue();
+
+	stagingRing.Release(completedValue);
+	swapped = this->ApplySwaps(completedValue);
+
+	// The TLASes pointing at the originals have to be rebuilt before this frame traces them
+	if (swapped) {
+		this->BuildTlasBatch();
 	}
 
-	std::vector<VkCommandBuffer> commands(nbBlas);
+	this->ScheduleCompactions(completedValue, false);
+}
 
-	if (compact) {
-		if (batch.queryPool)
-			vkDestroyQueryPool(renderDevice.GetDevice(), batch.queryPool, NULL);
+void Renderer::AsBuilder::SyncAcclBuilding()
+{
+	timeline->Wait(submittedValue);
 
-		VkQueryPoolCreateInfo qpci{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
-		qpci.queryCount = (uint32)nbBlas;
-		qpci.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
-		vkCreateQueryPool(renderDevice.GetDevice(), &qpci, NULL, &batch.queryPool);
+	// Everything is built, compact what's left right away and wait for the copies too
+	this->ScheduleCompactions(submittedValue, true);
+	timeline->Wait(submittedValue);
+
+	stagingRing.Release(submittedValue);
+
+	if (this->ApplySwaps(submittedValue)) {
+		swapped = true;
+		this->BuildTlasBatch();
 	}
+}
+
+void Renderer::AsBuilder::BuildAll()
+{
+	this->BuildBlasBatchs();
+	this->CompressBatch();
+	this->BuildTlasBatch();
+}
 
-	// TODO: check if we have enough memory for scratch space...
+Renderer::AsBuilder::CommandContext& Renderer::AsBuilder::BeginCommands()
+{
+	const uint64 completedValue = timeline->GetCurrentCounterValue();
 
-	for (size_t i = 0; i < nbBlas; i++) {
-		auto& info = batch.batchInfo[i];
+	for (CommandContext& context : commandContexts) {
+		if (context.value <= completedValue) {
+			vkResetCommandPool(renderDevice.GetDevice(), context.pool, 0);
 
-		if (pBuildOffset.size() <= info.ranges.size()) {
-			pBuildOffset.resize(info.ranges.size() * 2);
-		}
+			VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(context.cmd, &beginInfo);
 
-		for (size_t j = 0; j < info.ranges.size(); j++) {
-			pBuildOffset[j] = &info.ranges[j];
+			context.value = UINT64_MAX;
+			return context;
 		}
+	}
 
-		vkCmdBuildAccelerationStructuresKHR(info.cmd, 1, &info.buildInfo, pBuildOffset.data());
+	VkCommandPoolCreateInfo commandPoolCreateInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	commandPoolCreateInfo.queueFamilyIndex = renderDevice.GetQueueFamilyIndices().queueFamilies[COMPUTE];
 
-		// Since the scratch buffer is reused across builds, we need a barrier to ensure one build
-		// is finished before starting the next one
-		VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
-		barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
-		barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-		vkCmdPipelineBarrier(info.cmd, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
-			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, NULL, 0, NULL);
+	CommandContext context;
+	vkCreateCommandPool(renderDevice.GetDevice(), &commandPoolCreateInfo, NULL, &context.pool);
+	context.cmd = renderDevice.CreateCmdBuffer(context.pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	context.value = UINT64_MAX;
+	commandContexts.emplace_back(context);
+	return commandContexts.back();
+}
 
-		// Write compacted size to query number idx.
-		if (compact) {
-			vkCmdWriteAccelerationStructuresPropertiesKHR(info.cmd, 1, &info.buildInfo.dstAccelerationStructure,
-				VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, batch.queryPool, (uint32)i);
-		}
+uint64 Renderer::AsBuilder::Submit(CommandContext& context, bool graphicsWaits)
+{
+	vkEndCommandBuffer(context.cmd);
+
+	const uint64 value = timeline->IncrementTempValue();
+	VkSemaphore semaphore = timeline->GetApiObject();
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &value;
+
+	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &context.cmd;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &semaphore;
+
+	CALL_VK(vkQueueSubmit(renderDevice.GetQueue(COMPUTE), 1, &submitInfo, VK_NULL_HANDLE));
+
+	context.value = value;
+	submittedValue = value;
+	stagingRing.Commit(value);
+
+	if (graphicsWaits) {
+		renderDevice.AddWaitTimelineSemapore(CommandBuffer::GENERIC, timeline,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, value);
+	}
 
-		vkEndCommandBuffer(info.cmd);
-		commands[i] = info.cmd;
+	return value;
+}
+
+Renderer::AsBuilder::ScratchBuffer& Renderer::AsBuilder::AcquireScratch(VkDeviceSize size)
+{
+	const uint64 completedValue = timeline->GetCurrentCounterValue();
+	scratchSize = std::max(scratchSize, size);
+
+	for (auto it = scratchBuffers.begin(); it != scratchBuffers.end();) {
+		if (it->value > completedValue) {
+			++it;
+		} else if (it->size < scratchSize) {
+			// Outgrown, the GPU is done with it
+			it = scratchBuffers.erase(it);
+		} else {
+			it->value = UINT64_MAX;
+			return *it;
+		}
 	}
 
-    auto queue = renderDevice.GetQueue(COMPUTE);
-    CALL_VK(renderDevice.SubmitCmdBuffer(queue, commands.data(), (uint32)commands.size(), 0, VK_NULL_HANDLE, VK_NULL_HANDLE, stage->fence));
+	BufferCreateInfo info;
+	info.domain = MemoryDomain::GPU_ONLY;
+	info.size = scratchSize + SCRATCH_ALIGNMENT;
+	info.usage = BufferUsage::SHADER_DEVICE_ADDRESS | BufferUsage::STORAGE_BUFFER;
 
-	stage->submitted = true;
+	ScratchBuffer scratch;
+	scratch.buffer = renderDevice.CreateBuffer(info);
+	scratch.address = (renderDevice.GetBufferAddress(scratch.buffer) + SCRATCH_ALIGNMENT - 1) & ~(SCRATCH_ALIGNMENT - 1);
+	scratch.size = scratchSize;
+	scratch.value = UINT64_MAX;
+	scratchBuffers.emplace_back(std::move(scratch));
+	return scratchBuffers.back();
 }
 
-void Renderer::AsBuilder::CompressBatch()
+uint64 Renderer::AsBuilder::AllocateStaging(VkDeviceSize size)
 {
-	RtStaging* stage = &rtStaging[currentStaging];
-	RtStaging::Batch& batch = stage->batch[1]; // compact batch
-	auto& compactSizes = stage->compactSizes;
-	auto& cleanupAS = stage->cleanupAS;
-	auto nbBlas = batch.batchInfo.size();
-	bool fenceSet = stage->submitted;
-
-	// Sanity check:
-	if (batch.batchInfo.size() == 0) {
-		return;
+	stagingRing.Release(timeline->GetCurrentCounterValue());
+	uint64 offset = stagingRing.Allocate(size, 16);
+
+	// Only when a lot of instances were uploaded in the last few frames, wait for the oldest batch
+	while (offset == TimelineRing::INVALID_OFFSET) {
+		const uint64 oldestValue = stagingRing.GetOldestValue();
+		ASSERTF(oldestValue != 0, "Acceleration structure staging buffer is too small for %" PRIu64 " bytes", (uint64)size);
+
+		timeline->Wait(oldestValue);
+		stagingRing.Release(oldestValue);
+		offset = stagingRing.Allocate(size, 16);
 	}
 
-	if (fenceSet) {
-		vkWaitForFences(renderDevice.GetDevice(), 1, &stage->fence, VK_TRUE, UINT64_MAX);
-		vkResetFences(renderDevice.GetDevice(), 1, &stage->fence);
-		stage->submitted = false;
+	return offset;
+}
 
-		// vkResetCommandPool(renderDevice.GetDevice(), stage->cmdPool, 0);
-		stage->compressionCommand = renderDevice.CreateCmdBuffer(stage->cmdPool);
-	} else {
-		ASSERTF(true, "Fatal Error: Fence is not set!");
-		return;
+bool Renderer::AsBuilder::ApplySwaps(uint64 completedValue)
+{
+	std::unordered_set<const Blas*> swappedBlases;
+
+	while (!pendingSwaps.empty() && pendingSwaps.front().value <= completedValue) {
+		PendingSwap& swap = pendingSwaps.front();
+
+		// Frames in flight may still trace through TLASes referencing the original
+		renderDevice.QueueDeletion(RenderDevice::DeferredDeletion::ACCELERATION_STRUCTURE, (uint64)swap.blas->apiBlas);
+		swap.blas->apiBlas = swap.compacted;
+		swap.blas->buffer = swap.buffer;
+		swappedBlases.insert(swap.blas.Get());
+
+		pendingSwaps.pop_front();
 	}
 
-	if (compactSizes.size() <= nbBlas) {
-		compactSizes.resize(nbBlas * 2);
+	if (swappedBlases.empty())
+		return false;
+
+	// Instances hold the BLAS addresses, rewrite them all and rebuild (a refit can't change which BLAS an instance uses)
+	for (Tlas* tlas : tlases) {
+		const std::vector<BlasInstance>& instances = tlas->GetInfo().blasInstances;
+		const bool referenced = std::any_of(instances.begin(), instances.end(), [&swappedBlases](const BlasInstance& instance) {
+			return swappedBlases.count(instance.blas.Get()) != 0;
+		});
+
+		if (!referenced)
+			continue;
+
+		const bool staged = std::any_of(tlasBuilds.begin(), tlasBuilds.end(), [tlas](const TlasBuild& build) {
+			return build.tlas.Get() == tlas;
+		});
+
+		if (tlas->IsDynamic()) {
+			tlas->RequestRebuild();
+		}
+
+		// Static TLASes are always built from all of their instances
+		if (staged)
+			continue;
+
+		// Handles made from a pointer take over a reference
+		tlas->AddReference();
+		TlasHandle handle(tlas);
+
+		VkAccelerationStructureBuildGeometryInfoKHR buildInfo{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR };
+		buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+		buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+		this->StageTlasBuilding(handle, buildInfo, tlas->buildFlags, tlas->scratchSize);
 	}
 
-	if (cleanupAS.size() <= nbBlas) {
-		cleanupAS.resize(nbBlas * 2);
+	return true;
+}
+
+void Renderer::AsBuilder::AddTlas(Tlas* tlas)
+{
+	tlases.push_back(tlas);
+}
+
+void Renderer::AsBuilder::RemoveTlas(Tlas* tlas)
+{
+	auto it = std::find(tlases.begin(), tlases.end(), tlas);
+
+	if (it != tlases.end()) {
+		*it = tlases.back();
+		tlases.pop_back();
 	}
+}
+
+void Renderer::AsBuilder::ScheduleCompactions(uint64 completedValue, bool ignoreDelay)
+{
+	const uint64 frame = renderDevice.GetRetireValue();
+	const size_t firstSwap = pendingSwaps.size();
+	CommandContext* context = NULL;
+	std::vector<VkDeviceSize> compactSizes;
 
-	vkGetQueryPoolResults(renderDevice.GetDevice(), batch.queryPool, 0,
-		(uint32_t)nbBlas, nbBlas * sizeof(VkDeviceSize),
-		compactSizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_WAIT_BIT);
+	while (!pendingCompactions.empty()) {
+		PendingCompaction& compaction = pendingCompactions.front();
 
-	for (uint32_t idx = 0; idx < nbBlas; idx++) {
-		auto& info = batch.batchInfo[idx];
+		if (compaction.value > completedValue || (!ignoreDelay && frame < compaction.frame + COMPACTION_FRAME_DELAY))
+			break;
 
-		// Creating a compact version of the AS
-		BufferHandle buffHandle;
-		VkAccelerationStructureCreateInfoKHR asCreateInfo{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
-		asCreateInfo.size = compactSizes[idx];
-		asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-        auto as = renderDevice.CreateAcceleration(asCreateInfo, &buffHandle);
+		const uint32 count = (uint32)compaction.blases.size();
+		compactSizes.resize(count);
 
-		// Copy the original BLAS to a compact version
-		VkCopyAccelerationStructureInfoKHR copyInfo{ VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR };
-		copyInfo.src = info.blasObject->GetApiObject();
-		copyInfo.dst = as;
-		copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
-		vkCmdCopyAccelerationStructureKHR(stage->compressionCommand, &copyInfo);
+		// The builds completed so this doesn't wait, bail out if the driver disagrees
+		const VkResult result = vkGetQueryPoolResults(renderDevice.GetDevice(), compaction.queryPool, 0, count,
+			count * sizeof(VkDeviceSize), compactSizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT);
 
-		info.blasObject->apiBlas = as;
-		info.blasObject->buffer = buffHandle;
+		if (result != VK_SUCCESS)
+			break;
 
-		cleanupAS[idx] = copyInfo.src;
+		if (!context) {
+			context = &this->BeginCommands();
 
-		// vkEndCommandBuffer(stage->compressionCommand);
-	}
+			// Make the builds of the previous submissions visible to the copies
+			this->ScratchBarrier(context->cmd);
+		}
+
+		for (uint32 i = 0; i < count; i++) {
+			const BlasHandle& blas = compaction.blases[i];
 
+			BufferHandle buffer;
+			VkAccelerationStructureCreateInfoKHR asCreateInfo{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+			asCreateInfo.size = compactSizes[i];
+			asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+			VkAccelerationStructureKHR compacted = renderDevice.CreateAcceleration(asCreateInfo, &buffer);
 
-    auto queue = renderDevice.GetQueue(COMPUTE);
-    CALL_VK(renderDevice.SubmitCmdBuffer(queue, &stage->compressionCommand, 1, 0, VK_NULL_HANDLE, VK_NULL_HANDLE, stage->fence));
+			VkCopyAccelerationStructureInfoKHR copyInfo{ VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR };
+			copyInfo.src = blas->GetApiObject();
+			copyInfo.dst = compacted;
+			copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+			vkCmdCopyAccelerationStructureKHR(context->cmd, &copyInfo);
 
-	stage->submitted = true;
+			pendingSwaps.push_back({ blas, compacted, std::move(buffer), 0 });
+		}
+
+		vkDestroyQueryPool(renderDevice.GetDevice(), compaction.queryPool, NULL);
+		pendingCompactions.pop_front();
+	}
+
+	if (context) {
+		const uint64 value = this->Submit(*context, false);
+
+		for (size_t i = firstSwap; i < pendingSwaps.size(); i++) {
+			pendingSwaps[i].value = value;
+		}
+	}
 }
 
-void Renderer::AsBuilder::BuildAll()
+void Renderer::AsBuilder::SwapTlasCopy(Tlas& tlas)
 {
-	this->BuildBlasBatchs();
-    this->CompressBatch();
-	this->BuildTlasBatch();
+	// Nothing traces it before its first build
+	if (!tlas.built) {
+		tlas.built = true;
+		return;
+	}
+
+	const uint64 frame = renderDevice.GetRetireValue();
+	const uint32 framesInFlight = renderDevice.GetRenderContext()->GetNumFrames();
+	const uint64 completedFrame = frame > framesInFlight ? frame - framesInFlight : 0;
+	uint32 next = UINT32_MAX;
+
+	for (uint32 i = 1; i < tlas.copyCount; i++) {
+		const uint32 copy = (tlas.currentCopy + i) % tlas.copyCount;
+
+		if (tlas.copies[copy].frame <= completedFrame) {
+			next = copy;
+			break;
+		}
+	}
+
+	if (next == UINT32_MAX && tlas.copyCount < Tlas::MAX_COPIES) {
+		VkAccelerationStructureCreateInfoKHR acclCreateInfo{ VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR };
+		acclCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+		acclCreateInfo.size = tlas.acclSize;
+
+		next = tlas.copyCount++;
+		tlas.copies[next].accl = renderDevice.CreateAcceleration(acclCreateInfo, &tlas.copies[next].buffer);
+		tlas.copies[next].frame = 0;
+	}
+
+	if (next == UINT32_MAX) {
+		// Built more often than once a frame, the oldest copy is free once the frame that last traced it is done
+		next = (tlas.currentCopy + 1) % tlas.copyCount;
+		ASSERTF(tlas.copies[next].frame < frame, "TLAS built more than %u times in a frame, the frame may still bind its copies",
+			Tlas::MAX_COPIES - 1);
+		renderDevice.GetRenderContext()->WaitForFrame(renderDevice, tlas.copies[next].frame);
+	}
+
+	tlas.copies[tlas.currentCopy].frame = frame;
+	tlas.currentCopy = next;
+	tlas.apiTlas = tlas.copies[next].accl;
+	tlas.buffer = tlas.copies[next].buffer;
 }
 
-void Renderer::AsBuilder::Shutdown()
+void Renderer::AsBuilder::ScratchBarrier(VkCommandBuffer cmd)
 {
-    // TODO: finish this!
+	// The scratch buffer is shared by the builds of a batch, one has to finish before the next starts
+	VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, NULL, 0, NULL);
 }
 
 TRE_NS_END
@@ -1,61 +1,42 @@
 #pragma once
 
+#include <deque>
+#include <vector>
+
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
+#include <Renderer/Backend/Core/RingAllocator/TimelineRing.hpp>
+#include <Renderer/Backend/RHI/Synchronization/Semaphore/Semaphore.hpp>
+#include <Renderer/Backend/RHI/RayTracing/BLAS/BLAS.hpp>
+#include <Renderer/Backend/RHI/RayTracing/TLAS/TLAS.hpp>
 
 TRE_NS_START
 
 namespace Renderer
 {
 	class RenderDevice;
-	class Blas;
-	class Tlas;
 
+	/*
+	 * Builds acceleration structures on the compute queue without waiting on them from the host. Every submission
+	 * signals the next value of a timeline semaphore that the next graphics submission waits on, command pools,
+	 * scratch buffers and instance staging space are recycled once the timeline passed the value they were used at.
+	 *
+	 * BLASes built with ALLOW_COMPACTION are compacted COMPACTION_FRAME_DELAY frames later, once their compacted size
+	 * can be read without waiting. The original structure stays in use until the compacted copy is done, Update then
+	 * swaps it in and queues the original for deletion. The TLASes referencing a swapped BLAS are rebuilt in the same
+	 * batch, before the graphics work of that frame: only the frames already in flight still trace the original.
+	 *
+	 * Dynamic TLASes read their instances straight from a persistently mapped ring, one copy per build. Only the
+	 * instances a copy is missing are written and the TLAS is refit, with a full build every maxRefits.
+	 *
+	 * The graphics queue may still trace a TLAS from the frames in flight, so a TLAS is never built over while in use:
+	 * every build after the first writes another copy of it, one no frame in flight traces, refitting from the current
+	 * one. Then that copy becomes current.
+	 */
 	class AsBuilder
 	{
-		struct RtStaging
-		{
-			VkCommandPool cmdPool;
-			VkBuffer scratchBuffer;
-			VkDeviceAddress address;
-			VkFence fence;
-
-			VkBuffer stagingBuffer;
-			VkDeviceSize offset;
-			uint8* data;
-
-			struct Batch
-			{
-				struct BatchInfo
-				{
-					VkCommandBuffer cmd;
-					VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
-					std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
-					Blas* blasObject;
-				};
-
-				std::vector<BatchInfo> batchInfo;
-				VkQueryPool queryPool;
-				VkDeviceSize scratchSize;
-			};
-
-			// Compact Data:
-			std::vector<VkDeviceSize> compactSizes;
-			std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> pBuildOffset;
-			std::vector<VkAccelerationStructureKHR> cleanupAS;
-			VkCommandBuffer compressionCommand;
-			// 0: not compact, 1: compact
-			Batch batch[2];
-
-			// Bulding TLAS:
-			struct TlasBuild
-			{
-				VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
-				Tlas* tlasObject;
-			};
-			std::vector<TlasBuild> tlasBuilds;
-
-			bool submitted;
-		};
+	public:
+		CONSTEXPR static uint32 COMPACTION_FRAME_DELAY = NUM_FRAMES;
+		CONSTEXPR static uint32 STAGING_BUFFER_SIZE = 16 * 1024 * 1024;
 	public:
         AsBuilder(RenderDevice& device);
 
@@ -63,37 +44,134 @@ namespace Renderer
 
         void Shutdown();
 
-		// RT Functionality:
-		void StageBlasBuilding(Blas* blas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
-			const VkAccelerationStructureBuildRangeInfoKHR* ranges, uint32 rangesCount = 1,
-			uint32 flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+		void StageBlasBuilding(const BlasHandle& blas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+			const VkAccelerationStructureBuildRangeInfoKHR* ranges, uint32 rangesCount, uint32 flags, VkDeviceSize scratchSize);
+
+		void StageTlasBuilding(const TlasHandle& tlas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+			VkBuildAccelerationStructureFlagsKHR flags, VkDeviceSize scratchSize);
 
-		void StageTlasBuilding(Tlas* tlas, VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
-			VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+		// Refits (or rebuilds) a dynamic TLAS with its changed instances, nothing is staged when none changed
+		void StageTlasUpdate(const TlasHandle& tlas);
 
 		void BuildTlasBatch();
 
-		void BuildBlasBatch(bool compact);
+		// Submits the staged BLASes, the ones to compact first
+		void BuildBlasBatchs();
 
-        void CompressBatch();
+		// Schedules the compaction of the batches whose compacted sizes are available, never waits
+		void CompressBatch();
 
-		void BuildBlasBatchs();
+		// Called every frame: recycles what the GPU is done with, swaps in compacted BLASes and schedules compactions
+		void Update();
 
+		// Blocks until everything submitted is built and compacted, for loading screens and tools
 		void SyncAcclBuilding();
 
         void BuildAll();
+
+		FORCEINLINE const SemaphoreHandle& GetTimelineSemaphore() const { return timeline; }
+
+		// The timeline value the last submission signals
+		FORCEINLINE uint64 GetSubmittedValue() const { return submittedValue; }
+
+		// Whether the last Update swapped compacted BLASes in, the TLASes using them were rebuilt along
+		FORCEINLINE bool HasSwappedBlases() const { return swapped; }
+
+		// Live TLASes, the ones referencing a swapped BLAS are rebuilt
+		void AddTlas(Tlas* tlas);
+
+		void RemoveTlas(Tlas* tlas);
 	private:
-		// RT Functionality:
-		RtStaging rtStaging[NUM_FRAMES];
-		uint32 currentStaging;
-		VkDeviceMemory scartchMemory;
-		uint32 maxScratchSize;
-		VkDeviceMemory stagingMemory;
-		uint8* stagingMappedData;
+		struct BlasBuild
+		{
+			BlasHandle blas;
+			VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
+			std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
+			VkDeviceSize scratchSize;
+		};
 
-        RenderDevice& renderDevice;
+		struct TlasBuild
+		{
+			TlasHandle tlas;
+			VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
+			VkDeviceSize scratchSize;
+			uint32 region; // Copy of the instance ring a dynamic TLAS reads
+		};
+
+		// Recycled once the timeline reaches value
+		struct CommandContext
+		{
+			VkCommandPool pool;
+			VkCommandBuffer cmd;
+			uint64 value;
+		};
+
+		// All the same size, the largest scratch size seen so far, smaller ones are dropped once free
+		struct ScratchBuffer
+		{
+			BufferHandle buffer;
+			VkDeviceAddress address;
+			VkDeviceSize size;
+			uint64 value;
+		};
+
+		// BLASes built with compaction allowed, their compacted sizes are in the query pool once value is reached
+		struct PendingCompaction
+		{
+			std::vector<BlasHandle> blases;
+			VkQueryPool queryPool;
+			uint64 value;
+			uint64 frame;
+		};
+
+		// Compacted copy in flight, swapped into the BLAS once value is reached
+		struct PendingSwap
+		{
+			BlasHandle blas;
+			VkAccelerationStructureKHR compacted;
+			BufferHandle buffer;
+			uint64 value;
+		};
 
-		CONSTEXPR static uint32 MAX_UPLOAD_BUFFER_SIZE = 64 * 1024 * 1024;
+		CommandContext& BeginCommands();
+
+		// Submits the commands, graphics waits on them unless they only compact
+		uint64 Submit(CommandContext& context, bool graphicsWaits);
+
+		ScratchBuffer& AcquireScratch(VkDeviceSize size);
+
+		uint64 AllocateStaging(VkDeviceSize size);
+
+		// Also stages the rebuild of the TLASes referencing the swapped BLASes
+		bool ApplySwaps(uint64 completedValue);
+
+		void ScheduleCompactions(uint64 completedValue, bool ignoreDelay);
+
+		void ScratchBarrier(VkCommandBuffer cmd);
+
+		// Makes a copy of the TLAS no frame in flight traces current, the build about to be recorded writes it
+		void SwapTlasCopy(Tlas& tlas);
+	private:
+        RenderDevice& renderDevice;
+		SemaphoreHandle timeline;
+		uint64 submittedValue;
+		bool swapped;
+
+		std::vector<BlasBuild> blasBuilds[2]; // 0: not compact, 1: compact
+		std::vector<TlasBuild> tlasBuilds;
+		std::vector<Tlas*> tlases;
+		std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> pBuildOffset;
+
+		std::vector<CommandContext> commandContexts;
+		std::vector<ScratchBuffer> scratchBuffers;
+		VkDeviceSize scratchSize;
+		std::deque<PendingCompaction> pendingCompactions;
+		std::deque<PendingSwap> pendingSwaps;
+
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingMemory;
+		uint8* stagingData;
+		TimelineRing stagingRing;
 	};
 }
 
@@ -11,8 +11,50 @@ void Renderer::TlasDeleter::operator()(Tlas* tlas)
 
 Renderer::Tlas::Tlas(RenderDevice& device, const TlasCreateInfo& tlasInfo,
 	VkAccelerationStructureKHR tlas, BufferHandle buffer, BufferHandle instanceBuffer) :
-    device(device), tlasInfo(tlasInfo), apiTlas(tlas), buffer(buffer), instanceBuffer(instanceBuffer)
+    device(device), tlasInfo(tlasInfo), apiTlas(tlas), buffer(buffer), instanceBuffer(instanceBuffer),
+    copies{}, copyCount(1), currentCopy(0), acclSize(0), built(false), regionValues{}, buildFlags(0), scratchSize(0)
 {
+    copies[0].accl = tlas;
+    copies[0].buffer = buffer;
+
+    if (tlasInfo.dynamic) {
+        instanceTracker.Init((uint32)tlasInfo.blasInstances.size(), tlasInfo.maxRefits);
+    }
+}
+
+Renderer::Tlas::~Tlas()
+{
+    device.acclBuilder.RemoveTlas(this);
+
+    // Frames in flight may still trace any of them, their buffers are released the same way
+    for (uint32 i = 0; i < copyCount; i++) {
+        device.DestroyAccelerationStructure(copies[i].accl);
+    }
+}
+
+void Renderer::Tlas::SetTransform(uint32 instance, const float (&transform)[4][4])
+{
+    ASSERTF(tlasInfo.dynamic, "Only dynamic TLASes can be updated");
+
+    memcpy(tlasInfo.blasInstances[instance].transform, transform, sizeof(transform));
+    instanceTracker.MarkDirty(instance);
+}
+
+void Renderer::Tlas::SetTransformColumnMajor(uint32 instance, const float* matrix)
+{
+    ASSERTF(tlasInfo.dynamic, "Only dynamic TLASes can be updated");
+
+    // Only the top 3 rows are used
+    PackTransform3x4ColumnMajor(tlasInfo.blasInstances[instance].transform[0], matrix);
+    instanceTracker.MarkDirty(instance);
+}
+
+void Renderer::Tlas::SetInstance(uint32 instance, const BlasInstance& blasInstance)
+{
+    ASSERTF(tlasInfo.dynamic, "Only dynamic TLASes can be updated");
+
+    tlasInfo.blasInstances[instance] = blasInstance;
+    instanceTracker.RequestRebuild();
 }
 
 
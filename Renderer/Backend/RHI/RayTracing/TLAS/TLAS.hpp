@@ -4,6 +4,7 @@
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
 #include <Renderer/Backend/RHI/RayTracing/BLAS/BLAS.hpp>
+#include <Renderer/Backend/RHI/RayTracing/TLAS/TlasInstanceTracker.hpp>
 
 TRE_NS_START
 
@@ -18,12 +19,16 @@ namespace Renderer
 		uint32 instanceCustomId = 0;
 		uint32 mask = 0xFF;
 		VkGeometryInstanceFlagsKHR flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-		float transform[4][4];
+		float transform[4][4]; // Row major, the last row is ignored
 	};
 
 	struct TlasCreateInfo
 	{
 		std::vector<BlasInstance> blasInstances;
+
+		// Dynamic TLASes keep their instances in a persistently mapped ring and are refit when transforms change
+		bool dynamic = false;
+		uint32 maxRefits = 32; // Refits before a full rebuild
 	};
 
 	struct TlasDeleter
@@ -36,26 +41,63 @@ namespace Renderer
 	public:
 		friend struct TlasDeleter;
 
+		// Enough for a build every frame to always find a copy none of the frames in flight traces
+		CONSTEXPR static uint32 MAX_COPIES = MAX_FRAMES + 1;
+
         Tlas(RenderDevice& device, const TlasCreateInfo& tlasInfo, VkAccelerationStructureKHR tlas,
 			BufferHandle buffer, BufferHandle instancesBuffer);
 
+		~Tlas();
+
 		FORCEINLINE const TlasCreateInfo& GetInfo() const { return tlasInfo; }
 
-		// FORCEINLINE VkAccelerationStructureKHR GetApiObject() const { return apiTlas; }
+		// The copy the last build wrote, later builds write another one (see AsBuilder), bind it again after a build
 		FORCEINLINE const VkAccelerationStructureKHR& GetApiObject() const { return apiTlas; }
 
 		FORCEINLINE BufferHandle GetBuffer() const { return buffer; }
 		FORCEINLINE BufferHandle GetInstanceBuffer() const { return instanceBuffer; }
+
+		FORCEINLINE bool IsDynamic() const { return tlasInfo.dynamic; }
+
+		// Dynamic TLAS only, picked up by the next RenderDevice::RtUpdateTlas
+		void SetTransform(uint32 instance, const float (&transform)[4][4]);
+
+		void SetTransformColumnMajor(uint32 instance, const float* matrix);
+
+		// Dynamic TLAS only, for changes other than transforms: the next update rebuilds with all instances rewritten
+		void SetInstance(uint32 instance, const BlasInstance& blasInstance);
+
+		FORCEINLINE void RequestRebuild() { instanceTracker.RequestRebuild(); }
+	private:
+		struct Copy
+		{
+			VkAccelerationStructureKHR accl;
+			BufferHandle buffer;
+			uint64 frame; // Last frame (retire value) that may trace it, set once another copy replaces it
+		};
 	private:
         RenderDevice& device;
 		TlasCreateInfo tlasInfo;
 		VkAccelerationStructureKHR apiTlas;
 		BufferHandle buffer;
 		BufferHandle instanceBuffer;
-		
+
+		// Created as needed by the builds, all the same size
+		Copy copies[MAX_COPIES];
+		uint32 copyCount;
+		uint32 currentCopy;
+		VkDeviceSize acclSize;
+		bool built;
+
+		// Dynamic TLAS:
+		TlasInstanceTracker<NUM_FRAMES> instanceTracker;
+		uint64 regionValues[NUM_FRAMES]; // Timeline value of the last build reading each copy of the instance ring
+		VkBuildAccelerationStructureFlagsKHR buildFlags;
+		VkDeviceSize scratchSize;
 
         friend class RenderDevice;
 		friend class StagingManager;
+		friend class AsBuilder;
 	};
 
 	using TlasHandle = Handle<Tlas>;
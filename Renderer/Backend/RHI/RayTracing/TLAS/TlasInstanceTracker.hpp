@@ -0,0 +1,168 @@
+#pragma once
+
+#include <string.h>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE
+	#include <xmmintrin.h>
+#endif
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// Writes the top 3 rows of a row major 4x4 transform, the 3x4 layout of VkTransformMatrixKHR
+	FORCEINLINE void PackTransform3x4(float* dst, const float (&transform)[4][4])
+	{
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE
+		_mm_storeu_ps(dst + 0, _mm_loadu_ps(transform[0]));
+		_mm_storeu_ps(dst + 4, _mm_loadu_ps(transform[1]));
+		_mm_storeu_ps(dst + 8, _mm_loadu_ps(transform[2]));
+#else
+		memcpy(dst, transform, 12 * sizeof(float));
+#endif
+	}
+
+	// Same from a column major matrix (glm), transposed on the way
+	FORCEINLINE void PackTransform3x4ColumnMajor(float* dst, const float* matrix)
+	{
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE
+		__m128 c0 = _mm_loadu_ps(matrix + 0);
+		__m128 c1 = _mm_loadu_ps(matrix + 4);
+		__m128 c2 = _mm_loadu_ps(matrix + 8);
+		__m128 c3 = _mm_loadu_ps(matrix + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(dst + 0, c0);
+		_mm_storeu_ps(dst + 4, c1);
+		_mm_storeu_ps(dst + 8, c2);
+#else
+		for (uint32 row = 0; row < 3; row++) {
+			for (uint32 col = 0; col < 4; col++) {
+				dst[row * 4 + col] = matrix[col * 4 + row];
+			}
+		}
+#endif
+	}
+
+	/*
+	 * Bookkeeping of a dynamic TLAS whose instances live in a persistently mapped ring of RING_SIZE copies, each build
+	 * reading the next one. Tracks the instances every copy is missing so only those are written, and decides between
+	 * a refit and a full build: refits degrade the BVH as instances move away from where it was built, so every
+	 * maxRefits refits the TLAS is rebuilt. Vulkan free, the caller does the writing.
+	 */
+	template<uint32 RING_SIZE>
+	class TlasInstanceTracker
+	{
+	public:
+		static_assert(RING_SIZE > 0 && RING_SIZE <= 32, "One bit per copy of the ring");
+
+		CONSTEXPR static uint32 ALL_REGIONS = RING_SIZE == 32 ? ~0u : (1u << RING_SIZE) - 1;
+
+		struct Build
+		{
+			uint32 region;  // Copy of the ring the build reads
+			uint32 written; // Instances written into it
+			bool   rebuild; // Full build, a refit otherwise
+		};
+	public:
+		void Init(uint32 instanceCount, uint32 maxRefits)
+		{
+			this->instanceCount = instanceCount;
+			this->maxRefits = maxRefits;
+			markedAt.assign(instanceCount, 0);
+			writtenAt.assign(instanceCount, 0);
+
+			for (std::vector<uint32>& list : dirty) {
+				list.clear();
+			}
+
+			buildCount = 0;
+			refits = 0;
+			this->RequestRebuild();
+		}
+
+		void MarkDirty(uint32 instance)
+		{
+			ASSERTF(instance < instanceCount, "Instance %u out of range (%u instances)", instance, instanceCount);
+
+			if (markedAt[instance] != buildCount + 1) {
+				markedAt[instance] = buildCount + 1;
+				dirty[buildCount % RING_SIZE].push_back(instance);
+			}
+		}
+
+		// The next build is a full one and every copy gets all its instances written again on its next build, for
+		// changes beyond transforms (swapped BLASes, masks...)
+		void RequestRebuild()
+		{
+			rebuildRequested = true;
+			staleRegions = ALL_REGIONS;
+		}
+
+		// Calls writeInstance(index, full) for every instance the next build's copy is missing, full when the whole
+		// instance has to be written and not only its transform
+		template<typename WriteFunc>
+		Build BeginBuild(WriteFunc&& writeInstance)
+		{
+			Build build;
+			build.region = uint32(buildCount % RING_SIZE);
+			build.written = 0;
+			build.rebuild = rebuildRequested || refits >= maxRefits;
+
+			if (staleRegions & (1u << build.region)) {
+				staleRegions &= ~(1u << build.region);
+
+				for (uint32 i = 0; i < instanceCount; i++) {
+					writeInstance(i, true);
+				}
+
+				build.written = instanceCount;
+			} else {
+				// This copy was last written RING_SIZE builds ago, it misses what was marked since, in any list
+				const uint64 stamp = buildCount + 1;
+
+				for (const std::vector<uint32>& list : dirty) {
+					for (uint32 instance : list) {
+						if (writtenAt[instance] != stamp) {
+							writtenAt[instance] = stamp;
+							writeInstance(instance, false);
+							build.written++;
+						}
+					}
+				}
+			}
+
+			// Every copy now has the oldest list, it becomes the list of the next build
+			buildCount++;
+			dirty[buildCount % RING_SIZE].clear();
+			refits = build.rebuild ? 0 : refits + 1;
+			rebuildRequested = false;
+			return build;
+		}
+
+		// Whether anything was marked or requested since the last build
+		FORCEINLINE bool HasChanges() const { return rebuildRequested || !dirty[buildCount % RING_SIZE].empty(); }
+
+		// Copy of the ring the next build reads
+		FORCEINLINE uint32 GetNextRegion() const { return uint32(buildCount % RING_SIZE); }
+
+		FORCEINLINE uint32 GetInstanceCount() const { return instanceCount; }
+
+		FORCEINLINE uint32 GetRefitCount() const { return refits; }
+	private:
+		std::vector<uint32> dirty[RING_SIZE]; // Marked before build b, in list b % RING_SIZE
+		std::vector<uint64> markedAt;
+		std::vector<uint64> writtenAt;
+		uint64 buildCount = 0;
+		uint32 instanceCount = 0;
+		uint32 maxRefits = 0;
+		uint32 refits = 0;
+		uint32 staleRegions = ALL_REGIONS;
+		bool rebuildRequested = true;
+	};
+}
+
+TRE_NS_END
@@ -11,6 +11,20 @@ Renderer::RenderBackend::RenderBackend(TRE::Window* wnd) :
     window(wnd),
     renderContext(*this),
     renderDevice(&renderContext),
+    headlessExtent{ 0, 0 },
+    headlessFormat(VK_FORMAT_UNDEFINED),
+    msaaSamplerCount(1)
+{
+    renderDevice.internal.renderContext = &renderContext.internal;
+    renderContext.internal.renderDevice = &renderDevice.internal;
+}
+
+Renderer::RenderBackend::RenderBackend(uint32 width, uint32 height, VkFormat format) :
+    window(NULL),
+    renderContext(*this),
+    renderDevice(&renderContext),
+    headlessExtent{ width, height },
+    headlessFormat(format),
     msaaSamplerCount(1)
 {
     renderDevice.internal.renderContext = &renderContext.internal;
@@ -28,13 +42,41 @@ void Renderer::RenderBackend::InitInstance(uint32 usage)
         }
     }
 
-    renderInstance.CreateRenderInstance();
+    // Optional, without it the memory allocator estimates the heap budgets
+    deviceExt.PushBack(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+#if defined(VK_KHR_present_wait)
+    // Optional as well, frame latency is then measured up to the GPU finishing frames rather than to their present
+    if (window && renderContext.GetFramePacing().presentWait) {
+        deviceExt.PushBack(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        deviceExt.PushBack(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+#endif
+
+#if defined(VK_EXT_graphics_pipeline_library)
+    // Optional, without it graphics pipelines are compiled whole the first time they are bound
+    deviceExt.PushBack(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    deviceExt.PushBack(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+#endif
+
+    if (window) {
+        renderInstance.CreateRenderInstance();
+
+        renderContext.CreateRenderContext(window, renderInstance.internal);
+        renderDevice.CreateRenderDevice(renderInstance, deviceExt.begin(), deviceExt.Size());
+        renderContext.InitRenderContext(renderInstance.internal, renderDevice.internal);
 
-    renderContext.CreateRenderContext(window, renderInstance.internal);
-    renderDevice.CreateRenderDevice(renderInstance, deviceExt.begin(), deviceExt.Size());
-    renderContext.InitRenderContext(renderInstance.internal, renderDevice.internal);
+        renderDevice.Init(usage);
+    } else {
+        renderInstance.CreateRenderInstance(NULL, 0, NULL, 0, true);
 
-    renderDevice.Init(usage);
+        renderContext.CreateHeadlessRenderContext(headlessExtent.width, headlessExtent.height, headlessFormat);
+        renderDevice.CreateRenderDevice(renderInstance, deviceExt.begin(), deviceExt.Size());
+        // Offscreen targets are regular images so the allocators and staging have to be up first
+        renderDevice.Init(usage);
+
+        renderContext.InitRenderContext(renderInstance.internal, renderDevice.internal);
+    }
 
     const auto vendor = [](uint32 id) -> std::string
     {
@@ -77,11 +119,20 @@ Renderer::RenderBackend::~RenderBackend()
 {
     vkDeviceWaitIdle(renderDevice.internal.device);
 
+    if (renderContext.IsHeadless()) {
+        renderContext.FlushReadbacks(renderDevice);
+    }
+
     renderContext.DestroyRenderContext(renderInstance.internal, renderDevice.internal, renderContext.internal);
     renderDevice.Shutdown();
     renderInstance.DestroyRenderInstance();
 }
 
+void Renderer::RenderBackend::WaitForNextFrame()
+{
+    renderContext.WaitForNextFrame(renderDevice);
+}
+
 void Renderer::RenderBackend::BeginFrame()
 {
     renderContext.BeginFrame(renderDevice);
@@ -90,6 +141,10 @@ void Renderer::RenderBackend::BeginFrame()
 
 void Renderer::RenderBackend::EndFrame()
 {
+    if (renderContext.IsHeadless()) {
+        renderContext.RecordReadback(renderDevice);
+    }
+
     renderDevice.EndFrame();
     renderContext.EndFrame(renderDevice);
 }
@@ -15,6 +15,9 @@ namespace Renderer
 	public:
 		RenderBackend(TRE::Window* wnd);
 
+		// Headless backend: frames are rendered offscreen and read back through RenderContext::SetReadbackCallback
+		RenderBackend(uint32 width, uint32 height, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
 		~RenderBackend();
 
 		void Shutdown();
@@ -22,6 +25,9 @@ namespace Renderer
 		void InitInstance(uint32 usage = 0);
 
         // Frame managment:
+		// Optional, right before sampling input: waits and sleeps as frame pacing asks, BeginFrame does it otherwise
+		void WaitForNextFrame();
+
 		void BeginFrame();
 
 		void EndFrame();
@@ -29,6 +35,11 @@ namespace Renderer
 		// ..
 		void SetSamplerCount(uint32 msaaSamplerCount = 1);
 
+		// Present waits need their extensions, only enabled for windows when asked for before InitInstance
+		FORCEINLINE void SetFramePacing(const FramePacingSettings& settings) { renderContext.SetFramePacing(settings); }
+
+		FORCEINLINE FrameLatencyStats GetLatencyStats() const { return renderContext.GetLatencyStats(); }
+
         // Getters:
         FORCEINLINE RenderInstance& GetRenderInstance() { return renderInstance; }
         FORCEINLINE RenderContext& GetRenderContext() { return renderContext; }
@@ -44,6 +55,8 @@ namespace Renderer
 		RenderDevice	renderDevice;
 		RenderContext	renderContext;
 		TRE::Window*	window;
+		VkExtent2D		headlessExtent;
+		VkFormat		headlessFormat;
 
 		uint32 msaaSamplerCount;
 		uint32 enabledFeatures;
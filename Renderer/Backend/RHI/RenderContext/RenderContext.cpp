@@ -9,11 +9,16 @@
 
 TRE_NS_START
 
-Renderer::RenderContext::RenderContext(RenderBackend& backend) : internal{ 0 }, renderDevice(&backend.GetRenderDevice()), swapchain(backend)
+Renderer::RenderContext::RenderContext(RenderBackend& backend) : internal{ 0 }, renderDevice(&backend.GetRenderDevice()), swapchain(backend),
+    readbacks{}, readbackCallback(NULL), readbackUserData(NULL), frameCount(0), frameValues{},
+    presentedSwapchain(VK_NULL_HANDLE), presentedId(0), frameStarted(false), presentModeChanged(false)
 {
     internal.numFramesInFlight = NUM_FRAMES;
     internal.currentFrame = 0;
     internal.previousFrame = (internal.currentFrame + (NUM_FRAMES - 1)) % NUM_FRAMES;
+
+    pacingSettings.framesInFlight = NUM_FRAMES;
+    framePacer.SetSettings(pacingSettings);
 }
 
 void Renderer::RenderContext::CreateRenderContext(TRE::Window* wnd, const Internal::RenderInstance& instance)
@@ -24,9 +29,21 @@ void Renderer::RenderContext::CreateRenderContext(TRE::Window* wnd, const Intern
     CreateWindowSurface(instance, internal);
 }
 
+void Renderer::RenderContext::CreateHeadlessRenderContext(uint32 width, uint32 height, VkFormat format)
+{
+    internal.window = NULL;
+    internal.surface = VK_NULL_HANDLE;
+    swapchain.swapchainData.swapChainExtent = VkExtent2D{ width, height };
+    swapchain.swapchainData.swapChainImageFormat = format;
+}
+
 void Renderer::RenderContext::InitRenderContext(const Internal::RenderInstance& renderInstance, const Internal::RenderDevice& renderDevice)
 {
-    swapchain.CreateSwapchain();
+    if (this->IsHeadless()) {
+        swapchain.CreateHeadlessSwapchain();
+    } else {
+        swapchain.CreateSwapchain();
+    }
 }
 
 void Renderer::RenderContext::DestroyRenderContext(const Internal::RenderInstance& renderInstance,
@@ -34,17 +51,178 @@ void Renderer::RenderContext::DestroyRenderContext(const Internal::RenderInstanc
                                                    Internal::RenderContext& renderContext)
 {
     swapchain.DestroySwapchain();
-    Internal::DestroryWindowSurface(renderInstance.instance, renderContext.surface);
+
+    if (renderContext.surface != VK_NULL_HANDLE) {
+        Internal::DestroryWindowSurface(renderInstance.instance, renderContext.surface);
+    }
+}
+
+void Renderer::RenderContext::RecordReadback(RenderDevice& renderDevice)
+{
+    ASSERTF(this->IsHeadless(), "Readbacks are only available for headless contexts!");
+
+    const uint32 currentFrame = internal.currentFrame;
+    const Image& image = *swapchain.GetSwapchainImage(currentFrame);
+    const Buffer& buffer = *swapchain.GetReadbackBuffer(currentFrame);
+
+    CommandBufferHandle cmd = renderDevice.RequestCommandBuffer(CommandBuffer::Type::GENERIC);
+    // Render passes already left the image in TRANSFER_SRC, only make the attachment writes visible to the copy
+    cmd->ImageBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    cmd->CopyImageToBuffer(image, buffer);
+    cmd->BufferBarrier(buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+    // Ends up in the last submission of the frame, the frame fence tells when the copy is done
+    renderDevice.Submit(cmd);
+
+    readbacks[currentFrame].frameIndex = frameCount;
+    readbacks[currentFrame].pending = true;
+}
+
+void Renderer::RenderContext::FlushReadbacks(const RenderDevice& renderDevice)
+{
+    const Swapchain::SwapchainData& swapchainData = swapchain.swapchainData;
+
+    // The current frame slot holds the oldest frame in flight once EndFrame moved on
+    for (uint32 i = 0; i < internal.numFramesInFlight; i++) {
+        const uint32 frame = (internal.currentFrame + i) % internal.numFramesInFlight;
+
+        if (readbacks[frame].pending) {
+            vkWaitForFences(renderDevice.GetDevice(), 1, &swapchainData.fences[frame], VK_TRUE, UINT64_MAX);
+            this->DeliverReadback(renderDevice, frame);
+        }
+    }
+}
+
+void Renderer::RenderContext::DeliverReadback(const RenderDevice& renderDevice, uint32 frame)
+{
+    if (!readbacks[frame].pending)
+        return;
+
+    readbacks[frame].pending = false;
+
+    if (!readbackCallback)
+        return;
+
+    const Buffer& buffer = *swapchain.GetReadbackBuffer(frame);
+    const MemoryAllocation& memory = buffer.GetBufferMemory();
+
+    // Readback buffers live in cached memory which isn't necessarily coherent
+    const VkDeviceSize atomSize = renderDevice.GetProperties().limits.nonCoherentAtomSize;
+    VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+    range.memory = memory.memory;
+    range.offset = memory.offset & ~(atomSize - 1);
+    range.size = VK_WHOLE_SIZE;
+    vkInvalidateMappedMemoryRanges(renderDevice.GetDevice(), 1, &range);
+
+    const VkExtent2D& extent = swapchain.GetExtent();
+    FrameReadback readback;
+    readback.data = (const uint8*)memory.mappedData + memory.offset;
+    readback.frameIndex = readbacks[frame].frameIndex;
+    readback.width = extent.width;
+    readback.height = extent.height;
+    readback.rowPitch = extent.width * FormatToChannelCount(swapchain.GetFormat());
+    readback.format = swapchain.GetFormat();
+    readbackCallback(readback, readbackUserData);
+}
+
+void Renderer::RenderContext::SetFramePacing(const FramePacingSettings& settings)
+{
+    FramePacingSettings applied = settings;
+    applied.framesInFlight = TRE::Math::Max<uint32>(1, TRE::Math::Min<uint32>(settings.framesInFlight, MAX_FRAMES));
+
+    if (renderDevice->GetDevice() == VK_NULL_HANDLE) {
+        // Nothing created yet, the frame slots are used from the start
+        internal.numFramesInFlight = applied.framesInFlight;
+        internal.currentFrame = 0;
+        internal.previousFrame = applied.framesInFlight - 1;
+    } else if (this->IsHeadless() && applied.framesInFlight != internal.numFramesInFlight) {
+        // There is an offscreen image and a readback buffer per frame in flight
+        TRE_LOGW("Headless contexts can't change their frames in flight once created");
+        applied.framesInFlight = internal.numFramesInFlight;
+    }
+
+    presentModeChanged |= swapchain.GetApiObject() != VK_NULL_HANDLE && applied.presentMode != pacingSettings.presentMode;
+    pacingSettings = applied;
+    framePacer.SetSettings(applied);
+}
+
+void Renderer::RenderContext::ApplyFramesInFlight(const RenderDevice& renderDevice)
+{
+    if (pacingSettings.framesInFlight == internal.numFramesInFlight)
+        return;
+
+    // Frame slots are handed out again from the first one, none can still be in use
+    vkWaitForFences(renderDevice.GetDevice(), internal.numFramesInFlight, swapchain.swapchainData.fences, VK_TRUE, UINT64_MAX);
+
+    internal.numFramesInFlight = pacingSettings.framesInFlight;
+    internal.currentFrame = 0;
+    internal.previousFrame = internal.numFramesInFlight - 1;
+}
+
+bool Renderer::RenderContext::UsesPresentWait(const RenderDevice& renderDevice) const
+{
+    return pacingSettings.presentWait && !this->IsHeadless() && renderDevice.IsPresentWaitSupported();
+}
+
+void Renderer::RenderContext::WaitForNextFrame(const RenderDevice& renderDevice)
+{
+    if (frameStarted)
+        return;
+
+#if defined(VK_KHR_present_wait)
+    // The previous frame is on screen before the next one starts, which keeps a single frame queued for presentation.
+    // A swapchain retired since then can't be waited on, the new one has nothing presented yet
+    if (this->UsesPresentWait(renderDevice) && presentedSwapchain != VK_NULL_HANDLE && presentedSwapchain == swapchain.swapchain &&
+        presentedId == frameCount) {
+        const VkResult result = vkWaitForPresentKHR(renderDevice.GetDevice(), presentedSwapchain, presentedId, PRESENT_WAIT_TIMEOUT);
+
+        if (result == VK_SUCCESS) {
+            framePacer.OnFrameDone(presentedId - 1, FramePacer::Now(), true);
+        }
+    }
+#endif
+
+    framePacer.SetVsync(!this->IsHeadless() && swapchain.IsVsync());
+    FramePacer::SleepUntil(framePacer.GetWakeTime(FramePacer::Now()));
+    framePacer.BeginFrame(frameCount, FramePacer::Now());
+    frameStarted = true;
 }
 
 void Renderer::RenderContext::BeginFrame(const RenderDevice& renderDevice)
 {
+    this->ApplyFramesInFlight(renderDevice);
+    this->WaitForNextFrame(renderDevice);
+
     Swapchain::SwapchainData& swapchainData = swapchain.swapchainData;
     VkDevice device = renderDevice.GetDevice();
     uint32 currentFrame = internal.currentFrame;
 
     vkWaitForFences(device, 1, &swapchainData.fences[currentFrame], VK_TRUE, UINT64_MAX);
 
+    // Without present waits that's all there is to know when frames are done: the last one to use this slot is
+    if (frameCount >= internal.numFramesInFlight) {
+        framePacer.OnFrameDone(frameCount - internal.numFramesInFlight, FramePacer::Now(), false);
+    }
+
+    if (this->IsHeadless()) {
+        // The fence covered the readback copy recorded NUM_FRAMES ago, nothing to acquire
+        this->DeliverReadback(renderDevice, currentFrame);
+        vkResetFences(device, 1, &swapchainData.fences[currentFrame]);
+        internal.currentImage = currentFrame;
+        return;
+    }
+
+    swapchain.DestroyRetiredSwapchains(frameCount);
+
+    // Still minimized, the swapchain is recreated once the window has a size again
+    if (swapchain.framebufferResized) {
+        vkResetFences(device, 1, &swapchainData.fences[currentFrame]);
+        return;
+    }
+
     VkResult result = vkAcquireNextImageKHR(device, swapchain.GetApiObject(), UINT64_MAX, 
         swapchainData.imageAcquiredSemaphores[currentFrame], VK_NULL_HANDLE, &internal.currentImage);
 
@@ -64,6 +242,18 @@ void Renderer::RenderContext::BeginFrame(const RenderDevice& renderDevice)
     }
 }
 
+void Renderer::RenderContext::WaitForFrame(const RenderDevice& renderDevice, uint64 retireValue) const
+{
+    // The current slot's fence is reset until its frame is submitted, the frame it held before was waited on by BeginFrame.
+    // A frame whose slot was reused since is done as well
+    for (uint32 i = 0; i < internal.numFramesInFlight; i++) {
+        if (i != internal.currentFrame && frameValues[i] == retireValue) {
+            vkWaitForFences(renderDevice.GetDevice(), 1, &swapchain.swapchainData.fences[i], VK_TRUE, UINT64_MAX);
+            return;
+        }
+    }
+}
+
 void Renderer::RenderContext::EndFrame(const RenderDevice& renderDevice)
 {
     const Swapchain::SwapchainData& swapchainData = swapchain.swapchainData;
@@ -72,6 +262,19 @@ void Renderer::RenderContext::EndFrame(const RenderDevice& renderDevice)
     const uint32 currentFrame = internal.currentFrame;
     const uint32_t currentBuffer = internal.currentImage;
 
+    framePacer.EndFrame(frameCount, FramePacer::Now());
+    frameStarted = false;
+
+    frameValues[currentFrame] = frameCount + 1;
+
+    if (this->IsHeadless()) {
+        // Nothing to present, the copy is picked up when this frame slot comes around again
+        frameCount++;
+        internal.previousFrame = internal.currentFrame;
+        internal.currentFrame = (currentFrame + 1) % internal.numFramesInFlight;
+        return;
+    }
+
     /*VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     
@@ -129,16 +332,44 @@ void Renderer::RenderContext::EndFrame(const RenderDevice& renderDevice)
         presentInfo.pSwapchains     = &swapchain.swapchain;
         presentInfo.pImageIndices   = &currentBuffer;
 
+#if defined(VK_KHR_present_wait)
+        // Ids have to be non zero and increasing, the frame index + 1 is
+        const uint64 presentId = frameCount + 1;
+        VkPresentIdKHR presentIdInfo{};
+        presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentIdInfo.swapchainCount = 1;
+        presentIdInfo.pPresentIds = &presentId;
+
+        if (this->UsesPresentWait(renderDevice)) {
+            presentInfo.pNext = &presentIdInfo;
+        }
+#endif
+
         result = vkQueuePresentKHR(queues[Internal::QFT_PRESENT], &presentInfo);
+
+#if defined(VK_KHR_present_wait)
+        if (presentInfo.pNext && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)) {
+            presentedSwapchain = swapchain.swapchain;
+            presentedId = presentId;
+        }
+#endif
     }
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || swapchain.framebufferResized) {
+    // Resizes are caught here without waiting for the driver to report the swapchain out of date
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || swapchain.framebufferResized || swapchain.IsOutdated() ||
+        presentModeChanged) {
+        presentModeChanged = false;
         swapchain.RecreateSwapchain();
+
+        // The last present went to the retired swapchain
+        presentedSwapchain = VK_NULL_HANDLE;
+        presentedId = 0;
         // printf("[END FRAME] Swapchain resized! %d\n", result);
     } else if (result != VK_SUCCESS) {
         ASSERTF(true, "Failed to present swap chain image!");
     }
 
+    frameCount++;
     internal.previousFrame = internal.currentFrame;
     internal.currentFrame = (currentFrame + 1) % internal.numFramesInFlight;
 
@@ -4,6 +4,7 @@
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/RHI/StagingManager/StagingManager.hpp>
 #include <Renderer/Backend/RHI/Swapchain/Swapchain.hpp>
+#include <Renderer/Backend/RHI/FramePacing/FramePacer.hpp>
 
 TRE_NS_START
 
@@ -13,13 +14,32 @@ namespace Renderer
 	class RenderBackend;
 	class RenderDevice;
 
+	// A headless frame copied back to host memory, the data is only valid during the readback callback.
+	struct FrameReadback
+	{
+		const uint8*	data;
+		uint64			frameIndex;
+		uint32			width;
+		uint32			height;
+		uint32			rowPitch;
+		VkFormat		format;
+	};
+
+	typedef void(*FPN_ReadbackCallback)(const FrameReadback& readback, void* userData);
+
 	class RENDERER_API RenderContext
 	{
 	public:
+		// A present that doesn't come (hidden window...) holds the next frame that long at most, in nanoseconds
+		CONSTEXPR static uint64 PRESENT_WAIT_TIMEOUT = 100000000;
+
 		RenderContext(RenderBackend& backend);
 
 		void CreateRenderContext(TRE::Window* wnd, const Internal::RenderInstance& instance);
 
+		// Renders into a ring of offscreen images instead of a swapchain, no window or surface needed.
+		void CreateHeadlessRenderContext(uint32 width, uint32 height, VkFormat format);
+
 		void InitRenderContext(const Internal::RenderInstance& renderInstance, const Internal::RenderDevice& renderDevice);
 
 		void DestroyRenderContext(const Internal::RenderInstance& renderInstance, const Internal::RenderDevice& renderDevice, Internal::RenderContext& renderContext);
@@ -52,14 +72,68 @@ namespace Renderer
 
 		FORCEINLINE const VkExtent2D& GetSwapchainExtent() const { return swapchain.swapchainData.swapChainExtent; }
 
+		FORCEINLINE bool IsHeadless() const { return internal.window == NULL; }
+
+		FORCEINLINE uint64 GetFrameCount() const { return frameCount; }
+
+		// Called once a headless frame's copy landed in host memory, frames are delivered in order.
+		FORCEINLINE void SetReadbackCallback(FPN_ReadbackCallback callback, void* userData = NULL) { readbackCallback = callback; readbackUserData = userData; }
+
+		// Copies the current offscreen image into its readback buffer, must be recorded before the device ends the frame.
+		void RecordReadback(RenderDevice& renderDevice);
+
+		// Blocks until every frame in flight is read back (before shutdown or when the last frame is needed now).
+		void FlushReadbacks(const RenderDevice& renderDevice);
+
+		// Applied between frames, a new present mode recreates the swapchain. Headless contexts keep their frames in flight once created.
+		void SetFramePacing(const FramePacingSettings& settings);
+
+		FORCEINLINE const FramePacingSettings& GetFramePacing() const { return pacingSettings; }
+
+		// From the start of each frame to its present, or to the GPU being seen done with it without present waits.
+		FORCEINLINE FrameLatencyStats GetLatencyStats() const { return framePacer.GetLatencyStats(); }
+
+		// Waits for the previous present and sleeps until the next frame should start, BeginFrame calls it if the frame didn't.
+		// Called before sampling input, the frame's latency is measured from there.
+		void WaitForNextFrame(const RenderDevice& renderDevice);
+
         void BeginFrame(const RenderDevice& renderDevice);
 
 		void EndFrame(const RenderDevice& renderDevice);
+
+		// Blocks until the GPU is done with the frame of the given retire value (RenderDevice::GetRetireValue), only that
+		// frame's fence is waited on. Returns right away for the current frame's value, it isn't submitted yet.
+		void WaitForFrame(const RenderDevice& renderDevice, uint64 retireValue) const;
 	private:
+		void DeliverReadback(const RenderDevice& renderDevice, uint32 frame);
+
+		void ApplyFramesInFlight(const RenderDevice& renderDevice);
+
+		bool UsesPresentWait(const RenderDevice& renderDevice) const;
+	private:
+		struct PendingReadback
+		{
+			uint64	frameIndex;
+			bool	pending;
+		};
+
 		Internal::RenderContext	internal;
 		Swapchain swapchain;
 		RenderDevice* renderDevice;
 
+		PendingReadback			readbacks[MAX_FRAMES];
+		FPN_ReadbackCallback	readbackCallback;
+		void*					readbackUserData;
+		uint64					frameCount;
+		uint64					frameValues[MAX_FRAMES]; // Retire value of the last frame submitted with each slot's fence
+
+		FramePacer				framePacer;
+		FramePacingSettings		pacingSettings;
+		VkSwapchainKHR			presentedSwapchain;	// Swapchain the last present id went to
+		uint64					presentedId;		// Present id of the last frame presented, frame index + 1
+		bool					frameStarted;		// WaitForNextFrame was called for the current frame
+		bool					presentModeChanged;
+
 		friend class RenderBackend;
 	};
 }
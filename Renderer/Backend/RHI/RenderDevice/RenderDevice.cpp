@@ -1,11 +1,13 @@
 #include "RenderDevice.hpp"
 #include <Renderer/Backend/RHI/Swapchain/Swapchain.hpp>
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
+#include <algorithm>
 #include <unordered_set>
 #include <Renderer/Backend/RHI/Common/Utils.hpp>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
 #include <Renderer/Backend/RHI/RenderInstance/RenderInstance.hpp>
 #include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
+#include <Legacy/Profiler/Profiler.hpp>
 
 TRE_NS_START
 
@@ -13,13 +15,17 @@ Renderer::RenderDevice::RenderDevice(RenderContext* ctx) :
     internal{ 0 },
     renderContext(ctx),
     gpuMemoryAllocator{*this},
+    defragmenter{*this},
     stagingManager{*this},
+    shaderLibrary{*this},
     acclBuilder(*this),
     framebufferAllocator(this),
     transientAttachmentAllocator(*this, true),
     pipelineAllocator(*this),
+    deletionStats{},
     submitSwapchain(false),
-    stagingFlush(false)
+    stagingFlush(false),
+    defragEnabled(false)
 {
 
 }
@@ -46,7 +52,7 @@ int32 Renderer::RenderDevice::CreateRenderDevice(const RenderInstance& renderIns
     vkGetPhysicalDeviceProperties(internal.gpu, &internal.gpuProperties);
 
     internal.queueFamilyIndices     = FindQueueFamilies(internal.gpu, ctx.GetSurface());
-    internal.isPresentQueueSeprate  = internal.queueFamilyIndices.queueFamilies[Internal::QFT_GRAPHICS] != 
+    internal.isPresentQueueSeprate  = !ctx.IsHeadless() && internal.queueFamilyIndices.queueFamilies[Internal::QFT_GRAPHICS] != 
                                             internal.queueFamilyIndices.queueFamilies[Internal::QFT_PRESENT];
     internal.isTransferQueueSeprate = internal.queueFamilyIndices.queueFamilies[Internal::QFT_GRAPHICS] !=
                                             internal.queueFamilyIndices.queueFamilies[Internal::QFT_TRANSFER];
@@ -74,7 +80,10 @@ int32 Renderer::RenderDevice::CreateLogicalDevice(const RenderInstance& renderIn
     StaticVector<const char*> extensionsArr;
     StaticVector<const char*> layersArr;
 
-    for (const auto& ext : VK_REQ_DEVICE_EXT) {
+    // Offscreen rendering has no swapchain so it doesn't need the presentation extensions
+    const auto& requiredExtensions = renderContext->IsHeadless() ? VK_REQ_HEADLESS_DEVICE_EXT : VK_REQ_DEVICE_EXT;
+
+    for (const auto& ext : requiredExtensions) {
         Hash h = Utils::Data(ext, strlen(ext));
 
         if (availbleDevExtensions.find(h) == availbleDevExtensions.end()) {
@@ -89,6 +98,11 @@ int32 Renderer::RenderDevice::CreateLogicalDevice(const RenderInstance& renderIn
     for (uint32 i = 0; i < extCount; i++) {
         Hash h = Utils::Data(extensions[i], strlen(extensions[i]));
 
+        // Features can ask for the same extension (VK_KHR_pipeline_library)
+        if (deviceExtensions.find(h) != deviceExtensions.end()) {
+            continue;
+        }
+
         if (availbleDevExtensions.find(h) == availbleDevExtensions.end()) {
             TRE_LOGW("Skipping extension '%s' not supported by device", extensions[i]);
             continue;
@@ -98,17 +112,17 @@ int32 Renderer::RenderDevice::CreateLogicalDevice(const RenderInstance& renderIn
         deviceExtensions.emplace(h);
     }
 
-    printf("Device Ext:\n");
+    TRE_LOGD("Device Ext:");
     for (auto c : extensionsArr)
-        printf("\t%s\n", c);
+        TRE_LOGD("\t%s", c);
 
     for (uint32 i = 0; i < layerCount; i++) {
         layersArr.PushBack(layers[i]);
     }
 
-    printf("Device Layers:\n");
+    TRE_LOGD("Device Layers:");
     for (auto c : layersArr)
-        printf("\t%s\n", c);
+        TRE_LOGD("\t%s", c);
 
     VkDevice device = VK_NULL_HANDLE;
     float queuePriority = 1.0f;
@@ -130,17 +144,38 @@ int32 Renderer::RenderDevice::CreateLogicalDevice(const RenderInstance& renderIn
 
     // Enable some device features:
     // TODO: check if the GPU supports this feature
-    // TODO: upgrade this to use VkPhysicalDeviceVulkan12Features  
     internal.accelFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
     internal.rtPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
-    internal.buffAdrFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-    internal.timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    internal.vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
     internal.deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     internal.deviceFeatures2.pNext = &internal.accelFeatures;
     internal.accelFeatures.pNext = &internal.rtPipelineFeatures;
-    internal.rtPipelineFeatures.pNext = &internal.buffAdrFeatures;
-    internal.buffAdrFeatures.pNext = &internal.timelineSemaphoreFeatures;
+    internal.rtPipelineFeatures.pNext = &internal.vulkan12Features;
+    internal.vulkan12Features.pNext = NULL;
+
+#if defined(VK_KHR_present_wait)
+    // Features of extensions that aren't enabled can't be chained
+    internal.presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    internal.presentIdFeatures.pNext = &internal.presentWaitFeatures;
+    internal.presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    internal.presentWaitFeatures.pNext = NULL;
+
+    if (this->IsExtensionEnabled(VK_KHR_PRESENT_ID_EXTENSION_NAME) && this->IsExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+        internal.vulkan12Features.pNext = &internal.presentIdFeatures;
+    }
+#endif
+
+#if defined(VK_EXT_graphics_pipeline_library)
+    internal.pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    internal.pipelineLibraryFeatures.pNext = internal.vulkan12Features.pNext;
+    internal.pipelineLibraryFeatures.graphicsPipelineLibrary = VK_FALSE;
+
+    if (this->IsExtensionEnabled(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && this->IsExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+        internal.vulkan12Features.pNext = &internal.pipelineLibraryFeatures;
+    }
+#endif
+
     vkGetPhysicalDeviceFeatures2(internal.gpu, &internal.deviceFeatures2);
 
     //deviceFeatures2.features.samplerAnisotropy = VK_TRUE;
@@ -205,7 +240,8 @@ void Renderer::RenderDevice::Init(uint32 enabledFeatures)
     this->enabledFeatures = enabledFeatures;
     const Internal::QueueFamilyIndices& queueFamilyIndices = this->GetQueueFamilyIndices();
 
-    for (uint32 f = 0; f < renderContext->GetNumFrames(); f++) {
+    // Every frame slot gets its pools, frame pacing can raise the frames in flight later on
+    for (uint32 f = 0; f < MAX_FRAMES; f++) {
         for (uint32 t = 0; t < MAX_THREADS; t++) {
             for (uint32 i = 0; i < (uint32)CommandBuffer::MAX; i++) {
                 if (queueFamilyIndices.queueFamilies[i] == UINT32_MAX) {
@@ -220,14 +256,20 @@ void Renderer::RenderDevice::Init(uint32 enabledFeatures)
     }
 
     gpuMemoryAllocator.Init();
+    deletionWorker.Init(DestroyObjects, this);
     fenceManager.Init(this);
     semaphoreManager.Init(this);
     eventManager.Init(this);
     stagingManager.Init();
+    shaderLibrary.LoadReflectionCache();
 
     // RT:
     if (enabledFeatures & RAY_TRACING)
         acclBuilder.Init();
+
+    // Optimized pipelines are linked in the background once their fast linked version is in use
+    if (this->IsGraphicsPipelineLibrarySupported())
+        pipelineAllocator.Init();
 }
 
 VkDeviceMemory Renderer::RenderDevice::AllocateDedicatedMemory(VkImage image, MemoryDomain memoryDomain) const
@@ -408,7 +450,7 @@ VkDeviceAddress Renderer::RenderDevice::GetBufferAddress(BufferHandle buff) cons
 VkPhysicalDevice Renderer::RenderDevice::PickGPU(const RenderInstance& renderInstance,
                                                  const RenderContext& ctx, FPN_RankGPU p_pick_func)
 {
-    ASSERT(ctx.GetSurface() == NULL);
+    ASSERT(ctx.IsHeadless() || ctx.GetSurface() != NULL);
     ASSERT(renderInstance.GetApiObject() == NULL);
 
     VkInstance instance = renderInstance.GetApiObject();
@@ -418,7 +460,7 @@ VkPhysicalDevice Renderer::RenderDevice::PickGPU(const RenderInstance& renderIns
     vkEnumeratePhysicalDevices(instance, &deviceCount, NULL);
 
     if (deviceCount == 0) {
-        fprintf(stderr, "Failed to find GPUs with Vulkan support!\n");
+        TRE_LOGE("Failed to find GPUs with Vulkan support!");
     }
 
     std::vector<VkPhysicalDevice> devices(deviceCount, VK_NULL_HANDLE);
@@ -450,9 +492,13 @@ bool Renderer::RenderDevice::IsDeviceSuitable(VkPhysicalDevice gpu, VkSurfaceKHR
 {
     Internal::QueueFamilyIndices indices = FindQueueFamilies(gpu, surface);
     
-    bool swapChainAdequate = false;
-    Renderer::Swapchain::SwapchainSupportDetails swapChainSupport = Renderer::Swapchain::QuerySwapchainSupport(gpu, surface);
-    swapChainAdequate = !swapChainSupport.formats.IsEmpty() && !swapChainSupport.presentModes.IsEmpty();
+    // Headless contexts have no surface to present to
+    bool swapChainAdequate = true;
+
+    if (surface != VK_NULL_HANDLE) {
+        Renderer::Swapchain::SwapchainSupportDetails swapChainSupport = Renderer::Swapchain::QuerySwapchainSupport(gpu, surface);
+        swapChainAdequate = !swapChainSupport.formats.IsEmpty() && !swapChainSupport.presentModes.IsEmpty();
+    }
 
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(gpu, &supportedFeatures);
@@ -516,7 +562,7 @@ Renderer::Internal::QueueFamilyIndices Renderer::RenderDevice::FindQueueFamilies
         indices.queueFamilies[Internal::QFT_TRANSFER] = indices.queueFamilies[Internal::QFT_GRAPHICS];
     }
 
-    printf("Complete! (Graphics: %d | Transfer: %d | Compute: %d | Present: %d)\n",
+    TRE_LOGI("Queue families: (Graphics: %d | Transfer: %d | Compute: %d | Present: %d)",
         indices.queueFamilies[Internal::QFT_GRAPHICS],
         indices.queueFamilies[Internal::QFT_TRANSFER],
         indices.queueFamilies[Internal::QFT_COMPUTE],
@@ -547,17 +593,23 @@ void Renderer::RenderDevice::Shutdown()
     framebufferAllocator.Destroy();
     transientAttachmentAllocator.Destroy();
     pipelineAllocator.Destroy();
+    shaderLibrary.SaveReflectionCache();
+    shaderLibrary.Destroy();
+
+    // Releases its buffers and timeline semaphore, they are collected below
+    if (enabledFeatures & RAY_TRACING) {
+        acclBuilder.Shutdown();
+    }
+
     fenceManager.Destroy();
     semaphoreManager.Destroy();
     eventManager.Destroy();
+
+    // The attachments and pipelines destroyed above freed memory, it has to go back before the allocator goes away
+    this->CollectPendingObjects(UINT64_MAX);
     gpuMemoryAllocator.Destroy();
 
     stagingManager.Shutdown();
-
-    if (enabledFeatures & RAY_TRACING) {
-        acclBuilder.Shutdown();
-    }
-
     this->DestroyAllFrames();
 
     // Destroy vulkan device:
@@ -635,6 +687,7 @@ void Renderer::RenderDevice::Submit(CommandBuffer::Type type, CommandBufferHandl
 
 void Renderer::RenderDevice::FlushQueue(CommandBuffer::Type type, bool triggerSwapchainSwap)
 {
+    TRE_PROFILE_SCOPE("RenderDevice::FlushQueue");
     auto& submissions = this->GetQueueSubmissions(type);
 
     if (!submissions.Size()) {
@@ -653,6 +706,7 @@ void Renderer::RenderDevice::FlushQueue(CommandBuffer::Type type, bool triggerSw
     StaticVector<VkSemaphore>       waits;
     StaticVector<VkSemaphore>       signals;
     const bool swapchainResize = renderContext->GetSwapchain().ResizeRequested();
+    const bool headless = renderContext->IsHeadless();
 
     for (uint32 subId = 0; subId < submissions.Size(); subId++) {
         auto& sub = submissions[subId];
@@ -685,7 +739,8 @@ void Renderer::RenderDevice::FlushQueue(CommandBuffer::Type type, bool triggerSw
         // The line below is commented because we can deduce the timeline values automatically so the timelineSemaCount can be effectively 0
         // ASSERTF(timelineSemaCount != signalValuesCount, "The count of timeline semaphores to signal is not equal to signalVlauesCount passed as argument");
 
-        if ((swapchainCommandBuffer || triggerSwapchainSwap) && !swapchainResize) {
+        // Offscreen images are not acquired nor presented so there is nothing to wait on or signal
+        if ((swapchainCommandBuffer || triggerSwapchainSwap) && !swapchainResize && !headless) {
             //const uint32 frame = renderContext->GetCurrentFrame();
             //if (!stagingManager.GetStage(frame).submitted) {
             VkPipelineStageFlagBits stage = swapchainCommandBuffer ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
@@ -752,7 +807,12 @@ void Renderer::RenderDevice::FlushQueue(CommandBuffer::Type type, bool triggerSw
             vkFence = (*sub.fence)->GetApiObject();
         }
 
-        if (swapchainCommandBuffer || triggerSwapchainSwap) {
+        if (headless) {
+            // The frame fence guards the readback of the offscreen image so it goes on the last submit of the frame
+            if (triggerSwapchainSwap && subId == submissions.Size() - 1) {
+                vkFence = renderContext->GetFrameFence();
+            }
+        } else if (swapchainCommandBuffer || triggerSwapchainSwap) {
             vkFence = renderContext->GetFrameFence();
         }
 
@@ -882,6 +942,7 @@ void Renderer::RenderDevice::SetFence(PerFrame::Submission& sub, FenceHandle* fe
 
 void Renderer::RenderDevice::FlushQueues()
 {
+    TRE_PROFILE_SCOPE("RenderDevice::FlushQueues");
     this->FlushQueue(CommandBuffer::Type::ASYNC_TRANSFER);
     this->FlushQueue(CommandBuffer::Type::ASYNC_COMPUTE);
     this->FlushQueue(CommandBuffer::Type::GENERIC);
@@ -899,34 +960,59 @@ void Renderer::RenderDevice::ClearFrame()
         }
     }
 
-    this->DestroyPendingObjects(frame);
+    // The fence of this frame slot was waited on, so were all the frames before it
+    const uint64 frameValue = this->GetRetireValue();
+    const uint32 framesInFlight = renderContext->GetNumFrames();
+    this->CollectPendingObjects(frameValue > framesInFlight ? frameValue - framesInFlight : 0);
+
+    // Pipelines are done with their modules once created, the ones no program holds anymore can go
+    shaderLibrary.Trim();
 }
 
 void Renderer::RenderDevice::BeginFrame()
 {
+    TRE_PROFILE_SCOPE("RenderDevice::BeginFrame");
     //printf("Begin Frame %d\n", renderContext->GetCurrentFrame());
-    if ((stagingFlush = stagingManager.Flush())) {
-        // stagingManager.Wait(stagingManager.GetCurrentStagingBuffer());
-        stagingManager.NextCmd();
-        stagingManager.ResetCurrentStage();
+    {
+        TRE_PROFILE_SCOPE("RenderDevice::StagingFlush");
+
+        if ((stagingFlush = stagingManager.Flush())) {
+            // stagingManager.Wait(stagingManager.GetCurrentStagingBuffer());
+            stagingManager.NextCmd();
+            stagingManager.ResetCurrentStage();
+        }
     }
 
     framebufferAllocator.BeginFrame();
     transientAttachmentAllocator.BeginFrame();
+    pipelineAllocator.BeginFrame();
+    gpuMemoryAllocator.BeginFrame();
+
+    // Recorded after the staging flush so the moved resources have their latest uploads
+    if (defragEnabled) {
+        defragmenter.Step(defragConfig);
+    }
 
     for (auto& allocator : descriptorSetAllocators)
         allocator.second.BeginFrame();
 
+    // Recycles what the compute queue finished and swaps in the compacted BLASes, never waits
+    if (enabledFeatures & RAY_TRACING) {
+        acclBuilder.Update();
+    }
+
     this->ClearFrame();
     submitSwapchain = false;
 }
 
 void Renderer::RenderDevice::EndFrame()
 {
+    TRE_PROFILE_SCOPE("RenderDevice::EndFrame");
     this->FlushQueue(CommandBuffer::Type::ASYNC_TRANSFER);
     this->FlushQueue(CommandBuffer::Type::ASYNC_COMPUTE);
     // if we already did sumbit to swapchain then done force the swap
-    this->FlushQueue(CommandBuffer::Type::GENERIC, !submitSwapchain);
+    // headless frames always end with the readback copy which has to signal the frame fence
+    this->FlushQueue(CommandBuffer::Type::GENERIC, !submitSwapchain || renderContext->IsHeadless());
     stagingFlush = false;
     //printf("End Frame %d\n", renderContext->GetCurrentFrame());
     // getchar();
@@ -934,6 +1020,7 @@ void Renderer::RenderDevice::EndFrame()
 
 void Renderer::RenderDevice::FlushStaging()
 {
+    TRE_PROFILE_SCOPE("RenderDevice::StagingFlush");
     stagingFlush = stagingManager.Flush();
 }
 
@@ -973,7 +1060,8 @@ Renderer::BlasHandle Renderer::RenderDevice::CreateBlas(const BlasCreateInfo& bl
     VkAccelerationStructureKHR blas = this->CreateAcceleration(createInfo, &buffer);
     buildInfo.dstAccelerationStructure = blas;  // Setting the where the build lands
     BlasHandle ret(objectsPool.blases.Allocate(*this, blasInfo, blas, buffer));
-    acclBuilder.StageBlasBuilding(ret, buildInfo, blasInfo.accOffset.begin(), blasInfo.accOffset.Size(), flags);
+    acclBuilder.StageBlasBuilding(ret, buildInfo, blasInfo.accOffset.begin(), blasInfo.accOffset.Size(), flags,
+        sizeInfo.buildScratchSize);
     return ret;
 }
 
@@ -981,9 +1069,17 @@ Renderer::TlasHandle Renderer::RenderDevice::CreateTlas(const TlasCreateInfo& cr
 {
     BufferInfo bufferInfo;
     bufferInfo.size = createInfo.blasInstances.size() * sizeof(VkAccelerationStructureInstanceKHR);
-    bufferInfo.usage = BufferUsage::SHADER_DEVICE_ADDRESS;
+    bufferInfo.usage = BufferUsage::SHADER_DEVICE_ADDRESS | BufferUsage::ACCLS_BUILD_INPUT_READ_ONLY;
     bufferInfo.domain = MemoryDomain::GPU_ONLY;
-    BufferHandle instanceBuffer = this->CreateBuffer(bufferInfo);
+
+    // Dynamic TLASes are refit from a persistently mapped copy of their instances per build in flight
+    if (createInfo.dynamic) {
+        bufferInfo.domain = MemoryDomain::CPU_COHERENT;
+        flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+    }
+
+    BufferHandle instanceBuffer = createInfo.dynamic ? this->CreateRingBuffer(bufferInfo, NULL, NUM_FRAMES) :
+                                                       this->CreateBuffer(bufferInfo);
     VkDeviceAddress instanceAddress = this->GetBufferAddress(instanceBuffer);
 
     // Create VkAccelerationStructureGeometryInstancesDataKHR
@@ -1023,7 +1119,11 @@ Renderer::TlasHandle Renderer::RenderDevice::CreateTlas(const TlasCreateInfo& cr
     BufferHandle tlasBuffer;
     VkAccelerationStructureKHR accl = CreateAcceleration(acclCreateInfo, &tlasBuffer);
     TlasHandle ret(objectsPool.tlases.Allocate(*this, createInfo, accl, tlasBuffer, instanceBuffer));
-    acclBuilder.StageTlasBuilding(ret, buildInfo, flags);
+    ret->buildFlags = flags;
+    ret->scratchSize = std::max(sizeInfo.buildScratchSize, sizeInfo.updateScratchSize);
+    ret->acclSize = sizeInfo.accelerationStructureSize;
+    acclBuilder.AddTlas(ret.Get());
+    acclBuilder.StageTlasBuilding(ret, buildInfo, flags, ret->scratchSize);
     return ret;
 }
 
@@ -1096,8 +1196,7 @@ void Renderer::RenderDevice::ResetFence(VkFence fence, bool isWaited)
         vkResetFences(this->GetDevice(), 1, &fence);
         fenceManager.Recycle(fence);
     } else {
-        Frame().recycleFences.EmplaceBack(fence);
-        Frame().shouldDestroy = true;
+        this->QueueDeletion(DeferredDeletion::RECYCLE_FENCE, (uint64)fence);
     }
 }
 
@@ -1199,7 +1298,6 @@ VkDeviceMemory Renderer::RenderDevice::CreateBufferMemory(const BufferInfo& info
 
 Renderer::MemoryAllocation Renderer::RenderDevice::AllocateMemory(VkBuffer buffer, uint32 usage, MemoryDomain domain, uint32 multiplier)
 {
-    MemoryAllocation alloc;
     VkMemoryRequirements2 memoryReqs;
     VkMemoryDedicatedRequirements   dedicatedRegs{ VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
     VkBufferMemoryRequirementsInfo2 bufferReqs{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2 };
@@ -1216,38 +1314,20 @@ Renderer::MemoryAllocation Renderer::RenderDevice::AllocateMemory(VkBuffer buffe
         allocationSize = alignedSizeConst * multiplier;
     }
 
-    if (dedicatedRegs.requiresDedicatedAllocation || dedicatedRegs.prefersDedicatedAllocation || usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-        alloc.size = allocationSize;
-        alloc.offset = 0;
-        alloc.padding = 0;
-        alloc.alignment = memoryReqs.memoryRequirements.alignment;
-        alloc.allocKey = UINT32_MAX;
-
-        VkMemoryAllocateFlagsInfo memFlagInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
-
-        if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
-            memFlagInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+    // Device addresses need the flag on the memory object, the shared blocks don't have it
+    const bool deviceAddress = usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 
-        VkMemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.pNext = &memFlagInfo;
-        memoryAllocateInfo.allocationSize = alloc.size;
-        memoryAllocateInfo.memoryTypeIndex = this->FindMemoryTypeIndex(memoryReqs.memoryRequirements.memoryTypeBits, domain);
-        CALL_VK(vkAllocateMemory(this->GetDevice(), &memoryAllocateInfo, NULL, &alloc.memory));
-        
-        if (domain == MemoryDomain::CPU_ONLY || domain == MemoryDomain::CPU_CACHED || domain == MemoryDomain::CPU_COHERENT) {
-            vkMapMemory(this->GetDevice(), alloc.memory, 0, alloc.size, 0, &alloc.mappedData);
-        }
-    } else {
-        alloc = gpuMemoryAllocator.Allocate(memoryTypeIndex, allocationSize, memoryReqs.memoryRequirements.alignment);
-    }
-
-    return alloc;
+    AllocationRequest request;
+    request.size              = allocationSize;
+    request.alignment         = memoryReqs.memoryRequirements.alignment;
+    request.group             = 0;
+    request.requiresDedicated = dedicatedRegs.requiresDedicatedAllocation || deviceAddress;
+    request.prefersDedicated  = dedicatedRegs.prefersDedicatedAllocation;
+    return gpuMemoryAllocator.Allocate(memoryTypeIndex, request, deviceAddress ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0);
 }
 
 Renderer::MemoryAllocation Renderer::RenderDevice::AllocateMemory(VkImage image, uint32 usage, MemoryDomain domain, uint32 multiplier)
 {
-    MemoryAllocation alloc;
     VkMemoryRequirements2 memoryReqs;
     VkMemoryDedicatedRequirements   dedicatedRegs{ VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
     VkImageMemoryRequirementsInfo2 imageReqs{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2 };
@@ -1263,52 +1343,70 @@ Renderer::MemoryAllocation Renderer::RenderDevice::AllocateMemory(VkImage image,
         const VkDeviceSize alignedSizeConst = memoryReqs.memoryRequirements.size + memoryReqs.memoryRequirements.alignment - alignMod;
         allocationSize = alignedSizeConst * multiplier;
     }
-    
-    if (dedicatedRegs.requiresDedicatedAllocation || dedicatedRegs.prefersDedicatedAllocation || usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-        alloc.size = allocationSize;
-        alloc.offset = 0;
-        alloc.padding = 0;
-        alloc.alignment = memoryReqs.memoryRequirements.alignment;
-        alloc.allocKey = UINT32_MAX;
-
-        VkMemoryAllocateFlagsInfo memFlagInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
-
-        if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
-            memFlagInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
-
-        VkMemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.pNext = &memFlagInfo;
-        memoryAllocateInfo.allocationSize = alloc.size;
-        memoryAllocateInfo.memoryTypeIndex = this->FindMemoryTypeIndex(memoryReqs.memoryRequirements.memoryTypeBits, domain);
-        CALL_VK(vkAllocateMemory(this->GetDevice(), &memoryAllocateInfo, NULL, &alloc.memory));
-
-        if (domain == MemoryDomain::CPU_ONLY || domain == MemoryDomain::CPU_CACHED || domain == MemoryDomain::CPU_COHERENT) {
-            vkMapMemory(this->GetDevice(), alloc.memory, 0, alloc.size, 0, &alloc.mappedData);
-        }
-    } else {
-        const auto& limits = this->GetProperties().limits;
-        alloc = gpuMemoryAllocator.Allocate(memoryTypeIndex, allocationSize, MAX(memoryReqs.memoryRequirements.alignment, limits.bufferImageGranularity));
-    }
 
-    return alloc;
+    // Images get slab pages of their own so they never share a granularity page with a buffer
+    const auto& limits = this->GetProperties().limits;
+
+    AllocationRequest request;
+    request.size              = allocationSize;
+    request.alignment         = MAX(memoryReqs.memoryRequirements.alignment, limits.bufferImageGranularity);
+    request.group             = 1;
+    request.requiresDedicated = dedicatedRegs.requiresDedicatedAllocation;
+    request.prefersDedicated  = dedicatedRegs.prefersDedicatedAllocation;
+    return gpuMemoryAllocator.Allocate(memoryTypeIndex, request);
 }
 
 bool Renderer::RenderDevice::CreateBufferInternal(VkBuffer& outBuffer, MemoryAllocation& outMemoryView, const BufferInfo& createInfo)
 {
     outBuffer = this->CreateBufferHelper(createInfo);
     outMemoryView = this->AllocateMemory(outBuffer, createInfo.usage, createInfo.domain);
+
+    if (outMemoryView.memory == VK_NULL_HANDLE) {
+        // Out of device memory, the buffer was never bound or used so it goes right away
+        vkDestroyBuffer(this->GetDevice(), outBuffer, NULL);
+        outBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+
     vkBindBufferMemory(this->GetDevice(), outBuffer, outMemoryView.memory, outMemoryView.offset);
     return true;
 }
 
+bool Renderer::RenderDevice::IsExtensionEnabled(const char* extension) const
+{
+    return deviceExtensions.find(Utils::Data(extension, strlen(extension))) != deviceExtensions.end();
+}
+
+bool Renderer::RenderDevice::IsGraphicsPipelineLibrarySupported() const
+{
+#if defined(VK_EXT_graphics_pipeline_library)
+    return internal.pipelineLibraryFeatures.graphicsPipelineLibrary &&
+        this->IsExtensionEnabled(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && this->IsExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+#else
+    return false;
+#endif
+}
+
+bool Renderer::RenderDevice::IsPresentWaitSupported() const
+{
+#if defined(VK_KHR_present_wait)
+    return internal.presentIdFeatures.presentId && internal.presentWaitFeatures.presentWait &&
+        this->IsExtensionEnabled(VK_KHR_PRESENT_ID_EXTENSION_NAME) && this->IsExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+#else
+    return false;
+#endif
+}
+
 Renderer::BufferHandle Renderer::RenderDevice::CreateBuffer(const BufferInfo& createInfo, const void* data)
 {
     MemoryAllocation bufferMemory;
     VkBuffer apiBuffer;
 
-    this->CreateBufferInternal(apiBuffer, bufferMemory, createInfo);
+    if (!this->CreateBufferInternal(apiBuffer, bufferMemory, createInfo))
+        return BufferHandle(NULL);
+
     BufferHandle ret(objectsPool.buffers.Allocate(*this, apiBuffer, createInfo, bufferMemory));
+    defragmenter.Register(*ret);
 
     if (data) {
         ret->WriteToBuffer(createInfo.size, data);
@@ -1330,7 +1428,9 @@ Renderer::BufferHandle Renderer::RenderDevice::CreateRingBuffer(const BufferInfo
 
     // Removing padding from total size, as we dont need the last bytes for alignement
     // alignedSize * NUM_FRAMES - padding, data, usage, MemoryDomain, queueFamilies
-    this->CreateBufferInternal(apiBuffer, bufferMemory, info);
+    if (!this->CreateBufferInternal(apiBuffer, bufferMemory, info))
+        return BufferHandle(NULL);
+
     BufferHandle ret(objectsPool.buffers.Allocate(*this, apiBuffer, info, bufferMemory, (uint32)alignedSize, ringSize));
 
     if (data) {
@@ -1341,6 +1441,55 @@ Renderer::BufferHandle Renderer::RenderDevice::CreateRingBuffer(const BufferInfo
 }
 
 Renderer::ImageHandle Renderer::RenderDevice::CreateImage(const ImageCreateInfo& createInfo, const void* data)
+{
+    MemoryDomain memUsage;
+    VkImageLayout initialLayout;
+    ImageHandle ret = this->CreateImageInternal(createInfo, memUsage, initialLayout);
+
+    if (!ret)
+        return ret;
+
+    if (data) {
+        if (memUsage == MemoryDomain::GPU_ONLY) {
+            stagingManager.Stage(*ret, data, createInfo.width * createInfo.height * FormatToChannelCount(createInfo.format));
+        } else {
+            // TODO: add uploading directly from CPU
+            ASSERTF(true, "Not supported!");
+        }
+    } else {
+        if (createInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            // TODO: add layout trasnisioning here: using staging manager:
+            stagingManager.ChangeImageLayout(*ret, initialLayout, createInfo.layout);
+        }
+    }
+
+    return ret;
+}
+
+Renderer::ImageHandle Renderer::RenderDevice::CreateImage(const ImageCreateInfo& createInfo, const ImageInitialData* levels, uint32 levelCount)
+{
+    MemoryDomain memUsage;
+    VkImageLayout initialLayout;
+    ImageHandle ret = this->CreateImageInternal(createInfo, memUsage, initialLayout);
+
+    if (!ret)
+        return ret;
+
+    ASSERTF(memUsage == MemoryDomain::GPU_ONLY, "Mip chains can only be uploaded to device local images");
+    ASSERTF(levelCount && levelCount <= createInfo.levels, "Can't upload %d levels to an image of %d", levelCount, createInfo.levels);
+
+    const uint32 firstLevel = createInfo.levels - levelCount;
+
+    // Levels that aren't loaded yet still need a valid layout as views cover the whole chain
+    if (firstLevel) {
+        stagingManager.ChangeImageLayout(*ret, initialLayout, createInfo.layout);
+    }
+
+    stagingManager.Stage(*ret, levels, levelCount, firstLevel);
+    return ret;
+}
+
+VkImage Renderer::RenderDevice::CreateImageHelper(const ImageCreateInfo& createInfo, MemoryDomain& outDomain, VkImageLayout& outInitialLayout) const
 {
     MemoryDomain memUsage = MemoryDomain::USAGE_UNKNOWN;
 
@@ -1401,26 +1550,27 @@ Renderer::ImageHandle Renderer::RenderDevice::CreateImage(const ImageCreateInfo&
         ASSERTF(true, "failed to create a image!");
     }
 
+    outDomain = memUsage;
+    outInitialLayout = info.initialLayout;
+    return apiImage;
+}
+
+Renderer::ImageHandle Renderer::RenderDevice::CreateImageInternal(const ImageCreateInfo& createInfo, MemoryDomain& outDomain, VkImageLayout& outInitialLayout)
+{
+    VkImage apiImage = this->CreateImageHelper(createInfo, outDomain, outInitialLayout);
+
     MemoryAllocation imageMemory;
-    imageMemory = this->AllocateMemory(apiImage, (uint32)createInfo.usage, memUsage);
+    imageMemory = this->AllocateMemory(apiImage, (uint32)createInfo.usage, outDomain);
     // printf("[Image] Size: %d | offset: %d | padding: %d\n", imageMemory.size, imageMemory.offset - imageMemory.padding, imageMemory.padding);
-    vkBindImageMemory(this->GetDevice(), apiImage, imageMemory.memory, imageMemory.offset);
-    ImageHandle ret = ImageHandle(objectsPool.images.Allocate(*this, apiImage, createInfo, imageMemory));
-    
-    if (data) {
-        if (memUsage == MemoryDomain::GPU_ONLY) {
-            stagingManager.Stage(*ret, data, createInfo.width * createInfo.height * FormatToChannelCount(createInfo.format));
-        } else {
-            // TODO: add uploading directly from CPU
-            ASSERTF(true, "Not supported!");
-        }
-    } else {
-        if (createInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
-            // TODO: add layout trasnisioning here: using staging manager:
-            stagingManager.ChangeImageLayout(*ret, info.initialLayout, createInfo.layout);
-        }
+
+    if (imageMemory.memory == VK_NULL_HANDLE) {
+        vkDestroyImage(this->GetDevice(), apiImage, NULL);
+        return ImageHandle(NULL);
     }
 
+    vkBindImageMemory(this->GetDevice(), apiImage, imageMemory.memory, imageMemory.offset);
+    ImageHandle ret(objectsPool.images.Allocate(*this, apiImage, createInfo, imageMemory));
+    defragmenter.Register(*ret);
     return ret;
 }
 
@@ -1516,11 +1666,13 @@ Renderer::DescriptorSetAllocator* Renderer::RenderDevice::RequestDescriptorSetAl
 
 Renderer::Pipeline& Renderer::RenderDevice::RequestPipeline(ShaderProgram& program, const RenderPass& rp, const GraphicsState& state)
 {
+   TRE_PROFILE_SCOPE("RenderDevice::RequestPipeline");
    return pipelineAllocator.RequestPipline(program, rp, state);
 }
 
 Renderer::Pipeline& Renderer::RenderDevice::RequestPipeline(ShaderProgram& program)
 {
+    TRE_PROFILE_SCOPE("RenderDevice::RequestPipeline");
     return pipelineAllocator.RequestPipline(program);
 }
 
@@ -1659,175 +1811,194 @@ Renderer::ImageView& Renderer::RenderDevice::GetTransientAttachment(uint32 width
     return transientAttachmentAllocator.RequestAttachment(width, height, format, index, samples, layers);
 }
 
-void Renderer::RenderDevice::DestroyPendingObjects(PerFrame& frame)
+void Renderer::RenderDevice::CollectPendingObjects(uint64 completedValue)
 {
-    if (!frame.shouldDestroy)
-        return;
-
+    TRE_PROFILE_SCOPE("RenderDevice::CollectPendingObjects");
     VkDevice dev = this->GetDevice();
 
-    for (const auto& kv : frame.destroyedCmdBuffers)
-        vkFreeCommandBuffers(dev, kv.first, (uint32)kv.second.size(), kv.second.data());
-
-    for (auto pool : frame.destroyedCmdPools)
-        vkDestroyCommandPool(dev, pool, NULL);
+    // The allocator isn't thread safe, the memory goes back to it here in one go
+    readyAllocations.clear();
+    allocationQueue.Collect(completedValue, readyAllocations);
+    deletionStats.reclaimedBytes = gpuMemoryAllocator.Free(readyAllocations.data(), (uint32)readyAllocations.size());
+    deletionStats.freedAllocations = (uint32)readyAllocations.size();
 
-    for (auto rp : frame.destroyedRenderPasses)
-        vkDestroyRenderPass(dev, rp, NULL);
+    readyObjects.clear();
+    deletionQueue.Collect(completedValue, readyObjects);
 
-    for (auto dsc : frame.destroyedDescriptorPool)
-        vkDestroyDescriptorPool(dev, dsc, NULL);
+    // By type then command pool: the render thread's part comes first and command buffers are freed per pool
+    std::sort(readyObjects.begin(), readyObjects.end(), [](const DeferredDeletion& a, const DeferredDeletion& b) {
+        return a.type != b.type ? a.type < b.type : a.owner < b.owner;
+    });
 
-    for (auto fb : frame.destroyedFramebuffers)
-        vkDestroyFramebuffer(dev, fb, NULL);
+    uint32 first = 0;
 
-    for (auto view : frame.destroyedImageViews)
-        vkDestroyImageView(dev, view, NULL);
+    for (; first < readyObjects.size() && DeferredDeletion::IsOnRenderThread(readyObjects[first].type); first++) {
+        const DeferredDeletion& entry = readyObjects[first];
 
-    for (auto img : frame.destroyedImages)
-        vkDestroyImage(dev, img, NULL);
+        switch (entry.type) {
+        case DeferredDeletion::COMMAND_BUFFER: {
+            readyCmdBuffers.push_back((VkCommandBuffer)(uintptr)entry.handle);
+            const bool lastOfPool = first + 1 == readyObjects.size() || readyObjects[first + 1].type != entry.type ||
+                readyObjects[first + 1].owner != entry.owner;
 
-    for (auto view : frame.destroyedBufferViews)
-        vkDestroyBufferView(dev, view, NULL);
-
-    for (auto buff : frame.destroyedBuffers)
-        vkDestroyBuffer(dev, buff, NULL);
-
-    for (auto sem : frame.destroyedSemaphores)
-        vkDestroySemaphore(dev, sem, NULL);
+            if (lastOfPool) {
+                vkFreeCommandBuffers(dev, (VkCommandPool)entry.owner, (uint32)readyCmdBuffers.size(), readyCmdBuffers.data());
+                readyCmdBuffers.clear();
+            }
+            break;
+        }
+        case DeferredDeletion::RECYCLE_SEMAPHORE:
+            semaphoreManager.Recycle((VkSemaphore)entry.handle);
+            break;
+        case DeferredDeletion::RECYCLE_FENCE:
+            fenceManager.Recycle((VkFence)entry.handle);
+            break;
+        default:
+            break;
+        }
+    }
 
-    for (auto sampler : frame.destroyedSamplers)
-        vkDestroySampler(dev, sampler, NULL);
+    const uint32 workerCount = (uint32)readyObjects.size() - first;
+    deletionWorker.Submit(readyObjects.data() + first, workerCount);
 
-    if (enabledFeatures & RAY_TRACING) {
-        for (auto accl : frame.destroyedAccls)
-            vkDestroyAccelerationStructureKHR(dev, accl, NULL);
+    const DeletionWorkerStats workerStats = deletionWorker.GetStats();
+    deletionStats.destroyedObjects = workerCount;
+    deletionStats.pendingObjects = deletionQueue.GetPendingCount() + allocationQueue.GetPendingCount();
+    deletionStats.latencyMs = workerStats.lastLatencyMs;
+    deletionStats.maxLatencyMs = workerStats.maxLatencyMs;
+}
 
-        frame.destroyedAccls.Clear();
-    }
+void Renderer::RenderDevice::DestroyObjects(const DeferredDeletion* entries, uint32 count, void* userData)
+{
+    TRE_PROFILE_SCOPE("RenderDevice::DestroyObjects");
+    VkDevice dev = static_cast<RenderDevice*>(userData)->GetDevice();
 
-    // Free memory:
-    for (auto& mem : frame.freedMemory)
-        vkFreeMemory(dev, mem, NULL);
+    for (uint32 i = 0; i < count; i++) {
+        const DeferredDeletion& entry = entries[i];
 
-    // Free allocated memory:
-    for (auto alloc : frame.freeAllocatedMemory) {
-        if (alloc.allocKey != UINT32_MAX) {
-            gpuMemoryAllocator.Free(alloc);
-        } else { // Dedicated memory
-            if (alloc.mappedData)
-                vkUnmapMemory(dev, alloc.memory);
-            vkFreeMemory(dev, alloc.memory, NULL);
+        switch (entry.type) {
+        case DeferredDeletion::COMMAND_POOL:
+            vkDestroyCommandPool(dev, (VkCommandPool)entry.handle, NULL);
+            break;
+        case DeferredDeletion::RENDER_PASS:
+            vkDestroyRenderPass(dev, (VkRenderPass)entry.handle, NULL);
+            break;
+        case DeferredDeletion::DESCRIPTOR_POOL:
+            vkDestroyDescriptorPool(dev, (VkDescriptorPool)entry.handle, NULL);
+            break;
+        case DeferredDeletion::FRAMEBUFFER:
+            vkDestroyFramebuffer(dev, (VkFramebuffer)entry.handle, NULL);
+            break;
+        case DeferredDeletion::PIPELINE:
+            vkDestroyPipeline(dev, (VkPipeline)entry.handle, NULL);
+            break;
+        case DeferredDeletion::IMAGE_VIEW:
+            vkDestroyImageView(dev, (VkImageView)entry.handle, NULL);
+            break;
+        case DeferredDeletion::IMAGE:
+            vkDestroyImage(dev, (VkImage)entry.handle, NULL);
+            break;
+        case DeferredDeletion::BUFFER_VIEW:
+            vkDestroyBufferView(dev, (VkBufferView)entry.handle, NULL);
+            break;
+        case DeferredDeletion::BUFFER:
+            vkDestroyBuffer(dev, (VkBuffer)entry.handle, NULL);
+            break;
+        case DeferredDeletion::SEMAPHORE:
+            vkDestroySemaphore(dev, (VkSemaphore)entry.handle, NULL);
+            break;
+        case DeferredDeletion::EVENT:
+            vkDestroyEvent(dev, (VkEvent)entry.handle, NULL);
+            break;
+        case DeferredDeletion::SAMPLER:
+            vkDestroySampler(dev, (VkSampler)entry.handle, NULL);
+            break;
+        case DeferredDeletion::ACCELERATION_STRUCTURE:
+            vkDestroyAccelerationStructureKHR(dev, (VkAccelerationStructureKHR)entry.handle, NULL);
+            break;
+        case DeferredDeletion::DEVICE_MEMORY:
+            vkFreeMemory(dev, (VkDeviceMemory)entry.handle, NULL);
+            break;
+        default:
+            ASSERTF(false, "Deferred deletion of type %d doesn't belong to the worker", entry.type);
+            break;
         }
     }
-
-    // Recycle:
-    for (auto& sem : frame.recycleSemaphores)
-        semaphoreManager.Recycle(sem);
-
-    // vkResetFences(dev, (uint32)frame.recycleFences.Size(), frame.recycleFences.Data());
-    for (auto& fence : frame.recycleFences)
-        fenceManager.Recycle(fence);
-
-    frame.destroyedFramebuffers.Clear();
-    frame.destroyedImageViews.Clear();
-    frame.destroyedImages.Clear();
-    frame.freedMemory.Clear();
-    frame.destroyedSemaphores.Clear();
-    frame.recycleSemaphores.Clear();
-    frame.recycleFences.Clear();
-
-    frame.destroyedSamplers.Clear();
-    frame.destroyedBuffers.Clear();
-    frame.destroyedBufferViews.Clear();
-    frame.destroyedRenderPasses.Clear();
-    frame.destroyedDescriptorPool.Clear();
-    frame.destroyedCmdPools.Clear();
-    frame.destroyedCmdBuffers.clear();
-    frame.shouldDestroy = false;
 }
 
 void Renderer::RenderDevice::DestroyImage(VkImage image)
 {
-    PerFrame& frame = this->Frame();
-    frame.destroyedImages.EmplaceBack(image);
-    frame.shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::IMAGE, (uint64)image);
 }
 
 void Renderer::RenderDevice::DestroyImageView(VkImageView view)
 {
-    PerFrame& frame = this->Frame();
-    frame.destroyedImageViews.EmplaceBack(view);
-    frame.shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::IMAGE_VIEW, (uint64)view);
 }
 
 void Renderer::RenderDevice::DestroyFramebuffer(VkFramebuffer fb)
 {
-    PerFrame& frame = this->Frame();
-    frame.destroyedFramebuffers.EmplaceBack(fb);
-    frame.shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::FRAMEBUFFER, (uint64)fb);
 }
 
 void Renderer::RenderDevice::FreeMemory(VkDeviceMemory memory)
 {
-    PerFrame& frame = this->Frame();
-    frame.freedMemory.EmplaceBack(memory);
-    frame.shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::DEVICE_MEMORY, (uint64)memory);
 }
 
 void Renderer::RenderDevice::FreeMemory(const MemoryAllocation& alloc)
 {
-    PerFrame& frame = this->Frame();
-    frame.freeAllocatedMemory.EmplaceBack(alloc);
-    frame.shouldDestroy = true;
+    allocationQueue.Push(alloc, this->GetRetireValue());
 }
 
 void Renderer::RenderDevice::RecycleSemaphore(VkSemaphore sem)
 {
-    Frame().recycleSemaphores.EmplaceBack(sem);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::RECYCLE_SEMAPHORE, (uint64)sem);
 }
 
 void Renderer::RenderDevice::DestroySemaphore(VkSemaphore sem)
 {
-    Frame().destroyedSemaphores.EmplaceBack(sem);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::SEMAPHORE, (uint64)sem);
 }
 
 void Renderer::RenderDevice::DestroryEvent(VkEvent event)
 {
-    Frame().destroyedEvents.EmplaceBack(event);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::EVENT, (uint64)event);
 }
 
 void Renderer::RenderDevice::DestroyBuffer(VkBuffer buffer)
 {
-    Frame().destroyedBuffers.EmplaceBack(buffer);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::BUFFER, (uint64)buffer);
 }
 
 void Renderer::RenderDevice::DestroyBufferView(VkBufferView view)
 {
-    Frame().destroyedBufferViews.EmplaceBack(view);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::BUFFER_VIEW, (uint64)view);
 }
 
 void Renderer::RenderDevice::DestroySampler(VkSampler sampler)
 {
-    Frame().destroyedSamplers.EmplaceBack(sampler);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::SAMPLER, (uint64)sampler);
+}
+
+void Renderer::RenderDevice::DestroyPipeline(VkPipeline pipeline)
+{
+    this->QueueDeletion(DeferredDeletion::PIPELINE, (uint64)pipeline);
+}
+
+void Renderer::RenderDevice::DestroyAccelerationStructure(VkAccelerationStructureKHR accl)
+{
+    this->QueueDeletion(DeferredDeletion::ACCELERATION_STRUCTURE, (uint64)accl);
 }
 
 void Renderer::RenderDevice::FreeCommandBuffer(VkCommandPool pool, VkCommandBuffer cmd)
 {
-    Frame().destroyedCmdBuffers[pool].emplace_back(cmd);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::COMMAND_BUFFER, (uint64)(uintptr)cmd, (uint64)pool);
 }
 
 void Renderer::RenderDevice::DestroyCommandPool(VkCommandPool pool)
 {
-    Frame().destroyedCmdPools.EmplaceBack(pool);
-    Frame().shouldDestroy = true;
+    this->QueueDeletion(DeferredDeletion::COMMAND_POOL, (uint64)pool);
 }
 
 
@@ -1850,8 +2021,6 @@ void Renderer::RenderDevice::DestroyAllFrames()
     }
 
     for (PerFrame& frame : perFrame) {
-        frame.shouldDestroy = true;
-
         for (uint32 i = 0; i < (uint32)CommandBuffer::Type::MAX; i++) {
             for (uint32 t = 0; t < MAX_THREADS; t++)
                 frame.commandPools[t][i].Destroy();
@@ -1861,9 +2030,9 @@ void Renderer::RenderDevice::DestroyAllFrames()
         }
     }
 
-    for (PerFrame& frame : perFrame) {
-        this->DestroyPendingObjects(frame);
-    }
+    // The device is idle, everything left goes now
+    this->CollectPendingObjects(UINT64_MAX);
+    deletionWorker.Shutdown();
 }
 
 
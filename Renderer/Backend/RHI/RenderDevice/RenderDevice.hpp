@@ -8,6 +8,7 @@
 #include <Renderer/Backend/Common.hpp>
 
 #include <Renderer/Backend/Core/StaticVector/StaticVector.hpp>
+#include <Renderer/Backend/Core/DeletionQueue/DeletionQueue.hpp>
 #include <Renderer/Backend/Core/Allocators/StackAllocator.hpp>
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
@@ -16,12 +17,14 @@
 #include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
 #include <Renderer/Backend/RHI/RenderContext/RenderContext.hpp>
 #include <Renderer/Backend/RHI/MemoryAllocator/MemoryAllocator.hpp>
+#include <Renderer/Backend/RHI/MemoryDefragmenter/MemoryDefragmenter.hpp>
 #include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
 #include <Renderer/Backend/RHI/StagingManager/StagingManager.hpp>
 #include <Renderer/Backend/RHI/CommandList/CommandPool.hpp>
 #include <Renderer/Backend/RHI/CommandList/CommandList.hpp>
 #include <Renderer/Backend/RHI/Descriptors/DescriptorSetAlloc.hpp>
 #include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
+#include <Renderer/Backend/RHI/ShaderLibrary/ShaderLibrary.hpp>
 #include <Renderer/Backend/RHI/Images/Sampler.hpp>
 #include <Renderer/Backend/RHI/RenderPass/Framebuffer.hpp>
 #include <Renderer/Backend/RHI/RenderPass/FramebufferAllocator.hpp>
@@ -81,32 +84,38 @@ namespace Renderer
 
             typedef StaticVector<Submission> Submissions;
             Submissions                   submissions[(uint32)CommandBuffer::Type::MAX];
+        };
 
-            std::map<VkCommandPool, std::vector<VkCommandBuffer>> destroyedCmdBuffers;
-            TRE::Vector<VkCommandPool>    destroyedCmdPools;
-
-            TRE::Vector<VkPipeline>       destroyedPipelines;
-            TRE::Vector<VkFramebuffer>    destroyedFramebuffers;
-            TRE::Vector<VkImage>	      destroyedImages;
-            TRE::Vector<VkImageView>      destroyedImageViews;
-            TRE::Vector<VkBuffer>		  destroyedBuffers;
-            TRE::Vector<VkBufferView>	  destroyedBufferViews;
-            TRE::Vector<VkRenderPass>	  destroyedRenderPasses;
-            TRE::Vector<VkDescriptorPool> destroyedDescriptorPool;
-            TRE::Vector<VkSemaphore>	  destroyedSemaphores;
-            TRE::Vector<VkEvent>		  destroyedEvents;
-            TRE::Vector<VkSampler>        destroyedSamplers;
-
-            TRE::Vector<VkFence>		  recycleFences;
-            TRE::Vector<VkSemaphore>	  recycleSemaphores;
-            // TRE::Vector<VkSemaphore>      recycledTimelineSema;
-
-            TRE::Vector<VkDeviceMemory>	  freedMemory;
-            TRE::Vector<MemoryAllocation> freeAllocatedMemory;
+        // A Vulkan object waiting on the GPU before it's destroyed or recycled. The types are in destruction order, the
+        // first ones go back to pools the render thread uses and are handled there, the rest on the deletion worker.
+        struct DeferredDeletion
+        {
+            enum Type : uint8
+            {
+                COMMAND_BUFFER,
+                RECYCLE_SEMAPHORE,
+                RECYCLE_FENCE,
+                COMMAND_POOL,
+                RENDER_PASS,
+                DESCRIPTOR_POOL,
+                FRAMEBUFFER,
+                PIPELINE,
+                IMAGE_VIEW,
+                IMAGE,
+                BUFFER_VIEW,
+                BUFFER,
+                SEMAPHORE,
+                EVENT,
+                SAMPLER,
+                ACCELERATION_STRUCTURE,
+                DEVICE_MEMORY,
+            };
 
-            TRE::Vector<VkAccelerationStructureKHR> destroyedAccls;
+            uint64 handle;
+            uint64 owner; // The command pool of a command buffer
+            Type   type;
 
-            bool shouldDestroy = false;
+            CONSTEXPR static bool IsOnRenderThread(Type type) { return type <= RECYCLE_FENCE; }
         };
 
         struct HandlePool
@@ -126,6 +135,17 @@ namespace Renderer
             ObjectPool<Tlas>		  tlases;
         };
 
+	public:
+        // Deferred destruction of the last frame collected
+        struct DeletionStats
+        {
+            uint64 reclaimedBytes;     // Memory returned to the allocator
+            uint32 freedAllocations;
+            uint32 destroyedObjects;   // Handed to the deletion worker
+            uint32 pendingObjects;     // Objects and allocations still waiting on the GPU
+            float  latencyMs;          // Latest worker batch, from hand off to destroyed
+            float  maxLatencyMs;
+        };
 	public:
         // Basic:
         RenderDevice(RenderContext* ctx);
@@ -171,12 +191,18 @@ namespace Renderer
 
         FORCEINLINE void RtBuildTlasBatch() { acclBuilder.BuildTlasBatch(); };
 
+        // Stages the refit of a dynamic TLAS whose instances changed, built by the next RtBuildTlasBatch
+        FORCEINLINE void RtUpdateTlas(const TlasHandle& tlas) { acclBuilder.StageTlasUpdate(tlas); };
+
         FORCEINLINE void RtBuildBlasBatchs() { acclBuilder.BuildBlasBatchs(); };
 
         FORCEINLINE void RtCompressBatch() { acclBuilder.CompressBatch(); };
 
         FORCEINLINE void BuildAS() { acclBuilder.BuildAll(); };
 
+        // Compacted BLASes were swapped in this frame, the TLASes referencing them were rebuilt along
+        FORCEINLINE bool RtBlasesSwapped() const { return acclBuilder.HasSwappedBlases(); }
+
 
         // Command buffers and queues:
         CommandPoolHandle RequestCommandPool(uint32 queueFamily, CommandPool::Type type = CommandPool::Type::NONE);
@@ -221,15 +247,24 @@ namespace Renderer
         void FlushQueues();
 
         // Buffer Creation:
+        // Buffers and images come back as null handles when out of device memory
         BufferHandle CreateBuffer(const BufferInfo& createInfo, const void* data = NULL);
 
-        BufferHandle CreateRingBuffer(const BufferInfo& createInfo, const void* data = NULL, const uint32 ringSize = NUM_FRAMES);
+        // One copy per frame that can be in flight by default, whatever count frame pacing picked
+        BufferHandle CreateRingBuffer(const BufferInfo& createInfo, const void* data = NULL, const uint32 ringSize = MAX_FRAMES);
 
+        // False when out of device memory, the buffer is destroyed then
         bool CreateBufferInternal(VkBuffer& outBuffer, MemoryAllocation& outMemoryView, const BufferInfo& createInfo);
 
         // Image Creation:
         ImageHandle CreateImage(const ImageCreateInfo& createInfo, const void* data = NULL);
 
+        // Uploads a prebuilt mip chain, used for block compressed textures. With fewer levels than createInfo, the data is
+        // the tail of the chain (the smallest levels) and the larger ones are left to be streamed in with StagingManager::Stage.
+        ImageHandle CreateImage(const ImageCreateInfo& createInfo, const ImageInitialData* levels, uint32 levelCount);
+
+        ImageHandle CreateImageInternal(const ImageCreateInfo& createInfo, MemoryDomain& outDomain, VkImageLayout& outInitialLayout);
+
         ImageViewHandle CreateImageView(const ImageViewCreateInfo& createInfo);
 
         // Memory allocation:
@@ -283,7 +318,18 @@ namespace Renderer
 
 
         // Destroy functions:
-        void DestroyPendingObjects(PerFrame& frame);
+        // Frees and recycles what the GPU is done with, hands the rest of the ready objects to the deletion worker
+        void CollectPendingObjects(uint64 completedValue);
+
+        FORCEINLINE void QueueDeletion(DeferredDeletion::Type type, uint64 handle, uint64 owner = 0)
+        {
+            deletionQueue.Push({ handle, owner, type }, this->GetRetireValue());
+        }
+
+        // Objects queued while recording frame N are safe once frame N completed, frames count from 1
+        FORCEINLINE uint64 GetRetireValue() const { return renderContext->GetFrameCount() + 1; }
+
+        static void DestroyObjects(const DeferredDeletion* entries, uint32 count, void* userData);
 
         void DestroyImage(VkImage image);
 
@@ -305,6 +351,10 @@ namespace Renderer
 
         void DestroySampler(VkSampler sampler);
 
+        void DestroyPipeline(VkPipeline pipeline);
+
+        void DestroyAccelerationStructure(VkAccelerationStructureKHR accl);
+
         void FreeCommandBuffer(VkCommandPool pool, VkCommandBuffer cmd);
 
         void DestroyCommandPool(VkCommandPool pool);
@@ -336,6 +386,9 @@ namespace Renderer
         // Buffer
         VkBuffer CreateBufferHelper(const BufferInfo& info) const;
 
+        // Image
+        VkImage CreateImageHelper(const ImageCreateInfo& createInfo, MemoryDomain& outDomain, VkImageLayout& outInitialLayout) const;
+
 		VkDeviceMemory CreateBufferMemory(const BufferInfo& info, VkBuffer buffer,
 			VkDeviceSize* alignedSize = NULL, uint32 multiplier = 1) const;
 
@@ -374,6 +427,8 @@ namespace Renderer
 
 		FORCEINLINE const VkPhysicalDeviceAccelerationStructureFeaturesKHR& GetAcclFeatures() const { return internal.accelFeatures; }
 
+		FORCEINLINE const VkPhysicalDeviceVulkan12Features& GetVulkan12Features() const { return internal.vulkan12Features; }
+
         FORCEINLINE const RenderContext* GetRenderContext() const { return renderContext; }
 
         // Useful Getters:
@@ -381,10 +436,31 @@ namespace Renderer
 
         FORCEINLINE StagingManager& GetStagingManager() { return stagingManager; }
 
+        FORCEINLINE ShaderLibrary& GetShaderLibrary() { return shaderLibrary; }
+
         FORCEINLINE ObjectPool<CommandBuffer>& GetCommandBufferPool() { return objectsPool.commandBuffers; }
 
         FORCEINLINE HandlePool& GetObjectsPool() { return objectsPool; }
 
+        FORCEINLINE MemoryDefragmenter& GetDefragmenter() { return defragmenter; }
+
+        // Runs a defragmentation step at the start of every frame while enabled
+        FORCEINLINE void SetDefragmentation(bool enable, const MemoryDefragmenter::Config& config = MemoryDefragmenter::Config())
+        {
+            defragEnabled = enable;
+            defragConfig = config;
+        }
+
+        FORCEINLINE const DeletionStats& GetDeletionStats() const { return deletionStats; }
+
+        bool IsExtensionEnabled(const char* extension) const;
+
+        // VK_KHR_present_id and VK_KHR_present_wait enabled, presents can be tagged and waited on
+        bool IsPresentWaitSupported() const;
+
+        // VK_EXT_graphics_pipeline_library enabled, graphics pipelines are linked from parts compiled once
+        bool IsGraphicsPipelineLibrarySupported() const;
+
         FORCEINLINE bool IsMemoryInDomain(uint32 typeIndex, MemoryDomain usage) const
         {
             return internal.memoryTypeFlags[typeIndex] & (1 << (uint32)usage);
@@ -426,10 +502,13 @@ namespace Renderer
         RenderContext* renderContext;
 
         MemoryAllocator2 gpuMemoryAllocator;
+        MemoryDefragmenter defragmenter;
+        MemoryDefragmenter::Config defragConfig;
         StagingManager	 stagingManager;
         FenceManager	 fenceManager;
         SemaphoreManager semaphoreManager;
         EventManager	 eventManager;
+        ShaderLibrary	 shaderLibrary;
 
         // RT:
         AsBuilder        acclBuilder;
@@ -443,9 +522,18 @@ namespace Renderer
         PerFrame		perFrame[MAX_FRAMES];
         HandlePool		objectsPool;
 
+        DeletionQueue<DeferredDeletion>  deletionQueue;
+        DeletionQueue<MemoryAllocation>  allocationQueue;
+        DeletionWorker<DeferredDeletion> deletionWorker;
+        std::vector<DeferredDeletion>    readyObjects;
+        std::vector<MemoryAllocation>    readyAllocations;
+        std::vector<VkCommandBuffer>     readyCmdBuffers;
+        DeletionStats                    deletionStats;
+
         uint32 enabledFeatures;
         bool submitSwapchain;
         bool stagingFlush;
+        bool defragEnabled;
 
 		std::unordered_set<uint64> deviceExtensions;
 		std::unordered_set<uint64> availbleDevExtensions;
@@ -456,6 +544,8 @@ namespace Renderer
         friend class Semaphore;
         friend class Fence;
         friend class Swapchain;
+        friend class AsBuilder;
+        friend class Tlas;
 	};
 };
 
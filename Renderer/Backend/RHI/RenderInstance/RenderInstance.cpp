@@ -12,10 +12,11 @@ Renderer::RenderInstance::~RenderInstance()
 
 }
 
-int32 Renderer::RenderInstance::CreateRenderInstance(const char** extensions, uint32 extCount, const char** layers, uint32 layerCount)
+int32 Renderer::RenderInstance::CreateRenderInstance(const char** extensions, uint32 extCount, const char** layers, uint32 layerCount,
+                                                     bool headless)
 {
     int32 err_code; 
-    err_code = CreateInstance(&internal.instance);
+    err_code = CreateInstance(&internal.instance, extensions, extCount, layers, layerCount, headless);
     err_code |= SetupDebugMessenger(internal.instance, &internal.debugMessenger);
     return err_code;
 }
@@ -26,7 +27,8 @@ void Renderer::RenderInstance::DestroyRenderInstance()
     DestroyInstance(internal.instance);
 }
 
-int32 Renderer::RenderInstance::CreateInstance(VkInstance* p_instance, const char** extensions, uint32 extCount, const char** layers, uint32 layerCount)
+int32 Renderer::RenderInstance::CreateInstance(VkInstance* p_instance, const char** extensions, uint32 extCount, const char** layers, uint32 layerCount,
+                                               bool headless)
 {
     ASSERT(p_instance == NULL);
 
@@ -47,8 +49,21 @@ int32 Renderer::RenderInstance::CreateInstance(VkInstance* p_instance, const cha
         instanceExtensions.emplace(h);
     }
 
+    if (!headless) {
+        for (const auto& ext : VK_REQ_SURFACE_EXT) {
+            extensionsArr.PushBack(ext);
+            Hash h = Utils::Data(ext, strlen(ext));
+
+            if (availbleInstExtensions.find(h) == availbleInstExtensions.end()) {
+                TRE_LOGE("Can't load mandatory extension '%s' not supported by VK instance", ext);
+                return -1;
+            }
+
+            instanceExtensions.emplace(h);
+        }
+    }
+
     for (uint32 i = 0; i < extCount; i++) {
-        extensionsArr.PushBack(extensions[i]);
         Hash h = Utils::Data(extensions[i], strlen(extensions[i]));
 
         if (availbleInstExtensions.find(h) == availbleInstExtensions.end()) {
@@ -56,6 +71,7 @@ int32 Renderer::RenderInstance::CreateInstance(VkInstance* p_instance, const cha
             continue;
         }
 
+        extensionsArr.PushBack(extensions[i]);
         instanceExtensions.emplace(h);
     }
 
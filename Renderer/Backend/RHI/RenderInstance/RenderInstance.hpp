@@ -23,7 +23,9 @@ namespace Renderer
 
 		// int32 CreateRenderInstance();
 
-		int32 CreateRenderInstance(const char** extensions = NULL, uint32 extCount = 0, const char** layers = NULL, uint32 layerCount = 0);
+		// Headless instances don't request the window surface extensions
+		int32 CreateRenderInstance(const char** extensions = NULL, uint32 extCount = 0, const char** layers = NULL, uint32 layerCount = 0,
+			bool headless = false);
 
 		void DestroyRenderInstance();
 
@@ -32,7 +34,8 @@ namespace Renderer
 	private:
 		void FetchAvailbleInstanceExtensions();
 
-		int32 CreateInstance(VkInstance* p_instance, const char** extensions = NULL, uint32 extCount = 0, const char** layers = NULL, uint32 layerCount = 0);
+		int32 CreateInstance(VkInstance* p_instance, const char** extensions = NULL, uint32 extCount = 0, const char** layers = NULL, uint32 layerCount = 0,
+			bool headless = false);
 
 		static void DestroyInstance(VkInstance p_instance);
 
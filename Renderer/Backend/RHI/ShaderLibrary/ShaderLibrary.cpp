@@ -0,0 +1,264 @@
+#include "ShaderLibrary.hpp"
+#include <stdio.h>
+#include <filesystem>
+#include <Renderer/Backend/RHI/RenderDevice/RenderDevice.hpp>
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderProgram.hpp>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+
+TRE_NS_START
+
+Renderer::ShaderLibrary::ShaderLibrary(RenderDevice& device) :
+    renderDevice(device), stats{ 0 }, unusedCount(0), dirty(false)
+{
+}
+
+const Renderer::ShaderLibrary::Shader* Renderer::ShaderLibrary::RequestShader(const char* path)
+{
+    return this->RequestShader(InternString(path));
+}
+
+const Renderer::ShaderLibrary::Shader* Renderer::ShaderLibrary::RequestShader(StringId path)
+{
+    const char* pathStr = GetStringInterner().GetCString(path);
+
+    // Stamped before the file is read, a write that lands in between is caught by the next request
+    PathStamp stamp{};
+    const bool stamped = StampFile(pathStr, stamp);
+
+    if (stamped) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto pathIt = paths.find(path.id);
+
+        if (pathIt != paths.end() && pathIt->second.size == stamp.size && pathIt->second.writeTime == stamp.writeTime) {
+            auto shaderIt = shaders.find(pathIt->second.hash);
+
+            if (shaderIt != shaders.end()) {
+                stats.moduleHits++;
+                unusedCount -= shaderIt->second.refCount == 0;
+                shaderIt->second.refCount++;
+                return &shaderIt->second;
+            }
+        }
+    }
+
+    // The mapping is page aligned which satisfies the uint32 alignment SPIR-V requires
+    MappedFile shaderFile(pathStr, MappedFile::HINT_WILLNEED);
+
+    if (!shaderFile.IsOpen()) {
+        TRE_LOGE("Failed to open shader file %s", pathStr);
+        return NULL;
+    }
+
+    const Shader* shader = this->RequestShader(shaderFile.Data(), shaderFile.Size());
+
+    if (shader && stamped) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stamp.hash = shader->hash;
+        paths[path.id] = stamp;
+    }
+
+    return shader;
+}
+
+const Renderer::ShaderLibrary::Shader* Renderer::ShaderLibrary::RequestShader(const void* spirvCode, usize size)
+{
+    if (size % sizeof(uint32)) {
+        TRE_LOGE("Shader code isn't a whole number of SPIR-V words (%llu bytes)", (unsigned long long)size);
+        return NULL;
+    }
+
+    const Hash hash = ShaderReflection::HashCode(spirvCode, size);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Hash key = hash;
+    auto shaderIt = shaders.find(key);
+
+    while (shaderIt != shaders.end() && !shaderIt->second.Matches(spirvCode, size)) {
+        shaderIt = shaders.find(++key);
+    }
+
+    if (shaderIt != shaders.end()) {
+        stats.moduleHits++;
+        unusedCount -= shaderIt->second.refCount == 0;
+        shaderIt->second.refCount++;
+        return &shaderIt->second;
+    }
+
+    // The cache only knows the code by its hash, a shader that collided with another one keeps its own reflection
+    const bool collided = key != hash;
+    auto reflectionIt = reflections.find(hash);
+    ShaderReflection reflection;
+
+    if (!collided && reflectionIt != reflections.end()) {
+        stats.reflectionHits++;
+    } else {
+        if (!reflection.Reflect(spirvCode, size)) {
+            TRE_LOGE("Failed to reflect shader code (hash: %llu)", (unsigned long long)hash);
+            return NULL;
+        }
+
+        stats.reflectionMisses++;
+
+        if (!collided) {
+            reflectionIt = reflections.emplace(hash, std::move(reflection)).first;
+            dirty = true;
+        }
+    }
+
+    stats.moduleMisses++;
+    Shader& shader = shaders[key];
+    shader.hash = key;
+    shader.module = ShaderProgram::CreateShaderModule(renderDevice.GetDevice(), spirvCode, size);
+    shader.ownReflection = std::move(reflection);
+    shader.reflection = collided ? &shader.ownReflection : &reflectionIt->second;
+    shader.refCount = 1;
+    shader.code.assign((const uint32*)spirvCode, (const uint32*)spirvCode + size / sizeof(uint32));
+    return &shader;
+}
+
+bool Renderer::ShaderLibrary::Release(const Shader* shader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = shaders.find(shader->hash);
+
+    if (it == shaders.end() || &it->second != shader || it->second.refCount == 0) {
+        TRE_LOGE("Releasing a shader that isn't referenced (hash: %llu)", (unsigned long long)shader->hash);
+        return false;
+    }
+
+    unusedCount += --it->second.refCount == 0;
+    return true;
+}
+
+bool Renderer::ShaderLibrary::StampFile(const char* path, PathStamp& stamp)
+{
+    std::error_code error;
+    const auto writeTime = std::filesystem::last_write_time(path, error);
+
+    if (error)
+        return false;
+
+    const uintmax_t size = std::filesystem::file_size(path, error);
+
+    if (error)
+        return false;
+
+    stamp.size = (uint64)size;
+    stamp.writeTime = (int64)writeTime.time_since_epoch().count();
+    return true;
+}
+
+void Renderer::ShaderLibrary::Trim()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!unusedCount)
+        return;
+
+    unusedCount = 0;
+
+    for (auto it = shaders.begin(); it != shaders.end();) {
+        if (it->second.refCount == 0) {
+            vkDestroyShaderModule(renderDevice.GetDevice(), it->second.module, NULL);
+            it = shaders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Renderer::ShaderLibrary::Destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& shader : shaders) {
+        vkDestroyShaderModule(renderDevice.GetDevice(), shader.second.module, NULL);
+    }
+
+    shaders.clear();
+    unusedCount = 0;
+}
+
+bool Renderer::ShaderLibrary::LoadReflectionCache(const char* path)
+{
+    MappedFile cacheFile(path, MappedFile::HINT_SEQUENTIAL);
+
+    if (!cacheFile.IsOpen())
+        return false;
+
+    const uint8* cursor = cacheFile.Data();
+    const uint8* end = cursor + cacheFile.Size();
+    uint32 magic, version, count;
+
+    if (!Internal::ReadU32(cursor, end, magic) || !Internal::ReadU32(cursor, end, version) ||
+        magic != CACHE_MAGIC || version != ShaderReflection::CACHE_VERSION || !Internal::ReadU32(cursor, end, count))
+    {
+        TRE_LOGW("Ignoring outdated or invalid shader reflection cache %s", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (uint32 i = 0; i < count; i++) {
+        Hash hash;
+        uint32 size;
+
+        if (usize(end - cursor) < sizeof(Hash))
+            return false;
+
+        memcpy(&hash, cursor, sizeof(Hash));
+        cursor += sizeof(Hash);
+
+        if (!Internal::ReadCount(cursor, end, sizeof(uint8), size))
+            return false;
+
+        // Each entry is size prefixed so a corrupted entry can't desync the ones that follow
+        const uint8* entry = cursor;
+        cursor += size;
+        ShaderReflection reflection;
+
+        if (reflection.Deserialize(entry, cursor)) {
+            reflections.emplace(hash, std::move(reflection));
+        }
+    }
+
+    return true;
+}
+
+bool Renderer::ShaderLibrary::SaveReflectionCache(const char* path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!dirty)
+        return true;
+
+    std::vector<uint8> data;
+    std::vector<uint8> entry;
+    Internal::WriteU32(data, CACHE_MAGIC);
+    Internal::WriteU32(data, ShaderReflection::CACHE_VERSION);
+    Internal::WriteU32(data, (uint32)reflections.size());
+
+    for (const auto& reflection : reflections) {
+        const uint8* hash = (const uint8*)&reflection.first;
+        entry.clear();
+        reflection.second.Serialize(entry);
+
+        data.insert(data.end(), hash, hash + sizeof(Hash));
+        Internal::WriteU32(data, (uint32)entry.size());
+        data.insert(data.end(), entry.begin(), entry.end());
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if (!file) {
+        TRE_LOGW("Could not write shader reflection cache %s", path);
+        return false;
+    }
+
+    const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    dirty = !written;
+    return written;
+}
+
+TRE_NS_END
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+#include <Core/DataStructure/StringInterner.hpp>
+#include <Renderer/Backend/Common.hpp>
+#include <Renderer/Backend/RHI/Common/Globals.hpp>
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderReflection/ShaderReflection.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	class RenderDevice;
+
+	/*
+	 * Device wide store of shader modules keyed by the hash of their SPIR-V. Programs sharing a stage share the
+	 * VkShaderModule, and reflection data is persisted to a small binary cache so that warm starts skip spirv_reflect.
+	 * Modules are ref counted, the device trims the ones no program references anymore once per frame.
+	 * Keys can collide: a module is only shared when its code matches byte for byte, a different shader under a taken
+	 * key moves on to the next free one.
+	 */
+	class RENDERER_API ShaderLibrary
+	{
+	public:
+		CONSTEXPR static uint32 CACHE_MAGIC = 0x43525354; // "TSRC"
+		CONSTEXPR static const char DEFAULT_CACHE_PATH[] = "ShaderReflection.cache";
+
+		struct Shader
+		{
+			Hash hash;
+			VkShaderModule module;
+			const ShaderReflection* reflection;
+			uint32 refCount;
+			std::vector<uint32> code; // Compared on key hits
+			ShaderReflection ownReflection; // Only filled for shaders whose hash collided, the others share the cached one
+
+			bool Matches(const void* spirvCode, usize size) const
+			{
+				return code.size() * sizeof(uint32) == size && !memcmp(code.data(), spirvCode, size);
+			}
+		};
+
+		struct Stats
+		{
+			uint32 moduleHits;
+			uint32 moduleMisses;
+			uint32 reflectionHits;
+			uint32 reflectionMisses;
+		};
+	public:
+		ShaderLibrary(RenderDevice& device);
+
+		ShaderLibrary(const ShaderLibrary&) = delete;
+
+		ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+		// Returns NULL if the file can't be read or isn't valid SPIR-V
+		const Shader* RequestShader(const char* path);
+
+		// Paths whose module is still alive are served without reading the file, as long as its size and last write
+		// time are the ones it was loaded with. A rebuilt shader is loaded again, the old module is trimmed once released.
+		const Shader* RequestShader(StringId path);
+
+		const Shader* RequestShader(const void* spirvCode, usize size);
+
+		// Returns false if the shader doesn't come from this library or isn't referenced anymore
+		bool Release(const Shader* shader);
+
+		// Destroys the modules that are no longer referenced, reflection data is kept for the cache.
+		// Pipelines don't need their modules once created, programs hold their references until they are destroyed.
+		void Trim();
+
+		void Destroy();
+
+		bool LoadReflectionCache(const char* path = DEFAULT_CACHE_PATH);
+
+		// Only writes the file when new shaders were reflected since it was loaded
+		bool SaveReflectionCache(const char* path = DEFAULT_CACHE_PATH);
+
+		FORCEINLINE const Stats& GetStats() const { return stats; }
+	private:
+		struct PathStamp
+		{
+			Hash hash;
+			uint64 size;
+			int64 writeTime;
+		};
+
+		// False when the file can't be stat'ed, the hash is left to the caller
+		static bool StampFile(const char* path, PathStamp& stamp);
+	private:
+		RenderDevice& renderDevice;
+		std::unordered_map<Hash, ShaderReflection> reflections;
+		std::unordered_map<Hash, Shader> shaders; // Node based, pointers handed out stay valid
+		std::unordered_map<uint32, PathStamp> paths; // Interned path to the code last loaded from it
+		std::mutex mutex;
+		Stats stats;
+		uint32 unusedCount; // Modules with no reference left, Trim() has nothing to do while it's 0
+		bool dirty;
+	};
+}
+
+TRE_NS_END
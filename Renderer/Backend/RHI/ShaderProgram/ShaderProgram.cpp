@@ -1,16 +1,15 @@
 #include "ShaderProgram.hpp"
 #include <Renderer/Backend/RHI/Common/Utils.hpp>
 #include <Renderer/Backend/RHI/RenderBackend.hpp>
-#include <Renderer/Backend/RHI/ShaderProgram/ShaderReflect/spirv_reflect.hpp>
 
 TRE_NS_START
 
-VkShaderModule Renderer::ShaderProgram::CreateShaderModule(VkDevice device, const std::vector<char>& code)
+VkShaderModule Renderer::ShaderProgram::CreateShaderModule(VkDevice device, const void* code, usize size)
 {
     VkShaderModule shaderModule;
     VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.codeSize = size;
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code);
 
     if (vkCreateShaderModule(device, &createInfo, NULL, &shaderModule) != VK_SUCCESS) {
         ASSERTF(true, "failed to create shader module!");
@@ -63,130 +62,70 @@ VkRayTracingShaderGroupTypeKHR Renderer::ShaderProgram::SetShaderGroupType(VkRay
     return VkRayTracingShaderGroupTypeKHR(-1);
 }
 
-void Renderer::ShaderProgram::ReflectShaderCode(const void* spirvCode, size_t size, ShaderStages shaderStage,
+void Renderer::ShaderProgram::ApplyReflection(const ShaderReflection& reflection, ShaderStages shaderStage,
     std::unordered_set<uint32>& seenDescriptorSets, std::unordered_map<std::string, VkPushConstantRange>& pushConstants, 
     uint32& oldOffset)
 {
-    // This is equal to -12 and is used due to a weird bug in spvReflect (PATCH) (TODO: investigate)
-    CONSTEXPR uint32 bugPatchDiff = SPV_REFLECT_FORMAT_R64_UINT - SPV_REFLECT_FORMAT_R32_UINT;
-
-    // Generate reflection data for a shader
-    SpvReflectShaderModule module;
-    SpvReflectResult result = spvReflectCreateShaderModule(size, spirvCode, &module);
-    
-    if (result != SPV_REFLECT_RESULT_SUCCESS)
-        return;
-
-    ASSERT(result != SPV_REFLECT_RESULT_SUCCESS);
-
     if (shaderStage == ShaderStages::VERTEX) {
-        // Enumerate and extract shader's input variables
-        uint32_t inputVarCount;
-        spvReflectEnumerateInputVariables(&module, &inputVarCount, NULL);
-        SpvReflectInterfaceVariable** inputVarsReflect = (SpvReflectInterfaceVariable**)malloc(sizeof(SpvReflectInterfaceVariable) * inputVarCount);
-        spvReflectEnumerateInputVariables(&module, &inputVarCount, inputVarsReflect);
-
-        for (uint32 i = 0; i < inputVarCount; i++) {
-            if (inputVarsReflect[i]->location != UINT32_MAX) {
-                printf("Input var: name:%s|location:%d|format:%d\n", inputVarsReflect[i]->name, inputVarsReflect[i]->location, inputVarsReflect[i]->format);
-                vertexInput.AddAttribute(inputVarsReflect[i]->location, (VkFormat)(inputVarsReflect[i]->format - bugPatchDiff));
-            }
+        for (const auto& input : reflection.inputs) {
+            vertexInput.AddAttribute(input.location, (VkFormat)input.format);
         }
-
-        free(inputVarsReflect);
     }
 
-    // Enumerate descriptors:
-    uint32 descSetCount;
-    spvReflectEnumerateDescriptorSets(&module, &descSetCount, NULL);
-    SpvReflectDescriptorSet** descriptorSetsReflect = (SpvReflectDescriptorSet**)malloc(sizeof(SpvReflectDescriptorSet*) * descSetCount);
-    spvReflectEnumerateDescriptorSets(&module, &descSetCount, descriptorSetsReflect);
-
-    for (uint32 i = 0; i < descSetCount; i++) {
-        if (seenDescriptorSets.find(descriptorSetsReflect[i]->set) == seenDescriptorSets.end()) {
-            seenDescriptorSets.emplace(descriptorSetsReflect[i]->set);
+    for (uint32 set : reflection.descriptorSets) {
+        if (seenDescriptorSets.find(set) == seenDescriptorSets.end()) {
+            seenDescriptorSets.emplace(set);
             piplineLayout.AddDescriptorSetLayout();
-            printf("Set : %d -  Binding count: %d\n", descriptorSetsReflect[i]->set, descriptorSetsReflect[i]->binding_count);
-        }
-        
-        for (uint32 j = 0; j < descriptorSetsReflect[i]->binding_count; j++) {
-            SpvReflectDescriptorBinding* bindings = descriptorSetsReflect[i]->bindings[j];
-            DescriptorType descriptorType = (DescriptorType)bindings->descriptor_type;
-            bool isUniform = bindings->descriptor_type == (uint32)DescriptorType::UNIFORM_BUFFER ||
-                                bindings->descriptor_type == (uint32)DescriptorType::STORAGE_BUFFER;
-           
-            if (isUniform && bindings->type_description->type_name && 
-                !strncmp(bindings->type_description->type_name, DYNAMIC_KEYWORD_PREFIX, DYNAMIC_KEYWORD_SIZE)) 
-            {
-                descriptorType = DescriptorType(bindings->descriptor_type + 2);
-            }
-
-            printf("\tSet: %d - Binding: %d - Name: %s - Descriptor type: %d - Count: %d - Description type: %s\n",
-                bindings->set, bindings->binding, bindings->name, descriptorType, bindings->count, bindings->type_description->type_name);
-            piplineLayout.AddBindingToSet(bindings->set, bindings->binding, bindings->count, descriptorType, VK_SHADER_STAGES[shaderStage], NULL);
         }
     }
 
-    // Enumerate push constants:
-    uint32 pushConstCount;
-    spvReflectEnumeratePushConstantBlocks(&module, &pushConstCount, NULL);
-    SpvReflectBlockVariable** pushConstantsReflect = (SpvReflectBlockVariable**)malloc(sizeof(SpvReflectBlockVariable*) * pushConstCount);
-    spvReflectEnumeratePushConstantBlocks(&module, &pushConstCount, pushConstantsReflect);
-
-    for (uint32 i = 0; i < pushConstCount; i++) {
-        const char* typeName = pushConstantsReflect[i]->type_description->type_name;
+    for (const auto& binding : reflection.bindings) {
+        piplineLayout.AddBindingToSet(binding.set, binding.binding, binding.count, (DescriptorType)binding.descriptorType, 
+            VK_SHADER_STAGES[shaderStage], NULL);
+    }
 
+    for (const auto& block : reflection.pushConstants) {
         auto ret = pushConstants.emplace(
-            std::pair<std::string, VkPushConstantRange>{ typeName, 
-            { VkShaderStageFlags(VK_SHADER_STAGES[shaderStage]), pushConstantsReflect[i]->offset, pushConstantsReflect[i]->size } });
+            std::pair<std::string, VkPushConstantRange>{ block.typeName, 
+            { VkShaderStageFlags(VK_SHADER_STAGES[shaderStage]), block.offset, block.size } });
 
         if (!ret.second) {
             ret.first->second.stageFlags |= VK_SHADER_STAGES[shaderStage];
-
-            //printf("\tUpdating Push constant: Type: %s | Stage: %d | Offset: %d | Size: %d\n", 
-            //    pushConstantsReflect[i].type_description->type_name, VK_SHADER_STAGES[shaderStage], 
-            //    ret.first->second.offset, ret.first->second.size);
         } else {
-            ret.first->second.offset += pushConstantsReflect[i]->members->offset;
-            oldOffset += pushConstantsReflect[i]->size;  // TODO: possiblity of patching SPIRV code here to add the offset automatically
-           
-            //printf("\tPush constant: Type: %s | Stage: %d | Offset: %d | Size: %d\n", 
-            //    pushConstantsReflect[i].type_description->type_name, VK_SHADER_STAGES[shaderStage], 
-            //    ret.first->second.offset, ret.first->second.size);
+            oldOffset += block.size;  // TODO: possiblity of patching SPIRV code here to add the offset automatically
         }
     }
-
-    
-    // Destroy the reflection data when no longer required.
-    free(descriptorSetsReflect);
-    free(pushConstantsReflect);
-    spvReflectDestroyShaderModule(&module);
 }
 
 Renderer::ShaderProgram::ShaderProgram(RenderDevice& device, const std::initializer_list<ShaderStage>& shaderStages) :
-    Hashable(), device(device)
+    Hashable(), device(device), valid(true)
 {
     std::unordered_set<uint32> seenDescriptorSets;
     std::unordered_map<std::string, VkPushConstantRange> pushConstants;
+    ShaderLibrary& shaderLibrary = device.GetShaderLibrary();
     uint32 offset = 0;
     Hasher h;
 
     shaderStagesCreateInfo.reserve(MAX_SHADER_STAGES);
-    shaderModules.reserve(MAX_SHADER_STAGES);
+    shaders.reserve(MAX_SHADER_STAGES);
     rtShaderGroups.reserve(MAX_SHADER_STAGES);
 
     for (const auto& shaderStage : shaderStages) {
-        auto shaderCode = TRE::Renderer::ReadShaderFile(shaderStage.path);
+        const ShaderLibrary::Shader* shader = shaderLibrary.RequestShader(shaderStage.pathId);
 
-        shaderModules.emplace_back(CreateShaderModule(device.GetDevice(), shaderCode));
+        if (!shader) {
+            TRE_LOGE("Failed to load shader %s, the program is left without this stage", shaderStage.path);
+            valid = false;
+            continue;
+        }
+
+        shaders.emplace_back(shader);
         shaderStagesCreateInfo.push_back({ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO });
-        auto& currentModule = shaderModules.back();
         auto& currentStage = shaderStagesCreateInfo.back();
-        this->ReflectShaderCode(shaderCode.data(), shaderCode.size(), shaderStage.shaderStage, seenDescriptorSets, pushConstants, offset);
-
+        this->ApplyReflection(*shader->reflection, shaderStage.shaderStage, seenDescriptorSets, pushConstants, offset);
 
         currentStage.stage  = VK_SHADER_STAGES[(uint32)shaderStage.shaderStage];
-        currentStage.module = currentModule;
+        currentStage.module = shader->module;
         currentStage.pName  = shaderStage.entryPoint;
 
         if (shaderStage.shaderStage > END_RASTER) {
@@ -195,7 +134,10 @@ Renderer::ShaderProgram::ShaderProgram(RenderDevice& device, const std::initiali
             currentGroup.type = SetShaderGroupType(currentGroup, shaderStage.shaderStage, (uint32)shaderStagesCreateInfo.size() - 1);
         }
 
-        h.u64(shaderStage.GetHash());
+        // Keyed on the content rather than the path so identical SPIR-V loaded from different files shares pipelines
+        h.u64(shader->hash);
+        h.u64(GetStringInterner().GetHash(shaderStage.entryPointId));
+        h.u32(shaderStage.shaderStage);
     }
 
     for (auto& cts : pushConstants) {
@@ -226,11 +168,11 @@ void Renderer::ShaderProgram::Destroy()
 
 void Renderer::ShaderProgram::DestroyShaderModules()
 {
-    for (auto module : shaderModules) {
-        vkDestroyShaderModule(device.GetDevice(), module, NULL);
+    for (const ShaderLibrary::Shader* shader : shaders) {
+        device.GetShaderLibrary().Release(shader);
     }
 
-    shaderModules.clear();
+    shaders.clear();
 }
 
 TRE_NS_END
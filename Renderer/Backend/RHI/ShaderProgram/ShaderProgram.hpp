@@ -9,6 +9,7 @@
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Renderer/Backend/RHI/Pipeline/PipelineLayout/PipelineLayout.hpp>
 #include <Renderer/Backend/RHI/Pipeline/VertexInput/VertexInput.hpp>
+#include <Renderer/Backend/RHI/ShaderLibrary/ShaderLibrary.hpp>
 
 
 TRE_NS_START
@@ -66,24 +67,29 @@ namespace Renderer
 			VkShaderStageFlagBits(~0),
 		};
 
-		CONSTEXPR static const char DYNAMIC_KEYWORD_PREFIX[]  = "DYNC_";
 		CONSTEXPR static const char DEFAULT_ENTRY_POINT[]	  = "main";
-		CONSTEXPR static uint32 DYNAMIC_KEYWORD_SIZE		  = ARRAY_SIZE(DYNAMIC_KEYWORD_PREFIX) - 1;
 
+		// The path and entry point are interned, the strings passed in don't have to outlive the stage
 		struct ShaderStage
 		{
-			ShaderStage(const char* path, ShaderStages stage, const char* entryPoint = DEFAULT_ENTRY_POINT) : 
-				path(path), entryPoint(entryPoint), shaderStage(stage) {}
+			ShaderStage(const char* path, ShaderStages stage, const char* entryPoint = DEFAULT_ENTRY_POINT) :
+				pathId(InternString(path)), entryPointId(InternString(entryPoint)), shaderStage(stage)
+			{
+				this->path = GetStringInterner().GetCString(pathId);
+				this->entryPoint = GetStringInterner().GetCString(entryPointId);
+			}
 
 			Hash GetHash() const
 			{
 				Hasher h;
-				h.Data(path, strlen(path));
-				h.Data(entryPoint, strlen(entryPoint));
+				h.u64(GetStringInterner().GetHash(pathId));
+				h.u64(GetStringInterner().GetHash(entryPointId));
 				h.u32(shaderStage);
 				return h.Get();
 			}
 
+			StringId pathId;
+			StringId entryPointId;
 			const char* path;
 			const char* entryPoint;
 			ShaderStages shaderStage;
@@ -99,6 +105,10 @@ namespace Renderer
 
 		uint32 GetShadersCount() const { return (uint32)shaderStagesCreateInfo.size(); }
 
+		// False when one of the stages couldn't be loaded, pipelines can't be created from the program then
+		FORCEINLINE bool IsValid() const { return valid; }
+
+		// Drops this program's references to its modules in the device shader library
 		void DestroyShaderModules();
 
 		void Destroy();
@@ -115,21 +125,22 @@ namespace Renderer
 
 		FORCEINLINE uint32 GetShaderGroupsCount() const { return (uint32)rtShaderGroups.size(); }
 
-		static VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code);
+		static VkShaderModule CreateShaderModule(VkDevice device, const void* code, usize size);
 	private:
 		VkPipelineShaderStageCreateInfo* GetShaderStages() { return shaderStagesCreateInfo.data(); }
 
-		void ReflectShaderCode(const void* sprivCode, size_t size, ShaderStages shaderStage, std::unordered_set<uint32>& seenDescriptorSets,
+		void ApplyReflection(const ShaderReflection& reflection, ShaderStages shaderStage, std::unordered_set<uint32>& seenDescriptorSets,
 			std::unordered_map<std::string, VkPushConstantRange>& pushConstants, uint32& oldOffset);
 
 		VkRayTracingShaderGroupTypeKHR SetShaderGroupType(VkRayTracingShaderGroupCreateInfoKHR& group, uint32 stage, uint32 index);
 	private:
         RenderDevice& device;
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStagesCreateInfo;
-		std::vector<VkShaderModule> shaderModules;
+		std::vector<const ShaderLibrary::Shader*> shaders;
 		std::vector<VkRayTracingShaderGroupCreateInfoKHR> rtShaderGroups;
 		PipelineLayout piplineLayout;
 		VertexInput vertexInput;
+		bool valid;
 
 		friend class Pipeline;
 	};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string.h>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Core/DataStructure/Hasher.hpp>
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderReflect/spirv_reflect.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * Everything ShaderProgram needs out of a SPIR-V module: descriptor bindings, push constant blocks and vertex
+	 * inputs. Values are stored with their Vulkan numbering (descriptor types, formats and stage bits) so that
+	 * this header stays free of the Vulkan headers and can be parsed, cached and tested on the CPU alone.
+	 */
+	struct ShaderReflection
+	{
+		CONSTEXPR static uint32 CACHE_VERSION = 2; // The cache is keyed by HashCode, bumped when it changes
+
+		CONSTEXPR static const char DYNAMIC_KEYWORD_PREFIX[] = "DYNC_";
+		CONSTEXPR static uint32 DYNAMIC_KEYWORD_SIZE		 = ARRAY_SIZE(DYNAMIC_KEYWORD_PREFIX) - 1;
+
+		struct Binding
+		{
+			uint32 set;
+			uint32 binding;
+			uint32 count;
+			uint32 descriptorType; // VkDescriptorType, buffers prefixed with DYNC_ are already turned into dynamic ones
+		};
+
+		struct PushConstantBlock
+		{
+			std::string typeName;
+			uint32 offset;
+			uint32 size;
+		};
+
+		struct InputAttribute
+		{
+			uint32 location;
+			uint32 format; // VkFormat
+		};
+
+		uint32 stage = 0; // VkShaderStageFlagBits
+		std::vector<uint32> descriptorSets; // In the order they are declared
+		std::vector<Binding> bindings;
+		std::vector<PushConstantBlock> pushConstants;
+		std::vector<InputAttribute> inputs;
+
+		bool Reflect(const void* spirvCode, usize size);
+
+		void Clear();
+
+		// Compact binary form used by the shader library cache, integers are written in native byte order.
+		void Serialize(std::vector<uint8>& out) const;
+
+		bool Deserialize(const uint8*& cursor, const uint8* end);
+
+		// Content hash of a SPIR-V blob with Utils::Hasher, the size has to be a whole number of words.
+		static uint64 HashCode(const void* spirvCode, usize size);
+	};
+
+	/**************************************************/
+	/*               Public Functions                 */
+	/**************************************************/
+
+	FORCEINLINE bool ShaderReflection::Reflect(const void* spirvCode, usize size)
+	{
+		// The bundled spirv_reflect numbers its formats 12 above VkFormat (TODO: investigate)
+		CONSTEXPR uint32 bugPatchDiff = SPV_REFLECT_FORMAT_R64_UINT - SPV_REFLECT_FORMAT_R32_UINT;
+
+		this->Clear();
+
+		SpvReflectShaderModule module;
+
+		if (spvReflectCreateShaderModule(size, spirvCode, &module) != SPV_REFLECT_RESULT_SUCCESS)
+			return false;
+
+		stage = (uint32)module.shader_stage;
+
+		// Builtins (gl_VertexIndex...) have no location and aren't vertex attributes
+		for (uint32 i = 0; i < module.input_variable_count; i++) {
+			const SpvReflectInterfaceVariable* input = module.input_variables[i];
+
+			if (input->location != UINT32_MAX) {
+				inputs.push_back({ input->location, (uint32)input->format - bugPatchDiff });
+			}
+		}
+
+		for (uint32 i = 0; i < module.descriptor_set_count; i++) {
+			const SpvReflectDescriptorSet& set = module.descriptor_sets[i];
+			descriptorSets.push_back(set.set);
+
+			for (uint32 j = 0; j < set.binding_count; j++) {
+				const SpvReflectDescriptorBinding* binding = set.bindings[j];
+				uint32 descriptorType = (uint32)binding->descriptor_type;
+				const bool isBuffer = binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+									  binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				const char* typeName = binding->type_description ? binding->type_description->type_name : NULL;
+
+				// UNIFORM_BUFFER + 2 = UNIFORM_BUFFER_DYNAMIC, STORAGE_BUFFER + 2 = STORAGE_BUFFER_DYNAMIC
+				if (isBuffer && typeName && !strncmp(typeName, DYNAMIC_KEYWORD_PREFIX, DYNAMIC_KEYWORD_SIZE)) {
+					descriptorType += 2;
+				}
+
+				bindings.push_back({ binding->set, binding->binding, binding->count, descriptorType });
+			}
+		}
+
+		for (uint32 i = 0; i < module.push_constant_block_count; i++) {
+			const SpvReflectBlockVariable& block = module.push_constant_blocks[i];
+			const char* typeName = block.type_description && block.type_description->type_name ? block.type_description->type_name : "";
+			const uint32 memberOffset = block.member_count ? block.members[0].offset : 0;
+
+			pushConstants.push_back({ typeName, block.offset + memberOffset, block.size });
+		}
+
+		spvReflectDestroyShaderModule(&module);
+		return true;
+	}
+
+	FORCEINLINE void ShaderReflection::Clear()
+	{
+		stage = 0;
+		descriptorSets.clear();
+		bindings.clear();
+		pushConstants.clear();
+		inputs.clear();
+	}
+
+	namespace Internal
+	{
+		FORCEINLINE void WriteU32(std::vector<uint8>& out, uint32 value)
+		{
+			const uint8* bytes = (const uint8*)&value;
+			out.insert(out.end(), bytes, bytes + sizeof(uint32));
+		}
+
+		FORCEINLINE bool ReadU32(const uint8*& cursor, const uint8* end, uint32& value)
+		{
+			if (usize(end - cursor) < sizeof(uint32))
+				return false;
+
+			memcpy(&value, cursor, sizeof(uint32));
+			cursor += sizeof(uint32);
+			return true;
+		}
+
+		// Element counts are bounded by what is left in the buffer so that a corrupted file can't trigger huge allocations
+		FORCEINLINE bool ReadCount(const uint8*& cursor, const uint8* end, uint32 elementSize, uint32& count)
+		{
+			return ReadU32(cursor, end, count) && usize(count) * elementSize <= usize(end - cursor);
+		}
+	}
+
+	FORCEINLINE void ShaderReflection::Serialize(std::vector<uint8>& out) const
+	{
+		Internal::WriteU32(out, stage);
+
+		Internal::WriteU32(out, (uint32)descriptorSets.size());
+		for (uint32 set : descriptorSets) {
+			Internal::WriteU32(out, set);
+		}
+
+		Internal::WriteU32(out, (uint32)bindings.size());
+		for (const Binding& binding : bindings) {
+			Internal::WriteU32(out, binding.set);
+			Internal::WriteU32(out, binding.binding);
+			Internal::WriteU32(out, binding.count);
+			Internal::WriteU32(out, binding.descriptorType);
+		}
+
+		Internal::WriteU32(out, (uint32)pushConstants.size());
+		for (const PushConstantBlock& block : pushConstants) {
+			Internal::WriteU32(out, (uint32)block.typeName.size());
+			out.insert(out.end(), block.typeName.begin(), block.typeName.end());
+			Internal::WriteU32(out, block.offset);
+			Internal::WriteU32(out, block.size);
+		}
+
+		Internal::WriteU32(out, (uint32)inputs.size());
+		for (const InputAttribute& input : inputs) {
+			Internal::WriteU32(out, input.location);
+			Internal::WriteU32(out, input.format);
+		}
+	}
+
+	FORCEINLINE bool ShaderReflection::Deserialize(const uint8*& cursor, const uint8* end)
+	{
+		using namespace Internal;
+		uint32 count;
+
+		this->Clear();
+
+		if (!ReadU32(cursor, end, stage) || !ReadCount(cursor, end, sizeof(uint32), count))
+			return false;
+
+		descriptorSets.resize(count);
+		for (uint32& set : descriptorSets) {
+			ReadU32(cursor, end, set);
+		}
+
+		if (!ReadCount(cursor, end, sizeof(uint32) * 4, count))
+			return false;
+
+		bindings.resize(count);
+		for (Binding& binding : bindings) {
+			ReadU32(cursor, end, binding.set);
+			ReadU32(cursor, end, binding.binding);
+			ReadU32(cursor, end, binding.count);
+			ReadU32(cursor, end, binding.descriptorType);
+		}
+
+		if (!ReadCount(cursor, end, sizeof(uint32) * 3, count))
+			return false;
+
+		pushConstants.resize(count);
+		for (PushConstantBlock& block : pushConstants) {
+			uint32 nameSize;
+
+			if (!ReadCount(cursor, end, sizeof(uint8), nameSize))
+				return false;
+
+			block.typeName.assign((const char*)cursor, nameSize);
+			cursor += nameSize;
+
+			if (!ReadU32(cursor, end, block.offset) || !ReadU32(cursor, end, block.size))
+				return false;
+		}
+
+		if (!ReadCount(cursor, end, sizeof(uint32) * 2, count))
+			return false;
+
+		inputs.resize(count);
+		for (InputAttribute& input : inputs) {
+			ReadU32(cursor, end, input.location);
+			ReadU32(cursor, end, input.format);
+		}
+
+		return true;
+	}
+
+	FORCEINLINE uint64 ShaderReflection::HashCode(const void* spirvCode, usize size)
+	{
+		Utils::Hasher h;
+		h.u64(size);
+		h.Data((const uint32*)spirvCode, size);
+		return h.Get();
+	}
+}
+
+TRE_NS_END
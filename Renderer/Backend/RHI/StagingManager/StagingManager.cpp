@@ -192,13 +192,13 @@ namespace Renderer
 		stage->offset += padding;
 
         if ((stage->offset + size) >= (MAX_UPLOAD_BUFFER_SIZE) && !stage->submitted) {
-            printf("FORCED TO FLUSH: %d\n", currentBuffer);
+            TRE_LOGD("Staging buffer %d full, forced to flush", currentBuffer);
             this->Flush();
 		}
 
 		stage = &stagingBuffers[currentBuffer];
         if (stage->submitted) {
-            printf("FORCED TO WAIT %d ... ", currentBuffer);
+            TRE_LOGD("Staging buffer %d still in flight, forced to wait", currentBuffer);
             this->Wait(*stage);
 		}
 
@@ -300,6 +300,63 @@ namespace Renderer
 		stage->offset += size;
 	}
 
+	void StagingManager::Stage(Image& dstImage, const ImageInitialData* levels, uint32 levelCount, uint32 firstLevel)
+	{
+		CONSTEXPR static uint32 MAX_LEVELS = 16;
+		CONSTEXPR static DeviceSize LEVEL_ALIGNMENT = 16; // Multiple of every texel block size and of 4
+
+		const ImageCreateInfo& info = dstImage.GetInfo();
+		ASSERTF(firstLevel + levelCount <= info.levels && levelCount <= MAX_LEVELS, "Levels [%d, %d) out of the %d mip levels",
+			firstLevel, firstLevel + levelCount, info.levels);
+
+		DeviceSize size = 0;
+
+		for (uint32 i = 0; i < levelCount; i++) {
+			size = (size + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT + levels[i].size;
+		}
+
+		if (size > MAX_UPLOAD_BUFFER_SIZE) {
+			ASSERTF(false, "Can't allocate %d MB in GPU transfer buffer", (uint32)(size / (1024 * 1024)));
+		}
+
+		StagingBuffer* stage = &stagingBuffers[currentBuffer];
+		stage->offset = (stage->offset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+
+		if ((stage->offset + size) >= (MAX_UPLOAD_BUFFER_SIZE) && !stage->submitted) {
+            this->Flush();
+		}
+
+		stage = &stagingBuffers[currentBuffer];
+        if (stage->submitted) {
+            this->Wait(*stage);
+		}
+
+		VkBufferImageCopy imageCopies[MAX_LEVELS];
+		DeviceSize levelOffset = stage->offset;
+
+		for (uint32 i = 0; i < levelCount; i++) {
+			levelOffset = (levelOffset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+			memcpy(stage->data + levelOffset, levels[i].data, levels[i].size);
+
+			VkBufferImageCopy& imageCopy = imageCopies[i];
+			imageCopy.bufferOffset = levelOffset;
+			imageCopy.bufferRowLength = 0;
+			imageCopy.bufferImageHeight = 0;
+			const uint32 level = firstLevel + i;
+			imageCopy.imageSubresource = { FormatToAspectMask(info.format), level, 0, 1 };
+			imageCopy.imageOffset = { 0, 0, 0 };
+			imageCopy.imageExtent = { MAX(info.width >> level, 1u), MAX(info.height >> level, 1u), MAX(info.depth >> level, 1u) };
+			levelOffset += levels[i].size;
+		}
+
+		VkCommandBuffer cmd = GetCurrentCmd()->GetApiObject();
+		ChangeImageLayout(cmd, dstImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, firstLevel, levelCount);
+		vkCmdCopyBufferToImage(cmd, stage->apiBuffer, dstImage.apiImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, imageCopies);
+		ChangeImageLayout(cmd, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, info.layout, firstLevel, levelCount);
+
+		stage->offset = levelOffset;
+	}
+
 	void StagingManager::ChangeImageLayout(Image& image, VkImageLayout oldLayout, VkImageLayout newLayout)
 	{
 		StagingBuffer& stage = stagingBuffers[currentBuffer];
@@ -362,7 +419,8 @@ namespace Renderer
 		this->GetBlitCmdBuffer()->ImageBarrier(image, oldLayout, newLayout, srcStage, srcAccess, dstStage, dstAccess);
 	}
 
-	void StagingManager::ChangeImageLayout(VkCommandBuffer cmd, Image& image, VkImageLayout oldLayout, VkImageLayout newLayout)
+	void StagingManager::ChangeImageLayout(VkCommandBuffer cmd, Image& image, VkImageLayout oldLayout, VkImageLayout newLayout,
+		uint32 baseLevel, uint32 levelCount)
 	{
 		VkImageMemoryBarrier barrier{};
 		barrier.sType				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -373,7 +431,8 @@ namespace Renderer
 		barrier.image				= image.GetApiObject();
 		barrier.subresourceRange.aspectMask		= FormatToAspectMask(image.GetInfo().format);
 		barrier.subresourceRange.layerCount		= image.GetInfo().layers;
-		barrier.subresourceRange.levelCount		= image.GetInfo().levels;
+		barrier.subresourceRange.baseMipLevel	= baseLevel;
+		barrier.subresourceRange.levelCount		= levelCount;
 
 		VkPipelineStageFlags sourceStage;
 		VkPipelineStageFlags destinationStage;
@@ -11,6 +11,7 @@ namespace Renderer
 {
 	class Image;
 	class RenderDevice;
+	struct ImageInitialData;
 	class Blas;
 	class Tlas;
 
@@ -45,6 +46,10 @@ namespace Renderer
 
         void Stage(Image& dstImage, const void* data, const DeviceSize size, const DeviceSize alignment = 1);
 
+        // Uploads levels [firstLevel, firstLevel + levelCount) from the given data (largest first), no mips are generated.
+        // Only those levels are transitioned, so resident levels can keep being sampled while others stream in.
+        void Stage(Image& dstImage, const ImageInitialData* levels, uint32 levelCount, uint32 firstLevel = 0);
+
 		void* Stage(const DeviceSize size, const DeviceSize alignment, VkCommandBuffer& commandBuffer, VkBuffer& buffer, DeviceSize& bufferOffset);
 
 		void ChangeImageLayout(Image& image, VkImageLayout oldLayout, VkImageLayout newLayout);
@@ -107,7 +112,8 @@ namespace Renderer
 	private:
 		void PrepareFlush();
 
-		void ChangeImageLayout(VkCommandBuffer cmd, Image& image, VkImageLayout oldLayout, VkImageLayout newLayout);
+		void ChangeImageLayout(VkCommandBuffer cmd, Image& image, VkImageLayout oldLayout, VkImageLayout newLayout,
+			uint32 baseLevel = 0, uint32 levelCount = VK_REMAINING_MIP_LEVELS);
 	private:
         RenderDevice&       renderDevice;
         StagingBuffer       stagingBuffers[NUM_STAGES];
@@ -9,7 +9,7 @@ TRE_NS_START
 
 Renderer::Swapchain::Swapchain(RenderBackend& backend) :
     renderBackend(backend), swapchain(VK_NULL_HANDLE), swapchainData{0},
-    imagesCount(2), framebufferResized(false)
+    imagesCount(2), presentMode(VK_PRESENT_MODE_FIFO_KHR), framebufferResized(false), windowExtent{ 0, 0 }
 {
 }
 
@@ -45,14 +45,14 @@ void Renderer::Swapchain::CreateSwapchain()
     ASSERT(renderBackend.GetRenderDevice().GetDevice() == VK_NULL_HANDLE);
     ASSERT(renderBackend.GetRenderContext().GetSurface() == VK_NULL_HANDLE);
 
-    uint32 width = renderContext.GetWindow()->getSize().x;
-    uint32 height = renderContext.GetWindow()->getSize().y;
+    const Vec2<uint32> windowSize = renderContext.GetWindow()->getLatestSize();
     VkSwapchainKHR oldSwapchain = swapchain;
 
-    swapchainData.swapChainExtent    = VkExtent2D{ width, height };
+    windowExtent                     = VkExtent2D{ windowSize.x, windowSize.y };
+    swapchainData.swapChainExtent    = windowExtent;
     supportDetails                   = QuerySwapchainSupport(renderDevice.GetGPU(), renderContext.GetSurface());
     VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(supportDetails.formats);
-    VkPresentModeKHR presentMode     = ChooseSwapPresentMode(supportDetails.presentModes);
+    presentMode                      = ChooseSwapPresentMode(supportDetails.presentModes, renderContext.GetFramePacing().presentMode);
     VkExtent2D extent                = ChooseSwapExtent(supportDetails.capabilities, swapchainData.swapChainExtent);
     imagesCount                      = supportDetails.capabilities.minImageCount + 1;
 
@@ -104,24 +104,61 @@ void Renderer::Swapchain::CreateSwapchain()
         // CreateCommandPool(renderDevice, ctx);
         // CreateCommandBuffers(renderDevice, ctx);
     } else {
-        vkDestroySwapchainKHR(renderDevice.GetDevice(), oldSwapchain, NULL);
+        // Frames in flight may still render to or present its images
+        retiredSwapchains.push_back({ oldSwapchain, renderContext.GetFrameCount() });
     }
 
     // CreateSwapchainResources();
     CreateSwapchainResources(swapchainData.swapChainImages);
 }
 
+void Renderer::Swapchain::CreateHeadlessSwapchain()
+{
+    RenderDevice& renderDevice = renderBackend.GetRenderDevice();
+    RenderContext& renderContext = renderBackend.GetRenderContext();
+
+    ASSERT(renderDevice.GetDevice() != VK_NULL_HANDLE);
+    ASSERTF(FormatToChannelCount(swapchainData.swapChainImageFormat) == 4, "Headless rendering only supports 8-bit RGBA/BGRA formats!");
+
+    const VkExtent2D& extent = swapchainData.swapChainExtent;
+    const VkFormat format = swapchainData.swapChainImageFormat;
+
+    // One target per frame in flight, the image index then simply follows the frame index
+    imagesCount = renderContext.GetNumFrames();
+
+    // Start in TRANSFER_SRC so that reading back a frame nothing was drawn to is still valid
+    ImageCreateInfo imageInfo = ImageCreateInfo::RenderTarget(extent.width, extent.height, format);
+    imageInfo.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    BufferInfo bufferInfo;
+    bufferInfo.size = (DeviceSize)extent.width * extent.height * FormatToChannelCount(format);
+    bufferInfo.usage = BufferUsage::TRANSFER_DST;
+    bufferInfo.domain = MemoryDomain::CPU_CACHED;
+
+    for (uint32 i = 0; i < imagesCount; i++) {
+        swapchainData.swapchainImages[i] = renderDevice.CreateImage(imageInfo);
+        // Render passes will leave the image ready for the readback copy (like PRESENT_SRC for swapchain images)
+        swapchainData.swapchainImages[i]->SetSwapchainLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        swapchainData.readbackBuffers[i] = renderDevice.CreateBuffer(bufferInfo);
+    }
+
+    CreateSyncObjects();
+}
+
 void Renderer::Swapchain::DestroySwapchain()
 {
     const RenderDevice& renderDevice = renderBackend.GetRenderDevice();
     RenderContext& renderContext = renderBackend.GetRenderContext();
 
     CleanupSwapchain();
+    DestroyRetiredSwapchains(UINT64_MAX);
 
-    vkDestroySwapchainKHR(renderDevice.GetDevice(), swapchain, NULL);
-    swapchain = VK_NULL_HANDLE;
+    if (swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(renderDevice.GetDevice(), swapchain, NULL);
+        swapchain = VK_NULL_HANDLE;
+    }
 
-    for (size_t i = 0; i < renderContext.GetNumFrames(); i++) {
+    for (size_t i = 0; i < MAX_FRAMES; i++) {
         vkDestroySemaphore(renderDevice.GetDevice(), swapchainData.drawCompleteSemaphores[i], NULL);
         vkDestroySemaphore(renderDevice.GetDevice(), swapchainData.imageAcquiredSemaphores[i], NULL);
         vkDestroyFence(renderDevice.GetDevice(), swapchainData.fences[i], NULL);
@@ -138,9 +175,18 @@ void Renderer::Swapchain::DestroySwapchain()
     vkDestroyFence(renderDevice.GetDevice(), swapchainData.transferSyncFence, NULL);
 
     for (uint32 i = 0; i < MAX_IMAGES_COUNT; i++) {
+        // Offscreen images own their memory, clearing the swapchain layout lets the image free it
+        if (renderContext.IsHeadless() && swapchainData.swapchainImages[i]) {
+            swapchainData.swapchainImages[i]->SetSwapchainLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+        }
+
         // deleteing the image handles
         swapchainData.swapchainImages[i] = ImageHandle(NULL);
     }
+
+    for (uint32 i = 0; i < MAX_FRAMES; i++) {
+        swapchainData.readbackBuffers[i] = BufferHandle(NULL);
+    }
 }
 
 void Renderer::Swapchain::CleanupSwapchain()
@@ -161,24 +207,42 @@ void Renderer::Swapchain::CleanupSwapchain()
 
 void Renderer::Swapchain::RecreateSwapchain()
 {
-    const RenderDevice& renderDevice = renderBackend.GetRenderDevice();
-    RenderContext& renderContext = renderBackend.GetRenderContext();
+    const RenderContext& renderContext = renderBackend.GetRenderContext();
+    const Vec2<uint32> windowSize = renderContext.GetWindow()->getLatestSize();
 
-    vkDeviceWaitIdle(renderDevice.GetDevice());
-    CleanupSwapchain();
+    // Minimized: frames go on without presenting until the window has a size again
+    if (windowSize.x == 0 || windowSize.y == 0) {
+        framebufferResized = true;
+        return;
+    }
 
-    uint32 width = renderContext.GetWindow()->getSize().x;
-    uint32 height = renderContext.GetWindow()->getSize().y;
+    CleanupSwapchain();
+    framebufferResized = false;
+    CreateSwapchain();
+}
 
-    while (width == 0 || height == 0) {
-        renderContext.GetWindow()->WaitEvents();
+bool Renderer::Swapchain::IsOutdated() const
+{
+    const Vec2<uint32> windowSize = renderBackend.GetRenderContext().GetWindow()->getLatestSize();
+    return windowSize.x != windowExtent.width || windowSize.y != windowExtent.height;
+}
 
-        width = renderContext.GetWindow()->getSize().x;
-        height = renderContext.GetWindow()->getSize().y;
+void Renderer::Swapchain::DestroyRetiredSwapchains(uint64 frameCount)
+{
+    const RenderDevice& renderDevice = renderBackend.GetRenderDevice();
+    const RenderContext& renderContext = renderBackend.GetRenderContext();
+    uint32 kept = 0;
+
+    // Frames before frameCount - numFrames completed, one more gives the last present of the old images time to end
+    for (const RetiredSwapchain& retired : retiredSwapchains) {
+        if (frameCount == UINT64_MAX || retired.frame + renderContext.GetNumFrames() + 1 <= frameCount) {
+            vkDestroySwapchainKHR(renderDevice.GetDevice(), retired.swapchain, NULL);
+        } else {
+            retiredSwapchains[kept++] = retired;
+        }
     }
 
-    framebufferResized = false;
-    CreateSwapchain();
+    retiredSwapchains.resize(kept);
 }
 
 void Renderer::Swapchain::QueueSwapchainUpdate()
@@ -200,7 +264,8 @@ void Renderer::Swapchain::CreateSyncObjects()
 
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < renderContext.GetNumFrames(); i++) {
+    // For every frame slot, frame pacing can raise the frames in flight later on
+    for (size_t i = 0; i < MAX_FRAMES; i++) {
         vkCreateSemaphore(renderDevice.GetDevice(), &semaphoreInfo, NULL, &swapchainData.imageAcquiredSemaphores[i]);
         vkCreateSemaphore(renderDevice.GetDevice(), &semaphoreInfo, NULL, &swapchainData.drawCompleteSemaphores[i]);
         vkCreateFence(renderDevice.GetDevice(), &fenceInfo, NULL, &swapchainData.fences[i]);
@@ -302,14 +367,21 @@ VkSurfaceFormatKHR Renderer::Swapchain::ChooseSwapSurfaceFormat(const TRE::Vecto
     return availableFormats[0];
 }
 
-VkPresentModeKHR Renderer::Swapchain::ChooseSwapPresentMode(const TRE::Vector<VkPresentModeKHR>& availablePresentModes)
+VkPresentModeKHR Renderer::Swapchain::ChooseSwapPresentMode(const TRE::Vector<VkPresentModeKHR>& availablePresentModes, PresentMode requested)
 {
+    constexpr VkPresentModeKHR modes[] = {
+        VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR
+    };
+
+    const VkPresentModeKHR requestedMode = modes[(uint32)requested];
+
     for (const auto& availablePresentMode : availablePresentModes) {        
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == requestedMode) {
             return availablePresentMode;
         }
     }
-    
+
+    TRE_LOGW("Present mode %d not supported by the surface, falling back to FIFO", requestedMode);
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <vector>
+
 #include <Renderer/Backend/Common.hpp>
 #include <Renderer/Backend/RHI/Common/Globals.hpp>
 #include <Core/DataStructure/Vector.hpp>
 #include <Renderer/Backend/RHI/Images/ImageHelper.hpp>
 #include <Renderer/Backend/RHI/Images/Image.hpp>
+#include <Renderer/Backend/RHI/Buffers/Buffer.hpp>
+#include <Renderer/Backend/RHI/FramePacing/FramePacer.hpp>
 
 TRE_NS_START
 
@@ -44,6 +48,9 @@ namespace Renderer
             // second version
             ImageHandle                     swapchainImages[MAX_IMAGES_COUNT];
 
+            // Headless only: host visible copies of the offscreen images (one per frame in flight)
+            BufferHandle                    readbackBuffers[MAX_FRAMES];
+
             // Depth/Stencil resources:
             VkImage                         depthStencilImage;
             VkImageView                     depthStencilIamgeView;
@@ -67,20 +74,32 @@ namespace Renderer
 
         void CreateSwapchain();
 
+        // Offscreen ring of render targets used in place of the swapchain images when there is no window
+        void CreateHeadlessSwapchain();
+
         void CreateSwapchainResources();
 
         void CreateSwapchainResources(const VkImage* images);
 
         ImageHandle GetSwapchainImage(uint32 i) const;
 
+        FORCEINLINE BufferHandle GetReadbackBuffer(uint32 frame) const { return swapchainData.readbackBuffers[frame]; }
+
         void DestroySwapchain();
 
         void CleanupSwapchain();
 
         void QueueSwapchainUpdate();
 
+        // Doesn't wait on the device, the old swapchain is retired and destroyed once the frames using it are done
         void RecreateSwapchain();
 
+        // The window was resized since the swapchain was created, resize events not polled yet included
+        bool IsOutdated() const;
+
+        // Destroys the swapchains retired long enough before frame frameCount, all of them with UINT64_MAX
+        void DestroyRetiredSwapchains(uint64 frameCount);
+
         void CreateSyncObjects();
 
         void CreateSwapchainRenderPass();
@@ -89,7 +108,8 @@ namespace Renderer
 
         VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const TRE::Vector<VkSurfaceFormatKHR>& availableFormats);
 
-        VkPresentModeKHR ChooseSwapPresentMode(const TRE::Vector<VkPresentModeKHR>& availablePresentModes);
+        // The requested mode when the surface supports it, FIFO otherwise
+        VkPresentModeKHR ChooseSwapPresentMode(const TRE::Vector<VkPresentModeKHR>& availablePresentModes, PresentMode requested);
 
         VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, const VkExtent2D& extent);
 
@@ -108,6 +128,11 @@ namespace Renderer
         FORCEINLINE VkFormat GetFormat() const { return swapchainData.swapChainImageFormat; }
 
         FORCEINLINE bool ResizeRequested() const { return framebufferResized; }
+
+        FORCEINLINE VkPresentModeKHR GetPresentMode() const { return presentMode; }
+
+        // Presents wait for the display's vertical blank
+        FORCEINLINE bool IsVsync() const { return presentMode == VK_PRESENT_MODE_FIFO_KHR || presentMode == VK_PRESENT_MODE_FIFO_RELAXED_KHR; }
     private:
         VkFormat FindSupportedFormat(const std::initializer_list<VkFormat>& candidates, VkImageTiling tiling,
                                      VkFormatFeatureFlags features) const;
@@ -127,9 +152,19 @@ namespace Renderer
         VkSwapchainKHR          swapchain;
         VkRenderPass            renderPass;
         uint32                  imagesCount;
+        VkPresentModeKHR        presentMode;
 
         bool					framebufferResized;
 
+        struct RetiredSwapchain
+        {
+            VkSwapchainKHR swapchain;
+            uint64         frame;   // Last frame that could have used its images
+        };
+
+        std::vector<RetiredSwapchain> retiredSwapchains;
+        VkExtent2D              windowExtent;   // Window size the swapchain was created for
+
         friend class RenderBackend;
         friend class RenderContext;
         friend class RenderDevice;
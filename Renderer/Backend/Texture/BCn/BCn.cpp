@@ -0,0 +1,816 @@
+#include "BCn.hpp"
+#include <math.h>
+#include <string.h>
+#include <utility>
+
+TRE_NS_START
+
+namespace Renderer
+{
+    namespace Internal
+    {
+        CONSTEXPR static uint32 BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        FORCEINLINE int32 ClampInt(int32 v, int32 lo, int32 hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+        FORCEINLINE float ClampFloat(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+        // Endpoints at the extremes of the texels projected on their principal axis (covariance power iteration)
+        template<uint32 N>
+        static void FitPrincipalAxis(const float (*texels)[N], uint32 count, float* e0, float* e1)
+        {
+            float mean[N] = {};
+
+            for (uint32 i = 0; i < count; i++) {
+                for (uint32 c = 0; c < N; c++) {
+                    mean[c] += texels[i][c];
+                }
+            }
+
+            for (uint32 c = 0; c < N; c++) {
+                mean[c] /= float(count);
+            }
+
+            float cov[N][N] = {};
+
+            for (uint32 i = 0; i < count; i++) {
+                for (uint32 a = 0; a < N; a++) {
+                    for (uint32 b = 0; b < N; b++) {
+                        cov[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+                    }
+                }
+            }
+
+            // Power iteration seeded with the covariance row of the channel varying the most, a constant seed such as
+            // (1, 1, 1, 1) is orthogonal to the axis of anti-correlated channels (e.g. color fading as alpha rises)
+            uint32 seed = 0;
+
+            for (uint32 c = 1; c < N; c++) {
+                seed = cov[c][c] > cov[seed][seed] ? c : seed;
+            }
+
+            float axis[N];
+
+            for (uint32 c = 0; c < N; c++) {
+                axis[c] = cov[seed][c];
+            }
+
+            for (uint32 iter = 0; iter < 8; iter++) {
+                float next[N] = {};
+                float norm = 0.f;
+
+                for (uint32 a = 0; a < N; a++) {
+                    for (uint32 b = 0; b < N; b++) {
+                        next[a] += cov[a][b] * axis[b];
+                    }
+
+                    norm = MAX(norm, fabsf(next[a]));
+                }
+
+                if (norm < 1e-6f) {
+                    break;
+                }
+
+                for (uint32 c = 0; c < N; c++) {
+                    axis[c] = next[c] / norm;
+                }
+            }
+
+            float length = 0.f;
+
+            for (uint32 c = 0; c < N; c++) {
+                length += axis[c] * axis[c];
+            }
+
+            length = sqrtf(length);
+            float tMin = 0.f, tMax = 0.f;
+
+            if (length > 1e-6f) {
+                for (uint32 c = 0; c < N; c++) {
+                    axis[c] /= length;
+                }
+
+                tMin = 1e30f;
+                tMax = -1e30f;
+
+                for (uint32 i = 0; i < count; i++) {
+                    float t = 0.f;
+
+                    for (uint32 c = 0; c < N; c++) {
+                        t += (texels[i][c] - mean[c]) * axis[c];
+                    }
+
+                    tMin = MIN(tMin, t);
+                    tMax = MAX(tMax, t);
+                }
+            }
+
+            for (uint32 c = 0; c < N; c++) {
+                e0[c] = ClampFloat(mean[c] + axis[c] * tMin, 0.f, 255.f);
+                e1[c] = ClampFloat(mean[c] + axis[c] * tMax, 0.f, 255.f);
+            }
+        }
+
+        // Solves for the endpoints minimizing sum |(1 - w) e0 + w e1 - x|^2 given each texel's weight, false if singular
+        template<uint32 N>
+        static bool LeastSquaresEndpoints(const float (*texels)[N], const float* weights, uint32 count, float* e0, float* e1)
+        {
+            float aa = 0.f, ab = 0.f, bb = 0.f;
+            float ax[N] = {}, bx[N] = {};
+
+            for (uint32 i = 0; i < count; i++) {
+                const float w = weights[i];
+                const float iw = 1.f - w;
+                aa += iw * iw;
+                ab += iw * w;
+                bb += w * w;
+
+                for (uint32 c = 0; c < N; c++) {
+                    ax[c] += iw * texels[i][c];
+                    bx[c] += w * texels[i][c];
+                }
+            }
+
+            const float det = aa * bb - ab * ab;
+
+            if (fabsf(det) < 1e-6f)
+                return false;
+
+            for (uint32 c = 0; c < N; c++) {
+                e0[c] = ClampFloat((bb * ax[c] - ab * bx[c]) / det, 0.f, 255.f);
+                e1[c] = ClampFloat((aa * bx[c] - ab * ax[c]) / det, 0.f, 255.f);
+            }
+
+            return true;
+        }
+
+        template<uint32 N>
+        FORCEINLINE uint32 SquaredError(const uint8* a, const float* b)
+        {
+            float error = 0.f;
+
+            for (uint32 c = 0; c < N; c++) {
+                const float d = float(a[c]) - b[c];
+                error += d * d;
+            }
+
+            return uint32(error);
+        }
+
+        // BC1 --------------------------------------------------------------------------------------------------------
+
+        FORCEINLINE uint16 PackRGB565(const float* c)
+        {
+            const uint32 r = (uint32)ClampInt(int32(c[0] * 31.f / 255.f + 0.5f), 0, 31);
+            const uint32 g = (uint32)ClampInt(int32(c[1] * 63.f / 255.f + 0.5f), 0, 63);
+            const uint32 b = (uint32)ClampInt(int32(c[2] * 31.f / 255.f + 0.5f), 0, 31);
+            return uint16((r << 11) | (g << 5) | b);
+        }
+
+        FORCEINLINE void UnpackRGB565(uint16 v, int32* c)
+        {
+            const int32 r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+            c[0] = (r << 3) | (r >> 2);
+            c[1] = (g << 2) | (g >> 4);
+            c[2] = (b << 3) | (b >> 2);
+        }
+
+        // Palette as decoded, fourColor selects the c0 > c1 interpretation. Entry 3 of the 3 color mode is transparent black.
+        static void BC1Palette(uint16 q0, uint16 q1, bool fourColor, uint8 (*palette)[4])
+        {
+            int32 c0[3], c1[3];
+            UnpackRGB565(q0, c0);
+            UnpackRGB565(q1, c1);
+
+            for (uint32 c = 0; c < 3; c++) {
+                palette[0][c] = uint8(c0[c]);
+                palette[1][c] = uint8(c1[c]);
+
+                if (fourColor) {
+                    palette[2][c] = uint8((2 * c0[c] + c1[c]) / 3);
+                    palette[3][c] = uint8((c0[c] + 2 * c1[c]) / 3);
+                } else {
+                    palette[2][c] = uint8((c0[c] + c1[c]) / 2);
+                    palette[3][c] = 0;
+                }
+            }
+
+            palette[0][3] = palette[1][3] = palette[2][3] = 255;
+            palette[3][3] = fourColor ? 255 : 0;
+        }
+
+        struct BC1Fit
+        {
+            uint16 q0, q1;
+            uint8 indices[16];
+            uint32 error;
+        };
+
+        static void BC1Evaluate(const float (*colors)[3], uint32 transparentMask, bool fourColor, BC1Fit& fit)
+        {
+            uint8 palette[4][4];
+            BC1Palette(fit.q0, fit.q1, fourColor, palette);
+            const uint32 opaqueEntries = fourColor ? 4 : 3;
+            fit.error = 0;
+
+            for (uint32 i = 0; i < 16; i++) {
+                if (transparentMask & (1u << i)) {
+                    fit.indices[i] = 3;
+                    continue;
+                }
+
+                uint32 best = ~0u;
+
+                for (uint32 p = 0; p < opaqueEntries; p++) {
+                    const uint32 error = SquaredError<3>(palette[p], colors[i]);
+
+                    if (error < best) {
+                        best = error;
+                        fit.indices[i] = uint8(p);
+                    }
+                }
+
+                fit.error += best;
+            }
+        }
+
+        static void BC1Refine(const float (*colors)[3], uint32 transparentMask, bool fourColor, BC1Fit& fit)
+        {
+            CONSTEXPR static float FOUR_COLOR_WEIGHTS[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+            CONSTEXPR static float THREE_COLOR_WEIGHTS[3] = { 0.f, 1.f, 0.5f };
+
+            for (uint32 iter = 0; iter < 2; iter++) {
+                float opaque[16][3];
+                float weights[16];
+                uint32 count = 0;
+
+                for (uint32 i = 0; i < 16; i++) {
+                    if (transparentMask & (1u << i))
+                        continue;
+
+                    memcpy(opaque[count], colors[i], sizeof(float) * 3);
+                    weights[count++] = fourColor ? FOUR_COLOR_WEIGHTS[fit.indices[i]] : THREE_COLOR_WEIGHTS[fit.indices[i]];
+                }
+
+                float e0[3], e1[3];
+
+                if (!LeastSquaresEndpoints<3>(opaque, weights, count, e0, e1))
+                    return;
+
+                BC1Fit candidate;
+                candidate.q0 = PackRGB565(e0);
+                candidate.q1 = PackRGB565(e1);
+                BC1Evaluate(colors, transparentMask, fourColor, candidate);
+
+                if (candidate.error >= fit.error)
+                    return;
+
+                fit = candidate;
+            }
+        }
+
+        FORCEINLINE void WriteBC1(const BC1Fit& fit, bool fourColor, uint8* out)
+        {
+            uint16 q0 = fit.q0, q1 = fit.q1;
+            uint8 indices[16];
+            memcpy(indices, fit.indices, sizeof(indices));
+
+            // The mode is selected by the endpoint order, swapping the endpoints swaps the matching palette entries
+            if (fourColor ? q0 < q1 : q0 > q1) {
+                std::swap(q0, q1);
+
+                for (uint8& index : indices) {
+                    if (index < 2) {
+                        index ^= 1;
+                    } else if (fourColor) {
+                        index ^= 1; // 2 <-> 3
+                    }
+                }
+            } else if (fourColor && q0 == q1) {
+                // Decoded as the 3 color mode, every texel is exactly c0 anyway
+                memset(indices, 0, sizeof(indices));
+            }
+
+            uint32 bits = 0;
+
+            for (uint32 i = 0; i < 16; i++) {
+                bits |= uint32(indices[i]) << (i * 2);
+            }
+
+            out[0] = uint8(q0);
+            out[1] = uint8(q0 >> 8);
+            out[2] = uint8(q1);
+            out[3] = uint8(q1 >> 8);
+            memcpy(out + 4, &bits, sizeof(uint32));
+        }
+
+        // BC4 --------------------------------------------------------------------------------------------------------
+
+        static void BC4Palette(uint8 a0, uint8 a1, uint8* palette)
+        {
+            palette[0] = a0;
+            palette[1] = a1;
+
+            if (a0 > a1) {
+                for (uint32 i = 2; i < 8; i++) {
+                    palette[i] = uint8(((8 - i) * a0 + (i - 1) * a1 + 3) / 7);
+                }
+            } else {
+                for (uint32 i = 2; i < 6; i++) {
+                    palette[i] = uint8(((6 - i) * a0 + (i - 1) * a1 + 2) / 5);
+                }
+
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        static uint32 BC4Evaluate(const uint8* values, uint32 stride, uint8 a0, uint8 a1, uint8* indices)
+        {
+            uint8 palette[8];
+            BC4Palette(a0, a1, palette);
+            uint32 total = 0;
+
+            for (uint32 i = 0; i < 16; i++) {
+                const int32 v = values[i * stride];
+                uint32 best = ~0u;
+
+                for (uint32 p = 0; p < 8; p++) {
+                    const uint32 error = uint32((v - palette[p]) * (v - palette[p]));
+
+                    if (error < best) {
+                        best = error;
+                        indices[i] = uint8(p);
+                    }
+                }
+
+                total += best;
+            }
+
+            return total;
+        }
+
+        // BC7 --------------------------------------------------------------------------------------------------------
+
+        struct BitWriter
+        {
+            uint8* out;
+            uint32 pos = 0;
+
+            FORCEINLINE void Write(uint32 value, uint32 bits)
+            {
+                for (uint32 i = 0; i < bits; i++, pos++) {
+                    if (value & (1u << i)) {
+                        out[pos >> 3] |= uint8(1u << (pos & 7));
+                    }
+                }
+            }
+        };
+
+        struct BitReader
+        {
+            const uint8* in;
+            uint32 pos = 0;
+
+            FORCEINLINE uint32 Read(uint32 bits)
+            {
+                uint32 value = 0;
+
+                for (uint32 i = 0; i < bits; i++, pos++) {
+                    value |= uint32((in[pos >> 3] >> (pos & 7)) & 1) << i;
+                }
+
+                return value;
+            }
+        };
+
+        struct BC7Fit
+        {
+            uint8 q[2][4]; // 7 bit endpoints
+            uint8 p[2];    // p-bits
+            uint8 indices[16];
+            uint32 error;
+        };
+
+        FORCEINLINE void BC7Quantize(const float* e, uint8* q, uint8& pBit)
+        {
+            float bestError = 1e30f;
+
+            for (uint32 p = 0; p < 2; p++) {
+                uint8 candidate[4];
+                float error = 0.f;
+
+                for (uint32 c = 0; c < 4; c++) {
+                    candidate[c] = (uint8)ClampInt(int32((e[c] - float(p)) * 0.5f + 0.5f), 0, 127);
+                    const float d = float((candidate[c] << 1) | p) - e[c];
+                    error += d * d;
+                }
+
+                if (error < bestError) {
+                    bestError = error;
+                    memcpy(q, candidate, 4);
+                    pBit = uint8(p);
+                }
+            }
+        }
+
+        static void BC7Evaluate(const float (*texels)[4], BC7Fit& fit)
+        {
+            uint8 palette[16][4];
+
+            for (uint32 c = 0; c < 4; c++) {
+                const uint32 e0 = (uint32(fit.q[0][c]) << 1) | fit.p[0];
+                const uint32 e1 = (uint32(fit.q[1][c]) << 1) | fit.p[1];
+
+                for (uint32 i = 0; i < 16; i++) {
+                    palette[i][c] = uint8(((64 - BC7_WEIGHTS4[i]) * e0 + BC7_WEIGHTS4[i] * e1 + 32) >> 6);
+                }
+            }
+
+            fit.error = 0;
+
+            for (uint32 i = 0; i < 16; i++) {
+                uint32 best = ~0u;
+
+                for (uint32 p = 0; p < 16; p++) {
+                    const uint32 error = SquaredError<4>(palette[p], texels[i]);
+
+                    if (error < best) {
+                        best = error;
+                        fit.indices[i] = uint8(p);
+                    }
+                }
+
+                fit.error += best;
+            }
+        }
+
+        FORCEINLINE void BC7FitEndpoints(const float (*texels)[4], const float* e0, const float* e1, BC7Fit& fit)
+        {
+            BC7Quantize(e0, fit.q[0], fit.p[0]);
+            BC7Quantize(e1, fit.q[1], fit.p[1]);
+            BC7Evaluate(texels, fit);
+        }
+    }
+
+    void BCn::EncodeBC1Block(const uint8* rgba, uint8* out, bool allowTransparency)
+    {
+        using namespace Internal;
+
+        float colors[16][3];
+        float opaque[16][3];
+        uint32 transparentMask = 0;
+        uint32 opaqueCount = 0;
+
+        for (uint32 i = 0; i < 16; i++) {
+            for (uint32 c = 0; c < 3; c++) {
+                colors[i][c] = rgba[i * 4 + c];
+            }
+
+            if (allowTransparency && rgba[i * 4 + 3] < 128) {
+                transparentMask |= 1u << i;
+            } else {
+                memcpy(opaque[opaqueCount++], colors[i], sizeof(float) * 3);
+            }
+        }
+
+        if (!opaqueCount) {
+            memset(out, 0, 4);
+            memset(out + 4, 0xFF, 4);
+            return;
+        }
+
+        const bool fourColor = transparentMask == 0;
+        float e0[3], e1[3];
+        FitPrincipalAxis<3>(opaque, opaqueCount, e0, e1);
+
+        BC1Fit fit;
+        fit.q0 = PackRGB565(e1);
+        fit.q1 = PackRGB565(e0);
+        BC1Evaluate(colors, transparentMask, fourColor, fit);
+        BC1Refine(colors, transparentMask, fourColor, fit);
+        WriteBC1(fit, fourColor, out);
+    }
+
+    void BCn::EncodeBC4Block(const uint8* values, uint32 stride, uint8* out)
+    {
+        using namespace Internal;
+
+        uint8 minValue = 255, maxValue = 0;
+        uint8 minInner = 255, maxInner = 0; // Ignoring 0 and 255 that the 6 value mode gets for free
+
+        for (uint32 i = 0; i < 16; i++) {
+            const uint8 v = values[i * stride];
+            minValue = MIN(minValue, v);
+            maxValue = MAX(maxValue, v);
+
+            if (v != 0 && v != 255) {
+                minInner = MIN(minInner, v);
+                maxInner = MAX(maxInner, v);
+            }
+        }
+
+        uint8 indices[16], candidate[16];
+        uint8 a0 = maxValue, a1 = minValue;
+        uint32 error = BC4Evaluate(values, stride, a0, a1, indices);
+
+        if (minInner <= maxInner && error) {
+            const uint32 error6 = BC4Evaluate(values, stride, minInner, maxInner, candidate);
+
+            if (error6 < error) {
+                a0 = minInner;
+                a1 = maxInner;
+                memcpy(indices, candidate, sizeof(indices));
+            }
+        }
+
+        uint64 bits = 0;
+
+        for (uint32 i = 0; i < 16; i++) {
+            bits |= uint64(indices[i]) << (i * 3);
+        }
+
+        out[0] = a0;
+        out[1] = a1;
+
+        for (uint32 i = 0; i < 6; i++) {
+            out[2 + i] = uint8(bits >> (i * 8));
+        }
+    }
+
+    void BCn::EncodeBC3Block(const uint8* rgba, uint8* out)
+    {
+        EncodeBC4Block(rgba + 3, 4, out);
+        EncodeBC1Block(rgba, out + 8, false);
+    }
+
+    void BCn::EncodeBC5Block(const uint8* rgba, uint8* out)
+    {
+        EncodeBC4Block(rgba + 0, 4, out);
+        EncodeBC4Block(rgba + 1, 4, out + 8);
+    }
+
+    void BCn::EncodeBC7Block(const uint8* rgba, uint8* out)
+    {
+        using namespace Internal;
+
+        float texels[16][4];
+
+        for (uint32 i = 0; i < 16; i++) {
+            for (uint32 c = 0; c < 4; c++) {
+                texels[i][c] = rgba[i * 4 + c];
+            }
+        }
+
+        float e0[4], e1[4];
+        FitPrincipalAxis<4>(texels, 16, e0, e1);
+
+        BC7Fit fit;
+        BC7FitEndpoints(texels, e0, e1, fit);
+
+        for (uint32 iter = 0; iter < 2 && fit.error; iter++) {
+            float weights[16];
+
+            for (uint32 i = 0; i < 16; i++) {
+                weights[i] = BC7_WEIGHTS4[fit.indices[i]] / 64.f;
+            }
+
+            if (!LeastSquaresEndpoints<4>(texels, weights, 16, e0, e1))
+                break;
+
+            BC7Fit candidate;
+            BC7FitEndpoints(texels, e0, e1, candidate);
+
+            if (candidate.error >= fit.error)
+                break;
+
+            fit = candidate;
+        }
+
+        // The anchor texel stores 3 index bits, its index must be below 8
+        if (fit.indices[0] & 8) {
+            std::swap(fit.q[0], fit.q[1]);
+            std::swap(fit.p[0], fit.p[1]);
+
+            for (uint8& index : fit.indices) {
+                index = uint8(15 - index);
+            }
+        }
+
+        memset(out, 0, 16);
+        BitWriter writer{ out };
+        writer.Write(1u << 6, 7); // Mode 6
+
+        for (uint32 c = 0; c < 4; c++) {
+            writer.Write(fit.q[0][c], 7);
+            writer.Write(fit.q[1][c], 7);
+        }
+
+        writer.Write(fit.p[0], 1);
+        writer.Write(fit.p[1], 1);
+        writer.Write(fit.indices[0], 3);
+
+        for (uint32 i = 1; i < 16; i++) {
+            writer.Write(fit.indices[i], 4);
+        }
+    }
+
+    void BCn::DecodeBC1Block(const uint8* block, uint8* rgba, bool allowTransparency)
+    {
+        const uint16 q0 = uint16(block[0] | (block[1] << 8));
+        const uint16 q1 = uint16(block[2] | (block[3] << 8));
+        uint32 bits;
+        memcpy(&bits, block + 4, sizeof(uint32));
+
+        uint8 palette[4][4];
+        Internal::BC1Palette(q0, q1, !allowTransparency || q0 > q1, palette);
+
+        for (uint32 i = 0; i < 16; i++) {
+            memcpy(rgba + i * 4, palette[(bits >> (i * 2)) & 3], 4);
+        }
+    }
+
+    void BCn::DecodeBC4Block(const uint8* block, uint8* values, uint32 stride)
+    {
+        uint8 palette[8];
+        Internal::BC4Palette(block[0], block[1], palette);
+        uint64 bits = 0;
+
+        for (uint32 i = 0; i < 6; i++) {
+            bits |= uint64(block[2 + i]) << (i * 8);
+        }
+
+        for (uint32 i = 0; i < 16; i++) {
+            values[i * stride] = palette[(bits >> (i * 3)) & 7];
+        }
+    }
+
+    void BCn::DecodeBC3Block(const uint8* block, uint8* rgba)
+    {
+        DecodeBC1Block(block + 8, rgba, false);
+        DecodeBC4Block(block, rgba + 3, 4);
+    }
+
+    void BCn::DecodeBC5Block(const uint8* block, uint8* rgba)
+    {
+        DecodeBC4Block(block, rgba + 0, 4);
+        DecodeBC4Block(block + 8, rgba + 1, 4);
+
+        for (uint32 i = 0; i < 16; i++) {
+            rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    bool BCn::DecodeBC7Block(const uint8* block, uint8* rgba)
+    {
+        if ((block[0] & 0x7F) != (1u << 6)) {
+            memset(rgba, 0, 64);
+            return false;
+        }
+
+        Internal::BitReader reader{ block, 7 };
+        uint32 e[2][4];
+
+        for (uint32 c = 0; c < 4; c++) {
+            e[0][c] = reader.Read(7);
+            e[1][c] = reader.Read(7);
+        }
+
+        const uint32 p0 = reader.Read(1);
+        const uint32 p1 = reader.Read(1);
+
+        for (uint32 c = 0; c < 4; c++) {
+            e[0][c] = (e[0][c] << 1) | p0;
+            e[1][c] = (e[1][c] << 1) | p1;
+        }
+
+        for (uint32 i = 0; i < 16; i++) {
+            const uint32 w = Internal::BC7_WEIGHTS4[reader.Read(i == 0 ? 3 : 4)];
+
+            for (uint32 c = 0; c < 4; c++) {
+                rgba[i * 4 + c] = uint8(((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6);
+            }
+        }
+
+        return true;
+    }
+
+    bool BCn::CompressImage(const TextureImage& image, TextureFormat format, std::vector<uint8>& out)
+    {
+        if (!IsBlockCompressed(format))
+            return false;
+
+        const uint32 blocksX = (image.width + 3) / 4;
+        const uint32 blocksY = (image.height + 3) / 4;
+        const uint32 blockSize = GetFormatBlockSize(format);
+        out.resize(usize(blocksX) * blocksY * blockSize);
+
+        uint8 texels[64];
+        uint8* dst = out.data();
+
+        for (uint32 by = 0; by < blocksY; by++) {
+            for (uint32 bx = 0; bx < blocksX; bx++, dst += blockSize) {
+                for (uint32 y = 0; y < 4; y++) {
+                    const uint32 sy = MIN(by * 4 + y, image.height - 1);
+
+                    for (uint32 x = 0; x < 4; x++) {
+                        const uint32 sx = MIN(bx * 4 + x, image.width - 1);
+                        memcpy(texels + (y * 4 + x) * 4, image.pixels.data() + (usize(sy) * image.width + sx) * 4, 4);
+                    }
+                }
+
+                switch (format) {
+                case TextureFormat::BC1_RGBA_UNORM:
+                case TextureFormat::BC1_RGBA_SRGB:
+                    EncodeBC1Block(texels, dst);
+                    break;
+                case TextureFormat::BC3_UNORM:
+                case TextureFormat::BC3_SRGB:
+                    EncodeBC3Block(texels, dst);
+                    break;
+                case TextureFormat::BC4_UNORM:
+                    EncodeBC4Block(texels, 4, dst);
+                    break;
+                case TextureFormat::BC5_UNORM:
+                    EncodeBC5Block(texels, dst);
+                    break;
+                default:
+                    EncodeBC7Block(texels, dst);
+                    break;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool BCn::DecompressImage(const uint8* data, uint32 width, uint32 height, TextureFormat format, TextureImage& out)
+    {
+        if (!IsBlockCompressed(format))
+            return false;
+
+        const uint32 blocksX = (width + 3) / 4;
+        const uint32 blocksY = (height + 3) / 4;
+        const uint32 blockSize = GetFormatBlockSize(format);
+        bool valid = true;
+        uint8 texels[64];
+        out.Resize(width, height);
+
+        for (uint32 by = 0; by < blocksY; by++) {
+            for (uint32 bx = 0; bx < blocksX; bx++, data += blockSize) {
+                switch (format) {
+                case TextureFormat::BC1_RGBA_UNORM:
+                case TextureFormat::BC1_RGBA_SRGB:
+                    DecodeBC1Block(data, texels);
+                    break;
+                case TextureFormat::BC3_UNORM:
+                case TextureFormat::BC3_SRGB:
+                    DecodeBC3Block(data, texels);
+                    break;
+                case TextureFormat::BC4_UNORM:
+                    memset(texels, 0, sizeof(texels));
+                    DecodeBC4Block(data, texels, 4);
+                    break;
+                case TextureFormat::BC5_UNORM:
+                    DecodeBC5Block(data, texels);
+                    break;
+                default:
+                    valid &= DecodeBC7Block(data, texels);
+                    break;
+                }
+
+                for (uint32 y = 0; y < 4 && by * 4 + y < height; y++) {
+                    for (uint32 x = 0; x < 4 && bx * 4 + x < width; x++) {
+                        memcpy(out.pixels.data() + (usize(by * 4 + y) * width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+                    }
+                }
+            }
+        }
+
+        return valid;
+    }
+
+    double BCn::ComputePSNR(const TextureImage& a, const TextureImage& b, uint32 channelMask)
+    {
+        ASSERTF(a.width == b.width && a.height == b.height, "Comparing images of different sizes");
+
+        double squaredError = 0.0;
+        usize samples = 0;
+
+        for (usize i = 0; i < a.pixels.size(); i++) {
+            if (channelMask & (1u << (i & 3))) {
+                const double d = double(a.pixels[i]) - double(b.pixels[i]);
+                squaredError += d * d;
+                samples++;
+            }
+        }
+
+        if (squaredError == 0.0 || !samples)
+            return HUGE_VAL;
+
+        return 10.0 * log10(255.0 * 255.0 / (squaredError / double(samples)));
+    }
+}
+
+TRE_NS_END
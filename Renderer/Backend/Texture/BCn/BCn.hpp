@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Texture/TextureFormat.hpp>
+#include <Renderer/Backend/Texture/MipChain/MipChain.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * CPU block compression. Blocks are 4x4 RGBA8 texels in row major order (64 bytes).
+	 * - BC1: principal axis fit refined by least squares, 3 color + transparent mode when a texel has alpha < 128.
+	 * - BC3: BC1 color (always 4 color mode) and a BC4 alpha block.
+	 * - BC4/BC5: best of the 8 and 6 (+0/255) value modes on the single channel(s), BC5 uses red and green.
+	 * - BC7: mode 6 only (one subset, RGBA 7.7.7.7 endpoints with p-bits, 4 bit indices). It's the mode that
+	 *   handles smooth gradients and alpha best, partitioned modes are left out to keep encoding fast.
+	 * Decoders exist for every encoded format so that quality can be measured, the BC7 decoder only supports mode 6.
+	 */
+	namespace BCn
+	{
+		CONSTEXPR static uint32 BLOCK_TEXELS = 16;
+
+		void EncodeBC1Block(const uint8* rgba, uint8* out, bool allowTransparency = true);
+
+		void EncodeBC3Block(const uint8* rgba, uint8* out);
+
+		// values are read with the given stride, so a channel of an RGBA block can be encoded in place
+		void EncodeBC4Block(const uint8* values, uint32 stride, uint8* out);
+
+		void EncodeBC5Block(const uint8* rgba, uint8* out);
+
+		void EncodeBC7Block(const uint8* rgba, uint8* out);
+
+		void DecodeBC1Block(const uint8* block, uint8* rgba, bool allowTransparency = true);
+
+		void DecodeBC3Block(const uint8* block, uint8* rgba);
+
+		void DecodeBC4Block(const uint8* block, uint8* values, uint32 stride);
+
+		void DecodeBC5Block(const uint8* block, uint8* rgba);
+
+		// Returns false (and black texels) for modes other than 6
+		bool DecodeBC7Block(const uint8* block, uint8* rgba);
+
+		// Texels past the image edges are clamped to the last row/column. out is resized to the level size.
+		bool CompressImage(const TextureImage& image, TextureFormat format, std::vector<uint8>& out);
+
+		bool DecompressImage(const uint8* data, uint32 width, uint32 height, TextureFormat format, TextureImage& out);
+
+		// Peak signal to noise ratio over the channels selected in channelMask (bit 0 = R ... bit 3 = A), in dB
+		double ComputePSNR(const TextureImage& a, const TextureImage& b, uint32 channelMask = 0xF);
+	}
+}
+
+TRE_NS_END
@@ -0,0 +1,288 @@
+#include "KTX2.hpp"
+#include <string.h>
+
+TRE_NS_START
+
+namespace Renderer
+{
+    namespace Internal
+    {
+        CONSTEXPR static usize KTX2_HEADER_SIZE = 80; // Identifier, header and index
+        CONSTEXPR static usize KTX2_LEVEL_INDEX_SIZE = 24;
+
+        // Khronos data format descriptor values
+        CONSTEXPR static uint8 KHR_DF_MODEL_RGBSDA = 1;
+        CONSTEXPR static uint8 KHR_DF_MODEL_BC1A = 128;
+        CONSTEXPR static uint8 KHR_DF_MODEL_BC3 = 130;
+        CONSTEXPR static uint8 KHR_DF_MODEL_BC4 = 131;
+        CONSTEXPR static uint8 KHR_DF_MODEL_BC5 = 132;
+        CONSTEXPR static uint8 KHR_DF_MODEL_BC7 = 134;
+        CONSTEXPR static uint8 KHR_DF_PRIMARIES_BT709 = 1;
+        CONSTEXPR static uint8 KHR_DF_TRANSFER_LINEAR = 1;
+        CONSTEXPR static uint8 KHR_DF_TRANSFER_SRGB = 2;
+        CONSTEXPR static uint8 KHR_DF_SAMPLE_LINEAR = 0x10;
+
+        struct DfdSample
+        {
+            uint16 bitOffset;
+            uint8 bitLength;
+            uint8 channel;
+            uint32 upper;
+        };
+
+        FORCEINLINE void Write32(std::vector<uint8>& out, uint32 value)
+        {
+            const uint8 bytes[4] = { uint8(value), uint8(value >> 8), uint8(value >> 16), uint8(value >> 24) };
+            out.insert(out.end(), bytes, bytes + 4);
+        }
+
+        FORCEINLINE void Write64(std::vector<uint8>& out, uint64 value)
+        {
+            Write32(out, uint32(value));
+            Write32(out, uint32(value >> 32));
+        }
+
+        FORCEINLINE void Patch64(std::vector<uint8>& out, usize at, uint64 value)
+        {
+            for (uint32 i = 0; i < 8; i++) {
+                out[at + i] = uint8(value >> (i * 8));
+            }
+        }
+
+        FORCEINLINE uint32 Read32(const uint8* data)
+        {
+            return uint32(data[0]) | (uint32(data[1]) << 8) | (uint32(data[2]) << 16) | (uint32(data[3]) << 24);
+        }
+
+        FORCEINLINE uint64 Read64(const uint8* data)
+        {
+            return uint64(Read32(data)) | (uint64(Read32(data + 4)) << 32);
+        }
+
+        static void WriteDataFormatDescriptor(std::vector<uint8>& out, TextureFormat format, bool supercompressed)
+        {
+            DfdSample samples[4];
+            uint32 sampleCount = 1;
+            uint8 model = KHR_DF_MODEL_RGBSDA;
+            const uint32 blockSize = GetFormatBlockSize(format);
+
+            switch (format) {
+            case TextureFormat::BC1_RGBA_UNORM:
+            case TextureFormat::BC1_RGBA_SRGB:
+                model = KHR_DF_MODEL_BC1A;
+                samples[0] = { 0, 63, 1, ~0u }; // Alpha present
+                break;
+            case TextureFormat::BC3_UNORM:
+            case TextureFormat::BC3_SRGB:
+                model = KHR_DF_MODEL_BC3;
+                samples[0] = { 0, 63, 15 | KHR_DF_SAMPLE_LINEAR, ~0u };
+                samples[1] = { 64, 63, 0, ~0u };
+                sampleCount = 2;
+                break;
+            case TextureFormat::BC4_UNORM:
+                model = KHR_DF_MODEL_BC4;
+                samples[0] = { 0, 63, 0, ~0u };
+                break;
+            case TextureFormat::BC5_UNORM:
+                model = KHR_DF_MODEL_BC5;
+                samples[0] = { 0, 63, 0, ~0u };
+                samples[1] = { 64, 63, 1, ~0u };
+                sampleCount = 2;
+                break;
+            case TextureFormat::BC7_UNORM:
+            case TextureFormat::BC7_SRGB:
+                model = KHR_DF_MODEL_BC7;
+                samples[0] = { 0, 127, 0, ~0u };
+                break;
+            default:
+                samples[0] = { 0, 7, 0, 255 };
+                samples[1] = { 8, 7, 1, 255 };
+                samples[2] = { 16, 7, 2, 255 };
+                samples[3] = { 24, 7, 15 | KHR_DF_SAMPLE_LINEAR, 255 };
+                sampleCount = 4;
+                break;
+            }
+
+            const uint32 blockDescriptorSize = 24 + 16 * sampleCount;
+            const uint8 dimension = IsBlockCompressed(format) ? 3 : 0;
+
+            Write32(out, 4 + blockDescriptorSize); // dfdTotalSize
+            Write32(out, 0);                       // Khronos vendor, basic descriptor type
+            Write32(out, 2 | (blockDescriptorSize << 16));
+
+            const uint8 block[16] = {
+                model, KHR_DF_PRIMARIES_BT709, IsSrgb(format) ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR, 0,
+                dimension, dimension, 0, 0,
+                uint8(supercompressed ? 0 : blockSize), 0, 0, 0, 0, 0, 0, 0,
+            };
+            out.insert(out.end(), block, block + sizeof(block));
+
+            for (uint32 i = 0; i < sampleCount; i++) {
+                const DfdSample& sample = samples[i];
+                uint8 channel = sample.channel;
+
+                // Alpha is the only linear channel of sRGB formats, the qualifier is meaningless otherwise
+                if (!IsSrgb(format)) {
+                    channel = uint8(channel & ~KHR_DF_SAMPLE_LINEAR);
+                }
+
+                const uint8 header[8] = { uint8(sample.bitOffset), uint8(sample.bitOffset >> 8), sample.bitLength, channel, 0, 0, 0, 0 };
+                out.insert(out.end(), header, header + sizeof(header));
+                Write32(out, 0);
+                Write32(out, sample.upper);
+            }
+        }
+
+        FORCEINLINE bool IsSupportedFormat(uint32 vkFormat)
+        {
+            switch ((TextureFormat)vkFormat) {
+            case TextureFormat::RGBA8_UNORM:
+            case TextureFormat::RGBA8_SRGB:
+            case TextureFormat::BC1_RGBA_UNORM:
+            case TextureFormat::BC1_RGBA_SRGB:
+            case TextureFormat::BC3_UNORM:
+            case TextureFormat::BC3_SRGB:
+            case TextureFormat::BC4_UNORM:
+            case TextureFormat::BC5_UNORM:
+            case TextureFormat::BC7_UNORM:
+            case TextureFormat::BC7_SRGB:
+                return true;
+            default:
+                return false;
+            }
+        }
+    }
+
+    bool KTX2::Write(const CookedTexture& texture, std::vector<uint8>& out, const SupercompressionCodec* codec)
+    {
+        using namespace Internal;
+
+        const uint32 levelCount = (uint32)texture.levels.size();
+
+        if (!levelCount || !IsSupportedFormat((uint32)texture.format))
+            return false;
+
+        const Supercompression scheme = codec ? codec->scheme : Supercompression::NONE;
+        out.clear();
+        out.insert(out.end(), IDENTIFIER, IDENTIFIER + sizeof(IDENTIFIER));
+        Write32(out, (uint32)texture.format);
+        Write32(out, 1); // typeSize
+        Write32(out, texture.width);
+        Write32(out, texture.height);
+        Write32(out, 0); // pixelDepth
+        Write32(out, 0); // layerCount
+        Write32(out, 1); // faceCount
+        Write32(out, levelCount);
+        Write32(out, (uint32)scheme);
+
+        const usize dfdOffset = KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_INDEX_SIZE;
+        std::vector<uint8> dfd;
+        WriteDataFormatDescriptor(dfd, texture.format, scheme != Supercompression::NONE);
+
+        Write32(out, (uint32)dfdOffset);
+        Write32(out, (uint32)dfd.size());
+        Write32(out, 0); // kvdByteOffset
+        Write32(out, 0); // kvdByteLength
+        Write64(out, 0); // sgdByteOffset
+        Write64(out, 0); // sgdByteLength
+
+        const usize levelIndex = out.size();
+        out.resize(out.size() + levelCount * KTX2_LEVEL_INDEX_SIZE);
+        out.insert(out.end(), dfd.begin(), dfd.end());
+
+        // lcm(block size, 4) is the block size itself for every supported format
+        const usize alignment = scheme == Supercompression::NONE ? GetFormatBlockSize(texture.format) : 1;
+        std::vector<uint8> compressed;
+
+        for (uint32 i = levelCount; i-- > 0;) {
+            const CookedTexture::Level& level = texture.levels[i];
+            const uint8* src = texture.data.data() + level.offset;
+            usize size = level.size;
+
+            if (codec) {
+                compressed.clear();
+
+                if (!codec->compress(src, level.size, compressed))
+                    return false;
+
+                src = compressed.data();
+                size = compressed.size();
+            }
+
+            out.resize((out.size() + alignment - 1) / alignment * alignment);
+            const usize entry = levelIndex + i * KTX2_LEVEL_INDEX_SIZE;
+            Patch64(out, entry, out.size());
+            Patch64(out, entry + 8, size);
+            Patch64(out, entry + 16, level.size);
+            out.insert(out.end(), src, src + size);
+        }
+
+        return true;
+    }
+
+    bool KTX2::Read(const uint8* data, usize size, CookedTexture& out, const SupercompressionCodec* codec)
+    {
+        using namespace Internal;
+
+        if (size < KTX2_HEADER_SIZE || memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+            return false;
+
+        const uint8* header = data + sizeof(IDENTIFIER);
+        const uint32 vkFormat = Read32(header);
+        const uint32 width = Read32(header + 8);
+        const uint32 height = Read32(header + 12);
+        const uint32 depth = Read32(header + 16);
+        const uint32 layers = Read32(header + 20);
+        const uint32 faces = Read32(header + 24);
+        const uint32 levelCount = MAX(Read32(header + 28), 1u);
+        const Supercompression scheme = (Supercompression)Read32(header + 32);
+
+        if (!IsSupportedFormat(vkFormat) || !width || !height || depth > 1 || layers > 1 || faces != 1)
+            return false;
+
+        if (scheme != Supercompression::NONE && (!codec || codec->scheme != scheme))
+            return false;
+
+        if (levelCount > GetMipLevelCount(width, height) || size < KTX2_HEADER_SIZE + usize(levelCount) * KTX2_LEVEL_INDEX_SIZE)
+            return false;
+
+        out.format = (TextureFormat)vkFormat;
+        out.width = width;
+        out.height = height;
+        out.levels.resize(levelCount);
+        out.data.clear();
+
+        std::vector<uint8> decompressed;
+
+        for (uint32 i = 0; i < levelCount; i++) {
+            const uint8* entry = data + KTX2_HEADER_SIZE + i * KTX2_LEVEL_INDEX_SIZE;
+            const uint64 offset = Read64(entry);
+            const uint64 length = Read64(entry + 8);
+            const uint64 uncompressedLength = Read64(entry + 16);
+            const usize expected = GetTextureLevelSize(out.format, out.GetLevelWidth(i), out.GetLevelHeight(i));
+
+            if (offset > size || length > size - offset || uncompressedLength != expected)
+                return false;
+
+            const uint8* src = data + offset;
+
+            if (scheme != Supercompression::NONE) {
+                decompressed.clear();
+
+                if (!codec->decompress(src, (usize)length, expected, decompressed) || decompressed.size() != expected)
+                    return false;
+
+                src = decompressed.data();
+            } else if (length != expected) {
+                return false;
+            }
+
+            out.levels[i] = { out.data.size(), expected };
+            out.data.insert(out.data.end(), src, src + expected);
+        }
+
+        return true;
+    }
+}
+
+TRE_NS_END
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Texture/TextureFormat.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * KTX 2.0 container (2D, single layer and face) holding a CookedTexture. The writer emits the basic data format
+	 * descriptor matching the format and no key/value data, mip levels are laid out smallest first as the spec requires.
+	 * Supercompression goes through a codec provided by the caller so that the engine doesn't depend on zstd/zlib,
+	 * each level is compressed on its own.
+	 */
+	namespace KTX2
+	{
+		enum class Supercompression : uint32
+		{
+			NONE	 = 0,
+			BASIS_LZ = 1,
+			ZSTD	 = 2,
+			ZLIB	 = 3,
+		};
+
+		struct SupercompressionCodec
+		{
+			Supercompression scheme;
+			bool (*compress)(const uint8* src, usize size, std::vector<uint8>& out);
+			bool (*decompress)(const uint8* src, usize size, usize uncompressedSize, std::vector<uint8>& out);
+		};
+
+		CONSTEXPR static uint8 IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		// codec may be NULL to store the levels as is
+		bool Write(const CookedTexture& texture, std::vector<uint8>& out, const SupercompressionCodec* codec = NULL);
+
+		// Fails on malformed files, unsupported formats or when the file is supercompressed with another scheme than the codec's
+		bool Read(const uint8* data, usize size, CookedTexture& out, const SupercompressionCodec* codec = NULL);
+	}
+}
+
+TRE_NS_END
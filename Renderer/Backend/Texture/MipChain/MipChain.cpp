@@ -0,0 +1,338 @@
+#include "MipChain.hpp"
+#include <math.h>
+#include <string.h>
+#include <Legacy/Misc/Defines/PlatformSIMDInclude.hpp>
+
+#if SIMD_SUPPORTED_LEVEL >= SIMD_LEVEL_x86_SSE2 && (CPU_ARCH == CPU_ARCH_x86_64 || CPU_ARCH == CPU_ARCH_x86)
+    #include <emmintrin.h>
+    #define TRE_MIPS_SSE2
+#endif
+
+TRE_NS_START
+
+namespace Renderer
+{
+    namespace Internal
+    {
+        // Buckets of 256 per power of two over [2^-13, 1), no bucket straddles more than one code threshold
+        CONSTEXPR static uint32 SRGB_BUCKET_MIN_BITS = 0x39000000; // 2^-13, below the first threshold
+        CONSTEXPR static uint32 SRGB_BUCKET_SHIFT = 15;
+        CONSTEXPR static uint32 SRGB_BUCKET_COUNT = 13 << 8;
+        CONSTEXPR static float SRGB_MIN_LINEAR = 1.f / 8192.f;
+        CONSTEXPR static float SRGB_MAX_LINEAR = 0.99999994f;
+
+        struct SrgbTables
+        {
+            float toLinear[256];
+            float thresholds[256]; // Midpoints between consecutive decoded values, the last one is never reached
+            uint8 buckets[SRGB_BUCKET_COUNT]; // Code of the first value of each bucket
+
+            SrgbTables()
+            {
+                for (uint32 i = 0; i < 256; i++) {
+                    const float c = i / 255.f;
+                    toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+                }
+
+                for (uint32 i = 0; i < 255; i++) {
+                    thresholds[i] = (toLinear[i] + toLinear[i + 1]) * 0.5f;
+                }
+
+                thresholds[255] = 2.f;
+                uint32 code = 0;
+
+                for (uint32 i = 0; i < SRGB_BUCKET_COUNT; i++) {
+                    float start;
+                    const uint32 bits = SRGB_BUCKET_MIN_BITS + (i << SRGB_BUCKET_SHIFT);
+                    memcpy(&start, &bits, sizeof(float));
+
+                    while (start >= thresholds[code]) {
+                        code++;
+                    }
+
+                    buckets[i] = uint8(code);
+                }
+            }
+
+            FORCEINLINE uint8 Encode(float value, uint32 bucket) const
+            {
+                const uint8 code = buckets[bucket];
+                return uint8(code + (value >= thresholds[code]));
+            }
+        };
+
+        static const SrgbTables& GetSrgbTables()
+        {
+            static const SrgbTables tables;
+            return tables;
+        }
+
+        FORCEINLINE uint8 FloatToUnorm8(float value)
+        {
+            value = value < 0.f ? 0.f : (value > 1.f ? 1.f : value);
+            return uint8(value * 255.f + 0.5f);
+        }
+
+        // Kaiser windowed sinc for a 2:1 reduction, 12 source taps centered between the two source texels
+        CONSTEXPR static uint32 KAISER_TAPS = 12;
+        CONSTEXPR static float KAISER_ALPHA = 4.f;
+        CONSTEXPR static float KAISER_RADIUS = 3.f; // In destination texels
+
+        static float BesselI0(float x)
+        {
+            float sum = 1.f, term = 1.f;
+
+            for (uint32 k = 1; k < 16; k++) {
+                const float f = x / (2.f * k);
+                term *= f * f;
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        struct KaiserKernel
+        {
+            float weights[KAISER_TAPS];
+
+            KaiserKernel()
+            {
+                float sum = 0.f;
+
+                for (uint32 i = 0; i < KAISER_TAPS; i++) {
+                    // Source texel 2x - 5 + i relative to the destination texel x, in destination units
+                    const float t = (float(i) - 5.5f) * 0.5f;
+                    const float r = t / KAISER_RADIUS;
+                    const float window = BesselI0(KAISER_ALPHA * sqrtf(MAX(0.f, 1.f - r * r))) / BesselI0(KAISER_ALPHA);
+                    const float sinc = t == 0.f ? 1.f : sinf(3.14159265f * t) / (3.14159265f * t);
+                    weights[i] = sinc * window;
+                    sum += weights[i];
+                }
+
+                for (float& weight : weights) {
+                    weight /= sum;
+                }
+            }
+        };
+
+        static void ToFloat(const TextureImage& src, bool srgb, std::vector<float>& out)
+        {
+            const SrgbTables& tables = GetSrgbTables();
+            const usize count = usize(src.width) * src.height * 4;
+            out.resize(count);
+
+            for (usize i = 0; i < count; i++) {
+                const uint8 v = src.pixels[i];
+                out[i] = (srgb && (i & 3) != 3) ? tables.toLinear[v] : v / 255.f;
+            }
+        }
+
+        static void FromFloat(const float* src, bool srgb, TextureImage& dst)
+        {
+            const usize count = usize(dst.width) * dst.height * 4;
+
+            for (usize i = 0; i < count; i++) {
+                dst.pixels[i] = (srgb && (i & 3) != 3) ? Srgb::FromLinear(src[i]) : FloatToUnorm8(src[i]);
+            }
+        }
+
+        static void DownsampleBoxRows(const uint8* row0, const uint8* row1, uint8* dst, uint32 srcWidth, uint32 dstWidth)
+        {
+            uint32 x = 0;
+
+#if defined(TRE_MIPS_SSE2)
+            // Two destination texels per iteration: 4 source texels of both rows widened to 16 bits
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16(2);
+
+            for (; x + 2 <= dstWidth; x += 2) {
+                const __m128i a = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+                const __m128i b = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+                const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)); // texels 0, 1
+                const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)); // texels 2, 3
+                const __m128i sumLo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                const __m128i sumHi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                const __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sumLo, sumHi), round), 2);
+                _mm_storel_epi64((__m128i*)(dst + x * 4), _mm_packus_epi16(sum, zero));
+            }
+#endif
+
+            for (; x < dstWidth; x++) {
+                const uint32 x0 = 2 * x;
+                const uint32 x1 = MIN(2 * x + 1, srcWidth - 1);
+
+                for (uint32 c = 0; c < 4; c++) {
+                    dst[x * 4 + c] = uint8((row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c] + 2) >> 2);
+                }
+            }
+        }
+
+#if defined(TRE_MIPS_SSE2)
+        FORCEINLINE __m128 LoadLinear(const SrgbTables& tables, const uint8* texel)
+        {
+            return _mm_setr_ps(tables.toLinear[texel[0]], tables.toLinear[texel[1]], tables.toLinear[texel[2]], 0.f);
+        }
+#endif
+    }
+
+    float Srgb::ToLinear(uint8 value)
+    {
+        return Internal::GetSrgbTables().toLinear[value];
+    }
+
+    uint8 Srgb::FromLinear(float value)
+    {
+        const Internal::SrgbTables& tables = Internal::GetSrgbTables();
+        value = value < Internal::SRGB_MIN_LINEAR ? Internal::SRGB_MIN_LINEAR : (value > Internal::SRGB_MAX_LINEAR ? Internal::SRGB_MAX_LINEAR : value);
+
+        uint32 bits;
+        memcpy(&bits, &value, sizeof(float));
+        return tables.Encode(value, (bits - Internal::SRGB_BUCKET_MIN_BITS) >> Internal::SRGB_BUCKET_SHIFT);
+    }
+
+    void DownsampleBox(const TextureImage& src, TextureImage& dst, bool srgb)
+    {
+        const uint32 dstWidth = MAX(src.width / 2, 1u);
+        const uint32 dstHeight = MAX(src.height / 2, 1u);
+        dst.Resize(dstWidth, dstHeight);
+
+        if (!srgb) {
+            for (uint32 y = 0; y < dstHeight; y++) {
+                const uint8* row0 = src.pixels.data() + usize(2 * y) * src.width * 4;
+                const uint8* row1 = src.pixels.data() + usize(MIN(2 * y + 1, src.height - 1)) * src.width * 4;
+                Internal::DownsampleBoxRows(row0, row1, dst.pixels.data() + usize(y) * dstWidth * 4, src.width, dstWidth);
+            }
+
+            return;
+        }
+
+        const Internal::SrgbTables& tables = Internal::GetSrgbTables();
+
+        for (uint32 y = 0; y < dstHeight; y++) {
+            const uint8* row0 = src.pixels.data() + usize(2 * y) * src.width * 4;
+            const uint8* row1 = src.pixels.data() + usize(MIN(2 * y + 1, src.height - 1)) * src.width * 4;
+            uint8* out = dst.pixels.data() + usize(y) * dstWidth * 4;
+
+            for (uint32 x = 0; x < dstWidth; x++) {
+                const uint32 x0 = 2 * x * 4;
+                const uint32 x1 = MIN(2 * x + 1, src.width - 1) * 4;
+
+#if defined(TRE_MIPS_SSE2)
+                // Linearize through the table, average and compute the encode buckets 4 lanes at a time (alpha lane unused)
+                const __m128 sum = _mm_add_ps(
+                    _mm_add_ps(Internal::LoadLinear(tables, row0 + x0), Internal::LoadLinear(tables, row0 + x1)),
+                    _mm_add_ps(Internal::LoadLinear(tables, row1 + x0), Internal::LoadLinear(tables, row1 + x1)));
+                const __m128 average = _mm_min_ps(_mm_max_ps(_mm_mul_ps(sum, _mm_set1_ps(0.25f)),
+                    _mm_set1_ps(Internal::SRGB_MIN_LINEAR)), _mm_set1_ps(Internal::SRGB_MAX_LINEAR));
+                const __m128i buckets = _mm_srli_epi32(_mm_sub_epi32(_mm_castps_si128(average),
+                    _mm_set1_epi32(Internal::SRGB_BUCKET_MIN_BITS)), Internal::SRGB_BUCKET_SHIFT);
+
+                alignas(16) float values[4];
+                alignas(16) uint32 indices[4];
+                _mm_store_ps(values, average);
+                _mm_store_si128((__m128i*)indices, buckets);
+
+                for (uint32 c = 0; c < 3; c++) {
+                    out[x * 4 + c] = tables.Encode(values[c], indices[c]);
+                }
+#else
+                for (uint32 c = 0; c < 3; c++) {
+                    const float sum = (tables.toLinear[row0[x0 + c]] + tables.toLinear[row0[x1 + c]]) +
+                        (tables.toLinear[row1[x0 + c]] + tables.toLinear[row1[x1 + c]]);
+                    out[x * 4 + c] = Srgb::FromLinear(sum * 0.25f);
+                }
+#endif
+
+                out[x * 4 + 3] = uint8((row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2) >> 2);
+            }
+        }
+    }
+
+    void DownsampleKaiser(const TextureImage& src, TextureImage& dst, bool srgb)
+    {
+        static const Internal::KaiserKernel kernel;
+
+        const uint32 dstWidth = MAX(src.width / 2, 1u);
+        const uint32 dstHeight = MAX(src.height / 2, 1u);
+        dst.Resize(dstWidth, dstHeight);
+
+        std::vector<float> source;
+        Internal::ToFloat(src, srgb, source);
+
+        // Horizontal pass (src.height rows of dstWidth texels) then vertical pass, taps outside the image are clamped
+        std::vector<float> horizontal(usize(dstWidth) * src.height * 4);
+        std::vector<float> result(usize(dstWidth) * dstHeight * 4);
+        const int32 lastColumn = int32(src.width) - 1;
+        const int32 lastRow = int32(src.height) - 1;
+
+        for (uint32 y = 0; y < src.height; y++) {
+            const float* row = source.data() + usize(y) * src.width * 4;
+            float* out = horizontal.data() + usize(y) * dstWidth * 4;
+
+            for (uint32 x = 0; x < dstWidth; x++) {
+                float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+
+                for (uint32 t = 0; t < Internal::KAISER_TAPS; t++) {
+                    const int32 sx = src.width == 1 ? 0 : MIN(MAX(int32(2 * x) - 5 + int32(t), 0), lastColumn);
+                    const float w = kernel.weights[t];
+
+                    for (uint32 c = 0; c < 4; c++) {
+                        acc[c] += row[sx * 4 + c] * w;
+                    }
+                }
+
+                memcpy(out + x * 4, acc, sizeof(acc));
+            }
+        }
+
+        for (uint32 y = 0; y < dstHeight; y++) {
+            float* out = result.data() + usize(y) * dstWidth * 4;
+
+            for (uint32 t = 0; t < Internal::KAISER_TAPS; t++) {
+                const int32 sy = src.height == 1 ? 0 : MIN(MAX(int32(2 * y) - 5 + int32(t), 0), lastRow);
+                const float* row = horizontal.data() + usize(sy) * dstWidth * 4;
+                const float w = kernel.weights[t];
+
+                // Row major accumulation, the inner loop is contiguous and vectorizes
+                for (uint32 i = 0; i < dstWidth * 4; i++) {
+                    out[i] += row[i] * w;
+                }
+            }
+        }
+
+        Internal::FromFloat(result.data(), srgb, dst);
+    }
+
+    bool GenerateMipChain(const uint8* rgba, uint32 width, uint32 height, const MipChainOptions& options, std::vector<TextureImage>& levels)
+    {
+        uint32 levelCount = 1;
+
+        for (uint32 size = MAX(width, height); size > 1; size >>= 1) {
+            levelCount++;
+        }
+
+        if (options.maxLevels) {
+            levelCount = MIN(levelCount, options.maxLevels);
+        }
+
+        levels.resize(levelCount);
+        levels[0].Resize(width, height);
+        memcpy(levels[0].pixels.data(), rgba, levels[0].pixels.size());
+
+        // Each level is filtered from the previous one, the Kaiser kernel is wide enough for this not to alias
+        for (uint32 i = 1; i < levelCount; i++) {
+            if (options.cancel && options.cancel->load(std::memory_order_relaxed))
+                return false;
+
+            if (options.filter == MipFilter::KAISER) {
+                DownsampleKaiser(levels[i - 1], levels[i], options.srgb);
+            } else {
+                DownsampleBox(levels[i - 1], levels[i], options.srgb);
+            }
+        }
+
+        return true;
+    }
+}
+
+TRE_NS_END
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	// Uncompressed RGBA8 image, rows are tightly packed
+	struct TextureImage
+	{
+		uint32 width = 0;
+		uint32 height = 0;
+		std::vector<uint8> pixels;
+
+		FORCEINLINE void Resize(uint32 w, uint32 h)
+		{
+			width = w;
+			height = h;
+			pixels.resize(usize(w) * h * 4);
+		}
+	};
+
+	enum class MipFilter
+	{
+		BOX,	// 2x2 average, fastest
+		KAISER, // Kaiser windowed sinc over 12 taps, keeps distant mips sharp
+	};
+
+	struct MipChainOptions
+	{
+		MipFilter filter = MipFilter::BOX;
+		bool srgb = false; // Filter color in linear space, alpha is always linear
+		uint32 maxLevels = 0; // 0 for the full chain down to 1x1
+		const std::atomic<bool>* cancel = NULL; // Polled between levels
+	};
+
+	namespace Srgb
+	{
+		float ToLinear(uint8 value);
+
+		// Exact inverse of ToLinear: returns the code whose decoded value is the closest. Table driven (one bucket
+		// lookup and one threshold compare) so that it can run per channel in the filters.
+		uint8 FromLinear(float value);
+	}
+
+	// Each level is half the size of the previous one (rounded down, at least 1), odd trailing rows/columns are dropped
+	void DownsampleBox(const TextureImage& src, TextureImage& dst, bool srgb = false);
+
+	void DownsampleKaiser(const TextureImage& src, TextureImage& dst, bool srgb = false);
+
+	// levels[0] is a copy of the source image. Returns false if cancelled through options.cancel.
+	bool GenerateMipChain(const uint8* rgba, uint32 width, uint32 height, const MipChainOptions& options, std::vector<TextureImage>& levels);
+}
+
+TRE_NS_END
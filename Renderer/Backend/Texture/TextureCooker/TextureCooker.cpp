@@ -0,0 +1,95 @@
+#include "TextureCooker.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+#include <Renderer/Backend/Texture/BCn/BCn.hpp>
+#include <Renderer/Backend/Misc/stb_image.hpp>
+
+TRE_NS_START
+
+bool Renderer::TextureCooker::CookTexture(const uint8* rgba, uint32 width, uint32 height, const TextureCookOptions& options, CookedTexture& out)
+{
+    if (!rgba || !width || !height || !GetFormatBlockSize(options.format))
+        return false;
+
+    MipChainOptions mipOptions;
+    mipOptions.filter = options.filter;
+    mipOptions.srgb = IsSrgb(options.format);
+    mipOptions.maxLevels = options.maxLevels;
+
+    std::vector<TextureImage> mips;
+    GenerateMipChain(rgba, width, height, mipOptions, mips);
+
+    out.format = options.format;
+    out.width = width;
+    out.height = height;
+    out.levels.resize(mips.size());
+    out.data.clear();
+
+    std::vector<uint8> level;
+
+    for (usize i = 0; i < mips.size(); i++) {
+        if (IsBlockCompressed(options.format)) {
+            BCn::CompressImage(mips[i], options.format, level);
+        } else {
+            level.swap(mips[i].pixels);
+        }
+
+        out.levels[i] = { out.data.size(), level.size() };
+        out.data.insert(out.data.end(), level.begin(), level.end());
+    }
+
+    return true;
+}
+
+bool Renderer::TextureCooker::CookTexture(const uint8* encoded, usize size, const TextureCookOptions& options, CookedTexture& out)
+{
+    int32 width, height, channels;
+    stbi_uc* pixels = stbi_load_from_memory(encoded, (int)size, &width, &height, &channels, STBI_rgb_alpha);
+
+    if (!pixels)
+        return false;
+
+    const bool cooked = CookTexture(pixels, (uint32)width, (uint32)height, options, out);
+    stbi_image_free(pixels);
+    return cooked;
+}
+
+bool Renderer::TextureCooker::CookTextureFile(const char* path, const TextureCookOptions& options, CookedTexture& out)
+{
+    MappedFile file(path, MappedFile::HINT_SEQUENTIAL);
+
+    if (!file.IsOpen())
+        return false;
+
+    return CookTexture(file.Data(), file.Size(), options, out);
+}
+
+bool Renderer::TextureCooker::SaveKTX2(const char* path, const CookedTexture& texture, const KTX2::SupercompressionCodec* codec)
+{
+    std::vector<uint8> data;
+
+    if (!KTX2::Write(texture, data, codec))
+        return false;
+
+    FILE* file = fopen(path, "wb");
+
+    if (!file)
+        return false;
+
+    const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return written;
+}
+
+bool Renderer::TextureCooker::LoadKTX2(const char* path, CookedTexture& out, const KTX2::SupercompressionCodec* codec)
+{
+    MappedFile file(path, MappedFile::HINT_SEQUENTIAL);
+
+    if (!file.IsOpen())
+        return false;
+
+    return KTX2::Read(file.Data(), file.Size(), out, codec);
+}
+
+TRE_NS_END
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Texture/TextureFormat.hpp>
+#include <Renderer/Backend/Texture/MipChain/MipChain.hpp>
+#include <Renderer/Backend/Texture/KTX2/KTX2.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	struct TextureCookOptions
+	{
+		TextureFormat format = TextureFormat::BC7_SRGB; // sRGB formats filter the mips in linear space
+		MipFilter filter = MipFilter::KAISER;
+		uint32 maxLevels = 0; // 0 for the full chain
+	};
+
+	/*
+	 * Offline texture pipeline: decode (any format stb_image reads) -> mip chain on the CPU -> block compression of every
+	 * level -> KTX2. The result of CookTexture can be uploaded directly with RenderDevice::CreateImage(info, levels).
+	 */
+	namespace TextureCooker
+	{
+		bool CookTexture(const uint8* rgba, uint32 width, uint32 height, const TextureCookOptions& options, CookedTexture& out);
+
+		// Decodes an encoded image (png, jpg, tga...) from memory first
+		bool CookTexture(const uint8* encoded, usize size, const TextureCookOptions& options, CookedTexture& out);
+
+		bool CookTextureFile(const char* path, const TextureCookOptions& options, CookedTexture& out);
+
+		bool SaveKTX2(const char* path, const CookedTexture& texture, const KTX2::SupercompressionCodec* codec = NULL);
+
+		bool LoadKTX2(const char* path, CookedTexture& out, const KTX2::SupercompressionCodec* codec = NULL);
+	}
+}
+
+TRE_NS_END
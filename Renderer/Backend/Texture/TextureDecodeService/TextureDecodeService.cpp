@@ -0,0 +1,186 @@
+#include "TextureDecodeService.hpp"
+#include <string.h>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+#include <Renderer/Backend/Misc/stb_image.hpp>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+TRE_NS_START
+
+Renderer::TextureDecodeService::~TextureDecodeService()
+{
+    this->Shutdown();
+}
+
+void Renderer::TextureDecodeService::Init(uint32 workerCount)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT(!isRunning);
+
+    const uint32 poolWorkers = WorkerPool::Instance().GetWorkerCount();
+    this->workerCount = workerCount && workerCount < poolWorkers ? workerCount : poolWorkers;
+    isRunning = true;
+}
+
+void Renderer::TextureDecodeService::Shutdown()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (!isRunning)
+        return;
+
+    isRunning = false;
+
+    for (TextureDecodeHandle& request : requests) {
+        request->state.store(TextureDecodeRequest::CANCELLED, std::memory_order_release);
+    }
+
+    requests.clear();
+    completed.notify_all();
+    completed.wait(lock, [this]() { return scheduledCount == 0; });
+    workerCount = 0;
+}
+
+Renderer::TextureDecodeHandle Renderer::TextureDecodeService::Decode(const char* path, const TextureDecodeOptions& options)
+{
+    TextureDecodeHandle request = std::make_shared<TextureDecodeRequest>();
+    request->path = path;
+    request->options = options;
+    return this->Submit(std::move(request));
+}
+
+Renderer::TextureDecodeHandle Renderer::TextureDecodeService::Decode(std::vector<uint8>&& encoded, const TextureDecodeOptions& options)
+{
+    TextureDecodeHandle request = std::make_shared<TextureDecodeRequest>();
+    request->encoded = std::move(encoded);
+    request->options = options;
+    return this->Submit(std::move(request));
+}
+
+Renderer::TextureDecodeHandle Renderer::TextureDecodeService::Submit(TextureDecodeHandle request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!isRunning) {
+            request->state.store(TextureDecodeRequest::CANCELLED, std::memory_order_release);
+            return request;
+        }
+
+        requests.push_back(request);
+
+        if (scheduledCount == workerCount)
+            return request;
+
+        scheduledCount++;
+    }
+
+    WorkerPool::Instance().Submit([this]() { this->ProcessRequest(); });
+    return request;
+}
+
+bool Renderer::TextureDecodeService::Wait(const TextureDecodeHandle& request)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    completed.wait(lock, [this, &request]() { return request->IsDone() || (!isRunning && !scheduledCount); });
+    return request->GetState() == TextureDecodeRequest::READY;
+}
+
+// One request per pool job, then back in the pool's queue if there are more so the other services get their turn
+void Renderer::TextureDecodeService::ProcessRequest()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (!requests.empty()) {
+        TextureDecodeHandle request = std::move(requests.front());
+        requests.pop_front();
+
+        lock.unlock();
+        Process(*request);
+        lock.lock();
+
+        // Under the lock, the state change is ordered with waiters checking it before sleeping
+        completed.notify_all();
+
+        if (!requests.empty()) {
+            lock.unlock();
+            WorkerPool::Instance().Submit([this]() { this->ProcessRequest(); });
+            return;
+        }
+    }
+
+    scheduledCount--;
+    completed.notify_all();
+}
+
+void Renderer::TextureDecodeService::Process(TextureDecodeRequest& request)
+{
+    typedef TextureDecodeRequest Request;
+
+    if (request.cancelled.load(std::memory_order_relaxed)) {
+        request.state.store(Request::CANCELLED, std::memory_order_release);
+        return;
+    }
+
+    request.state.store(Request::RUNNING, std::memory_order_relaxed);
+
+    int32 width, height, channels;
+    stbi_uc* pixels = NULL;
+
+    if (!request.path.empty()) {
+        MappedFile file(request.path.c_str(), MappedFile::HINT_SEQUENTIAL);
+
+        if (file.IsOpen()) {
+            pixels = stbi_load_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels, STBI_rgb_alpha);
+        }
+    } else {
+        pixels = stbi_load_from_memory(request.encoded.data(), (int)request.encoded.size(), &width, &height, &channels, STBI_rgb_alpha);
+        std::vector<uint8>().swap(request.encoded);
+    }
+
+    if (!pixels) {
+        request.state.store(Request::FAILED, std::memory_order_release);
+        return;
+    }
+
+    const TextureDecodeOptions& options = request.options;
+    MipChainOptions mipOptions;
+    mipOptions.filter = options.filter;
+    mipOptions.srgb = options.srgb;
+    mipOptions.maxLevels = options.generateMips ? options.maxLevels : 1;
+    mipOptions.cancel = &request.cancelled;
+
+    std::vector<TextureImage> levels;
+    const bool generated = !request.cancelled.load(std::memory_order_relaxed) &&
+        GenerateMipChain(pixels, (uint32)width, (uint32)height, mipOptions, levels);
+    stbi_image_free(pixels);
+
+    if (!generated) {
+        request.state.store(Request::CANCELLED, std::memory_order_release);
+        return;
+    }
+
+    CookedTexture& texture = request.texture;
+    texture.format = options.srgb ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8_UNORM;
+    texture.width = (uint32)width;
+    texture.height = (uint32)height;
+    texture.levels.resize(levels.size());
+
+    usize size = 0;
+
+    for (const TextureImage& level : levels) {
+        size += level.pixels.size();
+    }
+
+    texture.data.resize(size);
+    size = 0;
+
+    for (usize i = 0; i < levels.size(); i++) {
+        texture.levels[i] = { size, levels[i].pixels.size() };
+        memcpy(texture.data.data() + size, levels[i].pixels.data(), levels[i].pixels.size());
+        size += levels[i].pixels.size();
+    }
+
+    request.state.store(Request::READY, std::memory_order_release);
+}
+
+TRE_NS_END
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Renderer/Backend/Texture/TextureFormat.hpp>
+#include <Renderer/Backend/Texture/MipChain/MipChain.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	struct TextureDecodeOptions
+	{
+		bool srgb = true; // Color data, the mips are filtered in linear space
+		bool generateMips = true;
+		MipFilter filter = MipFilter::BOX;
+		uint32 maxLevels = 0;
+	};
+
+	class TextureDecodeRequest
+	{
+	public:
+		enum State : uint32
+		{
+			PENDING,
+			RUNNING,
+			READY,
+			FAILED,
+			CANCELLED,
+		};
+
+		FORCEINLINE State GetState() const { return (State)state.load(std::memory_order_acquire); }
+
+		FORCEINLINE bool IsDone() const { return this->GetState() >= READY; }
+
+		// Queued requests stay queued and are skipped without decoding when a worker reaches them, running ones stop at
+		// the next stage boundary (after decoding, between mips)
+		FORCEINLINE void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+		// RGBA8 levels, tightly packed from the largest one: ready to be staged. Only valid once READY.
+		FORCEINLINE const CookedTexture& GetTexture() const { return texture; }
+
+		FORCEINLINE CookedTexture& GetTexture() { return texture; }
+
+	private:
+		std::string path;
+		std::vector<uint8> encoded;
+		TextureDecodeOptions options;
+		CookedTexture texture;
+		std::atomic<uint32> state{ PENDING };
+		std::atomic<bool> cancelled{ false };
+
+		friend class TextureDecodeService;
+	};
+
+	typedef std::shared_ptr<TextureDecodeRequest> TextureDecodeHandle;
+
+	/*
+	 * Decodes images and builds their mip chains on the worker pool, so neither stbi_load nor GPU blits (which not every
+	 * format supports) are on the render thread's path. Requests complete out of order, poll them or Wait on them.
+	 */
+	class TextureDecodeService
+	{
+	public:
+		TextureDecodeService() = default;
+
+		~TextureDecodeService();
+
+		// At most as many decodes at once as the pool has workers, 0 for all of them
+		void Init(uint32 workerCount = 0);
+
+		// Cancels what is still queued and waits for the decodes running
+		void Shutdown();
+
+		TextureDecodeHandle Decode(const char* path, const TextureDecodeOptions& options = TextureDecodeOptions());
+
+		TextureDecodeHandle Decode(std::vector<uint8>&& encoded, const TextureDecodeOptions& options = TextureDecodeOptions());
+
+		// Blocks until the request leaves the queue and the workers, returns true if it is READY. Returns right away
+		// when the service isn't running: a request it never took can't complete.
+		bool Wait(const TextureDecodeHandle& request);
+
+		// Pool workers the service may take at once
+		FORCEINLINE uint32 GetWorkerCount() const { return workerCount; }
+
+		// Runs a request on the calling thread, used by the workers
+		static void Process(TextureDecodeRequest& request);
+	private:
+		TextureDecodeHandle Submit(TextureDecodeHandle request);
+
+		void ProcessRequest();
+
+	private:
+		std::deque<TextureDecodeHandle> requests;
+		std::mutex mutex;
+		std::condition_variable completed;
+		uint32 workerCount = 0;
+		uint32 scheduledCount = 0; // Pool jobs queued or running
+		bool isRunning = false;
+	};
+}
+
+TRE_NS_END
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	/*
+	 * Formats produced by the texture cooker. The values are the matching VkFormat ones so that cooked data and KTX2
+	 * files (which store a vkFormat) can be handed to the RHI with a cast, without this header depending on Vulkan.
+	 */
+	enum class TextureFormat : uint32
+	{
+		UNDEFINED		= 0,
+		RGBA8_UNORM		= 37,  // VK_FORMAT_R8G8B8A8_UNORM
+		RGBA8_SRGB		= 43,  // VK_FORMAT_R8G8B8A8_SRGB
+		BC1_RGBA_UNORM	= 133, // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		BC1_RGBA_SRGB	= 134, // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		BC3_UNORM		= 137, // VK_FORMAT_BC3_UNORM_BLOCK
+		BC3_SRGB		= 138, // VK_FORMAT_BC3_SRGB_BLOCK
+		BC4_UNORM		= 139, // VK_FORMAT_BC4_UNORM_BLOCK
+		BC5_UNORM		= 141, // VK_FORMAT_BC5_UNORM_BLOCK
+		BC7_UNORM		= 145, // VK_FORMAT_BC7_UNORM_BLOCK
+		BC7_SRGB		= 146, // VK_FORMAT_BC7_SRGB_BLOCK
+	};
+
+	FORCEINLINE bool IsBlockCompressed(TextureFormat format)
+	{
+		return format >= TextureFormat::BC1_RGBA_UNORM && format <= TextureFormat::BC7_SRGB;
+	}
+
+	FORCEINLINE bool IsSrgb(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::RGBA8_SRGB:
+		case TextureFormat::BC1_RGBA_SRGB:
+		case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC7_SRGB:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Bytes of a 4x4 block for compressed formats, of a texel otherwise
+	FORCEINLINE uint32 GetFormatBlockSize(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::BC1_RGBA_UNORM:
+		case TextureFormat::BC1_RGBA_SRGB:
+		case TextureFormat::BC4_UNORM:
+			return 8;
+		case TextureFormat::BC3_UNORM:
+		case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC5_UNORM:
+		case TextureFormat::BC7_UNORM:
+		case TextureFormat::BC7_SRGB:
+			return 16;
+		case TextureFormat::RGBA8_UNORM:
+		case TextureFormat::RGBA8_SRGB:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	FORCEINLINE usize GetTextureLevelSize(TextureFormat format, uint32 width, uint32 height)
+	{
+		if (IsBlockCompressed(format))
+			return usize((width + 3) / 4) * ((height + 3) / 4) * GetFormatBlockSize(format);
+
+		return usize(width) * height * GetFormatBlockSize(format);
+	}
+
+	FORCEINLINE uint32 GetMipLevelCount(uint32 width, uint32 height)
+	{
+		uint32 size = MAX(width, height);
+		uint32 levels = 0;
+
+		while (size) {
+			levels++;
+			size >>= 1;
+		}
+
+		return levels;
+	}
+
+	// A full mip chain in its final GPU format, levels are stored contiguously from the largest one
+	struct CookedTexture
+	{
+		struct Level
+		{
+			usize offset;
+			usize size;
+		};
+
+		TextureFormat format = TextureFormat::UNDEFINED;
+		uint32 width = 0;
+		uint32 height = 0;
+		std::vector<Level> levels;
+		std::vector<uint8> data;
+
+		FORCEINLINE uint32 GetLevelWidth(uint32 level) const { return MAX(width >> level, 1u); }
+
+		FORCEINLINE uint32 GetLevelHeight(uint32 level) const { return MAX(height >> level, 1u); }
+
+		FORCEINLINE const uint8* GetLevelData(uint32 level) const { return data.data() + levels[level].offset; }
+	};
+}
+
+TRE_NS_END
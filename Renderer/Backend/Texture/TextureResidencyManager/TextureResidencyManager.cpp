@@ -0,0 +1,253 @@
+#include "TextureResidencyManager.hpp"
+#include <algorithm>
+#include <math.h>
+
+TRE_NS_START
+
+Renderer::TextureResidencyManager::TextureResidencyManager() : TextureResidencyManager(Config())
+{
+}
+
+Renderer::TextureResidencyManager::TextureResidencyManager(const Config& config) : config(config), stats{}, frame(0)
+{
+}
+
+Renderer::TextureResidencyManager::TextureId Renderer::TextureResidencyManager::Register(const StreamedTextureDesc& desc)
+{
+    ASSERTF(desc.levelCount && desc.levelCount <= ARRAY_SIZE(Texture::levelSizes), "Streamed textures have 1 to 16 levels, got %d", desc.levelCount);
+
+    const TextureTable::Handle handle = textures.Acquire();
+    ASSERTF(!handle.IsNull(), "Too many streamed textures");
+
+    Texture& texture = *textures.Get(handle);
+    texture.desc = desc;
+    texture.lastUsedFrame = frame;
+    texture.pendingLevel = NO_LEVEL;
+    texture.requestedLevel = NO_LEVEL;
+
+    for (uint32 i = 0; i < desc.levelCount; i++) {
+        texture.levelSizes[i] = GetTextureLevelSize(desc.format, MAX(desc.width >> i, 1u), MAX(desc.height >> i, 1u));
+    }
+
+    // The smallest level is always part of the tail even if it's above the threshold
+    uint32 tail = desc.levelCount - 1;
+
+    while (tail && texture.levelSizes[tail - 1] <= config.tailLevelSize) {
+        tail--;
+    }
+
+    texture.tailLevel = tail;
+    texture.residentLevel = tail;
+    texture.wantedLevel = tail;
+
+    for (uint32 i = tail; i < desc.levelCount; i++) {
+        stats.residentBytes += texture.levelSizes[i];
+    }
+
+    stats.textureCount++;
+    return handle.ToUInt64();
+}
+
+void Renderer::TextureResidencyManager::Unregister(TextureId id)
+{
+    Texture* texture = this->GetTexture(id);
+
+    if (!texture)
+        return;
+
+    for (uint32 i = texture->residentLevel; i < texture->desc.levelCount; i++) {
+        stats.residentBytes -= texture->levelSizes[i];
+    }
+
+    if (texture->pendingLevel != NO_LEVEL) {
+        stats.pendingBytes -= texture->levelSizes[texture->pendingLevel];
+    }
+
+    textures.Release(TextureTable::Handle::FromUInt64(id));
+    stats.textureCount--;
+}
+
+void Renderer::TextureResidencyManager::RequestLod(TextureId id, float lod)
+{
+    Texture* texture = this->GetTexture(id);
+
+    if (!texture)
+        return;
+
+    const uint32 level = MIN(lod > 0.f ? (uint32)lod : 0u, texture->tailLevel);
+    texture->requestedLevel = MIN(texture->requestedLevel, level);
+}
+
+void Renderer::TextureResidencyManager::Update(std::vector<LevelRequest>& loads, std::vector<LevelRequest>& evictions)
+{
+    frame++;
+    loads.clear();
+    evictions.clear();
+    stats.loadsIssued = 0;
+    stats.evictions = 0;
+    stats.loadsDeferred = 0;
+
+    textures.ForEach([this](TextureTable::Handle, Texture& texture) {
+        if (texture.requestedLevel != NO_LEVEL) {
+            texture.wantedLevel = texture.requestedLevel;
+            texture.lastUsedFrame = frame;
+            texture.requestedLevel = NO_LEVEL;
+        } else if (frame - texture.lastUsedFrame > config.evictionGraceFrames) {
+            texture.wantedLevel = texture.tailLevel;
+        }
+    });
+
+    // Budget lowered (or tails alone above it): unwanted levels go first, then the least recently used ones
+    const usize used = stats.residentBytes + stats.pendingBytes;
+
+    if (used > config.budget && !this->Evict(used - config.budget, false, evictions)) {
+        const usize stillUsed = stats.residentBytes + stats.pendingBytes;
+
+        if (stillUsed > config.budget) {
+            this->Evict(stillUsed - config.budget, true, evictions);
+        }
+    }
+
+    // Textures missing the most levels first, then the most recently used, then registration order
+    candidates.clear();
+
+    textures.ForEach([this](TextureTable::Handle handle, Texture& texture) {
+        if (texture.pendingLevel == NO_LEVEL && texture.wantedLevel < texture.residentLevel) {
+            candidates.push_back({ handle, &texture });
+        }
+    });
+
+    std::sort(candidates.begin(), candidates.end(), [](const Entry& a, const Entry& b) {
+        const Texture& ta = *a.texture;
+        const Texture& tb = *b.texture;
+        const uint32 missingA = ta.residentLevel - ta.wantedLevel;
+        const uint32 missingB = tb.residentLevel - tb.wantedLevel;
+
+        if (missingA != missingB)
+            return missingA > missingB;
+
+        if (ta.lastUsedFrame != tb.lastUsedFrame)
+            return ta.lastUsedFrame > tb.lastUsedFrame;
+
+        return a.handle.index < b.handle.index;
+    });
+
+    usize uploadBytes = 0;
+
+    for (const Entry& candidate : candidates) {
+        Texture& texture = *candidate.texture;
+        const uint32 level = texture.residentLevel - 1;
+        const usize size = texture.levelSizes[level];
+
+        if (uploadBytes + size > config.maxUploadBytesPerFrame) {
+            stats.loadsDeferred++;
+            continue;
+        }
+
+        const usize required = stats.residentBytes + stats.pendingBytes + size;
+
+        if (required > config.budget && !this->Evict(required - config.budget, false, evictions)) {
+            stats.loadsDeferred++;
+            continue;
+        }
+
+        texture.pendingLevel = level;
+        stats.pendingBytes += size;
+        stats.loadsIssued++;
+        uploadBytes += size;
+        loads.push_back({ candidate.handle.ToUInt64(), level, size });
+    }
+}
+
+bool Renderer::TextureResidencyManager::Evict(usize bytes, bool evictWanted, std::vector<LevelRequest>& evictions)
+{
+    // Textures with an upload in flight are left alone, the load completes on top of the current resident level
+    scratch.clear();
+
+    textures.ForEach([this, evictWanted](TextureTable::Handle handle, Texture& texture) {
+        const uint32 limit = evictWanted ? texture.tailLevel : texture.wantedLevel;
+
+        if (texture.pendingLevel == NO_LEVEL && texture.residentLevel < limit) {
+            scratch.push_back({ handle, &texture });
+        }
+    });
+
+    std::sort(scratch.begin(), scratch.end(), [](const Entry& a, const Entry& b) {
+        if (a.texture->lastUsedFrame != b.texture->lastUsedFrame)
+            return a.texture->lastUsedFrame < b.texture->lastUsedFrame;
+
+        return a.handle.index < b.handle.index;
+    });
+
+    usize freed = 0;
+
+    for (const Entry& entry : scratch) {
+        Texture& texture = *entry.texture;
+        const uint32 limit = evictWanted ? texture.tailLevel : texture.wantedLevel;
+
+        while (texture.residentLevel < limit && freed < bytes) {
+            const usize size = texture.levelSizes[texture.residentLevel];
+            evictions.push_back({ entry.handle.ToUInt64(), texture.residentLevel, size });
+            texture.residentLevel++;
+            stats.residentBytes -= size;
+            stats.evictions++;
+            freed += size;
+        }
+
+        if (freed >= bytes)
+            return true;
+    }
+
+    return false;
+}
+
+void Renderer::TextureResidencyManager::OnLevelLoaded(TextureId id, uint32 level)
+{
+    Texture* texture = this->GetTexture(id);
+
+    if (!texture || texture->pendingLevel != level)
+        return;
+
+    ASSERTF(level + 1 == texture->residentLevel, "Level %d loaded out of order (resident from %d)", level, texture->residentLevel);
+
+    const usize size = texture->levelSizes[level];
+    texture->pendingLevel = NO_LEVEL;
+    texture->residentLevel = level;
+    stats.pendingBytes -= size;
+    stats.residentBytes += size;
+}
+
+uint32 Renderer::TextureResidencyManager::GetResidentLevel(TextureId id) const
+{
+    const Texture* texture = this->GetTexture(id);
+    ASSERTF(texture != NULL, "Invalid streamed texture %" PRIx64, id);
+    return texture->residentLevel;
+}
+
+uint32 Renderer::TextureResidencyManager::GetTailLevel(TextureId id) const
+{
+    const Texture* texture = this->GetTexture(id);
+    ASSERTF(texture != NULL, "Invalid streamed texture %" PRIx64, id);
+    return texture->tailLevel;
+}
+
+float Renderer::TextureResidencyManager::ComputeScreenSpaceLod(uint32 width, uint32 height, float screenWidth, float screenHeight)
+{
+    if (screenWidth <= 0.f || screenHeight <= 0.f)
+        return 16.f;
+
+    const float ratio = MAX(float(width) / screenWidth, float(height) / screenHeight);
+    return ratio > 1.f ? log2f(ratio) : 0.f;
+}
+
+Renderer::TextureResidencyManager::Texture* Renderer::TextureResidencyManager::GetTexture(TextureId id)
+{
+    return textures.Get(TextureTable::Handle::FromUInt64(id));
+}
+
+const Renderer::TextureResidencyManager::Texture* Renderer::TextureResidencyManager::GetTexture(TextureId id) const
+{
+    return const_cast<TextureResidencyManager*>(this)->GetTexture(id);
+}
+
+TRE_NS_END
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+
+#include <Legacy/Misc/Defines/Common.hpp>
+#include <Legacy/Misc/Defines/Debug.hpp>
+#include <Core/DataStructure/HandleTable.hpp>
+#include <Renderer/Backend/Texture/TextureFormat.hpp>
+
+TRE_NS_START
+
+namespace Renderer
+{
+	struct StreamedTextureDesc
+	{
+		TextureFormat format;
+		uint32 width;
+		uint32 height;
+		uint32 levelCount;
+	};
+
+	/*
+	 * Decides which mip levels of streamed textures are resident. Textures are created with their whole chain but only
+	 * the tail (levels up to tailLevelSize bytes) is uploaded, finer levels are loaded one at a time as the requested LOD
+	 * asks for them and dropped when the budget needs room. Residency is always a contiguous range [residentLevel, levelCount)
+	 * so a single min LOD clamp per texture hides what isn't there.
+	 *
+	 * Each frame: RequestLod for the textures in use (several requests keep the finest), then Update which returns the
+	 * levels to upload and the ones evicted, and OnLevelLoaded once an upload has landed. Everything is ordered by
+	 * explicit keys, the same sequence of calls always gives the same decisions.
+	 */
+	class TextureResidencyManager
+	{
+	public:
+		// A handle to the texture's slot in the table, packed
+		typedef uint64 TextureId;
+
+		CONSTEXPR static TextureId INVALID_TEXTURE = 0;
+
+		struct Config
+		{
+			usize budget = 256u << 20;				  // Bytes of resident levels, tails included
+			usize maxUploadBytesPerFrame = 16u << 20;
+			usize tailLevelSize = 64u << 10;		  // Levels this small stay resident
+			uint32 evictionGraceFrames = 8;			  // Frames without a request before a texture only wants its tail
+		};
+
+		struct LevelRequest
+		{
+			TextureId texture;
+			uint32 level;
+			usize size;
+		};
+
+		struct Stats
+		{
+			usize residentBytes;
+			usize pendingBytes;
+			uint32 textureCount;
+			uint32 loadsIssued;
+			uint32 evictions;
+			uint32 loadsDeferred; // Wanted but didn't fit the budget or the frame's upload limit
+		};
+
+	public:
+		TextureResidencyManager();
+
+		TextureResidencyManager(const Config& config);
+
+		// The tail is considered resident right away, it's uploaded along with the image creation
+		TextureId Register(const StreamedTextureDesc& desc);
+
+		void Unregister(TextureId id);
+
+		// lod is the level the texture is sampled at this frame (0 = full resolution)
+		void RequestLod(TextureId id, float lod);
+
+		// Lowering the budget evicts on the next update, least recently used textures first
+		FORCEINLINE void SetBudget(usize budget) { config.budget = budget; }
+
+		void Update(std::vector<LevelRequest>& loads, std::vector<LevelRequest>& evictions);
+
+		// Upload completion, ignored if the texture was unregistered in the meantime
+		void OnLevelLoaded(TextureId id, uint32 level);
+
+		// Finest resident level, the min LOD to clamp sampling to
+		uint32 GetResidentLevel(TextureId id) const;
+
+		uint32 GetTailLevel(TextureId id) const;
+
+		FORCEINLINE const Stats& GetStats() const { return stats; }
+
+		FORCEINLINE uint64 GetFrame() const { return frame; }
+
+		// CPU estimate of the LOD a texture of the given size is sampled at when it covers screenWidth x screenHeight pixels
+		static float ComputeScreenSpaceLod(uint32 width, uint32 height, float screenWidth, float screenHeight);
+
+	private:
+		CONSTEXPR static uint32 NO_LEVEL = ~0u;
+
+		struct Texture
+		{
+			StreamedTextureDesc desc;
+			usize levelSizes[16];
+			uint64 lastUsedFrame;
+			uint32 tailLevel;
+			uint32 residentLevel;
+			uint32 wantedLevel;
+			uint32 requestedLevel; // Finest level requested since the last update
+			uint32 pendingLevel;
+		};
+
+		typedef HandleTable<Texture, 256> TextureTable;
+
+		struct Entry
+		{
+			TextureTable::Handle handle;
+			Texture* texture;
+		};
+
+		Texture* GetTexture(TextureId id);
+
+		const Texture* GetTexture(TextureId id) const;
+
+		// Drops the finest resident level of the textures from the least recently used one until freeing bytes, returns false
+		// if not enough could be freed. Only levels finer than wanted are touched unless evictWanted is set.
+		bool Evict(usize bytes, bool evictWanted, std::vector<LevelRequest>& evictions);
+
+	private:
+		Config config;
+		Stats stats;
+		TextureTable textures;			// Slots are reused, ids of unregistered textures stop resolving
+		std::vector<Entry> candidates;	// Textures to load, by priority
+		std::vector<Entry> scratch;		// Eviction order
+		uint64 frame;
+	};
+}
+
+TRE_NS_END
@@ -72,6 +72,7 @@ struct RENDERER_API Event {
 	};
 
 	event_t Type;
+	uint64 Time; // Microseconds on the steady clock, when the window got it from the system
 
 	union {
 		MouseEvent Mouse;
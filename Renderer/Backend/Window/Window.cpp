@@ -35,4 +35,41 @@ const TRE::Vec2<int32>& TRE::Window::getPosition() const
 const TRE::Vec2<int32>& TRE::Window::getMousePosition() const
 {
 	return mousePosition;
-}
\ No newline at end of file
+}
+
+TRE::Vec2<uint32> TRE::Window::getLatestSize() const
+{
+	const uint64 size = latestSize.load(std::memory_order_acquire);
+	return Vec2<uint32>(uint32(size >> 32), uint32(size));
+}
+
+uint32 TRE::Window::getEvents(Event* batch, uint32 maxEvents)
+{
+	this->PollEvents();
+	uint32 count = 0;
+
+	while (count < maxEvents && this->PopEvent(batch[count])) {
+		count++;
+	}
+
+	return count;
+}
+
+bool TRE::Window::PopEvent(Event& ev)
+{
+	if (events.empty())
+		return false;
+
+	ev = events.front();
+	events.pop();
+
+	// Only the latest position or size matters, what came in between is skipped
+	const bool coalesced = ev.Type == Event::TE_MOUSE_MOVE || ev.Type == Event::TE_RESIZE || ev.Type == Event::TE_MOVE;
+
+	while (coalesced && !events.empty() && events.front().Type == ev.Type) {
+		ev = events.front();
+		events.pop();
+	}
+
+	return true;
+}
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <queue>
+#include <thread>
 
 #include <Renderer/Backend/Common.hpp>
 #include <Renderer/Backend/Window/Event.hpp>
 #include <Legacy/Math/Vec.hpp>
 #include <Legacy/Math/Vec2.hpp>
+#include <Core/DataStructure/SpscRing.hpp>
 
 namespace WindowStyle
 {
@@ -46,7 +49,17 @@ public:
 	void setWindowTitle(const std::string& title);
 	void setVisible(bool visible);
 	void Close();
+
+	// Oldest event received, false once there are none left: call it until then every frame. Like getEvents, runs of
+	// mouse moves, resizes and moves come out as their last event
 	bool getEvent(Event& ev);
+
+	// Everything received since the last call, up to maxEvents. Runs of mouse moves, resizes and moves are merged into
+	// their last event, so a frame sees one of each however fast the system sends them
+	uint32 getEvents(Event* events, uint32 maxEvents);
+
+	// Size of the latest resize, even one still waiting in the event queue. Can be called from any thread
+	Vec2<uint32> getLatestSize() const;
 	bool isMouseButtonDown(MouseButton::mouse_button_t button) const;
 	bool isKeyDown(Key::key_t key) const;
 
@@ -71,6 +84,12 @@ public:
 	std::queue<Event> events;
 	bool mouse[3];
 	bool keys[100];
+	std::atomic<uint64> latestSize; // Width in the high bits
+
+	CONSTEXPR static usize EVENT_RING_SIZE = 1024;
+
+	// Pops the oldest event merged with the ones it can be coalesced with
+	bool PopEvent(Event& ev);
 
 #if defined( OS_WINDOWS )
 	HWND window;
@@ -86,8 +105,17 @@ public:
 	int screen;
 	int oldVideoMode;
 
+	// Filled by the event thread, drained on the thread polling events
+	SpscRing<Event, EVENT_RING_SIZE> eventRing;
+	std::thread eventThread;
+	std::atomic<bool> pumping;
+	Vec2<uint32> pumpedSize;     // What the event thread last saw, to only report changes
+	Vec2<int32> pumpedPosition;
+
 	void EnableFullscreen(bool enabled, int width = 0, int height = 0);
-	void WindowEvent(const XEvent& event);
+	void PumpEvents();
+	bool TranslateEvent(const XEvent& event, Event& ev);
+	void ApplyEvent(const Event& ev);
 	static Bool CheckEvent(Display*, XEvent* event, XPointer userData);
 #endif		
 
@@ -3,6 +3,7 @@
 #if defined(OS_WINDOWS)
 
 #include "Window.hpp"
+#include <chrono>
 
 TRE::Window::Window(uint width, uint height, const std::string& title, WindowStyle::window_style_t style)
 {
@@ -81,6 +82,7 @@ TRE::Window::Window(uint width, uint height, const std::string& title, WindowSty
 
 	windowSize.x = rect.right - rect.left;
 	windowSize.y = rect.bottom - rect.top;
+	latestSize.store(uint64(windowSize.x) << 32 | windowSize.y, std::memory_order_release);
 	this->open = true;
 	this->style = (DWORD)windowStyle;
 	mousePosition.x = 0;
@@ -140,11 +142,7 @@ bool TRE::Window::getEvent(Event& ev)
 	this->PollEvents();
 
 	// Return oldest event - if available
-	if (events.empty()) return false;
-
-	ev = events.front();
-	events.pop();
-	return true;
+	return this->PopEvent(ev);
 }
 
 void TRE::Window::PollEvents()
@@ -182,6 +180,7 @@ LRESULT TRE::Window::WindowEvent(UINT msg, WPARAM wParam, LPARAM lParam)
 	case WM_SIZE:
 		windowSize.x = GET_X_LPARAM(lParam);
 		windowSize.y = GET_Y_LPARAM(lParam);
+		latestSize.store(uint64(windowSize.x) << 32 | windowSize.y, std::memory_order_release);
 
 		if (events.empty()) {
 			ev.Type = Event::TE_RESIZE;
@@ -284,8 +283,10 @@ LRESULT TRE::Window::WindowEvent(UINT msg, WPARAM wParam, LPARAM lParam)
 		return DefWindowProc(window, msg, wParam, lParam);
 	}
 	// Add event to internal queue
-	if (ev.Type != Event::TE_UNKNOWN)
+	if (ev.Type != Event::TE_UNKNOWN) {
+		ev.Time = (uint64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 		events.push(ev);
+	}
 
 	return 0;
 }
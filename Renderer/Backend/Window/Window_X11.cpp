@@ -3,6 +3,8 @@
 #ifdef OS_LINUX
 
 #include "Window.hpp"
+#include <chrono>
+#include <poll.h>
 #include <string.h>
 #include <X11/Xutil.h>
 #include <X11/keysym.h>
@@ -110,8 +112,16 @@ Window::Window(uint width, uint height, const std::string& title, WindowStyle::w
 	mousePosition.x = 0;
 	mousePosition.y = 0;
 	this->open = true;
+	this->focus = false;
 	memset(this->mouse, 0, sizeof(this->mouse));
 	memset(this->keys, 0, sizeof(this->keys));
+
+	// Input is read on its own thread, polling events only drains what it queued
+	pumpedSize = windowSize;
+	pumpedPosition = windowPosition;
+	latestSize.store(uint64(width) << 32 | height, std::memory_order_release);
+	pumping.store(true, std::memory_order_release);
+	eventThread = std::thread(&Window::PumpEvents, this);
 }
 
 void* TRE::Window::GetNativeHandle()
@@ -121,7 +131,8 @@ void* TRE::Window::GetNativeHandle()
 
 Window::~Window()
 {
-	if (!open) return;
+	// Closed by the user the window still has its display and event thread
+	if (!display) return;
 
 	Close();
 }
@@ -160,31 +171,67 @@ void Window::setVisible(bool visible)
 
 void Window::Close()
 {
+	if (!display) return;
+
+	// The event thread reads from the display, it has to stop first
+	pumping.store(false, std::memory_order_release);
+
+	if (eventThread.joinable()) {
+		eventThread.join();
+	}
+
 	XDestroyWindow(display, window);
 	XFlush(display);
 
 	if (fullscreen) EnableFullscreen(false);
 
 	XCloseDisplay(display);
+	display = NULL;
 
 	open = false;
 }
 
 bool Window::getEvent(Event& ev)
 {
-	// Fetch new events
-	XEvent event;
-    while (XCheckIfEvent(display, &event, &CheckEvent, reinterpret_cast<XPointer>(window))){
-		WindowEvent(event);
-    }
+	this->PollEvents();
 
 	// Return oldest event - if available
-	if (events.empty()) 
-		return false;
+	return this->PopEvent(ev);
+}
+
+void Window::PollEvents()
+{
+	Event ev;
+
+	while (eventRing.TryPop(ev)) {
+		this->ApplyEvent(ev);
+		events.push(ev);
+	}
+}
+
+void Window::PumpEvents()
+{
+	const int connection = ConnectionNumber(display);
+	XEvent event;
+	Event ev;
+
+	while (pumping.load(std::memory_order_acquire)) {
+		while (XCheckIfEvent(display, &event, &CheckEvent, reinterpret_cast<XPointer>(window))) {
+			if (!this->TranslateEvent(event, ev))
+				continue;
 
-	ev = events.front();
-	events.pop();
-	return true;
+			ev.Time = (uint64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+			// Behind on a full ring: a mouse move is superseded by the next one anyway, anything else waits for room
+			while (!eventRing.TryPush(ev) && ev.Type != Event::TE_MOUSE_MOVE && pumping.load(std::memory_order_acquire)) {
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		}
+
+		// Sleep until the server sends something, waking up now and then to see if the window is closing
+		pollfd descriptor = { connection, POLLIN, 0 };
+		poll(&descriptor, 1, 10);
+	}
 }
 
 void Window::EnableFullscreen(bool enabled, int width, int height)
@@ -216,12 +263,16 @@ void Window::EnableFullscreen(bool enabled, int width, int height)
 
 void TRE::Window::WaitEvents()
 {
+	while (open && eventRing.IsEmpty()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
 
+	this->PollEvents();
 }
 
-void Window::WindowEvent(const XEvent& event)
+// Event thread, what it keeps track of is its own, the window state is only changed once the event is polled
+bool Window::TranslateEvent(const XEvent& event, Event& ev)
 {
-	Event ev;
 	ev.Type = Event::TE_UNKNOWN;
 
 	// Translate XEvent to Event
@@ -234,52 +285,37 @@ void Window::WindowEvent(const XEvent& event)
 	case ClientMessage:
 		if (Atom(event.xclient.data.l[0]) == close)
 		{
-			if (fullscreen) EnableFullscreen(false);
-			open = false;
 			ev.Type = Event::TE_CLOSE;
 		}
 		break;
 
 	case ConfigureNotify:
-		if ((uint)event.xconfigure.width != windowSize.x || (uint)event.xconfigure.height != windowSize.y)
+		if ((uint)event.xconfigure.width != pumpedSize.x || (uint)event.xconfigure.height != pumpedSize.y)
 		{
-			windowSize.x = event.xconfigure.width;
-			windowSize.y = event.xconfigure.height;
+			pumpedSize.x = event.xconfigure.width;
+			pumpedSize.y = event.xconfigure.height;
+			latestSize.store(uint64(pumpedSize.x) << 32 | pumpedSize.y, std::memory_order_release);
 
-			if (events.empty()) {
-				ev.Type = Event::TE_RESIZE;
-				ev.Window.Width = windowSize.x;
-				ev.Window.Height = windowSize.y;
-			}
-			else if (events.back().Type == Event::TE_RESIZE) {
-				events.back().Window.Width = windowSize.x;
-				events.back().Window.Height = windowSize.y;
-			}
+			ev.Type = Event::TE_RESIZE;
+			ev.Window.Width = pumpedSize.x;
+			ev.Window.Height = pumpedSize.y;
 		}
-		else if (event.xconfigure.x != windowPosition.x || event.xconfigure.y != windowPosition.y) {
-			windowPosition.x = event.xconfigure.x;
-			windowPosition.y = event.xconfigure.y;
-
-			if (events.empty()) {
-				ev.Type = Event::TE_MOVE;
-				ev.Window.X = windowPosition.x;
-				ev.Window.Y = windowPosition.y;
-			}
-			else if (events.back().Type == Event::TE_MOVE) {
-				events.back().Window.X = windowPosition.x;
-				events.back().Window.Y = windowPosition.y;
-			}
+		else if (event.xconfigure.x != pumpedPosition.x || event.xconfigure.y != pumpedPosition.y) {
+			pumpedPosition.x = event.xconfigure.x;
+			pumpedPosition.y = event.xconfigure.y;
+
+			ev.Type = Event::TE_MOVE;
+			ev.Window.X = pumpedPosition.x;
+			ev.Window.Y = pumpedPosition.y;
 		}
 		break;
 
 	case FocusIn:
 		ev.Type = Event::TE_FOCUS;
-		focus = true;
 		break;
 
 	case FocusOut:
 		ev.Type = Event::TE_BLUR;
-		focus = false;
 		break;
 
 	case KeyPress:
@@ -291,8 +327,6 @@ void Window::WindowEvent(const XEvent& event)
 		ev.Key.Alt = event.xkey.state & Mod1Mask;
 		ev.Key.Control = event.xkey.state & ControlMask;
 		ev.Key.Shift = event.xkey.state & ShiftMask;
-
-		keys[ev.Key.Code] = true;
 		break;
 
 	case KeyRelease:
@@ -303,8 +337,6 @@ void Window::WindowEvent(const XEvent& event)
 		ev.Key.Alt = event.xkey.state & Mod1Mask;
 		ev.Key.Control = event.xkey.state & ControlMask;
 		ev.Key.Shift = event.xkey.state & ShiftMask;
-
-		keys[ev.Key.Code] = false;
 		break;
 
 	case ButtonPress:
@@ -312,12 +344,10 @@ void Window::WindowEvent(const XEvent& event)
 
 		if (button == Button1 || button == Button2 || button == Button3)
 		{
-			mousePosition.x = event.xbutton.x;
-			mousePosition.y = event.xbutton.y;
 
 			ev.Type = Event::TE_MOUSE_BTN_DOWN;
-			ev.Mouse.X = mousePosition.x;
-			ev.Mouse.Y = mousePosition.y;
+			ev.Mouse.X = event.xbutton.x;
+			ev.Mouse.Y = event.xbutton.y;
 
 			if (button == Button1) ev.Mouse.Button = MouseButton::Left;
 			else if (button == Button2) ev.Mouse.Button = MouseButton::Middle;
@@ -330,44 +360,75 @@ void Window::WindowEvent(const XEvent& event)
 
 		if (button == Button1 || button == Button2 || button == Button3)
 		{
-			mousePosition.x = event.xbutton.x;
-			mousePosition.y = event.xbutton.y;
 
 			ev.Type = Event::TE_MOUSE_BTN_UP;
-			ev.Mouse.X = mousePosition.x;
-			ev.Mouse.Y = mousePosition.y;
+			ev.Mouse.X = event.xbutton.x;
+			ev.Mouse.Y = event.xbutton.y;
 
 			if (button == Button1) ev.Mouse.Button = MouseButton::Left;
 			else if (button == Button2) ev.Mouse.Button = MouseButton::Middle;
 			else if (button == Button3) ev.Mouse.Button = MouseButton::Right;
 		}
 		else if (button == Button4 || button == Button5) {
-			mousePosition.x = event.xbutton.x;
-			mousePosition.y = event.xbutton.y;
-
 			ev.Type = Event::TE_MOUSE_WHEEL;
 			ev.Mouse.Delta = button == Button4 ? 1 : -1;;
-			ev.Mouse.X = mousePosition.x;
-			ev.Mouse.Y = mousePosition.y;
+			ev.Mouse.X = event.xbutton.x;
+			ev.Mouse.Y = event.xbutton.y;
 		}
 		break;
 
 	case MotionNotify:
-		mousePosition.x = event.xmotion.x;
-		mousePosition.y = event.xmotion.y;
-
 		ev.Type = Event::TE_MOUSE_MOVE;
-		ev.Mouse.X = mousePosition.x;
-		ev.Mouse.Y = mousePosition.y;
+		ev.Mouse.X = event.xmotion.x;
+		ev.Mouse.Y = event.xmotion.y;
 		break;
     case DestroyNotify:
-        open = false;
+        ev.Type = Event::TE_CLOSE;
         break;
 	}
 
-	// Add event to internal queue
-	if (ev.Type != Event::TE_UNKNOWN)
-		events.push(ev);
+	return ev.Type != Event::TE_UNKNOWN;
+}
+
+// Thread polling events, the window state follows the events in the order they were received
+void Window::ApplyEvent(const Event& ev)
+{
+	switch (ev.Type)
+	{
+	case Event::TE_CLOSE:
+		if (open && fullscreen) EnableFullscreen(false);
+		open = false;
+		break;
+	case Event::TE_RESIZE:
+		windowSize.x = ev.Window.Width;
+		windowSize.y = ev.Window.Height;
+		break;
+	case Event::TE_MOVE:
+		windowPosition.x = ev.Window.X;
+		windowPosition.y = ev.Window.Y;
+		break;
+	case Event::TE_FOCUS:
+	case Event::TE_BLUR:
+		focus = ev.Type == Event::TE_FOCUS;
+		break;
+	case Event::TE_KEY_DOWN:
+	case Event::TE_KEY_UP:
+		keys[ev.Key.Code] = ev.Type == Event::TE_KEY_DOWN;
+		break;
+	case Event::TE_MOUSE_BTN_DOWN:
+	case Event::TE_MOUSE_BTN_UP:
+		mouse[ev.Mouse.Button] = ev.Type == Event::TE_MOUSE_BTN_DOWN;
+		mousePosition.x = ev.Mouse.X;
+		mousePosition.y = ev.Mouse.Y;
+		break;
+	case Event::TE_MOUSE_WHEEL:
+	case Event::TE_MOUSE_MOVE:
+		mousePosition.x = ev.Mouse.X;
+		mousePosition.y = ev.Mouse.Y;
+		break;
+	default:
+		break;
+	}
 }
 
 Bool Window::CheckEvent(Display*, XEvent* event, XPointer userData)
@@ -17,9 +17,16 @@ int main()
     using namespace TRE::Renderer;
     using namespace TRE;
 
+    // Logs go to the console and the last few runs' worth of files, written off the render thread
+    AsyncLog::AddSink(std::make_unique<ConsoleLogSink>());
+    AsyncLog::AddSink(std::make_unique<RotatingFileLogSink>("TrikytaEngine.log", 4 * 1024 * 1024, 3));
+    AsyncLog::Start();
+
     TRE::Window window(SCR_WIDTH, SCR_HEIGHT, "Trikyta ENGINE 3 (Vulkan 1.2)", WindowStyle::Resize);
     RenderBackend backend{ &window };
     // backend.SetSamplerCount(2);
+    // Lowest latency with vsync: a single frame in flight started just in time for the next vblank
+    // backend.SetFramePacing({ PresentMode::FIFO, 1, 0, 1000, true, true });
 
 #ifdef RASTER
     backend.InitInstance();
@@ -28,4 +35,6 @@ int main()
     backend.InitInstance(Features::RAY_TRACING);
     rt(backend);
 #endif
+
+    AsyncLog::Stop();
 }
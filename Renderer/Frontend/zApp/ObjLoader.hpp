@@ -17,6 +17,9 @@
 // Math.h - STD math Library
 #include <math.h>
 
+// MappedFile - Read-only file mapping, lines are parsed straight out of the mapping
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+
 // Print progress to console while loading (large models)
 #define OBJL_CONSOLE_OUTPUT
 
@@ -317,6 +320,20 @@ namespace objl
 				return false;
 		}
 
+		// Get the next line out of a memory range and advance the cursor
+		//	behaves like std::getline (no trailing empty line)
+		inline bool nextLine(const char*& cursor, const char* end, std::string& out)
+		{
+			if (cursor >= end)
+				return false;
+
+			const char* eol = (const char*)memchr(cursor, '\n', end - cursor);
+			const char* lineEnd = eol ? eol : end;
+			out.assign(cursor, lineEnd);
+			cursor = eol ? eol + 1 : end;
+			return true;
+		}
+
 		// Split a String into a string array at a given token
 		inline void split(const std::string& in,
 			std::vector<std::string>& out,
@@ -419,11 +436,14 @@ namespace objl
 				return false;
 
 
-			std::ifstream file(Path);
+			TRE::MappedFile file(Path.c_str(), TRE::MappedFile::HINT_SEQUENTIAL);
 
-			if (!file.is_open())
+			if (!file.IsOpen())
 				return false;
 
+			const char* cursor = (const char*)file.Data();
+			const char* end = cursor + file.Size();
+
 			LoadedMeshes.clear();
 			LoadedVertices.clear();
 			LoadedIndices.clear();
@@ -448,7 +468,7 @@ namespace objl
 #endif
 
 			std::string curline;
-			while (std::getline(file, curline)) {
+			while (algorithm::nextLine(cursor, end, curline)) {
 #ifdef OBJL_CONSOLE_OUTPUT
 				if ((outputIndicator = ((outputIndicator + 1) % outputEveryNth)) == 1) {
 					if (!meshname.empty()) {
@@ -639,7 +659,7 @@ namespace objl
 				LoadedMeshes.push_back(tempMesh);
 			}
 
-			file.close();
+			file.Close();
 
 			// Set Materials for each Mesh
 			for (int i = 0; i < MeshMatNames.size(); i++) {
@@ -927,19 +947,22 @@ namespace objl
 			if (path.substr(path.size() - 4, path.size()) != ".mtl")
 				return false;
 
-			std::ifstream file(path);
+			TRE::MappedFile file(path.c_str(), TRE::MappedFile::HINT_SEQUENTIAL);
 
 			// If the file is not found return false
-			if (!file.is_open())
+			if (!file.IsOpen())
 				return false;
 
+			const char* cursor = (const char*)file.Data();
+			const char* end = cursor + file.Size();
+
 			Material tempMaterial;
 
 			bool listening = false;
 
 			// Go through each line looking for material variables
 			std::string curline;
-			while (std::getline(file, curline)) {
+			while (algorithm::nextLine(cursor, end, curline)) {
 				// new material and material name
 				if (algorithm::firstToken(curline) == "newmtl") {
 					if (!listening) {
@@ -111,22 +111,6 @@ static bool HandleCameraEvent(Camera& camera, TRE::Event& e)
             start = !start;
             deltaTime = 0;
             break;
-        case Key::Z:
-            camera.ProcessKeyboard(FORWARD, speed * deltaTime);
-            updated = true;
-            break;
-        case Key::S:
-            camera.ProcessKeyboard(BACKWARD, speed * deltaTime);
-            updated = true;
-            break;
-        case Key::Q:
-            camera.ProcessKeyboard(LEFT, speed * deltaTime);
-            updated = true;
-            break;
-        case Key::D:
-            camera.ProcessKeyboard(RIGHT, speed * deltaTime);
-            updated = true;
-            break;
         case Key::Escape:
             disableCamera = !disableCamera;
         default:
@@ -154,4 +138,36 @@ static bool HandleCameraEvent(Camera& camera, TRE::Event& e)
     }
 
     return updated;
-}
\ No newline at end of file
+}
+
+// Held movement keys, polled once per frame after the events are drained so the camera moves every frame and not
+// only on the OS key repeats
+static bool HandleCameraKeys(Camera& camera, const TRE::Window& window)
+{
+    bool updated = false;
+
+    if (disableCamera)
+        return updated;
+
+    if (window.isKeyDown(Key::Z)) {
+        camera.ProcessKeyboard(FORWARD, speed * deltaTime);
+        updated = true;
+    }
+
+    if (window.isKeyDown(Key::S)) {
+        camera.ProcessKeyboard(BACKWARD, speed * deltaTime);
+        updated = true;
+    }
+
+    if (window.isKeyDown(Key::Q)) {
+        camera.ProcessKeyboard(LEFT, speed * deltaTime);
+        updated = true;
+    }
+
+    if (window.isKeyDown(Key::D)) {
+        camera.ProcessKeyboard(RIGHT, speed * deltaTime);
+        updated = true;
+    }
+
+    return updated;
+}
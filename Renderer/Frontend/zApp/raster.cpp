@@ -215,16 +215,7 @@ int raster(RenderBackend& backend)
     }*/
     std::vector<std::pair<BufferHandle, BufferHandle>> meshes;
 
-    std::string warn;
-    std::string err;
-    std::ifstream file("../Assets/sponza.obj");
-    std::stringstream objStream;
-
-    if (file) {
-        objStream << file.rdbuf();
-        file.close();
-    }
-    
+    // The loader parses the mapped file, nothing else reads it
     objl::Loader Loader;
     bool loadout = Loader.LoadFile("../Assets/sponza.obj");
 
@@ -255,13 +246,21 @@ int raster(RenderBackend& backend)
     //BufferHandle lightBuffer = dev.CreateBuffer({ sizeof(lightInfo), BufferUsage::STORAGE_BUFFER }, lightInfo);
 #endif
     // TODO: NEED WORK ON MEMORY FREEING!! (THIS IS DONE) (However we need to detect dedicated allocations from non dedicated allocs!)
-    /*int texWidth, texHeight, texChannels;
-    stbi_uc* pixels =  stbi_load("../Assets/box1.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * texChannels;
-    ImageHandle texture = dev.CreateImage(ImageCreateInfo::Texture2D(texWidth, texHeight, true), pixels);
+    /*TextureDecodeService textureDecoder;
+    textureDecoder.Init();
+    TextureDecodeHandle decodedTexture = textureDecoder.Decode("../Assets/box1.jpg");
+    textureDecoder.Wait(decodedTexture); // Decoding and mips run on the workers, only wait when the texture is needed
+    const CookedTexture& cooked = decodedTexture->GetTexture();
+    ImageInitialData textureLevels[16];
+
+    for (uint32 i = 0; i < cooked.levels.size(); i++) {
+        textureLevels[i] = { cooked.GetLevelData(i), cooked.levels[i].size };
+    }
+
+    ImageHandle texture = dev.CreateImage(ImageCreateInfo::PrebuiltTexture2D(cooked.width, cooked.height, (uint32)cooked.levels.size(),
+        (VkFormat)cooked.format), textureLevels, (uint32)cooked.levels.size());
     ImageViewHandle textureView = dev.CreateImageView(ImageViewCreateInfo::ImageView(texture, VK_IMAGE_VIEW_TYPE_2D));
-    SamplerHandle sampler = dev.CreateSampler(SamplerInfo::Sampler2D(texture));
-    free(pixels);*/
+    SamplerHandle sampler = dev.CreateSampler(SamplerInfo::Sampler2D(texture));*/
 
     Camera camera;
 
@@ -300,27 +299,33 @@ int raster(RenderBackend& backend)
 
     while (window.isOpen()) {
         auto tStart = std::chrono::high_resolution_clock::now();
-        window.getEvent(ev);
+        backend.WaitForNextFrame();
+        // Everything received since the last frame
+        while (window.getEvent(ev)) {
+            if (HandleCameraEvent(camera, ev)) {
+                // updateMVP(dev, uniformBuffer, glm::vec3(), camera);
+            }
 
-        if (HandleCameraEvent(camera, ev)) {
-            // updateMVP(dev, uniformBuffer, glm::vec3(), camera);
+            if (ev.Type == TRE::Event::TE_RESIZE) {
+                // printf("Event resize\n");
+                // backend.GetRenderContext().GetSwapchain().QueueSwapchainUpdate();
+                // continue;
+
+                const auto& currExtent = dev.GetRenderContext()->GetSwapchain().GetSwapchainData().swapChainExtent;
+                camera.SetPrespective(60.0f, (float)currExtent.width / (float)currExtent.height, 0.1f, 512.0f, true);
+            } else if (ev.Type == TRE::Event::TE_KEY_UP) {
+                if (ev.Key.Code == TRE::Key::L) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
+                    state.SaveChanges();
+                } else if (ev.Key.Code == TRE::Key::F) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
+                    state.SaveChanges();
+                }
+            }
         }
 
-        if (ev.Type == TRE::Event::TE_RESIZE) {
-            // printf("Event resize\n");
-            // backend.GetRenderContext().GetSwapchain().QueueSwapchainUpdate();
-            // continue;
-
-            const auto& currExtent = dev.GetRenderContext()->GetSwapchain().GetSwapchainData().swapChainExtent;
-            camera.SetPrespective(60.0f, (float)currExtent.width / (float)currExtent.height, 0.1f, 512.0f, true);
-        } else if (ev.Type == TRE::Event::TE_KEY_UP) {
-            if (ev.Key.Code == TRE::Key::L) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
-                state.SaveChanges();
-            } else if (ev.Key.Code == TRE::Key::F) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
-                state.SaveChanges();
-            }
+        if (HandleCameraKeys(camera, window)) {
+            // updateMVP(dev, uniformBuffer, glm::vec3(), camera);
         }
 
         // Using fences the performance is 1500-1800 fps
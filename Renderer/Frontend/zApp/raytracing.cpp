@@ -143,14 +143,34 @@ int rt(RenderBackend& backend)
 
     while (window.isOpen()) {
         auto tStart = std::chrono::high_resolution_clock::now();
-        window.getEvent(ev);
+        // Everything received since the last frame
+        bool resized = false;
+        bool cameraMoved = false;
+
+        while (window.getEvent(ev)) {
+            cameraMoved |= HandleCameraEvent(camera, ev);
+
+            if (ev.Type == TRE::Event::TE_RESIZE) {
+                resized = true;
+            } else if (ev.Type == TRE::Event::TE_KEY_UP) {
+                if (ev.Key.Code == TRE::Key::L) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
+                    state.SaveChanges();
+                } else if (ev.Key.Code == TRE::Key::F) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
+                    state.SaveChanges();
+                }
+            }
+        }
+
+        cameraMoved |= HandleCameraKeys(camera, window);
         auto currExtent = ctx.GetSwapchainExtent();
 
-        if (HandleCameraEvent(camera, ev)) {
+        if (cameraMoved) {
             updateCameraUBO(dev, ubo, camera);
         }
 
-        if (ev.Type == TRE::Event::TE_RESIZE || currExtent != lastExtent) {
+        if (resized || currExtent != lastExtent) {
             ctx.GetSwapchain().QueueSwapchainUpdate();
 
             rtImage = dev.CreateImage(ImageCreateInfo::RtRenderTarget(currExtent.width, currExtent.height));
@@ -165,14 +185,6 @@ int rt(RenderBackend& backend)
             dev.GetStagingManager().WaitPrevious();
             printf("Image re-created!\n");
             continue;
-        } else if (ev.Type == TRE::Event::TE_KEY_UP) {
-            if (ev.Key.Code == TRE::Key::L) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
-                state.SaveChanges();
-            } else if (ev.Key.Code == TRE::Key::F) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
-                state.SaveChanges();
-            }
         }
 
         backend.BeginFrame();
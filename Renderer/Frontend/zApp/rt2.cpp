@@ -6,6 +6,7 @@
 #include <chrono>
 #include <future>
 #include <Renderer/Backend/Backend.hpp>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
 
 #include "Shared.hpp"
 #include "Camera.hpp"
@@ -349,8 +350,8 @@ VkPipelineShaderStageCreateInfo loadShader(VkDevice dev, std::string fileName, V
     VkPipelineShaderStageCreateInfo shaderStage = {};
     shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStage.stage = stage;
-    auto shaderCode = TRE::Renderer::ReadShaderFile(fileName);
-    shaderStage.module = TRE::Renderer::ShaderProgram::CreateShaderModule(dev, shaderCode);
+    TRE::MappedFile shaderFile(fileName.c_str(), TRE::MappedFile::HINT_WILLNEED);
+    shaderStage.module = TRE::Renderer::ShaderProgram::CreateShaderModule(dev, shaderFile.Data(), shaderFile.Size());
     shaderStage.pName = "main";
     assert(shaderStage.module != VK_NULL_HANDLE);
     // shaderModules.push_back(shaderStage.module);
@@ -912,19 +913,26 @@ int rt()
 
     // D:/EngineDev/TrikytaEngine3D/Build/Renderer/x64/Debug/Renderer.exe
     while (window.isOpen()) {
-        window.getEvent(ev);
+        // Everything received since the last frame
+        bool resized = false;
+
+        while (window.getEvent(ev)) {
+            if (ev.Type == TRE::Event::TE_RESIZE) {
+                resized = true;
+            } else if (ev.Type == TRE::Event::TE_KEY_UP) {
+                if (ev.Key.Code == TRE::Key::L) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
+                    state.SaveChanges();
+                } else if (ev.Key.Code == TRE::Key::F) {
+                    state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
+                    state.SaveChanges();
+                }
+            }
+        }
 
-        if (ev.Type == TRE::Event::TE_RESIZE) {
+        if (resized) {
             backend.GetRenderContext().GetSwapchain().QueueSwapchainUpdate();
             continue;
-        } else if (ev.Type == TRE::Event::TE_KEY_UP) {
-            if (ev.Key.Code == TRE::Key::L) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_LINE;
-                state.SaveChanges();
-            } else if (ev.Key.Code == TRE::Key::F) {
-                state.GetRasterizationState().polygonMode = VK_POLYGON_MODE_FILL;
-                state.SaveChanges();
-            }
         }
 
         backend.BeginFrame();
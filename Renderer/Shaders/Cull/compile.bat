@@ -0,0 +1,2 @@
+%VULKAN_SDK%\Bin\glslc.exe --target-spv=spv1.4 --target-env=vulkan1.2 cull.comp -o cull.comp.spv
+pause
\ No newline at end of file
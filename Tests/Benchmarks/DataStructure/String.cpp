@@ -1,6 +1,11 @@
 #include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <string_view>
 #include <benchmark/benchmark.h>
 #include <Core/DataStructure/String.hpp>
+#include <Core/DataStructure/StringView.hpp>
+#include <Core/DataStructure/FromChars.hpp>
 
 using namespace TRE;
 
@@ -269,7 +274,7 @@ void StringErease(benchmark::State& state)
     std::uniform_int_distribution<> dist2(0, NB); // define the range
     usize idx = 0;
 
-    for (usize i = 0; i < NB; i++) {
+    for (benchmark::IterationCount i = 0; i < NB; i++) {
         usize p1 = dist2(gen) % (NB - 1);
         usize p2 = dist2(gen) % (NB - p1);
         ereasePos.emplace_back(p1, p2);
@@ -301,6 +306,160 @@ void StdStringErease(benchmark::State& state)
     }
 }
 
+// 64KB of lowercase text with the needle at the very end
+std::string GenerateSearchText(const char* needle)
+{
+    std::mt19937 gen(1337);
+    std::string text;
+
+    for (usize i = 0; i < 64 * 1024; i++) {
+        text.push_back('a' + gen() % 26);
+    }
+
+    text.replace(text.size() - strlen(needle), strlen(needle), needle);
+    return text;
+}
+
+// Lines of three floats, the way OBJ vertices look
+std::string GenerateFloatsText()
+{
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    std::string text;
+    char buffer[64];
+
+    for (usize i = 0; i < 10'000; i++) {
+        snprintf(buffer, sizeof(buffer), "v %.6f %.6f %.6f\n", dist(gen), dist(gen), dist(gen));
+        text += buffer;
+    }
+
+    return text;
+}
+
+void StringViewFind(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("needle");
+    const StringView view(text.data(), text.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view.Find("needle"));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void StdStringViewFind(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("needle");
+    const std::string_view view(text);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view.find("needle"));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void StringViewFindChar(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("!");
+    const StringView view(text.data(), text.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view.Find('!'));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void StdStringViewFindChar(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("!");
+    const std::string_view view(text);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view.find('!'));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void UtilsStrlen(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utils::Strlen(text.c_str()));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void StdStrlen(benchmark::State& state)
+{
+    const std::string text = GenerateSearchText("");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(strlen(text.c_str()));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// Splits the lines, skips the tag and the spaces, parses the floats
+void UtilsFromCharsLines(benchmark::State& state)
+{
+    const std::string text = GenerateFloatsText();
+
+    for (auto _ : state) {
+        StringView view(text.data(), text.size());
+        float sum = 0.f;
+
+        while (!view.Empty()) {
+            StringView line = view.PopLine();
+            line.RemovePrefix(1);
+
+            for (uint32 i = 0; i < 3; i++) {
+                line = line.TrimStart();
+                float value = 0.f;
+                const Utils::FromCharsResult result = Utils::FromChars(line.Data(), line.Data() + line.Size(), value);
+                line.RemovePrefix(usize(result.ptr - line.Data()));
+                sum += value;
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void StdStrtofLines(benchmark::State& state)
+{
+    const std::string text = GenerateFloatsText();
+
+    for (auto _ : state) {
+        const char* ptr = text.c_str();
+        float sum = 0.f;
+
+        while (*ptr) {
+            char* end = NULL;
+            ptr += 1;
+
+            for (uint32 i = 0; i < 3; i++) {
+                sum += strtof(ptr, &end);
+                ptr = end;
+            }
+
+            ptr = strchr(ptr, '\n') + 1;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
 // Register the function as a benchmark
 //BENCHMARK(StringEmptyDecl);
 //BENCHMARK(StdStringEmptyDecl);
@@ -331,3 +490,15 @@ void StdStringErease(benchmark::State& state)
 
 //BENCHMARK(StringAppend2);
 //BENCHMARK(StdStringAppend2);
+
+BENCHMARK(StringViewFind);
+BENCHMARK(StdStringViewFind);
+
+BENCHMARK(StringViewFindChar);
+BENCHMARK(StdStringViewFindChar);
+
+BENCHMARK(UtilsStrlen);
+BENCHMARK(StdStrlen);
+
+BENCHMARK(UtilsFromCharsLines);
+BENCHMARK(StdStrtofLines);
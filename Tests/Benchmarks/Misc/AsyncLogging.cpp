@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include <Core/Misc/AsyncLogging.hpp>
+
+using namespace TRE;
+
+// Throws the lines away, only the producer side is measured
+struct NullLogSink : public LogSink
+{
+    void Write(Log::LogType, const char*, usize) override {}
+};
+
+// What a call costs the thread logging: the typical renderer message, an integer, a float and a string
+void AsyncLog_Write(benchmark::State& state)
+{
+    AsyncLog::AddSink(std::make_unique<NullLogSink>());
+    AsyncLogSettings settings;
+    settings.ringSize = 1 << 20;
+    AsyncLog::Start(settings);
+    uint32 i = 0;
+
+    for (auto _ : state) {
+        AsyncLog::Write(Log::INFO, "Frame %u took %.3f ms in pass %s", i++, 16.6, "GBuffer");
+    }
+
+    AsyncLog::Stop();
+    AsyncLog::ClearSinks();
+}
+
+// The formatting alone, what the caller did before
+void AsyncLog_Snprintf(benchmark::State& state)
+{
+    char buffer[256];
+    uint32 i = 0;
+
+    for (auto _ : state) {
+        snprintf(buffer, sizeof(buffer), "Frame %u took %.3f ms in pass %s", i++, 16.6, "GBuffer");
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+// Formatting and writing on the calling thread, like Log::Write, with the logging thread stopped
+void AsyncLog_SyncWrite(benchmark::State& state)
+{
+#if defined(OS_WINDOWS)
+    AsyncLog::AddSink(std::make_unique<FileLogSink>("NUL"));
+#else
+    AsyncLog::AddSink(std::make_unique<FileLogSink>("/dev/null"));
+#endif
+    uint32 i = 0;
+
+    for (auto _ : state) {
+        AsyncLog::Write(Log::INFO, "Frame %u took %.3f ms in pass %s", i++, 16.6, "GBuffer");
+    }
+
+    AsyncLog::ClearSinks();
+}
+
+// Compiled out calls, arguments included
+void AsyncLog_Filtered(benchmark::State& state)
+{
+    uint32 i = 0;
+
+    for (auto _ : state) {
+        TRE_ALOG(Log::DEBUG_INFO, "Frame %u took %.3f ms in pass %s", i++, 16.6, "GBuffer");
+        benchmark::DoNotOptimize(i);
+    }
+}
+
+BENCHMARK(AsyncLog_Write);
+BENCHMARK(AsyncLog_Snprintf);
+BENCHMARK(AsyncLog_SyncWrite);
+BENCHMARK(AsyncLog_Filtered);
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <Legacy/Profiler/Profiler.hpp>
+
+using namespace TRE;
+
+// Traces go to the build directory, ~100 bytes an event
+static std::string TracePath(const char* name)
+{
+    return std::string(TRE_BENCHMARK_OUTPUT_DIR) + "/" + name;
+}
+
+// A tight loop ends zones faster than the writer thread takes them, the thread writes its events itself every half
+// ring. The flushes are timed: the result is what a zone costs when every event makes it to the trace.
+static void FlushBurst(uint32& recorded, uint32 burstSize)
+{
+    if (++recorded == burstSize) {
+        Profiler::Instance().Flush();
+        recorded = 0;
+    }
+}
+
+// The floor of an enabled zone, it takes two
+void ProfileTimestamp(benchmark::State& state)
+{
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Profiler::Now());
+    }
+}
+
+void ProfileZoneDisabled(benchmark::State& state)
+{
+    Profiler::Instance().SetEnabled(false);
+
+    for (auto _ : state) {
+        TRE_PROFILE_SCOPE("ProfileZoneDisabled");
+        benchmark::ClobberMemory();
+    }
+
+    Profiler::Instance().SetEnabled(true);
+}
+
+void ProfileZoneEnabled(benchmark::State& state)
+{
+    const std::string path = TracePath("profiler_benchmark.json");
+    Profiler::Instance().BeginSession("Benchmark", path.c_str());
+    const uint32 burstSize = Profiler::Instance().GetThreadBufferCapacity() / 2;
+    uint32 recorded = 0;
+
+    for (auto _ : state) {
+        {
+            TRE_PROFILE_SCOPE("ProfileZoneEnabled");
+            benchmark::ClobberMemory();
+        }
+
+        FlushBurst(recorded, burstSize);
+    }
+
+    state.counters["Dropped"] = (double)Profiler::Instance().GetDroppedCount();
+    Profiler::Instance().EndSession();
+}
+
+void ProfileZoneEnabledMultiThread(benchmark::State& state)
+{
+    if (state.thread_index() == 0) {
+        const std::string path = TracePath("profiler_benchmark_mt.json");
+        Profiler::Instance().BeginSession("Benchmark", path.c_str());
+    }
+
+    const uint32 burstSize = Profiler::Instance().GetThreadBufferCapacity() / 2;
+    uint32 recorded = 0;
+
+    for (auto _ : state) {
+        {
+            TRE_PROFILE_SCOPE("ProfileZoneEnabledMultiThread");
+            benchmark::ClobberMemory();
+        }
+
+        FlushBurst(recorded, burstSize);
+    }
+
+    if (state.thread_index() == 0) {
+        state.counters["Dropped"] = (double)Profiler::Instance().GetDroppedCount();
+        Profiler::Instance().EndSession();
+    }
+}
+
+// What a zone ending costs once its thread's ring is full: nothing drains it outside of a session, past the first
+// ring every event is dropped
+void ProfileZoneRingFull(benchmark::State& state)
+{
+    Profiler& profiler = Profiler::Instance();
+
+    for (auto _ : state) {
+        profiler.Record("ProfileZoneRingFull", Profiler::Now(), Profiler::Now());
+    }
+
+    state.counters["Capacity"] = (double)profiler.GetThreadBufferCapacity();
+}
+
+BENCHMARK(ProfileTimestamp);
+BENCHMARK(ProfileZoneDisabled);
+// A fixed count keeps the traces around 50 MB
+BENCHMARK(ProfileZoneEnabled)->Iterations(1 << 19);
+BENCHMARK(ProfileZoneEnabledMultiThread)->Threads(4)->Iterations(1 << 17);
+BENCHMARK(ProfileZoneRingFull);
@@ -0,0 +1,255 @@
+#include <benchmark/benchmark.h>
+#include <math.h>
+#include <random>
+#include <thread>
+#include <vector>
+#include <Renderer/Backend/Core/Bvh/MeshBvh.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+constexpr uint32 FLOOR_CELLS = 256;
+constexpr uint32 COLUMN_COUNT = 64;
+constexpr uint32 COLUMN_SEGMENTS = 32;
+constexpr uint32 COLUMN_RINGS = 32;
+constexpr uint32 IMAGE_SIZE = 256;
+
+// Sponza-class stand-in, 262k triangles: a bumpy floor under two colonnades, big and small triangles mixed
+struct BenchScene
+{
+    std::vector<float> positions;
+    std::vector<uint32> indices;
+
+    BenchScene()
+    {
+        const float size = 40.f;
+
+        for (uint32 z = 0; z <= FLOOR_CELLS; z++) {
+            for (uint32 x = 0; x <= FLOOR_CELLS; x++) {
+                const float fx = float(x) / FLOOR_CELLS, fz = float(z) / FLOOR_CELLS;
+                this->AddVertex((fx - 0.5f) * size, 0.1f * sinf(fx * 40.f) * cosf(fz * 40.f), (fz - 0.5f) * size);
+            }
+        }
+
+        this->AddGrid(0, FLOOR_CELLS, FLOOR_CELLS, false);
+
+        for (uint32 c = 0; c < COLUMN_COUNT; c++) {
+            const float cx = (c % 2 ? 1.f : -1.f) * 6.f;
+            const float cz = (float(c / 2) / (COLUMN_COUNT / 2) - 0.5f) * size * 0.9f;
+            const uint32 base = uint32(positions.size() / 3);
+
+            for (uint32 ring = 0; ring <= COLUMN_RINGS; ring++) {
+                const float y = float(ring) / COLUMN_RINGS * 12.f;
+                const float radius = 0.5f + 0.05f * sinf(y * 3.f);
+
+                for (uint32 s = 0; s <= COLUMN_SEGMENTS; s++) {
+                    const float angle = float(s) / COLUMN_SEGMENTS * 6.2831853f;
+                    this->AddVertex(cx + cosf(angle) * radius, y, cz + sinf(angle) * radius);
+                }
+            }
+
+            this->AddGrid(base, COLUMN_SEGMENTS, COLUMN_RINGS, true);
+        }
+    }
+
+    void AddVertex(float x, float y, float z)
+    {
+        positions.push_back(x);
+        positions.push_back(y);
+        positions.push_back(z);
+    }
+
+    void AddGrid(uint32 base, uint32 width, uint32 height, bool flip)
+    {
+        for (uint32 y = 0; y < height; y++) {
+            for (uint32 x = 0; x < width; x++) {
+                const uint32 i = base + y * (width + 1) + x;
+                const uint32 quad[6] = { i, i + width + 1, i + 1, i + 1, i + width + 1, i + width + 2 };
+
+                for (uint32 k = 0; k < 6; k++) {
+                    indices.push_back(quad[flip ? 5 - k : k]);
+                }
+            }
+        }
+    }
+
+    uint32 GetTriangleCount() const { return uint32(indices.size() / 3); }
+
+    void Build(MeshBvh& bvh, uint32 threadCount) const
+    {
+        BvhBuildSettings settings;
+        settings.threadCount = threadCount;
+        bvh.Build(positions.data(), uint32(positions.size() / 3), 3 * sizeof(float), indices.data(), this->GetTriangleCount(), settings);
+    }
+};
+
+static const BenchScene& GetScene()
+{
+    static const BenchScene scene;
+    return scene;
+}
+
+static const MeshBvh& GetBvh()
+{
+    static MeshBvh bvh;
+
+    if (bvh.IsEmpty()) {
+        GetScene().Build(bvh, std::thread::hardware_concurrency());
+    }
+
+    return bvh;
+}
+
+// Pinhole camera down the nave, slightly tilted towards the floor
+static BvhRay CameraRay(uint32 x, uint32 y)
+{
+    const float origin[3] = { 0.f, 3.f, -18.f };
+    const float direction[3] = { (float(x) + 0.5f) / IMAGE_SIZE - 0.5f, 0.4f - (float(y) + 0.5f) / IMAGE_SIZE, 1.f };
+    return BvhRay(origin, direction);
+}
+
+static void SetRaysCounter(benchmark::State& state, uint64 raysPerIteration)
+{
+    state.counters["Mrays/s"] = benchmark::Counter(double(state.iterations() * raysPerIteration) / 1e6, benchmark::Counter::kIsRate);
+}
+
+void Bvh_Build(benchmark::State& state)
+{
+    const BenchScene& scene = GetScene();
+
+    for (auto _ : state) {
+        MeshBvh bvh;
+        scene.Build(bvh, (uint32)state.range(0));
+        benchmark::DoNotOptimize(bvh.GetNodeCount());
+    }
+
+    state.SetItemsProcessed(state.iterations() * scene.GetTriangleCount());
+}
+
+void Bvh_PrimaryRays(benchmark::State& state)
+{
+    const MeshBvh& bvh = GetBvh();
+
+    for (auto _ : state) {
+        uint32 hits = 0;
+
+        for (uint32 y = 0; y < IMAGE_SIZE; y++) {
+            for (uint32 x = 0; x < IMAGE_SIZE; x++) {
+                BvhRay ray = CameraRay(x, y);
+                BvhHit hit;
+                hits += bvh.Intersect(ray, hit);
+            }
+        }
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    SetRaysCounter(state, IMAGE_SIZE * IMAGE_SIZE);
+}
+
+// Same rays as 2x2 pixel packets
+void Bvh_PrimaryPackets(benchmark::State& state)
+{
+    const MeshBvh& bvh = GetBvh();
+
+    for (auto _ : state) {
+        uint32 hits = 0;
+
+        for (uint32 y = 0; y < IMAGE_SIZE; y += 2) {
+            for (uint32 x = 0; x < IMAGE_SIZE; x += 2) {
+                BvhRayPacket4 packet;
+                BvhHit results[4];
+
+                for (uint32 lane = 0; lane < 4; lane++) {
+                    packet.SetRay(lane, CameraRay(x + lane % 2, y + lane / 2));
+                }
+
+                hits += bvh.Intersect(packet, results);
+            }
+        }
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    SetRaysCounter(state, IMAGE_SIZE * IMAGE_SIZE);
+}
+
+// Random origins and directions, what diffuse bounces look like
+void Bvh_IncoherentRays(benchmark::State& state)
+{
+    const MeshBvh& bvh = GetBvh();
+    const BvhAabb& bounds = bvh.GetBounds();
+    constexpr uint32 RAY_COUNT = 65536;
+    std::vector<BvhRay> rays(RAY_COUNT);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    for (BvhRay& ray : rays) {
+        float origin[3], direction[3];
+
+        for (uint32 axis = 0; axis < 3; axis++) {
+            origin[axis] = bounds.min[axis] + (bounds.max[axis] - bounds.min[axis]) * dist(gen);
+            direction[axis] = dist(gen) * 2.f - 1.f;
+        }
+
+        ray = BvhRay(origin, direction);
+    }
+
+    for (auto _ : state) {
+        uint32 hits = 0;
+
+        for (const BvhRay& source : rays) {
+            BvhRay ray = source;
+            BvhHit hit;
+            hits += bvh.Intersect(ray, hit);
+        }
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    SetRaysCounter(state, RAY_COUNT);
+}
+
+// From the camera hits towards a light above the colonnade, any hit will do
+void Bvh_ShadowRays(benchmark::State& state)
+{
+    const MeshBvh& bvh = GetBvh();
+    const float light[3] = { 2.f, 11.f, 4.f };
+    std::vector<BvhRay> rays;
+
+    for (uint32 y = 0; y < IMAGE_SIZE; y++) {
+        for (uint32 x = 0; x < IMAGE_SIZE; x++) {
+            BvhRay ray = CameraRay(x, y);
+            BvhHit hit;
+
+            if (bvh.Intersect(ray, hit)) {
+                float origin[3], direction[3];
+
+                for (uint32 axis = 0; axis < 3; axis++) {
+                    origin[axis] = ray.origin[axis] + ray.direction[axis] * hit.t;
+                    direction[axis] = light[axis] - origin[axis];
+                }
+
+                rays.push_back(BvhRay(origin, direction, 1e-3f, 1.f));
+            }
+        }
+    }
+
+    for (auto _ : state) {
+        uint32 occluded = 0;
+
+        for (const BvhRay& ray : rays) {
+            occluded += bvh.Occluded(ray);
+        }
+
+        benchmark::DoNotOptimize(occluded);
+    }
+
+    SetRaysCounter(state, rays.size());
+}
+
+BENCHMARK(Bvh_Build)->Arg(1)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(Bvh_PrimaryRays)->Unit(benchmark::kMillisecond);
+BENCHMARK(Bvh_PrimaryPackets)->Unit(benchmark::kMillisecond);
+BENCHMARK(Bvh_IncoherentRays)->Unit(benchmark::kMillisecond);
+BENCHMARK(Bvh_ShadowRays)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <stdlib.h>
+#include <Renderer/Backend/RHI/DrawQueue/DrawQueue.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+constexpr usize DRAW_COUNT = 100'000;
+constexpr uint32 PIPELINE_COUNT = 64;
+constexpr uint32 MATERIAL_COUNT = 512;
+
+struct BenchPipeline { uint32 id; };
+struct BenchBuffer { uint32 id; };
+typedef BasicDrawPacket<BenchPipeline, uint64, BenchBuffer> BenchPacket;
+
+// Counts what would reach the command buffer
+struct BenchRecorder
+{
+    uint64 work = 0;
+
+    FORCEINLINE void BindPipeline(const BenchPipeline& pipeline) { work += pipeline.id; }
+
+    FORCEINLINE void BindDescriptorSets(const BenchPipeline&, uint32 first, const uint64* sets, uint32 count, const uint32*, uint32)
+    {
+        work += first + sets[0] + count;
+    }
+
+    FORCEINLINE void BindVertexBuffer(const BenchBuffer& buffer, uint64 offset) { work += buffer.id + offset; }
+
+    FORCEINLINE void BindIndexBuffer(const BenchBuffer& buffer, uint64 offset, uint8) { work += buffer.id + offset; }
+
+    FORCEINLINE void Draw(uint32 count, uint32, uint32, uint32) { work += count; }
+
+    FORCEINLINE void DrawIndexed(uint32 count, uint32, uint32, int32, uint32) { work += count; }
+};
+
+static BenchPipeline pipelines[PIPELINE_COUNT];
+static BenchBuffer buffers[2] = { { 1 }, { 2 } };
+
+static void FillQueue(DrawQueue<BenchPacket>& queue)
+{
+    std::mt19937 gen(1337);
+    queue.Reset();
+
+    for (usize i = 0; i < DRAW_COUNT; i++) {
+        const uint32 pipeline = gen() % PIPELINE_COUNT;
+        const uint32 material = gen() % MATERIAL_COUNT;
+        const uint32 pass = gen() % 4;
+        BenchPacket& packet = queue.Push(DrawKey::Encode(pass, pipeline * 0x9E3779B97F4A7C15ull, material, gen() & 0xFFFFFF));
+        packet = {};
+        packet.pipeline = &pipelines[pipeline];
+        packet.vertexBuffer = &buffers[0];
+        packet.indexBuffer = &buffers[1];
+        packet.descriptorSets[0] = 1;
+        packet.descriptorSets[1] = material;
+        packet.descriptorSetCount = 2;
+        packet.count = 36;
+        packet.instanceCount = 1;
+    }
+}
+
+void DrawQueue_RadixSort(benchmark::State& state)
+{
+    DrawQueue<BenchPacket> queue(DRAW_COUNT);
+    DrawQueue<BenchPacket> source(DRAW_COUNT);
+    FillQueue(source);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        queue = source;
+        state.ResumeTiming();
+        queue.Sort((uint32)state.range(0));
+        benchmark::DoNotOptimize(queue.GetItems());
+    }
+
+    state.SetItemsProcessed(state.iterations() * DRAW_COUNT);
+}
+
+// Reference: the legacy command bucket sorts its packets with qsort
+void DrawQueue_QSort(benchmark::State& state)
+{
+    typedef DrawQueue<BenchPacket>::Item Item;
+    DrawQueue<BenchPacket> source(DRAW_COUNT);
+    FillQueue(source);
+    std::vector<Item> items;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        items.assign(source.GetItems(), source.GetItems() + source.Size());
+        state.ResumeTiming();
+        qsort(items.data(), items.size(), sizeof(Item), [](const void* a, const void* b) {
+            const uint64 ka = ((const Item*)a)->key, kb = ((const Item*)b)->key;
+            return (ka > kb) - (ka < kb);
+        });
+        benchmark::DoNotOptimize(items.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * DRAW_COUNT);
+}
+
+void DrawQueue_StdSort(benchmark::State& state)
+{
+    typedef DrawQueue<BenchPacket>::Item Item;
+    DrawQueue<BenchPacket> source(DRAW_COUNT);
+    FillQueue(source);
+    std::vector<Item> items;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        items.assign(source.GetItems(), source.GetItems() + source.Size());
+        state.ResumeTiming();
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+        benchmark::DoNotOptimize(items.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * DRAW_COUNT);
+}
+
+void DrawQueue_Replay(benchmark::State& state)
+{
+    DrawQueue<BenchPacket> queue(DRAW_COUNT);
+    FillQueue(queue);
+    queue.Sort();
+    DrawReplayStats stats{};
+
+    for (auto _ : state) {
+        BenchRecorder recorder;
+        stats = ReplayDraws(queue, recorder);
+        benchmark::DoNotOptimize(recorder.work);
+    }
+
+    state.SetItemsProcessed(state.iterations() * DRAW_COUNT);
+    state.counters["PipelineBinds"] = stats.pipelineBinds;
+    state.counters["SetBinds"] = stats.descriptorSetBinds;
+}
+
+BENCHMARK(DrawQueue_RadixSort)->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(DrawQueue_QSort)->Unit(benchmark::kMicrosecond);
+BENCHMARK(DrawQueue_StdSort)->Unit(benchmark::kMicrosecond);
+BENCHMARK(DrawQueue_Replay)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/Texture/BCn/BCn.hpp>
+#include <Renderer/Backend/Texture/MipChain/MipChain.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+constexpr uint32 TEXTURE_SIZE = 512;
+
+static const TextureImage& GetBenchImage()
+{
+    static TextureImage image;
+
+    if (image.pixels.empty()) {
+        std::mt19937 gen(1337);
+        image.Resize(TEXTURE_SIZE, TEXTURE_SIZE);
+
+        for (uint32 y = 0; y < TEXTURE_SIZE; y++) {
+            for (uint32 x = 0; x < TEXTURE_SIZE; x++) {
+                uint8* texel = image.pixels.data() + (y * TEXTURE_SIZE + x) * 4;
+                texel[0] = uint8(x / 2 + gen() % 8);
+                texel[1] = uint8(y / 2 + gen() % 8);
+                texel[2] = uint8((x ^ y) & 0xFF);
+                texel[3] = uint8(255 - x / 2);
+            }
+        }
+    }
+
+    return image;
+}
+
+static void TextureCooker_Compress(benchmark::State& state)
+{
+    const TextureFormat format = (TextureFormat)state.range(0);
+    const TextureImage& image = GetBenchImage();
+    std::vector<uint8> blocks;
+
+    for (auto _ : state) {
+        BCn::CompressImage(image, format, blocks);
+        benchmark::DoNotOptimize(blocks.data());
+    }
+
+    // Throughput in source texels
+    state.SetItemsProcessed(state.iterations() * TEXTURE_SIZE * TEXTURE_SIZE);
+}
+
+static void TextureCooker_MipChain(benchmark::State& state)
+{
+    const TextureImage& image = GetBenchImage();
+    MipChainOptions options;
+    options.filter = (MipFilter)state.range(0);
+    options.srgb = state.range(1) != 0;
+    std::vector<TextureImage> levels;
+
+    for (auto _ : state) {
+        GenerateMipChain(image.pixels.data(), image.width, image.height, options, levels);
+        benchmark::DoNotOptimize(levels.back().pixels.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * TEXTURE_SIZE * TEXTURE_SIZE);
+}
+
+BENCHMARK(TextureCooker_Compress)
+    ->Arg((int64_t)TextureFormat::BC1_RGBA_UNORM)
+    ->Arg((int64_t)TextureFormat::BC3_UNORM)
+    ->Arg((int64_t)TextureFormat::BC5_UNORM)
+    ->Arg((int64_t)TextureFormat::BC7_UNORM)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(TextureCooker_MipChain)
+    ->Args({ (int64_t)MipFilter::BOX, 0 })
+    ->Args({ (int64_t)MipFilter::BOX, 1 })
+    ->Args({ (int64_t)MipFilter::KAISER, 1 })
+    ->Unit(benchmark::kMillisecond);
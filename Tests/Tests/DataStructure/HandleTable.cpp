@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <Core/DataStructure/HandleTable.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct Tracked
+    {
+        Tracked(uint64 value, std::atomic<int32>* alive) : value(value), alive(alive) { (*alive)++; }
+
+        ~Tracked() { (*alive)--; }
+
+        uint64 value;
+        std::atomic<int32>* alive;
+    };
+
+    typedef HandleTable<Tracked, 64> SmallTable;
+}
+
+TEST(HandleTable, AcquireGetRelease)
+{
+    std::atomic<int32> alive = 0;
+    SmallTable table;
+
+    const SmallTable::Handle a = table.Acquire(1, &alive);
+    const SmallTable::Handle b = table.Acquire(2, &alive);
+    ASSERT_FALSE(a.IsNull());
+    ASSERT_NE(a.index, b.index);
+    ASSERT_EQ(table.Get(a)->value, 1u);
+    ASSERT_EQ(table.Get(b)->value, 2u);
+    ASSERT_EQ(table.GetCount(), 2u);
+    ASSERT_EQ(alive, 2);
+
+    ASSERT_TRUE(table.Release(a));
+    ASSERT_FALSE(table.Release(a));
+    ASSERT_EQ(table.Get(a), nullptr);
+    ASSERT_EQ(alive, 1);
+
+    // The slot comes back with a new generation, the old handle stays stale
+    const SmallTable::Handle c = table.Acquire(3, &alive);
+    ASSERT_EQ(c.index, a.index);
+    ASSERT_NE(c.generation, a.generation);
+    ASSERT_EQ(table.Get(a), nullptr);
+    ASSERT_FALSE(table.Release(a));
+    ASSERT_EQ(table.Get(c)->value, 3u);
+
+    // Null, forged and round-tripped handles
+    ASSERT_EQ(table.Get(SmallTable::Handle{}), nullptr);
+    ASSERT_EQ(table.Get(SmallTable::Handle{ 1000, 1 }), nullptr);
+    ASSERT_EQ(table.Get(SmallTable::Handle::FromUInt64(c.ToUInt64())), table.Get(c));
+}
+
+TEST(HandleTable, PointersSurviveGrowth)
+{
+    std::atomic<int32> alive = 0;
+    std::vector<std::pair<SmallTable::Handle, Tracked*>> objects;
+
+    {
+        SmallTable table;
+
+        for (uint64 i = 0; i < 1000; i++) {
+            const SmallTable::Handle handle = table.Acquire(i, &alive);
+            objects.emplace_back(handle, table.Get(handle));
+        }
+
+        for (uint64 i = 0; i < objects.size(); i++) {
+            ASSERT_EQ(table.Get(objects[i].first), objects[i].second);
+            ASSERT_EQ(objects[i].second->value, i);
+        }
+
+        uint32 visited = 0;
+        table.ForEach([&](SmallTable::Handle, Tracked& object) {
+            ASSERT_EQ(&object, objects[object.value].second);
+            visited++;
+        });
+        ASSERT_EQ(visited, 1000u);
+    }
+
+    // The table destroys what's left
+    ASSERT_EQ(alive, 0);
+}
+
+TEST(HandleTable, RunsOutOfSlots)
+{
+    typedef HandleTable<Tracked, 4, 2> TinyTable;
+    std::atomic<int32> alive = 0;
+    TinyTable table;
+    TinyTable::Handle handles[8];
+
+    for (uint32 i = 0; i < 8; i++) {
+        handles[i] = table.Acquire(i, &alive);
+        ASSERT_FALSE(handles[i].IsNull());
+    }
+
+    ASSERT_TRUE(table.Acquire(8, &alive).IsNull());
+    ASSERT_EQ(table.GetCapacity(), 8u);
+
+    ASSERT_TRUE(table.Release(handles[3]));
+    const TinyTable::Handle handle = table.Acquire(9, &alive);
+    ASSERT_EQ(handle.index, 3u);
+    ASSERT_EQ(alive, 8);
+}
+
+// Workers acquire, check and release concurrently, every handle they ever saw released must stay stale
+TEST(HandleTable, ConcurrentAcquireRelease)
+{
+    CONSTEXPR uint32 THREADS = 8;
+    CONSTEXPR uint32 STEPS = 20'000;
+    std::atomic<int32> alive = 0;
+    std::atomic<uint32> errors = 0;
+    SmallTable table;
+    std::vector<std::vector<SmallTable::Handle>> kept(THREADS);
+    std::vector<std::thread> threads;
+
+    for (uint32 t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            std::vector<SmallTable::Handle> owned, released;
+
+            for (uint32 step = 0; step < STEPS; step++) {
+                if (owned.empty() || gen() % 3) {
+                    const uint64 value = uint64(t) << 32 | step;
+                    const SmallTable::Handle handle = table.Acquire(value, &alive);
+                    const Tracked* object = table.Get(handle);
+                    errors += !object || object->value != value;
+                    owned.push_back(handle);
+                } else {
+                    const uint32 index = gen() % owned.size();
+                    errors += !table.Release(owned[index]);
+                    released.push_back(owned[index]);
+                    owned[index] = owned.back();
+                    owned.pop_back();
+                }
+            }
+
+            for (const SmallTable::Handle& handle : released) {
+                errors += table.Get(handle) != NULL;
+            }
+
+            for (const SmallTable::Handle& handle : owned) {
+                const Tracked* object = table.Get(handle);
+                errors += !object || (object->value >> 32) != t;
+            }
+
+            kept[t] = owned;
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(errors, 0u);
+
+    uint32 total = 0;
+
+    for (const std::vector<SmallTable::Handle>& owned : kept) {
+        total += (uint32)owned.size();
+    }
+
+    ASSERT_EQ(table.GetCount(), total);
+    ASSERT_EQ(alive, (int32)total);
+    ASSERT_LE(table.GetCapacity(), total + THREADS * 256);
+}
+
+// Many threads racing to release the same handles, each object is destroyed exactly once
+TEST(HandleTable, ConcurrentDoubleRelease)
+{
+    CONSTEXPR uint32 THREADS = 4;
+    CONSTEXPR uint32 COUNT = 4096;
+    std::atomic<int32> alive = 0;
+    std::atomic<uint32> released = 0;
+    SmallTable table;
+    std::vector<SmallTable::Handle> handles;
+
+    for (uint32 i = 0; i < COUNT; i++) {
+        handles.push_back(table.Acquire(i, &alive));
+    }
+
+    std::vector<std::thread> threads;
+
+    for (uint32 t = 0; t < THREADS; t++) {
+        threads.emplace_back([&]() {
+            for (const SmallTable::Handle& handle : handles) {
+                released += table.Release(handle);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(released, COUNT);
+    ASSERT_EQ(alive, 0);
+    ASSERT_EQ(table.GetCount(), 0u);
+}
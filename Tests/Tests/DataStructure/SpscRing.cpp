@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <Core/DataStructure/SpscRing.hpp>
+
+using namespace TRE;
+
+TEST(SpscRing, PushPopWrapAround)
+{
+    SpscRing<uint32, 4> ring;
+    uint32 value;
+
+    ASSERT_TRUE(ring.IsEmpty());
+    ASSERT_FALSE(ring.TryPop(value));
+    ASSERT_EQ(ring.Peek(), nullptr);
+
+    // Go around the ring a few times, filling it up each time
+    for (uint32 round = 0; round < 5; round++) {
+        for (uint32 i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.TryPush(round * 10 + i));
+        }
+
+        ASSERT_FALSE(ring.TryPush(99));
+        ASSERT_EQ(ring.Size(), 4u);
+        ASSERT_EQ(*ring.Peek(), round * 10);
+
+        for (uint32 i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.TryPop(value));
+            ASSERT_EQ(value, round * 10 + i);
+        }
+
+        ASSERT_FALSE(ring.TryPop(value));
+    }
+
+    // Interleaved
+    ASSERT_TRUE(ring.TryPush(1));
+    ASSERT_TRUE(ring.TryPush(2));
+    ASSERT_TRUE(ring.TryPop(value));
+    ASSERT_EQ(value, 1u);
+    ASSERT_TRUE(ring.TryPush(3));
+    ASSERT_TRUE(ring.TryPop(value));
+    ASSERT_EQ(value, 2u);
+    ASSERT_TRUE(ring.TryPop(value));
+    ASSERT_EQ(value, 3u);
+    ASSERT_TRUE(ring.IsEmpty());
+}
+
+// Everything pushed comes out once, in order, while both sides keep running into a full and an empty ring
+TEST(SpscRing, ProducerConsumerThreads)
+{
+    struct Item
+    {
+        uint64 sequence;
+        uint64 check;
+    };
+
+    constexpr uint64 COUNT = 200000;
+    SpscRing<Item, 64> ring;
+
+    std::thread producer([&ring]() {
+        for (uint64 i = 0; i < COUNT; i++) {
+            while (!ring.TryPush({ i, i * 2654435761u })) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    Item item;
+    uint64 expected = 0;
+
+    while (expected < COUNT) {
+        if (!ring.TryPop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        ASSERT_EQ(item.sequence, expected);
+        ASSERT_EQ(item.check, expected * 2654435761u);
+        expected++;
+    }
+
+    producer.join();
+    ASSERT_TRUE(ring.IsEmpty());
+}
@@ -375,3 +375,24 @@ TEST(StringsTest, SubString)
     }
 }
 
+
+TEST(StringsTest, Find)
+{
+    constexpr auto NB = 1000;
+
+    for (uint i = 0; i < NB; i++) {
+        auto s = GenerateRandomString(1024);
+        String str1(s);
+
+        if (s.empty())
+            continue;
+
+        const usize start = i % s.size();
+        const auto needle = s.substr(start, 1 + i % 16);
+        const auto expected = s.find(needle);
+        ASSERT_EQ(str1.Find(needle.data(), needle.size()), expected == std::string::npos ? String::NPOS : expected);
+        ASSERT_EQ(str1.Find(needle.data(), needle.size(), start), start);
+        ASSERT_EQ(str1.Find(s[start], start), start);
+        ASSERT_EQ(str1.Find("\x01"), String::NPOS);
+    }
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <Core/DataStructure/StringInterner.hpp>
+
+using namespace TRE;
+
+// Hashed at compile time, the same way the renderer's Hasher hashes a null terminated string
+static_assert(StringInterner::Hash("Mesh.vert", 9) == [] { Utils::Hasher h; h.String("Mesh.vert"); return h.Get(); }());
+
+namespace
+{
+    StringView ToView(const std::string& str)
+    {
+        return StringView(str.data(), str.size());
+    }
+}
+
+TEST(StringInterner, InternFindGet)
+{
+    StringInterner interner;
+
+    const StringId a = interner.Intern("Shaders/Mesh.vert.spv");
+    const StringId b = interner.Intern("Shaders/Mesh.frag.spv");
+    const StringId empty = interner.Intern(StringView());
+    ASSERT_FALSE(a.IsNull());
+    ASSERT_FALSE(empty.IsNull());
+    ASSERT_NE(a, b);
+    ASSERT_NE(a, empty);
+
+    // Same content from another buffer, same id
+    const std::string copy = "Shaders/Mesh.vert.spv";
+    ASSERT_EQ(interner.Intern(ToView(copy)), a);
+    ASSERT_EQ(interner.Find(ToView(copy)), a);
+    ASSERT_EQ(interner.Intern(""), empty);
+    ASSERT_TRUE(interner.Find("Shaders/Mesh.comp.spv").IsNull());
+
+    ASSERT_TRUE(interner.GetString(a) == StringView("Shaders/Mesh.vert.spv"));
+    ASSERT_STREQ(interner.GetCString(b), "Shaders/Mesh.frag.spv");
+    ASSERT_STREQ(interner.GetCString(empty), "");
+    ASSERT_EQ(interner.GetHash(a), StringInterner::Hash(copy.data(), copy.size()));
+    ASSERT_EQ(interner.GetCount(), 3u);
+}
+
+TEST(StringInterner, StableAcrossGrowth)
+{
+    StringInterner interner;
+    std::vector<StringId> ids;
+    std::vector<const char*> pointers;
+
+    // Enough for several table grows and arena chunks per shard, plus strings bigger than the chunks
+    for (uint32 i = 0; i < 50'000; i++) {
+        const std::string name = (i % 5000 == 0) ? std::string(40'000, char('a' + i / 5000)) : "Material_" + std::to_string(i);
+        ids.push_back(interner.Intern(ToView(name)));
+        pointers.push_back(interner.GetCString(ids.back()));
+    }
+
+    ASSERT_EQ(interner.GetCount(), 50'000u);
+    std::unordered_set<uint32> unique;
+
+    for (StringId id : ids) {
+        unique.insert(id.id);
+    }
+
+    ASSERT_EQ(unique.size(), ids.size());
+
+    for (uint32 i = 0; i < 50'000; i++) {
+        const std::string name = (i % 5000 == 0) ? std::string(40'000, char('a' + i / 5000)) : "Material_" + std::to_string(i);
+        ASSERT_EQ(interner.Find(ToView(name)), ids[i]);
+        ASSERT_EQ(interner.GetCString(ids[i]), pointers[i]);
+        ASSERT_TRUE(interner.GetString(ids[i]) == ToView(name));
+    }
+}
+
+// Threads race to intern overlapping names, everyone must agree on the ids
+TEST(StringInterner, ConcurrentIntern)
+{
+    CONSTEXPR uint32 THREADS = 8;
+    CONSTEXPR uint32 NAMES = 20'000;
+    StringInterner interner;
+    std::vector<std::vector<StringId>> results(THREADS);
+    std::vector<std::thread> threads;
+
+    for (uint32 t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            results[t].resize(NAMES);
+
+            for (uint32 i = 0; i < NAMES; i++) {
+                // Every thread walks the names in a different order
+                const uint32 name = (i * 7919 + t * 104729) % NAMES;
+                const std::string str = "Texture_" + std::to_string(name);
+                const StringId id = interner.Intern(ToView(str));
+                results[t][name] = id;
+
+                if (!(interner.GetString(id) == ToView(str)))
+                    results[t][name] = StringId{};
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(interner.GetCount(), NAMES);
+
+    for (uint32 i = 0; i < NAMES; i++) {
+        ASSERT_FALSE(results[0][i].IsNull());
+
+        for (uint32 t = 1; t < THREADS; t++) {
+            ASSERT_EQ(results[t][i], results[0][i]);
+        }
+    }
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <Core/DataStructure/StringView.hpp>
+#include <Core/DataStructure/FromChars.hpp>
+
+using namespace TRE;
+
+// The scalar fallbacks run at compile time
+static_assert(Utils::Strlen("hello") == 5);
+static_assert(Utils::Find("hello world", 11, "wor", 3) == 6);
+static_assert(Utils::FindAnyOf("hello world", 11, " w", 2) == 5);
+static_assert(Utils::SkipWhitespace(" \t\r\nx", 5) == 4);
+static_assert(StringView("a\nb").Find('\n') == 1);
+
+namespace
+{
+    std::string GenerateText(std::mt19937& gen, usize size, const char* alphabet)
+    {
+        const usize alphabetSize = strlen(alphabet);
+        std::string text;
+
+        for (usize i = 0; i < size; i++) {
+            text.push_back(alphabet[gen() % alphabetSize]);
+        }
+
+        return text;
+    }
+
+    usize ToNpos(usize index)
+    {
+        return index == std::string_view::npos ? StringView::NPOS : index;
+    }
+}
+
+TEST(StringViewTest, StrlenAtEveryAlignment)
+{
+    alignas(64) char buffer[256];
+
+    for (usize offset = 0; offset < 64; offset++) {
+        for (usize length = 0; length < 100; length++) {
+            memset(buffer, 'a', sizeof(buffer));
+            buffer[offset + length] = '\0';
+            ASSERT_EQ(Utils::Strlen(buffer + offset), length);
+        }
+    }
+}
+
+// Every size around the block widths, every position of the match
+TEST(StringViewTest, FindMatchesStd)
+{
+    std::mt19937 gen(1337);
+
+    for (usize size = 0; size < 140; size++) {
+        for (uint32 round = 0; round < 20; round++) {
+            const std::string text = GenerateText(gen, size, "abcd");
+            const std::string_view expected(text);
+            const StringView view(text.data(), text.size());
+
+            for (const char* needle : { "a", "ab", "abc", "dcba", "abcdab", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab" }) {
+                ASSERT_EQ(view.Find(needle), ToNpos(expected.find(needle))) << text << " / " << needle;
+            }
+
+            const usize pos = size ? gen() % size : 0;
+            const std::string needle = text.substr(pos, gen() % 8);
+            ASSERT_EQ(view.Find(needle.data(), needle.size(), pos), ToNpos(expected.find(needle, pos)));
+            ASSERT_EQ(view.Find('c', pos), ToNpos(expected.find('c', pos)));
+            ASSERT_EQ(view.FindFirstOf("cd", pos), ToNpos(expected.find_first_of("cd", pos)));
+            ASSERT_EQ(view.FindFirstNotOf("abc", pos), ToNpos(expected.find_first_not_of("abc", pos)));
+        }
+    }
+}
+
+TEST(StringViewTest, FindEdgeCases)
+{
+    const StringView view("hello world");
+
+    ASSERT_EQ(view.Find("world"), 6u);
+    ASSERT_EQ(view.Find("worlds"), StringView::NPOS);
+    ASSERT_EQ(view.Find("hello world and more"), StringView::NPOS);
+    ASSERT_EQ(view.Find(StringView("")), 0u);
+    ASSERT_EQ(view.Find(StringView(""), 11), 11u);
+    ASSERT_EQ(view.Find('o', 5), 7u);
+    ASSERT_EQ(view.Find('o', 11), StringView::NPOS);
+    ASSERT_EQ(view.Find("o", 0, 20), StringView::NPOS);
+
+    // Sets larger than the SIMD path handles
+    ASSERT_EQ(view.FindFirstOf("0123456789ABCDEFGHIJw"), 6u);
+    ASSERT_EQ(view.FindFirstNotOf("abcdefghijklmnopqrstuvwxyz"), 5u);
+}
+
+TEST(StringViewTest, LinesAndWhitespaces)
+{
+    const std::string text = "v 1.0 2.0 3.0\r\n   \t vt 0.5 0.5\n\nf 1/1 2/2 3/3";
+    StringView view(text.data(), text.size());
+
+    ASSERT_TRUE(view.PopLine() == StringView("v 1.0 2.0 3.0"));
+
+    StringView line = view.PopLine();
+    ASSERT_EQ(line.Size(), 15u);
+    ASSERT_TRUE(line.TrimStart() == StringView("vt 0.5 0.5"));
+
+    ASSERT_TRUE(view.PopLine().Empty());
+    ASSERT_TRUE(view.PopLine() == StringView("f 1/1 2/2 3/3"));
+    ASSERT_TRUE(view.Empty());
+
+    const std::string spaces(100, ' ');
+    ASSERT_EQ(Utils::SkipWhitespace(spaces.data(), spaces.size()), spaces.size());
+    ASSERT_EQ(StringView(spaces.data(), spaces.size()).TrimStart().Size(), 0u);
+}
+
+TEST(StringViewTest, FromCharsIntegers)
+{
+    const char* text = "-2147483648 2147483647 4294967295 2147483648 -0 +17 abc 12abc";
+    const char* end = text + strlen(text);
+    int32 i = 0;
+    uint32 u = 0;
+
+    Utils::FromCharsResult result = Utils::FromChars(text, end, i);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(i, INT32_MIN);
+
+    result = Utils::FromChars(result.ptr + 1, end, i);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(i, INT32_MAX);
+
+    result = Utils::FromChars(result.ptr + 1, end, u);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(u, UINT32_MAX);
+
+    // Overflow leaves the value alone and still consumes the digits
+    result = Utils::FromChars(result.ptr + 1, end, i);
+    ASSERT_FALSE(result.ok);
+    ASSERT_EQ(i, INT32_MAX);
+    ASSERT_EQ(*result.ptr, ' ');
+
+    result = Utils::FromChars(result.ptr + 1, end, i);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(i, 0);
+
+    result = Utils::FromChars(result.ptr + 1, end, u);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(u, 17u);
+
+    const char* letters = result.ptr + 1;
+    result = Utils::FromChars(letters, end, i);
+    ASSERT_FALSE(result.ok);
+    ASSERT_EQ(result.ptr, letters);
+
+    result = Utils::FromChars(letters + 4, end, i);
+    ASSERT_TRUE(result.ok);
+    ASSERT_EQ(i, 12);
+    ASSERT_EQ(*result.ptr, 'a');
+
+    const char* negative = "-1";
+    ASSERT_FALSE(Utils::FromChars(negative, negative + 2, u).ok);
+}
+
+// Bit exact against strtof and strtod, on the fast path and off it
+TEST(StringViewTest, FromCharsFloats)
+{
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int32> exponent(-30, 30);
+    char buffer[64];
+
+    for (uint32 i = 0; i < 200'000; i++) {
+        const double value = mantissa(gen) * pow(10.0, exponent(gen));
+        const char* format = (i % 3 == 0) ? "%.6f" : ((i % 3 == 1) ? "%.9g" : "%.17g");
+        const int32 length = snprintf(buffer, sizeof(buffer), format, value);
+
+        float f = 0.f;
+        double d = 0.0;
+        Utils::FromCharsResult result = Utils::FromChars(buffer, buffer + length, f);
+        ASSERT_TRUE(result.ok) << buffer;
+        ASSERT_EQ(result.ptr, buffer + length);
+        ASSERT_EQ(f, strtof(buffer, NULL)) << buffer;
+
+        result = Utils::FromChars(buffer, buffer + length, d);
+        ASSERT_TRUE(result.ok) << buffer;
+        ASSERT_EQ(d, strtod(buffer, NULL)) << buffer;
+    }
+
+    const char* special[] = { "1e5", "+2.5", ".5", "5.", "-0.0", "1e", "1e+", "12345678901234567890123", "0.000000000000000000000001",
+        "inf", "-nan", "1e400" };
+
+    for (const char* text : special) {
+        const char* end = text + strlen(text);
+        char* expectedEnd = NULL;
+        const double expected = strtod(text, &expectedEnd);
+        double d = 0.0;
+        const Utils::FromCharsResult result = Utils::FromChars(text, end, d);
+
+        ASSERT_EQ(result.ptr, expectedEnd) << text;
+
+        if (result.ok && expected == expected) {
+            ASSERT_EQ(d, expected) << text;
+        } else if (result.ok) {
+            ASSERT_NE(d, d) << text;
+        } else {
+            ASSERT_TRUE(isinf(expected)) << text;
+        }
+    }
+
+    const char* invalid = ".e5";
+    float f = 3.f;
+    ASSERT_FALSE(Utils::FromChars(invalid, invalid + 3, f).ok);
+    ASSERT_EQ(f, 3.f);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <Legacy/ECS/ECS/ECS.hpp>
+#include <Legacy/ECS/World/World.hpp>
+#include <Legacy/ECS/Entity/Entity.hpp>
+#include <Legacy/ECS/CommandRecord/CommandRecord.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct Health : Component<Health>
+    {
+        Health(uint32 value) : value(value) {}
+
+        uint32 value;
+    };
+
+    // Counts its live copies, payloads that are neither dispatched nor destroyed leak one
+    struct Tracked : Component<Tracked>
+    {
+        Tracked(uint32 value) : value(value) { alive++; }
+
+        Tracked(const Tracked& other) : value(other.value) { alive++; }
+
+        ~Tracked() { alive--; }
+
+        uint32 value;
+
+        static int32 alive;
+    };
+
+    int32 Tracked::alive = 0;
+
+    // Doesn't fit in a page
+    struct Large : Component<Large>
+    {
+        Large(uint8 fill) { memset(data, fill, sizeof(data)); }
+
+        uint8 data[1024];
+    };
+
+    CONSTEXPR uint32 PAGE_SIZE = 256;
+}
+
+TEST(CommandRecord, FlushesAcrossPagesInOrder)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+    const uint32 count = 100;
+    std::vector<EntityID> ids(count);
+    manager.CreateEntitiesWithComponents(count, ids.data(), Health(0));
+
+    CommandRecord record(PAGE_SIZE);
+
+    for (uint32 round = 0; round < 3; round++) {
+        // Removing and adding back the same component: only the recording order gives the final value
+        for (uint32 i = 0; i < count; i++) {
+            record.RemoveComponent(&world, ids[i], Health::ID);
+            record.AddComponent(&world, ids[i], Health(i + round));
+        }
+
+        ASSERT_EQ(record.GetCommandsCount(), count * 2);
+        ASSERT_GT(record.GetPagesCount(), 1u);
+
+        // Pages are kept and rewound after a flush, recording as much again doesn't allocate
+        const uint32 pages = record.GetPagesCount();
+        record.Flush();
+        ASSERT_EQ(record.GetCommandsCount(), 0u);
+
+        if (round) {
+            ASSERT_EQ(record.GetPagesCount(), pages);
+        }
+
+        for (uint32 i = 0; i < count; i++) {
+            ASSERT_EQ(manager.GetComponent<Health>(manager.GetEntityByID(ids[i]))->value, i + round);
+        }
+    }
+
+    // A flush with nothing recorded does nothing
+    record.Flush();
+    ASSERT_EQ(manager.GetComponent<Health>(manager.GetEntityByID(ids[0]))->value, 2u);
+}
+
+TEST(CommandRecord, CommandLargerThanAPage)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+    CommandRecord record(PAGE_SIZE);
+    const uint32 largeCount = 5;
+
+    record.CreateEntities(&world, 3, Health(1));
+    const uint32 pages = record.GetPagesCount();
+    record.CreateEntities(&world, largeCount, Large(0xAB), Health(2));
+    ASSERT_EQ(record.GetPagesCount(), pages + 1);
+    record.CreateEntities(&world, 4, Health(3));
+    ASSERT_EQ(record.GetCommandsCount(), 3u);
+    record.Flush();
+
+    Archetype* large = manager.GetArchetype(ECS::GetSignature<Large, Health>());
+    ASSERT_NE(large, nullptr);
+    uint32 count = 0;
+
+    for (ArchetypeChunk& chunk : *large) {
+        for (uint32 i = 0; i < chunk.GetEntitiesCount(); i++) {
+            ASSERT_EQ(chunk.GetComponentByInternalID<Large>(i).data[1023], 0xAB);
+            ASSERT_EQ(chunk.GetComponentByInternalID<Health>(i).value, 2u);
+            count++;
+        }
+    }
+
+    ASSERT_EQ(count, largeCount);
+
+    uint32 small = 0;
+
+    for (ArchetypeChunk& chunk : *manager.GetArchetype(ECS::GetSignature<Health>())) {
+        small += chunk.GetEntitiesCount();
+    }
+
+    ASSERT_EQ(small, 7u);
+}
+
+TEST(CommandRecord, ClearDestroysPayloads)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+    const uint32 count = 50;
+    std::vector<EntityID> ids(count);
+    manager.CreateEntitiesWithComponents(count, ids.data(), Health(0));
+
+    const int32 alive = Tracked::alive;
+
+    {
+        CommandRecord record(PAGE_SIZE);
+
+        for (uint32 i = 0; i < count; i++) {
+            record.AddComponent(&world, ids[i], Tracked(i));
+        }
+
+        record.CreateEntities(&world, 10, Tracked(7), Health(1));
+        ASSERT_GT(record.GetPagesCount(), 1u);
+        ASSERT_EQ(Tracked::alive, alive + int32(count) + 1);
+
+        // Nothing is applied, every payload is destroyed
+        record.Clear();
+        ASSERT_EQ(Tracked::alive, alive);
+        ASSERT_EQ(record.GetCommandsCount(), 0u);
+        record.Flush();
+
+        for (EntityID id : ids) {
+            ASSERT_FALSE(manager.HasComponent<Tracked>(id));
+        }
+
+        // Flushed payloads are copied into the chunks then destroyed, commands left at destruction are cleared
+        for (uint32 i = 0; i < count; i++) {
+            record.AddComponent(&world, ids[i], Tracked(i));
+        }
+
+        record.Flush();
+        ASSERT_EQ(Tracked::alive, alive + int32(count));
+        record.AddComponent(&world, ids[0], Tracked(0));
+    }
+
+    ASSERT_EQ(Tracked::alive, alive + int32(count));
+
+    for (uint32 i = 0; i < count; i++) {
+        ASSERT_EQ(manager.GetComponent<Tracked>(manager.GetEntityByID(ids[i]))->value, i);
+    }
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <Legacy/ECS/ECS/ECS.hpp>
+#include <Legacy/ECS/World/World.hpp>
+#include <Legacy/ECS/Entity/Entity.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct Position : Component<Position>
+    {
+        Position(uint32 value) : value(value) {}
+
+        uint32 value;
+    };
+
+    struct Velocity : Component<Velocity>
+    {
+        Velocity(float value) : value(value) {}
+
+        float value;
+    };
+
+    CONSTEXPR uint32 CAPACITY = ArchetypeChunk::CAPACITY;
+
+    template<typename... Components>
+    ArchetypeQuerry QuerryAll()
+    {
+        return ArchetypeQuerry(ECS::GetSignature<Components...>(), ECS::GetEmptySignature(), ECS::GetEmptySignature());
+    }
+
+    // Entities and chunks of the archetype made of exactly these components
+    template<typename... Components>
+    std::pair<uint32, uint32> CountArchetype(EntityManager& manager)
+    {
+        Archetype* archetype = manager.GetArchetype(ECS::GetSignature<Components...>());
+        std::pair<uint32, uint32> count(0, 0);
+
+        if (archetype) {
+            for (ArchetypeChunk& chunk : *archetype) {
+                count.first += chunk.GetEntitiesCount();
+                count.second++;
+            }
+        }
+
+        return count;
+    }
+}
+
+TEST(EntityManager, CreateEntitiesAcrossChunks)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+
+    // Fills a few chunks and leaves the last one partially used
+    const uint32 count = CAPACITY * 3 + 5;
+    std::vector<EntityID> ids(count);
+    manager.CreateEntitiesWithComponents(count, ids.data(), Position(7), Velocity(2.f));
+
+    for (EntityID id : ids) {
+        Entity* entity = manager.LookupEntity(id);
+        ASSERT_NE(entity, nullptr);
+        ASSERT_EQ(manager.GetComponent<Position>(*entity)->value, 7u);
+        ASSERT_EQ(manager.GetComponent<Velocity>(*entity)->value, 2.f);
+    }
+
+    ASSERT_EQ((CountArchetype<Position, Velocity>(manager)), std::make_pair(count, 4u));
+
+    // The next batch starts in the partially used chunk
+    std::vector<EntityID> more(CAPACITY);
+    manager.CreateEntitiesWithComponents(CAPACITY, more.data(), Position(8), Velocity(3.f));
+    ASSERT_EQ((CountArchetype<Position, Velocity>(manager)), std::make_pair(count + CAPACITY, 5u));
+    ASSERT_EQ(manager.GetComponent<Position>(manager.GetEntityByID(ids.back()))->value, 7u);
+    ASSERT_EQ(manager.GetComponent<Position>(manager.GetEntityByID(more.front()))->value, 8u);
+    ASSERT_EQ(manager.GetComponent<Position>(manager.GetEntityByID(more.back()))->value, 8u);
+}
+
+TEST(EntityManager, AddAndRemoveComponentOnQuerry)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+
+    // The destination archetype already holds a partial chunk, the moved entities fill it before taking new ones
+    std::vector<EntityID> existing(10);
+    manager.CreateEntitiesWithComponents(existing.size(), existing.data(), Position(1000), Velocity(1.f));
+
+    const uint32 count = CAPACITY * 2 + 20;
+    std::vector<EntityID> ids(count);
+    manager.CreateEntitiesWithComponents(count, ids.data(), Position(0));
+
+    // Distinct values, the columns have to be relocated entity by entity
+    for (uint32 i = 0; i < count; i++) {
+        manager.GetComponent<Position>(manager.GetEntityByID(ids[i]))->value = i;
+    }
+
+    ArchetypeQuerry positionOnly = QuerryAll<Position>();
+    positionOnly.None = ECS::GetSignature<Velocity>();
+    ASSERT_EQ(manager.AddComponentToQuerry(positionOnly, Velocity(4.f)), count);
+    ASSERT_EQ((CountArchetype<Position>(manager)).first, 0u);
+    ASSERT_EQ((CountArchetype<Position, Velocity>(manager)).first, count + 10);
+
+    for (uint32 i = 0; i < count; i++) {
+        Entity& entity = manager.GetEntityByID(ids[i]);
+        ASSERT_EQ(manager.GetComponent<Position>(entity)->value, i);
+        ASSERT_EQ(manager.GetComponent<Velocity>(entity)->value, 4.f);
+    }
+
+    for (EntityID id : existing) {
+        Entity& entity = manager.GetEntityByID(id);
+        ASSERT_EQ(manager.GetComponent<Position>(entity)->value, 1000u);
+        ASSERT_EQ(manager.GetComponent<Velocity>(entity)->value, 1.f);
+    }
+
+    // Nothing left without Velocity
+    ASSERT_EQ(manager.AddComponentToQuerry(positionOnly, Velocity(5.f)), 0u);
+
+    ASSERT_EQ(manager.RemoveComponentFromQuerry<Position>(QuerryAll<Velocity>()), count + 10);
+    ASSERT_EQ((CountArchetype<Velocity>(manager)).first, count + 10);
+
+    for (uint32 i = 0; i < count; i++) {
+        ASSERT_FALSE(manager.HasComponent<Position>(ids[i]));
+        ASSERT_EQ(manager.GetComponent<Velocity>(manager.GetEntityByID(ids[i]))->value, 4.f);
+    }
+}
+
+TEST(EntityManager, DeleteEntities)
+{
+    World world;
+    EntityManager& manager = world.GetEntityManager();
+
+    const uint32 count = CAPACITY * 2 + 3;
+    std::vector<EntityID> moving(count);
+    std::vector<EntityID> still(CAPACITY + 1);
+    manager.CreateEntitiesWithComponents(count, moving.data(), Position(0), Velocity(1.f));
+    manager.CreateEntitiesWithComponents(still.size(), still.data(), Position(0));
+
+    for (uint32 i = 0; i < still.size(); i++) {
+        manager.GetComponent<Position>(manager.GetEntityByID(still[i]))->value = i;
+    }
+
+    // One at a time from the front and the middle of chunks, the last entity of the chunk takes each slot
+    for (uint32 i = 0; i < still.size(); i += 7) {
+        manager.DeleteEntity(still[i]);
+        ASSERT_EQ(manager.LookupEntity(still[i]), nullptr);
+    }
+
+    for (uint32 i = 0; i < still.size(); i++) {
+        if (i % 7) {
+            ASSERT_EQ(manager.GetComponent<Position>(manager.GetEntityByID(still[i]))->value, i);
+        }
+    }
+
+    ASSERT_EQ(manager.DeleteEntities(QuerryAll<Velocity>()), count);
+    ASSERT_EQ((CountArchetype<Position, Velocity>(manager)), std::make_pair(0u, 0u));
+
+    for (EntityID id : moving) {
+        ASSERT_EQ(manager.LookupEntity(id), nullptr);
+    }
+
+    ASSERT_EQ(manager.DeleteEntities(QuerryAll<Velocity>()), 0u);
+    ASSERT_EQ((CountArchetype<Position>(manager)).first, uint32(still.size() - (still.size() + 6) / 7));
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <Legacy/FileSystem/AsyncIO/AsyncIOManager.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    CONSTEXPR uint32 FILE_SIZE = 1 << 20;
+    CONSTEXPR uint32 READ_SIZE = 4096;
+
+    FORCEINLINE uint8 ByteAt(uint64 offset)
+    {
+        return (uint8)(offset * 31 + (offset >> 8));
+    }
+
+    // A temporary file filled with a pattern every read can be checked against, named after the test as ctest runs them in parallel
+    struct PatternFile
+    {
+        PatternFile() : path(testing::TempDir() + "tre_async_io_")
+        {
+            for (const char* c = testing::UnitTest::GetInstance()->current_test_info()->name(); *c; c++) {
+                path += *c == '/' ? '_' : *c;
+            }
+
+            path += ".bin";
+
+            std::vector<uint8> data(FILE_SIZE);
+
+            for (uint32 i = 0; i < FILE_SIZE; i++) {
+                data[i] = ByteAt(i);
+            }
+
+            FILE* file = fopen(path.c_str(), "wb");
+            fwrite(data.data(), 1, data.size(), file);
+            fclose(file);
+        }
+
+        ~PatternFile() { remove(path.c_str()); }
+
+        std::string path;
+    };
+
+    bool MatchesPattern(const uint8* buffer, uint64 offset, uint32 size)
+    {
+        for (uint32 i = 0; i < size; i++) {
+            if (buffer[i] != ByteAt(offset + i))
+                return false;
+        }
+
+        return true;
+    }
+
+    class AsyncIOBackendTest : public testing::TestWithParam<AsyncIOManager::BackendType>
+    {
+    protected:
+        // io_uring can be missing or blocked (old kernel, seccomp), there is nothing to test then
+        bool InitManager(AsyncIOManager& manager)
+        {
+            return manager.Init(GetParam(), 32, 4);
+        }
+    };
+}
+
+TEST_P(AsyncIOBackendTest, ReadsBatch)
+{
+    PatternFile pattern;
+    AsyncIOFile file(pattern.path.c_str());
+    ASSERT_TRUE(file.IsOpen());
+    ASSERT_EQ(file.Size(), FILE_SIZE);
+
+    AsyncIOManager manager;
+
+    if (!this->InitManager(manager))
+        GTEST_SKIP() << "Backend not available";
+
+    // More reads than the queue depth, submitting waits for free slots
+    CONSTEXPR uint32 COUNT = FILE_SIZE / READ_SIZE;
+    std::vector<uint8> buffer(FILE_SIZE);
+    std::atomic<uint32> callbacks{ 0 };
+    AsyncIOBatch batch(COUNT);
+
+    for (uint32 i = 0; i < COUNT; i++) {
+        batch.AddRead(file, buffer.data() + i * READ_SIZE, i * READ_SIZE, READ_SIZE,
+            [&callbacks](const AsyncIORequest&) { callbacks++; });
+    }
+
+    manager.Submit(batch);
+    batch.Wait();
+
+    ASSERT_EQ(callbacks.load(), COUNT);
+
+    for (uint32 i = 0; i < COUNT; i++) {
+        ASSERT_FALSE(batch[i].HasFailed());
+        ASSERT_EQ(batch[i].result, (int64)READ_SIZE);
+    }
+
+    ASSERT_TRUE(MatchesPattern(buffer.data(), 0, FILE_SIZE));
+}
+
+TEST_P(AsyncIOBackendTest, ReadPastEndIsShort)
+{
+    PatternFile pattern;
+    AsyncIOFile file(pattern.path.c_str());
+    AsyncIOManager manager;
+
+    if (!this->InitManager(manager))
+        GTEST_SKIP() << "Backend not available";
+
+    std::vector<uint8> buffer(READ_SIZE);
+    AsyncIOBatch batch(1);
+    AsyncIORequest& request = batch.AddRead(file, buffer.data(), FILE_SIZE - 100, READ_SIZE);
+    manager.Submit(batch);
+    batch.Wait();
+
+    ASSERT_FALSE(request.HasFailed());
+    ASSERT_EQ(request.result, 100);
+    ASSERT_TRUE(MatchesPattern(buffer.data(), FILE_SIZE - 100, 100));
+}
+
+TEST_P(AsyncIOBackendTest, ShutdownCompletesReadsInFlight)
+{
+    // Direct reads skip the page cache, they are still in flight when submitting returns
+    PatternFile pattern;
+    AsyncIOFile file(pattern.path.c_str(), AsyncIOFile::DIRECT);
+
+    CONSTEXPR uint32 COUNT = 64;
+    uint8* buffer = (uint8*)aligned_alloc(AsyncIOFile::DIRECT_ALIGNMENT, COUNT * READ_SIZE);
+
+    for (uint32 run = 0; run < 16; run++) {
+        AsyncIOManager manager;
+
+        if (!this->InitManager(manager)) {
+            free(buffer);
+            GTEST_SKIP() << "Backend not available";
+        }
+
+        memset(buffer, 0, COUNT * READ_SIZE);
+        AsyncIOBatch batch(COUNT);
+
+        for (uint32 i = 0; i < COUNT; i++) {
+            batch.AddRead(file, buffer + i * READ_SIZE, (uint64)(i * 7 % COUNT) * READ_SIZE, READ_SIZE);
+        }
+
+        // Nothing may be pending once Shutdown returns, the buffers are released right after
+        manager.Submit(batch);
+        manager.Shutdown();
+
+        ASSERT_TRUE(batch.IsCompleted());
+
+        for (uint32 i = 0; i < COUNT; i++) {
+            ASSERT_EQ(batch[i].result, (int64)READ_SIZE);
+            ASSERT_TRUE(MatchesPattern(buffer + i * READ_SIZE, batch[i].offset, READ_SIZE));
+        }
+    }
+
+    free(buffer);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncIOBackendTest,
+    testing::Values(AsyncIOManager::BACKEND_IO_URING, AsyncIOManager::BACKEND_THREAD_POOL),
+    [](const testing::TestParamInfo<AsyncIOManager::BackendType>& info) {
+        return std::string(info.param == AsyncIOManager::BACKEND_IO_URING ? "IOUring" : "ThreadPool");
+    });
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <Legacy/FileSystem/File/File.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    std::string WriteTempFile(const char* name, const std::string& content)
+    {
+        const std::string path = testing::TempDir() + name;
+        FILE* file = fopen(path.c_str(), "wb");
+        fwrite(content.data(), 1, content.size(), file);
+        fclose(file);
+        return path;
+    }
+
+    void ExpectReadAll(const char* name, const std::string& content)
+    {
+        const std::string path = WriteTempFile(name, content);
+
+        {
+            File file(String(path.c_str()), File::OPEN_READ);
+            String data = file.ReadAll();
+
+            // The terminator is part of the length
+            ASSERT_EQ(data.Length(), content.size() + 1);
+            ASSERT_EQ(memcmp(data.Buffer(), content.data(), content.size()), 0);
+            ASSERT_EQ(data.Buffer()[content.size()], 0);
+        }
+
+        remove(path.c_str());
+    }
+}
+
+TEST(File, ReadAllSmall)
+{
+    ExpectReadAll("tre_read_all_empty.txt", "");
+    ExpectReadAll("tre_read_all_small.txt", "Hello");
+    ExpectReadAll("tre_read_all_sso.txt", std::string(22, 'x'));
+}
+
+TEST(File, ReadAllLarge)
+{
+    std::string content;
+
+    for (uint32 i = 0; i < 100000; i++) {
+        content.push_back((char)('a' + i % 26));
+    }
+
+    ExpectReadAll("tre_read_all_large.txt", content);
+}
+
+TEST(File, ReadAllKeepsHighBytes)
+{
+    // fgetc stopped on 0xFF, it reads as EOF once narrowed to char
+    std::string content = "before";
+    content.push_back((char)0xFF);
+    content += "after";
+
+    ExpectReadAll("tre_read_all_ff.bin", content);
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Core/Misc/AsyncLogging.hpp>
+#include <Renderer/Backend/Core/Logs/Logs.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct CapturedLine
+    {
+        Log::LogType type;
+        std::string line;
+    };
+
+    // Written to by the logging thread only, read after a Flush
+    struct CaptureSink : public LogSink
+    {
+        CaptureSink(std::vector<CapturedLine>* lines) : lines(lines) {}
+
+        void Write(Log::LogType type, const char* line, usize length) override
+        {
+            lines->push_back({ type, std::string(line, length) });
+        }
+
+        std::vector<CapturedLine>* lines;
+    };
+
+    // Message of a line, without the date and type prefix and the new line
+    std::string Message(const std::string& line)
+    {
+        const usize start = line.find("]: ");
+        return start == std::string::npos ? line : line.substr(start + 3, line.size() - start - 4);
+    }
+
+    enum class Fruit : uint8 { APPLE = 3 };
+}
+
+TEST(AsyncLogging, FormatsLikePrintf)
+{
+    const char* name = "tre";
+    char array[16] = "array";
+    void* pointer = (void*)0x1234;
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%p", pointer);
+
+    ASSERT_EQ(AsyncLog::Format("plain"), "plain");
+    ASSERT_EQ(AsyncLog::Format("%d %i %u", -5, 7, 42u), "-5 7 42");
+    ASSERT_EQ(AsyncLog::Format("%s and %s", name, array), "tre and array");
+    ASSERT_EQ(AsyncLog::Format("%.1f %5.2f %e", 1.25, 2.f, 1000.0), "1.2  2.00 1.000000e+03");
+    ASSERT_EQ(AsyncLog::Format("%llu %lld %zu", 18446744073709551615ull, -9223372036854775807ll, usize(3)), "18446744073709551615 -9223372036854775807 3");
+    ASSERT_EQ(AsyncLog::Format("%x %08X %#o", 255u, 0xBEEFu, 8), "ff 0000BEEF 010");
+    ASSERT_EQ(AsyncLog::Format("100%% %c", 'x'), "100% x");
+    ASSERT_EQ(AsyncLog::Format("[%*d] [%-*s] [%.*s]", 4, 7, 3, "a", 2, "abc"), "[   7] [a  ] [ab]");
+    ASSERT_EQ(AsyncLog::Format("%p", pointer), expected);
+    ASSERT_EQ(AsyncLog::Format("%d %d %s", true, Fruit::APPLE, (const char*)NULL), "1 3 (null)");
+    ASSERT_EQ(AsyncLog::Format("%d %d", 1), "1 (missing)");
+
+    // Strings are copied up to a limit
+    const std::string longString(AsyncLog::MAX_STRING_ARGUMENT + 100, 'a');
+    ASSERT_EQ(AsyncLog::Format("%s", longString.c_str()).size(), AsyncLog::MAX_STRING_ARGUMENT);
+
+    // Only what the build keeps is logged
+    ASSERT_TRUE(AsyncLog::IsEnabled(Log::ERR));
+    ASSERT_EQ(AsyncLog::IsEnabled(Log::DEBUG_INFO), TRE_LOG_MIN_SEVERITY == 0);
+    ASSERT_GT(AsyncLog::GetSeverity(Log::WARN), AsyncLog::GetSeverity(Log::INFO));
+}
+
+TEST(AsyncLogging, EverythingWrittenInOrderAfterFlush)
+{
+    std::vector<CapturedLine> lines;
+    AsyncLog::AddSink(std::make_unique<CaptureSink>(&lines));
+    AsyncLogSettings settings;
+    settings.ringSize = 4096;
+    AsyncLog::Start(settings);
+    ASSERT_TRUE(AsyncLog::IsRunning());
+
+    // Small rings, producers wait on the logging thread now and then
+    constexpr uint32 THREADS = 4;
+    constexpr uint32 MESSAGES = 2000;
+    std::vector<std::thread> threads;
+
+    for (uint32 t = 0; t < THREADS; t++) {
+        threads.emplace_back([t]() {
+            for (uint32 i = 0; i < MESSAGES; i++) {
+                AsyncLog::Write(Log::WARN, "thread %u message %u %s", t, i, "payload");
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Log::Write goes through the logging thread as well
+    Log::Write(Log::INFO, "legacy %d", 5);
+    AsyncLog::Flush();
+
+    ASSERT_EQ(lines.size(), THREADS * MESSAGES + 1);
+    std::vector<uint32> next(THREADS, 0);
+
+    for (usize i = 0; i < THREADS * MESSAGES; i++) {
+        uint32 thread, message;
+        ASSERT_EQ(lines[i].type, Log::WARN);
+        ASSERT_NE(lines[i].line.find("[TrikytaEngine][WARNING]: "), std::string::npos);
+        ASSERT_EQ(sscanf(Message(lines[i].line).c_str(), "thread %u message %u payload", &thread, &message), 2);
+        ASSERT_EQ(message, next[thread]++);
+    }
+
+    ASSERT_EQ(lines.back().type, Log::INFO);
+    ASSERT_EQ(Message(lines.back().line), "legacy 5");
+    ASSERT_EQ(AsyncLog::GetDroppedCount(), 0u);
+
+    // Lines logged right before Stop still make it
+    AsyncLog::Write(Log::ERR, "last");
+    AsyncLog::Stop();
+    ASSERT_FALSE(AsyncLog::IsRunning());
+    ASSERT_EQ(Message(lines.back().line), "last");
+
+    // And without the logging thread the caller writes
+    AsyncLog::Write(Log::INFO, "sync %d", 1);
+    ASSERT_EQ(Message(lines.back().line), "sync 1");
+    AsyncLog::ClearSinks();
+}
+
+TEST(AsyncLogging, RendererPrefix)
+{
+    std::vector<CapturedLine> lines;
+    AsyncLog::AddSink(std::make_unique<CaptureSink>(&lines));
+
+    // The renderer's macros keep their own prefix, from the caller or from the logging thread
+    TRE_LOGE("Failed to create %s (%d)", "swapchain", -4);
+    AsyncLog::Start();
+    TRE_LOGW("Using %u of %u", 3u, 4u);
+    TRE_LOGI("Device %s", "ready");
+    TRE_ALOG(Log::INFO, "engine");
+    AsyncLog::Stop();
+    AsyncLog::ClearSinks();
+
+    ASSERT_EQ(lines.size(), 4u);
+    ASSERT_EQ(lines[0].line, "[TRE][RENDERER] (ERROR): Failed to create swapchain (-4)\n");
+    ASSERT_EQ(lines[0].type, Log::ERR);
+    ASSERT_EQ(lines[1].line, "[TRE][RENDERER] (WARNING): Using 3 of 4\n");
+    ASSERT_EQ(lines[2].line, "[TRE][RENDERER] (INFO): Device ready\n");
+    ASSERT_NE(lines[3].line.find("[TrikytaEngine][INFO]: engine"), std::string::npos);
+}
+
+TEST(AsyncLogging, DropsWhenFull)
+{
+    std::vector<CapturedLine> lines;
+    AsyncLog::AddSink(std::make_unique<CaptureSink>(&lines));
+    AsyncLogSettings settings;
+    settings.ringSize = 256;
+    settings.policy = AsyncLogSettings::DROP;
+    settings.pollIntervalUs = 100000;
+    AsyncLog::Start(settings);
+
+    const uint64 dropped = AsyncLog::GetDroppedCount();
+    constexpr uint32 MESSAGES = 1000;
+
+    for (uint32 i = 0; i < MESSAGES; i++) {
+        AsyncLog::Write(Log::INFO, "message %u", i);
+    }
+
+    AsyncLog::Flush();
+    AsyncLog::Stop();
+    AsyncLog::ClearSinks();
+
+    // What wasn't written was counted, and reported
+    const uint64 drops = AsyncLog::GetDroppedCount() - dropped;
+    usize written = 0;
+    bool reported = false;
+
+    for (const CapturedLine& line : lines) {
+        written += line.line.find("message ") != std::string::npos;
+        reported |= line.type == Log::WARN && line.line.find("log messages dropped") != std::string::npos;
+    }
+
+    ASSERT_GT(drops, 0u);
+    ASSERT_TRUE(reported);
+    ASSERT_EQ(written + drops, MESSAGES);
+}
+
+TEST(AsyncLogging, RotatingFileSink)
+{
+    const char* path = "AsyncLoggingTest.log";
+    const std::string rotated[3] = { std::string(path) + ".1", std::string(path) + ".2", std::string(path) + ".3" };
+    remove(path);
+
+    for (const std::string& file : rotated) {
+        remove(file.c_str());
+    }
+
+    {
+        RotatingFileLogSink sink(path, 100, 2);
+        const std::string line(38, 'x');
+
+        for (char c = 'a'; c < 'a' + 7; c++) {
+            std::string text = c + line + "\n";
+            sink.Write(Log::INFO, text.data(), text.size());
+        }
+    }
+
+    // 2 lines a file, the newest in path, the oldest file gone
+    auto read = [](const char* file) {
+        std::string content;
+        FILE* f = fopen(file, "rb");
+
+        if (f) {
+            char buffer[256];
+            usize size;
+
+            while ((size = fread(buffer, 1, sizeof(buffer), f)) != 0) {
+                content.append(buffer, size);
+            }
+
+            fclose(f);
+        }
+
+        return content;
+    };
+
+    const std::string current = read(path);
+    const std::string first = read(rotated[0].c_str());
+    const std::string second = read(rotated[1].c_str());
+    remove(path);
+    remove(rotated[0].c_str());
+    remove(rotated[1].c_str());
+
+    ASSERT_EQ(current.size(), 40u);
+    ASSERT_EQ(current[0], 'g');
+    ASSERT_EQ(first.size(), 80u);
+    ASSERT_EQ(first[0], 'e');
+    ASSERT_EQ(second.size(), 80u);
+    ASSERT_EQ(second[0], 'c');
+    ASSERT_EQ(read(rotated[2].c_str()), "");
+}
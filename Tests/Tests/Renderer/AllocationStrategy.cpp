@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include <Renderer/Backend/Core/AllocationStrategy/AllocationStrategy.hpp>
+#include <Renderer/Backend/Core/SlabAllocator/SlabAllocator.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct TraceBlock : public BuddyAllocator
+    {
+    };
+
+    struct TraceBackend
+    {
+        bool CreateBlock(TraceBlock& block, uint64 size)
+        {
+            block.Init(64, (uint32)size);
+            reserved += size;
+            return true;
+        }
+
+        void DestroyBlock(TraceBlock& block, uint32)
+        {
+            reserved -= block.maxSize;
+        }
+
+        uint64 reserved = 0;
+    };
+
+    typedef BuddyBlockPool<TraceBlock, TraceBackend> TracePool;
+
+    BuddyPoolConfig MakePoolConfig(uint64 firstBlockSize)
+    {
+        BuddyPoolConfig config;
+        config.minSize = 64;
+        config.firstBlockSize = firstBlockSize;
+        config.maxBlockSize = 1024u << 20;
+        config.growthFactor = 4;
+        return config;
+    }
+
+    AllocationRequest MakeRequest(uint64 size, uint64 alignment = 256)
+    {
+        return { size, alignment, 0, false, false };
+    }
+}
+
+TEST(AllocationStrategy, ChoosesBySize)
+{
+    const AllocationStrategyConfig config;
+
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(256), config), AllocationStrategy::SLAB);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(12000), config), AllocationStrategy::SLAB);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(20000), config), AllocationStrategy::BUDDY);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(1000, 64u << 10), config), AllocationStrategy::BUDDY);
+
+    // Large resources go dedicated when the power of 2 rounding wastes too much, always above the threshold
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(4u << 20), config), AllocationStrategy::BUDDY);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(7u << 20), config), AllocationStrategy::BUDDY);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest((4u << 20) + 1), config), AllocationStrategy::DEDICATED);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(5u << 20), config), AllocationStrategy::DEDICATED);
+    ASSERT_EQ(ChooseAllocationStrategy(MakeRequest(32u << 20), config), AllocationStrategy::DEDICATED);
+
+    // The driver's hints win
+    AllocationRequest request = MakeRequest(256);
+    request.prefersDedicated = true;
+    ASSERT_EQ(ChooseAllocationStrategy(request, config), AllocationStrategy::DEDICATED);
+    request = MakeRequest(256);
+    request.requiresDedicated = true;
+    ASSERT_EQ(ChooseAllocationStrategy(request, config), AllocationStrategy::DEDICATED);
+
+    ASSERT_EQ(GetSlabSlotSize(100, 16), 128u);
+    ASSERT_EQ(GetSlabSlotSize(300, 16), 384u);
+    ASSERT_EQ(GetSlabSlotSize(300, 256), 512u);
+    ASSERT_EQ(GetSlabSlotSize(1100, 16), 1536u);
+    ASSERT_EQ(GetSlabSlotSize(5000, 16), 6144u);
+}
+
+TEST(AllocationStrategy, SlabPacksSlotsAndReleasesPages)
+{
+    TraceBackend backend;
+    TracePool pool;
+    pool.Init(&backend, MakePoolConfig(65536));
+    SlabAllocator<TracePool> slabs;
+    slabs.Init(&pool, 4096);
+
+    // 384 bytes slots, 10 per page
+    std::vector<BuddyPoolAllocation> slots(10);
+
+    for (uint32 i = 0; i < 10; i++) {
+        ASSERT_TRUE(slabs.Allocate(300, 16, 0, slots[i]));
+        ASSERT_EQ(slots[i].offset, slots[0].offset + i * 384);
+        ASSERT_EQ(slots[i].size, 384u);
+    }
+
+    ASSERT_EQ(slots[0].offset % 4096, 0u);
+    ASSERT_EQ(slabs.GetStats().pageCount, 1u);
+
+    // Other groups and sizes get pages of their own
+    BuddyPoolAllocation other, overflow;
+    ASSERT_TRUE(slabs.Allocate(300, 16, 1, other));
+    ASSERT_TRUE(slabs.Allocate(300, 16, 0, overflow));
+    ASSERT_EQ(slabs.GetStats().pageCount, 3u);
+    ASSERT_EQ(slabs.GetStats().usedBytes, 12u * 384);
+    ASSERT_EQ(slabs.GetStats().allocationCount, 12u);
+
+    // The last page of a class stays, a freed slot is reused
+    slabs.Free(overflow);
+    ASSERT_EQ(slabs.GetStats().pageCount, 3u);
+    slabs.Free(slots[4]);
+    ASSERT_TRUE(slabs.Allocate(300, 16, 0, slots[4]));
+    ASSERT_EQ(slots[4].offset, slots[0].offset + 4 * 384);
+
+    // Two empty pages of the same class: one goes back to the pool
+    for (const BuddyPoolAllocation& slot : slots) {
+        slabs.Free(slot);
+    }
+
+    ASSERT_EQ(slabs.GetStats().pageCount, 2u);
+    ASSERT_EQ(slabs.GetStats().allocationCount, 1u);
+    ASSERT_EQ(pool.GetStats().usedBytes, 2u * 4096);
+
+    slabs.Destroy();
+    ASSERT_EQ(pool.GetStats().allocationCount, 0u);
+}
+
+// Internal fragmentation (bytes reserved past what was asked) of a mixed workload: many small constant and instance
+// buffers, meshes and textures, a few large render targets. Buddy only versus the size classes.
+TEST(AllocationStrategy, SyntheticTraceSavesInternalFragmentation)
+{
+    struct Live
+    {
+        uint64 size;
+        AllocationStrategy strategy;
+        BuddyPoolAllocation buddyOnly;
+        BuddyPoolAllocation sized;
+    };
+
+    const AllocationStrategyConfig config;
+    TraceBackend buddyBackend, sizedBackend;
+    TracePool buddyPool, sizedPool;
+    buddyPool.Init(&buddyBackend, MakePoolConfig(16u << 20));
+    sizedPool.Init(&sizedBackend, MakePoolConfig(16u << 20));
+    SlabAllocator<TracePool> slabs;
+    slabs.Init(&sizedPool, config.slabPageSize);
+
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<Live> live;
+    uint64 requested = 0, slabRequested = 0, buddyRequested = 0, dedicatedBytes = 0;
+    uint32 counts[3] = {};
+
+    for (uint32 step = 0; step < 3000; step++) {
+        const double kind = uniform(gen);
+        uint64 size;
+
+        if (kind < 0.7) {
+            size = 16 + gen() % 16000;
+        } else if (kind < 0.98) {
+            size = uint64(16384.0 * pow(256.0, uniform(gen)));
+        } else {
+            size = (4u << 20) + gen() % (44u << 20);
+        }
+
+        Live alloc;
+        alloc.size = size;
+        alloc.strategy = ChooseAllocationStrategy(MakeRequest(size), config);
+        ASSERT_TRUE(buddyPool.Allocate(size, alloc.buddyOnly));
+
+        if (alloc.strategy == AllocationStrategy::SLAB) {
+            ASSERT_TRUE(slabs.Allocate(size, 256, 0, alloc.sized));
+            slabRequested += size;
+        } else if (alloc.strategy == AllocationStrategy::BUDDY) {
+            ASSERT_TRUE(sizedPool.Allocate(size, alloc.sized));
+            buddyRequested += size;
+        } else {
+            dedicatedBytes += size;
+        }
+
+        counts[(uint32)alloc.strategy]++;
+        requested += size;
+        live.push_back(alloc);
+
+        if (uniform(gen) < 0.4) {
+            const uint32 index = gen() % live.size();
+            const Live& freed = live[index];
+            buddyPool.Free(freed.buddyOnly);
+            requested -= freed.size;
+
+            if (freed.strategy == AllocationStrategy::SLAB) {
+                slabs.Free(freed.sized);
+                slabRequested -= freed.size;
+            } else if (freed.strategy == AllocationStrategy::BUDDY) {
+                sizedPool.Free(freed.sized);
+                buddyRequested -= freed.size;
+            } else {
+                dedicatedBytes -= freed.size;
+            }
+
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    const SlabStats slabStats = slabs.GetStats();
+    const uint64 buddyOnlyWaste = buddyPool.GetStats().usedBytes - requested;
+    const uint64 slabWaste = slabStats.usedBytes - slabRequested;
+    const uint64 buddyWaste = sizedPool.GetStats().usedBytes - slabStats.pageBytes - buddyRequested;
+    const uint64 sizedWaste = slabWaste + buddyWaste;
+
+    printf("[ AllocationStrategy ] %zu live allocations, %llu KB requested (%d slab, %d buddy, %d dedicated allocated)\n",
+        live.size(), (unsigned long long)(requested >> 10), counts[0], counts[1], counts[2]);
+    printf("[ AllocationStrategy ] buddy only: %llu KB internal fragmentation, %llu KB reserved\n",
+        (unsigned long long)(buddyOnlyWaste >> 10), (unsigned long long)(buddyBackend.reserved >> 10));
+    printf("[ AllocationStrategy ] size classes: %llu KB internal fragmentation (slab %llu KB, buddy %llu KB), "
+        "%llu KB reserved, %llu KB saved\n", (unsigned long long)(sizedWaste >> 10), (unsigned long long)(slabWaste >> 10),
+        (unsigned long long)(buddyWaste >> 10), (unsigned long long)((sizedBackend.reserved + dedicatedBytes) >> 10),
+        (unsigned long long)((buddyOnlyWaste - sizedWaste) >> 10));
+
+    ASSERT_GT(counts[0], 0u);
+    ASSERT_GT(counts[1], 0u);
+    ASSERT_GT(counts[2], 0u);
+    ASSERT_LT(sizedWaste * 2, buddyOnlyWaste);
+    ASSERT_LT(slabWaste * 4, slabRequested);
+
+    slabs.Destroy();
+    sizedPool.Destroy();
+    buddyPool.Destroy();
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <Renderer/Backend/Core/BuddyBlockPool/BuddyBlockPool.hpp>
+
+using namespace TRE;
+
+struct FakeBlock : public BuddyAllocator
+{
+};
+
+struct FakeBackend
+{
+    bool CreateBlock(FakeBlock& block, uint64 size)
+    {
+        if (reserved + size > capacity)
+            return false;
+
+        block.Init(64, (uint32)size);
+        reserved += size;
+        created.push_back(size);
+        return true;
+    }
+
+    void DestroyBlock(FakeBlock& block, uint32 index)
+    {
+        reserved -= block.maxSize;
+        destroyed.push_back(index);
+    }
+
+    uint64 capacity = UINT64_MAX;
+    uint64 reserved = 0;
+    std::vector<uint64> created;
+    std::vector<uint32> destroyed;
+};
+
+typedef BuddyBlockPool<FakeBlock, FakeBackend> FakePool;
+
+static BuddyPoolConfig MakeConfig()
+{
+    BuddyPoolConfig config;
+    config.minSize = 64;
+    config.firstBlockSize = 4096;
+    config.maxBlockSize = 65536;
+    config.growthFactor = 4;
+    config.releaseDelayFrames = 3;
+    config.spareBlocks = 1;
+    return config;
+}
+
+TEST(BuddyBlockPool, BuddiesMergeOnlyWhenBothAreFree)
+{
+    BuddyAllocator allocator;
+    allocator.Init(64, 1024);
+
+    const BuddyAllocator::Allocation a = allocator.Allocate(128);
+    const BuddyAllocator::Allocation b = allocator.Allocate(128);
+    const BuddyAllocator::Allocation c = allocator.Allocate(128);
+    const BuddyAllocator::Allocation d = allocator.Allocate(128);
+    ASSERT_EQ(d.offset, 384u);
+
+    // Both halves of the first 512 bytes are partially free, none of them can hold 256 bytes
+    allocator.Free(b);
+    allocator.Free(d);
+    ASSERT_EQ(allocator.GetLargestFreeBlock(), 512u);
+    ASSERT_EQ(allocator.Allocate(256).offset, 512u);
+    ASSERT_EQ(allocator.Allocate(128).offset, 128u);
+
+    allocator.Free(a);
+    allocator.Free(c);
+    ASSERT_EQ(allocator.Allocate(256).offset, 256u);
+    ASSERT_EQ(allocator.Allocate(256).offset, 768u);
+    ASSERT_EQ(allocator.Allocate(128).offset, 0u);
+    ASSERT_EQ(allocator.Allocate(64).offset, UINT64_MAX);
+}
+
+TEST(BuddyBlockPool, GrowsAndTracksStats)
+{
+    FakeBackend backend;
+    FakePool pool;
+    pool.Init(&backend, MakeConfig());
+
+    BuddyPoolAllocation a, b, c;
+    ASSERT_TRUE(pool.Allocate(1000, a));
+    ASSERT_TRUE(pool.Allocate(3000, b));
+    ASSERT_EQ(a.block, 0u);
+    ASSERT_EQ(b.block, 1u);
+    ASSERT_EQ(backend.created, (std::vector<uint64>{ 4096, 16384 }));
+
+    // Blocks grow by 4 up to the max, larger allocations get a block of their own size
+    ASSERT_TRUE(pool.Allocate(16384, c));
+    ASSERT_TRUE(pool.Allocate(100000, c));
+    ASSERT_EQ(backend.created, (std::vector<uint64>{ 4096, 16384, 65536, 131072 }));
+
+    BuddyPoolStats stats = pool.GetStats();
+    ASSERT_EQ(stats.blockCount, 4u);
+    ASSERT_EQ(stats.blockBytes, 4096u + 16384 + 65536 + 131072);
+    ASSERT_EQ(stats.usedBytes, 1024u + 4096 + 16384 + 131072);
+    ASSERT_EQ(stats.allocationCount, 4u);
+    ASSERT_EQ(stats.largestFreeBlock, 32768u);
+    ASSERT_EQ(stats.emptyBlockCount, 0u);
+    ASSERT_GT(stats.fragmentation, 0.f);
+
+    // A single free range isn't fragmented
+    FakePool single;
+    single.Init(&backend, MakeConfig());
+    ASSERT_TRUE(single.Allocate(2048, a));
+    ASSERT_FLOAT_EQ(single.GetStats().fragmentation, 0.f);
+    ASSERT_TRUE(single.Allocate(64, b));
+    ASSERT_FLOAT_EQ(single.GetStats().fragmentation, 1.f - 1024.f / 1984.f);
+}
+
+TEST(BuddyBlockPool, OutOfMemoryFallsBackToSmallerBlocks)
+{
+    FakeBackend backend;
+    backend.capacity = 4096 + 8192;
+    FakePool pool;
+    pool.Init(&backend, MakeConfig());
+
+    BuddyPoolAllocation a, b, c;
+    ASSERT_TRUE(pool.Allocate(4096, a));
+    ASSERT_TRUE(pool.Allocate(2000, b));
+    ASSERT_EQ(backend.created, (std::vector<uint64>{ 4096, 8192 }));
+    ASSERT_TRUE(pool.Allocate(4096, c));
+    ASSERT_FALSE(pool.Allocate(4096, c));
+
+    // Growth limited (over budget): blocks are sized to the allocation
+    FakeBackend unlimited;
+    FakePool limited;
+    limited.Init(&unlimited, MakeConfig());
+    limited.SetGrowthLimited(true);
+    ASSERT_TRUE(limited.Allocate(100, a));
+    ASSERT_TRUE(limited.Allocate(1000, b));
+    ASSERT_EQ(unlimited.created, (std::vector<uint64>{ 128, 1024 }));
+}
+
+TEST(BuddyBlockPool, ReleasesEmptyBlocksWithHysteresis)
+{
+    FakeBackend backend;
+    FakePool pool;
+    pool.Init(&backend, MakeConfig());
+
+    BuddyPoolAllocation a, b, c;
+    ASSERT_TRUE(pool.Allocate(4096, a));
+    ASSERT_TRUE(pool.Allocate(4096, b));
+    ASSERT_TRUE(pool.Allocate(16384, c));
+    ASSERT_EQ(pool.GetStats().blockCount, 3u);
+
+    pool.Free(b);
+    pool.Free(c);
+
+    // Nothing goes before the delay, then the largest empty block goes and the smallest stays as a spare
+    for (uint32 frame = 0; frame < 3; frame++) {
+        ASSERT_EQ(pool.ReleaseEmptyBlocks(), 0u);
+    }
+
+    ASSERT_EQ(pool.ReleaseEmptyBlocks(), 65536u);
+    ASSERT_EQ(backend.destroyed, (std::vector<uint32>{ 2 }));
+    ASSERT_EQ(pool.ReleaseEmptyBlocks(), 0u);
+    ASSERT_EQ(pool.GetStats().emptyBlockCount, 1u);
+
+    // Using the spare again resets its delay
+    ASSERT_TRUE(pool.Allocate(4096, b));
+    ASSERT_EQ(b.block, 1u);
+    pool.Free(b);
+    pool.Free(a);
+
+    for (uint32 frame = 0; frame < 3; frame++) {
+        ASSERT_EQ(pool.ReleaseEmptyBlocks(), 0u);
+    }
+
+    ASSERT_EQ(pool.ReleaseEmptyBlocks(), 16384u);
+    ASSERT_EQ(backend.destroyed, (std::vector<uint32>{ 2, 1 }));
+
+    // The hole is filled by the next growth, over budget every empty block goes right away
+    ASSERT_TRUE(pool.Allocate(4096, a));
+    ASSERT_TRUE(pool.Allocate(64, b));
+    ASSERT_EQ(b.block, 1u);
+    pool.Free(b);
+    pool.Free(a);
+    ASSERT_EQ(pool.ReleaseEmptyBlocks(true), 4096u + 16384);
+    ASSERT_EQ(pool.GetStats().blockCount, 0u);
+    ASSERT_EQ(backend.reserved, 0u);
+}
+
+TEST(BuddyBlockPool, DefragmentationEmptiesTheLeastUsedBlock)
+{
+    FakeBackend backend;
+    FakePool pool;
+    pool.Init(&backend, MakeConfig());
+
+    // Block 0 (4K) three quarters used, block 1 (16K) full
+    std::vector<BuddyPoolAllocation> live(3);
+    ASSERT_TRUE(pool.Allocate(2048, live[0]));
+    ASSERT_TRUE(pool.Allocate(16384, live[1]));
+    ASSERT_TRUE(pool.Allocate(1000, live[2]));
+    ASSERT_EQ(live[0].block, 0u);
+    ASSERT_EQ(live[1].block, 1u);
+    ASSERT_EQ(live[2].block, 0u);
+
+    // Nothing has room for the content of another block
+    std::vector<BuddyPoolMove> moves;
+    ASSERT_EQ(pool.PlanDefragmentation(live.data(), (uint32)live.size(), UINT64_MAX, 16, moves), 0u);
+
+    // Block 2 (64K) at half: it is the least used but doesn't fit elsewhere, block 0 goes into it
+    live.emplace_back();
+    ASSERT_TRUE(pool.Allocate(32768, live[3]));
+    ASSERT_EQ(live[3].block, 2u);
+
+    ASSERT_EQ(pool.PlanDefragmentation(live.data(), (uint32)live.size(), 2500, 16, moves), 1u);
+    ASSERT_EQ(moves[0].allocation, 0u);
+    ASSERT_EQ(moves[0].dst.block, 2u);
+
+    // The caller switches its resources to the destinations, the sources are freed once the copies are done
+    std::vector<BuddyPoolAllocation> pending;
+    pending.push_back(live[0]);
+    live[0] = moves[0].dst;
+
+    ASSERT_EQ(pool.PlanDefragmentation(live.data(), (uint32)live.size(), 2500, 16, moves), 1u);
+    ASSERT_EQ(moves[0].allocation, 2u);
+    ASSERT_EQ(moves[0].dst.block, 2u);
+    pending.push_back(live[2]);
+    live[2] = moves[0].dst;
+
+    // Block 0 is only pending frees now, block 1 fits in what is left of block 2 and moves alone past the byte limit
+    ASSERT_EQ(pool.PlanDefragmentation(live.data(), (uint32)live.size(), 2500, 16, moves), 1u);
+    ASSERT_EQ(moves[0].allocation, 1u);
+    ASSERT_EQ(moves[0].dst.block, 2u);
+    pending.push_back(live[1]);
+    live[1] = moves[0].dst;
+    ASSERT_EQ(pool.GetStats().allocationCount, 7u);
+
+    for (const BuddyPoolAllocation& alloc : pending) {
+        pool.Free(alloc);
+    }
+
+    ASSERT_TRUE(pool.GetBlock(0).IsEmpty());
+    ASSERT_TRUE(pool.GetBlock(1).IsEmpty());
+    ASSERT_EQ(pool.GetStats().allocationCount, 4u);
+    ASSERT_EQ(pool.GetBlock(2).GetUsedSize(), 32768u + 16384 + 2048 + 1024);
+    ASSERT_EQ(pool.PlanDefragmentation(live.data(), (uint32)live.size(), UINT64_MAX, 16, moves), 0u);
+}
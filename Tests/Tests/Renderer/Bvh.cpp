@@ -0,0 +1,314 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/Core/Bvh/SceneBvh.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+namespace
+{
+    // Random triangles of various sizes in a 10 unit cube, indexed
+    struct Soup
+    {
+        std::vector<float> positions;
+        std::vector<uint32> indices;
+
+        Soup(uint32 triangles, uint32 seed)
+        {
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<float> center(-5.f, 5.f);
+            std::uniform_real_distribution<float> offset(-1.f, 1.f);
+
+            for (uint32 i = 0; i < triangles; i++) {
+                const float size = (i % 10 == 0) ? 3.f : 0.3f;
+                const float c[3] = { center(gen), center(gen), center(gen) };
+
+                for (uint32 corner = 0; corner < 3; corner++) {
+                    for (uint32 axis = 0; axis < 3; axis++) {
+                        positions.push_back(c[axis] + offset(gen) * size);
+                    }
+
+                    indices.push_back(i * 3 + (2 - corner));
+                }
+            }
+        }
+
+        BvhTriangle Triangle(uint32 i, const float (*transform)[4] = NULL) const
+        {
+            float v[3][3];
+
+            for (uint32 corner = 0; corner < 3; corner++) {
+                const float* p = &positions[indices[i * 3 + corner] * 3];
+
+                for (uint32 row = 0; row < 3; row++) {
+                    v[corner][row] = transform ? transform[row][0] * p[0] + transform[row][1] * p[1] + transform[row][2] * p[2] + transform[row][3] : p[row];
+                }
+            }
+
+            BvhTriangle tri;
+
+            for (uint32 axis = 0; axis < 3; axis++) {
+                tri.v0[axis] = v[0][axis];
+                tri.e1[axis] = v[1][axis] - v[0][axis];
+                tri.e2[axis] = v[2][axis] - v[0][axis];
+            }
+
+            tri.primitive = i;
+            return tri;
+        }
+
+        uint32 Count() const { return uint32(indices.size() / 3); }
+    };
+
+    BvhRay RandomRay(std::mt19937& gen, float spread = 8.f)
+    {
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        const float origin[3] = { dist(gen) * spread, dist(gen) * spread, dist(gen) * spread };
+        float direction[3] = { dist(gen), dist(gen), dist(gen) };
+
+        // Some axis aligned ones for the zero direction components
+        if (gen() % 8 == 0) {
+            direction[gen() % 3] = 0.f;
+        }
+
+        return BvhRay(origin, direction, 0.f, gen() % 4 ? FLT_MAX : 5.f);
+    }
+
+    float BruteForce(const std::vector<BvhTriangle>& triangles, BvhRay ray)
+    {
+        float closest = FLT_MAX;
+
+        for (const BvhTriangle& tri : triangles) {
+            float t, u, v;
+
+            if (BvhIntersectTriangle(tri, ray, t, u, v) && t < closest) {
+                closest = t;
+            }
+        }
+
+        return closest;
+    }
+
+    std::vector<BvhTriangle> Triangles(const Soup& soup)
+    {
+        std::vector<BvhTriangle> triangles;
+
+        for (uint32 i = 0; i < soup.Count(); i++) {
+            triangles.push_back(soup.Triangle(i));
+        }
+
+        return triangles;
+    }
+
+    void CheckAgainstBruteForce(const MeshBvh& bvh, const std::vector<BvhTriangle>& triangles, uint32 seed)
+    {
+        std::mt19937 gen(seed);
+
+        for (uint32 i = 0; i < 2000; i++) {
+            const BvhRay original = RandomRay(gen);
+            const float expected = BruteForce(triangles, original);
+            BvhRay ray = original;
+            BvhHit hit;
+
+            ASSERT_EQ(bvh.Intersect(ray, hit), expected != FLT_MAX);
+            ASSERT_EQ(bvh.Occluded(original), expected != FLT_MAX);
+
+            if (hit.IsValid()) {
+                ASSERT_EQ(hit.t, expected);
+                ASSERT_EQ(ray.tMax, expected);
+                ASSERT_LT(hit.primitive, triangles.size());
+
+                // The reported triangle is hit at the reported distance
+                BvhRay check = original;
+                float t, u, v;
+                ASSERT_TRUE(BvhIntersectTriangle(triangles[hit.primitive], check, t, u, v));
+                ASSERT_EQ(t, hit.t);
+                ASSERT_EQ(u, hit.u);
+                ASSERT_EQ(v, hit.v);
+            }
+        }
+    }
+}
+
+TEST(Bvh, ClosestHitMatchesBruteForce)
+{
+    const Soup soup(3000, 1);
+    MeshBvh bvh;
+    bvh.Build(soup.positions.data(), uint32(soup.positions.size() / 3), 3 * sizeof(float), soup.indices.data(), soup.Count());
+
+    ASSERT_EQ(bvh.GetTriangleCount(), soup.Count());
+    ASSERT_GT(bvh.GetNodeCount(), 1u);
+    CheckAgainstBruteForce(bvh, Triangles(soup), 2);
+}
+
+// Threaded builds order the nodes differently but must hit the same triangles
+TEST(Bvh, ThreadedBuildMatchesBruteForce)
+{
+    const Soup soup(20000, 3);
+    BvhBuildSettings settings;
+    settings.threadCount = 8;
+    settings.maxLeafSize = 8;
+    settings.binCount = 32;
+
+    MeshBvh bvh;
+    bvh.Build(soup.positions.data(), uint32(soup.positions.size() / 3), 3 * sizeof(float), soup.indices.data(), soup.Count(), settings);
+    CheckAgainstBruteForce(bvh, Triangles(soup), 4);
+}
+
+// Every centroid at one point, the builder can only split by count
+TEST(Bvh, CoincidentTriangles)
+{
+    const float triangle[9] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f };
+    std::vector<float> positions;
+
+    for (uint32 i = 0; i < 100; i++) {
+        positions.insert(positions.end(), triangle, triangle + 9);
+    }
+
+    MeshBvh bvh;
+    bvh.Build(positions.data(), 300, 3 * sizeof(float), NULL, 100);
+
+    const float origin[3] = { 0.25f, 0.25f, 1.f };
+    const float direction[3] = { 0.f, 0.f, -1.f };
+    BvhRay ray(origin, direction);
+    BvhHit hit;
+    ASSERT_TRUE(bvh.Intersect(ray, hit));
+    ASSERT_EQ(hit.t, 1.f);
+    ASSERT_LT(hit.primitive, 100u);
+
+    MeshBvh empty;
+    empty.Build(NULL, 0, 12, NULL, 0);
+    BvhRay miss(origin, direction);
+    ASSERT_FALSE(empty.Intersect(miss, hit));
+    ASSERT_FALSE(empty.Occluded(miss));
+}
+
+TEST(Bvh, PacketsMatchSingleRays)
+{
+    const Soup soup(3000, 5);
+    MeshBvh bvh;
+    bvh.Build(soup.positions.data(), uint32(soup.positions.size() / 3), 3 * sizeof(float), soup.indices.data(), soup.Count());
+    std::mt19937 gen(6);
+
+    for (uint32 i = 0; i < 1000; i++) {
+        BvhRayPacket4 packet;
+        BvhRay rays[4];
+        BvhHit hits[4];
+
+        for (uint32 lane = 0; lane < 4; lane++) {
+            rays[lane] = RandomRay(gen);
+
+            // A missing lane now and then
+            if (gen() % 8) {
+                packet.SetRay(lane, rays[lane]);
+            }
+        }
+
+        const uint32 hitLanes = bvh.Intersect(packet, hits);
+
+        for (uint32 lane = 0; lane < 4; lane++) {
+            if (!(packet.active & (1u << lane))) {
+                ASSERT_FALSE(hitLanes & (1u << lane));
+                continue;
+            }
+
+            BvhHit expected;
+            const bool hit = bvh.Intersect(rays[lane], expected);
+            ASSERT_EQ(bool(hitLanes & (1u << lane)), hit);
+
+            if (hit) {
+                ASSERT_NEAR(hits[lane].t, expected.t, 1e-4f * expected.t);
+                ASSERT_NEAR(packet.tMax[lane], expected.t, 1e-4f * expected.t);
+            }
+        }
+    }
+}
+
+TEST(Bvh, InstancesMatchTransformedTriangles)
+{
+    const Soup soups[2] = { Soup(500, 7), Soup(800, 8) };
+    MeshBvh meshes[2];
+
+    for (uint32 i = 0; i < 2; i++) {
+        meshes[i].Build(soups[i].positions.data(), uint32(soups[i].positions.size() / 3), 3 * sizeof(float), soups[i].indices.data(), soups[i].Count());
+    }
+
+    // Rotated, scaled and moved copies, one of them singular and one hidden by its mask
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<BvhInstance> instances(12);
+
+    for (uint32 i = 0; i < instances.size(); i++) {
+        BvhInstance& instance = instances[i];
+        const float angle = dist(gen) * 3.14159f;
+        const float scale = 0.5f + (dist(gen) + 1.f) * 0.5f;
+        const float transform[3][4] = {
+            { cosf(angle) * scale, 0.f, sinf(angle) * scale, dist(gen) * 20.f },
+            { 0.f, scale, 0.f, dist(gen) * 20.f },
+            { -sinf(angle) * scale, 0.f, cosf(angle) * scale, dist(gen) * 20.f },
+        };
+
+        memcpy(instance.transform, transform, sizeof(transform));
+        instance.mesh = &meshes[i % 2];
+        instance.mask = i == 5 ? 0x2 : 0x1;
+
+        if (i == 7) {
+            memset(instance.transform, 0, sizeof(instance.transform));
+        }
+    }
+
+    SceneBvh scene;
+    scene.Build(instances.data(), uint32(instances.size()));
+    ASSERT_EQ(scene.GetInstanceCount(), 11u);
+
+    for (uint32 i = 0; i < 2000; i++) {
+        BvhRay ray = RandomRay(gen, 25.f);
+        ray.mask = 0x1;
+        float expected = FLT_MAX;
+        uint32 expectedInstance = BvhHit::INVALID;
+
+        for (uint32 instance = 0; instance < instances.size(); instance++) {
+            if (instance == 5 || instance == 7) {
+                continue;
+            }
+
+            const Soup& soup = soups[instance % 2];
+
+            for (uint32 tri = 0; tri < soup.Count(); tri++) {
+                float t, u, v;
+
+                if (BvhIntersectTriangle(soup.Triangle(tri, instances[instance].transform), ray, t, u, v) && t < expected) {
+                    expected = t;
+                    expectedInstance = instance;
+                }
+            }
+        }
+
+        BvhRay copy = ray;
+        BvhHit hit;
+        ASSERT_EQ(scene.Intersect(copy, hit), expected != FLT_MAX);
+
+        if (hit.IsValid()) {
+            // Object space intersections round differently, close hits of two instances may swap
+            ASSERT_NEAR(hit.t, expected, 1e-3f * expected);
+
+            if (fabsf(hit.t - expected) > 1e-5f * expected) {
+                ASSERT_NE(hit.instance, expectedInstance);
+            }
+
+            ASSERT_NE(hit.instance, 5u);
+            ASSERT_NE(hit.instance, 7u);
+        }
+
+        BvhRayPacket4 packet;
+        BvhHit hits[4];
+        packet.mask = ray.mask;
+        packet.SetRay(2, ray);
+        ASSERT_EQ(scene.Intersect(packet, hits) == 4u, hit.IsValid());
+
+        if (hit.IsValid()) {
+            ASSERT_NEAR(hits[2].t, hit.t, 1e-4f * hit.t);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <Renderer/Backend/Core/DeletionQueue/DeletionQueue.hpp>
+
+using namespace TRE;
+
+namespace
+{
+    struct DestroyLog
+    {
+        std::vector<uint32> destroyed;
+        std::thread::id thread;
+    };
+
+    void DestroyEntries(const uint32* entries, uint32 count, void* userData)
+    {
+        DestroyLog& log = *static_cast<DestroyLog*>(userData);
+        log.destroyed.insert(log.destroyed.end(), entries, entries + count);
+        log.thread = std::this_thread::get_id();
+    }
+}
+
+TEST(DeletionQueue, CollectsByRetireValue)
+{
+    DeletionQueue<uint32> queue;
+    std::vector<uint32> ready;
+
+    // Frame 1 queues two objects, frame 2 one and frame 4 one
+    queue.Push(10, 1);
+    queue.Push(11, 1);
+    queue.Push(20, 2);
+    queue.Push(40, 4);
+    ASSERT_EQ(queue.GetPendingCount(), 4u);
+
+    ASSERT_EQ(queue.Collect(0, ready), 0u);
+    ASSERT_TRUE(ready.empty());
+
+    ASSERT_EQ(queue.Collect(2, ready), 3u);
+    ASSERT_EQ(ready, (std::vector<uint32>{ 10, 11, 20 }));
+    ASSERT_EQ(queue.GetPendingCount(), 1u);
+
+    // Recycled batches keep working
+    queue.Push(50, 5);
+    ready.clear();
+    ASSERT_EQ(queue.Collect(4, ready), 1u);
+    ASSERT_EQ(ready, (std::vector<uint32>{ 40 }));
+
+    ready.clear();
+    ASSERT_EQ(queue.Collect(UINT64_MAX, ready), 1u);
+    ASSERT_EQ(ready, (std::vector<uint32>{ 50 }));
+    ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(DeletionQueue, WorkerDestroysInOrderOffThread)
+{
+    DestroyLog log;
+    DeletionWorker<uint32> worker;
+    worker.Init(DestroyEntries, &log);
+
+    std::vector<uint32> expected;
+
+    for (uint32 batch = 0; batch < 64; batch++) {
+        uint32 entries[16];
+
+        for (uint32 i = 0; i < 16; i++) {
+            entries[i] = batch * 16 + i;
+            expected.push_back(entries[i]);
+        }
+
+        worker.Submit(entries, 16);
+    }
+
+    worker.Flush();
+    ASSERT_EQ(log.destroyed, expected);
+    ASSERT_NE(log.thread, std::this_thread::get_id());
+
+    const DeletionWorkerStats stats = worker.GetStats();
+    ASSERT_EQ(stats.destroyedObjects, 64u * 16);
+    ASSERT_EQ(stats.batches, 64u);
+    ASSERT_GE(stats.maxLatencyMs, stats.lastLatencyMs);
+
+    // Once shut down, batches are destroyed right away on the caller
+    worker.Shutdown();
+    const uint32 last = 9999;
+    worker.Submit(&last, 1);
+    ASSERT_EQ(log.destroyed.back(), last);
+    ASSERT_EQ(log.thread, std::this_thread::get_id());
+}
+
+TEST(DeletionQueue, ShutdownDrainsPendingBatches)
+{
+    DestroyLog log;
+
+    {
+        DeletionWorker<uint32> worker;
+        worker.Init(DestroyEntries, &log);
+
+        for (uint32 i = 0; i < 1000; i++) {
+            worker.Submit(&i, 1);
+        }
+    }
+
+    ASSERT_EQ(log.destroyed.size(), 1000u);
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/RHI/DrawQueue/DrawQueue.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+struct FakePipeline { uint32 id; };
+struct FakeBuffer { uint32 id; };
+typedef BasicDrawPacket<FakePipeline, uint64, FakeBuffer> FakePacket;
+
+struct FakeRecorder
+{
+    std::vector<const FakePipeline*> pipelines;
+    std::vector<std::pair<uint32, uint32>> setRanges; // first, count
+    std::vector<uint32> dynamicOffsets;
+    uint32 vertexBinds = 0;
+    uint32 indexBinds = 0;
+    uint32 draws = 0;
+
+    void BindPipeline(const FakePipeline& pipeline) { pipelines.push_back(&pipeline); }
+
+    void BindDescriptorSets(const FakePipeline&, uint32 first, const uint64*, uint32 count, const uint32* offsets, uint32 offsetCount)
+    {
+        setRanges.emplace_back(first, count);
+        dynamicOffsets.insert(dynamicOffsets.end(), offsets, offsets + offsetCount);
+    }
+
+    void BindVertexBuffer(const FakeBuffer&, uint64) { vertexBinds++; }
+
+    void BindIndexBuffer(const FakeBuffer&, uint64, uint8) { indexBinds++; }
+
+    void Draw(uint32, uint32, uint32, uint32) { draws++; }
+
+    void DrawIndexed(uint32, uint32, uint32, int32, uint32) { draws++; }
+};
+
+struct SortItem
+{
+    uint64 key;
+    uint32 index;
+};
+
+static std::vector<SortItem> RandomItems(usize count, uint64 mask, uint32 seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<SortItem> items(count);
+
+    for (usize i = 0; i < count; i++) {
+        items[i] = { gen() & mask, (uint32)i };
+    }
+
+    return items;
+}
+
+static void CheckRadixSort(usize count, uint64 mask, uint32 threads)
+{
+    std::vector<SortItem> items = RandomItems(count, mask, (uint32)count + threads);
+    std::vector<SortItem> expected = items;
+    std::vector<SortItem> scratch(count);
+
+    std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+    Utils::RadixSort(items.data(), scratch.data(), count, [](const SortItem& item) { return item.key; }, threads);
+
+    for (usize i = 0; i < count; i++) {
+        ASSERT_EQ(items[i].key, expected[i].key) << i;
+        ASSERT_EQ(items[i].index, expected[i].index) << i; // Stable
+    }
+}
+
+TEST(RadixSort, SingleThread)
+{
+    CheckRadixSort(0, ~0ull, 1);
+    CheckRadixSort(1, ~0ull, 1);
+    CheckRadixSort(1000, ~0ull, 1);
+    CheckRadixSort(10000, 0xFF, 1); // Many duplicates, most passes skipped
+    CheckRadixSort(10000, 0xFF00000000FF0000ull, 1); // Odd number of passes
+}
+
+TEST(RadixSort, MultiThread)
+{
+    CheckRadixSort(100000, ~0ull, 4);
+    CheckRadixSort(100000, 0xFFFF, 3);
+    CheckRadixSort(200000, 0xFF000000000000FFull, 8);
+    CheckRadixSort(500, ~0ull, 4); // Falls back to a single thread
+}
+
+TEST(RadixSort, AllEqualKeys)
+{
+    std::vector<SortItem> items(4096, SortItem{ 42, 0 });
+    std::vector<SortItem> scratch(items.size());
+
+    for (uint32 i = 0; i < items.size(); i++) {
+        items[i].index = i;
+    }
+
+    Utils::RadixSort(items.data(), scratch.data(), items.size(), [](const SortItem& item) { return item.key; });
+
+    for (uint32 i = 0; i < items.size(); i++) {
+        ASSERT_EQ(items[i].index, i);
+    }
+}
+
+TEST(DrawKey, Encoding)
+{
+    const uint64 key = DrawKey::Encode(5, 0x123456789ABCDEFull, 0xBEEF, 0x123456);
+
+    EXPECT_EQ(DrawKey::GetPass(key), 5);
+    EXPECT_EQ(DrawKey::GetPipeline(key), DrawKey::FoldPipelineHash(0x123456789ABCDEFull));
+    EXPECT_EQ(DrawKey::GetMaterial(key), 0xBEEF);
+    EXPECT_EQ(DrawKey::GetDepth(key), 0x123456);
+
+    // Pass dominates everything else, depth only breaks ties
+    EXPECT_LT(DrawKey::Encode(1, ~0ull, 0xFFFF, 0xFFFFFF), DrawKey::Encode(2, 0, 0, 0));
+    EXPECT_LT(DrawKey::Encode(1, 7, 3, 0xFFFFFF), DrawKey::Encode(1, 7, 4, 0));
+
+    EXPECT_EQ(DrawKey::QuantizeDepth(1.f, 1.f, 100.f), 0);
+    EXPECT_EQ(DrawKey::QuantizeDepth(100.f, 1.f, 100.f), DrawKey::Mask(DrawKey::DEPTH_BITS));
+    EXPECT_LT(DrawKey::QuantizeDepth(10.f, 1.f, 100.f), DrawKey::QuantizeDepth(20.f, 1.f, 100.f));
+    EXPECT_GT(DrawKey::QuantizeDepth(10.f, 1.f, 100.f, true), DrawKey::QuantizeDepth(20.f, 1.f, 100.f, true));
+}
+
+TEST(DrawQueue, ReplaySkipsRedundantBinds)
+{
+    FakePipeline pipelines[2] = { { 0 }, { 1 } };
+    FakeBuffer vertexBuffer{ 0 }, indexBuffer{ 1 };
+    DrawQueue<FakePacket> queue;
+
+    // 2 pipelines x 3 materials x 4 draws pushed in the worst possible order
+    for (uint32 draw = 0; draw < 4; draw++) {
+        for (uint32 material = 0; material < 3; material++) {
+            for (uint32 p = 0; p < 2; p++) {
+                FakePacket& packet = queue.Push(DrawKey::Encode(0, p, material, 100 - draw));
+                packet = {};
+                packet.pipeline = &pipelines[p];
+                packet.vertexBuffer = &vertexBuffer;
+                packet.indexBuffer = &indexBuffer;
+                packet.descriptorSets[0] = 1000; // Per frame set, shared by everything
+                packet.descriptorSets[1] = 2000 + material;
+                packet.descriptorSetCount = 2;
+                packet.dynamicSets = 0b10;
+                packet.dynamicOffsets[0] = material * 256;
+                packet.count = 36;
+                packet.instanceCount = 1;
+            }
+        }
+    }
+
+    queue.Sort();
+
+    for (usize i = 1; i < queue.Size(); i++) {
+        ASSERT_LE(queue.GetItems()[i - 1].key, queue.GetItems()[i].key);
+    }
+
+    FakeRecorder recorder;
+    const DrawReplayStats stats = ReplayDraws(queue, recorder);
+
+    EXPECT_EQ(stats.draws, 24);
+    EXPECT_EQ(recorder.draws, 24);
+    EXPECT_EQ(stats.pipelineBinds, 2);
+    ASSERT_EQ(recorder.pipelines.size(), 2);
+    EXPECT_EQ(recorder.pipelines[0], &pipelines[0]);
+    EXPECT_EQ(recorder.pipelines[1], &pipelines[1]);
+    EXPECT_EQ(stats.vertexBufferBinds, 1);
+    EXPECT_EQ(stats.indexBufferBinds, 1);
+
+    // Per pipeline: both sets once, then only set 1 for the two other materials
+    ASSERT_EQ(stats.descriptorSetBinds, 6);
+    const std::pair<uint32, uint32> expectedRanges[] = { {0, 2}, {1, 1}, {1, 1}, {0, 2}, {1, 1}, {1, 1} };
+
+    for (uint32 i = 0; i < 6; i++) {
+        EXPECT_EQ(recorder.setRanges[i], expectedRanges[i]) << i;
+    }
+
+    EXPECT_EQ(recorder.dynamicOffsets, (std::vector<uint32>{ 0, 256, 512, 0, 256, 512 }));
+
+    queue.Reset();
+    EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(DrawQueue, DynamicOffsetChangeRebindsSet)
+{
+    FakePipeline pipeline{ 0 };
+    DrawQueue<FakePacket> queue;
+
+    for (uint32 i = 0; i < 3; i++) {
+        FakePacket& packet = queue.Push(DrawKey::Encode(0, 0, 0, i));
+        packet = {};
+        packet.pipeline = &pipeline;
+        packet.descriptorSets[0] = 1;
+        packet.descriptorSetCount = 1;
+        packet.dynamicSets = 1;
+        packet.dynamicOffsets[0] = i == 2 ? 64 : 0;
+        packet.count = 3;
+        packet.instanceCount = 1;
+    }
+
+    queue.Sort();
+    FakeRecorder recorder;
+    const DrawReplayStats stats = ReplayDraws(queue, recorder);
+
+    EXPECT_EQ(stats.descriptorSetBinds, 2);
+    EXPECT_EQ(recorder.dynamicOffsets, (std::vector<uint32>{ 0, 64 }));
+    EXPECT_EQ(stats.vertexBufferBinds, 0);
+    EXPECT_EQ(stats.indexBufferBinds, 0);
+}
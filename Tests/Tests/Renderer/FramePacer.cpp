@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <Renderer/Backend/RHI/FramePacing/FramePacer.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+namespace
+{
+    struct SimulatedFrames
+    {
+        uint64 lastLatency = 0;
+        uint64 latencySum = 0;  // Over the last half of the frames
+        uint32 missed = 0;      // Presents more than one vblank after the previous one, over the last half as well
+    };
+
+    // A FIFO swapchain with vblanks every interval, frames start once the previous one is on screen (like a present wait)
+    SimulatedFrames Simulate(FramePacer& pacer, uint32 frames, uint64 interval, uint64 cpuTime, uint64 gpuTime)
+    {
+        SimulatedFrames result;
+        uint64 now = interval;
+        uint64 lastPresent = 0;
+
+        for (uint64 frame = 0; frame < frames; frame++) {
+            now = std::max(now, pacer.GetWakeTime(now));
+            pacer.BeginFrame(frame, now);
+            pacer.EndFrame(frame, now + cpuTime);
+
+            const uint64 ready = now + cpuTime + gpuTime;
+            const uint64 present = (ready + interval - 1) / interval * interval;
+            pacer.OnFrameDone(frame, present, true);
+
+            if (frame >= frames / 2) {
+                result.latencySum += present - now;
+                result.missed += lastPresent && present - lastPresent > interval;
+            }
+
+            result.lastLatency = present - now;
+            lastPresent = present;
+            now = present;
+        }
+
+        return result;
+    }
+}
+
+TEST(FramePacer, CapSpacesFrameStarts)
+{
+    FramePacer pacer;
+    FramePacingSettings settings;
+    settings.targetFrameTimeUs = 10000;
+    pacer.SetSettings(settings);
+
+    // Nothing to wait for before the first frame
+    ASSERT_EQ(pacer.GetWakeTime(500), 0u);
+    pacer.BeginFrame(0, 1000);
+    pacer.EndFrame(0, 3000);
+    ASSERT_EQ(pacer.GetWakeTime(3000), 11000u);
+
+    // A late frame isn't made up for
+    pacer.BeginFrame(1, 25000);
+    ASSERT_EQ(pacer.GetWakeTime(26000), 35000u);
+
+    // Without present times there is nothing to start just in time for, the cap still applies
+    settings.justInTime = true;
+    pacer.SetSettings(settings);
+    pacer.OnFrameDone(1, 30000, false);
+    ASSERT_EQ(pacer.GetWakeTime(30000), 35000u);
+}
+
+TEST(FramePacer, JustInTimeCutsLatency)
+{
+    constexpr uint64 INTERVAL = 16667;
+    constexpr uint64 CPU_TIME = 4000;
+    constexpr uint64 GPU_TIME = 3000;
+
+    // Starting as soon as the previous frame is shown, the frame waits most of an interval for its vblank
+    FramePacer eager;
+    const SimulatedFrames eagerFrames = Simulate(eager, 200, INTERVAL, CPU_TIME, GPU_TIME);
+    ASSERT_EQ(eagerFrames.lastLatency, INTERVAL);
+    ASSERT_EQ(eagerFrames.missed, 0u);
+    ASSERT_NEAR((double)eager.GetInterval(), (double)INTERVAL, 1.0);
+
+    // Just in time, the margin grows to cover the GPU time the CPU estimate misses, then the frame starts right before it's needed
+    FramePacer pacer;
+    FramePacingSettings settings;
+    settings.justInTime = true;
+    settings.presentWait = true;
+    pacer.SetSettings(settings);
+    const SimulatedFrames frames = Simulate(pacer, 200, INTERVAL, CPU_TIME, GPU_TIME);
+
+    ASSERT_GE(pacer.GetMargin(), GPU_TIME);
+    ASSERT_LE(frames.missed, 2u);
+    ASSERT_LT(frames.latencySum / 100, CPU_TIME + GPU_TIME + 2 * settings.jitMarginUs + INTERVAL / 20);
+
+    // Latencies are reported the same way either way
+    const FrameLatencyStats stats = pacer.GetLatencyStats();
+    ASSERT_EQ(stats.frameId, 199u);
+    ASSERT_EQ(stats.count, FramePacer::LATENCY_HISTORY);
+    ASSERT_TRUE(stats.presentTimed);
+    ASSERT_LE(stats.minUs, stats.averageUs);
+    ASSERT_LE(stats.averageUs, stats.maxUs);
+    ASSERT_LT(stats.averageUs, eager.GetLatencyStats().averageUs);
+}
+
+TEST(FramePacer, LatencyStats)
+{
+    FramePacer pacer;
+    ASSERT_EQ(pacer.GetLatencyStats().count, 0u);
+
+    // Up to two frames in flight, completion seen through the frame fences
+    pacer.BeginFrame(0, 0);
+    pacer.EndFrame(0, 2000);
+    pacer.BeginFrame(1, 5000);
+    pacer.EndFrame(1, 7000);
+    pacer.OnFrameDone(0, 9000, false);
+    pacer.BeginFrame(2, 10000);
+    pacer.OnFrameDone(1, 12000, false);
+
+    // Reported once, frames never begun are ignored
+    pacer.OnFrameDone(1, 50000, false);
+    pacer.OnFrameDone(7, 50000, false);
+
+    FrameLatencyStats stats = pacer.GetLatencyStats();
+    ASSERT_EQ(stats.count, 2u);
+    ASSERT_EQ(stats.frameId, 1u);
+    ASSERT_EQ(stats.lastUs, 7000u);
+    ASSERT_EQ(stats.minUs, 7000u);
+    ASSERT_EQ(stats.maxUs, 9000u);
+    ASSERT_EQ(stats.averageUs, 8000u);
+    ASSERT_FALSE(stats.presentTimed);
+    ASSERT_EQ(pacer.GetCpuEstimate(), 2000u);
+
+    // Old records are overwritten once their slot comes around again
+    for (uint64 frame = 3; frame < 3 + FramePacer::MAX_PENDING_FRAMES; frame++) {
+        pacer.BeginFrame(frame, frame * 1000);
+    }
+
+    pacer.OnFrameDone(2, 60000, false);
+    ASSERT_EQ(pacer.GetLatencyStats().count, 2u);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <math.h>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/RHI/IndirectDraw/IndirectCulling.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+namespace
+{
+    CONSTEXPR float NEAR_PLANE = 0.1f;
+    CONSTEXPR float FAR_PLANE = 100.f;
+
+    // Camera at the origin looking down -Z, 90 degrees vertical field of view, Vulkan depth range
+    void MakeViewProj(float viewProj[16], float aspect = 1.f)
+    {
+        const float f = 1.f / tanf(0.25f * 3.14159265f);
+
+        for (uint32 i = 0; i < 16; i++) {
+            viewProj[i] = 0.f;
+        }
+
+        viewProj[0] = f / aspect;
+        viewProj[5] = -f;
+        viewProj[10] = FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+        viewProj[11] = -1.f;
+        viewProj[14] = NEAR_PLANE * FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+    }
+
+    GpuInstance MakeInstance(uint32 mesh, float x, float y, float z, float scale = 1.f)
+    {
+        GpuInstance instance = {};
+        instance.model[0] = scale;
+        instance.model[5] = scale;
+        instance.model[10] = scale;
+        instance.model[12] = x;
+        instance.model[13] = y;
+        instance.model[14] = z;
+        instance.model[15] = 1.f;
+        instance.mesh = mesh;
+        return instance;
+    }
+
+    struct Scene
+    {
+        std::vector<GpuInstance> instances;
+        std::vector<GpuMesh> meshes;
+        std::vector<GpuMeshLod> lods;
+        std::vector<GpuBatch> batches;
+        std::vector<GpuDrawCommand> commands;
+        std::vector<uint32> counts;
+        GpuCullParams params = {};
+
+        // Two batches, mesh 0 with three LODs up to 60 units, mesh 1 with one LOD, both unit spheres
+        Scene()
+        {
+            lods = {
+                { 300, 0, 0, 10.f }, { 120, 300, 0, 30.f }, { 36, 420, 0, 60.f },
+                { 90, 456, 100, FLT_MAX },
+            };
+            meshes = {
+                { { 0.f, 0.f, 0.f, 1.f }, 0, 3, 0, 0 },
+                { { 0.f, 0.f, 0.f, 1.f }, 3, 1, 1, 0 },
+            };
+            batches.resize(2);
+
+            float viewProj[16];
+            MakeViewProj(viewProj);
+            ExtractFrustumPlanes(viewProj, params.planes);
+            params.lodScale = 1.f;
+        }
+
+        uint32 Cull()
+        {
+            const uint32 total = LayoutBatches(instances.data(), (uint32)instances.size(), meshes.data(), batches.data(),
+                (uint32)batches.size());
+            commands.assign(total, GpuDrawCommand{});
+            counts.assign(batches.size(), 0);
+            params.instanceCount = (uint32)instances.size();
+            return CullInstances(params, instances.data(), meshes.data(), lods.data(), batches.data(), commands.data(),
+                counts.data());
+        }
+
+        std::vector<uint32> GetDrawnInstances(uint32 batch) const
+        {
+            std::vector<uint32> drawn;
+
+            for (uint32 i = 0; i < counts[batch]; i++) {
+                drawn.push_back(commands[batches[batch].firstCommand + i].firstInstance);
+            }
+
+            std::sort(drawn.begin(), drawn.end());
+            return drawn;
+        }
+    };
+}
+
+TEST(IndirectCulling, ExtractsNormalizedPlanes)
+{
+    Scene scene;
+
+    // Points right in front of the camera are inside every plane, the near and far planes are where they should be
+    for (uint32 p = 0; p < 6; p++) {
+        const float* plane = scene.params.planes[p];
+        ASSERT_NEAR(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2], 1.f, 1e-5f);
+        ASSERT_GT(-plane[2] * 50.f + plane[3], 0.f);
+    }
+
+    ASSERT_NEAR(scene.params.planes[4][3] / scene.params.planes[4][2], NEAR_PLANE, 1e-4f);
+    ASSERT_NEAR(scene.params.planes[5][3] / scene.params.planes[5][2], FAR_PLANE, 0.1f);
+}
+
+TEST(IndirectCulling, CullsAndSelectsLods)
+{
+    Scene scene;
+    scene.instances = {
+        MakeInstance(0, 0.f, 0.f, -5.f),        // LOD 0
+        MakeInstance(0, 0.f, 0.f, -20.f),       // LOD 1
+        MakeInstance(0, 0.f, 0.f, -45.f),       // LOD 2
+        MakeInstance(0, 0.f, 0.f, -70.f),       // Past the last LOD
+        MakeInstance(1, 0.f, 0.f, 5.f),         // Behind the camera
+        MakeInstance(1, 0.f, 0.f, -150.f),      // Past the far plane
+        MakeInstance(1, 10.6f, 0.f, -10.f),     // Outside on the right, but the sphere reaches in
+        MakeInstance(1, 12.f, 0.f, -10.f),      // Outside on the right
+        MakeInstance(1, 12.f, 0.f, -10.f, 3.f), // Same, scaled up it reaches in
+        MakeInstance(1, 0.f, -99.f, -98.f),     // Far, mostly below the frustum, mesh 1 has no distance limit
+    };
+
+    ASSERT_EQ(scene.Cull(), 6u);
+    ASSERT_EQ(scene.counts[0], 3u);
+    ASSERT_EQ(scene.counts[1], 3u);
+    ASSERT_EQ(scene.GetDrawnInstances(0), (std::vector<uint32>{ 0, 1, 2 }));
+    ASSERT_EQ(scene.GetDrawnInstances(1), (std::vector<uint32>{ 6, 8, 9 }));
+
+    // The first three instances use the LOD of the same index
+    for (uint32 i = 0; i < 3; i++) {
+        const GpuDrawCommand& command = scene.commands[scene.batches[0].firstCommand + i];
+        const GpuMeshLod& lod = scene.lods[command.firstInstance];
+        ASSERT_EQ(command.indexCount, lod.indexCount);
+        ASSERT_EQ(command.firstIndex, lod.firstIndex);
+        ASSERT_EQ(command.instanceCount, 1u);
+    }
+
+    // The LOD distances are scaled, as if the screen got smaller
+    scene.params.lodScale = 2.f;
+    scene.Cull();
+    ASSERT_EQ(scene.GetDrawnInstances(0), (std::vector<uint32>{ 0, 1 }));
+    ASSERT_EQ(scene.commands[scene.batches[0].firstCommand + 0].indexCount +
+        scene.commands[scene.batches[0].firstCommand + 1].indexCount, 300u + 36u);
+}
+
+// Random instances against a brute force test of the bounding sphere against the clip space planes, in double
+TEST(IndirectCulling, MatchesBruteForceAndCompacts)
+{
+    Scene scene;
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<float> position(-80.f, 80.f);
+    std::uniform_real_distribution<float> scale(0.2f, 6.f);
+
+    for (uint32 i = 0; i < 20000; i++) {
+        scene.instances.push_back(MakeInstance(gen() % 2, position(gen), position(gen), position(gen) - 40.f, scale(gen)));
+    }
+
+    const uint32 visible = scene.Cull();
+    ASSERT_GT(visible, 1000u);
+    ASSERT_LT(visible, 15000u);
+
+    float viewProj[16];
+    MakeViewProj(viewProj);
+    std::vector<uint32> expected[2];
+    std::vector<uint32> borderlines;
+
+    for (uint32 i = 0; i < scene.instances.size(); i++) {
+        const GpuInstance& instance = scene.instances[i];
+        const double center[4] = { instance.model[12], instance.model[13], instance.model[14], 1.0 };
+        const double radius = instance.model[0];
+        double clip[4];
+
+        for (uint32 r = 0; r < 4; r++) {
+            clip[r] = 0.0;
+
+            for (uint32 c = 0; c < 4; c++) {
+                clip[r] += double(viewProj[c * 4 + r]) * center[c];
+            }
+        }
+
+        // Distance to each plane is the clip space inequality divided by the length of the plane's normal
+        const double rows[6][4] = {
+            { viewProj[3] + viewProj[0], viewProj[7] + viewProj[4], viewProj[11] + viewProj[8], clip[3] + clip[0] },
+            { viewProj[3] - viewProj[0], viewProj[7] - viewProj[4], viewProj[11] - viewProj[8], clip[3] - clip[0] },
+            { viewProj[3] + viewProj[1], viewProj[7] + viewProj[5], viewProj[11] + viewProj[9], clip[3] + clip[1] },
+            { viewProj[3] - viewProj[1], viewProj[7] - viewProj[5], viewProj[11] - viewProj[9], clip[3] - clip[1] },
+            { viewProj[2], viewProj[6], viewProj[10], clip[2] },
+            { viewProj[3] - viewProj[2], viewProj[7] - viewProj[6], viewProj[11] - viewProj[10], clip[3] - clip[2] },
+        };
+
+        bool inside = true;
+        bool borderline = false;
+
+        for (const double* row : rows) {
+            const double distance = row[3] / sqrt(row[0] * row[0] + row[1] * row[1] + row[2] * row[2]);
+            inside &= distance >= -radius;
+            borderline |= fabs(distance + radius) < 1e-3;
+        }
+
+        const double length = sqrt(center[0] * center[0] + center[1] * center[1] + center[2] * center[2]);
+        const uint32 mesh = instance.mesh;
+        inside &= mesh == 1 || length <= 60.0;
+        borderline |= mesh == 0 && fabs(length - 60.0) < 1e-3;
+
+        // Too close to call in float, they may go either way
+        if (borderline) {
+            borderlines.push_back(i);
+        } else if (inside) {
+            expected[scene.meshes[mesh].batch].push_back(i);
+        }
+    }
+
+    for (uint32 batch = 0; batch < 2; batch++) {
+        std::vector<uint32> drawn = scene.GetDrawnInstances(batch);
+        drawn.erase(std::remove_if(drawn.begin(), drawn.end(), [&](uint32 i) {
+            return std::binary_search(borderlines.begin(), borderlines.end(), i);
+        }), drawn.end());
+        ASSERT_EQ(drawn, expected[batch]);
+
+        // Each batch's commands are packed at the start of its region
+        const GpuBatch& region = scene.batches[batch];
+        ASSERT_LE(scene.counts[batch], region.maxCommands);
+
+        for (uint32 i = scene.counts[batch]; i < region.maxCommands; i++) {
+            ASSERT_EQ(scene.commands[region.firstCommand + i].instanceCount, 0u);
+        }
+    }
+
+    ASSERT_EQ(scene.batches[0].maxCommands + scene.batches[1].maxCommands, 20000u);
+    ASSERT_EQ(scene.batches[1].firstCommand, scene.batches[0].maxCommands);
+}
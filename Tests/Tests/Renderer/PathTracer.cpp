@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include <Renderer/Backend/PathTracer/PathTracer.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+namespace
+{
+    struct TestVertex
+    {
+        float pos[3];
+        float color[3];
+        float tex[2];
+        float normal[3];
+    };
+
+    // Unit quad in the XZ plane facing +Y, the layout of the samples' vertices
+    const TestVertex QUAD[4] = {
+        { { -1.f, 0.f, -1.f }, {}, {}, { 0.f, 1.f, 0.f } },
+        { {  1.f, 0.f, -1.f }, {}, {}, { 0.f, 1.f, 0.f } },
+        { {  1.f, 0.f,  1.f }, {}, {}, { 0.f, 1.f, 0.f } },
+        { { -1.f, 0.f,  1.f }, {}, {}, { 0.f, 1.f, 0.f } },
+    };
+    const uint32 QUAD_INDICES[6] = { 0, 2, 1, 0, 3, 2 };
+
+    RtMesh QuadMesh()
+    {
+        RtMesh mesh;
+        mesh.vertices = QUAD;
+        mesh.vertexCount = 4;
+        mesh.vertexStride = sizeof(TestVertex);
+        mesh.positionOffset = offsetof(TestVertex, pos);
+        mesh.normalOffset = offsetof(TestVertex, normal);
+        mesh.indices = QUAD_INDICES;
+        mesh.triangleCount = 2;
+        return mesh;
+    }
+
+    RtInstance Quad(uint32 material, float scale, float x, float y, float z, bool wall = false)
+    {
+        RtInstance instance;
+        instance.material = material;
+
+        // Walls are the quad turned to face +Z
+        instance.transform[0][0] = scale;
+        instance.transform[1][1] = wall ? 0.f : scale;
+        instance.transform[1][2] = wall ? -scale : 0.f;
+        instance.transform[2][1] = wall ? scale : 0.f;
+        instance.transform[2][2] = wall ? 0.f : scale;
+        instance.transform[0][3] = x;
+        instance.transform[1][3] = y;
+        instance.transform[2][3] = z;
+        return instance;
+    }
+
+    // Floor, back wall, an emissive ceiling panel and a mirror, lit by a point and a directional light
+    RtScene BoxScene()
+    {
+        RtScene scene;
+        scene.meshes.push_back(QuadMesh());
+        scene.materials.resize(4);
+        scene.materials[1].albedo[0] = 0.2f;
+        scene.materials[2].emission[0] = scene.materials[2].emission[1] = scene.materials[2].emission[2] = 4.f;
+        scene.materials[3].metallic = 1.f;
+        scene.materials[3].roughness = 0.1f;
+
+        scene.instances.push_back(Quad(0, 3.f, 0.f, 0.f, 0.f));
+        scene.instances.push_back(Quad(1, 3.f, 0.f, 3.f, -3.f, true));
+        scene.instances.push_back(Quad(2, 0.5f, 0.f, 2.9f, 0.f));
+        scene.instances.push_back(Quad(3, 0.6f, 1.f, 0.8f, -1.f, true));
+
+        RtLight point;
+        point.position[1] = 2.f;
+        point.color[0] = point.color[1] = point.color[2] = 3.f;
+        scene.lights.push_back(point);
+
+        RtLight sun;
+        sun.type = RtLight::DIRECTIONAL;
+        sun.position[0] = 0.3f;
+        sun.position[1] = -1.f;
+        sun.color[0] = sun.color[1] = sun.color[2] = 0.5f;
+        scene.lights.push_back(sun);
+
+        const float eye[3] = { 0.f, 1.5f, 5.f };
+        const float target[3] = { 0.f, 1.f, 0.f };
+        const float up[3] = { 0.f, 1.f, 0.f };
+        scene.camera = RtCamera::LookAt(eye, target, up, 1.f, 4.f / 3.f);
+        return scene;
+    }
+}
+
+// Tiles and threads only change who renders a pixel, never its value
+TEST(PathTracer, DeterministicAcrossThreadsAndTiles)
+{
+    PathTracer tracer;
+    tracer.SetScene(BoxScene());
+
+    PathTracerSettings settings;
+    settings.width = 64;
+    settings.height = 48;
+    settings.samplesPerPixel = 4;
+    settings.tileSize = 8;
+    settings.seed = 3;
+
+    std::vector<float> reference;
+    tracer.Render(settings, reference);
+
+    settings.threadCount = 4;
+    std::vector<float> threaded;
+    tracer.Render(settings, threaded);
+    ASSERT_EQ(memcmp(reference.data(), threaded.data(), reference.size() * sizeof(float)), 0);
+
+    // Two render nodes with half the tiles each
+    const uint32 tiles = tracer.GetTileCount(settings);
+    ASSERT_EQ(tiles, 48u);
+    std::vector<float> merged;
+    settings.tileCount = tiles / 2;
+    tracer.Render(settings, merged);
+    settings.firstTile = tiles / 2;
+    settings.tileCount = 0;
+    tracer.Render(settings, merged);
+    ASSERT_EQ(memcmp(reference.data(), merged.data(), reference.size() * sizeof(float)), 0);
+
+    // Something got lit, nothing blew up
+    float total = 0.f;
+
+    for (float value : reference) {
+        ASSERT_TRUE(isfinite(value));
+        ASSERT_GE(value, 0.f);
+        total += value;
+    }
+
+    ASSERT_GT(total, 0.f);
+
+    // Another seed is another image
+    settings.firstTile = 0;
+    settings.seed = 4;
+    std::vector<float> reseeded;
+    tracer.Render(settings, reseeded);
+    ASSERT_NE(memcmp(reference.data(), reseeded.data(), reference.size() * sizeof(float)), 0);
+}
+
+// The output of raytrace.rchit and raytrace.rmiss
+TEST(PathTracer, BarycentricsLikeTheRtShaders)
+{
+    RtScene scene;
+    scene.meshes.push_back(QuadMesh());
+    scene.instances.push_back(RtInstance());
+    const float eye[3] = { 0.f, 3.f, 0.f };
+    const float target[3] = { 0.f, 0.f, 0.f };
+    const float up[3] = { 0.f, 0.f, -1.f };
+    scene.camera = RtCamera::LookAt(eye, target, up, 1.2f, 2.f);
+
+    PathTracer tracer;
+    tracer.SetScene(scene);
+
+    PathTracerSettings settings;
+    settings.width = 32;
+    settings.height = 16;
+    settings.mode = PathTracerMode::BARYCENTRICS;
+    std::vector<float> image;
+    tracer.Render(settings, image);
+
+    // The quad covers the middle, the sides miss
+    const float* center = &image[(8 * 32 + 16) * 3];
+    ASSERT_NEAR(center[0] + center[1] + center[2], 1.f, 1e-5f);
+    ASSERT_GE(center[0], 0.f);
+    ASSERT_GE(center[1], 0.f);
+    ASSERT_GE(center[2], 0.f);
+
+    const float* side = &image[(8 * 32) * 3];
+    ASSERT_EQ(side[0], 0.f);
+    ASSERT_EQ(side[1], 0.1f);
+    ASSERT_EQ(side[2], 0.3f);
+}
+
+// Direct lighting of a diffuse floor under a point light: albedo / PI * I * cos / r^2
+TEST(PathTracer, DirectLightingMatchesAnalytic)
+{
+    RtScene scene;
+    scene.meshes.push_back(QuadMesh());
+    scene.materials.resize(1);
+    scene.materials[0].albedo[0] = scene.materials[0].albedo[1] = scene.materials[0].albedo[2] = 0.5f;
+    scene.instances.push_back(Quad(0, 10.f, 0.f, 0.f, 0.f));
+
+    RtLight light;
+    light.position[0] = 1.f;
+    light.position[1] = 2.f;
+    light.color[0] = light.color[1] = light.color[2] = 4.f;
+    scene.lights.push_back(light);
+
+    const float eye[3] = { 0.f, 1.f, 0.f };
+    const float target[3] = { 0.f, 0.f, 0.f };
+    const float up[3] = { 0.f, 0.f, -1.f };
+    scene.camera = RtCamera::LookAt(eye, target, up, 0.01f, 1.f);
+
+    PathTracer tracer;
+    tracer.SetScene(scene);
+
+    PathTracerSettings settings;
+    settings.width = settings.height = 4;
+    settings.maxBounces = 1;
+    settings.samplesPerPixel = 8;
+    std::vector<float> image;
+    tracer.Render(settings, image);
+
+    // Light at distance sqrt(5), 2 / sqrt(5) above the horizon of the origin
+    const float expected = 0.5f / 3.14159265f * 4.f * (2.f / sqrtf(5.f)) / 5.f;
+
+    for (float value : image) {
+        ASSERT_NEAR(value, expected, expected * 0.01f);
+    }
+
+    // Reference images go through PFM files
+    const char* path = "PathTracerTest.pfm";
+    ASSERT_TRUE(PathTracer::SavePfm(path, image.data(), settings.width, settings.height));
+    std::vector<float> loaded;
+    uint32 width, height;
+    ASSERT_TRUE(PathTracer::LoadPfm(path, loaded, width, height));
+    remove(path);
+    ASSERT_EQ(width, 4u);
+    ASSERT_EQ(height, 4u);
+    ASSERT_EQ(loaded, image);
+}
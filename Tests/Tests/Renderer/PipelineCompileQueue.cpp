@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <algorithm>
+#include <map>
+#include <Renderer/Backend/RHI/Pipeline/PipelineAllocator/PipelineCompileQueue.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+TEST(PipelineCompileQueue, CompilesOnWorkersOnce)
+{
+    PipelineCompileQueue<uint64> queue;
+
+    // Nothing runs before Init, the caller keeps what it has
+    ASSERT_FALSE(queue.Submit(1, []() { return (uint64)1; }));
+
+    // The pool's workers are shared, the queue takes what it asks for when there are that many
+    queue.Init(3);
+    ASSERT_EQ(queue.GetWorkerCount(), std::min(3u, WorkerPool::Instance().GetWorkerCount()));
+
+    std::atomic<uint32> runs{ 0 };
+
+    for (uint64 key = 0; key < 64; key++) {
+        ASSERT_TRUE(queue.Submit(key, [key, &runs]() { runs++; return key * 3; }));
+    }
+
+    // A key in flight isn't compiled twice
+    ASSERT_FALSE(queue.Submit(5, []() { return (uint64)0; }));
+
+    queue.WaitIdle();
+    ASSERT_EQ(queue.GetPendingCount(), 0u);
+
+    std::map<uint64, uint64> results;
+    const uint32 count = queue.Collect([&results](uint64 key, uint64 result) { results[key] = result; });
+
+    ASSERT_EQ(count, 64u);
+    ASSERT_EQ(runs.load(), 64u);
+    ASSERT_EQ(results.size(), 64u);
+
+    for (const auto& result : results) {
+        ASSERT_EQ(result.second, result.first * 3);
+    }
+
+    // Collected keys can come back, once their result was swapped in
+    ASSERT_EQ(queue.Collect([](uint64, uint64) {}), 0u);
+    ASSERT_TRUE(queue.Submit(5, []() { return (uint64)7; }));
+
+    queue.Shutdown();
+}
+
+TEST(PipelineCompileQueue, ShutdownDropsQueuedJobs)
+{
+    PipelineCompileQueue<uint32> queue;
+    queue.Init(1);
+
+    std::atomic<bool> started{ false };
+    std::atomic<bool> released{ false };
+
+    // The worker is held on the first job, the rest stay queued
+    ASSERT_TRUE(queue.Submit(0, [&started, &released]() {
+        started = true;
+
+        while (!released) {
+            std::this_thread::yield();
+        }
+
+        return 10u;
+    }));
+
+    for (uint32 key = 1; key < 8; key++) {
+        ASSERT_TRUE(queue.Submit(key, [key]() { return key; }));
+    }
+
+    ASSERT_EQ(queue.GetPendingCount(), 8u);
+
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    std::thread release([&released]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        released = true;
+    });
+
+    queue.Shutdown();
+    release.join();
+
+    // What was running finished and is still handed over, so whatever it created can be released
+    uint32 collected = 0;
+    queue.Collect([&collected](uint64 key, uint32 result) {
+        ASSERT_EQ(key, 0u);
+        ASSERT_EQ(result, 10u);
+        collected++;
+    });
+
+    ASSERT_EQ(collected, 1u);
+    ASSERT_EQ(queue.GetPendingCount(), 0u);
+    ASSERT_FALSE(queue.Submit(1, []() { return 1u; }));
+}
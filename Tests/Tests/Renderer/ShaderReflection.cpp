@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <Renderer/Backend/RHI/ShaderProgram/ShaderReflection/ShaderReflection.hpp>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+// Raw Vulkan values, the reflection header purposely doesn't include vulkan.h
+constexpr uint32 STAGE_VERTEX = 0x1;
+constexpr uint32 STAGE_FRAGMENT = 0x10;
+constexpr uint32 STAGE_COMPUTE = 0x20;
+constexpr uint32 STAGE_RAYGEN = 0x100;
+constexpr uint32 DESCRIPTOR_COMBINED_IMAGE_SAMPLER = 1;
+constexpr uint32 DESCRIPTOR_STORAGE_IMAGE = 3;
+constexpr uint32 DESCRIPTOR_UNIFORM_BUFFER = 6;
+constexpr uint32 DESCRIPTOR_STORAGE_BUFFER = 7;
+constexpr uint32 DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC = 8;
+constexpr uint32 DESCRIPTOR_ACCELERATION_STRUCTURE = 1000150000;
+constexpr uint32 FORMAT_R32G32_SFLOAT = 103;
+constexpr uint32 FORMAT_R32G32B32_SFLOAT = 106;
+
+static const char* SHADERS[] = {
+    "vert.spv", "frag.spv", "Post/post.vert.spv", "Post/post.frag.spv", "RT/rgen.spv", "RT/rchit.spv", "RT/rmiss.spv", "Cull/cull.comp.spv"
+};
+
+// Cull/cull.comp.spv is built by the Renderer (RendererShaders) or its compile.bat instead of being checked in,
+// tests built without the Renderer skip it when it isn't there
+static bool IsShaderBuilt(const char* name)
+{
+#if defined(TRE_RENDERER_SHADERS)
+    (void)name;
+    return true;
+#else
+    MappedFile shader;
+    return shader.Open((std::string(TRE_SHADERS_DIR) + "/" + name).c_str());
+#endif
+}
+
+static bool ReflectShader(const char* name, ShaderReflection& reflection, MappedFile* file = NULL)
+{
+    MappedFile local;
+    MappedFile& shader = file ? *file : local;
+    const std::string path = std::string(TRE_SHADERS_DIR) + "/" + name;
+
+    if (!shader.Open(path.c_str()))
+        return false;
+
+    return reflection.Reflect(shader.Data(), shader.Size());
+}
+
+static const ShaderReflection::InputAttribute* FindInput(const ShaderReflection& reflection, uint32 location)
+{
+    for (const auto& input : reflection.inputs) {
+        if (input.location == location)
+            return &input;
+    }
+
+    return NULL;
+}
+
+TEST(ShaderReflection, VertexShader)
+{
+    ShaderReflection reflection;
+    ASSERT_TRUE(ReflectShader("vert.spv", reflection));
+
+    EXPECT_EQ(reflection.stage, STAGE_VERTEX);
+    ASSERT_EQ(reflection.inputs.size(), 3);
+    ASSERT_NE(FindInput(reflection, 0), nullptr);
+    ASSERT_NE(FindInput(reflection, 1), nullptr);
+    ASSERT_NE(FindInput(reflection, 2), nullptr);
+    EXPECT_EQ(FindInput(reflection, 0)->format, FORMAT_R32G32B32_SFLOAT);
+    EXPECT_EQ(FindInput(reflection, 1)->format, FORMAT_R32G32B32_SFLOAT);
+    EXPECT_EQ(FindInput(reflection, 2)->format, FORMAT_R32G32_SFLOAT);
+
+    // The MVP block is prefixed with DYNC_ and must become a dynamic uniform buffer
+    ASSERT_EQ(reflection.descriptorSets.size(), 1);
+    EXPECT_EQ(reflection.descriptorSets[0], 0);
+    ASSERT_EQ(reflection.bindings.size(), 1);
+    EXPECT_EQ(reflection.bindings[0].set, 0);
+    EXPECT_EQ(reflection.bindings[0].binding, 0);
+    EXPECT_EQ(reflection.bindings[0].count, 1);
+    EXPECT_EQ(reflection.bindings[0].descriptorType, DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC);
+    EXPECT_TRUE(reflection.pushConstants.empty());
+}
+
+TEST(ShaderReflection, FragmentShader)
+{
+    ShaderReflection reflection;
+    ASSERT_TRUE(ReflectShader("Post/post.frag.spv", reflection));
+
+    EXPECT_EQ(reflection.stage, STAGE_FRAGMENT);
+    ASSERT_EQ(reflection.bindings.size(), 1);
+    EXPECT_EQ(reflection.bindings[0].set, 0);
+    EXPECT_EQ(reflection.bindings[0].binding, 0);
+    EXPECT_EQ(reflection.bindings[0].descriptorType, DESCRIPTOR_COMBINED_IMAGE_SAMPLER);
+}
+
+TEST(ShaderReflection, BuiltinsAreNotInputs)
+{
+    ShaderReflection reflection;
+    ASSERT_TRUE(ReflectShader("Post/post.vert.spv", reflection));
+
+    EXPECT_EQ(reflection.stage, STAGE_VERTEX);
+    EXPECT_TRUE(reflection.inputs.empty());
+    EXPECT_TRUE(reflection.bindings.empty());
+}
+
+TEST(ShaderReflection, RayGenShader)
+{
+    ShaderReflection reflection;
+    ASSERT_TRUE(ReflectShader("RT/rgen.spv", reflection));
+
+    EXPECT_EQ(reflection.stage, STAGE_RAYGEN);
+    EXPECT_TRUE(reflection.inputs.empty());
+    ASSERT_EQ(reflection.bindings.size(), 3);
+
+    uint32 types[3] = {};
+
+    for (const auto& binding : reflection.bindings) {
+        ASSERT_EQ(binding.set, 0);
+        ASSERT_LT(binding.binding, 3);
+        types[binding.binding] = binding.descriptorType;
+    }
+
+    EXPECT_EQ(types[0], DESCRIPTOR_ACCELERATION_STRUCTURE);
+    EXPECT_EQ(types[1], DESCRIPTOR_STORAGE_IMAGE);
+    EXPECT_EQ(types[2], DESCRIPTOR_UNIFORM_BUFFER);
+}
+
+TEST(ShaderReflection, ComputeShader)
+{
+    if (!IsShaderBuilt("Cull/cull.comp.spv"))
+        GTEST_SKIP() << "Cull/cull.comp.spv isn't built, glslc wasn't found";
+
+    ShaderReflection reflection;
+    ASSERT_TRUE(ReflectShader("Cull/cull.comp.spv", reflection));
+
+    // The bindings IndirectScene::Cull writes: instances, meshes, lods, batches, commands and counts
+    EXPECT_EQ(reflection.stage, STAGE_COMPUTE);
+    EXPECT_TRUE(reflection.inputs.empty());
+    ASSERT_EQ(reflection.bindings.size(), 6);
+
+    bool seen[6] = {};
+
+    for (const auto& binding : reflection.bindings) {
+        ASSERT_EQ(binding.set, 0);
+        ASSERT_LT(binding.binding, 6);
+        EXPECT_EQ(binding.count, 1);
+        EXPECT_EQ(binding.descriptorType, DESCRIPTOR_STORAGE_BUFFER);
+        seen[binding.binding] = true;
+    }
+
+    for (bool binding : seen) {
+        EXPECT_TRUE(binding);
+    }
+
+    // GpuCullParams, instanceCount is the last member the shader reads
+    ASSERT_EQ(reflection.pushConstants.size(), 1);
+    EXPECT_EQ(reflection.pushConstants[0].offset, 0);
+    EXPECT_GE(reflection.pushConstants[0].size, 116);
+    EXPECT_LE(reflection.pushConstants[0].size, 128);
+}
+
+TEST(ShaderReflection, InvalidCode)
+{
+    const uint32 garbage[] = { 0xDEADBEEF, 1, 2, 3, 4, 5 };
+    ShaderReflection reflection;
+    EXPECT_FALSE(reflection.Reflect(garbage, sizeof(garbage)));
+}
+
+TEST(ShaderReflection, SerializeRoundTrip)
+{
+    for (const char* name : SHADERS) {
+        if (!IsShaderBuilt(name))
+            continue;
+
+        SCOPED_TRACE(name);
+        ShaderReflection reflection, loaded;
+        ASSERT_TRUE(ReflectShader(name, reflection));
+
+        // Only the culling shader has push constants, exercise them on every shader anyway
+        reflection.pushConstants.push_back({ "PushConstants", 16, 64 });
+
+        std::vector<uint8> blob;
+        reflection.Serialize(blob);
+        const uint8* cursor = blob.data();
+        ASSERT_TRUE(loaded.Deserialize(cursor, blob.data() + blob.size()));
+        EXPECT_EQ(cursor, blob.data() + blob.size());
+
+        EXPECT_EQ(loaded.stage, reflection.stage);
+        EXPECT_EQ(loaded.descriptorSets, reflection.descriptorSets);
+        ASSERT_EQ(loaded.bindings.size(), reflection.bindings.size());
+        ASSERT_EQ(loaded.inputs.size(), reflection.inputs.size());
+        ASSERT_EQ(loaded.pushConstants.size(), reflection.pushConstants.size());
+        EXPECT_EQ(loaded.pushConstants.back().typeName, "PushConstants");
+        EXPECT_EQ(loaded.pushConstants.back().offset, 16);
+        EXPECT_EQ(loaded.pushConstants.back().size, 64);
+
+        for (usize i = 0; i < loaded.pushConstants.size(); i++) {
+            EXPECT_EQ(loaded.pushConstants[i].typeName, reflection.pushConstants[i].typeName);
+            EXPECT_EQ(loaded.pushConstants[i].offset, reflection.pushConstants[i].offset);
+            EXPECT_EQ(loaded.pushConstants[i].size, reflection.pushConstants[i].size);
+        }
+
+        for (usize i = 0; i < loaded.bindings.size(); i++) {
+            EXPECT_EQ(loaded.bindings[i].set, reflection.bindings[i].set);
+            EXPECT_EQ(loaded.bindings[i].binding, reflection.bindings[i].binding);
+            EXPECT_EQ(loaded.bindings[i].count, reflection.bindings[i].count);
+            EXPECT_EQ(loaded.bindings[i].descriptorType, reflection.bindings[i].descriptorType);
+        }
+
+        for (usize i = 0; i < loaded.inputs.size(); i++) {
+            EXPECT_EQ(loaded.inputs[i].location, reflection.inputs[i].location);
+            EXPECT_EQ(loaded.inputs[i].format, reflection.inputs[i].format);
+        }
+
+        // Every truncation of the blob has to be rejected without reading out of bounds
+        for (usize size = 0; size < blob.size(); size++) {
+            const uint8* truncated = blob.data();
+            EXPECT_FALSE(loaded.Deserialize(truncated, blob.data() + size));
+        }
+    }
+}
+
+TEST(ShaderReflection, ContentHash)
+{
+    std::vector<uint64> hashes;
+
+    for (const char* name : SHADERS) {
+        if (!IsShaderBuilt(name))
+            continue;
+
+        SCOPED_TRACE(name);
+        MappedFile file;
+        ShaderReflection reflection;
+        ASSERT_TRUE(ReflectShader(name, reflection, &file));
+
+        const uint64 hash = ShaderReflection::HashCode(file.Data(), file.Size());
+        EXPECT_EQ(hash, ShaderReflection::HashCode(file.Data(), file.Size()));
+
+        for (uint64 other : hashes) {
+            EXPECT_NE(hash, other);
+        }
+
+        hashes.push_back(hash);
+
+        // A single flipped word changes the hash
+        std::vector<uint8> copy(file.Data(), file.Data() + file.Size());
+        copy[copy.size() / 2] ^= 1;
+        EXPECT_NE(hash, ShaderReflection::HashCode(copy.data(), copy.size()));
+    }
+}
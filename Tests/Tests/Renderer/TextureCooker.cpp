@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string.h>
+#include <vector>
+#include <Renderer/Backend/Texture/BCn/BCn.hpp>
+#include <Renderer/Backend/Texture/KTX2/KTX2.hpp>
+#include <Renderer/Backend/Texture/TextureCooker/TextureCooker.hpp>
+#include <Renderer/Backend/Misc/stb_image.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+static TextureImage MakeGradient(uint32 width, uint32 height)
+{
+    TextureImage image;
+    image.Resize(width, height);
+
+    for (uint32 y = 0; y < height; y++) {
+        for (uint32 x = 0; x < width; x++) {
+            uint8* texel = image.pixels.data() + (y * width + x) * 4;
+            texel[0] = uint8(x * 255 / (width - 1));
+            texel[1] = uint8(y * 255 / (height - 1));
+            texel[2] = uint8((x + y) * 255 / (width + height - 2));
+            texel[3] = uint8(255 - x * 255 / (width - 1));
+        }
+    }
+
+    return image;
+}
+
+// Smooth image with a bit of noise, closer to photographic content than a pure gradient
+static TextureImage MakeNoisyGradient(uint32 width, uint32 height, uint32 seed)
+{
+    TextureImage image = MakeGradient(width, height);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int32> noise(-6, 6);
+
+    for (uint8& value : image.pixels) {
+        const int32 noisy = int32(value) + noise(rng);
+        value = uint8(MIN(MAX(noisy, 0), 255));
+    }
+
+    return image;
+}
+
+static TextureImage MakeOpaque(TextureImage image)
+{
+    for (usize i = 3; i < image.pixels.size(); i += 4) {
+        image.pixels[i] = 255;
+    }
+
+    return image;
+}
+
+static double RoundTripPSNR(const TextureImage& image, TextureFormat format, uint32 channelMask)
+{
+    std::vector<uint8> blocks;
+    TextureImage decoded;
+    EXPECT_TRUE(BCn::CompressImage(image, format, blocks));
+    EXPECT_EQ(blocks.size(), GetTextureLevelSize(format, image.width, image.height));
+    EXPECT_TRUE(BCn::DecompressImage(blocks.data(), image.width, image.height, format, decoded));
+    return BCn::ComputePSNR(image, decoded, channelMask);
+}
+
+TEST(TextureCooker, SrgbRoundTrip)
+{
+    for (uint32 i = 0; i < 256; i++) {
+        ASSERT_EQ(Srgb::FromLinear(Srgb::ToLinear(uint8(i))), i);
+    }
+
+    ASSERT_EQ(Srgb::FromLinear(-1.f), 0);
+    ASSERT_EQ(Srgb::FromLinear(2.f), 255);
+}
+
+TEST(TextureCooker, MipChainLevels)
+{
+    const TextureImage image = MakeGradient(100, 37);
+    std::vector<TextureImage> levels;
+    MipChainOptions options;
+    GenerateMipChain(image.pixels.data(), image.width, image.height, options, levels);
+
+    ASSERT_EQ(levels.size(), GetMipLevelCount(100, 37));
+    ASSERT_EQ(levels.size(), 7u);
+    ASSERT_EQ(levels[0].pixels, image.pixels);
+
+    for (uint32 i = 1; i < levels.size(); i++) {
+        ASSERT_EQ(levels[i].width, MAX(100u >> i, 1u));
+        ASSERT_EQ(levels[i].height, MAX(37u >> i, 1u));
+        ASSERT_EQ(levels[i].pixels.size(), levels[i].width * levels[i].height * 4);
+    }
+
+    options.maxLevels = 3;
+    GenerateMipChain(image.pixels.data(), image.width, image.height, options, levels);
+    ASSERT_EQ(levels.size(), 3u);
+}
+
+TEST(TextureCooker, MipFilters)
+{
+    // Black and white checkerboard: averages to 0.5 in linear space, which is 188 in sRGB
+    TextureImage checker;
+    checker.Resize(64, 64);
+
+    for (uint32 i = 0; i < 64 * 64; i++) {
+        const uint8 v = ((i % 64) + (i / 64)) & 1 ? 255 : 0;
+        memset(checker.pixels.data() + i * 4, v, 3);
+        checker.pixels[i * 4 + 3] = 255;
+    }
+
+    TextureImage box, boxSrgb, kaiser;
+    DownsampleBox(checker, box, false);
+    DownsampleBox(checker, boxSrgb, true);
+    DownsampleKaiser(checker, kaiser, true);
+
+    ASSERT_EQ(box.width, 32u);
+    ASSERT_EQ(box.height, 32u);
+
+    for (uint32 i = 0; i < 32 * 32; i++) {
+        ASSERT_EQ(box.pixels[i * 4], 128);
+        ASSERT_EQ(boxSrgb.pixels[i * 4], Srgb::FromLinear(0.5f));
+        ASSERT_EQ(boxSrgb.pixels[i * 4 + 3], 255);
+    }
+
+    // The clamped taps make the borders drift, the interior sees the exact alternating pattern
+    for (uint32 y = 3; y < 29; y++) {
+        for (uint32 x = 3; x < 29; x++) {
+            ASSERT_NEAR(kaiser.pixels[(y * 32 + x) * 4], Srgb::FromLinear(0.5f), 1);
+        }
+    }
+
+    // Odd sizes: the SIMD path and the scalar tail must agree with the reference 2x2 average
+    const TextureImage image = MakeNoisyGradient(37, 21, 7);
+    DownsampleBox(image, box, false);
+
+    for (uint32 y = 0; y < box.height; y++) {
+        for (uint32 x = 0; x < box.width; x++) {
+            for (uint32 c = 0; c < 4; c++) {
+                const uint8* p = image.pixels.data();
+                const uint32 sum = p[((2 * y) * 37 + 2 * x) * 4 + c] + p[((2 * y) * 37 + 2 * x + 1) * 4 + c] +
+                    p[((2 * y + 1) * 37 + 2 * x) * 4 + c] + p[((2 * y + 1) * 37 + 2 * x + 1) * 4 + c];
+                ASSERT_EQ(box.pixels[(y * box.width + x) * 4 + c], (sum + 2) / 4);
+            }
+        }
+    }
+}
+
+TEST(TextureCooker, BlockCompressionQuality)
+{
+    const TextureImage gradient = MakeNoisyGradient(128, 128, 1);
+    const TextureImage opaque = MakeOpaque(gradient);
+
+    const double bc1 = RoundTripPSNR(opaque, TextureFormat::BC1_RGBA_UNORM, 0x7);
+    const double bc3Color = RoundTripPSNR(gradient, TextureFormat::BC3_UNORM, 0x7);
+    const double bc3Alpha = RoundTripPSNR(gradient, TextureFormat::BC3_UNORM, 0x8);
+    const double bc4 = RoundTripPSNR(gradient, TextureFormat::BC4_UNORM, 0x1);
+    const double bc5 = RoundTripPSNR(gradient, TextureFormat::BC5_UNORM, 0x3);
+    const double bc7 = RoundTripPSNR(gradient, TextureFormat::BC7_UNORM, 0xF);
+
+    EXPECT_GT(bc1, 35.0);
+    EXPECT_GT(bc3Color, 35.0);
+    EXPECT_GT(bc3Alpha, 45.0);
+    EXPECT_GT(bc4, 45.0);
+    EXPECT_GT(bc5, 45.0);
+    EXPECT_GT(bc7, 36.0);
+    EXPECT_GT(RoundTripPSNR(opaque, TextureFormat::BC7_UNORM, 0x7), bc1);
+
+    // Partial blocks on the edges, the steeper gradient costs a few dB to single subset endpoints
+    const TextureImage odd = MakeNoisyGradient(30, 18, 2);
+    const double oddBc7 = RoundTripPSNR(odd, TextureFormat::BC7_UNORM, 0xF);
+    const double oddBc1 = RoundTripPSNR(MakeOpaque(odd), TextureFormat::BC1_RGBA_UNORM, 0x7);
+    EXPECT_GT(oddBc7, 28.0);
+    EXPECT_GT(oddBc1, 28.0);
+}
+
+TEST(TextureCooker, SolidBlocks)
+{
+    uint8 texels[64], decoded[64], block[16];
+
+    for (uint32 i = 0; i < 16; i++) {
+        texels[i * 4 + 0] = 200;
+        texels[i * 4 + 1] = 17;
+        texels[i * 4 + 2] = 96;
+        texels[i * 4 + 3] = 255;
+    }
+
+    BCn::EncodeBC7Block(texels, block);
+    ASSERT_TRUE(BCn::DecodeBC7Block(block, decoded));
+
+    for (uint32 i = 0; i < 64; i++) {
+        ASSERT_NEAR(decoded[i], texels[i], 1);
+    }
+
+    BCn::EncodeBC1Block(texels, block);
+    BCn::DecodeBC1Block(block, decoded);
+
+    for (uint32 i = 0; i < 16; i++) {
+        ASSERT_NEAR(decoded[i * 4 + 0], 200, 4);
+        ASSERT_NEAR(decoded[i * 4 + 1], 17, 2);
+        ASSERT_NEAR(decoded[i * 4 + 2], 96, 4);
+        ASSERT_EQ(decoded[i * 4 + 3], 255);
+    }
+
+    // Values covering 0 and 255 pick the 6 value BC4 mode which represents both exactly
+    uint8 values[16];
+
+    for (uint32 i = 0; i < 16; i++) {
+        values[i] = i < 4 ? 0 : (i < 8 ? 255 : uint8(100 + i));
+    }
+
+    uint8 decodedValues[16];
+    BCn::EncodeBC4Block(values, 1, block);
+    BCn::DecodeBC4Block(block, decodedValues, 1);
+    ASSERT_LE(block[0], block[1]);
+
+    for (uint32 i = 0; i < 16; i++) {
+        ASSERT_NEAR(decodedValues[i], values[i], i < 8 ? 0 : 2);
+    }
+}
+
+TEST(TextureCooker, BC1Transparency)
+{
+    uint8 texels[64], decoded[64], block[8];
+
+    for (uint32 i = 0; i < 16; i++) {
+        texels[i * 4 + 0] = uint8(i * 16);
+        texels[i * 4 + 1] = uint8(255 - i * 16);
+        texels[i * 4 + 2] = 40;
+        texels[i * 4 + 3] = (i & 3) == 0 ? 0 : 255;
+    }
+
+    BCn::EncodeBC1Block(texels, block);
+    BCn::DecodeBC1Block(block, decoded);
+
+    for (uint32 i = 0; i < 16; i++) {
+        ASSERT_EQ(decoded[i * 4 + 3], texels[i * 4 + 3]);
+    }
+
+    // Without transparency the 4 color mode is always used, as BC3 decoders expect
+    BCn::EncodeBC1Block(texels, block, false);
+    ASSERT_GE(block[0] | (block[1] << 8), block[2] | (block[3] << 8));
+}
+
+static bool XorCompress(const uint8* src, usize size, std::vector<uint8>& out)
+{
+    out.resize(size + 1);
+    out[0] = 0x5A;
+
+    for (usize i = 0; i < size; i++) {
+        out[i + 1] = src[i] ^ 0x5A;
+    }
+
+    return true;
+}
+
+static bool XorDecompress(const uint8* src, usize size, usize uncompressedSize, std::vector<uint8>& out)
+{
+    if (size != uncompressedSize + 1 || src[0] != 0x5A)
+        return false;
+
+    out.resize(uncompressedSize);
+
+    for (usize i = 0; i < uncompressedSize; i++) {
+        out[i] = src[i + 1] ^ 0x5A;
+    }
+
+    return true;
+}
+
+TEST(TextureCooker, KTX2RoundTrip)
+{
+    const TextureImage image = MakeNoisyGradient(64, 40, 3);
+    TextureCookOptions options;
+    options.format = TextureFormat::BC7_SRGB;
+
+    CookedTexture cooked;
+    ASSERT_TRUE(TextureCooker::CookTexture(image.pixels.data(), image.width, image.height, options, cooked));
+    ASSERT_EQ(cooked.levels.size(), 7u);
+
+    for (uint32 i = 0; i < cooked.levels.size(); i++) {
+        ASSERT_EQ(cooked.levels[i].size, GetTextureLevelSize(cooked.format, cooked.GetLevelWidth(i), cooked.GetLevelHeight(i)));
+    }
+
+    std::vector<uint8> file;
+    ASSERT_TRUE(KTX2::Write(cooked, file));
+    ASSERT_EQ(memcmp(file.data(), KTX2::IDENTIFIER, sizeof(KTX2::IDENTIFIER)), 0);
+
+    // Levels are stored smallest first and aligned to the block size
+    uint64 previousOffset = ~0ull;
+
+    for (uint32 i = 0; i < cooked.levels.size(); i++) {
+        uint64 offset;
+        memcpy(&offset, file.data() + 80 + i * 24, sizeof(offset));
+        ASSERT_EQ(offset % 16, 0u);
+        ASSERT_LT(offset, previousOffset);
+        previousOffset = offset;
+    }
+
+    CookedTexture loaded;
+    ASSERT_TRUE(KTX2::Read(file.data(), file.size(), loaded));
+    ASSERT_EQ(loaded.format, cooked.format);
+    ASSERT_EQ(loaded.width, cooked.width);
+    ASSERT_EQ(loaded.height, cooked.height);
+    ASSERT_EQ(loaded.levels.size(), cooked.levels.size());
+    ASSERT_EQ(loaded.data, cooked.data);
+
+    ASSERT_FALSE(KTX2::Read(file.data(), file.size() - 1, loaded));
+    ASSERT_FALSE(KTX2::Read(file.data(), 40, loaded));
+
+    const KTX2::SupercompressionCodec codec = { KTX2::Supercompression::ZSTD, XorCompress, XorDecompress };
+    ASSERT_TRUE(KTX2::Write(cooked, file, &codec));
+    ASSERT_FALSE(KTX2::Read(file.data(), file.size(), loaded)); // No codec
+    ASSERT_TRUE(KTX2::Read(file.data(), file.size(), loaded, &codec));
+    ASSERT_EQ(loaded.data, cooked.data);
+}
+
+TEST(TextureCooker, CookFromFile)
+{
+    const char* path = TRE_ASSETS_DIR "/box1.jpg";
+
+    TextureCookOptions options;
+    options.format = TextureFormat::BC1_RGBA_SRGB;
+    CookedTexture cooked;
+    ASSERT_TRUE(TextureCooker::CookTextureFile(path, options, cooked));
+    ASSERT_EQ(cooked.levels.size(), GetMipLevelCount(cooked.width, cooked.height));
+
+    int32 width, height, channels;
+    stbi_uc* pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
+    ASSERT_NE(pixels, nullptr);
+    ASSERT_EQ(cooked.width, (uint32)width);
+    ASSERT_EQ(cooked.height, (uint32)height);
+
+    TextureImage source, decoded;
+    source.Resize(width, height);
+    memcpy(source.pixels.data(), pixels, source.pixels.size());
+    stbi_image_free(pixels);
+
+    ASSERT_TRUE(BCn::DecompressImage(cooked.GetLevelData(0), cooked.width, cooked.height, cooked.format, decoded));
+    EXPECT_GT(BCn::ComputePSNR(source, decoded, 0x7), 30.0);
+}
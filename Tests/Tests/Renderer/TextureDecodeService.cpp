@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string.h>
+#include <vector>
+#include <Renderer/Backend/Texture/TextureDecodeService/TextureDecodeService.hpp>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+#include <Renderer/Backend/Misc/stb_image.hpp>
+#include <Legacy/FileSystem/MappedFile/MappedFile.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+static const char* TEXTURE_PATH = TRE_ASSETS_DIR "/box1.jpg";
+
+// Reference encoder: the code whose decoded value is the closest, ties going up
+static uint8 FromLinearReference(float value)
+{
+    uint32 best = 0;
+
+    for (uint32 i = 1; i < 256; i++) {
+        if (fabsf(Srgb::ToLinear(uint8(i)) - value) <= fabsf(Srgb::ToLinear(uint8(best)) - value)) {
+            best = i;
+        }
+    }
+
+    return uint8(best);
+}
+
+TEST(TextureDecodeService, SrgbEncodeIsExact)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+    for (uint32 i = 0; i < 20000; i++) {
+        // Half of the samples in the linear toe where codes are the densest
+        const float value = i & 1 ? uniform(rng) : uniform(rng) * 0.01f;
+        ASSERT_EQ(Srgb::FromLinear(value), FromLinearReference(value)) << value;
+    }
+
+    // Both sides of every threshold
+    for (uint32 i = 0; i < 255; i++) {
+        const float threshold = (Srgb::ToLinear(uint8(i)) + Srgb::ToLinear(uint8(i + 1))) * 0.5f;
+        ASSERT_EQ(Srgb::FromLinear(nextafterf(threshold, 0.f)), i);
+        ASSERT_EQ(Srgb::FromLinear(nextafterf(threshold, 2.f)), i + 1);
+    }
+}
+
+TEST(TextureDecodeService, SrgbBoxMatchesReference)
+{
+    TextureImage image, mip;
+    image.Resize(67, 33);
+    std::mt19937 rng(7);
+
+    for (uint8& value : image.pixels) {
+        value = uint8(rng());
+    }
+
+    DownsampleBox(image, mip, true);
+
+    for (uint32 y = 0; y < mip.height; y++) {
+        for (uint32 x = 0; x < mip.width; x++) {
+            const uint8* t00 = image.pixels.data() + ((2 * y) * 67 + 2 * x) * 4;
+            const uint8* t01 = t00 + 4;
+            const uint8* t10 = t00 + 67 * 4;
+            const uint8* t11 = t10 + 4;
+
+            for (uint32 c = 0; c < 3; c++) {
+                const float sum = (Srgb::ToLinear(t00[c]) + Srgb::ToLinear(t01[c])) + (Srgb::ToLinear(t10[c]) + Srgb::ToLinear(t11[c]));
+                ASSERT_EQ(mip.pixels[(y * mip.width + x) * 4 + c], Srgb::FromLinear(sum * 0.25f));
+            }
+
+            ASSERT_EQ(mip.pixels[(y * mip.width + x) * 4 + 3], (t00[3] + t01[3] + t10[3] + t11[3] + 2) / 4);
+        }
+    }
+}
+
+TEST(TextureDecodeService, DecodeInParallel)
+{
+    int32 width, height, channels;
+    stbi_uc* pixels = stbi_load(TEXTURE_PATH, &width, &height, &channels, STBI_rgb_alpha);
+    ASSERT_NE(pixels, nullptr);
+
+    MappedFile file(TEXTURE_PATH);
+    ASSERT_TRUE(file.IsOpen());
+
+    TextureDecodeService service;
+    service.Init(4);
+    ASSERT_EQ(service.GetWorkerCount(), std::min(4u, WorkerPool::Instance().GetWorkerCount()));
+
+    std::vector<TextureDecodeHandle> requests;
+    TextureDecodeOptions linear;
+    linear.srgb = false;
+    linear.generateMips = false;
+
+    for (uint32 i = 0; i < 8; i++) {
+        if (i & 1) {
+            requests.emplace_back(service.Decode(std::vector<uint8>(file.Data(), file.Data() + file.Size())));
+        } else {
+            requests.emplace_back(service.Decode(TEXTURE_PATH, i == 4 ? linear : TextureDecodeOptions()));
+        }
+    }
+
+    TextureDecodeHandle missing = service.Decode("does/not/exist.png");
+    TextureDecodeHandle garbage = service.Decode(std::vector<uint8>(64, 0xCD));
+
+    for (uint32 i = 0; i < requests.size(); i++) {
+        ASSERT_TRUE(service.Wait(requests[i]));
+        const CookedTexture& texture = requests[i]->GetTexture();
+        ASSERT_EQ(texture.width, (uint32)width);
+        ASSERT_EQ(texture.height, (uint32)height);
+        ASSERT_EQ(texture.format, i == 4 ? TextureFormat::RGBA8_UNORM : TextureFormat::RGBA8_SRGB);
+        ASSERT_EQ(texture.levels.size(), i == 4 ? 1u : GetMipLevelCount(width, height));
+        ASSERT_EQ(memcmp(texture.GetLevelData(0), pixels, usize(width) * height * 4), 0);
+
+        usize offset = 0;
+
+        for (uint32 level = 0; level < texture.levels.size(); level++) {
+            ASSERT_EQ(texture.levels[level].offset, offset);
+            ASSERT_EQ(texture.levels[level].size, GetTextureLevelSize(texture.format, texture.GetLevelWidth(level), texture.GetLevelHeight(level)));
+            offset += texture.levels[level].size;
+        }
+
+        ASSERT_EQ(offset, texture.data.size());
+    }
+
+    ASSERT_FALSE(service.Wait(missing));
+    ASSERT_EQ(missing->GetState(), TextureDecodeRequest::FAILED);
+    ASSERT_FALSE(service.Wait(garbage));
+    ASSERT_EQ(garbage->GetState(), TextureDecodeRequest::FAILED);
+
+    stbi_image_free(pixels);
+}
+
+TEST(TextureDecodeService, Cancellation)
+{
+    TextureDecodeService service;
+    service.Init(1);
+
+    // The single worker can at most have picked up the first request by the time the others are cancelled
+    std::vector<TextureDecodeHandle> requests;
+
+    for (uint32 i = 0; i < 16; i++) {
+        requests.emplace_back(service.Decode(TEXTURE_PATH));
+    }
+
+    for (uint32 i = 1; i < requests.size(); i++) {
+        requests[i]->Cancel();
+    }
+
+    uint32 cancelled = 0;
+
+    for (uint32 i = 0; i < requests.size(); i++) {
+        const bool ready = service.Wait(requests[i]);
+        ASSERT_TRUE(requests[i]->IsDone());
+        cancelled += requests[i]->GetState() == TextureDecodeRequest::CANCELLED;
+        ASSERT_EQ(ready, requests[i]->GetState() == TextureDecodeRequest::READY);
+    }
+
+    ASSERT_TRUE(requests[0]->GetState() == TextureDecodeRequest::READY);
+    ASSERT_GE(cancelled, 14u);
+
+    // Shutting down drops the queue, the requests still complete
+    for (uint32 i = 0; i < 8; i++) {
+        requests[i] = service.Decode(TEXTURE_PATH);
+    }
+
+    service.Shutdown();
+
+    for (uint32 i = 0; i < 8; i++) {
+        ASSERT_TRUE(requests[i]->IsDone());
+    }
+
+    ASSERT_EQ(service.Decode(TEXTURE_PATH)->GetState(), TextureDecodeRequest::CANCELLED);
+
+    // Nothing will pick up a request a stopped service never took, waiting on it doesn't block
+    TextureDecodeHandle orphan = std::make_shared<TextureDecodeRequest>();
+    ASSERT_FALSE(service.Wait(orphan));
+    ASSERT_FALSE(TextureDecodeService().Wait(orphan));
+    ASSERT_EQ(orphan->GetState(), TextureDecodeRequest::PENDING);
+}
+
+TEST(TextureDecodeService, CancelBetweenMips)
+{
+    std::vector<uint8> pixels(256 * 256 * 4, 128);
+    std::vector<TextureImage> levels;
+    std::atomic<bool> cancel{ true };
+
+    MipChainOptions options;
+    options.cancel = &cancel;
+    ASSERT_FALSE(GenerateMipChain(pixels.data(), 256, 256, options, levels));
+
+    cancel = false;
+    ASSERT_TRUE(GenerateMipChain(pixels.data(), 256, 256, options, levels));
+    ASSERT_EQ(levels.size(), 9u);
+}
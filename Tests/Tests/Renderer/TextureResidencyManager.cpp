@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <Renderer/Backend/Texture/TextureResidencyManager/TextureResidencyManager.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+typedef TextureResidencyManager::LevelRequest LevelRequest;
+
+// 1024x1024 BC7, 11 levels: 1M, 256K, 64K, 16K, 4K, 1K, 256, 64, 16, 16, 16
+static const StreamedTextureDesc TEXTURE_1K = { TextureFormat::BC7_SRGB, 1024, 1024, 11 };
+static const usize TAIL_1K = 65536 + 16384 + 4096 + 1024 + 256 + 64 + 16 * 3;
+
+static TextureResidencyManager::Config MakeConfig(usize budget, usize uploadLimit = 16u << 20)
+{
+    TextureResidencyManager::Config config;
+    config.budget = budget;
+    config.maxUploadBytesPerFrame = uploadLimit;
+    config.tailLevelSize = 64u << 10;
+    config.evictionGraceFrames = 4;
+    return config;
+}
+
+static void CompleteLoads(TextureResidencyManager& manager, const std::vector<LevelRequest>& loads)
+{
+    for (const LevelRequest& load : loads) {
+        manager.OnLevelLoaded(load.texture, load.level);
+    }
+}
+
+TEST(TextureResidencyManager, TailIsResident)
+{
+    TextureResidencyManager manager(MakeConfig(64u << 20));
+    const TextureResidencyManager::TextureId id = manager.Register(TEXTURE_1K);
+
+    ASSERT_EQ(manager.GetTailLevel(id), 2u);
+    ASSERT_EQ(manager.GetResidentLevel(id), 2u);
+    ASSERT_EQ(manager.GetStats().residentBytes, TAIL_1K);
+    ASSERT_EQ(manager.GetStats().textureCount, 1u);
+
+    // A texture smaller than the threshold is all tail, a single oversized level too
+    const TextureResidencyManager::TextureId small = manager.Register({ TextureFormat::BC7_SRGB, 64, 64, 7 });
+    const TextureResidencyManager::TextureId single = manager.Register({ TextureFormat::RGBA8_UNORM, 512, 512, 1 });
+    ASSERT_EQ(manager.GetTailLevel(small), 0u);
+    ASSERT_EQ(manager.GetTailLevel(single), 0u);
+    ASSERT_EQ(manager.GetStats().residentBytes, TAIL_1K + 4096 + 1024 + 256 + 64 + 16 * 3 + 512 * 512 * 4);
+}
+
+TEST(TextureResidencyManager, StreamsOneLevelPerUpdate)
+{
+    TextureResidencyManager manager(MakeConfig(64u << 20));
+    const TextureResidencyManager::TextureId id = manager.Register(TEXTURE_1K);
+    std::vector<LevelRequest> loads, evictions;
+
+    for (uint32 level = 1; level != ~0u; level--) {
+        manager.RequestLod(id, 0.f);
+        manager.Update(loads, evictions);
+        ASSERT_EQ(loads.size(), 1u);
+        ASSERT_EQ(loads[0].texture, id);
+        ASSERT_EQ(loads[0].level, level);
+        ASSERT_EQ(loads[0].size, usize(1024 >> level) * (1024 >> level));
+        ASSERT_TRUE(evictions.empty());
+
+        // Nothing new is issued while the upload is in flight
+        manager.RequestLod(id, 0.f);
+        manager.Update(loads, evictions);
+        ASSERT_TRUE(loads.empty());
+        ASSERT_EQ(manager.GetStats().pendingBytes, usize(1024 >> level) * (1024 >> level));
+
+        manager.OnLevelLoaded(id, level);
+        ASSERT_EQ(manager.GetResidentLevel(id), level);
+        ASSERT_EQ(manager.GetStats().pendingBytes, 0u);
+    }
+
+    ASSERT_EQ(manager.GetStats().residentBytes, TAIL_1K + (1u << 20) + (256u << 10));
+
+    // A coarser request doesn't load anything nor evict while the budget has room
+    manager.RequestLod(id, 3.7f);
+    manager.Update(loads, evictions);
+    ASSERT_TRUE(loads.empty());
+    ASSERT_TRUE(evictions.empty());
+    ASSERT_EQ(manager.GetResidentLevel(id), 0u);
+}
+
+TEST(TextureResidencyManager, UploadLimitDefersLoads)
+{
+    TextureResidencyManager manager(MakeConfig(64u << 20, 300u << 10));
+    std::vector<TextureResidencyManager::TextureId> ids;
+    std::vector<LevelRequest> loads, evictions;
+
+    for (uint32 i = 0; i < 3; i++) {
+        ids.push_back(manager.Register(TEXTURE_1K));
+    }
+
+    // 256K each: only one fits in the frame, the lowest index wins the tie
+    for (TextureResidencyManager::TextureId id : ids) {
+        manager.RequestLod(id, 0.f);
+    }
+
+    manager.Update(loads, evictions);
+    ASSERT_EQ(loads.size(), 1u);
+    ASSERT_EQ(loads[0].texture, ids[0]);
+    ASSERT_EQ(manager.GetStats().loadsDeferred, 2u);
+    CompleteLoads(manager, loads);
+
+    // The textures missing the most levels come first
+    for (TextureResidencyManager::TextureId id : ids) {
+        manager.RequestLod(id, 0.f);
+    }
+
+    manager.Update(loads, evictions);
+    ASSERT_EQ(loads.size(), 1u);
+    ASSERT_EQ(loads[0].texture, ids[1]);
+    CompleteLoads(manager, loads);
+
+    for (TextureResidencyManager::TextureId id : ids) {
+        manager.RequestLod(id, 0.f);
+    }
+
+    manager.Update(loads, evictions);
+    ASSERT_EQ(loads.size(), 1u);
+    ASSERT_EQ(loads[0].texture, ids[2]);
+}
+
+TEST(TextureResidencyManager, EvictsLeastRecentlyUsed)
+{
+    // Room for both tails and a single level 0
+    const usize budget = 2 * TAIL_1K + 2 * (256u << 10) + (1u << 20);
+    TextureResidencyManager manager(MakeConfig(budget));
+    const TextureResidencyManager::TextureId a = manager.Register(TEXTURE_1K);
+    const TextureResidencyManager::TextureId b = manager.Register(TEXTURE_1K);
+    std::vector<LevelRequest> loads, evictions;
+
+    for (uint32 i = 0; i < 2; i++) {
+        manager.RequestLod(a, 0.f);
+        manager.Update(loads, evictions);
+        CompleteLoads(manager, loads);
+    }
+
+    ASSERT_EQ(manager.GetResidentLevel(a), 0u);
+
+    // b can stream its level 1, its level 0 doesn't fit while a still wants its own
+    for (uint32 i = 0; i < 3; i++) {
+        manager.RequestLod(a, 0.f);
+        manager.RequestLod(b, 0.f);
+        manager.Update(loads, evictions);
+        ASSERT_TRUE(evictions.empty());
+        CompleteLoads(manager, loads);
+    }
+
+    ASSERT_EQ(manager.GetResidentLevel(b), 1u);
+    ASSERT_EQ(manager.GetStats().loadsDeferred, 1u);
+
+    // a stops being requested: past the grace frames it only wants its tail and b takes its place
+    uint32 frames = 0;
+
+    do {
+        manager.RequestLod(b, 0.f);
+        manager.Update(loads, evictions);
+        CompleteLoads(manager, loads);
+        frames++;
+    } while (evictions.empty() && frames < 16);
+
+    ASSERT_EQ(frames, 5u);
+    ASSERT_EQ(evictions.size(), 1u);
+    ASSERT_EQ(evictions[0].texture, a);
+    ASSERT_EQ(evictions[0].level, 0u);
+    ASSERT_EQ(manager.GetResidentLevel(a), 1u);
+    ASSERT_EQ(manager.GetResidentLevel(b), 0u);
+    ASSERT_LE(manager.GetStats().residentBytes, budget);
+}
+
+TEST(TextureResidencyManager, LoweringTheBudget)
+{
+    TextureResidencyManager manager(MakeConfig(64u << 20));
+    std::vector<TextureResidencyManager::TextureId> ids;
+    std::vector<LevelRequest> loads, evictions;
+
+    for (uint32 i = 0; i < 3; i++) {
+        ids.push_back(manager.Register(TEXTURE_1K));
+    }
+
+    for (uint32 frame = 0; frame < 2; frame++) {
+        for (TextureResidencyManager::TextureId id : ids) {
+            manager.RequestLod(id, 0.f);
+        }
+
+        manager.Update(loads, evictions);
+        CompleteLoads(manager, loads);
+    }
+
+    // ids[2] then ids[0] were used last, ids[1] is the least recently used one
+    manager.RequestLod(ids[0], 0.f);
+    manager.RequestLod(ids[2], 0.f);
+    manager.Update(loads, evictions);
+    manager.RequestLod(ids[0], 0.f);
+    manager.Update(loads, evictions);
+    ASSERT_TRUE(loads.empty());
+
+    // Every texture still wants level 0, the wanted levels go from the least recently used texture
+    manager.SetBudget(3 * TAIL_1K + 2 * (256u << 10) + (1u << 20));
+    manager.Update(loads, evictions);
+    ASSERT_EQ(evictions.size(), 3u);
+    ASSERT_EQ(evictions[0].texture, ids[1]);
+    ASSERT_EQ(evictions[0].level, 0u);
+    ASSERT_EQ(evictions[1].texture, ids[1]);
+    ASSERT_EQ(evictions[1].level, 1u);
+    ASSERT_EQ(evictions[2].texture, ids[2]);
+    ASSERT_EQ(evictions[2].level, 0u);
+    ASSERT_EQ(manager.GetResidentLevel(ids[0]), 0u);
+    ASSERT_EQ(manager.GetResidentLevel(ids[1]), 2u);
+    ASSERT_EQ(manager.GetResidentLevel(ids[2]), 1u);
+    ASSERT_EQ(manager.GetStats().residentBytes, 3 * TAIL_1K + 2 * (256u << 10) + (1u << 20));
+
+    // Tails are never evicted, even over budget
+    manager.SetBudget(0);
+    manager.Update(loads, evictions);
+    ASSERT_EQ(manager.GetStats().residentBytes, 3 * TAIL_1K);
+    ASSERT_TRUE(loads.empty());
+}
+
+TEST(TextureResidencyManager, UnregisterWithPendingLoad)
+{
+    TextureResidencyManager manager(MakeConfig(64u << 20));
+    const TextureResidencyManager::TextureId id = manager.Register(TEXTURE_1K);
+    std::vector<LevelRequest> loads, evictions;
+
+    manager.RequestLod(id, 0.f);
+    manager.Update(loads, evictions);
+    ASSERT_EQ(loads.size(), 1u);
+    ASSERT_EQ(manager.GetStats().pendingBytes, 256u << 10);
+
+    manager.Unregister(id);
+    ASSERT_EQ(manager.GetStats().residentBytes, 0u);
+    ASSERT_EQ(manager.GetStats().pendingBytes, 0u);
+    ASSERT_EQ(manager.GetStats().textureCount, 0u);
+
+    // The slot is reused with a new generation, the old id no longer resolves
+    const TextureResidencyManager::TextureId other = manager.Register(TEXTURE_1K);
+    ASSERT_NE(other, id);
+    manager.OnLevelLoaded(id, 1);
+    manager.RequestLod(id, 0.f);
+    ASSERT_EQ(manager.GetResidentLevel(other), 2u);
+    ASSERT_EQ(manager.GetStats().residentBytes, TAIL_1K);
+
+    manager.Update(loads, evictions);
+    ASSERT_TRUE(loads.empty());
+}
+
+TEST(TextureResidencyManager, ScreenSpaceLod)
+{
+    ASSERT_FLOAT_EQ(TextureResidencyManager::ComputeScreenSpaceLod(1024, 1024, 1024.f, 1024.f), 0.f);
+    ASSERT_FLOAT_EQ(TextureResidencyManager::ComputeScreenSpaceLod(1024, 1024, 2048.f, 2048.f), 0.f);
+    ASSERT_FLOAT_EQ(TextureResidencyManager::ComputeScreenSpaceLod(1024, 1024, 256.f, 256.f), 2.f);
+    ASSERT_FLOAT_EQ(TextureResidencyManager::ComputeScreenSpaceLod(1024, 512, 256.f, 256.f), 2.f);
+    ASSERT_FLOAT_EQ(TextureResidencyManager::ComputeScreenSpaceLod(1024, 1024, 0.f, 64.f), 16.f);
+}
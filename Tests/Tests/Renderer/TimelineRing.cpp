@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/Core/RingAllocator/TimelineRing.hpp>
+
+using namespace TRE;
+
+TEST(TimelineRing, WrapsAndReleasesByValue)
+{
+    TimelineRing ring(100);
+
+    ASSERT_EQ(ring.Allocate(40), 0u);
+    ring.Commit(1);
+    ASSERT_EQ(ring.Allocate(30, 16), 48u);
+    ring.Commit(2);
+    ASSERT_EQ(ring.GetUsedSize(), 78u);
+
+    // No room at the end and the start is still in use
+    ASSERT_EQ(ring.Allocate(30), TimelineRing::INVALID_OFFSET);
+    ASSERT_EQ(ring.GetOldestValue(), 1u);
+
+    ring.Release(1);
+    ASSERT_EQ(ring.Allocate(30), 0u);
+    ASSERT_EQ(ring.Allocate(20), TimelineRing::INVALID_OFFSET);
+    ASSERT_EQ(ring.Allocate(10), 30u);
+    ring.Commit(3);
+
+    ring.Release(2);
+    // The end of the buffer skipped when wrapping belongs to the allocation that wrapped
+    ASSERT_EQ(ring.GetUsedSize(), 22u + 30u + 10u);
+    ring.Release(3);
+    ASSERT_EQ(ring.GetUsedSize(), 0u);
+    ASSERT_EQ(ring.GetOldestValue(), 0u);
+
+    // Empty rings start over
+    ASSERT_EQ(ring.Allocate(100), 0u);
+    ASSERT_EQ(ring.Allocate(101), TimelineRing::INVALID_OFFSET);
+}
+
+// Random traffic against a list of the live allocations, they must never overlap or leave the buffer
+TEST(TimelineRing, LiveAllocationsNeverOverlap)
+{
+    struct Allocation
+    {
+        uint64 offset;
+        uint64 size;
+        uint64 value;
+    };
+
+    CONSTEXPR uint64 CAPACITY = 4096;
+    TimelineRing ring(CAPACITY);
+    std::mt19937 gen(1337);
+    std::deque<Allocation> live;
+    uint64 value = 0;
+    uint64 completed = 0;
+    uint32 failures = 0;
+
+    for (uint32 i = 0; i < 100'000; i++) {
+        const uint64 size = 1 + gen() % 700;
+        const uint64 alignment = 1ull << (gen() % 8);
+        const uint64 offset = ring.Allocate(size, alignment);
+
+        if (offset == TimelineRing::INVALID_OFFSET) {
+            failures++;
+            ASSERT_FALSE(live.empty());
+            completed = ring.GetOldestValue() ? ring.GetOldestValue() : completed;
+        } else {
+            ASSERT_EQ(offset % alignment, 0u);
+            ASSERT_LE(offset + size, CAPACITY);
+
+            for (const Allocation& other : live) {
+                ASSERT_TRUE(offset + size <= other.offset || other.offset + other.size <= offset);
+            }
+
+            live.push_back({ offset, size, value + 1 });
+        }
+
+        if (gen() % 3 == 0) {
+            ring.Commit(++value);
+        }
+
+        if (gen() % 4 == 0) {
+            completed = std::max(completed, value - std::min<uint64>(value, gen() % 4));
+        }
+
+        ring.Release(completed);
+
+        while (!live.empty() && live.front().value <= completed) {
+            live.pop_front();
+        }
+    }
+
+    ASSERT_GT(failures, 0u);
+    ring.Commit(++value);
+    ring.Release(value);
+    ASSERT_EQ(ring.GetUsedSize(), 0u);
+}
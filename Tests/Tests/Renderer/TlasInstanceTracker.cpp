@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <random>
+#include <vector>
+#include <Renderer/Backend/RHI/RayTracing/TLAS/TlasInstanceTracker.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+TEST(TlasInstanceTracker, PacksTransforms)
+{
+    float transform[4][4];
+    float columnMajor[16];
+
+    for (uint32 row = 0; row < 4; row++) {
+        for (uint32 col = 0; col < 4; col++) {
+            transform[row][col] = float(row * 4 + col);
+            columnMajor[col * 4 + row] = float(row * 4 + col);
+        }
+    }
+
+    float packed[13];
+    float transposed[13];
+    packed[12] = transposed[12] = -1.f;
+    PackTransform3x4(packed, transform);
+    PackTransform3x4ColumnMajor(transposed, columnMajor);
+
+    for (uint32 i = 0; i < 12; i++) {
+        ASSERT_EQ(packed[i], float(i));
+        ASSERT_EQ(transposed[i], float(i));
+    }
+
+    // 3x4 only, the last row isn't written
+    ASSERT_EQ(packed[12], -1.f);
+    ASSERT_EQ(transposed[12], -1.f);
+}
+
+TEST(TlasInstanceTracker, RefitsUntilRebuild)
+{
+    TlasInstanceTracker<3> tracker;
+    tracker.Init(4, 2);
+    auto ignore = [](uint32, bool) {};
+
+    ASSERT_TRUE(tracker.HasChanges());
+    ASSERT_TRUE(tracker.BeginBuild(ignore).rebuild);
+    ASSERT_FALSE(tracker.HasChanges());
+
+    tracker.MarkDirty(1);
+    ASSERT_TRUE(tracker.HasChanges());
+    ASSERT_FALSE(tracker.BeginBuild(ignore).rebuild);
+    ASSERT_FALSE(tracker.BeginBuild(ignore).rebuild);
+    ASSERT_EQ(tracker.GetRefitCount(), 2u);
+    ASSERT_TRUE(tracker.BeginBuild(ignore).rebuild);
+    ASSERT_FALSE(tracker.BeginBuild(ignore).rebuild);
+
+    tracker.RequestRebuild();
+    ASSERT_TRUE(tracker.BeginBuild(ignore).rebuild);
+}
+
+// Every copy of the ring has to match the instances when a build reads it, with as few writes as possible
+TEST(TlasInstanceTracker, CopiesMatchInstancesWhenRead)
+{
+    CONSTEXPR uint32 RING = 3;
+    CONSTEXPR uint32 INSTANCES = 200;
+    TlasInstanceTracker<RING> tracker;
+    tracker.Init(INSTANCES, 8);
+
+    std::vector<uint32> instances(INSTANCES, 0);
+    std::vector<uint32> copies[RING];
+    std::mt19937 gen(7);
+
+    for (std::vector<uint32>& copy : copies) {
+        copy.assign(INSTANCES, ~0u);
+    }
+
+    for (uint32 b = 0; b < 500; b++) {
+        const uint32 changes = gen() % 20;
+
+        for (uint32 c = 0; c < changes; c++) {
+            const uint32 instance = gen() % INSTANCES;
+            instances[instance]++;
+            tracker.MarkDirty(instance);
+        }
+
+        const bool rebuildRequested = gen() % 50 == 0;
+
+        if (rebuildRequested) {
+            tracker.RequestRebuild();
+        }
+
+        uint32 writes = 0;
+        const uint32 region = b % RING;
+        const TlasInstanceTracker<RING>::Build build = tracker.BeginBuild([&](uint32 instance, bool) {
+            copies[region][instance] = instances[instance];
+            writes++;
+        });
+
+        ASSERT_EQ(build.region, region);
+        ASSERT_EQ(build.written, writes);
+        ASSERT_EQ(copies[region], instances);
+
+        if (rebuildRequested || b == 0) {
+            ASSERT_TRUE(build.rebuild);
+        }
+
+        // Once every copy caught up, at most the changes of the last RING builds are written
+        if (b >= RING && writes != INSTANCES) {
+            ASSERT_LE(writes, RING * 20u);
+        }
+    }
+}
+
+// Frames in flight: the GPU refits from the copy of each build up to RING - 1 frames after it was recorded. The copies
+// of those builds must stay untouched until they ran, and refits chain at most maxRefits times between full builds.
+TEST(TlasInstanceTracker, RefitsWithFramesInFlight)
+{
+    CONSTEXPR uint32 FRAMES = 3;
+    CONSTEXPR uint32 INSTANCES = 64;
+    CONSTEXPR uint32 MAX_REFITS = 5;
+    TlasInstanceTracker<FRAMES> tracker;
+    tracker.Init(INSTANCES, MAX_REFITS);
+
+    struct InFlight
+    {
+        uint32 region;
+        std::vector<uint32> instances; // What the build has to read
+    };
+
+    std::vector<uint32> instances(INSTANCES, 0);
+    std::vector<uint32> copies[FRAMES];
+    std::deque<InFlight> gpu;
+    std::mt19937 gen(11);
+    uint32 refitsInARow = 0;
+    uint32 refits = 0;
+
+    for (std::vector<uint32>& copy : copies) {
+        copy.assign(INSTANCES, ~0u);
+    }
+
+    auto retireOldest = [&]() {
+        ASSERT_EQ(copies[gpu.front().region], gpu.front().instances);
+        gpu.pop_front();
+    };
+
+    for (uint32 frame = 0; frame < 1000; frame++) {
+        // The GPU runs late by a varying amount, a copy is only written again once the build that read it ran
+        while (!gpu.empty() && (gpu.size() == FRAMES || gen() % 3 == 0)) {
+            retireOldest();
+        }
+
+        const uint32 changes = gen() % 8;
+
+        for (uint32 c = 0; c < changes; c++) {
+            const uint32 instance = gen() % INSTANCES;
+            instances[instance]++;
+            tracker.MarkDirty(instance);
+        }
+
+        if (gen() % 100 == 0) {
+            tracker.RequestRebuild();
+        }
+
+        const uint32 region = tracker.GetNextRegion();
+        const TlasInstanceTracker<FRAMES>::Build build = tracker.BeginBuild([&](uint32 instance, bool) {
+            copies[region][instance] = instances[instance];
+        });
+
+        ASSERT_EQ(build.region, region);
+        ASSERT_EQ(region, frame % FRAMES);
+
+        // Nothing the builds still in flight read was overwritten
+        for (const InFlight& inFlight : gpu) {
+            ASSERT_NE(inFlight.region, build.region);
+            ASSERT_EQ(copies[inFlight.region], inFlight.instances);
+        }
+
+        refitsInARow = build.rebuild ? 0 : refitsInARow + 1;
+        refits += !build.rebuild;
+        ASSERT_LE(refitsInARow, MAX_REFITS);
+        gpu.push_back({ build.region, instances });
+    }
+
+    while (!gpu.empty()) {
+        retireOldest();
+    }
+
+    // Mostly refits, one full build every MAX_REFITS + 1 at least
+    ASSERT_GE(refits, 1000u * MAX_REFITS / (MAX_REFITS + 1) - 20u);
+}
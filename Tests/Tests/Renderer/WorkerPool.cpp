@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include <Renderer/Backend/Core/WorkerPool/WorkerPool.hpp>
+
+using namespace TRE;
+using namespace TRE::Renderer;
+
+TEST(WorkerPool, ParallelForRunsEveryIndexOnce)
+{
+    WorkerPool& pool = WorkerPool::Instance();
+    ASSERT_GE(pool.GetWorkerCount(), 1u);
+
+    for (uint32 maxThreads : { 0u, 1u, 2u, 64u }) {
+        std::vector<std::atomic<uint32>> runs(1000);
+        pool.ParallelFor((uint32)runs.size(), [&runs](uint32 i) { runs[i]++; }, maxThreads);
+
+        for (const std::atomic<uint32>& count : runs) {
+            ASSERT_EQ(count.load(), 1u);
+        }
+    }
+
+    // Nothing to run
+    pool.ParallelFor(0, [](uint32) { FAIL(); });
+}
+
+TEST(WorkerPool, NestedAndBusyPool)
+{
+    WorkerPool& pool = WorkerPool::Instance();
+    std::atomic<bool> released{ false };
+    std::atomic<uint32> finished{ 0 };
+
+    // Every worker is held by a job, the caller runs the whole loop itself
+    for (uint32 i = 0; i < pool.GetWorkerCount(); i++) {
+        pool.Submit([&released, &finished]() {
+            while (!released) {
+                std::this_thread::yield();
+            }
+
+            finished++;
+        });
+    }
+
+    std::atomic<uint32> sum{ 0 };
+    pool.ParallelFor(64, [&sum](uint32 i) { sum += i; });
+    ASSERT_EQ(sum.load(), 64u * 63u / 2u);
+
+    released = true;
+
+    while (finished != pool.GetWorkerCount()) {
+        std::this_thread::yield();
+    }
+
+    // Loops started from the workers' own indices
+    std::vector<std::atomic<uint32>> runs(16 * 16);
+    pool.ParallelFor(16, [&pool, &runs](uint32 i) {
+        pool.ParallelFor(16, [&runs, i](uint32 j) { runs[i * 16 + j]++; });
+    });
+
+    for (const std::atomic<uint32>& count : runs) {
+        ASSERT_EQ(count.load(), 1u);
+    }
+}